@@ -0,0 +1,23 @@
+//===- BenchmarkMain.cpp --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Support/TargetSelect.h"
+
+#include <benchmark/benchmark.h>
+
+int main(int argc, char** argv) {
+  // RelocationBenchmark looks up the backends in the TargetRegistry
+  mcld::InitializeAllTargets();
+  mcld::InitializeAllDiagnostics();
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -0,0 +1,71 @@
+//===- HashTableBenchmark.cpp ---------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/ADT/HashEntry.h"
+#include "mcld/ADT/HashTable.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+using namespace mcld;
+
+namespace {
+
+struct IntCompare {
+  bool operator()(unsigned int X, unsigned int Y) const { return (X == Y); }
+};
+
+/// IntHash - spread the keys, the identity hash fills the buckets in order
+struct IntHash {
+  size_t operator()(unsigned int pKey) const { return pKey * 0x9E3779B1u; }
+};
+
+typedef HashEntry<unsigned int, unsigned int, IntCompare> EntryType;
+typedef HashTable<EntryType, IntHash, EntryFactory<EntryType> > TableType;
+
+/// getKeys - pseudo-random distinct keys
+std::vector<unsigned int> getKeys(size_t pNum) {
+  std::vector<unsigned int> keys(pNum);
+  for (size_t i = 0; i < pNum; ++i)
+    keys[i] = static_cast<unsigned int>(i * 2654435761u) ^ 0x5bd1e995u;
+  return keys;
+}
+
+void BM_HashTableInsert(benchmark::State& pState) {
+  std::vector<unsigned int> keys = getKeys(pState.range(0));
+  for (auto _ : pState) {
+    TableType table(0);
+    bool exist;
+    for (size_t i = 0; i < keys.size(); ++i)
+      table.insert(keys[i], exist);
+    benchmark::DoNotOptimize(table.numOfEntries());
+  }
+  pState.SetItemsProcessed(pState.iterations() * keys.size());
+}
+
+void BM_HashTableFind(benchmark::State& pState) {
+  std::vector<unsigned int> keys = getKeys(pState.range(0));
+  TableType table(0);
+  bool exist;
+  for (size_t i = 0; i < keys.size(); ++i)
+    table.insert(keys[i], exist);
+
+  for (auto _ : pState) {
+    size_t found = 0;
+    for (size_t i = 0; i < keys.size(); ++i)
+      found += (table.find(keys[i]) != table.end());
+    benchmark::DoNotOptimize(found);
+  }
+  pState.SetItemsProcessed(pState.iterations() * keys.size());
+}
+
+}  // anonymous namespace
+
+BENCHMARK(BM_HashTableInsert)->RangeMultiplier(10)->Range(10000, 10000000);
+BENCHMARK(BM_HashTableFind)->RangeMultiplier(10)->Range(10000, 10000000);
@@ -0,0 +1,46 @@
+//===- LEB128Benchmark.cpp ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Support/LEB128.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+using namespace mcld;
+
+namespace {
+
+const size_t kNumValues = 1 << 16;
+
+/// getEncoded - values of 1 to 9 bytes, as in .debug_info and .eh_frame
+std::vector<leb128::ByteType> getEncoded() {
+  std::vector<leb128::ByteType> buffer(kNumValues * 10);
+  leb128::ByteType* place = buffer.data();
+  for (size_t i = 0; i < kNumValues; ++i)
+    leb128::encode<uint64_t>(place, (i * 0x9E3779B97F4A7C15ull) >> (i % 57));
+  buffer.resize(place - buffer.data());
+  return buffer;
+}
+
+void BM_LEB128Decode(benchmark::State& pState) {
+  std::vector<leb128::ByteType> buffer = getEncoded();
+  for (auto _ : pState) {
+    const leb128::ByteType* place = buffer.data();
+    uint64_t sum = 0;
+    for (size_t i = 0; i < kNumValues; ++i)
+      sum += leb128::decode<uint64_t>(place);
+    benchmark::DoNotOptimize(sum);
+  }
+  pState.SetItemsProcessed(pState.iterations() * kNumValues);
+  pState.SetBytesProcessed(pState.iterations() * buffer.size());
+}
+
+}  // anonymous namespace
+
+BENCHMARK(BM_LEB128Decode);
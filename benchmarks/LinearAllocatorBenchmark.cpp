@@ -0,0 +1,57 @@
+//===- LinearAllocatorBenchmark.cpp ---------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Support/Allocators.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <vector>
+
+using namespace mcld;
+
+namespace {
+
+/// Data - about the size of a Relocation
+struct Data {
+  uint64_t value[5];
+};
+
+void BM_LinearAllocator(benchmark::State& pState) {
+  size_t num = pState.range(0);
+  for (auto _ : pState) {
+    LinearAllocator<Data, 256> allocator;
+    for (size_t i = 0; i < num; ++i) {
+      Data* data = allocator.allocate();
+      allocator.construct(data);
+      benchmark::DoNotOptimize(data);
+    }
+  }
+  pState.SetItemsProcessed(pState.iterations() * num);
+}
+
+void BM_Malloc(benchmark::State& pState) {
+  size_t num = pState.range(0);
+  std::vector<Data*> datas(num);
+  for (auto _ : pState) {
+    for (size_t i = 0; i < num; ++i) {
+      datas[i] = static_cast<Data*>(malloc(sizeof(Data)));
+      new (datas[i]) Data();
+      benchmark::DoNotOptimize(datas[i]);
+    }
+    // a linear allocator frees its chunks at once, so free in the loop
+    for (size_t i = 0; i < num; ++i)
+      free(datas[i]);
+  }
+  pState.SetItemsProcessed(pState.iterations() * num);
+}
+
+}  // anonymous namespace
+
+BENCHMARK(BM_LinearAllocator)->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(BM_Malloc)->RangeMultiplier(10)->Range(1000, 1000000);
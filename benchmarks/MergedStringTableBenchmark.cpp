@@ -0,0 +1,59 @@
+//===- MergedStringTableBenchmark.cpp -------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/MergedStringTable.h"
+#include "mcld/Support/ThreadPool.h"
+
+#include <benchmark/benchmark.h>
+
+#include <llvm/ADT/StringRef.h>
+
+#include <string>
+#include <vector>
+
+using namespace mcld;
+
+namespace {
+
+const size_t kNumBlocks = 64;
+
+/// getBlocks - .rodata.str1.1 like blocks. Each block shares most of its
+/// strings with the other blocks, and some strings are tails of others.
+std::vector<std::string> getBlocks(size_t pNumStrings) {
+  std::vector<std::string> blocks(kNumBlocks);
+  for (size_t b = 0; b < kNumBlocks; ++b) {
+    for (size_t i = 0; i < pNumStrings; ++i) {
+      blocks[b] += "string literal number ";
+      blocks[b] += std::to_string((i * 7 + b) % (pNumStrings * 2));
+      blocks[b] += '\0';
+    }
+  }
+  return blocks;
+}
+
+void BM_MergedStringTableInsert(benchmark::State& pState) {
+  std::vector<std::string> blocks = getBlocks(pState.range(1));
+  ThreadPool pool(pState.range(0));
+  size_t bytes = 0;
+  for (size_t i = 0; i < blocks.size(); ++i)
+    bytes += blocks[i].size();
+
+  for (auto _ : pState) {
+    MergedStringTable table;
+    for (size_t i = 0; i < blocks.size(); ++i)
+      table.addStrings(blocks[i]);
+    benchmark::DoNotOptimize(table.finalizeOffset(pool));
+  }
+  pState.SetBytesProcessed(pState.iterations() * bytes);
+}
+
+}  // anonymous namespace
+
+BENCHMARK(BM_MergedStringTableInsert)
+    ->ArgsProduct({{1, 4}, {1000, 10000}})
+    ->UseRealTime();
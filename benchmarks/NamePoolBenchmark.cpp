@@ -0,0 +1,58 @@
+//===- NamePoolBenchmark.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/NamePool.h"
+#include "mcld/LD/Resolver.h"
+#include "mcld/LD/ResolveInfo.h"
+
+#include <benchmark/benchmark.h>
+
+#include <llvm/ADT/StringRef.h>
+
+#include <string>
+#include <vector>
+
+using namespace mcld;
+
+namespace {
+
+/// getNames - mangled-like names with long common prefixes
+std::vector<std::string> getNames(size_t pNum) {
+  std::vector<std::string> names(pNum);
+  for (size_t i = 0; i < pNum; ++i)
+    names[i] = "_ZN4mcld9Benchmark6symbolEi" + std::to_string(i);
+  return names;
+}
+
+void insert(NamePool& pPool,
+            const std::string& pName,
+            ResolveInfo::Desc pDesc) {
+  Resolver::Result result;
+  pPool.insertSymbol(pName, false, ResolveInfo::Function, pDesc,
+                     ResolveInfo::Global, 0x0, 0x0, ResolveInfo::Default,
+                     NULL, result);
+}
+
+/// BM_NamePoolInsertSymbol - insert the undefined references, then resolve
+/// them against the definitions.
+void BM_NamePoolInsertSymbol(benchmark::State& pState) {
+  std::vector<std::string> names = getNames(pState.range(0));
+  for (auto _ : pState) {
+    NamePool pool(1024);
+    for (size_t i = 0; i < names.size(); ++i)
+      insert(pool, names[i], ResolveInfo::Undefined);
+    for (size_t i = 0; i < names.size(); ++i)
+      insert(pool, names[i], ResolveInfo::Define);
+    benchmark::DoNotOptimize(pool.size());
+  }
+  pState.SetItemsProcessed(pState.iterations() * names.size() * 2);
+}
+
+}  // anonymous namespace
+
+BENCHMARK(BM_NamePoolInsertSymbol)->RangeMultiplier(10)->Range(10000, 1000000);
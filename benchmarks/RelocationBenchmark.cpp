@@ -0,0 +1,115 @@
+//===- RelocationBenchmark.cpp --------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LinkerConfig.h"
+#include "mcld/Fragment/FillFragment.h"
+#include "mcld/Fragment/FragmentRef.h"
+#include "mcld/Fragment/Relocation.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/LD/LDSymbol.h"
+#include "mcld/LD/Relocator.h"
+#include "mcld/LD/ResolveInfo.h"
+#include "mcld/LD/SectionData.h"
+#include "mcld/Support/Target.h"
+#include "mcld/Support/TargetRegistry.h"
+#include "mcld/Target/TargetLDBackend.h"
+
+#include <benchmark/benchmark.h>
+
+#include <llvm/Support/ELF.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace mcld;
+
+namespace {
+
+const size_t kNumRelocs = 4096;
+
+/// applyRelocations - apply kNumRelocs relocations of pType against a local
+/// symbol in .text of a static executable. Mips is left out, its relocator
+/// needs the GOT of an input to apply anything.
+void applyRelocations(benchmark::State& pState,
+                      const char* pTriple,
+                      Relocation::Type pType) {
+  LinkerConfig config(pTriple);
+  config.setCodeGenType(LinkerConfig::Exec);
+  Relocation::SetUp(config);
+
+  std::string error;
+  const Target* target = TargetRegistry::lookupTarget(pTriple, error);
+  if (target == NULL) {
+    pState.SkipWithError(error.c_str());
+    return;
+  }
+  std::unique_ptr<TargetLDBackend> backend(target->createLDBackend(config));
+  if (!backend || !backend->initRelocator()) {
+    pState.SkipWithError("cannot create the relocator");
+    return;
+  }
+  Relocator& relocator = *backend->getRelocator();
+
+  LDSection* text = LDSection::Create(".text",
+                                      LDFileFormat::TEXT,
+                                      llvm::ELF::SHT_PROGBITS,
+                                      llvm::ELF::SHF_ALLOC |
+                                          llvm::ELF::SHF_EXECINSTR);
+  text->setAddr(0x10000);
+  SectionData* sd = SectionData::Create(*text);
+  Fragment* frag = new FillFragment(0x0, 1, kNumRelocs * 8, sd);
+  frag->setOffset(0x0);
+
+  ResolveInfo* info = ResolveInfo::Create("local");
+  info->setDesc(ResolveInfo::Define);
+  info->setBinding(ResolveInfo::Local);
+  LDSymbol* symbol = LDSymbol::Create(*info);
+  symbol->setValue(0x12000);
+  info->setSymPtr(symbol);
+
+  std::vector<Relocation*> relocs(kNumRelocs);
+  for (size_t i = 0; i < kNumRelocs; ++i) {
+    relocs[i] = Relocation::Create(pType, *FragmentRef::Create(*frag, i * 8),
+                                   i);
+    relocs[i]->setSymInfo(info);
+  }
+
+  for (auto _ : pState) {
+    for (size_t i = 0; i < kNumRelocs; ++i) {
+      relocs[i]->target() = 0x0;
+      relocs[i]->apply(relocator);
+    }
+    benchmark::DoNotOptimize(relocs.front()->target());
+  }
+  pState.SetItemsProcessed(pState.iterations() * kNumRelocs);
+
+  Relocation::Clear();
+  LDSymbol::Destroy(symbol);
+  ResolveInfo::Destroy(info);
+  LDSection::Destroy(text);
+}
+
+}  // anonymous namespace
+
+BENCHMARK_CAPTURE(applyRelocations, x86_64_64, "x86_64-linux-gnu",
+                  llvm::ELF::R_X86_64_64);
+BENCHMARK_CAPTURE(applyRelocations, x86_64_pc32, "x86_64-linux-gnu",
+                  llvm::ELF::R_X86_64_PC32);
+BENCHMARK_CAPTURE(applyRelocations, i386_32, "i386-linux-gnu",
+                  llvm::ELF::R_386_32);
+BENCHMARK_CAPTURE(applyRelocations, i386_pc32, "i386-linux-gnu",
+                  llvm::ELF::R_386_PC32);
+BENCHMARK_CAPTURE(applyRelocations, arm_abs32, "arm-linux-gnueabi",
+                  llvm::ELF::R_ARM_ABS32);
+BENCHMARK_CAPTURE(applyRelocations, arm_rel32, "arm-linux-gnueabi",
+                  llvm::ELF::R_ARM_REL32);
+BENCHMARK_CAPTURE(applyRelocations, aarch64_abs64, "aarch64-linux-gnu",
+                  llvm::ELF::R_AARCH64_ABS64);
+BENCHMARK_CAPTURE(applyRelocations, aarch64_prel32, "aarch64-linux-gnu",
+                  llvm::ELF::R_AARCH64_PREL32);
@@ -0,0 +1,66 @@
+//===- WildcardPatternBenchmark.cpp ---------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Object/SectionMap.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+using namespace mcld;
+
+namespace {
+
+/// the patterns of the default ELF linker script, in script order
+const char* kRules[][2] = {
+    {".text.unlikely", ".text"},
+    {".text.hot", ".text"},
+    {".text.*", ".text"},
+    {".rodata.*", ".rodata"},
+    {".data.rel.ro.*", ".data.rel.ro"},
+    {".data.*", ".data"},
+    {".bss.*", ".bss"},
+    {".tdata.*", ".tdata"},
+    {".tbss.*", ".tbss"},
+    {"*.debug_*", ".debug"},
+    {".init_array.?????", ".init_array"},
+    {".fini_array.?????", ".fini_array"},
+};
+
+/// getSectionNames - the input section names of -ffunction-sections and
+/// -fdata-sections objects
+std::vector<std::string> getSectionNames() {
+  const char* prefixes[] = {".text.", ".rodata.", ".data.", ".bss.",
+                            ".data.rel.ro.", ".init_array.", ".comment"};
+  std::vector<std::string> names;
+  for (size_t i = 0; i < 4096; ++i) {
+    names.push_back(std::string(prefixes[i % 7]) +
+                    (i % 7 == 5 ? "00100" : "_ZN4mcld6Module" +
+                                                std::to_string(i)));
+  }
+  return names;
+}
+
+void BM_SectionMapFind(benchmark::State& pState) {
+  SectionMap map;
+  for (size_t i = 0; i < sizeof(kRules) / sizeof(kRules[0]); ++i)
+    map.insert(kRules[i][0], kRules[i][1]);
+  std::vector<std::string> names = getSectionNames();
+  const SectionMap& cmap = map;
+
+  for (auto _ : pState) {
+    for (size_t i = 0; i < names.size(); ++i)
+      benchmark::DoNotOptimize(cmap.find("foo.o", names[i]));
+  }
+  pState.SetItemsProcessed(pState.iterations() * names.size());
+}
+
+}  // anonymous namespace
+
+BENCHMARK(BM_SectionMapFind);
@@ -9,9 +9,18 @@
 #ifndef MCLD_ADT_HASHBASE_H_
 #define MCLD_ADT_HASHBASE_H_
 
+#include "mcld/Support/Statistic.h"
+
 #include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+#include <llvm/Support/MathExtras.h>
 
 #include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace mcld {
 
@@ -48,6 +57,13 @@ class HashBucket {
  *  The drawback is that the number of the stored items can notbe more
  *  than the size of the hash table.
  *
+ *  Besides the buckets, HashTableImpl keeps one control byte per bucket. A
+ *  control byte is either empty, a tombstone, or 7 bits of the hash value of
+ *  the entry. Probing loads the control bytes of 16 consecutive buckets at
+ *  once (with SSE2 if available) and only touches the buckets whose control
+ *  bytes match, so most probes never compare a key. The number of buckets is
+ *  always a power of two.
+ *
  *  MCLinker tries to merge every things in the same HashEntry. It can
  *  keep every thing in the same cache line and improve the locality
  *  efficiently. HashTableImpl provides a template argument to change the
@@ -65,6 +81,9 @@ class HashTableImpl {
  private:
   static const unsigned int NumOfInitBuckets = 16;
 
+  /// the number of control bytes probed at a time
+  static const unsigned int GroupWidth = 16;
+
  public:
   typedef size_t size_type;
   typedef HashFunctionTy hasher;
@@ -99,6 +118,9 @@ class HashTableImpl {
   //  @return the index of the found bucket
   unsigned int lookUpBucketFor(const key_type& pKey);
 
+  /// lookUpBucketFor - search the bucket of pKey whose hash value is known
+  unsigned int lookUpBucketFor(const key_type& pKey, unsigned int pHashValue);
+
   /// findKey - finds an element with key pKey
   //  return the index of the element, or -1 when the element does not exist.
   int findKey(const key_type& pKey) const;
@@ -110,6 +132,20 @@ class HashTableImpl {
   /// buckets
   void doRehash(unsigned int pNewSize);
 
+  /// fillBucket - put pEntry into the bucket returned by lookUpBucketFor
+  void fillBucket(unsigned int pIndex, entry_type* pEntry);
+
+  /// eraseBucket - replace the entry of the bucket by a tombstone
+  void eraseBucket(unsigned int pIndex);
+
+  /// bucketIndexOf - the home bucket of the hash value
+  unsigned int bucketIndexOf(unsigned int pHashValue) const {
+    return pHashValue & (m_NumOfBuckets - 1);
+  }
+
+ private:
+  void setControl(unsigned int pIndex, uint8_t pControl);
+
   friend class ChainIteratorBase<Self>;
   friend class ChainIteratorBase<const Self>;
   friend class EntryIteratorBase<Self>;
@@ -118,6 +154,9 @@ class HashTableImpl {
  protected:
   // Array of Buckets
   bucket_type* m_Buckets;
+  // Array of control bytes, followed by a copy of the first GroupWidth bytes
+  // so that a group can be loaded at any bucket without wrapping around.
+  uint8_t* m_Controls;
   unsigned int m_NumOfBuckets;
   unsigned int m_NumOfEntries;
   unsigned int m_NumOfTombstones;
@@ -11,22 +11,54 @@
 // internal non-member functions
 //===----------------------------------------------------------------------===//
 inline static unsigned int compute_bucket_count(unsigned int pNumOfBuckets) {
-  static const unsigned int bucket_size[] = {
-      1,     3,     17,    37,    67,    97,     197,
-      419,   977,   2593,  4099,  8209,  12289,  16411,
-      20483, 32771, 49157, 65537, 98317, 131101, 196613};
-
-  const unsigned int buckets_count =
-      sizeof(bucket_size) / sizeof(bucket_size[0]);
-  unsigned int idx = 0;
-  do {
-    if (pNumOfBuckets < bucket_size[idx]) {
-      return bucket_size[idx];
-    }
-    ++idx;
-  } while (idx < buckets_count);
+  // the smallest power of two which is larger than pNumOfBuckets
+  if (pNumOfBuckets < 16)
+    return 16;
+  return llvm::NextPowerOf2(pNumOfBuckets);
+}
+
+/// control bytes of the buckets. A full bucket keeps 7 bits of its hash value
+/// so the highest bit tells if a bucket is free.
+static const uint8_t kEmptyControl = 0x80;
+static const uint8_t kTombstoneControl = 0xFE;
+
+inline static uint8_t hash_control(unsigned int pHashValue) {
+  // The low bits select the bucket. Take the control bits from a mixed hash
+  // value so that they are independent of the bucket index.
+  return (pHashValue * 0x9E3779B1u) >> 25;
+}
+
+/// match_control - a bit mask of the buckets in the group whose control byte
+/// is pControl.
+inline static unsigned int match_control(const uint8_t* pGroup,
+                                         uint8_t pControl) {
+#if defined(__SSE2__)
+  __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pGroup));
+  return _mm_movemask_epi8(
+      _mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(pControl))));
+#else
+  unsigned int mask = 0;
+  for (unsigned int i = 0; i < 16; ++i) {
+    if (pGroup[i] == pControl)
+      mask |= (1u << i);
+  }
+  return mask;
+#endif
+}
 
-  return (pNumOfBuckets + 131101);  // rare case. increase constantly
+/// match_free - a bit mask of the empty buckets and tombstones in the group.
+inline static unsigned int match_free(const uint8_t* pGroup) {
+#if defined(__SSE2__)
+  __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pGroup));
+  return _mm_movemask_epi8(group);
+#else
+  unsigned int mask = 0;
+  for (unsigned int i = 0; i < 16; ++i) {
+    if ((pGroup[i] & 0x80) != 0)
+      mask |= (1u << i);
+  }
+  return mask;
+#endif
 }
 
 //===----------------------------------------------------------------------===//
@@ -52,6 +84,7 @@ HashBucket<DataType>::getTombstone() {
 template <typename HashEntryTy, typename HashFunctionTy>
 HashTableImpl<HashEntryTy, HashFunctionTy>::HashTableImpl()
     : m_Buckets(0),
+      m_Controls(0),
       m_NumOfBuckets(0),
       m_NumOfEntries(0),
       m_NumOfTombstones(0),
@@ -68,6 +101,7 @@ HashTableImpl<HashEntryTy, HashFunctionTy>::HashTableImpl(
   }
 
   m_Buckets = 0;
+  m_Controls = 0;
   m_NumOfBuckets = 0;
   m_NumOfEntries = 0;
   m_NumOfTombstones = 0;
@@ -95,14 +129,18 @@ void HashTableImpl<HashEntryTy, HashFunctionTy>::init(unsigned int pInitSize) {
 
   /** calloc also set bucket.Item = bucket_type::getEmptyStone() **/
   m_Buckets = (bucket_type*)calloc(m_NumOfBuckets, sizeof(bucket_type));
+  m_Controls = (uint8_t*)malloc(m_NumOfBuckets + GroupWidth);
+  memset(m_Controls, kEmptyControl, m_NumOfBuckets + GroupWidth);
 }
 
 /// clear - clear the hash table.
 template <typename HashEntryTy, typename HashFunctionTy>
 void HashTableImpl<HashEntryTy, HashFunctionTy>::clear() {
   free(m_Buckets);
+  free(m_Controls);
 
   m_Buckets = 0;
+  m_Controls = 0;
   m_NumOfBuckets = 0;
   m_NumOfEntries = 0;
   m_NumOfTombstones = 0;
@@ -112,44 +150,50 @@ void HashTableImpl<HashEntryTy, HashFunctionTy>::clear() {
 template <typename HashEntryTy, typename HashFunctionTy>
 unsigned int HashTableImpl<HashEntryTy, HashFunctionTy>::lookUpBucketFor(
     const typename HashTableImpl<HashEntryTy, HashFunctionTy>::key_type& pKey) {
+  return lookUpBucketFor(pKey, m_Hasher(pKey));
+}
+
+/// lookUpBucketFor - look up the bucket of pKey by its hash value
+template <typename HashEntryTy, typename HashFunctionTy>
+unsigned int HashTableImpl<HashEntryTy, HashFunctionTy>::lookUpBucketFor(
+    const typename HashTableImpl<HashEntryTy, HashFunctionTy>::key_type& pKey,
+    unsigned int pHashValue) {
   if (m_NumOfBuckets == 0) {
     // NumOfBuckets is changed after init(pInitSize)
     init(NumOfInitBuckets);
   }
 
-  unsigned int full_hash = m_Hasher(pKey);
-  unsigned int index = full_hash % m_NumOfBuckets;
-
-  const unsigned int probe = 1;
-  int firstTombstone = -1;
+  static Statistic NumProbes("hash.probe", "The # of bucket groups probed");
+  unsigned int full_hash = pHashValue;
+  uint8_t control = hash_control(full_hash);
+  unsigned int mask = m_NumOfBuckets - 1;
+  unsigned int index = full_hash & mask;
+  int firstFree = -1;
 
-  // linear probing
+  // probe a group of buckets at a time
   while (true) {
-    bucket_type& bucket = m_Buckets[index];
-    // If we found an empty bucket, this key isn't in the table yet, return it.
-    if (bucket_type::getEmptyBucket() == bucket.Entry) {
-      if (firstTombstone != -1) {
-        m_Buckets[firstTombstone].FullHashValue = full_hash;
-        return firstTombstone;
-      }
-
-      bucket.FullHashValue = full_hash;
-      return index;
+    ++NumProbes;
+    const uint8_t* group = m_Controls + index;
+    unsigned int match = match_control(group, control);
+    for (; match != 0; match &= (match - 1)) {
+      unsigned int idx = (index + llvm::countTrailingZeros(match)) & mask;
+      bucket_type& bucket = m_Buckets[idx];
+      if (bucket.FullHashValue == full_hash && bucket.Entry->compare(pKey))
+        return idx;
     }
 
-    if (bucket_type::getTombstone() == bucket.Entry) {
-      if (firstTombstone == -1) {
-        firstTombstone = index;
-      }
-    } else if (bucket.FullHashValue == full_hash) {
-      if (bucket.Entry->compare(pKey)) {
-        return index;
-      }
+    unsigned int free_mask = match_free(group);
+    if (firstFree == -1 && free_mask != 0)
+      firstFree = (index + llvm::countTrailingZeros(free_mask)) & mask;
+
+    // If the group has an empty bucket, this key isn't in the table yet.
+    // Return the first empty bucket or tombstone on the way.
+    if (match_control(group, kEmptyControl) != 0) {
+      m_Buckets[firstFree].FullHashValue = full_hash;
+      return firstFree;
     }
 
-    index += probe;
-    if (index == m_NumOfBuckets)
-      index = 0;
+    index = (index + GroupWidth) & mask;
   }
 }
 
@@ -161,26 +205,26 @@ int HashTableImpl<HashEntryTy, HashFunctionTy>::findKey(
     return -1;
 
   unsigned int full_hash = m_Hasher(pKey);
-  unsigned int index = full_hash % m_NumOfBuckets;
+  uint8_t control = hash_control(full_hash);
+  unsigned int mask = m_NumOfBuckets - 1;
+  unsigned int index = full_hash & mask;
 
-  const unsigned int probe = 1;
-  // linear probing
+  // probe a group of buckets at a time
   while (true) {
-    bucket_type& bucket = m_Buckets[index];
+    const uint8_t* group = m_Controls + index;
+    unsigned int match = match_control(group, control);
+    for (; match != 0; match &= (match - 1)) {
+      unsigned int idx = (index + llvm::countTrailingZeros(match)) & mask;
+      const bucket_type& bucket = m_Buckets[idx];
+      // get string, compare, if match, return index
+      if (bucket.FullHashValue == full_hash && bucket.Entry->compare(pKey))
+        return idx;
+    }
 
-    if (bucket_type::getEmptyBucket() == bucket.Entry)
+    if (match_control(group, kEmptyControl) != 0)
       return -1;
 
-    if (bucket_type::getTombstone() == bucket.Entry) {
-      // Ignore tombstones.
-    } else if (full_hash == bucket.FullHashValue) {
-      // get string, compare, if match, return index
-      if (bucket.Entry->compare(pKey))
-        return index;
-    }
-    index += probe;
-    if (index == m_NumOfBuckets)
-      index = 0;
+    index = (index + GroupWidth) & mask;
   }
 }
 
@@ -204,40 +248,72 @@ void HashTableImpl<HashEntryTy, HashFunctionTy>::mayRehash() {
 template <typename HashEntryTy, typename HashFunctionTy>
 void HashTableImpl<HashEntryTy, HashFunctionTy>::doRehash(
     unsigned int pNewSize) {
-  bucket_type* new_table = (bucket_type*)calloc(pNewSize, sizeof(bucket_type));
+  static Statistic NumRehash("hash.rehash", "The # of rehashed tables");
+  ++NumRehash;
+
+  // keep the size a power of two, and keep the load factor under 3/4
+  unsigned int new_size = compute_bucket_count(pNewSize > 0 ? pNewSize - 1 : 0);
+  while ((m_NumOfEntries << 2) > new_size * 3)
+    new_size <<= 1;
+
+  bucket_type* new_table = (bucket_type*)calloc(new_size, sizeof(bucket_type));
+  uint8_t* new_controls = (uint8_t*)malloc(new_size + GroupWidth);
+  memset(new_controls, kEmptyControl, new_size + GroupWidth);
 
   // Rehash all the items into their new buckets.  Luckily :) we already have
   // the hash values available, so we don't have to recall hash function again.
+  unsigned int mask = new_size - 1;
   for (bucket_type* IB = m_Buckets, * E = m_Buckets + m_NumOfBuckets; IB != E;
        ++IB) {
     if (IB->Entry != bucket_type::getEmptyBucket() &&
         IB->Entry != bucket_type::getTombstone()) {
-      // Fast case, bucket available.
+      // The new table has no tombstone. Probe for the first empty bucket.
       unsigned full_hash = IB->FullHashValue;
-      unsigned new_bucket = full_hash % pNewSize;
-      if (bucket_type::getEmptyBucket() == new_table[new_bucket].Entry) {
-        new_table[new_bucket].Entry = IB->Entry;
-        new_table[new_bucket].FullHashValue = full_hash;
-        continue;
-      }
-
-      // Otherwise probe for a spot.
-      const unsigned int probe = 1;
-      do {
-        new_bucket += probe;
-        if (new_bucket == pNewSize)
-          new_bucket = 0;
-      } while (new_table[new_bucket].Entry != bucket_type::getEmptyBucket());
+      unsigned new_bucket = full_hash & mask;
+      unsigned int free_mask;
+      while ((free_mask = match_free(new_controls + new_bucket)) == 0)
+        new_bucket = (new_bucket + GroupWidth) & mask;
+      new_bucket = (new_bucket + llvm::countTrailingZeros(free_mask)) & mask;
 
       // Finally found a slot.  Fill it in.
       new_table[new_bucket].Entry = IB->Entry;
       new_table[new_bucket].FullHashValue = full_hash;
+      new_controls[new_bucket] = hash_control(full_hash);
+      if (new_bucket < GroupWidth)
+        new_controls[new_size + new_bucket] = new_controls[new_bucket];
     }
   }
 
   free(m_Buckets);
+  free(m_Controls);
 
   m_Buckets = new_table;
-  m_NumOfBuckets = pNewSize;
+  m_Controls = new_controls;
+  m_NumOfBuckets = new_size;
   m_NumOfTombstones = 0;
 }
+
+template <typename HashEntryTy, typename HashFunctionTy>
+void HashTableImpl<HashEntryTy, HashFunctionTy>::fillBucket(
+    unsigned int pIndex,
+    entry_type* pEntry) {
+  m_Buckets[pIndex].Entry = pEntry;
+  setControl(pIndex, hash_control(m_Buckets[pIndex].FullHashValue));
+}
+
+template <typename HashEntryTy, typename HashFunctionTy>
+void HashTableImpl<HashEntryTy, HashFunctionTy>::eraseBucket(
+    unsigned int pIndex) {
+  m_Buckets[pIndex].Entry = bucket_type::getTombstone();
+  setControl(pIndex, kTombstoneControl);
+}
+
+template <typename HashEntryTy, typename HashFunctionTy>
+void HashTableImpl<HashEntryTy, HashFunctionTy>::setControl(
+    unsigned int pIndex,
+    uint8_t pControl) {
+  m_Controls[pIndex] = pControl;
+  // keep the copy of the first group up to date
+  if (pIndex < GroupWidth)
+    m_Controls[m_NumOfBuckets + pIndex] = pControl;
+}
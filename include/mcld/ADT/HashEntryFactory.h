@@ -26,6 +26,12 @@ class HashEntryFactory {
     return HashEntryTy::Create(pKey);
   }
 
+  /// produce - create the entry of pKey whose hash value is known. Only the
+  /// entries which cache their hash value provide Create(pKey, pHashValue).
+  entry_type* produce(const key_type& pKey, unsigned int pHashValue) {
+    return HashEntryTy::Create(pKey, pHashValue);
+  }
+
   void destroy(entry_type*& pEntry) { HashEntryTy::Destroy(pEntry); }
 };
 
@@ -70,6 +70,12 @@ class HashTable : public HashTableImpl<HashEntryTy, HashFunctionTy> {
   //  If the element already exists, return the element, and set pExist true.
   entry_type* insert(const key_type& pKey, bool& pExist);
 
+  /// insert - insert pKey whose hash value pHashValue is computed ahead by
+  //  hasher. The entry is produced by the factory with the same hash value.
+  entry_type* insert(const key_type& pKey,
+                     unsigned int pHashValue,
+                     bool& pExist);
+
   /// erase - remove the element with the same key
   size_type erase(const key_type& pKey);
 
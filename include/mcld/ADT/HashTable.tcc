@@ -78,7 +78,40 @@ HashTable<HashEntryTy, HashFunctionTy, EntryFactoryTy>::insert(
   if (bucket_type::getTombstone() == entry)
     --BaseTy::m_NumOfTombstones;
 
-  entry = bucket.Entry = m_EntryFactory.produce(pKey);
+  entry = m_EntryFactory.produce(pKey);
+  BaseTy::fillBucket(index, entry);
+  ++BaseTy::m_NumOfEntries;
+  BaseTy::mayRehash();
+  pExist = false;
+  return entry;
+}
+
+/// insert - insert a new element whose hash value is known. If the element
+//  already exist, return the element.
+template <typename HashEntryTy,
+          typename HashFunctionTy,
+          typename EntryFactoryTy>
+typename HashTable<HashEntryTy, HashFunctionTy, EntryFactoryTy>::entry_type*
+HashTable<HashEntryTy, HashFunctionTy, EntryFactoryTy>::insert(
+    const typename HashTable<HashEntryTy,
+                             HashFunctionTy,
+                             EntryFactoryTy>::key_type& pKey,
+    unsigned int pHashValue,
+    bool& pExist) {
+  unsigned int index = BaseTy::lookUpBucketFor(pKey, pHashValue);
+  bucket_type& bucket = BaseTy::m_Buckets[index];
+  entry_type* entry = bucket.Entry;
+  if (bucket_type::getEmptyBucket() != entry &&
+      bucket_type::getTombstone() != entry) {
+    pExist = true;
+    return entry;
+  }
+
+  if (bucket_type::getTombstone() == entry)
+    --BaseTy::m_NumOfTombstones;
+
+  entry = m_EntryFactory.produce(pKey, pHashValue);
+  BaseTy::fillBucket(index, entry);
   ++BaseTy::m_NumOfEntries;
   BaseTy::mayRehash();
   pExist = false;
@@ -99,9 +132,8 @@ HashTable<HashEntryTy, HashFunctionTy, EntryFactoryTy>::erase(
   if ((index = BaseTy::findKey(pKey)) == -1)
     return 0;
 
-  bucket_type& bucket = BaseTy::m_Buckets[index];
-  m_EntryFactory.destroy(bucket.Entry);
-  bucket.Entry = bucket_type::getTombstone();
+  m_EntryFactory.destroy(BaseTy::m_Buckets[index].Entry);
+  BaseTy::eraseBucket(index);
 
   --BaseTy::m_NumOfEntries;
   ++BaseTy::m_NumOfTombstones;
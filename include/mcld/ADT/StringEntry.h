@@ -9,12 +9,16 @@
 #ifndef MCLD_ADT_STRINGENTRY_H_
 #define MCLD_ADT_STRINGENTRY_H_
 
+#include "mcld/Support/Compiler.h"
+
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Support/DataTypes.h>
 
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <new>
+#include <vector>
 
 namespace mcld {
 template <typename DataType>
@@ -105,6 +109,13 @@ class StringEntry<llvm::StringRef> {
   friend class StringEntryFactory<llvm::StringRef>;
 };
 
+/** \class StringEntryFactory
+ *  \brief StringEntryFactory carves the entries and their keys out of chunks
+ *  owned by the table.
+ *
+ *  Only the entry created last gives its storage back when it is destroyed.
+ *  The other entries are released with the factory, at once.
+ */
 template <typename DataType>
 class StringEntryFactory {
  public:
@@ -118,6 +129,21 @@ class StringEntryFactory {
 
   StringEntry<DataType>* produce(const key_type& pKey);
   void destroy(StringEntry<DataType>* pEntry);
+
+ private:
+  static const size_t ChunkSize = 4096;
+
+  static size_t getEntrySize(size_t pKeyLength);
+
+  void* allocate(size_t pSize);
+
+ private:
+  std::vector<char*> m_Chunks;
+  char* m_pCurrent;
+  char* m_pEnd;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(StringEntryFactory);
 };
 
 #include "StringEntry.tcc"
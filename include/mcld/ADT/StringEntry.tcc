@@ -32,18 +32,53 @@ StringEntry<DataType>::~StringEntry() {
 //===----------------------------------------------------------------------===//
 // StringEntryFactory
 template <typename DataType>
-StringEntryFactory<DataType>::StringEntryFactory() {
+StringEntryFactory<DataType>::StringEntryFactory()
+    : m_pCurrent(NULL), m_pEnd(NULL) {
 }
 
 template <typename DataType>
 StringEntryFactory<DataType>::~StringEntryFactory() {
+  // the table destroys its entries before its factory
+  std::vector<char*>::iterator chunk, cEnd = m_Chunks.end();
+  for (chunk = m_Chunks.begin(); chunk != cEnd; ++chunk)
+    free(*chunk);
+}
+
+template <typename DataType>
+size_t StringEntryFactory<DataType>::getEntrySize(size_t pKeyLength) {
+  const size_t alignment = alignof(StringEntry<DataType>);
+  size_t size = sizeof(StringEntry<DataType>) + pKeyLength + 1;
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+template <typename DataType>
+void* StringEntryFactory<DataType>::allocate(size_t pSize) {
+  if (static_cast<size_t>(m_pEnd - m_pCurrent) < pSize) {
+    // a very long key gets a chunk of its own. The current chunk is kept for
+    // the following entries.
+    if (pSize > ChunkSize / 4) {
+      char* chunk = static_cast<char*>(malloc(pSize));
+      if (chunk != NULL)
+        m_Chunks.push_back(chunk);
+      return chunk;
+    }
+    char* chunk = static_cast<char*>(malloc(ChunkSize));
+    if (chunk == NULL)
+      return NULL;
+    m_Chunks.push_back(chunk);
+    m_pCurrent = chunk;
+    m_pEnd = chunk + ChunkSize;
+  }
+  void* result = m_pCurrent;
+  m_pCurrent += pSize;
+  return result;
 }
 
 template <typename DataType>
 StringEntry<DataType>* StringEntryFactory<DataType>::produce(
     const typename StringEntryFactory<DataType>::key_type& pKey) {
-  StringEntry<DataType>* result = static_cast<StringEntry<DataType>*>(
-      malloc(sizeof(StringEntry<DataType>) + pKey.size() + 1));
+  StringEntry<DataType>* result =
+      static_cast<StringEntry<DataType>*>(allocate(getEntrySize(pKey.size())));
 
   if (result == NULL)
     return NULL;
@@ -58,8 +93,14 @@ StringEntry<DataType>* StringEntryFactory<DataType>::produce(
 
 template <typename DataType>
 void StringEntryFactory<DataType>::destroy(StringEntry<DataType>* pEntry) {
-  if (pEntry != NULL) {
-    pEntry->~StringEntry<DataType>();
-    free(pEntry);
-  }
+  if (pEntry == NULL)
+    return;
+
+  // give back the storage only if pEntry is the last entry in the current
+  // chunk
+  char* entry = reinterpret_cast<char*>(pEntry);
+  size_t size = getEntrySize(pEntry->getKeyLength());
+  pEntry->~StringEntry<DataType>();
+  if (entry + size == m_pCurrent && entry >= m_pEnd - ChunkSize)
+    m_pCurrent = entry;
 }
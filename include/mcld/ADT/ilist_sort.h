@@ -11,72 +11,80 @@
 
 #include <llvm/ADT/ilist.h>
 
+#include <algorithm>
 #include <functional>
-#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace mcld {
 
 namespace detail {
 
-template <typename T, typename Alloc, typename Comparator>
-void sort(llvm::iplist<T, Alloc>& xs, size_t size, Comparator is_less_than) {
-  typedef llvm::iplist<T, Alloc> iplist;
-  typedef typename iplist::iterator iterator;
-
-  assert(xs.size() == size && "Incorrect list size argument");
-
-  // Special cases for induction basis.
-  switch (size) {
-    case 0:
-    case 1: {
-      return;
-    }
-    case 2: {
-      iterator first = xs.begin();
-      iterator second = xs.begin();
-      ++second;
-      if (is_less_than(*second, *first)) {
-        xs.splice(first, xs, second);
-      }
-      return;
-    }
-  }
-
-  // Split the input linked list.
-  size_t mid = size / 2;
-  iterator mid_iter(xs.begin());
-  std::advance(mid_iter, mid);
-
-  iplist ys;
-  ys.splice(ys.begin(), xs, mid_iter, xs.end());
-
-  // Sort the xs and ys recursively.
-  sort(xs, mid, is_less_than);
-  sort(ys, size - mid, is_less_than);
-
-  // Merge two sorted linked lists.
-  iterator xs_it = xs.begin();
-  iterator xs_end = xs.end();
-  iterator ys_it = ys.begin();
-  iterator ys_end = ys.end();
-
-  while (xs_it != xs_end && ys_it != ys_end) {
-    if (is_less_than(*ys_it, *xs_it)) {
-      xs.splice(xs_it, ys, ys_it++);
-    } else {
-      ++xs_it;
-    }
-  }
-
-  xs.splice(xs_end, ys, ys_it, ys_end);
+template <typename T, typename Comparator>
+class NodeLess {
+ public:
+  explicit NodeLess(Comparator& pIsLessThan) : m_IsLessThan(pIsLessThan) {}
+
+  bool operator()(T* pX, T* pY) const { return m_IsLessThan(*pX, *pY); }
+
+ private:
+  Comparator& m_IsLessThan;
+};
+
+template <typename Key, typename T>
+bool isKeyLess(const std::pair<Key, T*>& pX, const std::pair<Key, T*>& pY) {
+  return pX.first < pY.first;
 }
 
 }  // namespace detail
 
+/// sort - stable sort the list. The nodes are sorted as an array of pointers
+/// and relinked in one pass, instead of being merged list by list.
 template <typename T, typename Alloc, typename Comparator = std::less<T> >
 void sort(llvm::iplist<T, Alloc>& list,
           Comparator is_less_than = Comparator()) {
-  detail::sort(list, list.size(), is_less_than);
+  if (list.empty() || &list.front() == &list.back())
+    return;
+
+  std::vector<T*> nodes;
+  nodes.reserve(list.size());
+  typedef typename llvm::iplist<T, Alloc>::iterator iterator;
+  iterator it, itEnd = list.end();
+  for (it = list.begin(); it != itEnd; ++it)
+    nodes.push_back(&*it);
+
+  std::stable_sort(nodes.begin(),
+                   nodes.end(),
+                   detail::NodeLess<T, Comparator>(is_less_than));
+
+  llvm::iplist<T, Alloc> sorted;
+  for (size_t i = 0; i < nodes.size(); ++i)
+    sorted.splice(sorted.end(), list, iterator(nodes[i]));
+  list.splice(list.end(), sorted);
+}
+
+/// sortByKey - stable sort the list by pKeyOf(node). The key of each node is
+/// computed once, which pays off when the comparison has to look it up.
+template <typename T, typename Alloc, typename KeyFunc>
+void sortByKey(llvm::iplist<T, Alloc>& list, KeyFunc pKeyOf) {
+  if (list.empty() || &list.front() == &list.back())
+    return;
+
+  typedef typename std::decay<decltype(pKeyOf(list.front()))>::type Key;
+  std::vector<std::pair<Key, T*> > nodes;
+  nodes.reserve(list.size());
+  typedef typename llvm::iplist<T, Alloc>::iterator iterator;
+  iterator it, itEnd = list.end();
+  for (it = list.begin(); it != itEnd; ++it)
+    nodes.push_back(std::make_pair(pKeyOf(*it), &*it));
+
+  std::stable_sort(nodes.begin(), nodes.end(), detail::isKeyLess<Key, T>);
+
+  llvm::iplist<T, Alloc> sorted;
+  for (size_t i = 0; i < nodes.size(); ++i)
+    sorted.splice(sorted.end(), list, iterator(nodes[i].second));
+  list.splice(list.end(), sorted);
 }
 
 }  // namespace mcld
@@ -35,6 +35,17 @@ class Fragment : public llvm::ilist_node_with_parent<Fragment, SectionData> {
 
   virtual ~Fragment();
 
+  /// operator new - fragments are carved out of a shared arena instead of
+  /// the global heap. The storage of a deleted fragment is reused by the next
+  /// fragment of the same size class.
+  static void* operator new(size_t pSize);
+
+  static void operator delete(void* pPtr, size_t pSize);
+
+  /// Clear - release the storage of all fragments at once. No fragment may be
+  /// touched afterwards.
+  static void Clear();
+
   Type getKind() const { return m_Kind; }
 
   const SectionData* getParent() const { return m_pParent; }
@@ -48,6 +59,17 @@ class Fragment : public llvm::ilist_node_with_parent<Fragment, SectionData> {
 
   bool hasOffset() const;
 
+  /// getAlign - the alignment of the offset. The first fragment of an input
+  /// section moved into an output section carries the input alignment, and
+  /// the padding before it is filled with zeros when emitted.
+  uint32_t getAlign() const { return m_Align; }
+
+  void setAlign(uint32_t pAlign) { m_Align = pAlign; }
+
+  /// alignOffset - the offset of the fragment if the previous one ends at
+  /// pOffset
+  uint64_t alignOffset(uint64_t pOffset) const;
+
   static bool classof(const Fragment* O) { return true; }
 
   virtual size_t size() const {
@@ -58,6 +80,8 @@ class Fragment : public llvm::ilist_node_with_parent<Fragment, SectionData> {
  private:
   Type m_Kind;
 
+  uint32_t m_Align;
+
   SectionData* m_pParent;
 
   uint64_t m_Offset;
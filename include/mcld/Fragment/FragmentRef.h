@@ -14,6 +14,13 @@
 #include "mcld/Config/Config.h"
 #include "mcld/Support/Allocators.h"
 
+/// MCLD_COMPACT_FRAGMENT_REF - keep the offset of a FragmentRef in 32 bits
+/// and pack the reference into 12 bytes. Build with
+/// -DMCLD_COMPACT_FRAGMENT_REF=0 to link a fragment larger than 4GB.
+#ifndef MCLD_COMPACT_FRAGMENT_REF
+#define MCLD_COMPACT_FRAGMENT_REF 1
+#endif
+
 namespace mcld {
 
 class Fragment;
@@ -23,7 +30,14 @@ class Layout;
 /** \class FragmentRef
  *  \brief FragmentRef is a reference of a Fragment's contetnt.
  *
+ *  Every defined symbol has a FragmentRef and every Relocation embeds one.
+ *  The offset is relative to the fragment, so it fits in 32 bits unless a
+ *  single fragment is larger than 4GB, and the compact reference is only
+ *  aligned to 4 bytes. A Relocation places it next to its 32-bit type.
  */
+#if MCLD_COMPACT_FRAGMENT_REF
+#pragma pack(push, 4)
+#endif
 class FragmentRef {
  public:
   typedef uint64_t Offset;  // FIXME: use SizeTraits<T>::Offset
@@ -83,10 +97,17 @@ class FragmentRef {
  private:
   Fragment* m_pFragment;
 
+#if MCLD_COMPACT_FRAGMENT_REF
+  uint32_t m_Offset;
+#else
   Offset m_Offset;
+#endif
 
   static FragmentRef g_NullFragmentRef;
 };
+#if MCLD_COMPACT_FRAGMENT_REF
+#pragma pack(pop)
+#endif
 
 }  // namespace mcld
 
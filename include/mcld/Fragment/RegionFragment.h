@@ -27,6 +27,8 @@ class RegionFragment : public Fragment {
   const llvm::StringRef getRegion() const { return m_Region; }
   llvm::StringRef getRegion() { return m_Region; }
 
+  void setRegion(llvm::StringRef pRegion) { m_Region = pRegion; }
+
   static bool classof(const Fragment* F) {
     return F->getKind() == Fragment::Region;
   }
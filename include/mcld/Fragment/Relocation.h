@@ -109,15 +109,16 @@ class Relocation : public llvm::ilist_node<Relocation> {
   /// m_Type - the type of the relocation entries
   Type m_Type;
 
+  /// m_TargetAddress - FragmentRef of the place being relocated. A compact
+  /// FragmentRef fills the padding after m_Type.
+  FragmentRef m_TargetAddress;
+
   /// m_TargetData - target data of the place being relocated
   DWord m_TargetData;
 
   /// m_pSymInfo - resolved symbol info of relocation target symbol
   ResolveInfo* m_pSymInfo;
 
-  /// m_TargetAddress - FragmentRef of the place being relocated
-  FragmentRef m_TargetAddress;
-
   /// m_Addend - the addend
   Address m_Addend;
 };
@@ -75,6 +75,12 @@ class Stub : public Fragment {
     return false;
   }
 
+  /// getDutyTypes - append the relocation types which isMyDuty may accept
+  /// @return false if isMyDuty may accept any type of relocation
+  virtual bool getDutyTypes(std::vector<Type>& pTypes) const {
+    return false;
+  }
+
   /// name - name of this stub
   virtual const std::string& name() const = 0;
 
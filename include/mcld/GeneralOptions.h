@@ -41,6 +41,32 @@ class GeneralOptions {
     Both = 0x3
   };
 
+  enum class HashOptimize : uint8_t {
+    Unknown,
+    None,
+    Lookup
+  };
+
+  enum class BuildID : uint8_t {
+    Unknown,
+    None,
+    Fast,
+    SHA1,
+    UUID
+  };
+
+  enum class CompressDebugSections : uint8_t {
+    Unknown,
+    None,
+    Zlib
+  };
+
+  enum class OutputMode : uint8_t {
+    Unknown,
+    MMap,
+    Stream
+  };
+
   enum class ICF {
     Unknown,
     None,
@@ -48,6 +74,13 @@ class GeneralOptions {
     Safe
   };
 
+  enum class SortCommon : uint8_t {
+    Unknown,
+    None,
+    Ascending,
+    Descending
+  };
+
   typedef std::vector<std::string> RpathList;
   typedef RpathList::iterator rpath_iterator;
   typedef RpathList::const_iterator const_rpath_iterator;
@@ -75,10 +108,23 @@ class GeneralOptions {
 
   bool trace() const { return m_bTrace; }
 
+  /// traceBufferSize - the block in which the output of --trace,
+  /// --print-gc-sections and --print-icf-sections is gathered before it is
+  /// written (--trace-buffer-size=N)
+  size_t traceBufferSize() const { return m_TraceBufferSize; }
+
+  void setTraceBufferSize(size_t pSize) { m_TraceBufferSize = pSize; }
+
   void setBsymbolic(bool pBsymbolic = true) { m_Bsymbolic = pBsymbolic; }
 
   bool Bsymbolic() const { return m_Bsymbolic; }
 
+  void setBsymbolicFunctions(bool pEnable = true) {
+    m_BsymbolicFunctions = pEnable;
+  }
+
+  bool BsymbolicFunctions() const { return m_BsymbolicFunctions; }
+
   void setPIE(bool pPIE = true) { m_bPIE = pPIE; }
 
   bool isPIE() const { return m_bPIE; }
@@ -166,6 +212,12 @@ class GeneralOptions {
 
   bool hasOrigin() const { return m_bOrigin; }
 
+  bool hasPackRelativeRelocs() const { return m_bPackRelativeRelocs; }
+
+  bool hasHugePageText() const { return m_bHugePageText; }
+
+  bool hasSeparateCode() const { return m_bSeparateCode; }
+
   uint64_t commPageSize() const { return m_CommPageSize; }
 
   uint64_t maxPageSize() const { return m_MaxPageSize; }
@@ -232,6 +284,13 @@ class GeneralOptions {
 
   bool printMap() const { return m_bPrintMap; }
 
+  // -Map=file
+  const std::string& getMapFile() const { return m_MapFile; }
+
+  void setMapFile(const std::string& pFile) { m_MapFile = pFile; }
+
+  bool hasMapFile() const { return !m_MapFile.empty(); }
+
   void setWarnMismatch(bool pEnable = true) { m_bWarnMismatch = pEnable; }
 
   bool warnMismatch() const { return m_bWarnMismatch; }
@@ -246,6 +305,11 @@ class GeneralOptions {
 
   bool getPrintGCSections() const { return m_bPrintGCSections; }
 
+  // --split-text-for-gc
+  void setSplitTextForGC(bool pEnable = true) { m_bSplitTextForGC = pEnable; }
+
+  bool splitTextForGC() const { return m_bSplitTextForGC; }
+
   // --ld-generated-unwind-info
   void setGenUnwindInfo(bool pEnable = true) { m_bGenUnwindInfo = pEnable; }
 
@@ -263,6 +327,58 @@ class GeneralOptions {
 
   void setHashStyle(HashStyle pStyle) { m_HashStyle = pStyle; }
 
+  // --hash-optimize=none|lookup
+  HashOptimize getHashOptimize() const { return m_HashOptimize; }
+
+  void setHashOptimize(HashOptimize pMode) { m_HashOptimize = pMode; }
+
+  // --hash-optimize-budget=N, the number of .gnu.hash layouts to evaluate
+  unsigned hashOptimizeBudget() const { return m_HashOptimizeBudget; }
+
+  void setHashOptimizeBudget(unsigned pBudget) {
+    m_HashOptimizeBudget = pBudget;
+  }
+
+  // --build-id, --build-id=none|fast|sha1|uuid
+  BuildID getBuildID() const { return m_BuildID; }
+
+  void setBuildID(BuildID pStyle) { m_BuildID = pStyle; }
+
+  bool hasBuildID() const {
+    return (m_BuildID != BuildID::Unknown) && (m_BuildID != BuildID::None);
+  }
+
+  // --compress-debug-sections=none|zlib
+  CompressDebugSections getCompressDebugSections() const {
+    return m_CompressDebugSections;
+  }
+
+  void setCompressDebugSections(CompressDebugSections pFormat) {
+    m_CompressDebugSections = pFormat;
+  }
+
+  bool hasCompressDebugSections() const {
+    return (m_CompressDebugSections != CompressDebugSections::Unknown) &&
+           (m_CompressDebugSections != CompressDebugSections::None);
+  }
+
+  // --gdb-index
+  void setGdbIndex(bool pEnable = true) { m_bGdbIndex = pEnable; }
+
+  bool hasGdbIndex() const { return m_bGdbIndex; }
+
+  // --sort-relocations
+  void setSortRelocations(bool pEnable = true) {
+    m_bSortRelocations = pEnable;
+  }
+
+  bool sortRelocations() const { return m_bSortRelocations; }
+
+  // --output-mode=mmap|stream
+  OutputMode getOutputMode() const { return m_OutputMode; }
+
+  void setOutputMode(OutputMode pMode) { m_OutputMode = pMode; }
+
   ICF getICFMode() const { return m_ICF; }
 
   void setICFMode(ICF pMode) { m_ICF = pMode; }
@@ -273,10 +389,195 @@ class GeneralOptions {
 
   bool printICFSections() const { return m_bPrintICFSections; }
 
+  // --sort-common[=ascending|descending]
+  SortCommon getSortCommon() const { return m_SortCommon; }
+
+  void setSortCommon(SortCommon pOrder) { m_SortCommon = pOrder; }
+
   void setPrintICFSections(bool pPrintICFSections = true) {
     m_bPrintICFSections = pPrintICFSections;
   }
 
+  // --threads=N
+  unsigned numThreads() const { return m_NumThreads; }
+
+  void setNumThreads(unsigned pNum) { m_NumThreads = pNum; }
+
+  // --pack-dyn-relocs=relr, -z pack-relative-relocs
+  void setPackRelativeRelocs(bool pEnable = true) {
+    m_bPackRelativeRelocs = pEnable;
+  }
+
+  // --pack-dyn-relocs=android
+  void setPackAndroidRelocs(bool pEnable = true) {
+    m_bPackAndroidRelocs = pEnable;
+  }
+
+  bool hasPackAndroidRelocs() const { return m_bPackAndroidRelocs; }
+
+  // --fsync-output
+  void setFsyncOutput(bool pEnable = true) { m_bFsyncOutput = pEnable; }
+
+  bool fsyncOutput() const { return m_bFsyncOutput; }
+
+  // --incremental
+  void setIncremental(bool pEnable = true) { m_bIncremental = pEnable; }
+
+  bool incremental() const { return m_bIncremental; }
+
+  // --time-trace, --time-trace-file=file
+  void setTimeTrace(bool pEnable = true) { m_bTimeTrace = pEnable; }
+
+  bool hasTimeTrace() const { return m_bTimeTrace; }
+
+  /// getTimeTraceFile - the trace file. If it is empty, the trace is written
+  /// to <output>.time-trace.json.
+  const std::string& getTimeTraceFile() const { return m_TimeTraceFile; }
+
+  void setTimeTraceFile(const std::string& pFile) { m_TimeTraceFile = pFile; }
+
+  // --print-stats
+  void setPrintStats(bool pEnable = true) { m_bPrintStats = pEnable; }
+
+  bool printStats() const { return m_bPrintStats; }
+
+  // --print-memory-usage
+  void setPrintMemoryUsage(bool pEnable = true) {
+    m_bPrintMemoryUsage = pEnable;
+  }
+
+  bool printMemoryUsage() const { return m_bPrintMemoryUsage; }
+
+  // --verify-determinism
+  void setVerifyDeterminism(bool pEnable = true) {
+    m_bVerifyDeterminism = pEnable;
+  }
+
+  bool verifyDeterminism() const { return m_bVerifyDeterminism; }
+
+  // --prelink-base=addr
+  void setPrelinkBase(uint64_t pBase) {
+    m_bPrelink = true;
+    m_PrelinkBase = pBase;
+  }
+
+  bool hasPrelinkBase() const { return m_bPrelink; }
+
+  /// prelinkBase - the address the shared object is laid out and resolved at
+  uint64_t prelinkBase() const { return m_PrelinkBase; }
+
+  // --reproduce=file.tar
+  const std::string& getReproduceFile() const { return m_ReproduceFile; }
+
+  void setReproduceFile(const std::string& pFile) { m_ReproduceFile = pFile; }
+
+  bool hasReproduce() const { return !m_ReproduceFile.empty(); }
+
+  // --script-cache=dir
+  const std::string& getScriptCacheDir() const { return m_ScriptCacheDir; }
+
+  void setScriptCacheDir(const std::string& pDir) { m_ScriptCacheDir = pDir; }
+
+  bool hasScriptCache() const { return !m_ScriptCacheDir.empty(); }
+
+  // --dso-cache=dir
+  const std::string& getDSOCacheDir() const { return m_DSOCacheDir; }
+
+  void setDSOCacheDir(const std::string& pDir) { m_DSOCacheDir = pDir; }
+
+  bool hasDSOCache() const { return !m_DSOCacheDir.empty(); }
+
+  // --thinlto-cache-dir=dir
+  const std::string& getLTOCacheDir() const { return m_LTOCacheDir; }
+
+  void setLTOCacheDir(const std::string& pDir) { m_LTOCacheDir = pDir; }
+
+  // --size-report=file
+  const std::string& getSizeReportFile() const { return m_SizeReportFile; }
+
+  void setSizeReportFile(const std::string& pFile) {
+    m_SizeReportFile = pFile;
+  }
+
+  bool hasSizeReport() const { return !m_SizeReportFile.empty(); }
+
+  // --dwp=file
+  const std::string& getDwpFile() const { return m_DwpFile; }
+
+  void setDwpFile(const std::string& pFile) { m_DwpFile = pFile; }
+
+  bool hasDwp() const { return !m_DwpFile.empty(); }
+
+  // --symbol-ordering-file=file
+  const std::string& getSymbolOrderingFile() const {
+    return m_SymbolOrderingFile;
+  }
+
+  void setSymbolOrderingFile(const std::string& pFile) {
+    m_SymbolOrderingFile = pFile;
+  }
+
+  bool hasSymbolOrderingFile() const { return !m_SymbolOrderingFile.empty(); }
+
+  // --call-graph-ordering-file=file
+  const std::string& getCallGraphOrderingFile() const {
+    return m_CallGraphOrderingFile;
+  }
+
+  void setCallGraphOrderingFile(const std::string& pFile) {
+    m_CallGraphOrderingFile = pFile;
+  }
+
+  // --[no-]call-graph-profile-sort
+  void setCallGraphProfileSort(bool pEnable = true) {
+    m_bCallGraphProfileSort = pEnable;
+  }
+
+  bool callGraphProfileSort() const { return m_bCallGraphProfileSort; }
+
+  // --data-ordering-file=file
+  const std::string& getDataOrderingFile() const { return m_DataOrderingFile; }
+
+  void setDataOrderingFile(const std::string& pFile) {
+    m_DataOrderingFile = pFile;
+  }
+
+  bool hasDataOrderingFile() const { return !m_DataOrderingFile.empty(); }
+
+  // --separate-written-data
+  void setSeparateWrittenData(bool pEnable = true) {
+    m_bSeparateWrittenData = pEnable;
+  }
+
+  bool separateWrittenData() const { return m_bSeparateWrittenData; }
+
+  // --lazy-dso-symbols
+  void setLazyDSOSymbols(bool pEnable = true) { m_bLazyDSOSymbols = pEnable; }
+
+  bool lazyDSOSymbols() const { return m_bLazyDSOSymbols; }
+
+  // --version-script=file
+  const std::string& getVersionScript() const { return m_VersionScript; }
+
+  void setVersionScript(const std::string& pFile) { m_VersionScript = pFile; }
+
+  bool hasVersionScript() const { return !m_VersionScript.empty(); }
+
+  // --dynamic-list=file
+  const std::string& getDynamicList() const { return m_DynamicList; }
+
+  void setDynamicList(const std::string& pFile) { m_DynamicList = pFile; }
+
+  bool hasDynamicList() const { return !m_DynamicList.empty(); }
+
+  /// getReproduceArgs - the arguments of the link, with the paths rewritten
+  /// to the ones in the reproduce archive
+  const std::vector<std::string>& getReproduceArgs() const {
+    return m_ReproduceArgs;
+  }
+
+  std::vector<std::string>& getReproduceArgs() { return m_ReproduceArgs; }
+
   // -----  link-in rpath  ----- //
   const RpathList& getRpathList() const { return m_RpathList; }
   RpathList& getRpathList() { return m_RpathList; }
@@ -359,8 +660,12 @@ class GeneralOptions {
   bool m_bRelro : 1;         // relro, norelro
   bool m_bNow : 1;           // lazy, now
   bool m_bOrigin : 1;        // origin
+  bool m_bPackRelativeRelocs : 1;  // pack-relative-relocs
+  bool m_bHugePageText : 1;  // hugepage-text
+  bool m_bSeparateCode : 1;  // separate-code, noseparate-code
   bool m_bTrace : 1;         // --trace
   bool m_Bsymbolic : 1;      // --Bsymbolic
+  bool m_BsymbolicFunctions : 1;  // -Bsymbolic-functions
   bool m_Bgroup : 1;
   bool m_bPIE : 1;
   bool m_bColor : 1;              // --color[=true,false,auto]
@@ -379,16 +684,53 @@ class GeneralOptions {
   bool m_bWarnMismatch : 1;       // --no-warn-mismatch
   bool m_bGCSections : 1;         // --gc-sections
   bool m_bPrintGCSections : 1;    // --print-gc-sections
+  bool m_bSplitTextForGC : 1;     // --split-text-for-gc
   bool m_bGenUnwindInfo : 1;      // --ld-generated-unwind-info
   bool m_bPrintICFSections : 1;   // --print-icf-sections
+  bool m_bPackAndroidRelocs : 1;  // --pack-dyn-relocs=android
+  bool m_bFsyncOutput : 1;        // --fsync-output
+  bool m_bIncremental : 1;        // --incremental
+  bool m_bTimeTrace : 1;          // --time-trace
+  bool m_bPrintStats : 1;         // --print-stats
+  bool m_bCallGraphProfileSort : 1;  // --[no-]call-graph-profile-sort
+  bool m_bSeparateWrittenData : 1;   // --separate-written-data
+  bool m_bLazyDSOSymbols : 1;        // --lazy-dso-symbols
+  bool m_bGdbIndex : 1;              // --gdb-index
+  bool m_bSortRelocations : 1;       // --sort-relocations
+  bool m_bPrintMemoryUsage : 1;      // --print-memory-usage
+  bool m_bVerifyDeterminism : 1;     // --verify-determinism
+  bool m_bPrelink : 1;               // --prelink-base=addr
   ICF m_ICF;
   size_t m_ICFIterations;
+  unsigned m_NumThreads;  // --threads=N
+  size_t m_TraceBufferSize;  // --trace-buffer-size=N
+  uint64_t m_PrelinkBase;    // --prelink-base=addr
   StripSymbolMode m_StripSymbols;
   RpathList m_RpathList;
   ScriptList m_ScriptList;
   UndefSymList m_UndefSymList;  // -u [symbol], --undefined [symbol]
   HashStyle m_HashStyle;
+  HashOptimize m_HashOptimize;
+  unsigned m_HashOptimizeBudget;
+  BuildID m_BuildID;
+  CompressDebugSections m_CompressDebugSections;
+  OutputMode m_OutputMode;
+  SortCommon m_SortCommon;
   std::string m_Filter;
+  std::string m_TimeTraceFile;
+  std::string m_ReproduceFile;
+  std::string m_ScriptCacheDir;
+  std::string m_DSOCacheDir;
+  std::string m_LTOCacheDir;  // --thinlto-cache-dir=dir
+  std::string m_MapFile;
+  std::string m_SizeReportFile;
+  std::string m_DwpFile;
+  std::string m_SymbolOrderingFile;
+  std::string m_CallGraphOrderingFile;
+  std::string m_DataOrderingFile;
+  std::string m_VersionScript;
+  std::string m_DynamicList;
+  std::vector<std::string> m_ReproduceArgs;
   AuxiliaryList m_AuxiliaryList;
   ExcludeLIBS m_ExcludeLIBS;
 };
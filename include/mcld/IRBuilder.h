@@ -27,8 +27,13 @@
 #include "mcld/Support/FileHandle.h"
 #include "mcld/Support/Path.h"
 
+#include <string>
+#include <unordered_set>
+#include <vector>
+
 namespace mcld {
 
+class ELFDynObjIndex;
 class InputTree;
 class LinkerConfig;
 class Module;
@@ -384,7 +389,24 @@ class IRBuilder {
   /// @return The added symbol. If the insertion fails due to the resoluction,
   /// return NULL.
   LDSymbol* AddSymbol(Input& pInput,
-                      const std::string& pName,
+                      const llvm::StringRef& pName,
+                      ResolveInfo::Type pType,
+                      ResolveInfo::Desc pDesc,
+                      ResolveInfo::Binding pBind,
+                      ResolveInfo::SizeType pSize,
+                      LDSymbol::ValueType pValue = 0x0,
+                      LDSection* pSection = NULL,
+                      ResolveInfo::Visibility pVis = ResolveInfo::Default);
+
+  /// AddSymbol - To add a symbol to the input file. pHashValue is the hash
+  /// value of pName by ResolveInfo::hasher, computed ahead of time, e.g. when
+  /// the symbol tables are decoded concurrently. It is ignored for the local
+  /// symbols, and recomputed if the symbol is renamed. pName is not copied
+  /// until the name pool stores it, so it may point into the string table
+  /// of pInput.
+  LDSymbol* AddSymbol(Input& pInput,
+                      const llvm::StringRef& pName,
+                      uint32_t pHashValue,
                       ResolveInfo::Type pType,
                       ResolveInfo::Desc pDesc,
                       ResolveInfo::Binding pBind,
@@ -458,8 +480,17 @@ class IRBuilder {
   /// symbols should be force to local symbols
   bool shouldForceLocal(const ResolveInfo& pInfo, const LinkerConfig& pConfig);
 
+  /// AddLazyDynObj - add the symbols of a shared object in pIndex when their
+  /// names are seen by the link. The names seen so far are looked up at once.
+  /// IRBuilder takes the ownership of pIndex.
+  void AddLazyDynObj(ELFDynObjIndex* pIndex);
+
  private:
-  LDSymbol* addSymbolFromObject(const std::string& pName,
+  /// addLazySymbols - look up pNames in all lazy shared objects in order
+  void addLazySymbols(std::vector<std::string>& pNames);
+
+  LDSymbol* addSymbolFromObject(const llvm::StringRef& pName,
+                                uint32_t pHashValue,
                                 ResolveInfo::Type pType,
                                 ResolveInfo::Desc pDesc,
                                 ResolveInfo::Binding pBinding,
@@ -469,7 +500,8 @@ class IRBuilder {
                                 ResolveInfo::Visibility pVisibility);
 
   LDSymbol* addSymbolFromDynObj(Input& pInput,
-                                const std::string& pName,
+                                const llvm::StringRef& pName,
+                                uint32_t pHashValue,
                                 ResolveInfo::Type pType,
                                 ResolveInfo::Desc pDesc,
                                 ResolveInfo::Binding pBinding,
@@ -482,6 +514,15 @@ class IRBuilder {
   const LinkerConfig& m_Config;
 
   InputBuilder m_InputBuilder;
+
+  std::vector<ELFDynObjIndex*> m_LazyDynObjs;
+  bool m_bAddingLazySymbols;
+
+  /// m_RenameHashes - the ResolveInfo hash values of the names renamed by
+  /// --wrap and --portable, built from the first m_NumOfRenames entries of
+  /// the rename map. A symbol whose hash is not in the set is not renamed.
+  std::unordered_set<uint32_t> m_RenameHashes;
+  size_t m_NumOfRenames;
 };
 
 template <>
@@ -15,6 +15,8 @@
 #include "mcld/ADT/StringHash.h"
 #include "mcld/Support/GCFactory.h"
 
+#include <llvm/ADT/StringRef.h>
+
 #include <string>
 #include <vector>
 
@@ -23,6 +25,7 @@ namespace mcld {
 class Input;
 class InputBuilder;
 class InputFactory;
+class ThreadPool;
 
 /** \class Archive
  *  \brief This class define the interfacee to Archive files
@@ -94,13 +97,15 @@ class Archive {
    public:
     enum Status { Include, Exclude, Unknown };
 
-    Symbol(const char* pName, uint32_t pOffset, enum Status pStatus)
+    Symbol(const llvm::StringRef& pName, uint32_t pOffset, enum Status pStatus)
         : name(pName), fileOffset(pOffset), status(pStatus) {}
 
     ~Symbol() {}
 
    public:
-    std::string name;
+    /// name - refers to the armap of the archive, which stays mapped for the
+    /// whole link.
+    llvm::StringRef name;
     uint32_t fileOffset;
     enum Status status;
   };
@@ -179,15 +184,19 @@ class Archive {
   /// numOfSymbols - return the number of symbols in symtab
   size_t numOfSymbols() const;
 
+  /// reserveSymbols - make room for pNumOfSymbols symtab entries
+  void reserveSymbols(size_t pNumOfSymbols);
+
   /// addSymbol - add a symtab entry to symtab
-  /// @param pName - symbol name
+  /// @param pName - symbol name. The string is not copied and must outlive
+  ///                the archive.
   /// @param pFileOffset - file offset in symtab represents a object file
-  void addSymbol(const char* pName,
+  void addSymbol(const llvm::StringRef& pName,
                  uint32_t pFileOffset,
                  enum Symbol::Status pStatus = Archive::Symbol::Unknown);
 
   /// getSymbolName - get the symbol name with the given index
-  const std::string& getSymbolName(size_t pSymIdx) const;
+  llvm::StringRef getSymbolName(size_t pSymIdx) const;
 
   /// getObjFileOffset - get the file offset that represent a object file
   uint32_t getObjFileOffset(size_t pSymIdx) const;
@@ -219,6 +228,11 @@ class Archive {
                        const sys::fs::Path& pPath,
                        off_t pFileOffset = 0);
 
+  /// prefetchMemberFiles - read the member files of a thin archive at pPaths
+  /// on pPool before getMemberFile() opens them one by one
+  void prefetchMemberFiles(const std::vector<sys::fs::Path>& pPaths,
+                           ThreadPool& pPool);
+
  private:
   typedef GCFactory<Symbol, 0> SymbolFactory;
 
@@ -118,10 +118,8 @@ class BranchIsland {
 
     struct Hash {
       size_t operator()(const Key& KEY) const {
-        llvm::StringRef sym_name(KEY.symbol()->name());
-        hash::StringHash<hash::DJB> str_hasher;
-        return (size_t((uintptr_t)KEY.prototype())) ^ str_hasher(sym_name) ^
-               KEY.addend();
+        return (size_t((uintptr_t)KEY.prototype())) ^
+               KEY.symbol()->resolveInfo()->hashValue() ^ KEY.addend();
       }
     };
 
@@ -12,12 +12,16 @@
 #include "mcld/LD/BranchIsland.h"
 #include "mcld/Support/GCFactory.h"
 
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/Support/DataTypes.h>
 
+#include <vector>
+
 namespace mcld {
 
 class Fragment;
 class Module;
+class SectionData;
 
 /** \class BranchIslandFactory
  *  \brief
@@ -48,10 +52,27 @@ class BranchIslandFactory : public GCFactory<BranchIsland, 0> {
   /// @return - return the pair of <fwd island, bwd island>
   std::pair<BranchIsland*, BranchIsland*> getIslands(const Fragment& pFragment);
 
+  /// findStub - find a stub built from pPrototype for pReloc in any island of
+  /// the section of pReloc, if the branch of pReloc can reach it
+  /// @return - the stub in the nearest island, or NULL
+  Stub* findStub(const Stub* pPrototype, const Relocation& pReloc) const;
+
+ private:
+  typedef std::vector<BranchIsland*> IslandList;
+
+ private:
+  /// isReachable - check if a branch at pPlace reaches pStub
+  bool isReachable(int64_t pPlace, const Stub& pStub) const;
+
  private:
   int64_t m_MaxFwdBranchRange;
   int64_t m_MaxBwdBranchRange;
   size_t m_MaxIslandSize;
+
+  /// m_Islands - the islands of each SectionData. The islands are produced
+  /// from the front to the back of a SectionData, so each list stays sorted
+  /// by the offset even when the fragments move.
+  llvm::DenseMap<const SectionData*, IslandList> m_Islands;
 };
 
 }  // namespace mcld
@@ -0,0 +1,80 @@
+//===- BuildIDNote.h ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_BUILDIDNOTE_H_
+#define MCLD_LD_BUILDIDNOTE_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/Support/DataTypes.h>
+
+#include <cstddef>
+
+namespace mcld {
+
+class FileOutputBuffer;
+class LDSection;
+class LinkerConfig;
+class ThreadPool;
+
+/** \class BuildIDNote
+ *  \brief BuildIDNote represents the .note.gnu.build-id section.
+ *
+ *  .note.gnu.build-id section format
+ *  uint32_t : namesz, 4
+ *  uint32_t : descsz, the size of the build ID
+ *  uint32_t : type, NT_GNU_BUILD_ID
+ *  char[4]  : name, "GNU\0"
+ *  uint8_t[descsz] : the build ID
+ *
+ *  The fast and sha1 build IDs are computed over the whole output file, with
+ *  the build ID itself zeroed. The file is cut into chunks that are hashed in
+ *  parallel, and the build ID is the hash of the chunk hashes.
+ */
+class BuildIDNote {
+ public:
+  BuildIDNote(LDSection& pSection, const LinkerConfig& pConfig);
+
+  ~BuildIDNote();
+
+  /// sizeOutput - base on the style of the build ID to size output
+  void sizeOutput();
+
+  /// emitOutput - write out the note. This has to be the last write to
+  /// pOutput, since the build ID covers the whole file.
+  void emitOutput(FileOutputBuffer& pOutput, ThreadPool& pPool);
+
+ private:
+  /// getDescSize - the size of the build ID
+  size_t getDescSize() const;
+
+  /// computeHash - hash pSize bytes of pData into pDesc
+  void computeHash(const uint8_t* pData,
+                   size_t pSize,
+                   uint8_t* pDesc,
+                   ThreadPool& pPool) const;
+
+  /// computeUUID - fill pDesc with a random UUID
+  void computeUUID(uint8_t* pDesc) const;
+
+  /// write32 - write pValue to pPlace in the target byte order
+  void write32(uint8_t* pPlace, uint32_t pValue) const;
+
+ private:
+  /// .note.gnu.build-id section
+  LDSection& m_Section;
+
+  const LinkerConfig& m_Config;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BuildIDNote);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_BUILDIDNOTE_H_
@@ -0,0 +1,84 @@
+//===- CallGraphSort.h ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_CALLGRAPHSORT_H_
+#define MCLD_LD_CALLGRAPHSORT_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <vector>
+
+namespace mcld {
+
+class LDSection;
+
+/** \class CallGraphSort
+ *  \brief CallGraphSort orders the code sections by a weighted call graph.
+ *
+ *  It follows the C3 heuristic of "Optimizing Function Placement for
+ *  Large-Scale Data-Center Applications" (Ottoni and Maher, CGO 2017). Every
+ *  section starts in a cluster of its own. From the densest cluster down, a
+ *  cluster is appended to the cluster of its most likely caller, unless the
+ *  cluster would grow too large or too sparse. The clusters are then laid
+ *  out by density.
+ *
+ *  The clusters are kept in arrays and linked by index, so that the sort
+ *  stays linear in the number of sections apart from the two sorts by
+ *  density.
+ */
+class CallGraphSort {
+ public:
+  CallGraphSort();
+
+  ~CallGraphSort();
+
+  /// addEdge - the code of pFrom calls into pTo pWeight times
+  void addEdge(const LDSection& pFrom, const LDSection& pTo, uint64_t pWeight);
+
+  /// sort - the sections of the graph in the order of their layout
+  void sort(std::vector<const LDSection*>& pOrder);
+
+  bool empty() const { return m_Sections.empty(); }
+
+ private:
+  /// Cluster - a run of sections, linked in a cycle by next and prev. The
+  /// cluster of a section starts at the index of the section.
+  struct Cluster {
+    int next;
+    int prev;
+    uint64_t size;
+    uint64_t weight;
+    uint64_t initial_weight;
+    int best_pred;
+    uint64_t best_pred_weight;
+
+    double density() const;
+  };
+
+  int getNode(const LDSection& pSection);
+
+  int getLeader(int pIndex);
+
+  void mergeClusters(int pInto, int pFrom);
+
+ private:
+  std::vector<const LDSection*> m_Sections;
+  std::vector<Cluster> m_Clusters;
+  std::vector<int> m_Leaders;
+  llvm::DenseMap<const LDSection*, int> m_Nodes;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CallGraphSort);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_CALLGRAPHSORT_H_
@@ -0,0 +1,72 @@
+//===- CompressedSection.h ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_COMPRESSEDSECTION_H_
+#define MCLD_LD_COMPRESSEDSECTION_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <vector>
+
+namespace mcld {
+
+class LDSection;
+class LinkerConfig;
+class ThreadPool;
+
+/** \class CompressedSection
+ *  \brief CompressedSection is the SHF_COMPRESSED content of a debug section.
+ *
+ *  The content is an ElfXX_Chdr followed by a zlib stream. The uncompressed
+ *  content is cut into chunks that are deflated in parallel. Each chunk but
+ *  the last ends with a full flush, so the chunks are concatenated into one
+ *  deflate stream, and the adler32 checksums of the chunks are combined.
+ */
+class CompressedSection {
+ public:
+  CompressedSection(LDSection& pSection, const LinkerConfig& pConfig);
+
+  ~CompressedSection();
+
+  /// compress - compress pContent, the content of the section with the
+  /// relocation results, and make the compressed data the only fragment of
+  /// the section. The size and the alignment of the section are updated.
+  void compress(llvm::ArrayRef<uint8_t> pContent, ThreadPool& pPool);
+
+  // ----- observers ----- //
+  const LDSection& getSection() const { return m_Section; }
+
+  uint64_t getUncompressedSize() const { return m_UncompressedSize; }
+
+ private:
+  /// getHeaderSize - the size of ElfXX_Chdr
+  size_t getHeaderSize() const;
+
+  /// writeHeader - write ElfXX_Chdr into pPlace
+  void writeHeader(uint8_t* pPlace, uint64_t pAlign) const;
+
+ private:
+  LDSection& m_Section;
+
+  const LinkerConfig& m_Config;
+
+  uint64_t m_UncompressedSize;
+
+  /// m_Data - ElfXX_Chdr and the zlib stream
+  std::vector<uint8_t> m_Data;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CompressedSection);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_COMPRESSEDSECTION_H_
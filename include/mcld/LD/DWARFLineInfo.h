@@ -9,14 +9,65 @@
 #ifndef MCLD_LD_DWARFLINEINFO_H_
 #define MCLD_LD_DWARFLINEINFO_H_
 #include "mcld/LD/DiagnosticLineInfo.h"
+#include "mcld/Support/Compiler.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace mcld {
 
 /** \class DWARFLineInfo
  *  \brief DWARFLineInfo provides the conversion from address to line of code
  *  by DWARF format.
+ *
+ *  The .debug_line of an input is decoded the first time a diagnostic asks
+ *  for a line in it, so a link without diagnostics parses no DWARF. The line
+ *  programs are read from the input file with their relocations, and their
+ *  rows are kept sorted by the input section and the offset of their code.
  */
-class DWARFLineInfo : public DiagnosticLineInfo {};
+class DWARFLineInfo : public DiagnosticLineInfo {
+ public:
+  /// Row - the line of the code from offset in the input section of index
+  /// section. A row of line 0 ends a sequence.
+  struct Row {
+    uint32_t section;
+    uint64_t offset;
+    uint32_t file;
+    uint32_t line;
+  };
+
+  struct Table {
+    std::vector<Row> rows;
+    std::vector<std::string> files;
+  };
+
+ public:
+  DWARFLineInfo();
+
+  ~DWARFLineInfo();
+
+  bool getLine(Input& pInput,
+               const LDSection& pSection,
+               uint64_t pOffset,
+               std::string& pFile,
+               unsigned int& pLine);
+
+ private:
+  typedef std::map<const Input*, Table*> TableMap;
+
+ private:
+  /// getTable - the line table of pInput, decoded at the first call
+  const Table& getTable(Input& pInput);
+
+ private:
+  TableMap m_Tables;
+  std::mutex m_Mutex;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(DWARFLineInfo);
+};
 
 }  // namespace mcld
 
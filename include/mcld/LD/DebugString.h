@@ -18,6 +18,7 @@ namespace mcld {
 class LDSection;
 class Relocation;
 class TargetLDBackend;
+class ThreadPool;
 
 /** \class DebugString
  *  \brief DebugString represents the output debug section .debug_str
@@ -29,14 +30,14 @@ class DebugString {
 
   static DebugString* Create(LDSection& pSection);
 
-  /// merge - process the strings in the given input .debug_str section and add
-  /// those strings into merged string map
+  /// merge - add the strings in the given input .debug_str section into
+  /// merged string map
   void merge(LDSection& pSection);
 
-  /// computeOffsetSize - set up the output offset of each strings and the
-  /// section size
+  /// computeOffsetSize - merge the strings, set up the output offset of each
+  /// strings and the section size
   /// @return string table size
-  size_t computeOffsetSize();
+  size_t computeOffsetSize(ThreadPool& pPool);
 
   /// applyOffset - apply the relocation which refer to debug string. This
   /// should be called after finalizeStringsOffset()
@@ -52,6 +53,8 @@ class DebugString {
   const LDSection* getSection() const { return m_pSection; }
   LDSection*       getSection()       { return m_pSection; }
 
+  const MergedStringTable& getStringTable() const { return m_StringTable; }
+
  private:
   /// m_Section - the output LDSection of this .debug_str
   LDSection* m_pSection;
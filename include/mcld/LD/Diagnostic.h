@@ -70,6 +70,13 @@ class Diagnostic {
     return static_cast<bool>(m_Engine.state().ArgumentVals[pIdx]);
   }
 
+  const ResolveInfo* getArgSymbol(unsigned int pIdx) const {
+    assert(getArgKind(pIdx) == DiagnosticEngine::ak_symbol &&
+           "Invalid argument accessor!");
+    return reinterpret_cast<const ResolveInfo*>(
+        m_Engine.state().ArgumentVals[pIdx]);
+  }
+
   intptr_t getRawVals(unsigned int pIdx) const {
     assert(getArgKind(pIdx) != DiagnosticEngine::ak_std_string &&
            "Invalid argument accessor!");
@@ -10,9 +10,15 @@
 #define MCLD_LD_DIAGNOSTICENGINE_H_
 #include "mcld/LD/DiagnosticInfos.h"
 
+#include <llvm/ADT/StringRef.h>
 #include <llvm/Support/DataTypes.h>
 
+#include <cassert>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace mcld {
 
@@ -21,6 +27,7 @@ class DiagnosticPrinter;
 class Input;
 class LinkerConfig;
 class MsgHandler;
+class ResolveInfo;
 
 /** \class DiagnosticEngine
  *  \brief DiagnosticEngine is used to report problems and issues.
@@ -32,6 +39,17 @@ class MsgHandler;
  *  DiagnosticEngine is a complex class, it is responsible for
  *  - remember the argument string for MsgHandler
  *  - choice the severity of a message by options
+ *  - drop the warnings and the notes which repeat an earlier one with the
+ *    same arguments, and stop showing a warning or a note after it has been
+ *    reported MaxReportsPerID times
+ *  - demangle the symbols given as arguments when the message is printed,
+ *    once for each symbol
+ *
+ *  A worker thread of a parallel phase reports into the Buffer of its
+ *  BufferScope instead of the printer. The phase replays the buffers in the
+ *  order of its inputs once the workers are done, so the output does not
+ *  depend on the scheduling and the workers never wait for each other. Only
+ *  a fatal diagnostic, which ends the link, is printed at once.
  */
 class DiagnosticEngine {
  public:
@@ -52,7 +70,8 @@ class DiagnosticEngine {
     ak_sint,        // int
     ak_uint,        // unsigned int
     ak_ulonglong,   // unsigned long long
-    ak_bool         // bool
+    ak_bool,        // bool
+    ak_symbol       // const ResolveInfo *, printed demangled
   };
 
  public:
@@ -62,8 +81,12 @@ class DiagnosticEngine {
 
   void reset(const LinkerConfig& pConfig);
 
+  /// setLineInfo - the engine owns pLineInfo, and deletes the previous one
   void setLineInfo(DiagnosticLineInfo& pLineInfo);
 
+  /// getLineInfo - the lines of code for the diagnostics, or NULL
+  DiagnosticLineInfo* getLineInfo() { return m_pLineInfo; }
+
   void setPrinter(DiagnosticPrinter& pPrinter, bool pShouldOwnPrinter = true);
 
   const DiagnosticPrinter* getPrinter() const { return m_pPrinter; }
@@ -83,14 +106,32 @@ class DiagnosticEngine {
   // report - issue the message to the printer
   MsgHandler report(uint16_t pID, Severity pSeverity);
 
+  /// isVisible - check if the diagnostic pID would be counted or shown. The
+  /// callers which compute costly arguments can skip an invisible one.
+  bool isVisible(uint16_t pID) const;
+
+  class Buffer;
+  class BufferScope;
+
+  /// replay - report the diagnostics held in pBuffer, and empty it
+  void replay(Buffer& pBuffer);
+
+  /// getDemangledName - the demangled name of pInfo. A C++ name is demangled
+  /// the first time it is asked for, and the result is kept until reset().
+  llvm::StringRef getDemangledName(const ResolveInfo& pInfo);
+
  private:
   friend class MsgHandler;
   friend class Diagnostic;
+  friend class DiagnosticInfos;
 
   enum {
     /// MaxArguments - The maximum number of arguments we can hold. We currently
     /// only support up to 10 arguments (%0-%9).
-    MaxArguments = 10
+    MaxArguments = 10,
+
+    /// MaxReportsPerID - a warning or a note is shown this many times at most
+    MaxReportsPerID = 100
   };
 
   struct State {
@@ -115,10 +156,43 @@ class DiagnosticEngine {
     Input* file;
   };
 
+ public:
+  /** \class Buffer
+   *  \brief Buffer holds the diagnostics of a worker thread until replay().
+   */
+  class Buffer {
+   public:
+    bool empty() const { return m_Diagnostics.empty(); }
+
+   private:
+    friend class DiagnosticEngine;
+
+    State m_Current;
+    std::vector<State> m_Diagnostics;
+  };
+
+  /** \class BufferScope
+   *  \brief BufferScope sends the diagnostics of the current thread to a
+   *  Buffer while it lives.
+   */
+  class BufferScope {
+   public:
+    explicit BufferScope(Buffer& pBuffer);
+
+    ~BufferScope();
+
+   private:
+    Buffer* m_pPrevBuffer;
+  };
+
  private:
-  State& state() { return m_State; }
+  State& state() {
+    return (s_pBuffer != NULL) ? s_pBuffer->m_Current : m_State;
+  }
 
-  const State& state() const { return m_State; }
+  const State& state() const {
+    return (s_pBuffer != NULL) ? s_pBuffer->m_Current : m_State;
+  }
 
   DiagnosticInfos& infoMap() {
     assert(m_pInfoMap != NULL && "DiagnosticEngine was not initialized!");
@@ -130,6 +204,10 @@ class DiagnosticEngine {
     return *m_pInfoMap;
   }
 
+  /// isRepeated - check if the current diagnostic repeats a reported one, or
+  /// its ID has been reported too many times
+  bool isRepeated();
+
  private:
   const LinkerConfig* m_pConfig;
   DiagnosticLineInfo* m_pLineInfo;
@@ -138,6 +216,17 @@ class DiagnosticEngine {
   bool m_OwnPrinter;
 
   State m_State;
+
+  // the IDs and the arguments of the reported warnings and notes
+  std::unordered_set<std::string> m_Reported;
+  std::vector<unsigned int> m_NumReports;
+
+  // the demangled C++ names, which a fatal worker may print at any time
+  std::unordered_map<const ResolveInfo*, std::string> m_DemangledNames;
+  std::mutex m_DemangledNamesLock;
+
+  // the buffer of the current thread, or NULL to report to the printer
+  static thread_local Buffer* s_pBuffer;
 };
 
 }  // namespace mcld
@@ -44,6 +44,13 @@ class DiagnosticInfos {
 
   llvm::StringRef getDescription(unsigned int pID, bool pLoC) const;
 
+  /// isVisible - check if the diagnostic pID would be counted or shown by the
+  /// printer of pEngine
+  bool isVisible(const DiagnosticEngine& pEngine, unsigned int pID) const;
+
+  /// isFatal - check if the diagnostic pID stops the link
+  bool isFatal(unsigned int pID) const;
+
   bool process(DiagnosticEngine& pEngine) const;
 
  private:
@@ -9,12 +9,31 @@
 #ifndef MCLD_LD_DIAGNOSTICLINEINFO_H_
 #define MCLD_LD_DIAGNOSTICLINEINFO_H_
 
+#include <llvm/Support/DataTypes.h>
+
+#include <string>
+
 namespace mcld {
 
+class Input;
+class LDSection;
+
 /** \class DiagnosticLineInfo
  *  \brief Map the address to the line of code.
  */
-class DiagnosticLineInfo {};
+class DiagnosticLineInfo {
+ public:
+  virtual ~DiagnosticLineInfo();
+
+  /// getLine - the source file and the line of the code at pOffset in the
+  /// input section pSection of pInput.
+  /// @return false if the line is unknown
+  virtual bool getLine(Input& pInput,
+                       const LDSection& pSection,
+                       uint64_t pOffset,
+                       std::string& pFile,
+                       unsigned int& pLine);
+};
 
 }  // namespace mcld
 
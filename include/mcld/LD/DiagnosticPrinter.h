@@ -37,6 +37,12 @@ class DiagnosticPrinter {
   virtual void handleDiagnostic(DiagnosticEngine::Severity pSeverity,
                                 const Diagnostic& pInfo);
 
+  /// isVisible - check if a diagnostic of pSeverity would be shown. The
+  /// diagnostics which are neither shown nor counted are not formatted.
+  virtual bool isVisible(DiagnosticEngine::Severity pSeverity) const {
+    return true;
+  }
+
   unsigned int getNumErrors() const { return m_NumErrors; }
   unsigned int getNumWarnings() const { return m_NumWarnings; }
 
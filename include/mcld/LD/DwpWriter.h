@@ -0,0 +1,59 @@
+//===- DwpWriter.h --------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_DWPWRITER_H_
+#define MCLD_LD_DWPWRITER_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/Support/DataTypes.h>
+
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+class Module;
+class ThreadPool;
+
+/** \class DwpWriter
+ *  \brief DwpWriter packages the split DWARF of the inputs into the DWARF 5
+ *  package file of --dwp.
+ *
+ *  An input compiled with -gsplit-dwarf holds a skeleton unit, and the rest
+ *  of its debug info is in the .dwo file beside it. The .dwo files are read
+ *  in parallel. Every split unit is indexed in .debug_cu_index or
+ *  .debug_tu_index, and a type unit is kept once. .debug_str.dwo is merged
+ *  and .debug_str_offsets.dwo is rewritten for it. The other sections are
+ *  copied as they are, so the link itself never reads the .dwo contents.
+ */
+class DwpWriter {
+ public:
+  DwpWriter();
+
+  ~DwpWriter();
+
+  /// addInputs - find the skeleton units in the objects of pModule, and the
+  /// .dwo files of their split units
+  void addInputs(Module& pModule);
+
+  /// write - package the .dwo files into pPath
+  bool write(const std::string& pPath, ThreadPool& pPool);
+
+ private:
+  /// m_Files - the .dwo files, and the DWO ID of the skeleton of each
+  std::vector<std::string> m_Files;
+  std::vector<uint64_t> m_DwoIDs;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(DwpWriter);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_DWPWRITER_H_
@@ -0,0 +1,81 @@
+//===- DynObjCache.h ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_DYNOBJCACHE_H_
+#define MCLD_LD_DYNOBJCACHE_H_
+
+#include "mcld/LD/ObjectReader.h"
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/ADT/StringRef.h>
+
+#include <memory>
+#include <string>
+
+namespace llvm {
+class MemoryBuffer;
+}  // namespace llvm
+
+namespace mcld {
+
+class Input;
+
+/** \class DynObjCache
+ *  \brief DynObjCache keeps the decoded .dynsym and the SONAME of the shared
+ *  objects in a directory, for the next links.
+ *
+ *  An entry is named after the path, the size, the modification time and the
+ *  build-id of a shared object, and the version of the linker. It is only
+ *  used if all of them match. The entry is mapped and read in place: a
+ *  header, the symbols as fixed-size records, and their names. The entries
+ *  are written aside and renamed, so the concurrent links sharing a directory
+ *  see either a whole entry or none.
+ */
+class DynObjCache {
+ public:
+  explicit DynObjCache(const std::string& pDir);
+
+  ~DynObjCache();
+
+  /// open - look up the entry of pInput whose build-id is pBuildID.
+  /// @return true if the entry is valid. Otherwise, store() writes it.
+  bool open(const Input& pInput, llvm::StringRef pBuildID);
+
+  /// isOpen - the last open() found the entry of pInput
+  bool isOpen(const Input& pInput) const {
+    return m_pInput == &pInput && m_pEntry != NULL;
+  }
+
+  /// isMissed - the last open() looked for pInput and found no entry
+  bool isMissed(const Input& pInput) const {
+    return m_pInput == &pInput && m_pEntry == NULL;
+  }
+
+  /// getSOName - the SONAME of the open entry
+  llvm::StringRef getSOName() const;
+
+  /// getSymbols - decode the symbols of the open entry into pStage
+  void getSymbols(Input& pInput, ObjectReader::SymbolStage& pStage) const;
+
+  /// store - write the entry of the input looked for by the last open()
+  bool store(llvm::StringRef pSOName, const ObjectReader::SymbolStage& pStage);
+
+ private:
+  std::string m_Dir;
+  const Input* m_pInput;
+  std::string m_Key;
+  std::string m_File;
+  std::unique_ptr<llvm::MemoryBuffer> m_pEntry;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(DynObjCache);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_DYNOBJCACHE_H_
@@ -0,0 +1,113 @@
+//===- ELFDynObjIndex.h ---------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_ELFDYNOBJINDEX_H_
+#define MCLD_LD_ELFDYNOBJINDEX_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mcld {
+
+class ELFReaderIF;
+class IRBuilder;
+class Input;
+
+/** \class ELFDynObjIndex
+ *  \brief ELFDynObjIndex looks up the symbols of a shared object through its
+ *  .gnu.hash, in place in the mapped file.
+ *
+ *  Under --lazy-dso-symbols, ELFDynObjReader only adds the symbols which
+ *  .gnu.hash leaves out, i.e., the ones before its symoffset. IRBuilder adds
+ *  a hashed symbol when its name has been seen by the link, so the symbols
+ *  which nobody refers to never get into the NamePool. The weak aliases of a
+ *  data symbol are added with it, as the copy relocation needs them.
+ */
+class ELFDynObjIndex {
+ public:
+  ELFDynObjIndex(Input& pInput, const ELFReaderIF& pReader, bool pIs64Bits);
+
+  ~ELFDynObjIndex();
+
+  /// parse - read the header of .gnu.hash in pGNUHash. Return false if the
+  /// section is malformed, and then the symbols should be read as usual.
+  bool parse(llvm::StringRef pSymTab,
+             llvm::StringRef pStrTab,
+             llvm::StringRef pGNUHash);
+
+  /// getUnhashedSymbols - the entries of .dynsym before the first symbol in
+  /// .gnu.hash
+  llvm::StringRef getUnhashedSymbols() const {
+    return m_SymTab.substr(0, m_SymOffset * m_EntSize);
+  }
+
+  /// addSymbols - add the symbols named pName to pBuilder if they are not
+  /// added yet. The names of the aliases added with them are appended to
+  /// pAliases.
+  void addSymbols(llvm::StringRef pName,
+                  IRBuilder& pBuilder,
+                  std::vector<std::string>& pAliases);
+
+ private:
+  typedef std::vector<std::pair<uint64_t, uint32_t> > ObjectList;
+
+ private:
+  /// lookUp - append the indices of the symbols named pName to pIndices
+  void lookUp(llvm::StringRef pName,
+              llvm::SmallVectorImpl<uint32_t>& pIndices) const;
+
+  llvm::StringRef getName(uint32_t pIndex) const;
+
+  uint64_t getValue(uint32_t pIndex) const;
+
+  /// isAliasCandidate - a defined global or weak data symbol may have weak
+  /// aliases
+  bool isAliasCandidate(uint32_t pIndex) const;
+
+  /// indexObjects - sort the alias candidates by their values
+  void indexObjects();
+
+ private:
+  Input& m_Input;
+  const ELFReaderIF& m_Reader;
+  bool m_bIs64Bits;
+
+  llvm::StringRef m_SymTab;
+  llvm::StringRef m_StrTab;
+  size_t m_EntSize;
+  uint32_t m_NumOfSymbols;
+
+  uint32_t m_NumOfBuckets;
+  uint32_t m_SymOffset;
+  uint32_t m_BloomSize;
+  uint32_t m_BloomShift;
+  const char* m_pBloom;
+  const char* m_pBuckets;
+  const char* m_pChains;
+
+  /// m_Added - the indices of the symbols added to the link
+  llvm::DenseSet<uint32_t> m_Added;
+
+  /// m_Objects - the (value, index) of the alias candidates, in order
+  ObjectList m_Objects;
+  bool m_bIndexedObjects;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ELFDynObjIndex);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_ELFDYNOBJINDEX_H_
@@ -10,8 +10,11 @@
 #define MCLD_LD_ELFDYNOBJREADER_H_
 #include "mcld/LD/DynObjReader.h"
 
+#include <llvm/ADT/StringRef.h>
+
 namespace mcld {
 
+class DynObjCache;
 class ELFReaderIF;
 class GNULDBackend;
 class Input;
@@ -21,6 +24,8 @@ class LinkerConfig;
 /** \class ELFDynObjReader
  *  \brief ELFDynObjReader reads ELF dynamic shared objects.
  *
+ *  Under --dso-cache, the SONAME and the decoded .dynsym of a shared object
+ *  are taken from DynObjCache if the cache has them, and stored otherwise.
  */
 class ELFDynObjReader : public DynObjReader {
  public:
@@ -38,8 +43,22 @@ class ELFDynObjReader : public DynObjReader {
   bool readSymbols(Input& pInput);
 
  private:
+  /// readLazySymbols - under --lazy-dso-symbols, add the symbols which are
+  /// not in .gnu.hash and leave the others to IRBuilder. Return false if the
+  /// shared object has no usable .gnu.hash.
+  bool readLazySymbols(Input& pInput,
+                       llvm::StringRef pSymTab,
+                       llvm::StringRef pStrTab);
+
+  /// getBuildID - the descriptor of the build-id note of pInput, or an empty
+  /// string if it has none
+  llvm::StringRef getBuildID(Input& pInput) const;
+
+ private:
+  const LinkerConfig& m_Config;
   ELFReaderIF* m_pELFReader;
   IRBuilder& m_Builder;
+  DynObjCache* m_pCache;  ///< NULL without --dso-cache
 };
 
 }  // namespace mcld
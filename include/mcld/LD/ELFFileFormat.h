@@ -63,6 +63,10 @@ class ELFFileFormat : public LDFileFormat {
     return (f_pRelaPlt != NULL) && (f_pRelaPlt->size() != 0);
   }
 
+  bool hasRelrDyn() const {
+    return (f_pRelrDyn != NULL) && (f_pRelrDyn->size() != 0);
+  }
+
   /// @ref 10.3.1.1, ISO/IEC 23360, Part 1:2010(E), p. 21.
   bool hasComment() const {
     return (f_pComment != NULL) && (f_pComment->size() != 0);
@@ -205,6 +209,14 @@ class ELFFileFormat : public LDFileFormat {
     return (f_pGNUHashTab != NULL) && (f_pGNUHashTab->size() != 0);
   }
 
+  bool hasBuildID() const {
+    return (f_pBuildID != NULL) && (f_pBuildID->size() != 0);
+  }
+
+  bool hasGdbIndex() const {
+    return (f_pGdbIndex != NULL) && (f_pGdbIndex->size() != 0);
+  }
+
   // -----  access functions  ----- //
   /// @ref Special Sections, Ch. 4.17, System V ABI, 4th edition.
   LDSection& getNULLSection() {
@@ -277,6 +289,16 @@ class ELFFileFormat : public LDFileFormat {
     return *f_pRelaPlt;
   }
 
+  LDSection& getRelrDyn() {
+    assert(f_pRelrDyn != NULL);
+    return *f_pRelrDyn;
+  }
+
+  const LDSection& getRelrDyn() const {
+    assert(f_pRelrDyn != NULL);
+    return *f_pRelrDyn;
+  }
+
   LDSection& getComment() {
     assert(f_pComment != NULL);
     return *f_pComment;
@@ -669,6 +691,26 @@ class ELFFileFormat : public LDFileFormat {
     return *f_pGNUHashTab;
   }
 
+  LDSection& getBuildID() {
+    assert(f_pBuildID != NULL);
+    return *f_pBuildID;
+  }
+
+  const LDSection& getBuildID() const {
+    assert(f_pBuildID != NULL);
+    return *f_pBuildID;
+  }
+
+  LDSection& getGdbIndex() {
+    assert(f_pGdbIndex != NULL);
+    return *f_pGdbIndex;
+  }
+
+  const LDSection& getGdbIndex() const {
+    assert(f_pGdbIndex != NULL);
+    return *f_pGdbIndex;
+  }
+
  protected:
   //         variable name         :  ELF
   /// @ref Special Sections, Ch. 4.17, System V ABI, 4th edition.
@@ -679,6 +721,7 @@ class ELFFileFormat : public LDFileFormat {
   LDSection* f_pRelPlt;   // .rel.plt
   LDSection* f_pRelaDyn;  // .rela.dyn
   LDSection* f_pRelaPlt;  // .rela.plt
+  LDSection* f_pRelrDyn;  // .relr.dyn
 
   /// @ref 10.3.1.1, ISO/IEC 23360, Part 1:2010(E), p. 21.
   LDSection* f_pComment;       // .comment
@@ -724,6 +767,8 @@ class ELFFileFormat : public LDFileFormat {
   LDSection* f_pStackNote;       // .note.GNU-stack
   LDSection* f_pDataRelRoLocal;  // .data.rel.ro.local
   LDSection* f_pGNUHashTab;      // .gnu.hash
+  LDSection* f_pBuildID;         // .note.gnu.build-id
+  LDSection* f_pGdbIndex;        // .gdb_index
 };
 
 }  // namespace mcld
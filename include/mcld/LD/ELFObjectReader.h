@@ -12,6 +12,11 @@
 #include "mcld/ADT/Flags.h"
 #include "mcld/LD/ObjectReader.h"
 
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Allocator.h>
+
+#include <vector>
+
 namespace mcld {
 
 class EhFrameReader;
@@ -19,6 +24,7 @@ class ELFReaderIF;
 class Input;
 class IRBuilder;
 class GNULDBackend;
+class LDSection;
 class LinkerConfig;
 
 /** \lclass ELFObjectReader
@@ -48,13 +54,46 @@ class ELFObjectReader : public ObjectReader {
 
   virtual bool readSections(Input& pFile);
 
+  virtual bool readEhFrames(Input& pFile);
+
+  /// decompressSections - inflate the SHF_COMPRESSED debug sections of all
+  /// inputs in parallel.
+  virtual bool decompressSections(ThreadPool& pPool);
+
   virtual bool readSymbols(Input& pFile);
 
+  virtual bool parseSymbols(Input& pFile, SymbolStage& pStage) const;
+
+  virtual bool addSymbols(Input& pFile, const SymbolStage& pStage);
+
   /// readRelocations - read relocation sections
   ///
   /// This function should be called after symbol resolution.
   virtual bool readRelocations(Input& pFile);
 
+  /// readRelocation - read the relocation section pRelocSect of pFile
+  virtual bool readRelocation(Input& pFile, LDSection& pRelocSect);
+
+ private:
+  /// readDebugSection - read a debug section. The content of a compressed
+  /// section is an empty buffer until decompressSections inflates it.
+  bool readDebugSection(Input& pInput, LDSection& pSection);
+
+  /// readGroup - record the signature of the group section pGroup. If a
+  /// previous input has the same COMDAT group, ignore the members.
+  void readGroup(Input& pInput, LDSection& pGroup);
+
+ private:
+  /// CompressedInput - a compressed input section waiting to be inflated
+  struct CompressedInput {
+    Input* input;
+    LDSection* section;
+    llvm::StringRef data;  ///< the zlib stream after ElfXX_Chdr
+    char* buffer;          ///< the uncompressed content
+  };
+
+  typedef std::vector<CompressedInput> CompressedInputs;
+
  private:
   ELFReaderIF* m_pELFReader;
   EhFrameReader* m_pEhFrameReader;
@@ -62,6 +101,11 @@ class ELFObjectReader : public ObjectReader {
   ReadFlag m_ReadFlag;
   GNULDBackend& m_Backend;
   const LinkerConfig& m_Config;
+
+  /// m_DebugAllocator - the storage of the uncompressed debug sections
+  llvm::BumpPtrAllocator m_DebugAllocator;
+
+  CompressedInputs m_CompressedInputs;
 };
 
 }  // namespace mcld
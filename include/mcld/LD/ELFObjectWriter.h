@@ -12,6 +12,7 @@
 #include "mcld/Support/FileOutputBuffer.h"
 
 #include <cassert>
+#include <vector>
 
 namespace mcld {
 
@@ -38,11 +39,21 @@ class ELFObjectWriter : public ObjectWriter {
 
   size_t getOutputSize(const Module& pModule) const;
 
+  void emitSectionContent(Module& pModule,
+                          LDSection& pSection,
+                          MemoryRegion& pRegion);
+
  private:
   void writeSection(Module& pModule,
                     FileOutputBuffer& pOutput,
                     LDSection* section);
 
+  /// writeSections - write out the given sections, copying the plain section
+  /// data on a thread pool.
+  void writeSections(Module& pModule,
+                     FileOutputBuffer& pOutput,
+                     const std::vector<LDSection*>& pSections);
+
   const GNULDBackend& target() const { return m_Backend; }
   GNULDBackend& target() { return m_Backend; }
 
@@ -26,6 +26,11 @@ class SectionData;
 
 /** \class ELFReader
  *  \brief ELFReader is a template scaffolding for partial specification.
+ *
+ *  Only the little endian readers exist, and isMyEndian rejects the big
+ *  endian files. The fields are swapped only on a big endian host, and the
+ *  test of the host is a constant, so the loops over the symbols and the
+ *  relocations on a little endian host never swap.
  */
 template <size_t BIT, bool LITTLEENDIAN>
 class ELFReader {};
@@ -68,17 +73,25 @@ class ELFReader<32, true> : public ELFReaderIF {
   /// readRegularSection - read a regular section and create fragments.
   bool readRegularSection(Input& pInput, SectionData& pSD) const;
 
-  /// readSymbols - read ELF symbols and create LDSymbol
-  bool readSymbols(Input& pInput,
-                   IRBuilder& pBuilder,
-                   llvm::StringRef pRegion,
-                   const char* StrTab) const;
-
-  /// readSignature - read a symbol from the given Input and index in symtab
-  /// This is used to get the signature of a group section.
-  ResolveInfo* readSignature(Input& pInput,
-                             LDSection& pSymTab,
-                             uint32_t pSymIdx) const;
+  /// readCompressionHeader - read the ElfXX_Chdr of a compressed section
+  bool readCompressionHeader(Input& pInput,
+                             const LDSection& pSection,
+                             uint32_t& pType,
+                             uint64_t& pSize,
+                             uint64_t& pAlign,
+                             size_t& pHeaderSize) const;
+
+  /// parseSymbols - decode ELF symbols into pStage
+  bool parseSymbols(Input& pInput,
+                    llvm::StringRef pRegion,
+                    const char* pStrTab,
+                    ObjectReader::SymbolStage& pStage) const;
+
+  /// readSignature - read the name of a symbol from the given Input and
+  /// index in symtab. This is used to get the signature of a group section.
+  llvm::StringRef readSignature(Input& pInput,
+                                LDSection& pSymTab,
+                                uint32_t pSymIdx) const;
 
   /// readRela - read ELF rela and create Relocation
   bool readRela(Input& pInput,
@@ -92,27 +105,6 @@ class ELFReader<32, true> : public ELFReaderIF {
 
   /// readDynamic - read ELF .dynamic in input dynobj
   bool readDynamic(Input& pInput) const;
-
- private:
-  struct AliasInfo {
-    LDSymbol* pt_alias;  /// potential alias
-    uint64_t ld_value;
-    ResolveInfo::Binding ld_binding;
-  };
-
-  /// comparison function to sort symbols for analyzing weak alias.
-  /// sort symbols by symbol value and then weak before strong.
-  static bool less(AliasInfo p1, AliasInfo p2) {
-    if (p1.ld_value != p2.ld_value)
-      return (p1.ld_value < p2.ld_value);
-    if (p1.ld_binding != p2.ld_binding) {
-      if (ResolveInfo::Weak == p1.ld_binding)
-        return true;
-      else if (ResolveInfo::Weak == p2.ld_binding)
-        return false;
-    }
-    return p1.pt_alias->str() < p2.pt_alias->str();
-  }
 };
 
 /** \class ELFReader<64, true>
@@ -153,17 +145,25 @@ class ELFReader<64, true> : public ELFReaderIF {
   /// readRegularSection - read a regular section and create fragments.
   bool readRegularSection(Input& pInput, SectionData& pSD) const;
 
-  /// readSymbols - read ELF symbols and create LDSymbol
-  bool readSymbols(Input& pInput,
-                   IRBuilder& pBuilder,
-                   llvm::StringRef pRegion,
-                   const char* StrTab) const;
-
-  /// readSignature - read a symbol from the given Input and index in symtab
-  /// This is used to get the signature of a group section.
-  ResolveInfo* readSignature(Input& pInput,
-                             LDSection& pSymTab,
-                             uint32_t pSymIdx) const;
+  /// readCompressionHeader - read the ElfXX_Chdr of a compressed section
+  bool readCompressionHeader(Input& pInput,
+                             const LDSection& pSection,
+                             uint32_t& pType,
+                             uint64_t& pSize,
+                             uint64_t& pAlign,
+                             size_t& pHeaderSize) const;
+
+  /// parseSymbols - decode ELF symbols into pStage
+  bool parseSymbols(Input& pInput,
+                    llvm::StringRef pRegion,
+                    const char* pStrTab,
+                    ObjectReader::SymbolStage& pStage) const;
+
+  /// readSignature - read the name of a symbol from the given Input and
+  /// index in symtab. This is used to get the signature of a group section.
+  llvm::StringRef readSignature(Input& pInput,
+                                LDSection& pSymTab,
+                                uint32_t pSymIdx) const;
 
   /// readRela - read ELF rela and create Relocation
   bool readRela(Input& pInput,
@@ -177,27 +177,6 @@ class ELFReader<64, true> : public ELFReaderIF {
 
   /// readDynamic - read ELF .dynamic in input dynobj
   bool readDynamic(Input& pInput) const;
-
- private:
-  struct AliasInfo {
-    LDSymbol* pt_alias;  /// potential alias
-    uint64_t ld_value;
-    ResolveInfo::Binding ld_binding;
-  };
-
-  /// comparison function to sort symbols for analyzing weak alias.
-  /// sort symbols by symbol value and then weak before strong.
-  static bool less(AliasInfo p1, AliasInfo p2) {
-    if (p1.ld_value != p2.ld_value)
-      return (p1.ld_value < p2.ld_value);
-    if (p1.ld_binding != p2.ld_binding) {
-      if (ResolveInfo::Weak == p1.ld_binding)
-        return true;
-      else if (ResolveInfo::Weak == p2.ld_binding)
-        return false;
-    }
-    return p1.pt_alias->str() < p2.pt_alias->str();
-  }
 };
 
 }  // namespace mcld
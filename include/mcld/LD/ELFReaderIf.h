@@ -10,6 +10,7 @@
 #define MCLD_LD_ELFREADERIF_H_
 
 #include "mcld/LinkerConfig.h"
+#include "mcld/LD/ObjectReader.h"
 #include "mcld/Support/MsgHandling.h"
 #include "mcld/Target/GNULDBackend.h"
 
@@ -59,17 +60,46 @@ class ELFReaderIF {
   /// readRegularSection - read a regular section and create fragments.
   virtual bool readRegularSection(Input& pInput, SectionData& pSD) const = 0;
 
-  /// readSymbols - read ELF symbols and create LDSymbol
-  virtual bool readSymbols(Input& pInput,
-                           IRBuilder& pBuilder,
-                           llvm::StringRef pRegion,
-                           const char* StrTab) const = 0;
+  /// readCompressionHeader - read the ElfXX_Chdr of the SHF_COMPRESSED
+  /// section pSection. pHeaderSize is the size of the ElfXX_Chdr.
+  virtual bool readCompressionHeader(Input& pInput,
+                                     const LDSection& pSection,
+                                     uint32_t& pType,
+                                     uint64_t& pSize,
+                                     uint64_t& pAlign,
+                                     size_t& pHeaderSize) const = 0;
 
-  /// readSignature - read a symbol from the given Input and index in symtab
-  /// This is used to get the signature of a group section.
-  virtual ResolveInfo* readSignature(Input& pInput,
-                                     LDSection& pSymTab,
-                                     uint32_t pSymIdx) const = 0;
+  /// readSymbols - read ELF symbols and create LDSymbol
+  bool readSymbols(Input& pInput,
+                   IRBuilder& pBuilder,
+                   llvm::StringRef pRegion,
+                   const char* pStrTab) const;
+
+  /// parseSymbols - decode ELF symbols into pStage. This does not touch the
+  /// module, so that different inputs can be parsed concurrently.
+  virtual bool parseSymbols(Input& pInput,
+                            llvm::StringRef pRegion,
+                            const char* pStrTab,
+                            ObjectReader::SymbolStage& pStage) const = 0;
+
+  /// addSymbols - create LDSymbols for the symbols decoded by parseSymbols.
+  bool addSymbols(Input& pInput,
+                  IRBuilder& pBuilder,
+                  const ObjectReader::SymbolStage& pStage) const;
+
+  /// appendSymbols - create LDSymbols for more symbols of pInput whose
+  /// symbols have been added by addSymbols.
+  bool appendSymbols(Input& pInput,
+                     IRBuilder& pBuilder,
+                     const ObjectReader::SymbolStage& pStage) const;
+
+  /// readSignature - read the name of a symbol from the given Input and
+  /// index in symtab. This is used to get the signature of a group section.
+  /// @return the name in place in the string table, or an empty name if the
+  /// symbol is a section symbol
+  virtual llvm::StringRef readSignature(Input& pInput,
+                                        LDSection& pSymTab,
+                                        uint32_t pSymIdx) const = 0;
 
   /// readRela - read ELF rela and create Relocation
   virtual bool readRela(Input& pInput,
@@ -94,6 +124,27 @@ class ELFReaderIF {
 
   typedef std::vector<LinkInfo> LinkInfoList;
 
+ protected:
+  struct AliasInfo {
+    LDSymbol* pt_alias;  /// potential alias
+    uint64_t ld_value;
+    ResolveInfo::Binding ld_binding;
+  };
+
+  /// comparison function to sort symbols for analyzing weak alias.
+  /// sort symbols by symbol value and then weak before strong.
+  static bool less(AliasInfo p1, AliasInfo p2) {
+    if (p1.ld_value != p2.ld_value)
+      return (p1.ld_value < p2.ld_value);
+    if (p1.ld_binding != p2.ld_binding) {
+      if (ResolveInfo::Weak == p1.ld_binding)
+        return true;
+      else if (ResolveInfo::Weak == p2.ld_binding)
+        return false;
+    }
+    return p1.pt_alias->str() < p2.pt_alias->str();
+  }
+
  protected:
   ResolveInfo::Type getSymType(uint8_t pInfo, uint16_t pShndx) const;
 
@@ -15,10 +15,12 @@
 #include "mcld/Support/Allocators.h"
 #include "mcld/Support/Compiler.h"
 
+#include <llvm/ADT/StringMap.h>
 #include <llvm/ADT/StringRef.h>
 
 #include <list>
 #include <map>
+#include <utility>
 #include <vector>
 
 namespace mcld {
@@ -190,6 +192,14 @@ class EhFrame {
   /// addFDE - add a FDE entry in EhFrame
   void addFDE(FDE& pFDE, bool pAlsoAddFragment = true);
 
+  /// findCIE - find the first CIE of this EhFrame that equals to pCIE, or
+  /// return NULL.
+  CIE* findCIE(const CIE& pCIE) const;
+
+  /// clearRecords - delete the CIEs, FDEs and fragments read so far, so that
+  /// the section can be read again.
+  void clearRecords();
+
   // -----  CIE  ----- //
   const_cie_iterator cie_begin() const { return m_CIEs.begin(); }
   cie_iterator cie_begin() { return m_CIEs.begin(); }
@@ -225,7 +235,17 @@ class EhFrame {
   // ALL readSections done, that is the reason why we don't check this
   // immediately when reading.
   void setupAttributes(const LDSection* reloc_sect);
-  void removeDiscardedFDE(CIE& pCIE, const LDSection* pRelocEhFrameSect);
+
+  /// RelocIndex - the relocations of .eh_frame by the offset they apply at.
+  /// A removed relocation is left as NULL.
+  typedef std::vector<std::pair<uint64_t, Relocation*> > RelocIndex;
+
+  /// findReloc - the first relocation in pRelocs at pOffset, or NULL
+  static Relocation* findReloc(const RelocIndex& pRelocs, uint64_t pOffset);
+
+  void removeDiscardedFDE(CIE& pCIE,
+                          const LDSection* pRelocEhFrameSect,
+                          RelocIndex& pRelocs);
 
  private:
   void removeAndUpdateCIEForFDE(EhFrame& pInFrame,
@@ -250,6 +270,10 @@ class EhFrame {
   // to the nearest CIE.
   CIEMap m_FoundCIEs;
 
+  // The first CIE added for each content, so that merging an input CIE does
+  // not compare it with all output CIEs.
+  llvm::StringMap<CIE*> m_CIEIndex;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(EhFrame);
 };
@@ -17,6 +17,7 @@ namespace mcld {
 
 class LDSection;
 class FileOutputBuffer;
+class ThreadPool;
 
 /** \class EhFrameHdr
  *  \brief EhFrameHdr represents .eh_frame_hdr section.
@@ -43,14 +44,25 @@ class EhFrameHdr {
 
   /// emitOutput - write out eh_frame_hdr
   template <size_t size>
-  void emitOutput(FileOutputBuffer& pOutput) {
+  void emitOutput(FileOutputBuffer& pOutput, ThreadPool& pPool) {
     assert(false && "Call invalid EhFrameHdr::emitOutput");
   }
 
  private:
+  /// doEmitOutput - write out eh_frame_hdr of a SIZE-bit output
+  template <size_t SIZE>
+  void doEmitOutput(FileOutputBuffer& pOutput, ThreadPool& pPool);
+
   /// computePCBegin - return the address of FDE's pc
-  uint32_t computePCBegin(const EhFrame::FDE& pFDE,
-                          const MemoryRegion& pEhFrameRegion);
+  template <size_t SIZE>
+  typename SizeTraits<SIZE>::Address computePCBegin(
+      const EhFrame::FDE& pFDE,
+      const MemoryRegion& pEhFrameRegion) const;
+
+  /// getSData4 - return pAddr - pBase as a DW_EH_PE_sdata4 value
+  template <size_t SIZE>
+  int32_t getSData4(typename SizeTraits<SIZE>::Address pAddr,
+                    typename SizeTraits<SIZE>::Address pBase) const;
 
  private:
   /// .eh_frame_hdr section
@@ -65,7 +77,10 @@ class EhFrameHdr {
 //===----------------------------------------------------------------------===//
 /// emitOutput - write out eh_frame_hdr
 template <>
-void EhFrameHdr::emitOutput<32>(FileOutputBuffer& pOutput);
+void EhFrameHdr::emitOutput<32>(FileOutputBuffer& pOutput, ThreadPool& pPool);
+
+template <>
+void EhFrameHdr::emitOutput<64>(FileOutputBuffer& pOutput, ThreadPool& pPool);
 
 }  // namespace mcld
 
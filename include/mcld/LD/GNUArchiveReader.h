@@ -12,6 +12,8 @@
 #include "mcld/LD/Archive.h"
 #include "mcld/LD/ArchiveReader.h"
 
+#include <vector>
+
 namespace mcld {
 
 class Archive;
@@ -19,6 +21,7 @@ class ELFObjectReader;
 class Input;
 class LinkerConfig;
 class Module;
+class ThreadPool;
 
 /** \class GNUArchiveReader
  *  \brief GNUArchiveReader reads GNU archive files.
@@ -72,14 +75,23 @@ class GNUArchiveReader : public ArchiveReader {
   enum Archive::Symbol::Status shouldIncludeSymbol(
       const llvm::StringRef& pSymName) const;
 
+  /// prefetchMembers - read the member files of the thin archive pArchive
+  /// whose headers are at pOffsets on pPool
+  void prefetchMembers(Archive& pArchive,
+                       const std::vector<uint32_t>& pOffsets,
+                       ThreadPool& pPool);
+
   /// includeMember - include the object member in the given file offset, and
   /// return the size of the object
   /// @param pConfig - LinkerConfig
   /// @param pArchiveRoot - the archive root
   /// @param pFileOffset  - file offset of the member header in the archive
+  /// @param pStaged      - if not NULL, an object member is only staged here
+  ///                       and its symbols are left to the caller
   size_t includeMember(const LinkerConfig& pConfig,
                        Archive& pArchiveRoot,
-                       uint32_t pFileOffset);
+                       uint32_t pFileOffset,
+                       std::vector<Input*>* pStaged = NULL);
 
   /// includeAllMembers - include all object members. This is called if
   /// --whole-archive is the attribute for this archive file.
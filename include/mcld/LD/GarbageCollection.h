@@ -9,27 +9,42 @@
 #ifndef MCLD_LD_GARBAGECOLLECTION_H_
 #define MCLD_LD_GARBAGECOLLECTION_H_
 
-#include <map>
-#include <set>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+
+#include <utility>
 #include <vector>
 
 namespace mcld {
 
+class Input;
 class LDSection;
 class LinkerConfig;
 class Module;
+class ObjectReader;
 class TargetLDBackend;
 
 /** \class GarbageCollection
  *  \brief Implementation of garbage collection for --gc-section.
+ *
+ *  The relocations applied to a section that may be collected need not be
+ *  read before garbage collection. Such relocation sections are read when
+ *  their target section is reached, so the relocations of the collected
+ *  sections are never decoded.
  */
 class GarbageCollection {
  public:
-  typedef std::set<const LDSection*> SectionListTy;
+  /// SectionListTy - the sections a section reaches directly. A section may
+  /// be listed more than once; the walk visits each section only once anyway.
+  typedef std::vector<const LDSection*> SectionListTy;
   typedef std::vector<const LDSection*> SectionVecTy;
+  typedef llvm::DenseSet<const LDSection*> SectionSetTy;
 
   /** \class SectionReachedListMap
    *  \brief Map the section to the list of sections which it can reach directly
+   *
+   *  The list returned by getReachedList or findReachedList stays valid only
+   *  until a list is created for another section.
    */
   class SectionReachedListMap {
    public:
@@ -47,7 +62,7 @@ class GarbageCollection {
     SectionListTy* findReachedList(const LDSection& pSection);
 
    private:
-    typedef std::map<const LDSection*, SectionListTy> ReachedSectionsTy;
+    typedef llvm::DenseMap<const LDSection*, SectionListTy> ReachedSectionsTy;
 
    private:
     /// m_ReachedSections - map a section to the reachable sections list
@@ -57,14 +72,33 @@ class GarbageCollection {
  public:
   GarbageCollection(const LinkerConfig& pConfig,
                     const TargetLDBackend& pBackend,
-                    Module& pModule);
+                    Module& pModule,
+                    ObjectReader& pObjectReader);
   ~GarbageCollection();
 
   /// run - do garbage collection
   bool run();
 
+  /// mayDeferRelocations - check if the relocations applied to pSection can
+  /// be left unread until garbage collection reaches pSection
+  static bool mayDeferRelocations(const LDSection& pSection);
+
+ private:
+  typedef std::vector<std::pair<Input*, LDSection*> > RelocSectionList;
+  typedef llvm::DenseMap<const LDSection*, RelocSectionList>
+      PendingRelocSections;
+
  private:
   void setUpReachedSections();
+
+  /// addReachedSections - add the references made by the relocations of
+  /// pRelocSect
+  void addReachedSections(const LDSection& pRelocSect);
+
+  /// readPendingRelocations - read the unread relocation sections applied to
+  /// pSection and add their references
+  void readPendingRelocations(const LDSection& pSection);
+
   void findReferencedSections(SectionVecTy& pEntry);
   void getEntrySections(SectionVecTy& pEntry);
   void stripSections();
@@ -75,11 +109,16 @@ class GarbageCollection {
   SectionReachedListMap m_SectionReachedListMap;
 
   /// m_ReferencedSections - a list of sections which can be reached from entry
-  SectionListTy m_ReferencedSections;
+  SectionSetTy m_ReferencedSections;
+
+  /// m_PendingRelocSections - map a section to the unread relocation sections
+  /// applied to it
+  PendingRelocSections m_PendingRelocSections;
 
   const LinkerConfig& m_Config;
   const TargetLDBackend& m_Backend;
   Module& m_Module;
+  ObjectReader& m_ObjectReader;
 };
 
 }  // namespace mcld
@@ -0,0 +1,135 @@
+//===- GdbIndex.h ---------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_GDBINDEX_H_
+#define MCLD_LD_GDBINDEX_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <vector>
+
+namespace mcld {
+
+class FileOutputBuffer;
+class LDSection;
+class Module;
+class ThreadPool;
+
+/** \class GdbIndex
+ *  \brief GdbIndex represents the .gdb_index section of --gdb-index.
+ *
+ *  .gdb_index section format (version 7, always little endian)
+ *  uint32_t[6] : version, and the offsets of the unit list, the type unit
+ *                list, the address area, the symbol table and the constant
+ *                pool
+ *  <uint64_t, uint64_t>* : the offset and the size of each unit
+ *  <uint64_t, uint64_t, uint32_t>* : the address ranges and their units
+ *  <uint32_t, uint32_t>* : the symbol hash table, the offsets of the names
+ *                          and of their unit vectors in the constant pool
+ *  constant pool : the unit vectors, then the names
+ *
+ *  The units are the headers in .debug_info, the names come from the public
+ *  name and type sections and the ranges from .debug_aranges. The names and
+ *  the number of ranges do not depend on relocations, so sizeOutput reserves
+ *  the whole section before layout. The sets of names and of ranges refer to
+ *  their units by relocated offsets, and the ranges hold relocated
+ *  addresses, so resolve() reads them after the relocations are applied.
+ */
+class GdbIndex {
+ public:
+  explicit GdbIndex(LDSection& pSection);
+
+  ~GdbIndex();
+
+  /// sizeOutput - read the debug sections of pModule and size the output.
+  /// The fragments of the debug sections are read in parallel.
+  void sizeOutput(Module& pModule, ThreadPool& pPool);
+
+  /// getRelocatedSections - the sections whose relocated content resolve()
+  /// reads
+  const std::vector<LDSection*>& getRelocatedSections() const {
+    return m_RelocatedSections;
+  }
+
+  /// resolve - look up the units of the name sets and the address ranges in
+  /// pContents, the relocated content of each getRelocatedSections()
+  void resolve(const std::vector<std::vector<uint8_t> >& pContents);
+
+  /// emitOutput - write out .gdb_index
+  void emitOutput(FileOutputBuffer& pOutput, ThreadPool& pPool) const;
+
+ private:
+  struct Unit {
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  /// Set - a set of names or of ranges at pOffset in a relocated section
+  struct Set {
+    uint32_t section;
+    uint64_t offset;
+    uint32_t unit;
+  };
+
+  struct Range {
+    uint64_t low;
+    uint64_t high;
+    uint32_t unit;
+  };
+
+  /// Entry - a name in a set, and the kind and the static bit of a GNU
+  /// public name
+  struct Entry {
+    uint32_t set;
+    uint8_t flags;
+  };
+
+  struct Symbol {
+    llvm::StringRef name;
+    uint32_t name_offset;
+    uint32_t vec_offset;
+    std::vector<Entry> entries;
+  };
+
+ private:
+  /// findUnit - the index of the unit at pOffset in .debug_info
+  uint32_t findUnit(uint64_t pOffset) const;
+
+ private:
+  LDSection& m_Section;
+
+  std::vector<LDSection*> m_RelocatedSections;
+
+  std::vector<Unit> m_Units;
+
+  std::vector<Set> m_NameSets;
+
+  /// m_RangeSets - the sets of ranges, and the number of ranges at each
+  /// offset in .debug_aranges
+  std::vector<Set> m_RangeSets;
+  std::vector<uint32_t> m_NumOfRanges;
+
+  std::vector<Range> m_Ranges;
+
+  std::vector<Symbol> m_Symbols;
+
+  /// m_HashTable - the index plus one of the symbol in each slot
+  std::vector<uint32_t> m_HashTable;
+
+  uint32_t m_PoolSize;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(GdbIndex);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_GDBINDEX_H_
@@ -10,8 +10,9 @@
 #define MCLD_LD_IDENTICALCODEFOLDING_H_
 
 #include <llvm/ADT/MapVector.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
 
-#include <string>
 #include <vector>
 
 namespace mcld {
@@ -34,28 +35,62 @@ class IdenticalCodeFolding {
   typedef llvm::MapVector<LDSection*, ObjectAndId> KeptSections;
 
  private:
+  /// RelocContent - the part of a relocation that does not change while the
+  /// candidates are being folded.
+  struct RelocContent {
+    enum Kind { Recursive, Variable, Symbolic };
+
+    Kind kind;
+    uint32_t type;
+    uint64_t sym_value;
+    uint64_t addend;
+    uint64_t place;
+    /// name - the referred symbol, only for Symbolic relocations
+    llvm::StringRef name;
+    /// scope - the object that defines a local or absolute symbol
+    const Input* scope;
+  };
+
   class FoldingCandidate {
    public:
-    FoldingCandidate() : sect(NULL), reloc_sect(NULL), obj(NULL) {}
+    FoldingCandidate()
+        : sect(NULL), reloc_sect(NULL), obj(NULL), constant_hash(0),
+          content_hash(0) {}
     FoldingCandidate(LDSection* pCode, LDSection* pReloc, Input* pInput)
-        : sect(pCode), reloc_sect(pReloc), obj(pInput) {}
+        : sect(pCode), reloc_sect(pReloc), obj(pInput), constant_hash(0),
+          content_hash(0) {}
 
+    /// initConstantContent - collect and hash the section bytes and the
+    /// relocations. It only reads the candidate and pKeptSections, so the
+    /// candidates can be initialized in parallel.
     void initConstantContent(
         const TargetLDBackend& pBackend,
         const IdenticalCodeFolding::KeptSections& pKeptSections);
-    std::string getContentWithVariables(
-        const TargetLDBackend& pBackend,
+
+    /// updateVariableContent - take the kept indices of the sections that
+    /// the variable relocations refer to, and rehash the whole content.
+    void updateVariableContent(
         const IdenticalCodeFolding::KeptSections& pKeptSections);
 
+    bool hasSameContent(const FoldingCandidate& pOther) const;
+
     LDSection* sect;
     LDSection* reloc_sect;
     Input* obj;
-    std::string content;
+    uint64_t constant_hash;
+    uint64_t content_hash;
+    std::vector<llvm::StringRef> regions;
+    std::vector<RelocContent> relocs;
     std::vector<Relocation*> variable_relocs;
+    std::vector<size_t> variable_content;
   };
 
   typedef std::vector<FoldingCandidate> FoldingCandidates;
 
+  /// Dependents - the candidates whose variable relocations refer to each
+  /// kept section, indexed like KeptSections.
+  typedef std::vector<std::vector<size_t> > Dependents;
+
  public:
   IdenticalCodeFolding(const LinkerConfig& pConfig,
                        const TargetLDBackend& pBackend,
@@ -66,7 +101,12 @@ class IdenticalCodeFolding {
  private:
   void findCandidates(FoldingCandidates& pCandidateList);
 
-  bool matchCandidates(FoldingCandidates& pCandidateList);
+  void findDependents(const FoldingCandidates& pCandidateList,
+                      Dependents& pDependents) const;
+
+  bool matchCandidates(FoldingCandidates& pCandidateList,
+                       const Dependents& pDependents,
+                       std::vector<bool>& pOutdated);
 
  private:
   const LinkerConfig& m_Config;
@@ -0,0 +1,123 @@
+//===- IncrementalLayout.h ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_INCREMENTALLAYOUT_H_
+#define MCLD_LD_INCREMENTALLAYOUT_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+class Fragment;
+class Input;
+class LDSection;
+class Module;
+
+/** \class IncrementalLayout
+ *  \brief IncrementalLayout keeps the layout of an output stable between the
+ *  links of --incremental.
+ *
+ *  Every code and data section of the inputs is padded with a slack before
+ *  it is merged into its output section. The layout file next to the
+ *  output records where each input section went, how much space it reserved
+ *  and the addresses of the global symbols. On the next link, a section which
+ *  still fits its reservation is padded up to it, so the sections behind it
+ *  do not move, and only the pages that differ from the old output have to
+ *  be written.
+ *
+ *  The layout file also records a key of what the relocation results of each
+ *  debug section depend on. A section whose key did not change already has
+ *  its relocated bytes in the old output.
+ */
+class IncrementalLayout {
+ public:
+  IncrementalLayout();
+
+  ~IncrementalLayout();
+
+  /// read - read the layout file of the previous link. A missing or a
+  /// malformed file only means that nothing is reserved yet.
+  bool read(const std::string& pFile);
+
+  /// reserve - pad pSection of pInput to its reservation. This is called
+  /// before the section is merged into its output section.
+  void reserve(const Input& pInput, LDSection& pSection);
+
+  /// isRelocated - the old output holds the relocated bytes of pSection of
+  /// pInput, and they are correct for the relocation key pKey
+  bool isRelocated(const Input& pInput,
+                   const LDSection& pSection,
+                   uint64_t pKey) const;
+
+  /// addRelocated - record the relocation key of pSection of pInput
+  void addRelocated(const Input& pInput,
+                    const LDSection& pSection,
+                    uint64_t pKey);
+
+  /// getStringsKey - the hash of the merged .debug_str of the old output
+  uint64_t getStringsKey() const { return m_OldStringsKey; }
+
+  /// setStringsKey - record the hash of the merged .debug_str
+  void setStringsKey(uint64_t pKey) { m_StringsKey = pKey; }
+
+  /// write - write the layout of pModule after its output is emitted
+  bool write(const std::string& pFile,
+             const Module& pModule,
+             uint64_t pOutputSize) const;
+
+  /// canPatch - the old output pOutput can be patched in place to become an
+  /// output of pSize bytes
+  bool canPatch(const std::string& pOutput, uint64_t pSize) const;
+
+  /// getSlack - the slack reserved behind a new section of pSize bytes
+  static uint64_t getSlack(uint64_t pSize);
+
+ private:
+  /// Record - an input section of the previous link
+  struct Record {
+    uint64_t offset;
+    uint64_t reserved;
+  };
+
+  /// Entry - an input section of this link
+  struct Entry {
+    std::string key;
+    const Fragment* first;
+    uint64_t size;
+    uint64_t reserved;
+  };
+
+  typedef std::map<std::string, Record> RecordMap;
+  typedef std::map<std::string, uint64_t> SymbolMap;
+  typedef std::map<std::string, uint64_t> KeyMap;
+
+ private:
+  bool m_bRead;
+  uint64_t m_OutputSize;
+  RecordMap m_Records;
+  SymbolMap m_Symbols;
+  std::vector<Entry> m_Entries;
+  KeyMap m_OldRelocKeys;
+  KeyMap m_RelocKeys;
+  uint64_t m_OldStringsKey;
+  uint64_t m_StringsKey;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(IncrementalLayout);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_INCREMENTALLAYOUT_H_
@@ -0,0 +1,135 @@
+//===- InputCostReport.h --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_INPUTCOSTREPORT_H_
+#define MCLD_LD_INPUTCOSTREPORT_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/Support/DataTypes.h>
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+}  // namespace llvm
+
+namespace mcld {
+
+class Input;
+class Module;
+class TimeTrace;
+
+/** \class InputCostReport
+ *  \brief InputCostReport charges the time of the per-input work of the link
+ *  and the structures read from an input to the path of that input.
+ *
+ *  The phases which walk the inputs one by one time each of them by
+ *  InputCostReport::Scope, on whichever thread does the work. The members of
+ *  an archive share its path, so an archive is charged for all its members.
+ *  The counters are added up from the module when the link is done, and the
+ *  inputs which cost the most are printed by --print-stats and added to the
+ *  time trace.
+ */
+class InputCostReport {
+ public:
+  enum Phase {
+    Read,     ///< the headers, the sections and the symbol tables
+    Resolve,  ///< the symbols added to the name pool
+    GC,       ///< the references set up by --gc-sections
+    Scan,     ///< the relocations scanned for GOT, PLT and dynamic entries
+    Apply,    ///< the relocations applied
+    NumOfPhases
+  };
+
+  /** \class Scope
+   *  \brief Scope charges the time from its construction to its destruction
+   *  to an input.
+   */
+  class Scope {
+   public:
+    Scope(const Input& pInput, Phase pPhase);
+
+    ~Scope();
+
+   private:
+    const Input& m_Input;
+    Phase m_Phase;
+    std::chrono::steady_clock::time_point m_Begin;
+
+   private:
+    DISALLOW_COPY_AND_ASSIGN(Scope);
+  };
+
+ public:
+  InputCostReport();
+
+  ~InputCostReport();
+
+  /// Current - the installed report, or NULL
+  static InputCostReport* Current();
+
+  static void SetCurrent(InputCostReport* pReport);
+
+  /// PhaseName - the name of pPhase in the report and the trace
+  static const char* PhaseName(Phase pPhase);
+
+  /// addTime - charge pMicros microseconds of pPhase to pInput. It may be
+  /// called by several threads at once.
+  void addTime(const Input& pInput, Phase pPhase, uint64_t pMicros);
+
+  /// addModule - count the mapped bytes, the symbols, the relocations, the
+  /// sections and the branches to stubs of every input of pModule
+  void addModule(const Module& pModule);
+
+  /// print - print the pNumber inputs which took the longest
+  void print(llvm::raw_ostream& pOS, size_t pNumber) const;
+
+  /// addEvents - add the pNumber inputs which took the longest to pTrace,
+  /// with their costs as the arguments of the events
+  void addEvents(TimeTrace& pTrace, size_t pNumber) const;
+
+ private:
+  struct Cost {
+    Cost();
+
+    /// time - the microseconds of all phases
+    uint64_t time() const;
+
+    uint64_t times[NumOfPhases];  ///< in microseconds
+    uint64_t bytes;
+    uint64_t symbols;
+    uint64_t relocations;
+    uint64_t sections;
+    uint64_t stubs;
+  };
+
+  typedef std::map<std::string, Cost> CostMap;
+
+  /// getTopInputs - the pNumber inputs which took the longest, the longest
+  /// first
+  void getTopInputs(size_t pNumber,
+                    std::vector<CostMap::const_iterator>& pInputs) const;
+
+ private:
+  std::mutex m_Mutex;
+
+  /// m_Costs - the costs by the paths of the inputs
+  CostMap m_Costs;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(InputCostReport);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_INPUTCOSTREPORT_H_
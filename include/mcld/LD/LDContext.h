@@ -11,16 +11,14 @@
 
 #include "mcld/LD/LDFileFormat.h"
 
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
 #include <llvm/Support/DataTypes.h>
 
 #include <cassert>
 #include <string>
 #include <vector>
 
-namespace llvm {
-class StringRef;
-}  // namespace llvm
-
 namespace mcld {
 
 class LDSymbol;
@@ -40,6 +38,8 @@ class LDContext {
   typedef SymbolTable::const_iterator const_sym_iterator;
 
  public:
+  LDContext();
+
   // -----  sections  ----- //
   LDContext& appendSection(LDSection& pSection);
 
@@ -52,10 +52,13 @@ class LDContext {
   const LDSection* getSection(unsigned int pIdx) const;
   LDSection* getSection(unsigned int pIdx);
 
-  const LDSection* getSection(const std::string& pName) const;
-  LDSection* getSection(const std::string& pName);
+  /// getSection - the first section named pName, or NULL if there is none.
+  const LDSection* getSection(const llvm::StringRef& pName) const;
+  LDSection* getSection(const llvm::StringRef& pName);
 
-  size_t getSectionIdx(const std::string& pName) const;
+  /// getSectionIdx - the index of the first section named pName, or 0 if
+  /// there is none.
+  size_t getSectionIdx(const llvm::StringRef& pName) const;
 
   size_t numOfSections() const { return m_SectionTable.size(); }
 
@@ -81,12 +84,25 @@ class LDContext {
   const_sect_iterator relocSectEnd() const { return m_RelocSections.end(); }
   sect_iterator relocSectEnd() { return m_RelocSections.end(); }
 
+ private:
+  typedef llvm::StringMap<size_t> SectionIndex;
+
+  /// updateSectionIndex - add the sections appended since the last lookup to
+  /// the name index. The index is built on first use, so that inputs whose
+  /// sections are never looked up by name do not pay for it.
+  void updateSectionIndex() const;
+
  private:
   SectionTable m_SectionTable;
   SymbolTable m_SymTab;
   SectionTable m_RelocSections;
 
-  // FIXME : maintain a map<section name, section index>
+  /// m_SectionIndex - map the name of a section to its index. Only the first
+  /// one of the sections with the same name is recorded.
+  mutable SectionIndex m_SectionIndex;
+
+  /// m_NumOfIndexed - the number of leading sections in m_SectionIndex
+  mutable size_t m_NumOfIndexed;
 };
 
 }  // namespace mcld
@@ -57,8 +57,14 @@ class LDSection {
 
   bool hasOffset() const;
 
-  /// name - the name of this section.
-  const std::string& name() const { return m_Name; }
+  /// name - the name of this section. All sections of the same name share
+  /// one interned copy of it.
+  const std::string& name() const { return *m_pName; }
+
+  /// hasSameName - compare names by their interned copies.
+  bool hasSameName(const LDSection& pOther) const {
+    return (m_pName == pOther.m_pName);
+  }
 
   /// kind - the kind of this section, such as Text, BSS, GOT, and so on.
   /// from LDFileFormat::Kind
@@ -102,8 +108,16 @@ class LDSection {
   ///   Before layouting, output's LDSection::align() should return zero.
   uint32_t align() const { return m_Align; }
 
+  /// entSize - the size of each entry of a table section, or zero.
+  ///   In ELF, it is sh_entsize.
+  uint32_t entSize() const { return m_EntSize; }
+
   size_t index() const { return m_Index; }
 
+  /// order - the layout order the backend classifies an output section into
+  /// when it places the section, or ~0U before then.
+  unsigned int order() const { return m_Order; }
+
   /// getLink - return the Link. When a section A needs the other section B
   /// during linking or loading, we say B is A's Link section.
   /// In ELF, InfoLink section control the ElfNN_Shdr::sh_link and sh_info.
@@ -125,6 +139,8 @@ class LDSection {
 
   void setAlign(uint32_t align) { m_Align = align; }
 
+  void setEntSize(uint32_t pEntSize) { m_EntSize = pEntSize; }
+
   void setFlag(uint32_t flag) { m_Flag = flag; }
 
   void setType(uint32_t type) { m_Type = type; }
@@ -170,6 +186,8 @@ class LDSection {
 
   void setIndex(size_t pIndex) { m_Index = pIndex; }
 
+  void setOrder(unsigned int pOrder) { m_Order = pOrder; }
+
  private:
   union Data {
     SectionData* sect_data;
@@ -179,7 +197,8 @@ class LDSection {
   };
 
  private:
-  std::string m_Name;
+  /// m_pName - the interned name, owned by the section name pool
+  const std::string* m_pName;
 
   LDFileFormat::Kind m_Kind;
   uint32_t m_Type;
@@ -189,6 +208,7 @@ class LDSection {
   uint64_t m_Offset;
   uint64_t m_Addr;
   uint32_t m_Align;
+  uint32_t m_EntSize;
 
   size_t m_Info;
   LDSection* m_pLink;
@@ -198,6 +218,8 @@ class LDSection {
 
   /// m_Index - the index of the file
   size_t m_Index;
+
+  unsigned int m_Order;
 };  // end of LDSection
 
 }  // namespace mcld
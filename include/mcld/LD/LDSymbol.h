@@ -110,6 +110,12 @@ class LDSymbol {
 
   bool hasFragRef() const;
 
+  /// symIdx - the index in the output symbol table, .symtab of a relocatable
+  /// output or .dynsym otherwise. It is set when the table is emitted.
+  uint32_t symIdx() const { return m_SymIdx; }
+
+  bool hasSymIdx() const { return (m_SymIdx != NoSymIdx); }
+
   // -----  modifiers  ----- //
   void setSize(SizeType pSize) {
     assert(m_pResolveInfo != NULL);
@@ -118,12 +124,15 @@ class LDSymbol {
 
   void setValue(ValueType pValue) { m_Value = pValue; }
 
+  void setSymIdx(uint32_t pIdx) { m_SymIdx = pIdx; }
+
   void setFragmentRef(FragmentRef* pFragmentRef);
 
   void setResolveInfo(const ResolveInfo& pInfo);
 
  private:
   friend class Chunk<LDSymbol, MCLD_SYMBOLS_PER_INPUT>;
+  friend class SymbolCategory;
   template <class T>
   friend void* llvm::object_creator();
 
@@ -131,11 +140,19 @@ class LDSymbol {
   LDSymbol(const LDSymbol& pCopy);
   LDSymbol& operator=(const LDSymbol& pCopy);
 
+ private:
+  static const uint32_t NoSymIdx = ~0U;
+
  private:
   // -----  Symbol's fields  ----- //
   ResolveInfo* m_pResolveInfo;
   FragmentRef* m_pFragRef;
   ValueType m_Value;
+  uint32_t m_SymIdx;
+
+  // the position in the SymbolCategory of the output symbols, kept by
+  // SymbolCategory itself
+  uint32_t m_CategoryPos;
 };
 
 }  // namespace mcld
@@ -0,0 +1,95 @@
+//===- LTOCodeGen.h -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_LTOCODEGEN_H_
+#define MCLD_LD_LTOCODEGEN_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/ADT/StringRef.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+class Input;
+class IRBuilder;
+class Module;
+class ThreadPool;
+
+/** \class BitcodeCompiler
+ *  \brief BitcodeCompiler compiles a bitcode module into a relocatable object
+ *  of the target.
+ *
+ *  MCLinker has no code generator of its own. A driver which links one in
+ *  installs it by Linker::setBitcodeCompiler.
+ */
+class BitcodeCompiler {
+ public:
+  virtual ~BitcodeCompiler() {}
+
+  /// getCacheKey - the version and the options of the code generator. An
+  /// object in the cache is only used for the same key.
+  virtual std::string getCacheKey() const = 0;
+
+  /// compile - compile the module pBitcode of the input pName into pObject.
+  /// Several modules are compiled at once on different threads.
+  virtual bool compile(const std::string& pName,
+                       llvm::StringRef pBitcode,
+                       std::string& pObject) = 0;
+};
+
+/** \class LTOCodeGen
+ *  \brief LTOCodeGen compiles the bitcode inputs of a link and adds their
+ *  objects to the input tree.
+ *
+ *  Every module is compiled on its own, as the backends of ThinLTO are, so
+ *  the modules are compiled in parallel. With a cache directory, the object
+ *  of a module is named after the digest of the module and of the key of the
+ *  compiler, and a module compiled by an earlier link is not compiled again.
+ *  The objects follow the inputs of the command line.
+ */
+class LTOCodeGen {
+ public:
+  LTOCodeGen(BitcodeCompiler& pCompiler, const std::string& pCacheDir);
+
+  ~LTOCodeGen();
+
+  /// isBitcode - pInput is a bitcode file or a bitcode wrapper
+  static bool isBitcode(Input& pInput);
+
+  /// run - compile the bitcode inputs of pModule which are not compiled yet,
+  /// and add their objects by pBuilder.
+  /// @return false if a module cannot be compiled
+  bool run(Module& pModule, IRBuilder& pBuilder, ThreadPool& pPool);
+
+  /// numOfObjects - the objects added by run so far
+  size_t numOfObjects() const { return m_NumOfObjects; }
+
+ private:
+  BitcodeCompiler& m_Compiler;
+  std::string m_CacheDir;
+
+  /// m_Compiled - the bitcode inputs compiled by the earlier runs
+  std::set<const Input*> m_Compiled;
+
+  /// m_Objects - the objects compiled by this link. The inputs read them
+  /// in place.
+  std::vector<std::string*> m_Objects;
+
+  size_t m_NumOfObjects;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LTOCodeGen);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_LTOCODEGEN_H_
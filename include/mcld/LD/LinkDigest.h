@@ -0,0 +1,80 @@
+//===- LinkDigest.h -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_LINKDIGEST_H_
+#define MCLD_LD_LINKDIGEST_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <string>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+}  // namespace llvm
+
+namespace mcld {
+
+class Module;
+
+/** \class LinkDigest
+ *  \brief LinkDigest hashes the symbols and the output sections of a link as
+ *  each phase ends, and the output once it is written, for
+ *  --verify-determinism.
+ *
+ *  The symbols are hashed whatever their order in the name pool is, and the
+ *  output sections and their fragments in their order in the module. Links
+ *  of the same inputs are expected to agree phase by phase whatever the
+ *  number of threads, so the first phase whose digests differ is where a
+ *  link went nondeterministic.
+ */
+class LinkDigest {
+ public:
+  struct Entry {
+    std::string phase;
+    uint64_t symbols;   ///< the symbols of the name pool, in any order
+    uint64_t sections;  ///< the output sections and their fragments
+    uint64_t output;    ///< the bytes of the output, once written
+  };
+
+  typedef std::vector<Entry> EntryList;
+
+ public:
+  LinkDigest();
+
+  ~LinkDigest();
+
+  /// addPhase - digest the symbols and the sections of pModule at the end of
+  /// the phase pPhase
+  void addPhase(llvm::StringRef pPhase, const Module& pModule);
+
+  /// addOutput - digest pContents, the bytes of the output
+  void addOutput(llvm::StringRef pContents);
+
+  const EntryList& entries() const { return m_Entries; }
+
+  /// write - write the digests to pOS, one phase per line
+  void write(llvm::raw_ostream& pOS) const;
+
+  /// read - read the digests written by write(). Return false if pContents
+  /// is malformed.
+  bool read(llvm::StringRef pContents);
+
+ private:
+  EntryList m_Entries;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LinkDigest);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_LINKDIGEST_H_
@@ -0,0 +1,67 @@
+//===- MapWriter.h --------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_MAPWRITER_H_
+#define MCLD_LD_MAPWRITER_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/Support/DataTypes.h>
+
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+}  // namespace llvm
+
+namespace mcld {
+
+class Fragment;
+class Input;
+class LDSection;
+class Module;
+
+/** \class MapWriter
+ *  \brief MapWriter writes the link map of -M and -Map.
+ *
+ *  The input sections are recorded by their first fragment when they are
+ *  merged, which costs a pointer or three per section. After the layout, the
+ *  map is streamed out section by section: every output section, the input
+ *  sections laid out in it and the symbols defined in them, in address order.
+ */
+class MapWriter {
+ public:
+  MapWriter();
+
+  ~MapWriter();
+
+  /// record - pSection of pInput is about to be merged into its output
+  /// section
+  void record(const Input& pInput, const LDSection& pSection);
+
+  /// write - write the map of the laid out pModule to pOS
+  void write(llvm::raw_ostream& pOS, const Module& pModule) const;
+
+ private:
+  /// Entry - an input section of this link
+  struct Entry {
+    const Input* input;
+    const LDSection* section;
+    const Fragment* first;
+  };
+
+ private:
+  std::vector<Entry> m_Entries;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(MapWriter);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_MAPWRITER_H_
@@ -0,0 +1,88 @@
+//===- MemoryReport.h -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_MEMORYREPORT_H_
+#define MCLD_LD_MEMORYREPORT_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <string>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+}  // namespace llvm
+
+namespace mcld {
+
+class Module;
+
+/** \class MemoryReport
+ *  \brief MemoryReport adds up the objects and the bytes held by the data
+ *  structures of the link after each phase, for --print-memory-usage.
+ *
+ *  The structures are walked when a phase ends, so the link pays nothing
+ *  unless the report is asked for. The bytes are the sizes of the objects
+ *  and of the buffers they own, not what the allocator rounds them up to.
+ *  A structure that lives only within a phase, such as the candidates of
+ *  identical code folding, adds itself to the current report before it is
+ *  gone, and it is counted in the sample of that phase.
+ */
+class MemoryReport {
+ public:
+  MemoryReport();
+
+  ~MemoryReport();
+
+  /// Current - the installed report, or NULL
+  static MemoryReport* Current();
+
+  static void SetCurrent(MemoryReport* pReport);
+
+  /// add - count pObjects objects of pBytes bytes in total to the structure
+  /// pName of the sample which is not ended yet
+  void add(llvm::StringRef pName, uint64_t pObjects, uint64_t pBytes);
+
+  /// addModule - count the symbols, the sections, the fragments, the
+  /// relocations and the mapped inputs of pModule
+  void addModule(const Module& pModule);
+
+  /// endSample - end the sample of the phase pPhase
+  void endSample(llvm::StringRef pPhase);
+
+  /// print - print the structures of every sample
+  void print(llvm::raw_ostream& pOS) const;
+
+ private:
+  struct Usage {
+    std::string name;
+    uint64_t objects;
+    uint64_t bytes;
+  };
+
+  struct Sample {
+    std::string phase;
+    std::vector<Usage> usages;
+  };
+
+ private:
+  std::vector<Sample> m_Samples;
+
+  /// m_Current - the structures counted since the last sample
+  std::vector<Usage> m_Current;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(MemoryReport);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_MEMORYREPORT_H_
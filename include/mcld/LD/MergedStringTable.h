@@ -14,49 +14,110 @@
 #include <llvm/ADT/StringMap.h>
 #include <llvm/ADT/StringRef.h>
 
+#include <vector>
+
 namespace mcld {
 
+class ThreadPool;
+
 /** \class MergedStringTable
  *  \brief MergedStringTable represents the mergeable string table. The sections
  *  with flag SHF_MERGED and SHF_STRING are mergeable. Every string in
  *  MergedStringTable is unique.
+ *
+ *  Strings are spread over a fixed number of shards by their hash, so that
+ *  the shards are filled and laid out in parallel. A string that is a suffix
+ *  of another one is not emitted; it points into the tail of the longer one.
+ *
+ *  The table also merges the fixed-size entries of SHF_MERGE sections without
+ *  SHF_STRINGS. Each entry is a piece of its own, and no tail is shared.
  */
 class MergedStringTable {
  public:
-  typedef llvm::StringMap<size_t> StringMapTy;
+  /// Piece - the output location of a unique string.
+  struct Piece {
+    Piece() : offset(0), owner(NULL), delta(0) {}
+
+    uint64_t offset;
+    /// owner - the emitted string that this string is a suffix of, or NULL
+    /// if this string is emitted itself
+    Piece* owner;
+    /// delta - the position of this string in its owner
+    uint64_t delta;
+  };
+
+  typedef llvm::StringMap<Piece> StringMapTy;
+
+  enum { NumShards = 32 };
 
  public:
-  MergedStringTable() {}
+  /// @param pEntSize the size of a character, or of an entry if pIsStrings is
+  ///        false
+  explicit MergedStringTable(unsigned pEntSize = 1, bool pIsStrings = true);
 
-  /// insertString - insert a string to the string table
-  /// @return false if the string already exists in the map.
-  bool insertString(llvm::StringRef pString);
+  /// addStrings - add a block of NUL-terminated strings to the string table.
+  /// The block is split and merged when finalizeOffset is called.
+  void addStrings(llvm::StringRef pStrings);
 
   /// finalizeOffset - finalize the output offset of strings. After this
   /// function been called, any string should not be added to this table
   /// @return the section size
-  uint64_t finalizeOffset();
+  uint64_t finalizeOffset(ThreadPool& pPool);
 
   /// emit - emit the string table
   void emit(MemoryRegion& pRegion);
 
   /// ----- observers -----///
   /// getOutputOffset - get the output offset of the string. This should be
-  /// called after finalizeOffset.
-  size_t getOutputOffset(llvm::StringRef pStr);
+  /// called after finalizeOffset. It is safe to call from several threads.
+  size_t getOutputOffset(llvm::StringRef pStr) const;
+
+  /// getOutputOffset - get the output offset of the byte at pOffset of an
+  /// added block.
+  uint64_t getOutputOffset(llvm::StringRef pBlock, uint64_t pOffset) const;
+
+  /// getPiece - the string, without its terminator, or the entry that
+  /// begins at pOffset of pBlock.
+  llvm::StringRef getPiece(llvm::StringRef pBlock, uint64_t pOffset) const;
+
+  /// numOfStrings - the unique strings, which are only known after
+  /// finalizeOffset is called
+  size_t numOfStrings() const;
+
+  /// memoryUsage - the bytes of the blocks and of the string maps
+  uint64_t memoryUsage() const;
 
  private:
   typedef StringMapTy::iterator string_map_iterator;
   typedef StringMapTy::const_iterator const_string_map_iterator;
 
+  /// Shard - the strings whose hash falls into one shard
+  struct Shard {
+    Shard() : size(0), base(0) {}
+
+    /// strings - maps the string to its output location
+    StringMapTy strings;
+    /// size - the size of the strings emitted by this shard
+    uint64_t size;
+    /// base - the output offset of the first string of this shard
+    uint64_t base;
+  };
+
+ private:
+  void fillShards(ThreadPool& pPool);
+
+  void mergeTails(ThreadPool& pPool);
+
+  bool isTerminator(llvm::StringRef pBlock, uint64_t pOffset) const;
+
  private:
-  /// m_StringMap - the string pool of this section. It maps the string to the
-  /// output offset. The key of this map is the string, and the value is output
-  /// offset
-  StringMapTy m_StringMap;
+  unsigned m_EntSize;
+  /// m_TermSize - the size of the terminator emitted after each piece
+  unsigned m_TermSize;
+  std::vector<llvm::StringRef> m_Blocks;
+  std::vector<Shard> m_Shards;
 };
 
 }  // namespace mcld
 
 #endif  // MCLD_LD_MERGEDSTRINGTABLE_H_
-
@@ -18,6 +18,8 @@
 
 namespace mcld {
 
+class ResolveInfo;
+
 /** \class MsgHandler
  *  \brief MsgHandler controls the timing to output message.
  */
@@ -68,6 +70,14 @@ inline const MsgHandler& operator<<(const MsgHandler& pHandler,
   return pHandler;
 }
 
+/// a symbol is kept as is, and demangled only if the message is printed
+inline const MsgHandler& operator<<(const MsgHandler& pHandler,
+                                    const ResolveInfo& pInfo) {
+  pHandler.addTaggedVal(reinterpret_cast<intptr_t>(&pInfo),
+                        DiagnosticEngine::ak_symbol);
+  return pHandler;
+}
+
 inline const MsgHandler& operator<<(const MsgHandler& pHandler, int pValue) {
   pHandler.addTaggedVal(pValue, DiagnosticEngine::ak_sint);
   return pHandler;
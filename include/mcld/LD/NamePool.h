@@ -13,16 +13,20 @@
 #include "mcld/ADT/StringHash.h"
 #include "mcld/Config/Config.h"
 #include "mcld/LD/ResolveInfo.h"
+#include "mcld/LD/ResolveInfoFactory.h"
 #include "mcld/LD/Resolver.h"
 #include "mcld/Support/Compiler.h"
 #include "mcld/Support/GCFactory.h"
 
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/StringRef.h>
 
 #include <utility>
 
 namespace mcld {
 
+class Input;
+
 /** \class NamePool
  *  \brief Store symbol and search symbol by name. Can help symbol resolution.
  *
@@ -30,7 +34,8 @@ namespace mcld {
  */
 class NamePool {
  public:
-  typedef HashTable<ResolveInfo, hash::StringHash<hash::DJB> > Table;
+  typedef HashTable<ResolveInfo, ResolveInfo::hasher, ResolveInfoFactory>
+      Table;
   typedef Table::iterator syminfo_iterator;
   typedef Table::const_iterator const_syminfo_iterator;
 
@@ -74,6 +79,21 @@ class NamePool {
                     ResolveInfo* pOldInfo,
                     Resolver::Result& pResult);
 
+  /// insertSymbol - insert a symbol whose hash value pHashValue has been
+  /// computed by ResolveInfo::hasher, so that the pool does not hash pName
+  /// again. The hash values can be computed concurrently ahead of time.
+  void insertSymbol(const llvm::StringRef& pName,
+                    uint32_t pHashValue,
+                    bool pIsDyn,
+                    ResolveInfo::Type pType,
+                    ResolveInfo::Desc pDesc,
+                    ResolveInfo::Binding pBinding,
+                    ResolveInfo::SizeType pSize,
+                    LDSymbol::ValueType pValue,
+                    ResolveInfo::Visibility pVisibility,
+                    ResolveInfo* pOldInfo,
+                    Resolver::Result& pResult);
+
   /// findSymbol - find the resolved output LDSymbol
   const LDSymbol* findSymbol(const llvm::StringRef& pName) const;
   LDSymbol* findSymbol(const llvm::StringRef& pName);
@@ -82,6 +102,13 @@ class NamePool {
   const ResolveInfo* findInfo(const llvm::StringRef& pName) const;
   ResolveInfo* findInfo(const llvm::StringRef& pName);
 
+  /// setDynDefiner - the shared object pInput defines pInfo. A non-weak
+  /// reference resolved to pInfo afterwards marks pInput needed, so that
+  /// --as-needed knows the used shared objects without walking the symbols.
+  void setDynDefiner(const ResolveInfo& pInfo, Input& pInput) {
+    m_DynDefiners[&pInfo] = &pInput;
+  }
+
   /// insertString - insert a string
   /// if the string has existed, modify pString to the existing string
   /// @return the StringRef points to the hash table
@@ -114,6 +141,8 @@ class NamePool {
   const_freeinfo_iterator freeinfo_end() const { return m_FreeInfoSet.end(); }
 
   // -----  capacity  ----- //
+  /// reserve - make room for pN symbols in total, so that inserting them does
+  /// not rehash the pool. The pool never shrinks.
   void reserve(size_type pN);
 
   size_type capacity() const;
@@ -123,6 +152,9 @@ class NamePool {
   Table m_Table;
   FreeInfoSet m_FreeInfoSet;
 
+  /// m_DynDefiners - the shared objects which define the symbols
+  llvm::DenseMap<const ResolveInfo*, Input*> m_DynDefiners;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(NamePool);
 };
@@ -12,11 +12,20 @@
 #include "mcld/ADT/StringHash.h"
 #include "mcld/LD/LDReader.h"
 #include "mcld/LD/ResolveInfo.h"
+#include "mcld/LD/ResolveInfoFactory.h"
+
+#include <llvm/ADT/StringRef.h>
+
+#include <string>
+#include <vector>
 
 namespace mcld {
 
 class Input;
+class LDSection;
 class Module;
+class NamePool;
+class ThreadPool;
 
 /** \class ObjectReader
  *  \brief ObjectReader provides an common interface for different object
@@ -24,9 +33,27 @@ class Module;
  */
 class ObjectReader : public LDReader {
  protected:
-  typedef HashTable<ResolveInfo, hash::StringHash<hash::DJB> >
+  typedef HashTable<ResolveInfo, ResolveInfo::hasher, ResolveInfoFactory>
       GroupSignatureMap;
 
+ public:
+  /// StagedSymbol - a symbol decoded from an input file, waiting to be added
+  /// into the module. The name points into the string table of the input,
+  /// which is mapped for the whole link, or to the name of its section.
+  struct StagedSymbol {
+    llvm::StringRef name;
+    uint32_t hash;  ///< ResolveInfo::hasher of name, 0 for the local symbols
+    ResolveInfo::Type type;
+    ResolveInfo::Desc desc;
+    ResolveInfo::Binding binding;
+    ResolveInfo::SizeType size;
+    uint64_t value;
+    LDSection* section;
+    ResolveInfo::Visibility visibility;
+  };
+
+  typedef std::vector<StagedSymbol> SymbolStage;
+
  protected:
   ObjectReader() {}
 
@@ -37,13 +64,42 @@ class ObjectReader : public LDReader {
 
   virtual bool readSymbols(Input& pFile) = 0;
 
+  /// parseSymbols - decode the symbols of pFile into pStage.
+  ///
+  /// This function does not touch the module, so different inputs can be
+  /// parsed concurrently. It should be called after readSections.
+  virtual bool parseSymbols(Input& pFile, SymbolStage& pStage) const = 0;
+
+  /// addSymbols - add the symbols decoded by parseSymbols into the module.
+  virtual bool addSymbols(Input& pFile, const SymbolStage& pStage) = 0;
+
+  /// addStagedSymbols - decode the symbol tables of pInputs concurrently, and
+  /// then add the symbols into the module in input order so that symbol
+  /// resolution does not depend on scheduling. pInputs is cleared.
+  void addStagedSymbols(ThreadPool& pPool,
+                        NamePool& pNamePool,
+                        std::vector<Input*>& pInputs);
+
   virtual bool readSections(Input& pFile) = 0;
 
+  /// readEhFrames - parse the .eh_frame sections of pFile into CIEs and FDEs.
+  ///
+  /// This function only touches the sections of pFile, so different inputs
+  /// can be read concurrently. It should be called after readSections.
+  virtual bool readEhFrames(Input& pFile) = 0;
+
+  /// decompressSections - inflate the compressed debug sections that
+  /// readSections kept. This should be called before readRelocations.
+  virtual bool decompressSections(ThreadPool& pPool) = 0;
+
   /// readRelocations - read relocation sections
   ///
   /// This function should be called after symbol resolution.
   virtual bool readRelocations(Input& pFile) = 0;
 
+  /// readRelocation - read the relocation section pRelocSect of pFile
+  virtual bool readRelocation(Input& pFile, LDSection& pRelocSect) = 0;
+
   GroupSignatureMap& signatures() { return f_GroupSignatureMap; }
 
   const GroupSignatureMap& signatures() const { return f_GroupSignatureMap; }
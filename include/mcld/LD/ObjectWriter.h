@@ -8,11 +8,14 @@
 //===----------------------------------------------------------------------===//
 #ifndef MCLD_LD_OBJECTWRITER_H_
 #define MCLD_LD_OBJECTWRITER_H_
+#include "mcld/Support/MemoryRegion.h"
+
 #include <system_error>
 
 namespace mcld {
 
 class FileOutputBuffer;
+class LDSection;
 class Module;
 
 /** \class ObjectWriter
@@ -29,6 +32,12 @@ class ObjectWriter {
                                       FileOutputBuffer& pOutput) = 0;
 
   virtual size_t getOutputSize(const Module& pModule) const = 0;
+
+  /// emitSectionContent - write the content of pSection into pRegion, without
+  /// the relocation results
+  virtual void emitSectionContent(Module& pModule,
+                                  LDSection& pSection,
+                                  MemoryRegion& pRegion) = 0;
 };
 
 }  // namespace mcld
@@ -30,8 +30,15 @@ class LDSection;
  *  \brief RelocData stores Relocation.
  *
  *  Since Relocations are created by GCFactory, we use GCFactoryListTraits for
- *the
- *  RelocationList here to avoid iplist to delete Relocations.
+ *  the RelocationList here to avoid iplist to delete Relocations.
+ *
+ *  The factory hands out Relocations from chunks of
+ *  MCLD_RELOCATIONS_PER_INPUT entries in creation order, and readers create
+ *  the relocations of a section one after another. Walking the list of an
+ *  input section therefore visits memory sequentially. Relocations are kept
+ *  as list nodes rather than columns of arrays because stubs, GOT/PLT entries
+ *  and the relocation sections of partial links refer to individual
+ *  Relocations and move them between lists.
  */
 class RelocData {
  private:
@@ -92,6 +99,11 @@ class RelocData {
     mcld::sort(m_Relocations, pComparator);
   }
 
+  template <class KeyFunc>
+  void sortByKey(KeyFunc pKeyOf) {
+    mcld::sortByKey(m_Relocations, pKeyOf);
+  }
+
  private:
   RelocationListType m_Relocations;
   LDSection* m_pSection;
@@ -11,6 +11,9 @@
 
 #include "mcld/Fragment/Relocation.h"
 
+#include <utility>
+#include <vector>
+
 namespace mcld {
 
 class Input;
@@ -32,6 +35,9 @@ class Relocator {
  public:
   enum Result { OK, BadReloc, Overflow, Unsupported, Unknown };
 
+  typedef std::vector<Relocation*> RelocList;
+  typedef std::vector<std::pair<Relocation*, Result> > FailureList;
+
  public:
   explicit Relocator(const LinkerConfig& pConfig) : m_Config(pConfig) {}
 
@@ -40,6 +46,22 @@ class Relocator {
   /// apply - general apply function
   virtual Result applyRelocation(Relocation& pRelocation) = 0;
 
+  /// applyRelocations - apply the relocations of a section, and append the
+  /// ones which fail and their results to pFailures. The default applies each
+  /// of them by applyRelocation(). A target may override it to apply its most
+  /// common types without the dispatch of each relocation.
+  virtual void applyRelocations(const RelocList& pRelocs,
+                                FailureList& pFailures);
+
+  /// applyDebugRelocations - apply the relocations of a non-allocated debug
+  /// section. Their absolute relocations need neither PLT nor dynamic
+  /// relocation, so a target may override it to compute S + A for them
+  /// directly. The default is applyRelocations().
+  virtual void applyDebugRelocations(const RelocList& pRelocs,
+                                     FailureList& pFailures) {
+    applyRelocations(pRelocs, pFailures);
+  }
+
   /// scanRelocation - When read in relocations, backend can do any modification
   /// to relocation and generate empty entries, such as GOT, dynamic relocation
   /// entries and other target dependent entries. These entries are generated
@@ -54,6 +76,14 @@ class Relocator {
                               LDSection& pSection,
                               Input& pInput) = 0;
 
+  /// mayNeedScan - check if scanRelocation may do anything for pReloc, which
+  /// applies to pSection. This only reads the relocation and its symbol, so
+  /// relocations are checked concurrently, and only the ones that may need a
+  /// scan are scanned in order. The relocations of non-allocated sections
+  /// never need one.
+  virtual bool mayNeedScan(const Relocation& pReloc,
+                           const LDSection& pSection) const;
+
   /// issueUndefRefError - Provides a basic version for undefined reference
   /// dump.
   /// It will handle the filename and function name automatically.
@@ -80,6 +110,29 @@ class Relocator {
   /// @return - return true for finalization success
   virtual bool finalizeApply(Input& pInput) { return true; }
 
+  /// prepareApply - called once before the relocations of pModule are
+  /// applied, when the addresses are final. A target can find here the
+  /// relocation types which cannot overflow in this output, and skip their
+  /// range checks.
+  virtual void prepareApply(const Module& pModule) {}
+
+  /// mayApplyInParallel - check if relocations of different inputs can be
+  /// applied concurrently. A target which keeps per-input state between
+  /// initializeApply() and finalizeApply(), or creates entries while applying,
+  /// should override this function and return false.
+  virtual bool mayApplyInParallel() const { return true; }
+
+  /// mayReorderRelocations - check if the relocations of a section can be
+  /// applied in another order than that of the input. A target which pairs
+  /// relocations by their order should override this function and return
+  /// false.
+  virtual bool mayReorderRelocations() const { return true; }
+
+  /// issueApplyResult - report the diagnostic of a failed applyRelocation()
+  /// @param pResult - the value returned by applyRelocation()
+  /// @param pReloc - the applied relocation entry
+  void issueApplyResult(Result pResult, Relocation& pReloc);
+
   /// partialScanRelocation - When doing partial linking, backend can do any
   /// modification to relocation to fix the relocation offset after section
   /// merge
@@ -9,6 +9,8 @@
 #ifndef MCLD_LD_RESOLVEINFO_H_
 #define MCLD_LD_RESOLVEINFO_H_
 
+#include "mcld/ADT/StringHash.h"
+
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Support/DataTypes.h>
 
@@ -73,11 +75,27 @@ class ResolveInfo {
 
   // -----  For HashTable  ----- //
   typedef llvm::StringRef key_type;
+  typedef hash::StringHash<hash::MURMUR> hasher;
 
  public:
   // -----  factory method  ----- //
   static ResolveInfo* Create(const key_type& pKey);
 
+  /// Create - create the ResolveInfo of pKey whose hash value pHashValue has
+  /// been computed by hasher
+  static ResolveInfo* Create(const key_type& pKey, uint32_t pHashValue);
+
+  /// Create - create the ResolveInfo of pKey in pPlace, which has at least
+  /// SizeOf(pKey) bytes. Such a ResolveInfo is never given to Destroy().
+  static ResolveInfo* Create(void* pPlace,
+                             const key_type& pKey,
+                             uint32_t pHashValue);
+
+  /// SizeOf - the bytes of the ResolveInfo of pKey, including its name
+  static size_t SizeOf(const key_type& pKey) {
+    return sizeof(ResolveInfo) + pKey.size() + 1;
+  }
+
   static void Destroy(ResolveInfo*& pInfo);
 
   static ResolveInfo* Null();
@@ -185,6 +203,9 @@ class ResolveInfo {
 
   uint32_t bitfield() const { return m_BitField; }
 
+  /// hashValue - the hash value of the name, computed once by Create()
+  uint32_t hashValue() const { return m_HashValue; }
+
   // shouldForceLocal - check if this symbol should be forced to local
   bool shouldForceLocal(const LinkerConfig& pConfig);
 
@@ -266,6 +287,7 @@ class ResolveInfo {
    * visibility|Local|Com|Def|Dyn|Weak|
    */
   uint32_t m_BitField;
+  uint32_t m_HashValue;
   char m_Name[];
 };
 
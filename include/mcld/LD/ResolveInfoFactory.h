@@ -0,0 +1,60 @@
+//===- ResolveInfoFactory.h -----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_RESOLVEINFOFACTORY_H_
+#define MCLD_LD_RESOLVEINFOFACTORY_H_
+
+#include "mcld/LD/ResolveInfo.h"
+#include "mcld/Support/Compiler.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace mcld {
+
+/** \class ResolveInfoFactory
+ *  \brief ResolveInfoFactory is the entry factory of the NamePool. It carves
+ *  the ResolveInfos and their inline names out of large chunks.
+ *
+ *  The entries are laid out one after another in the order they are created,
+ *  so the symbols of an input stay close together, and no entry pays for the
+ *  header and the rounding of a heap block. Only the entry created last can
+ *  be given back, which is what the NamePool does with the temporary entry
+ *  of a resolution. The other entries are released with the factory.
+ */
+class ResolveInfoFactory {
+ public:
+  typedef ResolveInfo entry_type;
+  typedef ResolveInfo::key_type key_type;
+
+ public:
+  ResolveInfoFactory();
+
+  ~ResolveInfoFactory();
+
+  entry_type* produce(const key_type& pKey);
+
+  entry_type* produce(const key_type& pKey, uint32_t pHashValue);
+
+  void destroy(entry_type*& pEntry);
+
+ private:
+  void* allocate(size_t pSize);
+
+ private:
+  std::vector<char*> m_Chunks;
+  char* m_pCurrent;
+  char* m_pEnd;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ResolveInfoFactory);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_RESOLVEINFOFACTORY_H_
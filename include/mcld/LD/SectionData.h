@@ -18,12 +18,19 @@
 #include <llvm/ADT/ilist_node.h>
 #include <llvm/Support/DataTypes.h>
 
+#include <vector>
+
 namespace mcld {
 
 class LDSection;
+class ThreadPool;
 
 /** \class SectionData
  *  \brief SectionData provides a container for all Fragments.
+ *
+ *  The fragments are kept in a list, so that the stubs and the branch islands
+ *  are inserted between them in constant time. The walks which need random
+ *  access take a FragmentIndex of the list.
  */
 class SectionData {
  private:
@@ -79,6 +86,18 @@ class SectionData {
   const_reverse_iterator rend() const { return m_Fragments.rend(); }
   reverse_iterator rend() { return m_Fragments.rend(); }
 
+  /// updateOffsets - recompute the offsets of the fragments starting from
+  /// pFrom after fragments in front of it have been inserted or resized.
+  /// Since the size of a fragment depends only on its own offset, the walk
+  /// stops at the first fragment whose offset does not change.
+  void updateOffsets(Fragment& pFrom);
+
+  /// layout - set up the offsets of all fragments from the beginning and the
+  /// size of the section. A large section is split into chunks which start
+  /// at its most aligned fragments. The chunks are laid out on pPool, and
+  /// then moved to the prefix sums of their sizes.
+  void layout(ThreadPool& pPool);
+
  private:
   FragmentListType m_Fragments;
   LDSection* m_pSection;
@@ -87,6 +106,45 @@ class SectionData {
   DISALLOW_COPY_AND_ASSIGN(SectionData);
 };
 
+/** \class FragmentIndex
+ *  \brief FragmentIndex is an array of the fragments of a SectionData in the
+ *  order of the list.
+ *
+ *  The position of a fragment is stable until fragments are inserted into or
+ *  removed from the list, and the index is built again afterwards. The
+ *  fragments of a laid out section are found by their offsets in logarithmic
+ *  time, and a large section is split at positions for several threads.
+ */
+class FragmentIndex {
+ public:
+  FragmentIndex();
+
+  explicit FragmentIndex(SectionData& pData);
+
+  /// build - take the fragments of pData, dropping the earlier ones
+  void build(SectionData& pData);
+
+  size_t size() const { return m_Fragments.size(); }
+
+  bool empty() const { return m_Fragments.empty(); }
+
+  Fragment& operator[](size_t pIdx) const { return *m_Fragments[pIdx]; }
+
+  /// find - the position of the fragment which covers pOffset of a laid out
+  /// section, or size() if no fragment does
+  size_t find(uint64_t pOffset) const;
+
+  /// split - split the fragments into runs of at least pMinSize fragments,
+  /// each of which starts at a fragment aligned to pAlign at least. pStarts
+  /// gets the first position of every run, and size() at the end.
+  void split(size_t pMinSize,
+             uint32_t pAlign,
+             std::vector<size_t>& pStarts) const;
+
+ private:
+  std::vector<Fragment*> m_Fragments;
+};
+
 }  // namespace mcld
 
 #endif  // MCLD_LD_SECTIONDATA_H_
@@ -0,0 +1,117 @@
+//===- SectionMerger.h ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_SECTIONMERGER_H_
+#define MCLD_LD_SECTIONMERGER_H_
+
+#include "mcld/LD/MergedStringTable.h"
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/ADT/DenseMap.h>
+
+#include <vector>
+
+namespace mcld {
+
+class Fragment;
+class LDSection;
+class MemoryReport;
+class Module;
+class Relocation;
+class RegionFragment;
+class SectionData;
+class ThreadPool;
+
+/** \class SectionMerger
+ *  \brief SectionMerger merges the contents of the SHF_MERGE input sections,
+ *  such as .rodata.str1.1, .rodata.cst8 and .comment.
+ *
+ *  The mergeable input sections are moved into the output like any other
+ *  section. Then the inputs that went to the same place with the same entry
+ *  size and alignment are replaced by one fragment that holds each unique
+ *  string or entry once, and the symbols and the section-relative relocations
+ *  that refer to them are redirected to that fragment.
+ */
+class SectionMerger {
+ public:
+  SectionMerger();
+
+  ~SectionMerger();
+
+  /// isMergeable - check whether the header and the contents of the input
+  /// section allows merging
+  static bool isMergeable(const LDSection& pSection);
+
+  /// collect - find the mergeable input sections of pModule whose references
+  /// can all be redirected. This should be called before the input sections
+  /// are merged into the output sections.
+  void collect(Module& pModule);
+
+  /// merge - merge the collected sections. This should be called after they
+  /// are moved into the output sections and before relocations are scanned.
+  void merge(Module& pModule, ThreadPool& pPool);
+
+  /// hashContents - the hash of the merged contents. The references that
+  /// were redirected only depend on the layout of the merged fragments and
+  /// on this.
+  uint64_t hashContents() const;
+
+  /// addMemoryUsage - count the merged strings and entries, and the members
+  /// of the groups, in pReport
+  void addMemoryUsage(MemoryReport& pReport) const;
+
+ private:
+  struct Group;
+
+  struct Member {
+    LDSection* section;
+    RegionFragment* fragment;
+    Group* group;
+  };
+
+  /// Group - the merged inputs that share one fragment
+  struct Group {
+    Group(SectionData& pData, const LDSection& pSection);
+
+    bool accepts(const SectionData& pData, const LDSection& pSection) const;
+
+    SectionData* data;
+    uint32_t flag;
+    uint32_t ent_size;
+    uint32_t align;
+    MergedStringTable table;
+    std::vector<Member*> members;
+    std::vector<uint8_t> contents;
+    RegionFragment* fragment;
+  };
+
+  typedef llvm::DenseMap<const Fragment*, Member*> MemberMap;
+
+ private:
+  /// getOutputOffset - the offset in the merged fragment of the byte at
+  /// pOffset of the member
+  uint64_t getOutputOffset(const Member& pMember, uint64_t pOffset) const;
+
+  void redirectRelocation(Relocation& pReloc) const;
+
+  void redirectSymbols(Module& pModule);
+
+  void replaceFragments(Group& pGroup);
+
+ private:
+  std::vector<Member> m_Members;
+  MemberMap m_MemberMap;
+  std::vector<Group*> m_Groups;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SectionMerger);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_SECTIONMERGER_H_
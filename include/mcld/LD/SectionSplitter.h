@@ -0,0 +1,84 @@
+//===- SectionSplitter.h --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_SECTIONSPLITTER_H_
+#define MCLD_LD_SECTIONSPLITTER_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/Support/DataTypes.h>
+
+#include <vector>
+
+namespace mcld {
+
+class Input;
+class IRBuilder;
+class LDSection;
+class Module;
+class ObjectReader;
+
+/** \class SectionSplitter
+ *  \brief SectionSplitter splits the .text sections of the objects built
+ *  without -ffunction-sections at their global functions, so that
+ *  --gc-sections collects the functions one by one.
+ *
+ *  A section is split only if the relocations are the only references from
+ *  one function to another. The assembler resolves a branch to a local label
+ *  without a relocation, so a section with local symbols other than the
+ *  mapping symbols, or with a function whose size is unknown, is kept whole.
+ *  So is a section referred to through its section symbol by an allocated
+ *  section other than .eh_frame, or by a REL relocation, whose addend is in
+ *  the place and cannot be moved to a piece. The first piece stays in the
+ *  original section, and the others are appended to the object with their
+ *  own relocation sections.
+ */
+class SectionSplitter {
+ public:
+  SectionSplitter(Module& pModule, IRBuilder& pBuilder, ObjectReader& pReader);
+
+  ~SectionSplitter();
+
+  /// run - split the .text sections of all objects, and return the number
+  /// of the sections added
+  size_t run();
+
+ private:
+  /// Boundaries - the offsets of the pieces of a section, the first of which
+  /// is always zero
+  typedef std::vector<uint64_t> Boundaries;
+
+  /// getBoundaries - the offsets of the functions of pSection. Return false
+  /// if pSection cannot be split at them.
+  bool getBoundaries(Input& pInput,
+                     const LDSection& pSection,
+                     Boundaries& pBoundaries) const;
+
+  /// checkReferences - read the relocations of pInput, and return true if
+  /// every one referring to pSection by its section symbol can be moved to
+  /// one of the pieces
+  bool checkReferences(Input& pInput,
+                       const LDSection& pSection,
+                       const Boundaries& pBoundaries);
+
+  /// split - cut pSection at pBoundaries, and move the symbols and the
+  /// relocations to the pieces
+  void split(Input& pInput, LDSection& pSection, const Boundaries& pBoundaries);
+
+ private:
+  Module& m_Module;
+  IRBuilder& m_Builder;
+  ObjectReader& m_Reader;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SectionSplitter);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_SECTIONSPLITTER_H_
@@ -0,0 +1,84 @@
+//===- SizeReport.h -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_SIZEREPORT_H_
+#define MCLD_LD_SIZEREPORT_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/Support/DataTypes.h>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+}  // namespace llvm
+
+namespace mcld {
+
+class Input;
+class LDSection;
+
+/** \class SizeReport
+ *  \brief SizeReport adds up the bytes of the output by the input file, the
+ *  archive member and the output section, for --size-report.
+ *
+ *  The bytes of an input section are counted when it is merged into its
+ *  output section, so the merged strings are counted before the duplicates
+ *  are removed. The bytes which garbage collection and identical code folding
+ *  removed are counted by input.
+ */
+class SizeReport {
+ public:
+  SizeReport();
+
+  ~SizeReport();
+
+  /// addSection - pSection of pInput is merged into pOutput
+  void addSection(const Input& pInput,
+                  const LDSection& pSection,
+                  const LDSection& pOutput);
+
+  /// addStripped - pSection of pInput is removed by --gc-sections
+  void addStripped(const Input& pInput, const LDSection& pSection);
+
+  /// addFolded - pSection of pInput is folded by --icf
+  void addFolded(const Input& pInput, const LDSection& pSection);
+
+  /// writeJSON - write the report as a JSON object
+  void writeJSON(llvm::raw_ostream& pOS) const;
+
+  /// writeCSV - write the report with a line per input and output section
+  void writeCSV(llvm::raw_ostream& pOS) const;
+
+ private:
+  typedef std::pair<const LDSection*, uint64_t> OutputBytes;
+
+  /// Entry - the bytes of an input
+  struct Entry {
+    const Input* input;
+    std::vector<OutputBytes> outputs;
+    uint64_t stripped;
+    uint64_t folded;
+  };
+
+  Entry& getEntry(const Input& pInput);
+
+ private:
+  std::vector<Entry> m_Entries;
+  std::unordered_map<const Input*, size_t> m_Index;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SizeReport);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_SIZEREPORT_H_
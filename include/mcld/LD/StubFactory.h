@@ -9,8 +9,12 @@
 #ifndef MCLD_LD_STUBFACTORY_H_
 #define MCLD_LD_STUBFACTORY_H_
 
+#include "mcld/Fragment/Relocation.h"
+
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/Support/DataTypes.h>
 
+#include <functional>
 #include <vector>
 
 namespace mcld {
@@ -18,14 +22,31 @@ namespace mcld {
 class BranchIslandFactory;
 class IRBuilder;
 class FragmentRef;
+class Module;
 class Relocation;
 class Stub;
+class ThreadPool;
 
 /** \class StubFactory
  *  \brief the clone factory of Stub
  *
  */
 class StubFactory {
+ public:
+  /// Candidate - a relocation which needs a stub of the prototype by the
+  /// current layout
+  struct Candidate {
+    Relocation* reloc;
+    Stub* prototype;
+  };
+
+  typedef std::vector<Candidate> CandidateList;
+
+  /// BranchTarget - set pTarget to the address a relocation branches to, or
+  /// return false if the relocation never needs a stub
+  typedef std::function<bool(const Relocation& pReloc, uint64_t& pTarget)>
+      BranchTarget;
+
  public:
   ~StubFactory();
 
@@ -42,6 +63,30 @@ class StubFactory {
                IRBuilder& pBuilder,
                BranchIslandFactory& pBRIslandFactory);
 
+  /// create - create a stub of pPrototype, found for pReloc by findStubs or
+  /// findPrototype, or reuse one in reach of pReloc. Return NULL if pReloc
+  /// has no island.
+  Stub* create(Relocation& pReloc,
+               Stub& pPrototype,
+               IRBuilder& pBuilder,
+               BranchIslandFactory& pBRIslandFactory);
+
+  /// findStubs - find the relocations of the objects of pModule which need
+  /// stubs, on the threads of pPool. The layout and the symbols are only
+  /// read, so the stubs are created afterwards, in the order of the objects
+  /// and of their relocations kept by pCandidates.
+  void findStubs(Module& pModule,
+                 const BranchTarget& pTarget,
+                 ThreadPool& pPool,
+                 CandidateList& pCandidates) const;
+
+  /// findPrototype - find the prototype of the stub pReloc needs to reach
+  /// pTargetSymValue, or NULL. It may be called concurrently.
+  Stub* findPrototype(const Relocation& pReloc,
+                      uint64_t pTargetSymValue) const {
+    return findPrototype(pReloc, pReloc.place(), pTargetSymValue);
+  }
+
  private:
   /// findPrototype - find if there is a registered stub prototype for the given
   ///                 relocation
@@ -53,9 +98,17 @@ class StubFactory {
 
  private:
   typedef std::vector<Stub*> StubPoolType;
+  typedef llvm::DenseMap<Relocation::Type, StubPoolType> TypeTableType;
 
  private:
   StubPoolType m_StubPool;  // stub pool
+
+  /// m_TypeTable - the prototypes which may fix each type of relocation, in
+  /// the order they are registered
+  TypeTableType m_TypeTable;
+
+  /// m_AnyTypeStubs - the prototypes which may fix any type of relocation
+  StubPoolType m_AnyTypeStubs;
 };
 
 }  // namespace mcld
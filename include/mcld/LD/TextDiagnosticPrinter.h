@@ -31,6 +31,8 @@ class TextDiagnosticPrinter : public DiagnosticPrinter {
   virtual void handleDiagnostic(DiagnosticEngine::Severity pSeverity,
                                 const Diagnostic& pInfo);
 
+  virtual bool isVisible(DiagnosticEngine::Severity pSeverity) const;
+
   virtual void beginInput(const Input& pInput, const LinkerConfig& pConfig);
 
   virtual void endInput();
@@ -0,0 +1,86 @@
+//===- VersionScript.h ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_VERSIONSCRIPT_H_
+#define MCLD_LD_VERSIONSCRIPT_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+/** \class VersionScript
+ *  \brief VersionScript reads the global and local patterns of the version
+ *  nodes of --version-script.
+ *
+ *  Only the scope of the symbols is used. The names of the version nodes and
+ *  their dependencies are read and dropped, so no symbol versions are
+ *  emitted. An exact name is stronger than a pattern, and a pattern is
+ *  stronger than a lone `*'. At the same strength, global wins over local.
+ *
+ *  The patterns are compiled as they are read. The exact names are looked up
+ *  in a hash table, and the patterns `prefix*' by the prefixes of the name
+ *  of each length in use. Only the other patterns are matched one by one,
+ *  and only those whose literal head the name starts with.
+ */
+class VersionScript {
+ public:
+  enum Scope { Unspecified, Global, Local };
+
+ public:
+  VersionScript();
+
+  ~VersionScript();
+
+  /// parse - read the version nodes of pContent. Return false and describe
+  /// the error in pError if the script is malformed.
+  bool parse(llvm::StringRef pContent, std::string& pError);
+
+  /// scope - the scope which the script gives to the symbol pName
+  Scope scope(llvm::StringRef pName) const;
+
+  bool empty() const;
+
+ private:
+  /// Patterns - the compiled patterns of a scope
+  struct Patterns {
+    /// prefixes - the patterns `prefix*', and the lengths of the prefixes
+    llvm::StringMap<char> prefixes;
+    std::vector<size_t> prefix_sizes;
+
+    /// globs - the other patterns, and the literal head of each
+    std::vector<std::string> globs;
+    std::vector<size_t> glob_heads;
+
+    bool empty() const { return prefixes.empty() && globs.empty(); }
+  };
+
+ private:
+  void addPattern(llvm::StringRef pPattern, Scope pScope);
+
+  /// match - check if a pattern of pPatterns matches pName
+  static bool match(const Patterns& pPatterns, llvm::StringRef pName);
+
+ private:
+  llvm::StringMap<Scope> m_Names;
+  Patterns m_Global;
+  Patterns m_Local;
+  Scope m_AllScope;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(VersionScript);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_LD_VERSIONSCRIPT_H_
@@ -9,19 +9,33 @@
 #ifndef MCLD_LINKER_H_
 #define MCLD_LINKER_H_
 
+#include <llvm/Support/DataTypes.h>
+
+#include <functional>
+#include <future>
 #include <string>
+#include <vector>
 
 namespace mcld {
 
+class BitcodeCompiler;
 class FileHandle;
 class FileOutputBuffer;
+class IncrementalLayout;
+class InputCostReport;
 class IRBuilder;
+class LinkDigest;
 class LinkerConfig;
 class LinkerScript;
+class LTOCodeGen;
+class MapWriter;
+class MemoryReport;
 class Module;
 class ObjectLinker;
+class SizeReport;
 class Target;
 class TargetLDBackend;
+class TimeTrace;
 
 /** \class Linker
 *  \brief Linker is a modular linker.
@@ -47,18 +61,56 @@ class Linker {
   /// link - A convenient way to resolve and to layout the output mcld::Module.
   bool link(Module& pModule, IRBuilder& pBuilder);
 
+  /// snapshot - To read the inputs given so far, such as the runtime
+  /// libraries of many small links, and keep the state of the link for
+  /// fork(). The inputs of each link are read as if they followed the
+  /// snapshot on the command line, so the archives of the snapshot do not
+  /// pull in members for them.
+  bool snapshot(Module& pModule, IRBuilder& pBuilder);
+
+  /// fork - To link one output against the snapshot in a copy-on-write child
+  /// process. pAddInputs adds the inputs of the link with the IRBuilder, and
+  /// the child emits the output to pPath. The snapshot is left untouched for
+  /// the next fork(). On hosts without fork(), the snapshot is used up.
+  /// @return true if the child linked pPath
+  bool fork(Module& pModule,
+            const std::function<bool(IRBuilder&)>& pAddInputs,
+            const std::string& pPath);
+
+  /// verifyDeterminism - To link the inputs twice in copy-on-write child
+  /// processes, first with the threads of the options and then with one
+  /// thread, and to compare the digests of their phases. The output of the
+  /// threaded link is emitted to pPath. On hosts without fork(), the inputs
+  /// are linked once and nothing is compared.
+  /// @return true if both links succeeded and agree in every phase
+  bool verifyDeterminism(Module& pModule,
+                         IRBuilder& pBuilder,
+                         const std::string& pPath);
+
   /// emit - To emit output mcld::Module to a FileOutputBuffer.
   bool emit(FileOutputBuffer& pOutput);
 
   /// emit - To open a file for output in pPath and to emit output mcld::Module
-  /// to the file.
+  /// to the file. The output is written to a temporary file and renamed to
+  /// pPath, then flushed to the disk in the background if --fsync-output.
+  /// With --incremental, an old output of the same size is patched in place.
   bool emit(const Module& pModule, const std::string& pPath);
 
   /// emit - To emit output mcld::Module in the pFileDescriptor.
   bool emit(const Module& pModule, int pFileDescriptor);
 
+  /// emit - To emit output mcld::Module into pOutput, which is resized to
+  /// the output. No file is written.
+  bool emit(const Module& pModule, std::vector<uint8_t>& pOutput);
+
   bool reset();
 
+  /// setBitcodeCompiler - To compile the bitcode inputs by pCompiler. The
+  /// compiler is not owned, and it outlives the link.
+  void setBitcodeCompiler(BitcodeCompiler* pCompiler) {
+    m_pBitcodeCompiler = pCompiler;
+  }
+
  private:
   bool initTarget();
 
@@ -68,6 +120,40 @@ class Linker {
 
   bool initEmulator(LinkerScript& pScript);
 
+  /// initLink - set up the link of pModule before any input is read
+  bool initLink(Module& pModule, IRBuilder& pBuilder);
+
+  /// readInputs - read the inputs that are not read yet, and settle the
+  /// options that depend on them
+  bool readInputs(Module& pModule);
+
+  /// compileBitcode - compile the bitcode inputs read by the last normalize,
+  /// and read their objects
+  bool compileBitcode(Module& pModule);
+
+  /// reportStats - write the time trace and print the link statistics
+  void reportStats(const Module& pModule);
+
+  /// writeReproduce - write the inputs and the response file to the
+  /// --reproduce archive
+  bool writeReproduce(const Module& pModule);
+
+  /// writeMap - write the link map of -M and -Map
+  bool writeMap(const Module& pModule);
+
+  /// writeSizeReport - write the --size-report file
+  bool writeSizeReport();
+
+  /// writeDwp - package the split DWARF of pModule into the --dwp file
+  bool writeDwp(Module& pModule);
+
+  /// forkDigest - link and emit pPath with pThreads threads in a child, and
+  /// read the digests of its phases into pDigest
+  bool forkDigest(Module& pModule,
+                  unsigned pThreads,
+                  const std::string& pPath,
+                  LinkDigest& pDigest);
+
  private:
   LinkerConfig* m_pConfig;
   IRBuilder* m_pIRBuilder;
@@ -75,6 +161,18 @@ class Linker {
   const Target* m_pTarget;
   TargetLDBackend* m_pBackend;
   ObjectLinker* m_pObjLinker;
+  TimeTrace* m_pTimeTrace;
+  InputCostReport* m_pCostReport;
+  IncrementalLayout* m_pIncremental;
+  MapWriter* m_pMapWriter;
+  SizeReport* m_pSizeReport;
+  MemoryReport* m_pMemoryReport;
+  LinkDigest* m_pDigest;
+  BitcodeCompiler* m_pBitcodeCompiler;
+  LTOCodeGen* m_pLTOCodeGen;
+
+  /// m_OutputSync - the background fsync of the output
+  std::future<bool> m_OutputSync;
 };
 
 }  // namespace mcld
@@ -14,6 +14,7 @@
 #include "mcld/Support/Path.h"
 
 #include <string>
+#include <vector>
 
 namespace mcld {
 
@@ -39,6 +40,25 @@ class InputFileAction : public InputAction {
   sys::fs::Path m_Path;
 };
 
+/// InputFilesAction - a run of input files on the command line. Every file
+/// becomes an input with its context and memory area, as InputFileAction,
+/// ContextAction and MemoryAreaAction do for one file, without three
+/// actions for each of them.
+class InputFilesAction : public InputAction {
+ public:
+  explicit InputFilesAction(unsigned int pPosition);
+
+  /// append - add the file pPath, which must outlive the action
+  void append(const char* pPath) { m_Paths.push_back(pPath); }
+
+  size_t size() const { return m_Paths.size(); }
+
+  bool activate(InputBuilder&) const;
+
+ private:
+  std::vector<const char*> m_Paths;
+};
+
 /// NamespecAction
 class NamespecAction : public InputAction {
  public:
@@ -10,9 +10,12 @@
 #define MCLD_MC_CONTEXTFACTORY_H_
 
 #include "mcld/LD/LDContext.h"
-#include "mcld/Support/UniqueGCFactory.h"
+#include "mcld/Support/GCFactory.h"
 #include "mcld/Support/Path.h"
 
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+
 namespace mcld {
 /** \class ContextFactory
  *  \brief ContextFactory avoids the duplicated LDContext of the same file.
@@ -25,10 +28,14 @@ namespace mcld {
  *  create LDContext directly. Instead, it creates LDContext by ContextFactory.
  *  ContextFactory returns the identical reference of LDContext if it's openend.
  *
+ *  The members of an archive share the path of the archive, and each of them
+ *  has a context of its own, so only the files given by their paths are
+ *  looked up.
+ *
  *  @see LDContext
- *  @see UniqueGCFactoryBase
+ *  @see GCFactory
  */
-class ContextFactory : public UniqueGCFactoryBase<sys::fs::Path, LDContext, 0> {
+class ContextFactory : public GCFactory<LDContext, 0> {
  public:
   explicit ContextFactory(size_t pNum);
   ~ContextFactory();
@@ -36,6 +43,16 @@ class ContextFactory : public UniqueGCFactoryBase<sys::fs::Path, LDContext, 0> {
   LDContext* produce();
   LDContext* produce(const sys::fs::Path& pPath);
   LDContext* produce(const char* pPath);
+
+ private:
+  /// produceFile - the context of the file pName, created on first use
+  LDContext* produceFile(llvm::StringRef pName);
+
+ private:
+  /// m_ContextMap - the context of each file by its path. The map holds its
+  /// own copy of the paths, and finds them by their hashes rather than by
+  /// comparing the paths.
+  llvm::StringMap<LDContext*> m_ContextMap;
 };
 
 }  // namespace mcld
@@ -15,6 +15,7 @@
 
 #include <stack>
 #include <string>
+#include <vector>
 
 namespace mcld {
 
@@ -23,6 +24,7 @@ class ContextFactory;
 class InputFactory;
 class LinkerConfig;
 class MemoryAreaFactory;
+class ThreadPool;
 
 /** \class InputBuilder
  *  \brief InputBuilder recieves InputActions and build the InputTree.
@@ -70,6 +72,11 @@ class InputBuilder {
 
   bool setMemory(Input& pInput, void* pMemBuffer, size_t pSize);
 
+  /// prefetchMemory - read the files of pPaths on pPool, so that the later
+  /// setMemory() of the inputs at these paths do not wait for the disk.
+  void prefetchMemory(const std::vector<sys::fs::Path>& pPaths,
+                      ThreadPool& pPool);
+
   InputTree& enterGroup();
 
   InputTree& exitGroup();
@@ -11,6 +11,7 @@
 #include "mcld/Support/Directory.h"
 #include "mcld/Support/FileSystem.h"
 
+#include <llvm/ADT/StringMap.h>
 #include <llvm/ADT/StringRef.h>
 
 #include <string>
@@ -38,9 +39,19 @@ class MCLDDirectory : public sys::fs::Directory {
 
   const std::string& name() const { return m_Name; }
 
+  /// find - the entry whose file name is pFileName, or NULL. The directory is
+  /// listed once on the first call, and later calls never touch the file
+  /// system.
+  sys::fs::Path* find(const std::string& pFileName);
+
+ private:
+  typedef llvm::StringMap<sys::fs::Path*> EntryMap;
+
  private:
   std::string m_Name;
   bool m_bInSysroot;
+  EntryMap m_EntryMap;
+  bool m_bListed;
 };
 
 }  // namespace mcld
@@ -17,6 +17,9 @@ class LDSymbol;
 class ResolveInfo;
 /** \class SymbolCategory
  *  \brief SymbolCategory groups output LDSymbol into different categories.
+ *
+ *  Every symbol remembers its position in the categories, so moving a symbol
+ *  to another category takes a swap per category boundary it crosses.
  */
 class SymbolCategory {
  private:
@@ -36,6 +39,12 @@ class SymbolCategory {
 
   SymbolCategory& forceLocal(LDSymbol& pSymbol);
 
+  /// add - add pSymbols at once, and force pSymbols[i] to local if
+  /// pForceLocal[i] is set. The symbols of a category keep the given order,
+  /// behind the symbols already in the category.
+  SymbolCategory& add(const std::vector<LDSymbol*>& pSymbols,
+                      const std::vector<bool>& pForceLocal);
+
   SymbolCategory& arrange(LDSymbol& pSymbol, const ResolveInfo& pSourceInfo);
 
   SymbolCategory& changeCommonsToGlobal();
@@ -156,6 +165,13 @@ class SymbolCategory {
                           Category::Type pSource,
                           Category::Type pTarget);
 
+  /// position - the position of pSymbol, or numOfSymbols() if pSymbol is not
+  /// in the categories
+  size_t position(const LDSymbol& pSymbol) const;
+
+  /// swap - swap the symbols at pX and pY, and keep their positions
+  void swap(size_t pX, size_t pY);
+
  private:
   OutputSymbols m_OutputSymbols;
 
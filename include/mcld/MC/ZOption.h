@@ -38,6 +38,11 @@ class ZOption {
     Lazy,
     Now,
     Origin,
+    PackRelativeRelocs,
+    NoPackRelativeRelocs,
+    HugePageText,
+    SeparateCode,
+    NoSeparateCode,
     CommPageSize,
     MaxPageSize,
     Unknown
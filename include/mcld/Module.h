@@ -18,6 +18,9 @@
 #include "mcld/LD/SectionSymbolSet.h"
 #include "mcld/MC/SymbolCategory.h"
 
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+
 #include <vector>
 #include <string>
 
@@ -44,6 +47,8 @@ class Module {
   typedef InputTree::iterator input_iterator;
   typedef InputTree::const_iterator const_input_iterator;
 
+  typedef std::vector<Input*> InputList;
+
   typedef std::vector<LDSection*> SectionTable;
   typedef SectionTable::iterator iterator;
   typedef SectionTable::const_iterator const_iterator;
@@ -98,6 +103,15 @@ class Module {
   const_input_iterator input_end() const { return m_MainTree.end(); }
   input_iterator input_end() { return m_MainTree.end(); }
 
+  /// getInputList - the inputs of the input tree in depth-first order,
+  /// without the group nodes. The loops over all inputs after normalization
+  /// index it instead of walking the tree.
+  const InputList& getInputList() const { return m_InputList; }
+
+  /// buildInputList - flatten the input tree into the input list. It is
+  /// called once the input tree stops growing, at the end of normalization.
+  void buildInputList();
+
   /// @}
   /// @name Section Accessors
   /// @{
@@ -117,8 +131,17 @@ class Module {
   size_t size() const { return m_SectionTable.size(); }
   bool empty() const { return m_SectionTable.empty(); }
 
-  LDSection* getSection(const std::string& pName);
-  const LDSection* getSection(const std::string& pName) const;
+  /// appendSection - append pSection to the section table.
+  void appendSection(LDSection& pSection);
+
+  /// clearSections - remove all sections from the section table.
+  void clearSections();
+
+  /// getSection - the first section named pName, or NULL if there is none.
+  /// Sections are looked up through an index that is kept in sync with sections
+  /// appended or removed by appendSection() and clearSections().
+  LDSection* getSection(const llvm::StringRef& pName);
+  const LDSection* getSection(const llvm::StringRef& pName) const;
 
   /// @}
   /// @name Symbol Accessors
@@ -161,13 +184,23 @@ class Module {
   void addAlias(const ResolveInfo& pAlias);
   AliasList* getAliasList(const ResolveInfo& pSym);
 
+ private:
+  typedef llvm::StringMap<LDSection*> SectionIndex;
+
+  /// updateSectionIndex - add the sections appended since the last lookup to
+  /// the name index.
+  void updateSectionIndex() const;
+
  private:
   std::string m_Name;
   LinkerScript& m_Script;
   ObjectList m_ObjectList;
   LibraryList m_LibraryList;
   InputTree m_MainTree;
+  InputList m_InputList;
   SectionTable m_SectionTable;
+  mutable SectionIndex m_SectionIndex;
+  mutable size_t m_NumOfIndexed;
   SymbolTable m_SymbolTable;
   NamePool m_NamePool;
   SectionSymbolSet m_SectSymbolSet;
@@ -14,6 +14,7 @@
 #include <llvm/Support/DataTypes.h>
 
 #include <string>
+#include <vector>
 
 namespace mcld {
 
@@ -64,9 +65,18 @@ class ObjectBuilder {
   /// is not defined, return NULL.
   LDSection* MergeSection(const Input& pInputFile, LDSection& pInputSection);
 
-  /// MoveSectionData - move the fragment of pFrom to pTo section data.
+  /// MoveSectionData - move the fragment of pFrom to pTo section data. The
+  /// first one carries the alignment of pFrom.
   static bool MoveSectionData(SectionData& pFrom, SectionData& pTo);
 
+  /// MoveSectionData - move the fragments of pFrom to pTo section data, as
+  /// if they were moved into a section aligned to pAlign first and that
+  /// section into pTo. The offsets and the size of pTo are left to
+  /// SectionData::layout().
+  static void MoveSectionData(const std::vector<SectionData*>& pFrom,
+                              uint32_t pAlign,
+                              SectionData& pTo);
+
   /// UpdateSectionAlign - update alignment for input section
   static void UpdateSectionAlign(LDSection& pTo, const LDSection& pFrom);
 
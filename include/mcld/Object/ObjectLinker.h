@@ -8,27 +8,42 @@
 //===----------------------------------------------------------------------===//
 #ifndef MCLD_OBJECT_OBJECTLINKER_H_
 #define MCLD_OBJECT_OBJECTLINKER_H_
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
 #include <llvm/Support/DataTypes.h>
 
+#include <vector>
+
 namespace mcld {
 
 class ArchiveReader;
 class BinaryReader;
 class BinaryWriter;
+class CompressedSection;
 class DynObjReader;
 class DynObjWriter;
 class ExecWriter;
 class FileOutputBuffer;
+class Fragment;
 class GroupReader;
+class IncrementalLayout;
+class Input;
 class IRBuilder;
+class LDSection;
 class LinkerConfig;
+class MapWriter;
+class MemoryReport;
 class Module;
+class ObjectBuilder;
 class ObjectReader;
 class ObjectWriter;
 class Relocation;
 class ResolveInfo;
 class ScriptReader;
+class SectionMerger;
+class SizeReport;
 class TargetLDBackend;
+class ThreadPool;
 
 /** \class ObjectLinker
  */
@@ -46,7 +61,8 @@ class ObjectLinker {
   /// addUndefinedSymbols - add symbols set by -u
   void addUndefinedSymbols();
 
-  /// normalize - normalize the input files
+  /// normalize - normalize the input files. A later call reads only the
+  /// inputs appended to the input tree since the last call.
   void normalize();
 
   /// linkable - check the linkability of current LinkerConfig
@@ -55,6 +71,14 @@ class ObjectLinker {
   ///  - check every Input has a correct Attribute
   bool linkable() const;
 
+  /// applyVersionScript - hide the defined symbols which the --version-script
+  /// makes local
+  bool applyVersionScript();
+
+  /// applyDynamicList - keep the symbols of the --dynamic-list preemptible,
+  /// and bind the others in the shared object
+  bool applyDynamicList();
+
   /// readRelocations - read all relocation entries
   bool readRelocations();
 
@@ -114,6 +138,12 @@ class ObjectLinker {
   /// and push_back into the relocation section
   bool relocation();
 
+  /// compressDebugSections - compress the .debug_* sections for
+  /// --compress-debug-sections, and place the sections after them again.
+  /// This needs the relocation results, and has to be done before the size
+  /// of the output is known.
+  bool compressDebugSections();
+
   /// finalizeSymbolValue - finalize the symbol value
   bool finalizeSymbolValue();
 
@@ -145,11 +175,70 @@ class ObjectLinker {
   const ObjectWriter* getWriter() const { return m_pWriter; }
   ObjectWriter* getWriter() { return m_pWriter; }
 
+  /// setIncrementalLayout - reserve the slack of --incremental in pLayout
+  /// when the sections are merged
+  void setIncrementalLayout(IncrementalLayout* pLayout) {
+    m_pIncremental = pLayout;
+  }
+
+  /// setMapWriter - record the input sections of -M and -Map in pWriter
+  /// when they are merged
+  void setMapWriter(MapWriter* pWriter) { m_pMapWriter = pWriter; }
+
+  /// setSizeReport - count the bytes of --size-report in pReport
+  void setSizeReport(SizeReport* pReport) { m_pSizeReport = pReport; }
+
+  /// addMemoryUsage - count the structures held by the linker in pReport
+  void addMemoryUsage(MemoryReport& pReport) const;
+
  private:
+  /// SectionOrder - the priorities of the sections of --symbol-ordering-file,
+  /// the call graph and --data-ordering-file
+  typedef llvm::DenseMap<const LDSection*, unsigned> SectionOrder;
+
+  /// mergeSection - merge pSection of pInput into its output section
+  bool mergeSection(ObjectBuilder& pBuilder,
+                    Input& pInput,
+                    LDSection& pSection);
+
+  /// getSectionOrder - read the --symbol-ordering-file into pOrder
+  bool getSectionOrder(SectionOrder& pOrder);
+
+  /// getCallGraphOrder - sort the code sections by the call graph profile
+  /// into pOrder
+  bool getCallGraphOrder(SectionOrder& pOrder);
+
+  /// getDataOrder - read the --data-ordering-file into pOrder, and the data
+  /// marked as written into pWritten for --separate-written-data
+  bool getDataOrder(SectionOrder& pOrder, SectionOrder& pWritten);
+
+  /// mergeOrderedSections - merge the sections of pOrder by their priorities.
+  /// If pPageSize is not zero, the first of them in every input section
+  /// description starts on a page of that size.
+  bool mergeOrderedSections(ObjectBuilder& pBuilder,
+                            const SectionOrder& pOrder,
+                            uint64_t pPageSize = 0);
+
+  /// readDeferredRelocations - read the relocation sections that
+  /// readRelocations left for garbage collection and that survived it
+  bool readDeferredRelocations();
+
+  /// reuseRelocatedSections - find the debug sections of --incremental whose
+  /// relocation keys did not change, and leave their relocations unapplied
+  void reuseRelocatedSections();
+
+  /// restoreRelocatedSections - read the relocated bytes of the reused
+  /// sections back from the old output, or apply their relocations now
+  void restoreRelocatedSections(FileOutputBuffer& pOutput);
+
   /// normalSyncRelocationResult - sync relocation result when producing shared
   /// objects or executables
   void normalSyncRelocationResult(FileOutputBuffer& pOutput);
 
+  /// syncInputRelocationResult - helper function of
+  /// normalSyncRelocationResult, write the relocation results of an input
+  void syncInputRelocationResult(Input& pInput, uint8_t* pOutput);
+
   /// partialSyncRelocationResult - sync relocation result when doing partial
   /// link
   void partialSyncRelocationResult(FileOutputBuffer& pOutput);
@@ -158,9 +247,27 @@ class ObjectLinker {
   /// relocation target data to output
   void writeRelocationResult(Relocation& pReloc, uint8_t* pOutput);
 
-  /// addSymbolToOutput - add a symbol to output symbol table if it's not a
+  /// writeRelocationTarget - write the target data of pReloc to pPlace
+  void writeRelocationTarget(Relocation& pReloc, uint8_t* pPlace);
+
+  /// emitRelocatedContents - write the content of pSections, with the
+  /// relocation results, into pContents
+  void emitRelocatedContents(const std::vector<LDSection*>& pSections,
+                             std::vector<std::vector<uint8_t> >& pContents,
+                             ThreadPool& pPool);
+
+  /// isOutputSymbol - a symbol goes to output symbol table if it's not a
   /// section symbol and not defined in the discarded section
-  void addSymbolToOutput(ResolveInfo& pInfo, Module& pModule);
+  bool isOutputSymbol(const ResolveInfo& pInfo) const;
+
+ private:
+  /// ReusedSection - a relocation section whose results are in the old output
+  /// of --incremental, and the fragment it applies to
+  struct ReusedSection {
+    Input* input;
+    LDSection* reloc;
+    const Fragment* fragment;
+  };
 
  private:
   const LinkerConfig& m_Config;
@@ -177,6 +284,30 @@ class ObjectLinker {
   BinaryReader* m_pBinaryReader;
   ScriptReader* m_pScriptReader;
   ObjectWriter* m_pWriter;
+
+  /// m_pSectionMerger - holds the merged SHF_MERGE contents until output
+  SectionMerger* m_pSectionMerger;
+
+  /// m_pIncremental - the layout of --incremental, owned by Linker
+  IncrementalLayout* m_pIncremental;
+
+  /// m_pMapWriter - the link map of -M and -Map, owned by Linker
+  MapWriter* m_pMapWriter;
+
+  /// m_pSizeReport - the bytes of --size-report, owned by Linker
+  SizeReport* m_pSizeReport;
+
+  /// m_NumOfNormalized - the steps of the input iterator that normalize has
+  /// read
+  size_t m_NumOfNormalized;
+
+  /// m_CompressedSections - holds the compressed debug sections until output
+  std::vector<CompressedSection*> m_CompressedSections;
+
+  /// m_ReusedSections - the relocation sections of --incremental that are not
+  /// applied, and the set of them
+  std::vector<ReusedSection> m_ReusedSections;
+  llvm::DenseSet<const LDSection*> m_ReusedRelocs;
 };
 
 }  // namespace mcld
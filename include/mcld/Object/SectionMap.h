@@ -12,6 +12,7 @@
 #include "mcld/Script/Assignment.h"
 #include "mcld/Script/InputSectDesc.h"
 #include "mcld/Script/OutputSectDesc.h"
+#include "mcld/Support/Compiler.h"
 
 #include <llvm/Support/DataTypes.h>
 
@@ -154,9 +155,20 @@ class SectionMap {
   typedef OutputDescList::const_reverse_iterator const_reverse_iterator;
   typedef OutputDescList::reverse_iterator reverse_iterator;
 
+  /// (order, section) of a section to be placed by insertByOrder()
+  typedef std::vector<std::pair<size_t, LDSection*> > OrderedSectionList;
+
  public:
+  SectionMap();
+
   ~SectionMap();
 
+  /// find - find the first rule in script order that maps the input section
+  /// pInputSection of pInputFile to an output section.
+  ///
+  /// The rules are compiled into a matcher on the first lookup. The matcher is
+  /// rebuilt after insert() or sortByOrder(); code that reorders the output
+  /// section descriptions through iterators must not interleave it with find.
   const_mapping find(const std::string& pInputFile,
                      const std::string& pInputSection) const;
   mapping find(const std::string& pInputFile, const std::string& pInputSection);
@@ -191,10 +203,27 @@ class SectionMap {
 
   iterator insert(iterator pPosition, LDSection* pSection);
 
+  /// insertByOrder - insert an output section description of each section
+  /// of pSections before the first description whose order is larger. The
+  /// sections of the same order keep their order in pSections. The list is
+  /// rebuilt in one merge, instead of one search and one insert per section.
+  void insertByOrder(OrderedSectionList& pSections);
+
+  /// sortByOrder - stable sort the output section descriptions by order()
+  void sortByOrder();
+
   // fixupDotSymbols - ensure the dot assignments are valid
   void fixupDotSymbols();
 
  private:
+  class Matcher;
+
+  /// getMatcher - compile the rules if they have changed since the last
+  /// lookup.
+  Matcher& getMatcher() const;
+
+  void invalidateMatcher();
+
   bool matched(const Input& pInput,
                const std::string& pInputFile,
                const std::string& pInputSection) const;
@@ -203,6 +232,10 @@ class SectionMap {
 
  private:
   OutputDescList m_OutputDescList;
+  mutable Matcher* m_pMatcher;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SectionMap);
 };
 
 }  // namespace mcld
@@ -13,6 +13,7 @@
 #include "mcld/Object/SectionMap.h"
 #include "mcld/Support/Allocators.h"
 
+#include <cstdint>
 #include <vector>
 
 namespace mcld {
@@ -48,6 +49,19 @@ class RpnExpr {
 
   bool hasDot() const;
 
+  /// isFolded - check if the value of the expression is known without
+  /// evaluating it, i.e. it only combines integers by the pure operators
+  bool isFolded() const { return m_bFolded; }
+
+  uint64_t foldedValue() const { return m_FoldedValue; }
+
+  /// setFoldedValue - remember the value of a constant expression. Any change
+  /// of the tokens forgets it.
+  void setFoldedValue(uint64_t pValue) const {
+    m_bFolded = true;
+    m_FoldedValue = pValue;
+  }
+
   void dump() const;
 
   void push_back(ExprToken* pToken);
@@ -69,6 +83,8 @@ class RpnExpr {
 
  private:
   TokenQueue m_TokenQueue;
+  mutable bool m_bFolded;
+  mutable uint64_t m_FoldedValue;
 };
 
 }  // namespace mcld
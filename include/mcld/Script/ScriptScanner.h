@@ -18,8 +18,8 @@
 #endif
 
 #ifndef YY_DECL
-#define YY_DECL                                            \
-  mcld::ScriptParser::token_type mcld::ScriptScanner::lex( \
+#define YY_DECL                                             \
+  mcld::ScriptParser::token_type mcld::ScriptScanner::scan( \
       mcld::ScriptParser::semantic_type* yylval,           \
       mcld::ScriptParser::location_type* yylloc,           \
       const mcld::ScriptFile& pScriptFile)
@@ -28,13 +28,32 @@
 #include "mcld/Script/ScriptFile.h"
 #include "ScriptParser.h"
 #include <stack>
+#include <string>
+#include <vector>
 
 namespace mcld {
 
 /** \class ScriptScanner
  *
+ *  The scanner can record the tokens it returns, and replay the recorded
+ *  tokens of the same script instead of scanning it again.
  */
 class ScriptScanner : public yyFlexLexer {
+ public:
+  struct Token {
+    int type;
+    unsigned beginLine;
+    unsigned beginColumn;
+    unsigned endLine;
+    unsigned endColumn;
+    // the value of an INTEGER
+    uint64_t integer;
+    // the value of a STRING or a LNAMESPEC
+    std::string text;
+  };
+
+  typedef std::vector<Token> TokenList;
+
  public:
   explicit ScriptScanner(std::istream* yyin = NULL, std::ostream* yyout = NULL);
 
@@ -48,12 +67,30 @@ class ScriptScanner : public yyFlexLexer {
 
   void popLexState();
 
+  /// record - append the tokens returned from now on to pTokens
+  void record(TokenList& pTokens) { m_pRecord = &pTokens; }
+
+  /// replay - return the tokens of pTokens instead of scanning the input
+  void replay(const TokenList& pTokens);
+
+  /// hasError - the scanner reported an error, so its tokens are not worth
+  /// replaying
+  bool hasError() const { return m_bHasError; }
+
  private:
+  ScriptParser::token_type scan(ScriptParser::semantic_type* yylval,
+                                ScriptParser::location_type* yylloc,
+                                const ScriptFile& pScriptFile);
+
   void enterComments(ScriptParser::location_type& pLocation);
 
  private:
   ScriptFile::Kind m_Kind;
   std::stack<ScriptFile::Kind> m_StateStack;
+  TokenList* m_pRecord;
+  const TokenList* m_pReplay;
+  size_t m_ReplayPos;
+  bool m_bHasError;
 };
 
 }  // namespace mcld
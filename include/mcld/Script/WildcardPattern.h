@@ -15,10 +15,19 @@
 
 #include <llvm/ADT/StringRef.h>
 
+#include <bitset>
+#include <string>
+#include <vector>
+
 namespace mcld {
 
 /** \class WildcardPattern
  *  \brief This class defines the interfaces to Input Section Wildcard Patterns
+ *
+ *  A pattern is compiled when it is created. The common shapes "name",
+ *  "name*", "*name" and "*name*" are matched by comparing the literal part;
+ *  any other pattern is compiled into a sequence of characters, `?', `*' and
+ *  bracket classes and is matched without calling fnmatch.
  */
 
 class WildcardPattern : public StrToken {
@@ -32,6 +41,15 @@ class WildcardPattern : public StrToken {
     SORT_BY_INIT_PRIORITY
   };
 
+  enum MatchKind {
+    Exact,     // no wildcards
+    Prefix,    // literal followed by a `*'
+    Suffix,    // `*' followed by literal
+    Contains,  // literal between two `*'
+    Glob,      // any other wildcards
+    Complex    // uses the bracket expressions that only fnmatch knows
+  };
+
  private:
   friend class Chunk<WildcardPattern, MCLD_SYMBOLS_PER_INPUT>;
   WildcardPattern();
@@ -42,10 +60,18 @@ class WildcardPattern : public StrToken {
 
   SortPolicy sortPolicy() const { return m_SortPolicy; }
 
-  bool isPrefix() const { return m_bIsPrefix; }
+  MatchKind matchKind() const { return m_MatchKind; }
+
+  bool isPrefix() const { return m_MatchKind == Prefix; }
 
   llvm::StringRef prefix() const;
 
+  /// literal - the fixed part of an Exact, Prefix, Suffix or Contains pattern
+  llvm::StringRef literal() const { return m_Literal; }
+
+  /// matches - check if pName matches the pattern, as fnmatch would do
+  bool matches(llvm::StringRef pName) const;
+
   static bool classof(const StrToken* pToken) {
     return pToken->kind() == StrToken::Wildcard;
   }
@@ -56,9 +82,31 @@ class WildcardPattern : public StrToken {
   static void destroy(WildcardPattern*& pToken);
   static void clear();
 
+ private:
+  struct Element {
+    enum Type { Char, AnyChar, Star, Class };
+    Type type;
+    // the character of a Char, or the index of the class of a Class
+    unsigned value;
+  };
+
+  typedef std::bitset<256> CharClass;
+
+ private:
+  void compile();
+
+  /// parseClass - parse the bracket expression at pPos of the pattern. Return
+  /// npos if it is not a bracket expression, or the position after it.
+  size_t parseClass(size_t pPos, CharClass& pClass);
+
+  bool matchGlob(llvm::StringRef pName) const;
+
  private:
   SortPolicy m_SortPolicy;
-  bool m_bIsPrefix;
+  MatchKind m_MatchKind;
+  std::string m_Literal;
+  std::vector<Element> m_Elements;
+  std::vector<CharClass> m_Classes;
 };
 
 }  // namespace mcld
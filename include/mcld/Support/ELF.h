@@ -19,9 +19,46 @@ enum SHF {
   SHF_ORDERED = 0x40000000,
 
   // Section with data that is GP relative addressable.
-  SHF_MIPS_GPREL = 0x10000000
+  SHF_MIPS_GPREL = 0x10000000,
+
+  // Section with compressed data, which starts with an ElfXX_Chdr.
+  SHF_COMPRESSED = 0x800
 };  // enum SHF
 
+// Compression types of ElfXX_Chdr
+enum ELFCOMPRESS {
+  ELFCOMPRESS_ZLIB = 1
+};  // enum ELFCOMPRESS
+
+// Section types
+enum SHT {
+  // Packed relative relocations.
+  SHT_RELR = 19,
+
+  // Android packed relocations.
+  SHT_ANDROID_REL = 0x60000001,
+  SHT_ANDROID_RELA = 0x60000002
+};  // enum SHT
+
+// Dynamic table tags
+enum DT {
+  // The size and the address of the packed relative relocations, and the
+  // size of one entry.
+  DT_RELRSZ = 35,
+  DT_RELR = 36,
+  DT_RELRENT = 37,
+
+  // The address and the size of the Android packed relocations.
+  DT_ANDROID_REL = 0x6000000f,
+  DT_ANDROID_RELSZ = 0x60000010,
+  DT_ANDROID_RELA = 0x60000011,
+  DT_ANDROID_RELASZ = 0x60000012,
+
+  // The output is laid out at a fixed base, and the places of its relative
+  // relocations already hold their values at that base.
+  DT_GNU_PRELINKED = 0x6ffffdf5
+};  // enum DT
+
 }  // namespace ELF
 }  // namespace mcld
 
@@ -82,6 +82,9 @@ class FileHandle {
   // truncate - truncate the file up to the pSize.
   bool truncate(size_t pSize);
 
+  // sync - flush the content of the file to the storage device.
+  bool sync();
+
   bool read(void* pMemBuffer, size_t pStartOffset, size_t pLength);
 
   bool write(const void* pMemBuffer, size_t pStartOffset, size_t pLength);
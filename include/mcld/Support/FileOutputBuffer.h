@@ -15,7 +15,10 @@
 #include <llvm/Support/DataTypes.h>
 #include <llvm/Support/FileSystem.h>
 
+#include <future>
 #include <system_error>
+#include <utility>
+#include <vector>
 
 namespace mcld {
 
@@ -23,31 +26,90 @@ class FileHandle;
 
 /// FileOutputBuffer - This interface is borrowed from llvm bassically, and we
 /// may use ostream to emit output later.
+///
+/// In the stream mode, the buffer is anonymous memory, and it is written to
+/// the file with large pwrites. The ranges that are flushed are written in
+/// the background while the link goes on, and the rest is written by commit.
+///
+/// In the patch mode, the file is an old output of the same size, and commit
+/// only writes the blocks that differ from it.
+///
+/// In the memory mode, the buffer is the memory of the caller, and there is no
+/// file.
+///
+/// A file which is empty when the buffer is created is only extended, so it
+/// reads as zeros. The writers need not write the zero bytes into such a
+/// buffer, and the stream mode leaves the zero blocks as holes of the file.
 class FileOutputBuffer {
+ public:
+  enum Mode {
+    MMap,    ///< write through a shared mapping of the file
+    Stream,  ///< write an anonymous buffer with pwrite
+    Patch,   ///< write the blocks of an anonymous buffer that changed
+    Memory   ///< write into the memory of the caller
+  };
+
  public:
   /// Factory method to create an OutputBuffer object which manages a read/write
   /// buffer of the specified size. When committed, the buffer will be written
   /// to the file at the specified path.
   static std::error_code create(FileHandle& pFileHandle,
+                                size_t pSize,
+                                std::unique_ptr<FileOutputBuffer>& pResult,
+                                Mode pMode = MMap);
+
+  /// Factory method to create an OutputBuffer object on the pSize bytes of
+  /// pData in the memory mode. The memory should be zeroed.
+  static std::error_code create(uint8_t* pData,
                                 size_t pSize,
                                 std::unique_ptr<FileOutputBuffer>& pResult);
 
   /// Returns a pointer to the start of the buffer.
-  uint8_t* getBufferStart() {
-    return reinterpret_cast<uint8_t*>(m_pRegion->data());
-  }
+  uint8_t* getBufferStart() { return m_pData; }
 
   /// Returns a pointer to the end of the buffer.
-  uint8_t* getBufferEnd() {
-    return reinterpret_cast<uint8_t*>(m_pRegion->data()) + m_pRegion->size();
-  }
+  uint8_t* getBufferEnd() { return m_pData + m_Size; }
 
   /// Returns size of the buffer.
-  size_t getBufferSize() const { return m_pRegion->size(); }
+  size_t getBufferSize() const { return m_Size; }
+
+  /// isZeroed - the buffer was all zeros when it was created
+  bool isZeroed() const { return m_bZeroed; }
 
   MemoryRegion request(size_t pOffset, size_t pLength);
 
-  /// Returns path where file will show up if buffer is committed.
+  /// flush - the range [pOffset, pOffset + pLength) is final and is not
+  /// written again. In the stream mode, it is written in the background.
+  void flush(size_t pOffset, size_t pLength);
+
+  /// commit - write the ranges that are not flushed and wait for all writes.
+  /// In the mmap mode, the pages are written back when the buffer is gone.
+  std::error_code commit();
+
+  /// restore - in the patch mode, read the old bytes of the file in
+  /// [pOffset, pOffset + pLength) back into the buffer. It returns false in
+  /// the other modes or if the file is short.
+  bool restore(size_t pOffset, size_t pLength);
+
+  /// canCopyFile - copyFile may copy into the output
+  bool canCopyFile() const { return MMap == m_Mode; }
+
+  /// copyFile - copy pLength bytes at pFromOffset of the file pPath into
+  /// [pOffset, pOffset + pLength) of the output by copy_file_range, which
+  /// shares the blocks on the file systems with reflinks. The bytes do not
+  /// pass through the memory of the link, and the mapping reads them back.
+  /// It returns false if the bytes may not be copied, and then the caller
+  /// writes them.
+  bool copyFile(const std::string& pPath,
+                size_t pFromOffset,
+                size_t pOffset,
+                size_t pLength);
+
+  /// getPatchedSize - the bytes written by commit in the patch mode
+  size_t getPatchedSize() const { return m_PatchedSize; }
+
+  /// Returns path where file will show up if buffer is committed, or an
+  /// empty path in the memory mode.
   llvm::StringRef getPath() const;
 
   ~FileOutputBuffer();
@@ -57,10 +119,39 @@ class FileOutputBuffer {
   FileOutputBuffer& operator=(const FileOutputBuffer&);
 
   FileOutputBuffer(llvm::sys::fs::mapped_file_region* pRegion,
-                   FileHandle& pFileHandle);
+                   FileHandle& pFileHandle,
+                   bool pZeroFile);
+
+  FileOutputBuffer(uint8_t* pData,
+                   size_t pSize,
+                   FileHandle* pFileHandle,
+                   Mode pMode,
+                   bool pZeroFile);
+
+  /// write - write a range of the buffer in the stream mode
+  std::error_code write(size_t pOffset, size_t pLength) const;
+
+  /// commitPatch - write the blocks that differ from the file
+  std::error_code commitPatch();
+
+ private:
+  typedef std::pair<size_t, size_t> Range;
 
+  Mode m_Mode;
   std::unique_ptr<llvm::sys::fs::mapped_file_region> m_pRegion;
-  FileHandle& m_FileHandle;
+  uint8_t* m_pData;
+  size_t m_Size;
+  FileHandle* m_pFileHandle;  // NULL in the memory mode
+
+  /// m_Flushed - the ranges which are written in the background
+  std::vector<Range> m_Flushed;
+  std::vector<std::future<std::error_code> > m_Writes;
+  size_t m_PatchedSize;
+  bool m_bCommitted;
+
+  /// m_bZeroFile - the file was empty before it was resized
+  bool m_bZeroFile;
+  bool m_bZeroed;
 };
 
 }  // namespace mcld
@@ -70,6 +70,8 @@ class Path;
 class DirIterator;
 class Directory;
 
+/// exists, is_directory - the status of a path is read once per process,
+/// so files created or removed afterwards are not seen
 bool exists(const Path& pPath);
 bool is_directory(const Path& pPath);
 
@@ -95,7 +97,15 @@ int open(const Path& pPath, int pOFlag);
 int open(const Path& pPath, int pOFlag, int pPermission);
 ssize_t pread(int pFD, void* pBuf, size_t pCount, off_t pOffset);
 ssize_t pwrite(int pFD, const void* pBuf, size_t pCount, off_t pOffset);
+/// copy_file_range - copy pCount bytes between two files in the kernel, or
+/// return -1 with ENOSYS if the system cannot
+ssize_t copy_file_range(int pFromFD,
+                        off_t pFromOffset,
+                        int pToFD,
+                        off_t pToOffset,
+                        size_t pCount);
 int ftruncate(int pFD, size_t pLength);
+int fsync(int pFD);
 void* mmap(void* pAddr,
            size_t pLen,
            int pProt,
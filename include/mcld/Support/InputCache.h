@@ -0,0 +1,62 @@
+//===- InputCache.h -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_INPUTCACHE_H_
+#define MCLD_SUPPORT_INPUTCACHE_H_
+
+#include <llvm/ADT/StringRef.h>
+
+#include <string>
+#include <vector>
+
+namespace llvm {
+class MemoryBuffer;
+}  // namespace llvm
+
+namespace mcld {
+
+/** \class InputCache
+ *  \brief InputCache keeps the shared objects and the archives resident in a
+ *  long-running link server.
+ *
+ *  The server forks a child for every link. The child reads the cached files
+ *  from the memory it inherits from the server, and records the files it had
+ *  to read by itself, so that the server can load them for the next links.
+ *  An entry is only used while the device, the inode, the size and the
+ *  modification time of the file stay the same.
+ *
+ *  The cache is disabled unless the link server enables it.
+ */
+class InputCache {
+ public:
+  /// Enable - turn the cache on or off. Turning it off drops the entries.
+  static void Enable(bool pEnable);
+
+  static bool IsEnabled();
+
+  /// Lookup - the cached content of pPath, or NULL if pPath is not cached or
+  /// the file has changed since it was loaded.
+  static const llvm::MemoryBuffer* Lookup(llvm::StringRef pPath);
+
+  /// Load - read pPath into the cache if it is a shared object or an archive.
+  /// @return true if pPath is cached
+  static bool Load(llvm::StringRef pPath);
+
+  /// RecordMiss - remember that pPath was read without the cache
+  static void RecordMiss(llvm::StringRef pPath);
+
+  /// GetMisses - the paths recorded by RecordMiss
+  static const std::vector<std::string>& GetMisses();
+
+  /// size - the number of the cached files
+  static size_t size();
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_SUPPORT_INPUTCACHE_H_
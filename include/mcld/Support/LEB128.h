@@ -35,13 +35,20 @@ IntType decode(const ByteType*& pBuf);
 template <typename IntType>
 size_t size(IntType pValue) {
   size_t size = 1;
-  while (pValue > 0x80) {
+  while (pValue >= 0x80) {
     pValue >>= 7;
     ++size;
   }
   return size;
 }
 
+/*
+ * The number of bytes required to encode a signed integer in SLEB128 format,
+ * without encoding it.
+ */
+template <>
+size_t size<int64_t>(int64_t pValue);
+
 /*
  * Write an unsigned integer in ULEB128 to the given buffer. The client should
  * ensure there's enough space in the buffer to hold the result. Update the
@@ -87,6 +94,18 @@ int64_t decode<int64_t>(const ByteType* pBuf, size_t& pSize);
 template <>
 int64_t decode<int64_t>(const ByteType*& pBuf);
 
+/*
+ * Read at most pCount integers encoded in ULEB128 format from the buffer
+ * [pBuf, pEnd) into pValues. An integer of at most 8 bytes is decoded from
+ * one 64-bit load without a loop over its bytes. Update pBuf to the point
+ * just past the last read value and return the number of integers read,
+ * which is less than pCount if the buffer ends in the middle of a value.
+ */
+size_t decodeBatch(const ByteType*& pBuf,
+                   const ByteType* pEnd,
+                   uint64_t* pValues,
+                   size_t pCount);
+
 /*
  * The functions below handle the signed byte stream. This helps the user to get
  * rid of annoying type conversions when using the LEB128 encoding/decoding APIs
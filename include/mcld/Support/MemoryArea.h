@@ -14,6 +14,8 @@
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Support/MemoryBuffer.h>
 
+#include <string>
+
 namespace mcld {
 
 /** \class MemoryArea
@@ -22,6 +24,15 @@ namespace mcld {
 class MemoryArea {
   friend class MemoryAreaFactory;
 
+ public:
+  /// Advice - how a range of the area is going to be accessed.
+  enum Advice {
+    Normal,
+    Sequential,
+    WillNeed,
+    DontNeed
+  };
+
  public:
   // constructor by file handler.
   // If the given file handler is read-only, client can not request a region
@@ -31,6 +42,10 @@ class MemoryArea {
 
   explicit MemoryArea(const char* pMemBuffer, size_t pSize);
 
+  /// constructor by a buffer already read from the file pFilename
+  MemoryArea(std::unique_ptr<llvm::MemoryBuffer> pBuffer,
+             llvm::StringRef pFilename);
+
   // request - create a MemoryRegion within a sufficient space
   // find an existing space to hold the MemoryRegion.
   // if MemoryArea does not find such space, then it creates a new space and
@@ -39,8 +54,19 @@ class MemoryArea {
 
   size_t size() const;
 
+  /// path - the file whose content the area is read from, or empty if the
+  /// area is in memory or shared with a link server
+  const std::string& path() const { return m_Path; }
+
+  /// advise - tell the system how [pOffset, pOffset + pLength) is going to be
+  /// accessed. The content of the area never changes; DontNeed pages are read
+  /// back from the file if they are touched again. Areas not mapped from a
+  /// file ignore the advice.
+  void advise(size_t pOffset, size_t pLength, Advice pAdvice);
+
  private:
   std::unique_ptr<llvm::MemoryBuffer> m_pMemoryBuffer;
+  std::string m_Path;
 
  private:
   DISALLOW_COPY_AND_ASSIGN(MemoryArea);
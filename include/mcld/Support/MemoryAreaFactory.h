@@ -14,9 +14,15 @@
 #include "mcld/Support/Path.h"
 
 #include <llvm/ADT/StringMap.h>
+#include <llvm/Support/FileSystem.h>
+
+#include <map>
+#include <vector>
 
 namespace mcld {
 
+class ThreadPool;
+
 /** \class MemoryAreaFactory
  *  \brief MemoryAreaFactory avoids creating duplicated MemoryAreas of the
  *   same file.
@@ -57,10 +63,23 @@ class MemoryAreaFactory : public GCFactory<MemoryArea, 0> {
   // The created MemoryArea is not moderated by m_HandleToArea.
   MemoryArea* produce(int pFD, FileHandle::OpenMode pMode);
 
+  /// prefetch - read the files of pPaths on pPool ahead of their produce().
+  /// The files are registered in the order of pPaths, and the files which
+  /// cannot be read are left to produce() to report.
+  void prefetch(const std::vector<sys::fs::Path>& pPaths, ThreadPool& pPool);
+
   void destruct(MemoryArea* pArea);
 
+ private:
+  /// produceFile - the MemoryArea of the file pName. A file is only mapped
+  /// once, whichever path names it.
+  MemoryArea* produceFile(llvm::StringRef pName);
+
  private:
   llvm::StringMap<MemoryArea*> m_AreaMap;
+
+  /// m_FileMap - the MemoryArea of each file by its device and inode
+  std::map<llvm::sys::fs::UniqueID, MemoryArea*> m_FileMap;
 };
 
 }  // namespace mcld
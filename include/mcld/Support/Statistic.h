@@ -0,0 +1,89 @@
+//===- Statistic.h --------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_STATISTIC_H_
+#define MCLD_SUPPORT_STATISTIC_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <atomic>
+
+/// MCLD_ENABLE_STATS - build with -DMCLD_ENABLE_STATS=0 to compile the
+/// counters away.
+#ifndef MCLD_ENABLE_STATS
+#define MCLD_ENABLE_STATS 1
+#endif
+
+namespace llvm {
+class raw_ostream;
+}  // namespace llvm
+
+namespace mcld {
+
+/** \class Statistic
+ *  \brief Statistic is a named counter of the hot paths.
+ *
+ *  A counter registers itself when it is constructed, so it is declared as a
+ *  static object, either at namespace scope or in a function body of a
+ *  template. Counters of the same name are summed up when they are printed.
+ *  An increment is a relaxed atomic add, so counters can be bumped from the
+ *  worker threads.
+ */
+class Statistic {
+ public:
+  Statistic(const char* pName, const char* pDesc);
+
+  ~Statistic();
+
+  void inc(uint64_t pValue = 1) {
+#if MCLD_ENABLE_STATS
+    m_Value.fetch_add(pValue, std::memory_order_relaxed);
+#else
+    (void)pValue;
+#endif
+  }
+
+  Statistic& operator++() {
+    inc();
+    return *this;
+  }
+
+  Statistic& operator+=(uint64_t pValue) {
+    inc(pValue);
+    return *this;
+  }
+
+  const char* name() const { return m_pName; }
+
+  const char* desc() const { return m_pDesc; }
+
+  uint64_t value() const { return m_Value.load(std::memory_order_relaxed); }
+
+  /// Add - add pValue to the counter named pName, which is created on the
+  /// first use. This is for counters whose names are only known at run time,
+  /// such as the relocation types of a target.
+  static void Add(llvm::StringRef pName, uint64_t pValue);
+
+  /// PrintAll - print the non-zero counters sorted by name
+  static void PrintAll(llvm::raw_ostream& pOS);
+
+ private:
+  const char* m_pName;
+  const char* m_pDesc;
+  std::atomic<uint64_t> m_Value;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(Statistic);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_SUPPORT_STATISTIC_H_
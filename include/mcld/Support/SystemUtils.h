@@ -36,6 +36,9 @@ long GetRandomNum();
 /// SetRandomSeed - set the initial seed value for future calls to random().
 void SetRandomSeed(unsigned pSeed);
 
+/// GetPeakRSS - the peak resident set size of the process in bytes.
+size_t GetPeakRSS();
+
 }  // namespace sys
 }  // namespace mcld
 
@@ -0,0 +1,64 @@
+//===- TarWriter.h --------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_TARWRITER_H_
+#define MCLD_SUPPORT_TARWRITER_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <memory>
+#include <set>
+#include <string>
+#include <system_error>
+
+namespace mcld {
+
+/** \class TarWriter
+ *  \brief TarWriter writes files into a ustar archive.
+ *
+ *  Every member is put under a base directory, so that the archive extracts
+ *  into one directory. A path which does not fit the ustar header is written
+ *  with a PAX extended header.
+ */
+class TarWriter {
+ public:
+  /// create - create the archive pFile. The members are put under pBaseDir.
+  static std::error_code create(const std::string& pFile,
+                                const std::string& pBaseDir,
+                                std::unique_ptr<TarWriter>& pResult);
+
+  ~TarWriter();
+
+  /// append - add pData as pBaseDir/pPath. A path is only added once.
+  void append(llvm::StringRef pPath, llvm::StringRef pData);
+
+  /// close - write the end of the archive and close the file
+  std::error_code close();
+
+ private:
+  TarWriter(int pFD, const std::string& pBaseDir);
+
+  void writeHeader(llvm::StringRef pName, char pType, uint64_t pSize);
+
+  void writePadding(uint64_t pSize);
+
+ private:
+  llvm::raw_fd_ostream m_OS;
+  std::string m_BaseDir;
+  std::set<std::string> m_Files;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TarWriter);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_SUPPORT_TARWRITER_H_
@@ -55,6 +55,10 @@ class Target {
   typedef DiagnosticLineInfo* (*DiagnosticLineInfoCtorTy)(const mcld::Target&,
                                                           const std::string&);
 
+  /// InitializerFnTy - registers the emulation, the backend and the other
+  /// components of a target on its first use
+  typedef void (*InitializerFnTy)();
+
  public:
   Target();
 
@@ -86,6 +90,10 @@ class Target {
       const mcld::Target& pTarget,
       const std::string& pTriple) const;
 
+ private:
+  /// initialize - register the components which are registered lazily
+  void initialize() const;
+
  private:
   /// Name - The target name
   const char* Name;
@@ -96,6 +104,7 @@ class Target {
   EmulationFnTy EmulationFn;
   TargetLDBackendCtorTy TargetLDBackendCtorFn;
   DiagnosticLineInfoCtorTy DiagnosticLineInfoCtorFn;
+  InitializerFnTy InitializerFn;
 };
 
 }  // namespace mcld
@@ -88,6 +88,17 @@ class TargetRegistry {
       T.DiagnosticLineInfoCtorFn = Fn;
   }
 
+  /// RegisterInitializer - Register a function which registers the other
+  /// components of the target when the target is first used.
+  ///
+  /// @param T - The target being registered
+  /// @param Fn - A function to register the components of the target
+  static void RegisterInitializer(mcld::Target& T,
+                                  mcld::Target::InitializerFnTy Fn) {
+    if (!T.InitializerFn)
+      T.InitializerFn = Fn;
+  }
+
   /// lookupTarget - Look up MCLinker target
   ///
   /// @param Triple - The Triple string
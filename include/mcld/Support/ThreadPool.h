@@ -0,0 +1,152 @@
+//===- ThreadPool.h -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_THREADPOOL_H_
+#define MCLD_SUPPORT_THREADPOOL_H_
+
+#include "mcld/Support/Compiler.h"
+#include "mcld/Support/MsgHandling.h"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace mcld {
+
+/** \class ThreadPool
+ *  \brief ThreadPool runs independent tasks on a fixed set of worker threads.
+ *
+ *  A pool with less than two threads does not spawn any worker. Tasks are run
+ *  immediately on the calling thread, so that a serial link pays nothing for
+ *  going through the pool.
+ *
+ *  The worker threads are shared by all pools of the process. They are
+ *  started as the pools alive at the same time need them, and live until the
+ *  process exits, so the link phases which make their own pools do not start
+ *  threads again. wait() runs the queued tasks of its own pool on the waiting
+ *  thread, so that a task can wait on a nested pool without holding up a
+ *  worker.
+ */
+class ThreadPool {
+ public:
+  typedef std::function<void()> Task;
+
+ public:
+  explicit ThreadPool(unsigned pNumThreads);
+
+  ~ThreadPool();
+
+  /// async - queue a task. The task may start before async() returns.
+  void async(Task pTask);
+
+  /// wait - block until all queued tasks are done.
+  void wait();
+
+  /// size - the number of threads that run tasks.
+  unsigned size() const { return isParallel() ? m_NumThreads : 1; }
+
+  bool isParallel() const { return m_pWorkers != NULL; }
+
+ private:
+  class Workers;
+
+  /// GetWorkers - the workers of the process
+  static Workers& GetWorkers();
+
+ private:
+  /// m_pWorkers - the shared workers, or NULL if the pool is serial
+  Workers* m_pWorkers;
+  unsigned m_NumThreads;
+
+  /// m_NumPending - the tasks queued and not finished yet, guarded by the
+  /// mutex of the workers
+  unsigned m_NumPending;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ThreadPool);
+};
+
+/// parallelFor - call pFunc(i) for each i in [pBegin, pEnd) on the pool, and
+/// wait until all calls finish. Indices are handed out in contiguous chunks,
+/// several per thread so that uneven work still balances. The diagnostics of
+/// the calls are reported after they finish, in the order of the indices.
+template <typename FuncType>
+void parallelFor(ThreadPool& pPool, size_t pBegin, size_t pEnd,
+                 FuncType pFunc) {
+  if (pBegin >= pEnd)
+    return;
+
+  if (!pPool.isParallel()) {
+    for (size_t i = pBegin; i != pEnd; ++i)
+      pFunc(i);
+    return;
+  }
+
+  size_t chunk = (pEnd - pBegin) / (pPool.size() * 4);
+  if (chunk == 0)
+    chunk = 1;
+  std::vector<DiagnosticEngine::Buffer> diags((pEnd - pBegin + chunk - 1) /
+                                              chunk);
+  for (size_t begin = pBegin; begin < pEnd; begin += chunk) {
+    size_t end = (pEnd - begin > chunk) ? begin + chunk : pEnd;
+    DiagnosticEngine::Buffer* diag = &diags[(begin - pBegin) / chunk];
+    pPool.async([begin, end, diag, &pFunc]() {
+      DiagnosticEngine::BufferScope scope(*diag);
+      for (size_t i = begin; i != end; ++i)
+        pFunc(i);
+    });
+  }
+  pPool.wait();
+
+  for (size_t i = 0; i < diags.size(); ++i) {
+    if (!diags[i].empty())
+      getDiagnosticEngine().replay(diags[i]);
+  }
+}
+
+/// parallelForEach - call pFunc(*i) for each i in the random access range
+/// [pBegin, pEnd), such as the range of Module::obj_iterator.
+template <typename IterType, typename FuncType>
+void parallelForEach(ThreadPool& pPool, IterType pBegin, IterType pEnd,
+                     FuncType pFunc) {
+  parallelFor(pPool, 0, pEnd - pBegin, [&pBegin, &pFunc](size_t pIndex) {
+    pFunc(pBegin[pIndex]);
+  });
+}
+
+/// parallelReduce - combine pMap(i) for each i in [pBegin, pEnd) by
+/// pCombine, which must be associative with the identity pInit. The values
+/// are combined in the order of the indices, so the result is the same for
+/// any number of threads even if pCombine is not commutative.
+template <typename ValueType, typename MapType, typename CombineType>
+ValueType parallelReduce(ThreadPool& pPool, size_t pBegin, size_t pEnd,
+                         ValueType pInit, MapType pMap,
+                         CombineType pCombine) {
+  if (pBegin >= pEnd)
+    return pInit;
+
+  size_t chunk = (pEnd - pBegin) / (pPool.size() * 4);
+  if (chunk == 0)
+    chunk = 1;
+  std::vector<ValueType> partial((pEnd - pBegin + chunk - 1) / chunk, pInit);
+  parallelFor(pPool, 0, partial.size(), [&](size_t pChunk) {
+    size_t begin = pBegin + pChunk * chunk;
+    size_t end = (pEnd - begin > chunk) ? begin + chunk : pEnd;
+    for (size_t i = begin; i != end; ++i)
+      partial[pChunk] = pCombine(partial[pChunk], pMap(i));
+  });
+
+  ValueType result = pInit;
+  for (size_t i = 0; i < partial.size(); ++i)
+    result = pCombine(result, partial[i]);
+  return result;
+}
+
+}  // namespace mcld
+
+#endif  // MCLD_SUPPORT_THREADPOOL_H_
@@ -0,0 +1,117 @@
+//===- TimeTrace.h --------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_TIMETRACE_H_
+#define MCLD_SUPPORT_TIMETRACE_H_
+
+#include "mcld/Support/Compiler.h"
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+}  // namespace llvm
+
+namespace mcld {
+
+/** \class TimeTrace
+ *  \brief TimeTrace records the time of the link phases and a few counters.
+ *
+ *  The phases are recorded by TimeTrace::Scope on the thread that drives the
+ *  link. A scope does nothing unless a TimeTrace is installed by SetCurrent,
+ *  so the phases can be marked anywhere without passing the trace around.
+ */
+class TimeTrace {
+ public:
+  /** \class Scope
+   *  \brief Scope records the time from its construction to its destruction.
+   */
+  class Scope {
+   public:
+    explicit Scope(const char* pName);
+
+    ~Scope();
+
+   private:
+    const char* m_pName;
+    uint64_t m_Begin;
+
+   private:
+    DISALLOW_COPY_AND_ASSIGN(Scope);
+  };
+
+ public:
+  TimeTrace();
+
+  ~TimeTrace();
+
+  /// Current - the installed trace, or NULL
+  static TimeTrace* Current();
+
+  static void SetCurrent(TimeTrace* pTrace);
+
+  /// PhaseHook - called with the name of every phase as it ends
+  typedef std::function<void(llvm::StringRef)> PhaseHook;
+
+  void setPhaseHook(const PhaseHook& pHook) { m_PhaseHook = pHook; }
+
+  /// now - microseconds since the trace was created
+  uint64_t now() const;
+
+  void addEvent(llvm::StringRef pName, uint64_t pBegin, uint64_t pDuration);
+
+  void addCount(llvm::StringRef pName, uint64_t pValue);
+
+  /// Args - the named values shown with an event
+  typedef std::vector<std::pair<std::string, uint64_t> > Args;
+
+  /// addInstant - add an event of no duration at this moment. pDetail is
+  /// shown with the event as the argument "detail", followed by pArgs.
+  void addInstant(llvm::StringRef pName,
+                  llvm::StringRef pDetail,
+                  const Args& pArgs);
+
+  /// printChromeTrace - print the events in the Chrome trace event format
+  void printChromeTrace(llvm::raw_ostream& pOS) const;
+
+  /// printSummary - print the time of the phases, the peak RSS and counters.
+  /// The instant events are not phases and are not printed.
+  void printSummary(llvm::raw_ostream& pOS) const;
+
+ private:
+  struct Event {
+    std::string name;
+    uint64_t begin;     ///< in microseconds
+    uint64_t duration;  ///< in microseconds
+    bool instant;
+    std::string detail;
+    Args args;
+  };
+
+  typedef std::pair<std::string, uint64_t> Count;
+
+ private:
+  std::chrono::steady_clock::time_point m_Start;
+  std::vector<Event> m_Events;
+  std::vector<Count> m_Counts;
+  PhaseHook m_PhaseHook;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TimeTrace);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_SUPPORT_TIMETRACE_H_
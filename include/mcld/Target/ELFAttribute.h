@@ -14,6 +14,7 @@
 
 #include <llvm/ADT/SmallVector.h>
 #include <llvm/ADT/StringRef.h>
+#include <llvm/ADT/StringSet.h>
 
 namespace mcld {
 
@@ -54,6 +55,11 @@ class ELFAttribute {
 
  public:
   /// merge - merge attributes from input (attribute) section
+  ///
+  /// Most inputs carry the same attribute section. Merging the attributes is
+  /// a join, so a section with the same content as one merged before adds
+  /// nothing to the output and is skipped. Its diagnostics were issued for
+  /// the first input carrying it.
   bool merge(const Input& pInput, LDSection& pInputAttrSectHdr);
 
   /// sizeOutput - calculate the number of bytes required to encode this
@@ -113,6 +119,9 @@ class ELFAttribute {
 
   // There is at most two subsections ("aeabi" and "gnu") in most cases.
   llvm::SmallVector<Subsection*, 2> m_Subsections;
+
+  // The content of the attribute sections merged so far
+  llvm::StringSet<> m_MergedContents;
 };
 
 }  // namespace mcld
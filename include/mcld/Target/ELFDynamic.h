@@ -12,8 +12,8 @@
 #include "mcld/LD/LDSection.h"
 #include "mcld/Support/FileOutputBuffer.h"
 #include <llvm/Support/ELF.h>
+
 #include <vector>
-#include <cstring>
 
 namespace mcld {
 
@@ -21,104 +21,31 @@ class ELFFileFormat;
 class GNULDBackend;
 class LinkerConfig;
 
-namespace elf_dynamic {
-
-/** \class EntryIF
-*  \brief EntryIF provides a common interface for one entry in the dynamic
-*  section
-*/
-class EntryIF {
- protected:
-  EntryIF();
-
- public:
-  virtual ~EntryIF();
-
-  virtual EntryIF* clone() const = 0;
-  virtual size_t size() const = 0;
-  virtual size_t symbolSize() const = 0;
-  virtual size_t relSize() const = 0;
-  virtual size_t relaSize() const = 0;
-  virtual size_t emit(uint8_t* pAddress) const = 0;
-  virtual void setValue(uint64_t pTag, uint64_t pValue) = 0;
-};
-
-template <size_t BITNUMBER, bool LITTLEENDIAN>
-class Entry {};
-
-template <>
-class Entry<32, true> : public EntryIF {
- public:
-  typedef llvm::ELF::Elf32_Dyn Pair;
-  typedef llvm::ELF::Elf32_Sym Symbol;
-  typedef llvm::ELF::Elf32_Rel Rel;
-  typedef llvm::ELF::Elf32_Rela Rela;
-
- public:
-  inline Entry();
-
-  inline ~Entry();
-
-  Entry* clone() const { return new Entry(); }
-
-  size_t size() const { return sizeof(Pair); }
-
-  size_t symbolSize() const { return sizeof(Symbol); }
-
-  size_t relSize() const { return sizeof(Rel); }
-
-  size_t relaSize() const { return sizeof(Rela); }
-
-  inline void setValue(uint64_t pTag, uint64_t pValue);
-
-  inline size_t emit(uint8_t* pAddress) const;
-
- private:
-  Pair m_Pair;
-};
-
-template <>
-class Entry<64, true> : public EntryIF {
- public:
-  typedef llvm::ELF::Elf64_Dyn Pair;
-  typedef llvm::ELF::Elf64_Sym Symbol;
-  typedef llvm::ELF::Elf64_Rel Rel;
-  typedef llvm::ELF::Elf64_Rela Rela;
-
- public:
-  inline Entry();
-
-  inline ~Entry();
-
-  Entry* clone() const { return new Entry(); }
-
-  size_t size() const { return sizeof(Pair); }
-
-  size_t symbolSize() const { return sizeof(Symbol); }
-
-  size_t relSize() const { return sizeof(Rel); }
-
-  size_t relaSize() const { return sizeof(Rela); }
-
-  inline void setValue(uint64_t pTag, uint64_t pValue);
-
-  inline size_t emit(uint8_t* pAddress) const;
-
- private:
-  Pair m_Pair;
-};
-
-#include "ELFDynamic.tcc"
-
-}  // namespace elf_dynamic
-
 /** \class ELFDynamic
  *  \brief ELFDynamic is the .dynamic section in ELF shared and executable
  *  files.
+ *
+ *  The entries are kept as plain tag and value pairs in one table, which is
+ *  sized when the entries are reserved and filled in the order they are
+ *  applied. The table is encoded for the word size of the output and written
+ *  to the section at once.
  */
 class ELFDynamic {
  public:
-  typedef std::vector<elf_dynamic::EntryIF*> EntryListType;
+  /// Entry - the tag and the value of a dynamic entry
+  struct Entry {
+    Entry() : tag(llvm::ELF::DT_NULL), value(0) {}
+
+    void setValue(uint64_t pTag, uint64_t pValue) {
+      tag = pTag;
+      value = pValue;
+    }
+
+    uint64_t tag;
+    uint64_t value;
+  };
+
+  typedef std::vector<Entry> EntryListType;
   typedef EntryListType::iterator iterator;
   typedef EntryListType::const_iterator const_iterator;
 
@@ -169,10 +96,18 @@ class ELFDynamic {
 
   const LinkerConfig& config() const { return m_Config; }
 
+ private:
+  size_t relSize() const;
+
+  size_t relaSize() const;
+
+  /// emitEntries - encode the entries as DYN into pAddress
+  template <typename DYN>
+  void emitEntries(uint8_t* pAddress) const;
+
  private:
   EntryListType m_EntryList;
   EntryListType m_NeedList;
-  elf_dynamic::EntryIF* m_pEntryFactory;
   const GNULDBackend& m_Backend;
   const LinkerConfig& m_Config;
 
@@ -60,6 +60,10 @@ class GNUInfo {
   /// here. If target favors the different size, please override this function
   virtual uint64_t abiPageSize() const { return 0x1000; }
 
+  /// hugePageSize - the size of the huge pages which the code is aligned to
+  /// for -z hugepage-text, and we set it to 2M here.
+  virtual uint64_t hugePageSize() const { return 0x200000; }
+
   /// stubGroupSize - the default group size to place stubs between sections.
   virtual unsigned stubGroupSize() const { return 0x10000; }
 
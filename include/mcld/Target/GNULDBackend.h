@@ -17,13 +17,16 @@
 #include "mcld/LD/GNUArchiveReader.h"
 #include "mcld/Target/TargetLDBackend.h"
 
+#include <llvm/ADT/DenseSet.h>
 #include <llvm/Support/ELF.h>
 
 #include <cstdint>
+#include <vector>
 
 namespace mcld {
 
 class BranchIslandFactory;
+class BuildIDNote;
 class EhFrameHdr;
 class ELFAttribute;
 class ELFDynamic;
@@ -32,12 +35,16 @@ class ELFExecFileFormat;
 class ELFFileFormat;
 class ELFObjectFileFormat;
 class ELFSegmentFactory;
+class GdbIndex;
 class GNUInfo;
 class IRBuilder;
 class Layout;
 class LinkerConfig;
 class LinkerScript;
 class Module;
+class OutputPackedRelocSection;
+class OutputRelrSection;
+class RelocData;
 class Relocation;
 class StubFactory;
 
@@ -118,6 +125,16 @@ class GNULDBackend : public TargetLDBackend {
   virtual uint64_t emitSectionData(const LDSection& pSection,
                                    MemoryRegion& pRegion) const = 0;
 
+  /// fillCodePadding - fill the pSize bytes of padding at pData, which is at
+  /// the address pAddress of an executable section, with the no-ops of the
+  /// target, so that the code falling through the padding decodes quickly.
+  /// @return false if the padding is filled with zeros
+  virtual bool fillCodePadding(uint8_t* pData,
+                               uint64_t pAddress,
+                               size_t pSize) const {
+    return false;
+  }
+
   /// emitRegNamePools - emit regular name pools - .symtab, .strtab
   virtual void emitRegNamePools(const Module& pModule,
                                 FileOutputBuffer& pOutput);
@@ -133,6 +150,10 @@ class GNULDBackend : public TargetLDBackend {
   virtual void emitGNUHashTab(Module::SymbolTable& pSymtab,
                               FileOutputBuffer& pOutput);
 
+  /// hashDynsymNames - compute the hashes of the names in .dynsym for
+  /// .gnu.hash and .hash, once for each symbol
+  void hashDynsymNames(const Module::SymbolTable& pSymtab);
+
   /// sizeInterp - compute the size of program interpreter's name
   /// In ELF executables, this is the length of dynamic linker's path name
   virtual void sizeInterp();
@@ -181,6 +202,9 @@ class GNULDBackend : public TargetLDBackend {
   /// abiPageSize - the abi page size of the target machine
   uint64_t abiPageSize() const;
 
+  /// hugePageSize - the alignment of the code segment for -z hugepage-text
+  uint64_t hugePageSize() const;
+
   /// getSymbolIdx - get the symbol index of ouput symbol table
   size_t getSymbolIdx(const LDSymbol* pSymbol) const;
 
@@ -251,10 +275,21 @@ class GNULDBackend : public TargetLDBackend {
   /// symbolNeedsPLT - return whether the symbol needs a PLT entry
   bool symbolNeedsPLT(const ResolveInfo& pSym) const;
 
+  /// symbolNeedsCanonicalPLT - return whether the absolute reference pReloc
+  /// to pSym resolves to the PLT entry of pSym
+  bool symbolNeedsCanonicalPLT(const Relocation& pReloc,
+                               const ResolveInfo& pSym) const;
+
   /// symbolNeedsCopyReloc - return whether the symbol needs a copy relocation
   bool symbolNeedsCopyReloc(const Relocation& pReloc,
                             const ResolveInfo& pSym) const;
 
+  /// noteCopyReloc - count the copy relocation of pSym for --print-stats
+  void noteCopyReloc(const ResolveInfo& pSym);
+
+  /// noteCanonicalPLT - count the PLT entry which is the address of pSym
+  void noteCanonicalPLT(const ResolveInfo& pSym);
+
   /// symbolNeedsDynRel - return whether the symbol needs a dynamic relocation
   bool symbolNeedsDynRel(const ResolveInfo& pSym,
                          bool pSymHasPLT,
@@ -264,6 +299,9 @@ class GNULDBackend : public TargetLDBackend {
   /// units
   bool isSymbolPreemptible(const ResolveInfo& pSym) const;
 
+  /// addDynamicListSymbol - pSym is listed in the --dynamic-list
+  void addDynamicListSymbol(const ResolveInfo& pSym);
+
   /// symbolHasFinalValue - return true if the symbol's value can be decided at
   /// link time
   bool symbolFinalValueIsKnown(const ResolveInfo& pSym) const;
@@ -308,6 +346,9 @@ class GNULDBackend : public TargetLDBackend {
   /// getStubFactory
   StubFactory* getStubFactory() { return m_pStubFactory; }
 
+  /// getGdbIndex - the .gdb_index of --gdb-index, or NULL
+  GdbIndex* getGdbIndex() { return m_pGdbIndex; }
+
   /// maxFwdBranchOffset - return the max forward branch offset of the backend.
   /// Target can override this function if needed.
   virtual int64_t maxFwdBranchOffset() const { return INT64_MAX; }
@@ -326,10 +367,47 @@ class GNULDBackend : public TargetLDBackend {
   /// process relocations more efficiently
   void sortRelocation(LDSection& pSection);
 
+  /// sortDynRelocation - sort the relocations in pRelocs for -z combreloc
+  void sortDynRelocation(RelocData& pRelocs);
+
+  /// isRelativeReloc - check if pReloc is a dynamic relocation that only adds
+  /// the load address to a word. Targets which can pack their relative
+  /// relocations into .relr.dyn should override this function.
+  virtual bool isRelativeReloc(const Relocation& pReloc) const { return false; }
+
+  /// packRelativeRelocs - move the relative relocations of .rel.dyn or
+  /// .rela.dyn into .relr.dyn for -z pack-relative-relocs, and size both
+  void packRelativeRelocs();
+
+  /// applyRelativeAddends - write the addends of the relative relocations of
+  /// .rela.dyn to their places for --prelink-base. The relocations are kept,
+  /// so the output still loads at another address.
+  void applyRelativeAddends(FileOutputBuffer& pOutput) const;
+
+  /// getRelrDyn - the packed relative relocations, or NULL if there is none
+  const OutputRelrSection* getRelrDyn() const { return m_pRelrDyn; }
+
+  /// packAndroidRelocs - order the relocations of .rel.dyn or .rela.dyn and
+  /// reserve their size in the Android packed format, for
+  /// --pack-dyn-relocs=android
+  void packAndroidRelocs(const Module& pModule);
+
+  /// getPackedRelDyn - the Android packed relocations, or NULL if there is none
+  const OutputPackedRelocSection* getPackedRelDyn() const {
+    return m_pPackedRelDyn;
+  }
+
   /// createAndSizeEhFrameHdr - This is seperated since we may add eh_frame
   /// entry in the middle
   void createAndSizeEhFrameHdr(Module& pModule);
 
+  /// createAndSizeBuildID - reserve .note.gnu.build-id for --build-id
+  void createAndSizeBuildID();
+
+  /// createAndSizeGdbIndex - read the debug sections and reserve .gdb_index
+  /// for --gdb-index
+  void createAndSizeGdbIndex(Module& pModule);
+
   /// attribute - the attribute section data.
   ELFAttribute& attribute() { return *m_pAttribute; }
 
@@ -364,19 +442,32 @@ class GNULDBackend : public TargetLDBackend {
   /// getGNUHashMaskbitslog2 - calculate the number of mask bits in log2
   unsigned getGNUHashMaskbitslog2(unsigned pNumOfSymbols) const;
 
-  /// emitSymbol32 - emit an ELF32 symbol
-  void emitSymbol32(llvm::ELF::Elf32_Sym& pSym32,
-                    LDSymbol& pSymbol,
-                    char* pStrtab,
-                    size_t pStrtabsize,
-                    size_t pSymtabIdx);
-
-  /// emitSymbol64 - emit an ELF64 symbol
-  void emitSymbol64(llvm::ELF::Elf64_Sym& pSym64,
-                    LDSymbol& pSymbol,
-                    char* pStrtab,
-                    size_t pStrtabsize,
-                    size_t pSymtabIdx);
+  /// tuneGNUHash - choose the number of buckets and mask bits of .gnu.hash
+  /// from the hashes of the symbols, for --hash-optimize=lookup. The given
+  /// values are the default layout.
+  void tuneGNUHash(const Module::SymbolTable& pSymtab,
+                   size_t& pNumOfBuckets,
+                   unsigned& pMaskbitslog2) const;
+
+  /// emitSymbolTable - emit the null symbol and the symbols in
+  /// [pBegin, pEnd) into pSymtab, and their names into pStrtab from
+  /// pStrtabSize. If pSetSymIdx, the symbols keep their indices.
+  void emitSymbolTable(Module::const_sym_iterator pBegin,
+                       Module::const_sym_iterator pEnd,
+                       MemoryRegion& pSymtab,
+                       char* pStrtab,
+                       size_t& pStrtabSize,
+                       bool pSetSymIdx) const;
+
+  /// emitSymbols - emit ELF symbols of the given bitclass and byte order
+  template <size_t BITCLASS, bool ISLITTLE>
+  void emitSymbols(Module::const_sym_iterator pBegin,
+                   Module::const_sym_iterator pEnd,
+                   uint8_t* pSymtab,
+                   size_t pSymIdx,
+                   char* pStrtab,
+                   size_t& pStrtabSize,
+                   bool pSetSymIdx) const;
 
  protected:
   /// createProgramHdrs - base on output sections to create the program headers
@@ -476,15 +567,6 @@ class GNULDBackend : public TargetLDBackend {
     SHO_STRTAB            // .strtab
   };
 
-  // for -z combreloc
-  struct RelocCompare {
-    explicit RelocCompare(const GNULDBackend& pBackend) : m_Backend(pBackend) {}
-    bool operator()(const Relocation& X, const Relocation& Y) const;
-
-   private:
-    const GNULDBackend& m_Backend;
-  };
-
   // for gnu style hash table
   struct DynsymCompare {
     bool needGNUHash(const LDSymbol& X) const;
@@ -492,24 +574,6 @@ class GNULDBackend : public TargetLDBackend {
     bool operator()(const LDSymbol* X, const LDSymbol* Y) const;
   };
 
-  struct SymCompare {
-    bool operator()(const LDSymbol* X, const LDSymbol* Y) const {
-      return (X == Y);
-    }
-  };
-
-  struct SymPtrHash {
-    size_t operator()(const LDSymbol* pKey) const {
-      return (unsigned((uintptr_t)pKey) >> 4) ^
-             (unsigned((uintptr_t)pKey) >> 9);
-    }
-  };
-
-  typedef HashEntry<LDSymbol*, size_t, SymCompare> SymHashEntryType;
-  typedef HashTable<SymHashEntryType,
-                    SymPtrHash,
-                    EntryFactory<SymHashEntryType> > HashTableType;
-
  protected:
   ELFObjectReader* m_pObjectReader;
 
@@ -530,12 +594,21 @@ class GNULDBackend : public TargetLDBackend {
   // stub factory
   StubFactory* m_pStubFactory;
 
-  // map the LDSymbol to its index in the output symbol table
-  HashTableType* m_pSymIndexMap;
-
   // section .eh_frame_hdr
   EhFrameHdr* m_pEhFrameHdr;
 
+  // section .relr.dyn
+  OutputRelrSection* m_pRelrDyn;
+
+  // section .rel.dyn or .rela.dyn in the Android packed format
+  OutputPackedRelocSection* m_pPackedRelDyn;
+
+  // section .note.gnu.build-id
+  BuildIDNote* m_pBuildID;
+
+  // section .gdb_index
+  GdbIndex* m_pGdbIndex;
+
   // attribute section
   ELFAttribute* m_pAttribute;
 
@@ -546,6 +619,25 @@ class GNULDBackend : public TargetLDBackend {
   // DF_STATIC_TLS of DT_FLAGS
   bool m_bHasStaticTLS;
 
+  // ----- hash tables ----- //
+  // the number of symbols, buckets and mask bits in log2 of .gnu.hash,
+  // chosen in sizeNamePools()
+  size_t m_NumOfGNUHashedSyms;
+  size_t m_GNUHashBucketCount;
+  unsigned m_GNUHashMaskbitslog2;
+
+  // the hashes of the names in .dynsym, without the null symbol
+  std::vector<uint32_t> m_GNUHashes;
+  std::vector<uint32_t> m_SysVHashes;
+
+  // the defined symbols which --dynamic-list keeps preemptible
+  llvm::DenseSet<const ResolveInfo*> m_DynamicListSymbols;
+
+  // the symbols which -z nocopyreloc has been warned about, and the symbols
+  // whose PLT entries are their addresses
+  mutable llvm::DenseSet<const ResolveInfo*> m_NoCopyRelocSymbols;
+  llvm::DenseSet<const ResolveInfo*> m_CanonicalPLTSymbols;
+
   // -----  standard symbols  ----- //
   // section symbols
   LDSymbol* f_pPreInitArrayStart;
@@ -9,13 +9,20 @@
 #ifndef MCLD_TARGET_KEYENTRYMAP_H_
 #define MCLD_TARGET_KEYENTRYMAP_H_
 
+#include <llvm/ADT/DenseMap.h>
+
 #include <list>
+#include <utility>
 #include <vector>
 
 namespace mcld {
 
 /** \class KeyEntryMap
  *  \brief KeyEntryMap is a <const KeyType*, ENTRY*> map.
+ *
+ *  The mappings are kept in the order they are recorded, and are indexed by
+ *  the address of the key. The first mapping recorded for a key is the one
+ *  which is looked up.
  */
 template <typename KEY, typename ENTRY>
 class KeyEntryMap {
@@ -46,6 +53,7 @@ class KeyEntryMap {
 
   typedef std::vector<Mapping> KeyEntryPool;
   typedef std::list<EntryPair> PairListType;
+  typedef llvm::DenseMap<const KeyType*, EntryOrPair> IndexType;
 
  public:
   typedef typename KeyEntryPool::iterator iterator;
@@ -75,11 +83,17 @@ class KeyEntryMap {
   const_iterator end() const { return m_Pool.end(); }
   iterator end() { return m_Pool.end(); }
 
-  void reserve(size_t pSize) { m_Pool.reserve(pSize); }
+  void reserve(size_t pSize) {
+    m_Pool.reserve(pSize);
+    m_Index.reserve(pSize);
+  }
 
  private:
   KeyEntryPool m_Pool;
 
+  /// m_Index - the entry or the pair of the first mapping of each key
+  IndexType m_Index;
+
   /// m_Pairs - the EntryPairs
   PairListType m_Pairs;
 };
@@ -87,78 +101,54 @@ class KeyEntryMap {
 template <typename KeyType, typename EntryType>
 const EntryType* KeyEntryMap<KeyType, EntryType>::lookUp(
     const KeyType& pKey) const {
-  const_iterator mapping, mEnd = m_Pool.end();
-  for (mapping = m_Pool.begin(); mapping != mEnd; ++mapping) {
-    if (mapping->key == &pKey) {
-      return mapping->entry.entry_ptr;
-    }
-  }
-
-  return NULL;
+  typename IndexType::const_iterator mapping = m_Index.find(&pKey);
+  if (mapping == m_Index.end())
+    return NULL;
+  return mapping->second.entry_ptr;
 }
 
 template <typename KeyType, typename EntryType>
 EntryType* KeyEntryMap<KeyType, EntryType>::lookUp(const KeyType& pKey) {
-  iterator mapping, mEnd = m_Pool.end();
-  for (mapping = m_Pool.begin(); mapping != mEnd; ++mapping) {
-    if (mapping->key == &pKey) {
-      return mapping->entry.entry_ptr;
-    }
-  }
-
-  return NULL;
+  typename IndexType::iterator mapping = m_Index.find(&pKey);
+  if (mapping == m_Index.end())
+    return NULL;
+  return mapping->second.entry_ptr;
 }
 
 template <typename KeyType, typename EntryType>
 const EntryType* KeyEntryMap<KeyType, EntryType>::lookUpFirstEntry(
     const KeyType& pKey) const {
-  const_iterator mapping, mEnd = m_Pool.end();
-  for (mapping = m_Pool.begin(); mapping != mEnd; ++mapping) {
-    if (mapping->key == &pKey) {
-      return mapping->entry.pair_ptr->entry1;
-    }
-  }
-
-  return NULL;
+  typename IndexType::const_iterator mapping = m_Index.find(&pKey);
+  if (mapping == m_Index.end())
+    return NULL;
+  return mapping->second.pair_ptr->entry1;
 }
 
 template <typename KeyType, typename EntryType>
 EntryType* KeyEntryMap<KeyType, EntryType>::lookUpFirstEntry(
     const KeyType& pKey) {
-  const_iterator mapping, mEnd = m_Pool.end();
-  for (mapping = m_Pool.begin(); mapping != mEnd; ++mapping) {
-    if (mapping->key == &pKey) {
-      return mapping->entry.pair_ptr->entry1;
-    }
-  }
-
-  return NULL;
+  typename IndexType::iterator mapping = m_Index.find(&pKey);
+  if (mapping == m_Index.end())
+    return NULL;
+  return mapping->second.pair_ptr->entry1;
 }
 
 template <typename KeyType, typename EntryType>
 const EntryType* KeyEntryMap<KeyType, EntryType>::lookUpSecondEntry(
     const KeyType& pKey) const {
-  const_iterator mapping, mEnd = m_Pool.end();
-  for (mapping = m_Pool.begin(); mapping != mEnd; ++mapping) {
-    if (mapping->key == &pKey) {
-      return mapping->entry.pair_ptr->entry2;
-    }
-  }
-
-  return NULL;
+  typename IndexType::const_iterator mapping = m_Index.find(&pKey);
+  if (mapping == m_Index.end())
+    return NULL;
+  return mapping->second.pair_ptr->entry2;
 }
 
 template <typename KeyType, typename EntryType>
 EntryType* KeyEntryMap<KeyType, EntryType>::lookUpSecondEntry(
     const KeyType& pKey) {
-  const_iterator mapping, mEnd = m_Pool.end();
-  for (mapping = m_Pool.begin(); mapping != mEnd; ++mapping) {
-    if (mapping->key == &pKey) {
-      return mapping->entry.pair_ptr->entry2;
-    }
-  }
-
-  return NULL;
+  typename IndexType::iterator mapping = m_Index.find(&pKey);
+  if (mapping == m_Index.end())
+    return NULL;
+  return mapping->second.pair_ptr->entry2;
 }
 
 template <typename KeyType, typename EntryType>
@@ -168,6 +158,7 @@ void KeyEntryMap<KeyType, EntryType>::record(const KeyType& pKey,
   mapping.key = &pKey;
   mapping.entry.entry_ptr = &pEntry;
   m_Pool.push_back(mapping);
+  m_Index.insert(std::make_pair(&pKey, mapping.entry));
 }
 
 template <typename KeyType, typename EntryType>
@@ -179,6 +170,7 @@ void KeyEntryMap<KeyType, EntryType>::record(const KeyType& pKey,
   m_Pairs.push_back(EntryPair(&pEntry1, &pEntry2));
   mapping.entry.pair_ptr = &m_Pairs.back();
   m_Pool.push_back(mapping);
+  m_Index.insert(std::make_pair(&pKey, mapping.entry));
 }
 
 }  // namespace mcld
@@ -0,0 +1,88 @@
+//===- OutputPackedRelocSection.h -----------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_TARGET_OUTPUTPACKEDRELOCSECTION_H_
+#define MCLD_TARGET_OUTPUTPACKEDRELOCSECTION_H_
+
+#include "mcld/Support/Compiler.h"
+#include "mcld/Support/MemoryRegion.h"
+
+#include <llvm/Support/DataTypes.h>
+
+
+namespace mcld {
+
+class GNULDBackend;
+class LDSection;
+class LinkerConfig;
+class Relocation;
+
+/** \class OutputPackedRelocSection
+ *  \brief The Android packed relocations of .rel.dyn or .rela.dyn
+ *
+ *  The relocations are encoded in the APS2 format of the Android dynamic
+ *  linker: the magic "APS2", the number of relocations and the initial offset,
+ *  followed by groups of relocations. Each group starts with its size and
+ *  flags, then the fields shared by the group, then the remaining fields of
+ *  each relocation. All the numbers are SLEB128, and the offsets and addends
+ *  are deltas from the previous relocation.
+ *
+ *  The size is reserved before layout, when the addresses, the symbol indices
+ *  and the addends are not known yet. The deltas between places in the same
+ *  output section are exact, and the other numbers are counted at their
+ *  largest encoding. The emitted section is padded to the reserved size.
+ */
+class OutputPackedRelocSection {
+ public:
+  /// OutputPackedRelocSection - pack the relocations of pSection, which are
+  /// already in the order to be emitted
+  OutputPackedRelocSection(LDSection& pSection,
+                           const LinkerConfig& pConfig,
+                           const GNULDBackend& pBackend);
+
+  ~OutputPackedRelocSection();
+
+  /// finalizeSectionSize - reserve the size of the packed relocations. This
+  /// has to be called after the fragments of the places are placed in the
+  /// output sections.
+  void finalizeSectionSize();
+
+  /// emit - write the packed relocations into pRegion
+  void emit(MemoryRegion& pRegion) const;
+
+  // ----- observers ----- //
+  const LDSection& getSection() const { return m_Section; }
+
+  size_t numOfRelocs() const;
+
+ private:
+  /// getInfo - the r_info field of pReloc
+  int64_t getInfo(const Relocation& pReloc) const;
+
+  /// getAddend - the r_addend field of pReloc
+  int64_t getAddend(const Relocation& pReloc) const;
+
+ private:
+  LDSection& m_Section;
+
+  const GNULDBackend& m_Backend;
+
+  bool m_bIs32Bits;
+
+  bool m_bHasAddend;
+
+  /// m_MaxFieldSize - the size of the longest SLEB128 field
+  size_t m_MaxFieldSize;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(OutputPackedRelocSection);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_TARGET_OUTPUTPACKEDRELOCSECTION_H_
@@ -11,6 +11,9 @@
 
 #include "mcld/LD/RelocData.h"
 
+#include <atomic>
+#include <vector>
+
 namespace mcld {
 
 class LDSymbol;
@@ -20,6 +23,13 @@ class RelocationFactory;
 
 /** \class OutputRelocSection
  *  \brief Dynamic relocation section for ARM .rel.dyn and .rel.plt
+ *
+ *  A target either creates the entries as it scans, or reserves them while
+ *  scanning and fills them in while applying. A reservation is only counted.
+ *  The reserved entries are created at once when the section is sized or
+ *  the first one is taken, so they lie next to each other. They are then
+ *  handed out by an atomic cursor, and different inputs may take them in
+ *  parallel.
  */
 class OutputRelocSection {
  public:
@@ -30,8 +40,10 @@ class OutputRelocSection {
   /// create - create an dynamic relocation entry
   Relocation* create();
 
+  /// reserveEntry - count pNum entries to be taken by consumeEntry
   void reserveEntry(size_t pNum = 1);
 
+  /// consumeEntry - take the next reserved entry
   Relocation* consumeEntry();
 
   /// addSymbolToDynSym - add local symbol to TLS category so that it'll be
@@ -39,12 +51,15 @@ class OutputRelocSection {
   bool addSymbolToDynSym(LDSymbol& pSymbol);
 
   // ----- observers ----- //
-  bool empty() { return m_pRelocData->empty(); }
+  bool empty() { return m_pRelocData->empty() && m_NumOfReserved == 0; }
 
+  /// numOfRelocs - the number of the entries, including the reserved ones.
+  /// The section is sized from here, so the reserved entries are created.
   size_t numOfRelocs();
 
  private:
-  typedef RelocData::iterator RelocIterator;
+  /// createReservedEntries - create the entries reserved since the last call
+  void createReservedEntries();
 
  private:
   Module& m_Module;
@@ -53,11 +68,13 @@ class OutputRelocSection {
   /// relocations
   RelocData* m_pRelocData;
 
-  /// m_isVisit - First time visit the function getEntry() or not
-  bool m_isVisit;
+  /// m_Reserved - the created reserved entries, in the order to be taken
+  std::vector<Relocation*> m_Reserved;
+
+  size_t m_NumOfReserved;
 
-  /// m_ValidEntryIterator - point to the first valid entry
-  RelocIterator m_ValidEntryIterator;
+  /// m_Cursor - the index of the next entry in m_Reserved to take
+  std::atomic<size_t> m_Cursor;
 };
 
 }  // namespace mcld
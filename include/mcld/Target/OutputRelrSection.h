@@ -0,0 +1,95 @@
+//===- OutputRelrSection.h ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_TARGET_OUTPUTRELRSECTION_H_
+#define MCLD_TARGET_OUTPUTRELRSECTION_H_
+
+#include "mcld/LD/RelocData.h"
+#include "mcld/Support/Compiler.h"
+#include "mcld/Support/MemoryRegion.h"
+
+#include <llvm/Support/DataTypes.h>
+
+#include <vector>
+
+namespace mcld {
+
+class FileOutputBuffer;
+class LDSection;
+class LinkerConfig;
+class Relocation;
+
+/** \class OutputRelrSection
+ *  \brief The packed relative relocations of .relr.dyn
+ *
+ *  A relative relocation only tells the dynamic linker to add the load address
+ *  to a word, so .relr.dyn keeps the address of the word and nothing else. An
+ *  even entry is an address to relocate. An odd entry is a bitmap of the
+ *  (bits - 1) words that follow the previous entry, with bit 0 set.
+ *
+ *  Each output section starts with an address entry, so that the number of
+ *  entries is known before the output sections are placed.
+ */
+class OutputRelrSection {
+ public:
+  /// OutputRelrSection - pHasAddend tells whether the relocations come from
+  /// RELA relocations, whose addends have to be written to the places.
+  OutputRelrSection(LDSection& pSection,
+                    const LinkerConfig& pConfig,
+                    bool pHasAddend);
+
+  ~OutputRelrSection();
+
+  /// isPackable - check if the relative relocation pReloc can be packed. Its
+  /// place has to be an aligned word in a section whose layout is fixed.
+  bool isPackable(const Relocation& pReloc) const;
+
+  /// add - add the relocation pReloc, which is not in any list
+  void add(Relocation& pReloc);
+
+  /// finalizeSectionSize - set the size of .relr.dyn. This has to be called
+  /// after the fragments of the places are placed in the output sections.
+  void finalizeSectionSize();
+
+  /// emit - write the entries of .relr.dyn into pRegion
+  void emit(MemoryRegion& pRegion) const;
+
+  /// applyAddends - write the addends of the RELA relocations to the places,
+  /// after the relocation results are written to pOutput
+  void applyAddends(FileOutputBuffer& pOutput) const;
+
+  // ----- observers ----- //
+  bool empty() const { return m_pRelocData->empty(); }
+
+  size_t numOfRelocs() const { return m_pRelocData->size(); }
+
+ private:
+  /// encode - compute the entries. The places are addresses if pUseAddress is
+  /// true, or the offsets in their output sections otherwise.
+  void encode(std::vector<uint64_t>& pEntries, bool pUseAddress) const;
+
+  /// write - write the word pValue to pPlace in the target byte order
+  void write(uint8_t* pPlace, uint64_t pValue) const;
+
+ private:
+  const LinkerConfig& m_Config;
+
+  /// m_pRelocData - the relocations packed into .relr.dyn
+  RelocData* m_pRelocData;
+
+  unsigned m_WordSize;
+
+  bool m_bHasAddend;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(OutputRelrSection);
+};
+
+}  // namespace mcld
+
+#endif  // MCLD_TARGET_OUTPUTRELRSECTION_H_
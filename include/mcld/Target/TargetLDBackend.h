@@ -27,6 +27,7 @@ class DynObjReader;
 class DynObjWriter;
 class ExecWriter;
 class FileOutputBuffer;
+class GdbIndex;
 class IRBuilder;
 class Input;
 class LDSection;
@@ -161,6 +162,9 @@ class TargetLDBackend {
   virtual BranchIslandFactory* getBRIslandFactory() = 0;
   virtual StubFactory* getStubFactory() = 0;
 
+  /// getGdbIndex - the .gdb_index to resolve with the relocation results
+  virtual GdbIndex* getGdbIndex() { return NULL; }
+
   /// relax - the relaxation pass
   virtual bool relax(Module& pModule, IRBuilder& pBuilder) = 0;
 
@@ -185,6 +189,10 @@ class TargetLDBackend {
   /// units
   virtual bool isSymbolPreemptible(const ResolveInfo& pSym) const = 0;
 
+  /// addDynamicListSymbol - pSym is listed in the --dynamic-list, and stays
+  /// preemptible
+  virtual void addDynamicListSymbol(const ResolveInfo& pSym) {}
+
   /// mayHaveUnsafeFunctionPointerAccess - check if the section may have unsafe
   /// function pointer access
   virtual bool mayHaveUnsafeFunctionPointerAccess(
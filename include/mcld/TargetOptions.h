@@ -67,6 +67,13 @@ class TargetOptions {
 
   unsigned getStubGroupSize() const { return m_StubGroupSize; }
 
+  /// --stub-reserve: the first relaxation pass takes the branches within
+  /// this many bytes of their range as out of range, so that the stubs added
+  /// in that pass do not push other branches out of range.
+  void setStubReserve(unsigned pSize) { m_StubReserve = pSize; }
+
+  unsigned getStubReserve() const { return m_StubReserve; }
+
   void setFixCA53Erratum835769(bool pEnable = true) {
     m_FixCA53Erratum835769 = pEnable;
   }
@@ -79,6 +86,18 @@ class TargetOptions {
 
   bool fixCA53Erratum843419() const { return m_FixCA53Erratum843419; }
 
+  /// --relax-adrp: rewrite the ADRP pairs of AArch64 whose targets are within
+  /// 1MB to a NOP and an ADR or a literal load
+  void setRelaxADRP(bool pEnable = true) { m_RelaxADRP = pEnable; }
+
+  bool relaxADRP() const { return m_RelaxADRP; }
+
+  /// --small-data-by-refs: only the small common symbols accessed relative
+  /// to GP go into the small data, the most accessed first
+  void setSmallDataByRefs(bool pEnable = true) { m_SmallDataByRefs = pEnable; }
+
+  bool smallDataByRefs() const { return m_SmallDataByRefs; }
+
  private:
   llvm::Triple m_Triple;
   std::string m_ArchName;
@@ -87,8 +106,11 @@ class TargetOptions {
   unsigned int m_BitClass;
   unsigned m_GPSize;  // -G, --gpsize
   unsigned m_StubGroupSize;
+  unsigned m_StubReserve;
   bool m_FixCA53Erratum835769 : 1;
   bool m_FixCA53Erratum843419 : 1;
+  bool m_RelaxADRP : 1;
+  bool m_SmallDataByRefs : 1;
 };
 
 }  // namespace mcld
@@ -7,17 +7,47 @@
 //
 //===----------------------------------------------------------------------===//
 #include "mcld/Environment.h"
+#include "mcld/Support/TargetRegistry.h"
 #include "mcld/Support/TargetSelect.h"
 
+namespace {
+
+// The components of a target are registered when the target is first used,
+// so that a link only touches the code of the target it selects.
+#define MCLD_TARGET(TargetName)                           \
+  void Initialize##TargetName##Components() {             \
+    MCLDInitialize##TargetName##LDBackend();              \
+    MCLDInitialize##TargetName##Emulation();              \
+    MCLDInitialize##TargetName##DiagnosticLineInfo();     \
+  }
+#include "mcld/Config/Targets.def"  // NOLINT [build/include] [4]
+
+/// RegisterTargetInfo - register the targets of pInfoFn, and pComponentsFn to
+/// register their components lazily
+void RegisterTargetInfo(void (*pInfoFn)(),
+                        mcld::Target::InitializerFnTy pComponentsFn) {
+  size_t registered = mcld::TargetRegistry::size();
+  pInfoFn();
+
+  mcld::TargetRegistry::iterator target = mcld::TargetRegistry::begin();
+  for (size_t i = 0; i < registered; ++i)
+    ++target;
+  for (; target != mcld::TargetRegistry::end(); ++target)
+    mcld::TargetRegistry::RegisterInitializer(**target, pComponentsFn);
+}
+
+}  // anonymous namespace
+
 void mcld::Initialize() {
   static bool is_initialized = false;
 
   if (is_initialized)
     return;
 
-  mcld::InitializeAllTargets();
-  mcld::InitializeAllEmulations();
-  mcld::InitializeAllDiagnostics();
+#define MCLD_TARGET(TargetName)                               \
+  RegisterTargetInfo(MCLDInitialize##TargetName##LDTargetInfo, \
+                     Initialize##TargetName##Components);
+#include "mcld/Config/Targets.def"  // NOLINT [build/include] [4]
 
   is_initialized = true;
 }
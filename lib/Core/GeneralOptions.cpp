@@ -38,8 +38,12 @@ GeneralOptions::GeneralOptions()
       m_bRelro(false),
       m_bNow(false),
       m_bOrigin(false),
+      m_bPackRelativeRelocs(false),
+      m_bHugePageText(false),
+      m_bSeparateCode(false),
       m_bTrace(false),
       m_Bsymbolic(false),
+      m_BsymbolicFunctions(false),
       m_Bgroup(false),
       m_bPIE(false),
       m_bColor(true),
@@ -54,15 +58,39 @@ GeneralOptions::GeneralOptions()
       m_bFatalWarnings(false),
       m_bNewDTags(false),
       m_bNoStdlib(false),
+      m_bPrintMap(false),
       m_bWarnMismatch(true),
       m_bGCSections(false),
       m_bPrintGCSections(false),
+      m_bSplitTextForGC(false),
       m_bGenUnwindInfo(true),
       m_bPrintICFSections(false),
+      m_bPackAndroidRelocs(false),
+      m_bFsyncOutput(false),
+      m_bIncremental(false),
+      m_bTimeTrace(false),
+      m_bPrintStats(false),
+      m_bCallGraphProfileSort(true),
+      m_bSeparateWrittenData(false),
+      m_bLazyDSOSymbols(false),
+      m_bGdbIndex(false),
+      m_bSortRelocations(false),
+      m_bPrintMemoryUsage(false),
+      m_bVerifyDeterminism(false),
+      m_bPrelink(false),
       m_ICF(ICF::None),
       m_ICFIterations(2),
+      m_NumThreads(1),
+      m_TraceBufferSize(64 * 1024),
+      m_PrelinkBase(0x0),
       m_StripSymbols(StripSymbolMode::KeepAllSymbols),
-      m_HashStyle(HashStyle::SystemV) {
+      m_HashStyle(HashStyle::SystemV),
+      m_HashOptimize(HashOptimize::None),
+      m_HashOptimizeBudget(16),
+      m_BuildID(BuildID::None),
+      m_CompressDebugSections(CompressDebugSections::None),
+      m_OutputMode(OutputMode::MMap),
+      m_SortCommon(SortCommon::None) {
 }
 
 GeneralOptions::~GeneralOptions() {
@@ -135,6 +163,21 @@ void GeneralOptions::addZOption(const ZOption& pOption) {
     case ZOption::Origin:
       m_bOrigin = true;
       break;
+    case ZOption::PackRelativeRelocs:
+      m_bPackRelativeRelocs = true;
+      break;
+    case ZOption::NoPackRelativeRelocs:
+      m_bPackRelativeRelocs = false;
+      break;
+    case ZOption::HugePageText:
+      m_bHugePageText = true;
+      break;
+    case ZOption::SeparateCode:
+      m_bSeparateCode = true;
+      break;
+    case ZOption::NoSeparateCode:
+      m_bSeparateCode = false;
+      break;
     case ZOption::CommPageSize:
       m_CommPageSize = pOption.pageSize();
       break;
@@ -12,6 +12,7 @@
 #include "mcld/LinkerScript.h"
 #include "mcld/LD/DebugString.h"
 #include "mcld/LD/EhFrame.h"
+#include "mcld/LD/ELFDynObjIndex.h"
 #include "mcld/LD/ELFReader.h"
 #include "mcld/LD/LDContext.h"
 #include "mcld/LD/RelocData.h"
@@ -39,6 +40,10 @@ LDFileFormat::Kind GetELFSectionKind(uint32_t pType,
 
   // name rules
   llvm::StringRef name(pName);
+  // the split DWARF of -gsplit-dwarf=single is only for the debugger, even
+  // if the compiler did not mark it SHF_EXCLUDE
+  if (name.startswith(".debug") && name.endswith(".dwo"))
+    return LDFileFormat::Exclude;
   if (name.startswith(".debug") || name.startswith(".zdebug") ||
       name.startswith(".line") || name.startswith(".stab")) {
     if (name.startswith(".debug_str"))
@@ -109,7 +114,11 @@ LDFileFormat::Kind GetELFSectionKind(uint32_t pType,
 // IRBuilder
 //===----------------------------------------------------------------------===//
 IRBuilder::IRBuilder(Module& pModule, const LinkerConfig& pConfig)
-    : m_Module(pModule), m_Config(pConfig), m_InputBuilder(pConfig) {
+    : m_Module(pModule),
+      m_Config(pConfig),
+      m_InputBuilder(pConfig),
+      m_bAddingLazySymbols(false),
+      m_NumOfRenames(0) {
   m_InputBuilder.setCurrentTree(m_Module.getInputTree());
 
   // FIXME: where to set up Relocation?
@@ -117,6 +126,9 @@ IRBuilder::IRBuilder(Module& pModule, const LinkerConfig& pConfig)
 }
 
 IRBuilder::~IRBuilder() {
+  std::vector<ELFDynObjIndex*>::iterator index, end = m_LazyDynObjs.end();
+  for (index = m_LazyDynObjs.begin(); index != end; ++index)
+    delete *index;
 }
 
 /// CreateInput - To create an input file and append it to the input tree.
@@ -395,7 +407,35 @@ uint64_t IRBuilder::AppendEhFrame(EhFrame::CIE& pCIE, EhFrame& pEhFrame) {
 /// AddSymbol - To add a symbol in the input file and resolve the symbol
 /// immediately
 LDSymbol* IRBuilder::AddSymbol(Input& pInput,
-                               const std::string& pName,
+                               const llvm::StringRef& pName,
+                               ResolveInfo::Type pType,
+                               ResolveInfo::Desc pDesc,
+                               ResolveInfo::Binding pBind,
+                               ResolveInfo::SizeType pSize,
+                               LDSymbol::ValueType pValue,
+                               LDSection* pSection,
+                               ResolveInfo::Visibility pVis) {
+  // the local symbols never go into the name pool
+  uint32_t hash_value = 0;
+  if (ResolveInfo::Local != pBind)
+    hash_value = ResolveInfo::hasher()(pName);
+  return AddSymbol(pInput,
+                   pName,
+                   hash_value,
+                   pType,
+                   pDesc,
+                   pBind,
+                   pSize,
+                   pValue,
+                   pSection,
+                   pVis);
+}
+
+/// AddSymbol - To add a symbol whose hash value is known in the input file
+/// and resolve the symbol immediately
+LDSymbol* IRBuilder::AddSymbol(Input& pInput,
+                               const llvm::StringRef& pName,
+                               uint32_t pHashValue,
                                ResolveInfo::Type pType,
                                ResolveInfo::Desc pDesc,
                                ResolveInfo::Binding pBind,
@@ -404,16 +444,29 @@ LDSymbol* IRBuilder::AddSymbol(Input& pInput,
                                LDSection* pSection,
                                ResolveInfo::Visibility pVis) {
   // rename symbols
-  std::string name = pName;
-  if (!m_Module.getScript().renameMap().empty() &&
-      ResolveInfo::Undefined == pDesc) {
+  llvm::StringRef name = pName;
+  const LinkerScript::SymbolRenameMap& renames =
+      m_Module.getScript().renameMap();
+  if (!renames.empty() && ResolveInfo::Undefined == pDesc) {
     // If the renameMap is not empty, some symbols should be renamed.
-    // --wrap and --portable defines the symbol rename map.
-    const LinkerScript& script = m_Module.getScript();
-    LinkerScript::SymbolRenameMap::const_iterator renameSym =
-        script.renameMap().find(pName);
-    if (script.renameMap().end() != renameSym)
-      name = renameSym.getEntry()->value();
+    // --wrap and --portable defines the symbol rename map. The rename map
+    // is hashed differently, so its names are first probed by pHashValue.
+    if (m_NumOfRenames != renames.numOfEntries()) {
+      m_RenameHashes.clear();
+      LinkerScript::SymbolRenameMap::const_iterator entry,
+          entryEnd = renames.end();
+      for (entry = renames.begin(); entry != entryEnd; ++entry)
+        m_RenameHashes.insert(ResolveInfo::hasher()(entry.getEntry()->key()));
+      m_NumOfRenames = renames.numOfEntries();
+    }
+    if (m_RenameHashes.count(pHashValue) != 0) {
+      LinkerScript::SymbolRenameMap::const_iterator renameSym =
+          renames.find(pName);
+      if (renames.end() != renameSym) {
+        name = renameSym.getEntry()->value();
+        pHashValue = ResolveInfo::hasher()(name);
+      }
+    }
   }
 
   // Fix up the visibility if object has no export set.
@@ -423,6 +476,14 @@ LDSymbol* IRBuilder::AddSymbol(Input& pInput,
     }
   }
 
+  // the lazy shared objects read before define the name first
+  if (!m_LazyDynObjs.empty() && !m_bAddingLazySymbols &&
+      ResolveInfo::Local != pBind &&
+      m_Module.getNamePool().findInfo(name) == NULL) {
+    std::vector<std::string> names(1, name.str());
+    addLazySymbols(names);
+  }
+
   switch (pInput.type()) {
     case Input::Object: {
       FragmentRef* frag = NULL;
@@ -435,13 +496,13 @@ LDSymbol* IRBuilder::AddSymbol(Input& pInput,
         frag = FragmentRef::Create(*pSection, pValue);
 
       LDSymbol* input_sym = addSymbolFromObject(
-          name, pType, pDesc, pBind, pSize, pValue, frag, pVis);
+          name, pHashValue, pType, pDesc, pBind, pSize, pValue, frag, pVis);
       pInput.context()->addSymbol(input_sym);
       return input_sym;
     }
     case Input::DynObj: {
       return addSymbolFromDynObj(
-          pInput, name, pType, pDesc, pBind, pSize, pValue, pVis);
+          pInput, name, pHashValue, pType, pDesc, pBind, pSize, pValue, pVis);
     }
     default: {
       return NULL;
@@ -451,7 +512,8 @@ LDSymbol* IRBuilder::AddSymbol(Input& pInput,
   return NULL;
 }
 
-LDSymbol* IRBuilder::addSymbolFromObject(const std::string& pName,
+LDSymbol* IRBuilder::addSymbolFromObject(const llvm::StringRef& pName,
+                                         uint32_t pHashValue,
                                          ResolveInfo::Type pType,
                                          ResolveInfo::Desc pDesc,
                                          ResolveInfo::Binding pBinding,
@@ -477,6 +539,7 @@ LDSymbol* IRBuilder::addSymbolFromObject(const std::string& pName,
   } else {
     // if the symbol is not local, insert and resolve it immediately
     m_Module.getNamePool().insertSymbol(pName,
+                                        pHashValue,
                                         false,
                                         pType,
                                         pDesc,
@@ -526,7 +589,8 @@ LDSymbol* IRBuilder::addSymbolFromObject(const std::string& pName,
 }
 
 LDSymbol* IRBuilder::addSymbolFromDynObj(Input& pInput,
-                                         const std::string& pName,
+                                         const llvm::StringRef& pName,
+                                         uint32_t pHashValue,
                                          ResolveInfo::Type pType,
                                          ResolveInfo::Desc pDesc,
                                          ResolveInfo::Binding pBinding,
@@ -551,7 +615,9 @@ LDSymbol* IRBuilder::addSymbolFromDynObj(Input& pInput,
   // insert symbol and resolve it immediately
   // resolved_result is a triple <resolved_info, existent, override>
   Resolver::Result resolved_result;
+  ResolveInfo old_info;
   m_Module.getNamePool().insertSymbol(pName,
+                                      pHashValue,
                                       true,
                                       pType,
                                       pDesc,
@@ -559,14 +625,19 @@ LDSymbol* IRBuilder::addSymbolFromDynObj(Input& pInput,
                                       pSize,
                                       pValue,
                                       pVisibility,
-                                      NULL,
+                                      &old_info,
                                       resolved_result);
 
   // the return ResolveInfo should not NULL
   assert(resolved_result.info != NULL);
 
-  if (resolved_result.overriden || !resolved_result.existent)
-    pInput.setNeeded();
+  // The shared object is needed if it defines a symbol which has a non-weak
+  // reference. The references read later are checked by the name pool.
+  if (resolved_result.overriden && !resolved_result.info->isUndef()) {
+    m_Module.getNamePool().setDynDefiner(*resolved_result.info, pInput);
+    if (resolved_result.existent && old_info.isUndef() && !old_info.isWeak())
+      pInput.setNeeded();
+  }
 
   // create a LDSymbol for the input file.
   LDSymbol* input_sym = LDSymbol::Create(*resolved_result.info);
@@ -583,6 +654,37 @@ LDSymbol* IRBuilder::addSymbolFromDynObj(Input& pInput,
   return input_sym;
 }
 
+void IRBuilder::AddLazyDynObj(ELFDynObjIndex* pIndex) {
+  // the names are copied, as the aliases may grow the pool
+  std::vector<std::string> names;
+  NamePool& pool = m_Module.getNamePool();
+  NamePool::syminfo_iterator info, info_end = pool.syminfo_end();
+  for (info = pool.syminfo_begin(); info != info_end; ++info)
+    names.push_back(info.getEntry()->name());
+
+  m_LazyDynObjs.push_back(pIndex);
+  m_bAddingLazySymbols = true;
+  std::vector<std::string> aliases;
+  std::vector<std::string>::const_iterator name, end = names.end();
+  for (name = names.begin(); name != end; ++name)
+    pIndex->addSymbols(*name, *this, aliases);
+  addLazySymbols(aliases);
+}
+
+void IRBuilder::addLazySymbols(std::vector<std::string>& pNames) {
+  // The alias names are new to the pool, so every lazy shared object looks
+  // them up in turn, too.
+  m_bAddingLazySymbols = true;
+  while (!pNames.empty()) {
+    std::string name = pNames.back();
+    pNames.pop_back();
+    std::vector<ELFDynObjIndex*>::iterator index, end = m_LazyDynObjs.end();
+    for (index = m_LazyDynObjs.begin(); index != end; ++index)
+      (*index)->addSymbols(name, *this, pNames);
+  }
+  m_bAddingLazySymbols = false;
+}
+
 /// AddRelocation - add a relocation entry
 ///
 /// All symbols should be read and resolved before calling this function.
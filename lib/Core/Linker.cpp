@@ -11,23 +11,62 @@
 #include "mcld/IRBuilder.h"
 #include "mcld/LinkerConfig.h"
 #include "mcld/Module.h"
+#include "mcld/Config/Config.h"
+#include "mcld/Fragment/Fragment.h"
 #include "mcld/Fragment/FragmentRef.h"
 #include "mcld/Fragment/Relocation.h"
+#include "mcld/LD/DiagnosticLineInfo.h"
+#include "mcld/LD/DwpWriter.h"
+#include "mcld/LD/IncrementalLayout.h"
+#include "mcld/LD/InputCostReport.h"
+#include "mcld/LD/LDContext.h"
 #include "mcld/LD/LDSection.h"
 #include "mcld/LD/LDSymbol.h"
+#include "mcld/LD/LTOCodeGen.h"
+#include "mcld/LD/LinkDigest.h"
+#include "mcld/LD/MapWriter.h"
+#include "mcld/LD/MemoryReport.h"
 #include "mcld/LD/ObjectWriter.h"
 #include "mcld/LD/RelocData.h"
 #include "mcld/LD/SectionData.h"
+#include "mcld/LD/SizeReport.h"
 #include "mcld/MC/InputBuilder.h"
 #include "mcld/Object/ObjectLinker.h"
 #include "mcld/Support/FileHandle.h"
 #include "mcld/Support/FileOutputBuffer.h"
 #include "mcld/Support/MsgHandling.h"
+#include "mcld/Support/Statistic.h"
 #include "mcld/Support/TargetRegistry.h"
+#include "mcld/Support/TarWriter.h"
+#include "mcld/Support/ThreadPool.h"
+#include "mcld/Support/TimeTrace.h"
 #include "mcld/Support/raw_ostream.h"
 #include "mcld/Target/TargetLDBackend.h"
 
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#if defined(MCLD_ON_UNIX)
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 namespace mcld {
 
@@ -36,7 +75,16 @@ Linker::Linker()
       m_pIRBuilder(NULL),
       m_pTarget(NULL),
       m_pBackend(NULL),
-      m_pObjLinker(NULL) {
+      m_pObjLinker(NULL),
+      m_pTimeTrace(NULL),
+      m_pCostReport(NULL),
+      m_pIncremental(NULL),
+      m_pMapWriter(NULL),
+      m_pSizeReport(NULL),
+      m_pMemoryReport(NULL),
+      m_pDigest(NULL),
+      m_pBitcodeCompiler(NULL),
+      m_pLTOCodeGen(NULL) {
 }
 
 Linker::~Linker() {
@@ -73,14 +121,79 @@ bool Linker::link(Module& pModule, IRBuilder& pBuilder) {
   return layout();
 }
 
+/// getLayoutPath - the layout file of --incremental next to the output pPath
+static std::string getLayoutPath(const std::string& pPath) {
+  return pPath + ".layout";
+}
+
 /// normalize - to convert the command line language to the input tree.
 bool Linker::normalize(Module& pModule, IRBuilder& pBuilder) {
+  if (!initLink(pModule, pBuilder))
+    return false;
+  return readInputs(pModule);
+}
+
+/// initLink - steps 1 to 4.a of normalize, which read no input
+bool Linker::initLink(Module& pModule, IRBuilder& pBuilder) {
   assert(m_pConfig != NULL);
 
   m_pIRBuilder = &pBuilder;
 
   m_pObjLinker = new ObjectLinker(*m_pConfig, *m_pBackend);
 
+  // the trace messages are many and small, so they are written in blocks.
+  // A block size of zero keeps the streams as they are.
+  const GeneralOptions& options = m_pConfig->options();
+  if ((options.trace() || options.getPrintGCSections() ||
+       options.printICFSections()) && options.traceBufferSize() != 0) {
+    mcld::outs().SetBufferSize(options.traceBufferSize());
+    mcld::errs().SetBufferSize(options.traceBufferSize());
+  }
+
+  if (m_pConfig->options().hasTimeTrace() ||
+      m_pConfig->options().printStats() ||
+      m_pConfig->options().printMemoryUsage() ||
+      m_pConfig->options().verifyDeterminism()) {
+    m_pTimeTrace = new TimeTrace();
+    TimeTrace::SetCurrent(m_pTimeTrace);
+    m_pCostReport = new InputCostReport();
+    InputCostReport::SetCurrent(m_pCostReport);
+  }
+
+  // the structures are counted and the digests are taken as each phase ends
+  if (m_pConfig->options().printMemoryUsage()) {
+    m_pMemoryReport = new MemoryReport();
+    MemoryReport::SetCurrent(m_pMemoryReport);
+  }
+  if (m_pMemoryReport != NULL || m_pConfig->options().verifyDeterminism()) {
+    m_pTimeTrace->setPhaseHook([this, &pModule](llvm::StringRef pPhase) {
+      if (m_pMemoryReport != NULL) {
+        m_pObjLinker->addMemoryUsage(*m_pMemoryReport);
+        m_pMemoryReport->endSample(pPhase);
+      }
+      if (m_pDigest != NULL)
+        m_pDigest->addPhase(pPhase, pModule);
+    });
+  }
+
+  // a relocatable output is linked again, so it has no use for the slack
+  if (m_pConfig->options().incremental() &&
+      LinkerConfig::Object != m_pConfig->codeGenType()) {
+    m_pIncremental = new IncrementalLayout();
+    m_pIncremental->read(getLayoutPath(pModule.name()));
+    m_pObjLinker->setIncrementalLayout(m_pIncremental);
+  }
+
+  if (m_pConfig->options().printMap() || m_pConfig->options().hasMapFile()) {
+    m_pMapWriter = new MapWriter();
+    m_pObjLinker->setMapWriter(m_pMapWriter);
+  }
+
+  if (m_pConfig->options().hasSizeReport()) {
+    m_pSizeReport = new SizeReport();
+    m_pObjLinker->setSizeReport(m_pSizeReport);
+  }
+
   // 2. - initialize ObjectLinker
   if (!m_pObjLinker->initialize(pModule, pBuilder))
     return false;
@@ -97,20 +210,195 @@ bool Linker::normalize(Module& pModule, IRBuilder& pBuilder) {
   //   ensure that correspoding objects (e.g. in an archive) will be included
   m_pObjLinker->addUndefinedSymbols();
 
+  return true;
+}
+
+/// snapshot - the set-up of normalize, and the inputs given so far are read.
+bool Linker::snapshot(Module& pModule, IRBuilder& pBuilder) {
+  if (!initLink(pModule, pBuilder))
+    return false;
+
+  TimeTrace::Scope scope("normalize");
+  m_pObjLinker->normalize();
+  return Diagnose();
+}
+
+/// fork - the child shares the pages of the snapshot until it writes them,
+/// so every link only pays for the inputs it adds.
+bool Linker::fork(Module& pModule,
+                  const std::function<bool(IRBuilder&)>& pAddInputs,
+                  const std::string& pPath) {
+  assert(m_pObjLinker != NULL && m_pIRBuilder != NULL);
+#if defined(MCLD_ON_UNIX)
+  mcld::outs().flush();
+  mcld::errs().flush();
+  pid_t pid = ::fork();
+  if (pid < 0)
+    return false;
+
+  if (pid == 0) {
+    bool result = pAddInputs(*m_pIRBuilder) && readInputs(pModule) &&
+                  resolve(pModule) && layout() && emit(pModule, pPath);
+    if (m_OutputSync.valid())
+      m_OutputSync.wait();
+    mcld::outs().flush();
+    mcld::errs().flush();
+    // the static objects belong to the parent
+    ::_exit(result ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  int status;
+  while (::waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR)
+      return false;
+  }
+  return WIFEXITED(status) && EXIT_SUCCESS == WEXITSTATUS(status);
+#else
+  // without a copy-on-write child, the snapshot is linked in place once
+  return pAddInputs(*m_pIRBuilder) && readInputs(pModule) &&
+         resolve(pModule) && layout() && emit(pModule, pPath);
+#endif
+}
+
+/// verifyDeterminism - both links start from the state left by initLink, so
+/// they differ in nothing but their threads.
+bool Linker::verifyDeterminism(Module& pModule,
+                               IRBuilder& pBuilder,
+                               const std::string& pPath) {
+  if (!initLink(pModule, pBuilder))
+    return false;
+
+#if defined(MCLD_ON_UNIX)
+  // the serial link writes aside, and the output of the threaded one is kept
+  unsigned threads = m_pConfig->options().numThreads();
+  std::string serial_path = pPath + ".serial";
+  LinkDigest parallel, serial;
+  bool result = forkDigest(pModule, threads, pPath, parallel) &&
+                forkDigest(pModule, 1, serial_path, serial);
+  llvm::sys::fs::remove(serial_path);
+  if (!result)
+    return false;
+
+  // the phases are compared in order, so the first difference is reported
+  const LinkDigest::EntryList& lhs = parallel.entries();
+  const LinkDigest::EntryList& rhs = serial.entries();
+  size_t num = std::max(lhs.size(), rhs.size());
+  for (size_t i = 0; i < num; ++i) {
+    const char* part = NULL;
+    if (i >= lhs.size() || i >= rhs.size() || lhs[i].phase != rhs[i].phase)
+      part = "phases";
+    else if (lhs[i].symbols != rhs[i].symbols)
+      part = "symbols";
+    else if (lhs[i].sections != rhs[i].sections)
+      part = "sections";
+    else if (lhs[i].output != rhs[i].output)
+      part = "bytes";
+    if (part == NULL)
+      continue;
+
+    const std::string& phase = (i < lhs.size()) ? lhs[i].phase : rhs[i].phase;
+    error(diag::err_nondeterministic_link) << part << threads << phase;
+    return false;
+  }
+  return Diagnose();
+#else
+  // without a copy-on-write child, the link cannot be repeated
+  return readInputs(pModule) && resolve(pModule) && layout() &&
+         emit(pModule, pPath);
+#endif
+}
+
+/// forkDigest - the child writes its digests to a pipe as it exits
+bool Linker::forkDigest(Module& pModule,
+                        unsigned pThreads,
+                        const std::string& pPath,
+                        LinkDigest& pDigest) {
+#if defined(MCLD_ON_UNIX)
+  int fds[2];
+  if (::pipe(fds) != 0) {
+    error(diag::err_cannot_verify_determinism) << std::strerror(errno);
+    return false;
+  }
+
+  mcld::outs().flush();
+  mcld::errs().flush();
+  pid_t pid = ::fork();
+  if (pid < 0) {
+    error(diag::err_cannot_verify_determinism) << std::strerror(errno);
+    ::close(fds[0]);
+    ::close(fds[1]);
+    return false;
+  }
+
+  if (pid == 0) {
+    ::close(fds[0]);
+    m_pConfig->options().setNumThreads(pThreads);
+    LinkDigest digest;
+    m_pDigest = &digest;
+    bool result = readInputs(pModule) && resolve(pModule) && layout() &&
+                  emit(pModule, pPath);
+    if (m_OutputSync.valid())
+      m_OutputSync.wait();
+    {
+      mcld::raw_fd_ostream os(fds[1], /* pShouldClose */true);
+      if (result)
+        digest.write(os);
+    }
+    mcld::outs().flush();
+    mcld::errs().flush();
+    // the static objects belong to the parent
+    ::_exit(result ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  ::close(fds[1]);
+  std::string contents;
+  char buffer[4096];
+  while (true) {
+    ssize_t size = ::read(fds[0], buffer, sizeof(buffer));
+    if (size < 0 && errno == EINTR)
+      continue;
+    if (size <= 0)
+      break;
+    contents.append(buffer, size);
+  }
+  ::close(fds[0]);
+
+  int status;
+  while (::waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR)
+      return false;
+  }
+  return WIFEXITED(status) && EXIT_SUCCESS == WEXITSTATUS(status) &&
+         pDigest.read(contents);
+#else
+  return false;
+#endif
+}
+
+/// readInputs - read the inputs which are not read yet and check the result
+bool Linker::readInputs(Module& pModule) {
   // 4.b - normalize the input tree
   //   read out sections and symbol/string tables (from the files) and
   //   set them in Module. When reading out the symbol, resolve their symbols
   //   immediately and set their ResolveInfo (i.e., Symbol Resolution).
-  m_pObjLinker->normalize();
+  {
+    TimeTrace::Scope scope("normalize");
+    m_pObjLinker->normalize();
+  }
+
+  // 4.b' - compile the bitcode inputs, and read their objects as if they
+  //   followed the inputs on the command line
+  if (!compileBitcode(pModule))
+    return false;
 
   if (m_pConfig->options().trace()) {
     static int counter = 0;
     mcld::outs() << "** name\ttype\tpath\tsize ("
                  << pModule.getInputTree().size() << ")\n";
 
-    InputTree::const_dfs_iterator input,
-        inEnd = pModule.getInputTree().dfs_end();
-    for (input = pModule.getInputTree().dfs_begin(); input != inEnd; ++input) {
+    Module::InputList::const_iterator input,
+        inEnd = pModule.getInputList().end();
+    for (input = pModule.getInputList().begin(); input != inEnd; ++input) {
       mcld::outs() << counter++ << " *  " << (*input)->name();
       switch ((*input)->type()) {
         case Input::Archive:
@@ -136,6 +424,22 @@ bool Linker::normalize(Module& pModule, IRBuilder& pBuilder) {
     }
   }
 
+  // 4.c - capture the resolved inputs and scripts for --reproduce
+  if (m_pConfig->options().hasReproduce() && !writeReproduce(pModule))
+    return false;
+
+  // 4.d - make the symbols local which the version script hides, before
+  //   garbage collection takes the exported symbols as its roots, and find
+  //   the symbols which the dynamic list keeps preemptible
+  if (m_pConfig->options().hasVersionScript() &&
+      LinkerConfig::Object != m_pConfig->codeGenType() &&
+      !m_pObjLinker->applyVersionScript())
+    return false;
+  if (m_pConfig->options().hasDynamicList() &&
+      LinkerConfig::DynObj == m_pConfig->codeGenType() &&
+      !m_pObjLinker->applyDynamicList())
+    return false;
+
   // 5. - set up code position
   if (LinkerConfig::DynObj == m_pConfig->codeGenType() ||
       m_pConfig->options().isPIE()) {
@@ -162,6 +466,39 @@ bool Linker::normalize(Module& pModule, IRBuilder& pBuilder) {
   return true;
 }
 
+bool Linker::compileBitcode(Module& pModule) {
+  if (m_pBitcodeCompiler == NULL) {
+    Module::InputList::const_iterator input,
+        inEnd = pModule.getInputList().end();
+    for (input = pModule.getInputList().begin(); input != inEnd; ++input) {
+      if (Input::External == (*input)->type() &&
+          LTOCodeGen::isBitcode(**input))
+        warning(diag::warn_uncompiled_bitcode) << (*input)->path();
+    }
+    return true;
+  }
+
+  if (m_pLTOCodeGen == NULL) {
+    m_pLTOCodeGen = new LTOCodeGen(*m_pBitcodeCompiler,
+                                   m_pConfig->options().getLTOCacheDir());
+  }
+
+  size_t num_objects = m_pLTOCodeGen->numOfObjects();
+  {
+    TimeTrace::Scope scope("ltoCodeGen");
+    ThreadPool pool(m_pConfig->options().numThreads());
+    if (!m_pLTOCodeGen->run(pModule, *m_pIRBuilder, pool))
+      return Diagnose();
+  }
+
+  // the objects are read as the inputs given after the snapshot of fork()
+  if (m_pLTOCodeGen->numOfObjects() != num_objects) {
+    TimeTrace::Scope scope("normalize");
+    m_pObjLinker->normalize();
+  }
+  return true;
+}
+
 bool Linker::resolve(Module& pModule) {
   assert(m_pConfig != NULL);
   assert(m_pObjLinker != NULL);
@@ -172,7 +509,10 @@ bool Linker::resolve(Module& pModule) {
   //   initiate their reloc entries in SectOrRelocData of LDSection.
   //
   //   To collect all edges in the reference graph.
-  m_pObjLinker->readRelocations();
+  {
+    TimeTrace::Scope scope("readRelocations");
+    m_pObjLinker->readRelocations();
+  }
 
   // 7. - data stripping optimizations
   m_pObjLinker->dataStrippingOpt();
@@ -183,8 +523,11 @@ bool Linker::resolve(Module& pModule) {
   //   Maintain them as fragments in the section.
   //
   //   To merge nodes of the reference graph.
-  if (!m_pObjLinker->mergeSections())
-    return false;
+  {
+    TimeTrace::Scope scope("mergeSections");
+    if (!m_pObjLinker->mergeSections())
+      return false;
+  }
 
   // 9.a - add symbols to output
   //  After all input symbols have been resolved, add them to output symbol
@@ -210,41 +553,143 @@ bool Linker::layout() {
   // 11. - scan all relocation entries by output symbols.
   //   reserve GOT space for layout.
   //   the space info is needed by pre-layout to compute the section size
-  m_pObjLinker->scanRelocations();
+  {
+    TimeTrace::Scope scope("scanRelocations");
+    m_pObjLinker->scanRelocations();
+  }
 
   // 12.a - init relaxation stuff.
   m_pObjLinker->initStubs();
 
   // 12.b - pre-layout
-  m_pObjLinker->prelayout();
+  {
+    TimeTrace::Scope scope("prelayout");
+    m_pObjLinker->prelayout();
+  }
 
   // 12.c - linear layout
   //   Decide which sections will be left in. Sort the sections according to
   //   a given order. Then, create program header accordingly.
   //   Finally, set the offset for sections (@ref LDSection)
   //   according to the new order.
-  m_pObjLinker->layout();
+  {
+    TimeTrace::Scope scope("layout");
+    m_pObjLinker->layout();
+  }
 
   // 12.d - post-layout (create segment, instruction relaxing)
-  m_pObjLinker->postlayout();
+  {
+    TimeTrace::Scope scope("postlayout");
+    m_pObjLinker->postlayout();
+  }
 
   // 13. - finalize symbol value
   m_pObjLinker->finalizeSymbolValue();
 
   // 14. - apply relocations
-  m_pObjLinker->relocation();
+  {
+    TimeTrace::Scope scope("relocation");
+    m_pObjLinker->relocation();
+  }
+
+  // 14.b - compress the debug sections with the relocation results
+  //   The offsets of the non-ALLOC sections are final only after this step,
+  //   since they follow the code in the file and shrink when compressed. So
+  //   nothing is written before emit().
+  {
+    TimeTrace::Scope scope("compressDebugSections");
+    m_pObjLinker->compressDebugSections();
+  }
+
+  // 15. - write the link map
+  if (m_pMapWriter != NULL) {
+    TimeTrace::Scope scope("writeMap");
+    if (!writeMap(m_pIRBuilder->getModule()))
+      return false;
+  }
+
+  // 16. - write the bytes of each input
+  if (m_pSizeReport != NULL && !writeSizeReport())
+    return false;
+
+  // 17. - package the .dwo files of the split DWARF inputs
+  if (m_pConfig->options().hasDwp()) {
+    TimeTrace::Scope scope("writeDwp");
+    if (!writeDwp(m_pIRBuilder->getModule()))
+      return false;
+  }
 
   if (!Diagnose())
     return false;
   return true;
 }
 
+/// getOutputMode - how the output buffer writes the file
+static FileOutputBuffer::Mode getOutputMode(const LinkerConfig& pConfig) {
+  if (GeneralOptions::OutputMode::Stream == pConfig.options().getOutputMode())
+    return FileOutputBuffer::Stream;
+  return FileOutputBuffer::MMap;
+}
+
+/// commitOutput - finish writing pOutput to the file
+static bool commitOutput(FileOutputBuffer& pOutput) {
+  std::error_code ec = pOutput.commit();
+  if (ec) {
+    error(diag::err_cannot_write_output_file) << pOutput.getPath()
+                                              << ec.message();
+    return false;
+  }
+  return true;
+}
+
+/// isReplaceable - the output can be replaced by renaming a file over it.
+/// Special files, such as /dev/null, are written in place.
+static bool isReplaceable(const std::string& pPath) {
+  if (!llvm::sys::fs::exists(pPath))
+    return true;
+  bool regular = false;
+  return !llvm::sys::fs::is_regular_file(pPath, regular) && regular;
+}
+
+/// getTemporaryPath - a temporary file in the directory of pPath
+static std::string getTemporaryPath(const std::string& pPath) {
+  std::string path;
+  llvm::raw_string_ostream os(path);
+  os << pPath << ".tmp";
+  os.write_hex(llvm::sys::Process::GetRandomNumber());
+  return os.str();
+}
+
+/// syncOutput - flush the output file pPath to the disk
+static bool syncOutput(const std::string& pPath) {
+  FileHandle file;
+  if (!file.open(sys::fs::Path(pPath),
+                 FileHandle::OpenMode(FileHandle::ReadOnly),
+                 FileHandle::Permission(FileHandle::System)))
+    return false;
+  bool result = file.sync();
+  file.close();
+  return result;
+}
+
 bool Linker::emit(FileOutputBuffer& pOutput) {
   // 15. - write out output
-  m_pObjLinker->emitOutput(pOutput);
+  {
+    TimeTrace::Scope scope("emitOutput");
+    m_pObjLinker->emitOutput(pOutput);
+  }
 
   // 16. - post processing
-  m_pObjLinker->postProcessing(pOutput);
+  {
+    TimeTrace::Scope scope("postProcessing");
+    m_pObjLinker->postProcessing(pOutput);
+  }
+
+  if (m_pDigest != NULL) {
+    m_pDigest->addOutput(llvm::StringRef(
+        reinterpret_cast<const char*>(pOutput.getBufferStart()),
+        pOutput.getBufferSize()));
+  }
 
   if (!Diagnose())
     return false;
@@ -271,18 +716,68 @@ bool Linker::emit(const Module& pModule, const std::string& pPath) {
       assert(0 && "Unknown file type");
   }
 
-  bool result = file.open(sys::fs::Path(pPath), open_mode, permission);
-  if (!result) {
-    error(diag::err_cannot_open_output_file) << "Linker::emit()" << pPath;
+  size_t size = m_pObjLinker->getWriter()->getOutputSize(pModule);
+
+  // --incremental writes the changed blocks of the old output in place. An
+  // output which cannot be opened for writing, such as a running executable,
+  // is replaced as usual.
+  bool patch = false;
+  if (m_pIncremental != NULL && m_pIncremental->canPatch(pPath, size)) {
+    patch = file.open(sys::fs::Path(pPath),
+                      FileHandle::OpenMode(FileHandle::ReadWrite),
+                      permission);
+  }
+
+  // Write to a temporary file and rename it over the old output, so that the
+  // old output is neither truncated under the processes that still map it
+  // nor left half-written if the link fails.
+  bool replace = !patch && isReplaceable(pPath);
+  std::string path = replace ? getTemporaryPath(pPath) : pPath;
+
+  if (!patch && !file.open(sys::fs::Path(path), open_mode, permission)) {
+    error(diag::err_cannot_open_output_file) << "Linker::emit()" << path;
     return false;
   }
 
   std::unique_ptr<FileOutputBuffer> output;
-  FileOutputBuffer::create(
-      file, m_pObjLinker->getWriter()->getOutputSize(pModule), output);
-
-  result = emit(*output);
+  FileOutputBuffer::create(file,
+                           size,
+                           output,
+                           patch ? FileOutputBuffer::Patch
+                                 : getOutputMode(*m_pConfig));
+
+  bool result = emit(*output) && commitOutput(*output);
+  if (patch)
+    Statistic::Add("incremental.patched-bytes", output->getPatchedSize());
+  output.reset();
   file.close();
+
+  if (replace) {
+    if (result) {
+      std::error_code ec = llvm::sys::fs::rename(path, pPath);
+      if (ec) {
+        error(diag::err_cannot_write_output_file) << pPath << ec.message();
+        result = false;
+      }
+    }
+    if (!result)
+      llvm::sys::fs::remove(path);
+  }
+
+  // a stale layout would reserve the slack of an output that is not there
+  if (m_pIncremental != NULL) {
+    std::string layout = getLayoutPath(pPath);
+    if (!result || !m_pIncremental->write(layout, pModule, size)) {
+      if (result)
+        warning(diag::warn_cannot_write_incremental_layout) << layout;
+      llvm::sys::fs::remove(layout);
+    }
+  }
+  reportStats(pModule);
+
+  // the link is done, and the output is flushed off the critical path
+  if (result && m_pConfig->options().fsyncOutput())
+    m_OutputSync = std::async(std::launch::async, syncOutput, pPath);
   return result;
 }
 
@@ -291,13 +786,202 @@ bool Linker::emit(const Module& pModule, int pFileDescriptor) {
   file.delegate(pFileDescriptor);
 
   std::unique_ptr<FileOutputBuffer> output;
-  FileOutputBuffer::create(
-      file, m_pObjLinker->getWriter()->getOutputSize(pModule), output);
+  FileOutputBuffer::create(file,
+                           m_pObjLinker->getWriter()->getOutputSize(pModule),
+                           output,
+                           getOutputMode(*m_pConfig));
 
-  return emit(*output);
+  bool result = emit(*output) && commitOutput(*output);
+  reportStats(pModule);
+  return result;
+}
+
+bool Linker::emit(const Module& pModule, std::vector<uint8_t>& pOutput) {
+  pOutput.assign(m_pObjLinker->getWriter()->getOutputSize(pModule), 0x0);
+
+  std::unique_ptr<FileOutputBuffer> output;
+  FileOutputBuffer::create(pOutput.data(), pOutput.size(), output);
+
+  bool result = emit(*output) && commitOutput(*output);
+  reportStats(pModule);
+  return result;
+}
+
+/// writeReproduce - every input is stored at its absolute path under the base
+/// directory, which is where the response file of the driver refers to.
+bool Linker::writeReproduce(const Module& pModule) {
+  const std::string& file = m_pConfig->options().getReproduceFile();
+  std::string base = llvm::sys::path::stem(file).str();
+  std::unique_ptr<TarWriter> tar;
+  std::error_code ec = TarWriter::create(file, base, tar);
+  if (ec) {
+    error(diag::err_cannot_write_reproduce) << file << ec.message();
+    return false;
+  }
+
+  std::string response;
+  const std::vector<std::string>& args =
+      m_pConfig->options().getReproduceArgs();
+  for (size_t i = 0; i < args.size(); ++i)
+    response += args[i] + "\n";
+  tar->append("response.txt", response);
+  tar->append("version.txt",
+              std::string(m_pConfig->options().getVersionString()) + "\n");
+
+  std::vector<std::string> files;
+  Module::InputList::const_iterator input,
+      inEnd = pModule.getInputList().end();
+  for (input = pModule.getInputList().begin(); input != inEnd; ++input) {
+    if (!(*input)->path().empty())
+      files.push_back((*input)->path().native());
+  }
+  if (m_pConfig->options().hasSymbolOrderingFile())
+    files.push_back(m_pConfig->options().getSymbolOrderingFile());
+  if (!m_pConfig->options().getCallGraphOrderingFile().empty())
+    files.push_back(m_pConfig->options().getCallGraphOrderingFile());
+  if (m_pConfig->options().hasDataOrderingFile())
+    files.push_back(m_pConfig->options().getDataOrderingFile());
+  if (m_pConfig->options().hasVersionScript())
+    files.push_back(m_pConfig->options().getVersionScript());
+  if (m_pConfig->options().hasDynamicList())
+    files.push_back(m_pConfig->options().getDynamicList());
+
+  for (size_t i = 0; i < files.size(); ++i) {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer> > buffer =
+        llvm::MemoryBuffer::getFile(files[i]);
+    if (!buffer) {
+      error(diag::err_cannot_write_reproduce)
+          << file << files[i] + ": " + buffer.getError().message();
+      return false;
+    }
+    llvm::SmallString<256> path(files[i]);
+    llvm::sys::fs::make_absolute(path);
+    tar->append(llvm::sys::path::relative_path(path),
+                (*buffer)->getBuffer());
+  }
+
+  ec = tar->close();
+  if (ec) {
+    error(diag::err_cannot_write_reproduce) << file << ec.message();
+    return false;
+  }
+  return true;
+}
+
+/// reportStats - write the time trace and print the statistics of the link
+void Linker::reportStats(const Module& pModule) {
+  if (m_pTimeTrace == NULL)
+    return;
+
+  size_t relocations = 0;
+  Module::const_obj_iterator input, inEnd = pModule.obj_end();
+  for (input = pModule.obj_begin(); input != inEnd; ++input) {
+    const LDContext* context = (*input)->context();
+    LDContext::const_sect_iterator rs, rsEnd = context->relocSectEnd();
+    for (rs = context->relocSectBegin(); rs != rsEnd; ++rs) {
+      if ((*rs)->hasRelocData())
+        relocations += (*rs)->getRelocData()->size();
+    }
+  }
+
+  size_t fragments = 0;
+  Module::const_iterator sect, sectEnd = pModule.end();
+  for (sect = pModule.begin(); sect != sectEnd; ++sect) {
+    if ((*sect)->hasSectionData())
+      fragments += (*sect)->getSectionData()->size();
+  }
+
+  m_pTimeTrace->addCount("objects", pModule.getObjectList().size());
+  m_pTimeTrace->addCount("libraries", pModule.getLibraryList().size());
+  m_pTimeTrace->addCount("symbols", pModule.getSymbolTable().numOfSymbols());
+  m_pTimeTrace->addCount("relocations", relocations);
+  m_pTimeTrace->addCount("fragments", fragments);
+
+  // the inputs which cost the most are shown with the phases
+  const size_t num_of_costly_inputs = 10;
+  m_pCostReport->addModule(pModule);
+  m_pCostReport->addEvents(*m_pTimeTrace, num_of_costly_inputs);
+
+  if (m_pConfig->options().printStats()) {
+    m_pTimeTrace->printSummary(mcld::errs());
+    m_pCostReport->print(mcld::errs(), num_of_costly_inputs);
+    Statistic::PrintAll(mcld::errs());
+  }
+
+  if (m_pMemoryReport != NULL)
+    m_pMemoryReport->print(mcld::errs());
+
+  if (m_pConfig->options().hasTimeTrace()) {
+    std::string path = m_pConfig->options().getTimeTraceFile();
+    if (path.empty())
+      path = pModule.name() + ".time-trace.json";
+    std::error_code ec;
+    mcld::raw_fd_ostream os(path.c_str(), ec);
+    if (ec)
+      warning(diag::warn_cannot_write_time_trace) << path << ec.message();
+    else
+      m_pTimeTrace->printChromeTrace(os);
+  }
+}
+
+bool Linker::writeMap(const Module& pModule) {
+  if (m_pConfig->options().printMap())
+    m_pMapWriter->write(mcld::outs(), pModule);
+
+  if (!m_pConfig->options().hasMapFile())
+    return true;
+
+  const std::string& path = m_pConfig->options().getMapFile();
+  std::error_code ec;
+  mcld::raw_fd_ostream os(path.c_str(), ec);
+  if (!ec) {
+    m_pMapWriter->write(os, pModule);
+    os.close();
+    if (os.has_error()) {
+      ec = std::make_error_code(std::errc::io_error);
+      os.clear_error();
+    }
+  }
+  if (ec) {
+    error(diag::err_cannot_write_map_file) << path << ec.message();
+    return false;
+  }
+  return true;
+}
+
+bool Linker::writeSizeReport() {
+  const std::string& path = m_pConfig->options().getSizeReportFile();
+  std::error_code ec;
+  mcld::raw_fd_ostream os(path.c_str(), ec);
+  if (!ec) {
+    if (llvm::StringRef(path).endswith(".csv"))
+      m_pSizeReport->writeCSV(os);
+    else
+      m_pSizeReport->writeJSON(os);
+    os.close();
+    if (os.has_error()) {
+      ec = std::make_error_code(std::errc::io_error);
+      os.clear_error();
+    }
+  }
+  if (ec) {
+    error(diag::err_cannot_write_size_report) << path << ec.message();
+    return false;
+  }
+  return true;
+}
+
+bool Linker::writeDwp(Module& pModule) {
+  DwpWriter writer;
+  writer.addInputs(pModule);
+  ThreadPool pool(m_pConfig->options().numThreads());
+  return writer.write(m_pConfig->options().getDwpFile(), pool);
 }
 
 bool Linker::reset() {
+  if (m_OutputSync.valid())
+    m_OutputSync.wait();
+
   m_pConfig = NULL;
   m_pIRBuilder = NULL;
   m_pTarget = NULL;
@@ -314,6 +998,34 @@ bool Linker::reset() {
   delete m_pObjLinker;
   m_pObjLinker = NULL;
 
+  TimeTrace::SetCurrent(NULL);
+  delete m_pTimeTrace;
+  m_pTimeTrace = NULL;
+
+  InputCostReport::SetCurrent(NULL);
+  delete m_pCostReport;
+  m_pCostReport = NULL;
+
+  delete m_pIncremental;
+  m_pIncremental = NULL;
+
+  delete m_pMapWriter;
+  m_pMapWriter = NULL;
+
+  delete m_pSizeReport;
+  m_pSizeReport = NULL;
+
+  delete m_pMemoryReport;
+  m_pMemoryReport = NULL;
+
+  // the inputs read the compiled objects in place until the output is
+  // written
+  delete m_pLTOCodeGen;
+  m_pLTOCodeGen = NULL;
+
+  // All fragments are gone with their section data and the target backend.
+  Fragment::Clear();
+
   LDSection::Clear();
   LDSymbol::Clear();
   FragmentRef::Clear();
@@ -346,6 +1058,12 @@ bool Linker::initBackend() {
         << m_pConfig->targets().triple().str();
     return false;
   }
+
+  // the line info decodes nothing until a diagnostic asks for a line
+  DiagnosticLineInfo* line_info = m_pTarget->createDiagnosticLineInfo(
+      *m_pTarget, m_pConfig->targets().triple().str());
+  if (line_info != NULL)
+    getDiagnosticEngine().setLineInfo(*line_info);
   return true;
 }
 
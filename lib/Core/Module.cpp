@@ -24,33 +24,64 @@ static GCFactory<Module::AliasList, MCLD_SECTIONS_PER_INPUT>
 //===----------------------------------------------------------------------===//
 // Module
 //===----------------------------------------------------------------------===//
-Module::Module(LinkerScript& pScript) : m_Script(pScript), m_NamePool(1024) {
+Module::Module(LinkerScript& pScript)
+    : m_Script(pScript), m_NumOfIndexed(0), m_NamePool(1024) {
 }
 
 Module::Module(const std::string& pName, LinkerScript& pScript)
-    : m_Name(pName), m_Script(pScript), m_NamePool(1024) {
+    : m_Name(pName), m_Script(pScript), m_NumOfIndexed(0), m_NamePool(1024) {
 }
 
 Module::~Module() {
 }
 
-// Following two functions will be obsolette when we have new section merger.
-LDSection* Module::getSection(const std::string& pName) {
-  iterator sect, sectEnd = end();
-  for (sect = begin(); sect != sectEnd; ++sect) {
-    if ((*sect)->name() == pName)
-      return *sect;
-  }
-  return NULL;
+void Module::buildInputList() {
+  m_InputList.clear();
+  m_InputList.reserve(m_MainTree.size());
+  InputTree::dfs_iterator input, inEnd = m_MainTree.dfs_end();
+  for (input = m_MainTree.dfs_begin(); input != inEnd; ++input)
+    m_InputList.push_back(*input);
+}
+
+void Module::appendSection(LDSection& pSection) {
+  m_SectionTable.push_back(&pSection);
 }
 
-const LDSection* Module::getSection(const std::string& pName) const {
-  const_iterator sect, sectEnd = end();
-  for (sect = begin(); sect != sectEnd; ++sect) {
-    if ((*sect)->name() == pName)
-      return *sect;
+void Module::clearSections() {
+  m_SectionTable.clear();
+  m_SectionIndex.clear();
+  m_NumOfIndexed = 0;
+}
+
+LDSection* Module::getSection(const llvm::StringRef& pName) {
+  updateSectionIndex();
+  SectionIndex::const_iterator entry = m_SectionIndex.find(pName);
+  if (entry == m_SectionIndex.end())
+    return NULL;
+  return entry->getValue();
+}
+
+const LDSection* Module::getSection(const llvm::StringRef& pName) const {
+  updateSectionIndex();
+  SectionIndex::const_iterator entry = m_SectionIndex.find(pName);
+  if (entry == m_SectionIndex.end())
+    return NULL;
+  return entry->getValue();
+}
+
+void Module::updateSectionIndex() const {
+  // the section table may still be shrunk through getSectionTable(), start
+  // over if so.
+  if (m_NumOfIndexed > m_SectionTable.size()) {
+    m_SectionIndex.clear();
+    m_NumOfIndexed = 0;
+  }
+
+  size_t size = m_SectionTable.size();
+  for (; m_NumOfIndexed < size; ++m_NumOfIndexed) {
+    LDSection* sect = m_SectionTable[m_NumOfIndexed];
+    m_SectionIndex.insert(std::make_pair(sect->name(), sect));
   }
-  return NULL;
 }
 
 void Module::CreateAliasList(const ResolveInfo& pSym) {
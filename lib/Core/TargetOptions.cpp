@@ -18,7 +18,11 @@ TargetOptions::TargetOptions()
       m_BitClass(0),
       m_GPSize(8),
       m_StubGroupSize(0),
-      m_FixCA53Erratum835769(false) {
+      m_StubReserve(0),
+      m_FixCA53Erratum835769(false),
+      m_FixCA53Erratum843419(false),
+      m_RelaxADRP(false),
+      m_SmallDataByRefs(false) {
 }
 
 TargetOptions::TargetOptions(const std::string& pTriple)
@@ -27,7 +31,11 @@ TargetOptions::TargetOptions(const std::string& pTriple)
       m_BitClass(0),
       m_GPSize(8),
       m_StubGroupSize(0),
-      m_FixCA53Erratum835769(false) {
+      m_StubReserve(0),
+      m_FixCA53Erratum835769(false),
+      m_FixCA53Erratum843419(false),
+      m_RelaxADRP(false),
+      m_SmallDataByRefs(false) {
 }
 
 TargetOptions::~TargetOptions() {
@@ -8,21 +8,132 @@
 //===----------------------------------------------------------------------===//
 
 #include "mcld/Fragment/Fragment.h"
+#include "mcld/ADT/SizeTraits.h"
 #include "mcld/LD/SectionData.h"
+#include "mcld/Support/Allocators.h"
 
 #include <llvm/Support/DataTypes.h>
 
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
 namespace mcld {
 
+namespace {
+
+/** \class FragmentArena
+ *  \brief FragmentArena carves fragments out of large chunks.
+ *
+ *  A request is rounded up to a number of units, and each number of units is
+ *  a size class with its own free list. Requests beyond the largest class go
+ *  to the global heap. Chunks are only released when the arena is destroyed.
+ *
+ *  Every thread has an arena of its own, so the parallel readers create
+ *  fragments without a lock. A fragment freed by another thread goes to the
+ *  free list of that thread.
+ */
+class FragmentArena {
+ public:
+  FragmentArena() {
+    for (size_t i = 0; i < NumOfClasses; ++i)
+      m_FreeList[i] = NULL;
+  }
+
+  ~FragmentArena() { m_Allocator.clear(); }
+
+  static bool isPooled(size_t pSize) { return getUnits(pSize) < NumOfClasses; }
+
+  void* allocate(size_t pSize) {
+    size_t units = getUnits(pSize);
+    if (m_FreeList[units] == NULL)
+      return m_Allocator.allocate(units);
+
+    FreeBlock* block = m_FreeList[units];
+    m_FreeList[units] = block->next;
+    return block;
+  }
+
+  void deallocate(void* pPtr, size_t pSize) {
+    size_t units = getUnits(pSize);
+    FreeBlock* block = static_cast<FreeBlock*>(pPtr);
+    block->next = m_FreeList[units];
+    m_FreeList[units] = block;
+  }
+
+ private:
+  union Unit {
+    uint64_t integer;
+    double real;
+    void* pointer;
+  };
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  enum {
+    NumOfClasses = 33,
+    UnitsPerChunk = 8192
+  };
+
+  typedef LinearAllocator<Unit, UnitsPerChunk> Allocator;
+
+ private:
+  static size_t getUnits(size_t pSize) {
+    return (pSize + sizeof(Unit) - 1) / sizeof(Unit);
+  }
+
+ private:
+  Allocator m_Allocator;
+  FreeBlock* m_FreeList[NumOfClasses];
+};
+
+}  // anonymous namespace
+
+// The arenas are deliberately not a ManagedStatic. Fragments are destroyed by
+// the SectionData factory, and that must never happen after the storage of
+// the fragments has gone.
+//
+// g_Arenas owns the arenas of all threads. A thread adds its arena on its
+// first fragment, and the arenas are only destroyed together by Clear(). A
+// thread whose generation is not g_Generation has an arena from before the
+// last Clear(), which is gone.
+static std::mutex g_ArenaLock;
+static std::vector<FragmentArena*> g_Arenas;
+static std::atomic<unsigned int> g_Generation(0);
+static thread_local FragmentArena* t_pArena = NULL;
+static thread_local unsigned int t_Generation = 0;
+
+/// getArena - the arena of this thread. If pCreate is false and no thread
+/// has an arena, the storage of the fragments has gone, and return NULL.
+static FragmentArena* getArena(bool pCreate) {
+  if (t_pArena != NULL &&
+      t_Generation == g_Generation.load(std::memory_order_acquire))
+    return t_pArena;
+
+  std::lock_guard<std::mutex> guard(g_ArenaLock);
+  if (!pCreate && g_Arenas.empty())
+    return NULL;
+  t_pArena = new FragmentArena();
+  t_Generation = g_Generation.load(std::memory_order_relaxed);
+  g_Arenas.push_back(t_pArena);
+  return t_pArena;
+}
+
 //===----------------------------------------------------------------------===//
 // Fragment
 //===----------------------------------------------------------------------===//
 Fragment::Fragment()
-    : m_Kind(Type(~0)), m_pParent(NULL), m_Offset(~uint64_t(0)) {
+    : m_Kind(Type(~0)), m_Align(1), m_pParent(NULL), m_Offset(~uint64_t(0)) {
 }
 
 Fragment::Fragment(Type pKind, SectionData* pParent)
-    : m_Kind(pKind), m_pParent(pParent), m_Offset(~uint64_t(0)) {
+    : m_Kind(pKind),
+      m_Align(1),
+      m_pParent(pParent),
+      m_Offset(~uint64_t(0)) {
   if (m_pParent != NULL)
     m_pParent->getFragmentList().push_back(this);
 }
@@ -30,6 +141,38 @@ Fragment::Fragment(Type pKind, SectionData* pParent)
 Fragment::~Fragment() {
 }
 
+void* Fragment::operator new(size_t pSize) {
+  if (!FragmentArena::isPooled(pSize))
+    return ::operator new(pSize);
+
+  return getArena(true)->allocate(pSize);
+}
+
+void Fragment::operator delete(void* pPtr, size_t pSize) {
+  if (pPtr == NULL)
+    return;
+
+  if (!FragmentArena::isPooled(pSize)) {
+    ::operator delete(pPtr);
+    return;
+  }
+
+  // the storage has already gone with the arenas.
+  FragmentArena* arena = getArena(false);
+  if (arena == NULL)
+    return;
+  arena->deallocate(pPtr, pSize);
+}
+
+void Fragment::Clear() {
+  std::lock_guard<std::mutex> guard(g_ArenaLock);
+  std::vector<FragmentArena*>::iterator arena, aEnd = g_Arenas.end();
+  for (arena = g_Arenas.begin(); arena != aEnd; ++arena)
+    delete *arena;
+  g_Arenas.clear();
+  g_Generation.fetch_add(1, std::memory_order_release);
+}
+
 uint64_t Fragment::getOffset() const {
   assert(hasOffset() && "Cannot getOffset() before setting it up.");
   return m_Offset;
@@ -39,4 +182,10 @@ bool Fragment::hasOffset() const {
   return (m_Offset != ~uint64_t(0));
 }
 
+uint64_t Fragment::alignOffset(uint64_t pOffset) const {
+  if (m_Align > 1)
+    alignAddress(pOffset, m_Align);
+  return pOffset;
+}
+
 }  // namespace mcld
@@ -38,6 +38,7 @@ FragmentRef::FragmentRef() : m_pFragment(NULL), m_Offset(0) {
 
 FragmentRef::FragmentRef(Fragment& pFrag, FragmentRef::Offset pOffset)
     : m_pFragment(&pFrag), m_Offset(pOffset) {
+  assert(m_Offset == pOffset && "the offset does not fit in a FragmentRef");
 }
 
 /// Create - create a fragment reference for a given fragment.
@@ -112,6 +113,7 @@ FragmentRef& FragmentRef::assign(const FragmentRef& pCopy) {
 FragmentRef& FragmentRef::assign(Fragment& pFrag, FragmentRef::Offset pOffset) {
   m_pFragment = &pFrag;
   m_Offset = pOffset;
+  assert(m_Offset == pOffset && "the offset does not fit in a FragmentRef");
   return *this;
 }
 
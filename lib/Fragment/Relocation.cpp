@@ -14,7 +14,6 @@
 #include "mcld/LD/Relocator.h"
 #include "mcld/LD/ResolveInfo.h"
 #include "mcld/LD/SectionData.h"
-#include "mcld/Support/MsgHandling.h"
 
 #include <llvm/Support/ManagedStatic.h>
 
@@ -94,33 +93,7 @@ Relocation::Address Relocation::symValue() const {
 }
 
 void Relocation::apply(Relocator& pRelocator) {
-  Relocator::Result result = pRelocator.applyRelocation(*this);
-
-  switch (result) {
-    case Relocator::OK: {
-      // do nothing
-      return;
-    }
-    case Relocator::Overflow: {
-      error(diag::result_overflow) << pRelocator.getName(type())
-                                   << symInfo()->name();
-      return;
-    }
-    case Relocator::BadReloc: {
-      error(diag::result_badreloc) << pRelocator.getName(type())
-                                   << symInfo()->name();
-      return;
-    }
-    case Relocator::Unsupported: {
-      fatal(diag::unsupported_relocation) << type()
-                                          << "mclinker@googlegroups.com";
-      return;
-    }
-    case Relocator::Unknown: {
-      fatal(diag::unknown_relocation) << type() << symInfo()->name();
-      return;
-    }
-  }  // end of switch
+  pRelocator.issueApplyResult(pRelocator.applyRelocation(*this), *this);
 }
 
 void Relocation::setType(Type pType) {
@@ -163,10 +163,15 @@ size_t Archive::numOfSymbols() const {
   return m_SymTab.size();
 }
 
+/// reserveSymbols - make room for pNumOfSymbols symtab entries
+void Archive::reserveSymbols(size_t pNumOfSymbols) {
+  m_SymTab.reserve(pNumOfSymbols);
+}
+
 /// addSymbol - add a symtab entry to symtab
 /// @param pName - symbol name
 /// @param pFileOffset - file offset in symtab represents a object file
-void Archive::addSymbol(const char* pName,
+void Archive::addSymbol(const llvm::StringRef& pName,
                         uint32_t pFileOffset,
                         enum Archive::Symbol::Status pStatus) {
   Symbol* entry = m_SymbolFactory.allocate();
@@ -175,7 +180,7 @@ void Archive::addSymbol(const char* pName,
 }
 
 /// getSymbolName - get the symbol name with the given index
-const std::string& Archive::getSymbolName(size_t pSymIdx) const {
+llvm::StringRef Archive::getSymbolName(size_t pSymIdx) const {
   assert(pSymIdx < numOfSymbols());
   return m_SymTab[pSymIdx]->name;
 }
@@ -246,4 +251,9 @@ Input* Archive::getMemberFile(Input& pArchiveFile,
   return member;
 }
 
+void Archive::prefetchMemberFiles(const std::vector<sys::fs::Path>& pPaths,
+                                  ThreadPool& pPool) {
+  m_Builder.prefetchMemory(pPaths, pPool);
+}
+
 }  // namespace mcld
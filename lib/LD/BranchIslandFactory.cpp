@@ -9,12 +9,29 @@
 #include "mcld/LD/BranchIslandFactory.h"
 
 #include "mcld/Fragment/Fragment.h"
+#include "mcld/Fragment/FragmentRef.h"
+#include "mcld/Fragment/Relocation.h"
+#include "mcld/Fragment/Stub.h"
 #include "mcld/LD/LDSection.h"
 #include "mcld/LD/SectionData.h"
 #include "mcld/Module.h"
 
+#include <algorithm>
+
 namespace mcld {
 
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// isBeforeIsland - the order of an offset and the islands after it
+bool isBeforeIsland(uint64_t pOffset, const BranchIsland* pIsland) {
+  return pOffset < pIsland->offset();
+}
+
+}  // anonymous namespace
+
 //===----------------------------------------------------------------------===//
 // BranchIslandFactory
 //===----------------------------------------------------------------------===//
@@ -69,6 +86,7 @@ BranchIsland* BranchIslandFactory::produce(Fragment& pFragment) {
   new (island) BranchIsland(pFragment,        // entry fragment to the island
                             m_MaxIslandSize,  // the max size of the island
                             size() - 1u);     // index in the island factory
+  m_Islands[pFragment.getParent()].push_back(island);
   return island;
 }
 
@@ -78,27 +96,70 @@ std::pair<BranchIsland*, BranchIsland*> BranchIslandFactory::getIslands(
     const Fragment& pFragment) {
   BranchIsland* fwd = NULL;
   BranchIsland* bwd = NULL;
-  for (iterator it = begin(), ie = end(), prev = ie; it != ie;
-       prev = it, ++it) {
-    if (pFragment.getParent() != (*it).getParent()) {
-      continue;
-    }
+  llvm::DenseMap<const SectionData*, IslandList>::const_iterator islands =
+      m_Islands.find(pFragment.getParent());
+  if (islands == m_Islands.end())
+    return std::make_pair(fwd, bwd);
 
-    if ((pFragment.getOffset() < (*it).offset()) &&
-        ((pFragment.getOffset() + m_MaxFwdBranchRange) >= (*it).offset())) {
-      fwd = &*it;
+  // the first island after the fragment is the nearest forward one
+  const IslandList& list = islands->second;
+  IslandList::const_iterator it = std::upper_bound(
+      list.begin(), list.end(), pFragment.getOffset(), isBeforeIsland);
+  if ((it != list.end()) &&
+      ((pFragment.getOffset() + m_MaxFwdBranchRange) >= (*it)->offset())) {
+    fwd = *it;
 
-      if ((prev != ie) && (pFragment.getParent() == (*prev).getParent())) {
-        int64_t bwd_off = (int64_t)pFragment.getOffset() + m_MaxBwdBranchRange;
-        if ((pFragment.getOffset() > (*prev).offset()) &&
-            (bwd_off <= (int64_t)(*prev).offset())) {
-          bwd = &*prev;
-        }
+    if (it != list.begin()) {
+      BranchIsland* prev = *(it - 1);
+      int64_t bwd_off = (int64_t)pFragment.getOffset() + m_MaxBwdBranchRange;
+      if ((pFragment.getOffset() > prev->offset()) &&
+          (bwd_off <= (int64_t)prev->offset())) {
+        bwd = prev;
       }
-      break;
     }
   }
   return std::make_pair(fwd, bwd);
 }
 
+Stub* BranchIslandFactory::findStub(const Stub* pPrototype,
+                                    const Relocation& pReloc) const {
+  const Fragment& frag = *pReloc.targetRef().frag();
+  llvm::DenseMap<const SectionData*, IslandList>::const_iterator islands =
+      m_Islands.find(frag.getParent());
+  if (islands == m_Islands.end())
+    return NULL;
+
+  const IslandList& list = islands->second;
+  const int64_t place = pReloc.targetRef().getOutputOffset();
+  IslandList::const_iterator next = std::upper_bound(
+      list.begin(), list.end(), frag.getOffset(), isBeforeIsland);
+
+  // the islands after the branch, the nearest first
+  for (IslandList::const_iterator it = next; it != list.end(); ++it) {
+    if ((int64_t)(*it)->offset() - place > m_MaxFwdBranchRange)
+      break;
+    Stub* stub = (*it)->findStub(pPrototype, pReloc);
+    if ((stub != NULL) && isReachable(place, *stub))
+      return stub;
+  }
+
+  // the islands before the branch, the nearest first
+  for (IslandList::const_iterator it = next; it != list.begin();) {
+    --it;
+    if ((int64_t)((*it)->offset() + (*it)->size()) - place <
+        m_MaxBwdBranchRange)
+      break;
+    Stub* stub = (*it)->findStub(pPrototype, pReloc);
+    if ((stub != NULL) && isReachable(place, *stub))
+      return stub;
+  }
+  return NULL;
+}
+
+bool BranchIslandFactory::isReachable(int64_t pPlace, const Stub& pStub) const {
+  int64_t distance = (int64_t)pStub.getOffset() - pPlace;
+  return (distance <= m_MaxFwdBranchRange) &&
+         (distance >= m_MaxBwdBranchRange);
+}
+
 }  // namespace mcld
@@ -0,0 +1,155 @@
+//===- BuildIDNote.cpp ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/BuildIDNote.h"
+
+#include "mcld/GeneralOptions.h"
+#include "mcld/LinkerConfig.h"
+#include "mcld/ADT/SizeTraits.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/Support/FileOutputBuffer.h"
+#include "mcld/Support/ThreadPool.h"
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/xxhash.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace mcld {
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// the size of the note header and the name "GNU\0"
+const size_t kHeaderSize = 16;
+
+/// the size of the chunks hashed in parallel
+const size_t kChunkSize = 1 << 20;
+
+/// the size of a SHA1 digest
+const size_t kSHA1Size = 20;
+
+/// hashFast - the xxHash64 of pData in little endian
+void hashFast(const uint8_t* pData, size_t pSize, uint8_t* pDigest) {
+  uint64_t hash = llvm::xxHash64(
+      llvm::StringRef(reinterpret_cast<const char*>(pData), pSize));
+  for (size_t i = 0; i < 8; ++i)
+    pDigest[i] = static_cast<uint8_t>(hash >> (i * 8));
+}
+
+/// hashSHA1 - the SHA1 digest of pData
+void hashSHA1(const uint8_t* pData, size_t pSize, uint8_t* pDigest) {
+  llvm::SHA1 sha1;
+  sha1.update(llvm::ArrayRef<uint8_t>(pData, pSize));
+  std::memcpy(pDigest, sha1.final().data(), kSHA1Size);
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// BuildIDNote
+//===----------------------------------------------------------------------===//
+BuildIDNote::BuildIDNote(LDSection& pSection, const LinkerConfig& pConfig)
+    : m_Section(pSection), m_Config(pConfig) {
+}
+
+BuildIDNote::~BuildIDNote() {
+}
+
+size_t BuildIDNote::getDescSize() const {
+  switch (m_Config.options().getBuildID()) {
+    case GeneralOptions::BuildID::Fast:
+      return 8;
+    case GeneralOptions::BuildID::SHA1:
+      return kSHA1Size;
+    case GeneralOptions::BuildID::UUID:
+      return 16;
+    default:
+      assert(false && "no build ID is requested");
+      return 0;
+  }
+}
+
+/// sizeOutput - base on the style of the build ID to size output
+void BuildIDNote::sizeOutput() {
+  m_Section.setSize(kHeaderSize + getDescSize());
+}
+
+/// emitOutput - write out the note
+void BuildIDNote::emitOutput(FileOutputBuffer& pOutput, ThreadPool& pPool) {
+  size_t desc_size = getDescSize();
+  MemoryRegion region = pOutput.request(m_Section.offset(), m_Section.size());
+  uint8_t* data = region.begin();
+  write32(data, 4);
+  write32(data + 4, desc_size);
+  write32(data + 8, llvm::ELF::NT_GNU_BUILD_ID);
+  std::memcpy(data + 12, "GNU", 4);
+
+  uint8_t* desc = data + kHeaderSize;
+  std::memset(desc, 0x0, desc_size);
+  if (GeneralOptions::BuildID::UUID == m_Config.options().getBuildID()) {
+    computeUUID(desc);
+    return;
+  }
+
+  // compute into a temporary, so that the hashed build ID stays zero
+  std::vector<uint8_t> id(desc_size);
+  computeHash(pOutput.getBufferStart(), pOutput.getBufferSize(), id.data(),
+              pPool);
+  std::memcpy(desc, id.data(), desc_size);
+}
+
+/// computeHash - hash the chunks in parallel, then hash their digests. The
+/// build ID only depends on the content, not on the number of threads.
+void BuildIDNote::computeHash(const uint8_t* pData,
+                              size_t pSize,
+                              uint8_t* pDesc,
+                              ThreadPool& pPool) const {
+  void (*hash)(const uint8_t*, size_t, uint8_t*) = hashSHA1;
+  if (GeneralOptions::BuildID::Fast == m_Config.options().getBuildID())
+    hash = hashFast;
+  size_t digest_size = getDescSize();
+
+  size_t num_chunks = (pSize + kChunkSize - 1) / kChunkSize;
+  std::vector<uint8_t> digests(num_chunks * digest_size);
+  parallelFor(pPool, 0, num_chunks, [&](size_t pChunk) {
+    size_t begin = pChunk * kChunkSize;
+    size_t size = std::min(kChunkSize, pSize - begin);
+    hash(pData + begin, size, &digests[pChunk * digest_size]);
+  });
+  hash(digests.data(), digests.size(), pDesc);
+}
+
+/// computeUUID - a random (version 4) UUID
+void BuildIDNote::computeUUID(uint8_t* pDesc) const {
+  std::random_device device;
+  for (size_t i = 0; i < 16; i += 4) {
+    uint32_t value = device();
+    std::memcpy(pDesc + i, &value, 4);
+  }
+  pDesc[6] = (pDesc[6] & 0x0f) | 0x40;
+  pDesc[8] = (pDesc[8] & 0x3f) | 0x80;
+}
+
+void BuildIDNote::write32(uint8_t* pPlace, uint32_t pValue) const {
+  if (llvm::sys::IsLittleEndianHost != m_Config.targets().isLittleEndian())
+    pValue = bswap32(pValue);
+  std::memcpy(pPlace, &pValue, 4);
+}
+
+}  // namespace mcld
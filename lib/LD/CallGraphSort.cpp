@@ -0,0 +1,163 @@
+//===- CallGraphSort.cpp --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/CallGraphSort.h"
+
+#include "mcld/LD/LDSection.h"
+
+#include <algorithm>
+
+namespace mcld {
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// kMaxDensityDegradation - a merged cluster may be this many times sparser
+/// than the cluster it is merged into
+const unsigned kMaxDensityDegradation = 8;
+
+/// kMaxClusterSize - a cluster beyond a megabyte gains nothing from being
+/// contiguous
+const uint64_t kMaxClusterSize = 1024 * 1024;
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// CallGraphSort
+//===----------------------------------------------------------------------===//
+double CallGraphSort::Cluster::density() const {
+  if (size == 0)
+    return 0.0;
+  return static_cast<double>(weight) / static_cast<double>(size);
+}
+
+CallGraphSort::CallGraphSort() {
+}
+
+CallGraphSort::~CallGraphSort() {
+}
+
+int CallGraphSort::getNode(const LDSection& pSection) {
+  std::pair<llvm::DenseMap<const LDSection*, int>::iterator, bool> node =
+      m_Nodes.insert(std::make_pair(&pSection, m_Sections.size()));
+  if (node.second) {
+    int index = m_Sections.size();
+    Cluster cluster = {index, index, pSection.size(), 0, 0, -1, 0};
+    m_Sections.push_back(&pSection);
+    m_Clusters.push_back(cluster);
+  }
+  return node.first->second;
+}
+
+void CallGraphSort::addEdge(const LDSection& pFrom,
+                            const LDSection& pTo,
+                            uint64_t pWeight) {
+  int from = getNode(pFrom);
+  int to = getNode(pTo);
+  Cluster& cluster = m_Clusters[to];
+  cluster.weight += pWeight;
+  if (from == to)
+    return;
+
+  // the heaviest edge into a section comes from its likeliest predecessor
+  if (cluster.best_pred == -1 || cluster.best_pred_weight < pWeight) {
+    cluster.best_pred = from;
+    cluster.best_pred_weight = pWeight;
+  }
+}
+
+int CallGraphSort::getLeader(int pIndex) {
+  // path halving
+  while (m_Leaders[pIndex] != pIndex) {
+    m_Leaders[pIndex] = m_Leaders[m_Leaders[pIndex]];
+    pIndex = m_Leaders[pIndex];
+  }
+  return pIndex;
+}
+
+void CallGraphSort::mergeClusters(int pInto, int pFrom) {
+  Cluster& into = m_Clusters[pInto];
+  Cluster& from = m_Clusters[pFrom];
+  int tail1 = into.prev;
+  int tail2 = from.prev;
+
+  into.prev = tail2;
+  m_Clusters[tail2].next = pInto;
+  from.prev = tail1;
+  m_Clusters[tail1].next = pFrom;
+
+  into.size += from.size;
+  into.weight += from.weight;
+  from.size = 0;
+  from.weight = 0;
+}
+
+void CallGraphSort::sort(std::vector<const LDSection*>& pOrder) {
+  size_t size = m_Clusters.size();
+  std::vector<int> sorted(size);
+  auto denser = [this](int pX, int pY) {
+    return m_Clusters[pX].density() > m_Clusters[pY].density();
+  };
+  m_Leaders.resize(size);
+  for (size_t i = 0; i < size; ++i) {
+    sorted[i] = i;
+    m_Leaders[i] = i;
+    m_Clusters[i].initial_weight = m_Clusters[i].weight;
+  }
+  std::stable_sort(sorted.begin(), sorted.end(), denser);
+
+  for (size_t i = 0; i < size; ++i) {
+    // a cluster not merged yet is led by its own section
+    int leader = sorted[i];
+    const Cluster& cluster = m_Clusters[leader];
+
+    // a caller of a tenth of the calls or less is not likely enough
+    if (cluster.best_pred == -1 ||
+        cluster.best_pred_weight * 10 <= cluster.initial_weight)
+      continue;
+
+    int pred = getLeader(cluster.best_pred);
+    if (pred == leader)
+      continue;
+
+    const Cluster& pred_cluster = m_Clusters[pred];
+    if (cluster.size + pred_cluster.size > kMaxClusterSize)
+      continue;
+
+    double density =
+        static_cast<double>(pred_cluster.weight + cluster.weight) /
+        static_cast<double>(pred_cluster.size + cluster.size);
+    if (density < pred_cluster.density() / kMaxDensityDegradation)
+      continue;
+
+    m_Leaders[leader] = pred;
+    mergeClusters(pred, leader);
+  }
+
+  // only the clusters which were not merged into another are left
+  sorted.clear();
+  for (size_t i = 0; i < size; ++i) {
+    if (m_Leaders[i] == static_cast<int>(i))
+      sorted.push_back(i);
+  }
+  std::stable_sort(sorted.begin(), sorted.end(), denser);
+
+  pOrder.reserve(pOrder.size() + size);
+  std::vector<int>::const_iterator leader, end = sorted.end();
+  for (leader = sorted.begin(); leader != end; ++leader) {
+    int index = *leader;
+    do {
+      pOrder.push_back(m_Sections[index]);
+      index = m_Clusters[index].next;
+    } while (index != *leader);
+  }
+}
+
+}  // namespace mcld
@@ -0,0 +1,173 @@
+//===- CompressedSection.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/CompressedSection.h"
+
+#include "mcld/LinkerConfig.h"
+#include "mcld/ADT/SizeTraits.h"
+#include "mcld/Fragment/RegionFragment.h"
+#include "mcld/LD/LDFileFormat.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/LD/SectionData.h"
+#include "mcld/Support/ELF.h"
+#include "mcld/Support/ThreadPool.h"
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/Host.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace mcld {
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// the size of the chunks deflated in parallel
+const size_t kChunkSize = 1 << 20;
+
+/// the zlib header of a deflate stream with a 32K window
+const uint8_t kZlibHeader[] = {0x78, 0x01};
+
+/// deflateChunk - deflate pSize bytes of pData into pOut as a part of a raw
+/// deflate stream. Only the last chunk finishes the stream.
+void deflateChunk(const uint8_t* pData,
+                  size_t pSize,
+                  bool pIsLast,
+                  std::vector<uint8_t>& pOut) {
+  z_stream stream;
+  std::memset(&stream, 0x0, sizeof(stream));
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK)
+    llvm::report_fatal_error("cannot initialize zlib");
+
+  // a full flush adds an empty stored block to the bound of deflate
+  pOut.resize(deflateBound(&stream, pSize) + 16);
+  stream.next_in = const_cast<Bytef*>(pData);
+  stream.avail_in = pSize;
+  stream.next_out = pOut.data();
+  stream.avail_out = pOut.size();
+  int result = deflate(&stream, pIsLast ? Z_FINISH : Z_FULL_FLUSH);
+  bool done = pIsLast ? (result == Z_STREAM_END)
+                      : ((result == Z_OK) && (stream.avail_out != 0));
+  if (!done || (stream.avail_in != 0))
+    llvm::report_fatal_error("cannot compress a debug section");
+  pOut.resize(stream.total_out);
+  deflateEnd(&stream);
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// CompressedSection
+//===----------------------------------------------------------------------===//
+CompressedSection::CompressedSection(LDSection& pSection,
+                                     const LinkerConfig& pConfig)
+    : m_Section(pSection), m_Config(pConfig), m_UncompressedSize(0) {
+}
+
+CompressedSection::~CompressedSection() {
+}
+
+void CompressedSection::compress(llvm::ArrayRef<uint8_t> pContent,
+                                 ThreadPool& pPool) {
+  assert(!pContent.empty() && "compress an empty section");
+  m_UncompressedSize = pContent.size();
+
+  size_t num_chunks = (pContent.size() + kChunkSize - 1) / kChunkSize;
+  std::vector<std::vector<uint8_t> > chunks(num_chunks);
+  std::vector<uLong> checksums(num_chunks);
+  parallelFor(pPool, 0, num_chunks, [&](size_t pChunk) {
+    size_t begin = pChunk * kChunkSize;
+    size_t size = std::min(kChunkSize, pContent.size() - begin);
+    deflateChunk(pContent.data() + begin, size, (pChunk + 1 == num_chunks),
+                 chunks[pChunk]);
+    checksums[pChunk] = adler32(adler32(0L, Z_NULL, 0),
+                                pContent.data() + begin, size);
+  });
+
+  // ElfXX_Chdr, the zlib header, the deflate stream and the adler32
+  size_t size = getHeaderSize() + sizeof(kZlibHeader) + 4;
+  for (size_t i = 0; i < num_chunks; ++i)
+    size += chunks[i].size();
+  m_Data.resize(size);
+
+  writeHeader(m_Data.data(), m_Section.align());
+  uint8_t* out = m_Data.data() + getHeaderSize();
+  std::memcpy(out, kZlibHeader, sizeof(kZlibHeader));
+  out += sizeof(kZlibHeader);
+
+  uLong checksum = checksums[0];
+  for (size_t i = 0; i < num_chunks; ++i) {
+    std::memcpy(out, chunks[i].data(), chunks[i].size());
+    out += chunks[i].size();
+    if (i != 0) {
+      size_t chunk_size =
+          std::min(kChunkSize, pContent.size() - i * kChunkSize);
+      checksum = adler32_combine(checksum, checksums[i], chunk_size);
+    }
+  }
+  for (size_t i = 0; i < 4; ++i)
+    out[i] = static_cast<uint8_t>(checksum >> (24 - i * 8));
+
+  // The fragments of the uncompressed content are still referred by the
+  // relocations and the symbols, so they are left in the old section data.
+  SectionData* sd = SectionData::Create(m_Section);
+  m_Section.setSectionData(sd);
+  Fragment* frag = new RegionFragment(
+      llvm::StringRef(reinterpret_cast<const char*>(m_Data.data()),
+                      m_Data.size()),
+      sd);
+  frag->setOffset(0x0);
+
+  m_Section.setKind(LDFileFormat::Debug);
+  m_Section.setFlag(m_Section.flag() | ELF::SHF_COMPRESSED);
+  m_Section.setAlign(m_Config.targets().bitclass() / 8);
+  m_Section.setSize(m_Data.size());
+}
+
+size_t CompressedSection::getHeaderSize() const {
+  return m_Config.targets().is32Bits() ? 12 : 24;
+}
+
+/// writeHeader - Elf32_Chdr is {ch_type, ch_size, ch_addralign}, and
+/// Elf64_Chdr is {ch_type, ch_reserved, ch_size, ch_addralign}
+void CompressedSection::writeHeader(uint8_t* pPlace, uint64_t pAlign) const {
+  bool swap =
+      (llvm::sys::IsLittleEndianHost != m_Config.targets().isLittleEndian());
+  uint32_t type = ELF::ELFCOMPRESS_ZLIB;
+  if (swap)
+    type = bswap32(type);
+  std::memset(pPlace, 0x0, getHeaderSize());
+  std::memcpy(pPlace, &type, 4);
+
+  if (m_Config.targets().is32Bits()) {
+    uint32_t fields[2] = {static_cast<uint32_t>(m_UncompressedSize),
+                          static_cast<uint32_t>(pAlign)};
+    for (size_t i = 0; i < 2; ++i) {
+      if (swap)
+        fields[i] = bswap32(fields[i]);
+    }
+    std::memcpy(pPlace + 4, fields, sizeof(fields));
+  } else {
+    uint64_t fields[2] = {m_UncompressedSize, pAlign};
+    for (size_t i = 0; i < 2; ++i) {
+      if (swap)
+        fields[i] = bswap64(fields[i]);
+    }
+    std::memcpy(pPlace + 8, fields, sizeof(fields));
+  }
+}
+
+}  // namespace mcld
@@ -8,9 +8,611 @@
 //===----------------------------------------------------------------------===//
 #include "mcld/LD/DWARFLineInfo.h"
 
+#include "mcld/LD/LDContext.h"
+#include "mcld/LD/LDFileFormat.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/MC/Input.h"
+#include "mcld/Support/ELF.h"
+#include "mcld/Support/MemoryArea.h"
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Dwarf.h>
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/Endian.h>
+
+#include <algorithm>
+
 namespace mcld {
 
-//==========================
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+const uint32_t kNoSection = ~0U;
+
+const uint32_t kNoFile = ~0U;
+
+/// the line number content types and the forms of DWARF 5
+const uint64_t kLNCTPath = 0x1;
+const uint64_t kLNCTDirectoryIndex = 0x2;
+const uint64_t kFormStrx = 0x1a;
+const uint64_t kFormData16 = 0x1e;
+const uint64_t kFormLineStrp = 0x1f;
+const uint64_t kFormStrx1 = 0x25;
+const uint64_t kFormStrx2 = 0x26;
+const uint64_t kFormStrx3 = 0x27;
+const uint64_t kFormStrx4 = 0x28;
+
+/// Cursor - read the little endian fields of a section. A read beyond the
+/// end fails the cursor and returns zero.
+class Cursor {
+ public:
+  Cursor(llvm::StringRef pData, uint64_t pPos)
+      : m_Data(pData), m_Pos(pPos), m_bOK(pPos <= pData.size()) {}
+
+  bool ok() const { return m_bOK; }
+
+  uint64_t pos() const { return m_Pos; }
+
+  bool atEnd() const { return !m_bOK || m_Pos >= m_Data.size(); }
+
+  void seek(uint64_t pPos) {
+    if (pPos > m_Data.size())
+      m_bOK = false;
+    else
+      m_Pos = pPos;
+  }
+
+  void skip(uint64_t pSize) {
+    if (take(pSize))
+      m_Pos += pSize;
+  }
+
+  /// readU - read an unsigned field of 1, 2, 4 or 8 bytes
+  uint64_t readU(unsigned int pSize) {
+    if (!take(pSize))
+      return 0;
+    const char* place = m_Data.data() + m_Pos;
+    m_Pos += pSize;
+    switch (pSize) {
+      case 1:
+        return static_cast<uint8_t>(*place);
+      case 2:
+        return llvm::support::endian::read16le(place);
+      case 4:
+        return llvm::support::endian::read32le(place);
+      case 8:
+        return llvm::support::endian::read64le(place);
+      default:
+        return 0;
+    }
+  }
+
+  uint64_t readULEB() {
+    uint64_t value = 0;
+    unsigned int shift = 0;
+    while (take(1)) {
+      uint8_t byte = m_Data[m_Pos++];
+      if (shift < 64)
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      shift += 7;
+      if ((byte & 0x80) == 0)
+        return value;
+    }
+    return 0;
+  }
+
+  int64_t readSLEB() {
+    uint64_t value = 0;
+    unsigned int shift = 0;
+    while (take(1)) {
+      uint8_t byte = m_Data[m_Pos++];
+      if (shift < 64)
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      shift += 7;
+      if ((byte & 0x80) == 0) {
+        if (shift < 64 && (byte & 0x40) != 0)
+          value |= ~static_cast<uint64_t>(0) << shift;
+        return static_cast<int64_t>(value);
+      }
+    }
+    return 0;
+  }
+
+  llvm::StringRef readCStr() {
+    if (!m_bOK)
+      return llvm::StringRef();
+    size_t end = m_Data.find('\0', m_Pos);
+    if (end == llvm::StringRef::npos) {
+      m_bOK = false;
+      return llvm::StringRef();
+    }
+    llvm::StringRef str = m_Data.slice(m_Pos, end);
+    m_Pos = end + 1;
+    return str;
+  }
+
+ private:
+  bool take(uint64_t pSize) {
+    if (m_bOK && pSize > m_Data.size() - m_Pos)
+      m_bOK = false;
+    return m_bOK;
+  }
+
+ private:
+  llvm::StringRef m_Data;
+  uint64_t m_Pos;
+  bool m_bOK;
+};
+
+/// RelocTarget - the section and the value of the symbol of a relocation
+/// plus its addend. The addend of a REL is the relocated field itself.
+struct RelocTarget {
+  uint32_t section;
+  uint64_t value;
+  bool addField;
+};
+
+typedef std::map<uint64_t, RelocTarget> RelocMap;
+
+/// getContent - the content of pSection in the file of pInput, or nothing if
+/// it is not stored as it is
+llvm::StringRef getContent(Input& pInput, const LDSection* pSection) {
+  if (pSection == NULL || pSection->size() == 0 ||
+      pSection->type() == llvm::ELF::SHT_NOBITS ||
+      (pSection->flag() & ELF::SHF_COMPRESSED) != 0 ||
+      pInput.memArea() == NULL)
+    return llvm::StringRef();
+  return pInput.memArea()->request(pInput.fileOffset() + pSection->offset(),
+                                   pSection->size());
+}
+
+/// readRelocations - read the relocations of pTarget from the file of pInput
+void readRelocations(Input& pInput,
+                     const LDSection& pTarget,
+                     RelocMap& pRelocs) {
+  LDContext& context = *pInput.context();
+  const LDSection* symtab_sect = context.getSection(".symtab");
+  llvm::StringRef symtab = getContent(pInput, symtab_sect);
+  if (symtab.empty())
+    return;
+  bool is64 = (symtab_sect->entSize() == sizeof(llvm::ELF::Elf64_Sym));
+  size_t sym_size =
+      is64 ? sizeof(llvm::ELF::Elf64_Sym) : sizeof(llvm::ELF::Elf32_Sym);
+
+  LDContext::sect_iterator it, itEnd = context.relocSectEnd();
+  for (it = context.relocSectBegin(); it != itEnd; ++it) {
+    if ((*it)->getLink() != &pTarget)
+      continue;
+    bool is_rela = ((*it)->type() == llvm::ELF::SHT_RELA);
+    unsigned int word = is64 ? 8 : 4;
+    Cursor relocs(getContent(pInput, *it), 0);
+    while (!relocs.atEnd()) {
+      uint64_t offset = relocs.readU(word);
+      uint64_t info = relocs.readU(word);
+      int64_t addend = 0;
+      if (is_rela)
+        addend = static_cast<int64_t>(relocs.readU(word));
+      if (!relocs.ok())
+        break;
+      if (!is64 && is_rela)
+        addend = static_cast<int32_t>(addend);
+
+      uint64_t sym = is64 ? (info >> 32) : (info >> 8);
+      Cursor entry(symtab, sym * sym_size);
+      uint64_t value, shndx;
+      if (is64) {
+        entry.skip(6);
+        shndx = entry.readU(2);
+        value = entry.readU(8);
+      } else {
+        entry.skip(4);
+        value = entry.readU(4);
+        entry.skip(6);
+        shndx = entry.readU(2);
+      }
+      if (!entry.ok() || shndx == llvm::ELF::SHN_UNDEF ||
+          shndx >= llvm::ELF::SHN_LORESERVE)
+        continue;
+
+      RelocTarget target = {static_cast<uint32_t>(shndx),
+                            value + static_cast<uint64_t>(addend),
+                            !is_rela};
+      pRelocs[offset] = target;
+    }
+  }
+}
+
+/// LineDecoder - decode the line programs of .debug_line into a table
+class LineDecoder {
+ public:
+  LineDecoder(Input& pInput,
+              llvm::StringRef pData,
+              const RelocMap& pRelocs,
+              DWARFLineInfo::Table& pTable)
+      : m_Input(pInput), m_Data(pData), m_Relocs(pRelocs), m_Table(pTable) {}
+
+  void decode() {
+    uint64_t pos = 0;
+    while (pos + 4 <= m_Data.size()) {
+      Cursor cursor(m_Data, pos);
+      uint64_t length = cursor.readU(4);
+      bool is64 = false;
+      if (length == 0xffffffff) {
+        length = cursor.readU(8);
+        is64 = true;
+      } else if (length >= 0xfffffff0) {
+        return;
+      }
+      if (!cursor.ok() || length > m_Data.size() - cursor.pos())
+        return;
+      uint64_t end = cursor.pos() + length;
+      decodeUnit(cursor.pos(), end, is64);
+      pos = end;
+    }
+  }
+
+ private:
+  /// resolve - read the field of pSize bytes at pCursor, and the section
+  /// and the offset which it refers to after relocation
+  uint64_t resolve(Cursor& pCursor, unsigned int pSize, uint32_t& pSection) {
+    uint64_t pos = pCursor.pos();
+    uint64_t field = pCursor.readU(pSize);
+    RelocMap::const_iterator it = m_Relocs.find(pos);
+    if (it == m_Relocs.end()) {
+      pSection = kNoSection;
+      return field;
+    }
+    pSection = it->second.section;
+    return it->second.value + (it->second.addField ? field : 0);
+  }
+
+  /// readString - the string in the string section pDefault at the offset
+  /// in the field
+  llvm::StringRef readString(Cursor& pCursor,
+                             bool pIs64,
+                             const char* pDefault) {
+    uint32_t section;
+    uint64_t offset = resolve(pCursor, pIs64 ? 8 : 4, section);
+    const LDSection* str_sect = (section == kNoSection)
+                                    ? m_Input.context()->getSection(pDefault)
+                                    : m_Input.context()->getSection(section);
+    llvm::StringRef strtab = getContent(m_Input, str_sect);
+    Cursor str(strtab, offset);
+    llvm::StringRef result = str.readCStr();
+    return str.ok() ? result : llvm::StringRef();
+  }
+
+  /// readForm - read a value of pForm. Return false for an unknown form.
+  bool readForm(Cursor& pCursor,
+                uint64_t pForm,
+                bool pIs64,
+                llvm::StringRef& pString,
+                uint64_t& pValue) {
+    switch (pForm) {
+      case llvm::dwarf::DW_FORM_string:
+        pString = pCursor.readCStr();
+        return true;
+      case llvm::dwarf::DW_FORM_strp:
+        pString = readString(pCursor, pIs64, ".debug_str");
+        return true;
+      case kFormLineStrp:
+        pString = readString(pCursor, pIs64, ".debug_line_str");
+        return true;
+      case llvm::dwarf::DW_FORM_data1:
+      case kFormStrx1:
+        pValue = pCursor.readU(1);
+        return true;
+      case llvm::dwarf::DW_FORM_data2:
+      case kFormStrx2:
+        pValue = pCursor.readU(2);
+        return true;
+      case kFormStrx3:
+        pCursor.skip(3);
+        return true;
+      case llvm::dwarf::DW_FORM_data4:
+      case kFormStrx4:
+        pValue = pCursor.readU(4);
+        return true;
+      case llvm::dwarf::DW_FORM_data8:
+        pValue = pCursor.readU(8);
+        return true;
+      case kFormData16:
+        pCursor.skip(16);
+        return true;
+      case llvm::dwarf::DW_FORM_udata:
+      case kFormStrx:
+        pValue = pCursor.readULEB();
+        return true;
+      case llvm::dwarf::DW_FORM_sdata:
+        pValue = static_cast<uint64_t>(pCursor.readSLEB());
+        return true;
+      case llvm::dwarf::DW_FORM_block:
+        pCursor.skip(pCursor.readULEB());
+        return true;
+      case llvm::dwarf::DW_FORM_block1:
+        pCursor.skip(pCursor.readU(1));
+        return true;
+      case llvm::dwarf::DW_FORM_block2:
+        pCursor.skip(pCursor.readU(2));
+        return true;
+      case llvm::dwarf::DW_FORM_block4:
+        pCursor.skip(pCursor.readU(4));
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /// readEntries - read the directories or the files of a DWARF 5 header.
+  /// The directory index of a directory is ignored.
+  bool readEntries(Cursor& pCursor,
+                   bool pIs64,
+                   std::vector<llvm::StringRef>& pPaths,
+                   std::vector<uint64_t>& pDirs) {
+    uint64_t num_formats = pCursor.readU(1);
+    std::vector<std::pair<uint64_t, uint64_t> > formats;
+    for (uint64_t i = 0; i < num_formats && pCursor.ok(); ++i) {
+      uint64_t type = pCursor.readULEB();
+      uint64_t form = pCursor.readULEB();
+      formats.push_back(std::make_pair(type, form));
+    }
+    uint64_t count = pCursor.readULEB();
+    for (uint64_t i = 0; i < count && pCursor.ok(); ++i) {
+      llvm::StringRef path;
+      uint64_t dir = 0;
+      for (size_t j = 0; j < formats.size(); ++j) {
+        llvm::StringRef string;
+        uint64_t value = 0;
+        if (!readForm(pCursor, formats[j].second, pIs64, string, value))
+          return false;
+        if (formats[j].first == kLNCTPath)
+          path = string;
+        else if (formats[j].first == kLNCTDirectoryIndex)
+          dir = value;
+      }
+      pPaths.push_back(path);
+      pDirs.push_back(dir);
+    }
+    return pCursor.ok();
+  }
+
+  /// addFile - add the file pName in the pDir-th directory to the table
+  uint32_t addFile(llvm::StringRef pName,
+                   uint64_t pDir,
+                   const std::vector<llvm::StringRef>& pDirNames) {
+    std::string file;
+    if (!pName.startswith("/") && pDir < pDirNames.size() &&
+        !pDirNames[pDir].empty()) {
+      file = pDirNames[pDir].str();
+      file += '/';
+    }
+    file += pName.str();
+    m_Table.files.push_back(file);
+    return m_Table.files.size() - 1;
+  }
+
+  void addRow(uint32_t pSection,
+              uint64_t pOffset,
+              uint32_t pFile,
+              uint32_t pLine) {
+    if (pSection == kNoSection)
+      return;
+    DWARFLineInfo::Row row = {pSection, pOffset, pFile, pLine};
+    m_Table.rows.push_back(row);
+  }
+
+  /// decodeUnit - decode the line program whose header starts at pPos, after
+  /// the unit length, and which ends at pEnd
+  void decodeUnit(uint64_t pPos, uint64_t pEnd, bool pIs64) {
+    Cursor cursor(m_Data.substr(0, pEnd), pPos);
+    uint64_t version = cursor.readU(2);
+    if (version < 2 || version > 5)
+      return;
+    if (version >= 5)
+      cursor.skip(2);  // address_size and segment_selector_size
+    uint64_t header_length = cursor.readU(pIs64 ? 8 : 4);
+    uint64_t program = cursor.pos() + header_length;
+    uint64_t min_inst_length = cursor.readU(1);
+    if (version >= 4)
+      cursor.skip(1);  // maximum_operations_per_instruction
+    cursor.skip(1);  // default_is_stmt
+    int64_t line_base = static_cast<int8_t>(cursor.readU(1));
+    uint64_t line_range = cursor.readU(1);
+    uint64_t opcode_base = cursor.readU(1);
+    std::vector<uint64_t> opcode_lengths(opcode_base, 0);
+    for (uint64_t i = 1; i < opcode_base; ++i)
+      opcode_lengths[i] = cursor.readU(1);
+
+    // the files of the unit and their indices in the table. The directory
+    // and the file 0 of DWARF 4 are the compilation directory and the
+    // primary source file, which only the unit DIE knows.
+    std::vector<llvm::StringRef> dir_names;
+    std::vector<uint32_t> files;
+    if (version >= 5) {
+      std::vector<uint64_t> unused;
+      std::vector<llvm::StringRef> names;
+      std::vector<uint64_t> dirs;
+      if (!readEntries(cursor, pIs64, dir_names, unused) ||
+          !readEntries(cursor, pIs64, names, dirs))
+        return;
+      for (size_t i = 0; i < names.size(); ++i)
+        files.push_back(addFile(names[i], dirs[i], dir_names));
+    } else {
+      dir_names.push_back(llvm::StringRef());
+      while (cursor.ok()) {
+        llvm::StringRef dir = cursor.readCStr();
+        if (dir.empty())
+          break;
+        dir_names.push_back(dir);
+      }
+      files.push_back(kNoFile);
+      while (cursor.ok()) {
+        llvm::StringRef name = cursor.readCStr();
+        if (name.empty())
+          break;
+        uint64_t dir = cursor.readULEB();
+        cursor.readULEB();  // modification time
+        cursor.readULEB();  // length
+        files.push_back(addFile(name, dir, dir_names));
+      }
+    }
+    if (!cursor.ok() || line_range == 0)
+      return;
+
+    // run the state machine. The operation index of VLIW is not tracked.
+    cursor.seek(program);
+    uint32_t section = kNoSection;
+    uint64_t address = 0;
+    uint64_t file = 1;
+    int64_t line = 1;
+    while (!cursor.atEnd()) {
+      uint64_t opcode = cursor.readU(1);
+      if (opcode >= opcode_base) {
+        uint64_t adjusted = opcode - opcode_base;
+        address += (adjusted / line_range) * min_inst_length;
+        line += line_base + static_cast<int64_t>(adjusted % line_range);
+        uint32_t index = (file < files.size()) ? files[file] : kNoFile;
+        addRow(section, address, index, line);
+        continue;
+      }
+      switch (opcode) {
+        case 0: {
+          uint64_t length = cursor.readULEB();
+          uint64_t next = cursor.pos() + length;
+          if (length == 0 || next > pEnd)
+            return;
+          uint64_t sub_opcode = cursor.readU(1);
+          if (sub_opcode == llvm::dwarf::DW_LNE_end_sequence) {
+            addRow(section, address, kNoFile, 0);
+            section = kNoSection;
+            address = 0;
+            file = 1;
+            line = 1;
+          } else if (sub_opcode == llvm::dwarf::DW_LNE_set_address &&
+                     (length == 5 || length == 9)) {
+            address = resolve(cursor, length - 1, section);
+          } else if (sub_opcode == llvm::dwarf::DW_LNE_define_file) {
+            llvm::StringRef name = cursor.readCStr();
+            uint64_t dir = cursor.readULEB();
+            files.push_back(addFile(name, dir, dir_names));
+          }
+          cursor.seek(next);
+          break;
+        }
+        case llvm::dwarf::DW_LNS_copy: {
+          uint32_t index = (file < files.size()) ? files[file] : kNoFile;
+          addRow(section, address, index, line);
+          break;
+        }
+        case llvm::dwarf::DW_LNS_advance_pc:
+          address += cursor.readULEB() * min_inst_length;
+          break;
+        case llvm::dwarf::DW_LNS_advance_line:
+          line += cursor.readSLEB();
+          break;
+        case llvm::dwarf::DW_LNS_set_file:
+          file = cursor.readULEB();
+          break;
+        case llvm::dwarf::DW_LNS_const_add_pc:
+          address += ((255 - opcode_base) / line_range) * min_inst_length;
+          break;
+        case llvm::dwarf::DW_LNS_fixed_advance_pc:
+          address += cursor.readU(2);
+          break;
+        default:
+          // the other standard opcodes take only ULEB128 operands
+          for (uint64_t i = 0; i < opcode_lengths[opcode]; ++i)
+            cursor.readULEB();
+          break;
+      }
+    }
+  }
+
+ private:
+  Input& m_Input;
+  llvm::StringRef m_Data;
+  const RelocMap& m_Relocs;
+  DWARFLineInfo::Table& m_Table;
+};
+
+bool isBefore(const DWARFLineInfo::Row& pX, const DWARFLineInfo::Row& pY) {
+  if (pX.section != pY.section)
+    return pX.section < pY.section;
+  return pX.offset < pY.offset;
+}
+
+/// isRowBefore - order the rows by their code. At the same offset, the ends
+/// of sequences come first, and the rows keep the order of the programs.
+bool isRowBefore(const DWARFLineInfo::Row& pX, const DWARFLineInfo::Row& pY) {
+  if (isBefore(pX, pY))
+    return true;
+  if (isBefore(pY, pX))
+    return false;
+  return pX.line == 0 && pY.line != 0;
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
 // DWARFLineInfo
+//===----------------------------------------------------------------------===//
+DWARFLineInfo::DWARFLineInfo() {
+}
+
+DWARFLineInfo::~DWARFLineInfo() {
+  TableMap::iterator it, itEnd = m_Tables.end();
+  for (it = m_Tables.begin(); it != itEnd; ++it)
+    delete it->second;
+}
+
+bool DWARFLineInfo::getLine(Input& pInput,
+                            const LDSection& pSection,
+                            uint64_t pOffset,
+                            std::string& pFile,
+                            unsigned int& pLine) {
+  // the diagnostics of the inputs may be issued in parallel
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  const Table& table = getTable(pInput);
+
+  Row key = {static_cast<uint32_t>(pSection.index()), pOffset, kNoFile, 0};
+  std::vector<Row>::const_iterator row =
+      std::upper_bound(table.rows.begin(), table.rows.end(), key, isBefore);
+  if (row == table.rows.begin())
+    return false;
+  --row;
+  if (row->section != key.section || row->line == 0 ||
+      row->file >= table.files.size())
+    return false;
+
+  pFile = table.files[row->file];
+  pLine = row->line;
+  return true;
+}
+
+const DWARFLineInfo::Table& DWARFLineInfo::getTable(Input& pInput) {
+  TableMap::iterator entry = m_Tables.find(&pInput);
+  if (entry != m_Tables.end())
+    return *entry->second;
+
+  Table* table = new Table();
+  m_Tables[&pInput] = table;
+
+  LDContext* context = pInput.context();
+  if (context == NULL)
+    return *table;
+  const LDSection* debug_line = context->getSection(".debug_line");
+  llvm::StringRef data = getContent(pInput, debug_line);
+  if (data.empty())
+    return *table;
+
+  RelocMap relocs;
+  readRelocations(pInput, *debug_line, relocs);
+  LineDecoder decoder(pInput, data, relocs, *table);
+  decoder.decode();
+  std::stable_sort(table->rows.begin(), table->rows.end(), isRowBefore);
+  return *table;
+}
 
 }  // namespace mcld
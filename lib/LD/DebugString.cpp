@@ -44,22 +44,18 @@ void DebugString::merge(LDSection& pSection) {
   for (it = pSection.getSectionData()->begin(); it != end; ++it) {
     if ((*it).getKind() == Fragment::Region) {
       RegionFragment* frag = llvm::cast<RegionFragment>(&(*it));
-      strings = frag->getRegion().data();
+      strings = frag->getRegion();
     }
   }
 
-  // get the debug strings and add them into merged string table
-  const char* str = strings.data();
-  const char* str_end = str + pSection.size();
-  while (str < str_end) {
-    size_t len = string_length(str);
-    m_StringTable.insertString(llvm::StringRef(str, len));
-    str = str + len + 1;
-  }
+  // the debug strings are split and added into merged string table when the
+  // offsets are computed, so that all inputs are processed in parallel
+  if (strings.data() != NULL)
+    m_StringTable.addStrings(llvm::StringRef(strings.data(), pSection.size()));
 }
 
-size_t DebugString::computeOffsetSize() {
-  size_t size = m_StringTable.finalizeOffset();
+size_t DebugString::computeOffsetSize(ThreadPool& pPool) {
+  size_t size = m_StringTable.finalizeOffset(pPool);
   m_pSection->setSize(size);
   return size;
 }
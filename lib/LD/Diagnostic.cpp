@@ -170,6 +170,12 @@ void Diagnostic::format(const char* pBegin,
           pOutStr.append("false");
         break;
       }
+      case DiagnosticEngine::ak_symbol: {
+        llvm::StringRef name =
+            m_Engine.getDemangledName(*getArgSymbol(arg_no));
+        pOutStr.append(name.data(), name.size());
+        break;
+      }
     }  // end of switch
   }    // end of while
 }
@@ -12,11 +12,42 @@
 #include "mcld/LD/DiagnosticLineInfo.h"
 #include "mcld/LD/DiagnosticPrinter.h"
 #include "mcld/LD/MsgHandler.h"
+#include "mcld/LD/ResolveInfo.h"
+#include "mcld/Support/Demangle.h"
 
 #include <cassert>
+#include <mutex>
 
 namespace mcld {
 
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// getFatalLock - the lock which keeps a fatal diagnostic of a worker from
+/// interleaving with another one
+std::mutex& getFatalLock() {
+  static std::mutex lock;
+  return lock;
+}
+
+}  // anonymous namespace
+
+thread_local DiagnosticEngine::Buffer* DiagnosticEngine::s_pBuffer = NULL;
+
+//===----------------------------------------------------------------------===//
+// DiagnosticEngine::BufferScope
+//===----------------------------------------------------------------------===//
+DiagnosticEngine::BufferScope::BufferScope(Buffer& pBuffer)
+    : m_pPrevBuffer(s_pBuffer) {
+  s_pBuffer = &pBuffer;
+}
+
+DiagnosticEngine::BufferScope::~BufferScope() {
+  s_pBuffer = m_pPrevBuffer;
+}
+
 //===----------------------------------------------------------------------===//
 // DiagnosticEngine
 //===----------------------------------------------------------------------===//
@@ -34,7 +65,6 @@ DiagnosticEngine::~DiagnosticEngine() {
 
   delete m_pInfoMap;
 
-  // FIXME: design the destructive relation of LineInfo.
   delete m_pLineInfo;
 }
 
@@ -43,9 +73,14 @@ void DiagnosticEngine::reset(const LinkerConfig& pConfig) {
   delete m_pInfoMap;
   m_pInfoMap = new DiagnosticInfos(*m_pConfig);
   m_State.reset();
+  m_Reported.clear();
+  m_NumReports.clear();
+  m_DemangledNames.clear();
 }
 
 void DiagnosticEngine::setLineInfo(DiagnosticLineInfo& pLineInfo) {
+  if (m_pLineInfo != &pLineInfo)
+    delete m_pLineInfo;
   m_pLineInfo = &pLineInfo;
 }
 
@@ -60,18 +95,104 @@ void DiagnosticEngine::setPrinter(DiagnosticPrinter& pPrinter,
 // emit - process current diagnostic.
 bool DiagnosticEngine::emit() {
   assert(m_pInfoMap != NULL);
+  if (s_pBuffer != NULL) {
+    Buffer& buffer = *s_pBuffer;
+    if (!m_pInfoMap->isFatal(buffer.m_Current.ID)) {
+      buffer.m_Diagnostics.push_back(buffer.m_Current);
+      buffer.m_Current.reset();
+      return true;
+    }
+
+    // the link stops here, so the buffered diagnostics are of no use
+    std::lock_guard<std::mutex> guard(getFatalLock());
+    s_pBuffer = NULL;
+    m_State = buffer.m_Current;
+    buffer.m_Current.reset();
+  }
+
+  uint16_t id = m_State.ID;
   bool emitted = m_pInfoMap->process(*this);
   m_State.reset();
+
+  // say once that the rest of a noisy diagnostic is not shown
+  if (emitted && id < m_NumReports.size() &&
+      m_NumReports[id] == MaxReportsPerID) {
+    report(diag::warn_diagnostics_suppressed, Warning)
+        << static_cast<unsigned int>(MaxReportsPerID);
+  }
   return emitted;
 }
 
 MsgHandler DiagnosticEngine::report(uint16_t pID,
                                     DiagnosticEngine::Severity pSeverity) {
-  m_State.ID = pID;
-  m_State.severity = pSeverity;
+  state().ID = pID;
+  state().severity = pSeverity;
 
   MsgHandler result(*this);
   return result;
 }
 
+void DiagnosticEngine::replay(Buffer& pBuffer) {
+  std::vector<State>::const_iterator diag, diagEnd;
+  diagEnd = pBuffer.m_Diagnostics.end();
+  for (diag = pBuffer.m_Diagnostics.begin(); diag != diagEnd; ++diag) {
+    state() = *diag;
+    emit();
+  }
+  pBuffer.m_Diagnostics.clear();
+}
+
+bool DiagnosticEngine::isVisible(uint16_t pID) const {
+  return infoMap().isVisible(*this, pID);
+}
+
+llvm::StringRef DiagnosticEngine::getDemangledName(const ResolveInfo& pInfo) {
+  llvm::StringRef name(pInfo.name(), pInfo.nameSize());
+  if (!name.startswith("_Z"))
+    return name;
+
+  std::lock_guard<std::mutex> guard(m_DemangledNamesLock);
+  std::pair<std::unordered_map<const ResolveInfo*, std::string>::iterator,
+            bool> entry =
+      m_DemangledNames.insert(std::make_pair(&pInfo, std::string()));
+  if (entry.second)
+    entry.first->second = demangleName(name.str());
+  return entry.first->second;
+}
+
+bool DiagnosticEngine::isRepeated() {
+  uint16_t id = m_State.ID;
+  if (id == diag::warn_diagnostics_suppressed)
+    return false;
+
+  if (m_NumReports.size() <= id)
+    m_NumReports.resize(id + 1, 0);
+  if (m_NumReports[id] >= MaxReportsPerID)
+    return true;
+
+  // the key is the ID and the arguments, which is cheaper than formatting
+  std::string key(reinterpret_cast<const char*>(&id), sizeof(id));
+  for (int i = 0; i < m_State.numArgs; ++i) {
+    key.push_back(static_cast<char>(m_State.ArgumentKinds[i]));
+    switch (m_State.ArgumentKinds[i]) {
+      case ak_std_string:
+        key.append(m_State.ArgumentStrs[i]);
+        break;
+      case ak_c_string:
+        key.append(reinterpret_cast<const char*>(m_State.ArgumentVals[i]));
+        break;
+      default:
+        key.append(reinterpret_cast<const char*>(&m_State.ArgumentVals[i]),
+                   sizeof(intptr_t));
+        break;
+    }
+    key.push_back('\0');
+  }
+  if (!m_Reported.insert(key).second)
+    return true;
+
+  ++m_NumReports[id];
+  return false;
+}
+
 }  // namespace mcld
@@ -94,34 +94,17 @@ static const DiagStaticInfo* getDiagInfo(unsigned int pID,
   return result;
 }
 
-//===----------------------------------------------------------------------===//
-//  DiagnosticInfos
-//===----------------------------------------------------------------------===//
-DiagnosticInfos::DiagnosticInfos(const LinkerConfig& pConfig)
-    : m_Config(pConfig) {
-}
-
-DiagnosticInfos::~DiagnosticInfos() {
-}
-
-llvm::StringRef DiagnosticInfos::getDescription(unsigned int pID,
-                                                bool pInLoC) const {
-  return getDiagInfo(pID, pInLoC)->getDescription();
-}
-
-bool DiagnosticInfos::process(DiagnosticEngine& pEngine) const {
-  Diagnostic info(pEngine);
-
-  unsigned int ID = info.getID();
-
+/// getSeverity - the severity of the diagnostic pID under the options
+static DiagnosticEngine::Severity getSeverity(const LinkerConfig& pConfig,
+                                              unsigned int pID) {
   // we are not implement LineInfo, so keep pIsLoC false.
-  const DiagStaticInfo* static_info = getDiagInfo(ID);
+  const DiagStaticInfo* static_info = getDiagInfo(pID);
 
   DiagnosticEngine::Severity severity = static_info->Severity;
 
-  switch (ID) {
+  switch (pID) {
     case diag::multiple_definitions: {
-      if (m_Config.options().isMulDefs()) {
+      if (pConfig.options().isMulDefs()) {
         severity = DiagnosticEngine::Ignore;
       }
       break;
@@ -131,15 +114,15 @@ bool DiagnosticInfos::process(DiagnosticEngine& pEngine) const {
       // we have not implement --unresolved-symbols=method yet. So far, MCLinker
       // provides the easier --allow-shlib-undefined and --no-undefined (i.e.
       // -z defs)
-      switch (m_Config.codeGenType()) {
+      switch (pConfig.codeGenType()) {
         case LinkerConfig::Object:
-          if (m_Config.options().isNoUndefined())
+          if (pConfig.options().isNoUndefined())
             severity = DiagnosticEngine::Error;
           else
             severity = DiagnosticEngine::Ignore;
           break;
         case LinkerConfig::DynObj:
-          if (m_Config.options().isNoUndefined())
+          if (pConfig.options().isNoUndefined())
             severity = DiagnosticEngine::Error;
           else
             severity = DiagnosticEngine::Ignore;
@@ -151,7 +134,7 @@ bool DiagnosticInfos::process(DiagnosticEngine& pEngine) const {
       break;
     }
     case diag::debug_print_gc_sections: {
-      if (!m_Config.options().getPrintGCSections())
+      if (!pConfig.options().getPrintGCSections())
         severity = DiagnosticEngine::Ignore;
       break;
     }
@@ -160,13 +143,51 @@ bool DiagnosticInfos::process(DiagnosticEngine& pEngine) const {
   }  // end of switch
 
   // If --fatal-warnings is turned on, then switch warnings and errors to fatal
-  if (m_Config.options().isFatalWarnings()) {
+  if (pConfig.options().isFatalWarnings()) {
     if (severity == DiagnosticEngine::Warning ||
         severity == DiagnosticEngine::Error) {
       severity = DiagnosticEngine::Fatal;
     }
   }
 
+  return severity;
+}
+
+//===----------------------------------------------------------------------===//
+//  DiagnosticInfos
+//===----------------------------------------------------------------------===//
+DiagnosticInfos::DiagnosticInfos(const LinkerConfig& pConfig)
+    : m_Config(pConfig) {
+}
+
+DiagnosticInfos::~DiagnosticInfos() {
+}
+
+llvm::StringRef DiagnosticInfos::getDescription(unsigned int pID,
+                                                bool pInLoC) const {
+  return getDiagInfo(pID, pInLoC)->getDescription();
+}
+
+bool DiagnosticInfos::isVisible(const DiagnosticEngine& pEngine,
+                                unsigned int pID) const {
+  DiagnosticEngine::Severity severity = getSeverity(m_Config, pID);
+  return severity <= DiagnosticEngine::Error ||
+         pEngine.getPrinter()->isVisible(severity);
+}
+
+bool DiagnosticInfos::isFatal(unsigned int pID) const {
+  return getSeverity(m_Config, pID) <= DiagnosticEngine::Fatal;
+}
+
+bool DiagnosticInfos::process(DiagnosticEngine& pEngine) const {
+  Diagnostic info(pEngine);
+  DiagnosticEngine::Severity severity = getSeverity(m_Config, info.getID());
+
+  // errors are always counted, so only the lesser ones can be dropped
+  if (severity > DiagnosticEngine::Error &&
+      (!pEngine.getPrinter()->isVisible(severity) || pEngine.isRepeated()))
+    return false;
+
   // finally, report it.
   pEngine.getPrinter()->handleDiagnostic(severity, info);
   return true;
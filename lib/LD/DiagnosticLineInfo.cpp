@@ -12,5 +12,15 @@ namespace mcld {
 
 //==========================
 // DiagnosticLineInfo
+DiagnosticLineInfo::~DiagnosticLineInfo() {
+}
+
+bool DiagnosticLineInfo::getLine(Input& pInput,
+                                 const LDSection& pSection,
+                                 uint64_t pOffset,
+                                 std::string& pFile,
+                                 unsigned int& pLine) {
+  return false;
+}
 
 }  // namespace mcld
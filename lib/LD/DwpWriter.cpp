@@ -0,0 +1,653 @@
+//===- DwpWriter.cpp ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/DwpWriter.h"
+
+#include "mcld/Module.h"
+#include "mcld/LD/LDContext.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/MC/Input.h"
+#include "mcld/Support/ELF.h"
+#include "mcld/Support/MemoryArea.h"
+#include "mcld/Support/MsgHandling.h"
+#include "mcld/Support/ThreadPool.h"
+#include "mcld/Support/raw_ostream.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <set>
+
+namespace mcld {
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// the sections of a .dwo file which the package holds
+enum SectionKind {
+  InfoSection,
+  AbbrevSection,
+  LineSection,
+  LocListsSection,
+  StrOffsetsSection,
+  MacroSection,
+  RngListsSection,
+  StrSection,
+  NumOfSections
+};
+
+/// DwoSection - a section and its DW_SECT column in the unit index
+struct DwoSection {
+  const char* name;
+  uint32_t column;
+};
+
+const DwoSection kSections[NumOfSections] = {
+    {".debug_info.dwo", 1},
+    {".debug_abbrev.dwo", 3},
+    {".debug_line.dwo", 4},
+    {".debug_loclists.dwo", 5},
+    {".debug_str_offsets.dwo", 6},
+    {".debug_macro.dwo", 7},
+    {".debug_rnglists.dwo", 8},
+    {".debug_str.dwo", 0},
+};
+
+/// the order of the sections in the package
+const SectionKind kOutputOrder[NumOfSections] = {
+    AbbrevSection, LineSection,     LocListsSection, StrOffsetsSection,
+    MacroSection,  RngListsSection, StrSection,      InfoSection,
+};
+
+/// the unit types of DWARF 5
+const uint8_t kSkeletonUnit = 0x04;
+const uint8_t kSplitCompileUnit = 0x05;
+const uint8_t kSplitTypeUnit = 0x06;
+
+const uint16_t kIndexVersion = 5;
+
+/// readLE - the little endian field of pSize bytes at pPos, or 0 with pOK
+/// cleared if the field is out of pData
+uint64_t readLE(llvm::StringRef pData,
+                uint64_t pPos,
+                unsigned int pSize,
+                bool& pOK) {
+  if (!pOK || pPos > pData.size() || pSize > pData.size() - pPos) {
+    pOK = false;
+    return 0;
+  }
+  uint64_t value = 0;
+  for (unsigned int i = 0; i < pSize; ++i)
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(pData[pPos + i]))
+             << (8 * i);
+  return value;
+}
+
+void writeLE(char* pPlace, uint64_t pValue, unsigned int pSize) {
+  for (unsigned int i = 0; i < pSize; ++i)
+    pPlace[i] = static_cast<char>(pValue >> (8 * i));
+}
+
+void appendLE(std::string& pOut, uint64_t pValue, unsigned int pSize) {
+  for (unsigned int i = 0; i < pSize; ++i)
+    pOut.push_back(static_cast<char>(pValue >> (8 * i)));
+}
+
+/// Unit - a unit of .debug_info.dwo
+struct Unit {
+  uint8_t type;
+  uint64_t signature;
+  uint64_t offset;
+  uint64_t size;
+};
+
+/// readUnit - read the header of the DWARF 5 unit at pPos. Return its size,
+/// or 0 if it is malformed.
+uint64_t readUnit(llvm::StringRef pData, uint64_t pPos, Unit& pUnit) {
+  bool ok = true;
+  uint64_t length = readLE(pData, pPos, 4, ok);
+  uint64_t header = 4;
+  unsigned int word = 4;
+  if (length == 0xffffffff) {
+    length = readLE(pData, pPos + 4, 8, ok);
+    header = 12;
+    word = 8;
+  }
+  if (!ok || length > pData.size() - pPos - header)
+    return 0;
+
+  uint64_t pos = pPos + header;
+  uint64_t version = readLE(pData, pos, 2, ok);
+  pUnit.type = readLE(pData, pos + 2, 1, ok);
+  // the address size and the offset in .debug_abbrev precede the signature
+  pUnit.signature = readLE(pData, pos + 4 + word, 8, ok);
+  pUnit.offset = pPos;
+  pUnit.size = header + length;
+  if (!ok || version != 5)
+    return 0;
+  return pUnit.size;
+}
+
+/// DwoFile - a .dwo file and what the package takes from it
+struct DwoFile {
+  DwoFile() : packaged(false), is64(false), machine(0) {
+    std::memset(out_offsets, 0, sizeof(out_offsets));
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer> buffer;
+  std::string error;
+  bool packaged;
+  bool is64;
+  uint16_t machine;
+  llvm::StringRef sections[NumOfSections];
+  std::vector<Unit> units;
+
+  /// strings - the offset of each string in .debug_str.dwo, and of the same
+  /// string in the package
+  std::vector<uint64_t> strings;
+  std::vector<uint64_t> out_strings;
+
+  /// out_offsets - the offset of each section in its package section
+  uint64_t out_offsets[NumOfSections];
+};
+
+/// readDwo - map pPath and find the package sections and the units in it
+bool readDwo(const std::string& pPath, DwoFile& pDwo) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer> > buffer =
+      llvm::MemoryBuffer::getFile(pPath,
+                                  /*FileSize*/ -1,
+                                  /*RequiresNullTerminator*/ false);
+  if (!buffer) {
+    pDwo.error = buffer.getError().message();
+    return false;
+  }
+  pDwo.buffer = std::move(*buffer);
+  llvm::StringRef file = pDwo.buffer->getBuffer();
+
+  if (file.size() < llvm::ELF::EI_NIDENT || !file.startswith("\x7f" "ELF") ||
+      file[llvm::ELF::EI_DATA] != llvm::ELF::ELFDATA2LSB) {
+    pDwo.error = "not a little endian ELF file";
+    return false;
+  }
+  pDwo.is64 = (file[llvm::ELF::EI_CLASS] == llvm::ELF::ELFCLASS64);
+
+  // the section headers of Elf32_Ehdr and Elf64_Ehdr
+  bool ok = true;
+  bool is64 = pDwo.is64;
+  pDwo.machine = readLE(file, 18, 2, ok);
+  uint64_t shoff = readLE(file, is64 ? 40 : 32, is64 ? 8 : 4, ok);
+  uint64_t shentsize = readLE(file, is64 ? 58 : 46, 2, ok);
+  uint64_t shnum = readLE(file, is64 ? 60 : 48, 2, ok);
+  uint64_t shstrndx = readLE(file, is64 ? 62 : 50, 2, ok);
+  unsigned int word = is64 ? 8 : 4;
+  uint64_t shstrtab = shoff + shstrndx * shentsize;
+  uint64_t names = readLE(file, shstrtab + (is64 ? 24 : 16), word, ok);
+  for (uint64_t i = 0; i < shnum && ok; ++i) {
+    uint64_t shdr = shoff + i * shentsize;
+    uint64_t name = readLE(file, shdr, 4, ok);
+    uint64_t flags = readLE(file, shdr + 8, word, ok);
+    uint64_t offset = readLE(file, shdr + (is64 ? 24 : 16), word, ok);
+    uint64_t size = readLE(file, shdr + (is64 ? 32 : 20), word, ok);
+    if (!ok || names + name >= file.size() || offset > file.size() ||
+        size > file.size() - offset) {
+      ok = false;
+      break;
+    }
+    llvm::StringRef sect_name = file.substr(names + name);
+    sect_name = sect_name.substr(0, sect_name.find('\0'));
+    for (unsigned int kind = 0; kind < NumOfSections; ++kind) {
+      if (sect_name != kSections[kind].name)
+        continue;
+      if ((flags & ELF::SHF_COMPRESSED) != 0) {
+        pDwo.error = "compressed section " + sect_name.str();
+        return false;
+      }
+      pDwo.sections[kind] = file.substr(offset, size);
+    }
+  }
+  if (!ok) {
+    pDwo.error = "malformed section headers";
+    return false;
+  }
+
+  llvm::StringRef info = pDwo.sections[InfoSection];
+  for (uint64_t pos = 0; pos < info.size();) {
+    Unit unit;
+    uint64_t size = readUnit(info, pos, unit);
+    if (size == 0) {
+      pDwo.error = "unit at " + llvm::utostr(pos) +
+                   " of .debug_info.dwo is not a DWARF 5 unit";
+      return false;
+    }
+    if (unit.type == kSplitCompileUnit || unit.type == kSplitTypeUnit)
+      pDwo.units.push_back(unit);
+    pos += size;
+  }
+
+  llvm::StringRef str = pDwo.sections[StrSection];
+  for (uint64_t pos = 0; pos < str.size();) {
+    pDwo.strings.push_back(pos);
+    size_t end = str.find('\0', pos);
+    if (end == llvm::StringRef::npos)
+      break;
+    pos = end + 1;
+  }
+  return true;
+}
+
+/// rewriteStrOffsets - rewrite the offsets of the contributions to
+/// .debug_str_offsets.dwo copied at pOut for the merged strings
+void rewriteStrOffsets(const DwoFile& pDwo, char* pOut) {
+  llvm::StringRef data = pDwo.sections[StrOffsetsSection];
+  bool ok = true;
+  for (uint64_t pos = 0; pos + 8 <= data.size();) {
+    // unit_length, version and padding. Only DWARF32 has 4-byte entries.
+    uint64_t length = readLE(data, pos, 4, ok);
+    if (!ok || length >= 0xfffffff0 || length > data.size() - pos - 4)
+      return;
+    uint64_t end = pos + 4 + length;
+    for (uint64_t entry = pos + 8; entry + 4 <= end; entry += 4) {
+      uint64_t offset = readLE(data, entry, 4, ok);
+      std::vector<uint64_t>::const_iterator it = std::upper_bound(
+          pDwo.strings.begin(), pDwo.strings.end(), offset);
+      if (it == pDwo.strings.begin())
+        continue;
+      --it;
+      size_t index = it - pDwo.strings.begin();
+      writeLE(pOut + entry,
+              pDwo.out_strings[index] + (offset - *it),
+              4);
+    }
+    pos = end;
+  }
+}
+
+/// IndexRow - the signature of a unit and its contribution to each column
+struct IndexRow {
+  uint64_t signature;
+  uint64_t offsets[NumOfSections];
+  uint64_t sizes[NumOfSections];
+};
+
+/// buildIndex - the .debug_cu_index or .debug_tu_index of pRows
+std::string buildIndex(const std::vector<IndexRow>& pRows,
+                       const std::vector<unsigned int>& pColumns) {
+  uint32_t num_of_slots = 1;
+  while (num_of_slots <= pRows.size() + pRows.size() / 2)
+    num_of_slots <<= 1;
+  uint32_t mask = num_of_slots - 1;
+
+  std::vector<uint64_t> signatures(num_of_slots, 0);
+  std::vector<uint32_t> indices(num_of_slots, 0);
+  for (size_t i = 0; i < pRows.size(); ++i) {
+    uint64_t signature = pRows[i].signature;
+    uint32_t slot = signature & mask;
+    uint32_t step = ((signature >> 32) & mask) | 1;
+    while (indices[slot] != 0)
+      slot = (slot + step) & mask;
+    signatures[slot] = signature;
+    indices[slot] = i + 1;
+  }
+
+  std::string index;
+  appendLE(index, kIndexVersion, 2);
+  appendLE(index, 0, 2);
+  appendLE(index, pColumns.size(), 4);
+  appendLE(index, pRows.size(), 4);
+  appendLE(index, num_of_slots, 4);
+  for (uint32_t i = 0; i < num_of_slots; ++i)
+    appendLE(index, signatures[i], 8);
+  for (uint32_t i = 0; i < num_of_slots; ++i)
+    appendLE(index, indices[i], 4);
+  for (size_t j = 0; j < pColumns.size(); ++j)
+    appendLE(index, kSections[pColumns[j]].column, 4);
+  for (size_t i = 0; i < pRows.size(); ++i) {
+    for (size_t j = 0; j < pColumns.size(); ++j)
+      appendLE(index, pRows[i].offsets[pColumns[j]], 4);
+  }
+  for (size_t i = 0; i < pRows.size(); ++i) {
+    for (size_t j = 0; j < pColumns.size(); ++j)
+      appendLE(index, pRows[i].sizes[pColumns[j]], 4);
+  }
+  return index;
+}
+
+/// InfoUnit - a unit of a .dwo file and its offset in the package
+struct InfoUnit {
+  const DwoFile* dwo;
+  const Unit* unit;
+  uint64_t offset;
+};
+
+/// OutputSection - a section of the package and its place in the file
+struct OutputSection {
+  std::string name;
+  uint64_t offset;
+  uint64_t size;
+  uint64_t align;
+  uint64_t flags;
+  uint64_t entsize;
+  uint32_t type;
+};
+
+/// getDebugInfo - the .debug_info of pInput in its file
+llvm::StringRef getDebugInfo(Input& pInput) {
+  if (pInput.context() == NULL || pInput.memArea() == NULL)
+    return llvm::StringRef();
+  const LDSection* info = pInput.context()->getSection(".debug_info");
+  if (info == NULL || info->size() == 0 ||
+      (info->flag() & ELF::SHF_COMPRESSED) != 0)
+    return llvm::StringRef();
+  return pInput.memArea()->request(pInput.fileOffset() + info->offset(),
+                                   info->size());
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// DwpWriter
+//===----------------------------------------------------------------------===//
+DwpWriter::DwpWriter() {
+}
+
+DwpWriter::~DwpWriter() {
+}
+
+void DwpWriter::addInputs(Module& pModule) {
+  std::set<std::string> files;
+  Module::obj_iterator input, inEnd = pModule.obj_end();
+  for (input = pModule.obj_begin(); input != inEnd; ++input) {
+    // the .dwo of an archive member is not beside the archive
+    if ((*input)->fileOffset() != 0)
+      continue;
+
+    Unit skeleton;
+    llvm::StringRef info = getDebugInfo(**input);
+    if (info.empty() || readUnit(info, 0, skeleton) == 0 ||
+        skeleton.type != kSkeletonUnit)
+      continue;
+
+    llvm::SmallString<256> path((*input)->path().native());
+    llvm::sys::path::replace_extension(path, "dwo");
+    if (!files.insert(path.str().str()).second)
+      continue;
+    m_Files.push_back(path.str().str());
+    m_DwoIDs.push_back(skeleton.signature);
+  }
+}
+
+bool DwpWriter::write(const std::string& pPath, ThreadPool& pPool) {
+  std::vector<DwoFile> dwos(m_Files.size());
+  parallelFor(pPool, 0, dwos.size(), [&](size_t pIndex) {
+    readDwo(m_Files[pIndex], dwos[pIndex]);
+  });
+
+  // lay the contributions out in the order of the inputs, so that the
+  // package does not depend on the number of threads
+  uint64_t sizes[NumOfSections] = {0};
+  std::vector<IndexRow> cu_rows, tu_rows;
+  std::vector<InfoUnit> info_units;
+  std::vector<llvm::StringRef> out_strings;
+  llvm::StringMap<uint64_t> string_map;
+  std::set<uint64_t> cu_ids;
+  llvm::DenseSet<uint64_t> type_ids;
+  bool has_machine = false;
+  bool is64 = false;
+  uint16_t machine = 0;
+  for (size_t i = 0; i < dwos.size(); ++i) {
+    DwoFile& dwo = dwos[i];
+    if (!dwo.error.empty()) {
+      warning(diag::warn_cannot_package_dwo) << m_Files[i] << dwo.error;
+      continue;
+    }
+    Unit* cu = NULL;
+    for (size_t j = 0; j < dwo.units.size(); ++j) {
+      if (dwo.units[j].type == kSplitCompileUnit &&
+          dwo.units[j].signature == m_DwoIDs[i])
+        cu = &dwo.units[j];
+    }
+    if (cu == NULL) {
+      warning(diag::warn_cannot_package_dwo)
+          << m_Files[i] << "no split unit matches the skeleton";
+      continue;
+    }
+    if (!cu_ids.insert(cu->signature).second) {
+      warning(diag::warn_cannot_package_dwo) << m_Files[i]
+                                             << "duplicate DWO ID";
+      continue;
+    }
+    dwo.packaged = true;
+    if (!has_machine) {
+      has_machine = true;
+      is64 = dwo.is64;
+      machine = dwo.machine;
+    }
+
+    for (unsigned int kind = 0; kind < NumOfSections; ++kind) {
+      dwo.out_offsets[kind] = sizes[kind];
+      if (kind != InfoSection && kind != StrSection)
+        sizes[kind] += dwo.sections[kind].size();
+    }
+
+    llvm::StringRef str = dwo.sections[StrSection];
+    dwo.out_strings.resize(dwo.strings.size());
+    for (size_t j = 0; j < dwo.strings.size(); ++j) {
+      llvm::StringRef string = str.substr(dwo.strings[j]);
+      string = string.substr(0, string.find('\0'));
+      llvm::StringMap<uint64_t>::iterator entry = string_map.find(string);
+      if (entry == string_map.end()) {
+        entry = string_map.insert(std::make_pair(string, sizes[StrSection]))
+                    .first;
+        out_strings.push_back(string);
+        sizes[StrSection] += string.size() + 1;
+      }
+      dwo.out_strings[j] = entry->second;
+    }
+
+    // the units share the other contributions of their .dwo
+    for (size_t j = 0; j < dwo.units.size(); ++j) {
+      const Unit& unit = dwo.units[j];
+      if (unit.type == kSplitCompileUnit && &unit != cu)
+        continue;
+      if (unit.type == kSplitTypeUnit &&
+          !type_ids.insert(unit.signature).second)
+        continue;
+      IndexRow row;
+      row.signature = unit.signature;
+      for (unsigned int kind = 0; kind < NumOfSections; ++kind) {
+        row.offsets[kind] = dwo.out_offsets[kind];
+        row.sizes[kind] = dwo.sections[kind].size();
+      }
+      row.offsets[InfoSection] = sizes[InfoSection];
+      row.sizes[InfoSection] = unit.size;
+      InfoUnit info_unit = {&dwo, &unit, sizes[InfoSection]};
+      info_units.push_back(info_unit);
+      sizes[InfoSection] += unit.size;
+      if (unit.type == kSplitCompileUnit)
+        cu_rows.push_back(row);
+      else
+        tu_rows.push_back(row);
+    }
+  }
+
+  for (unsigned int kind = 0; kind < NumOfSections; ++kind) {
+    if (sizes[kind] > 0xffffffff) {
+      error(diag::err_cannot_write_dwp)
+          << pPath << std::string(kSections[kind].name) + " exceeds 4GB";
+      return false;
+    }
+  }
+
+  // the columns of the indices are the sections which some unit has
+  std::vector<unsigned int> columns;
+  for (unsigned int kind = 0; kind < NumOfSections; ++kind) {
+    if (kind != StrSection && sizes[kind] != 0)
+      columns.push_back(kind);
+  }
+  std::string cu_index = buildIndex(cu_rows, columns);
+  std::string tu_index;
+  if (!tu_rows.empty())
+    tu_index = buildIndex(tu_rows, columns);
+
+  // lay the package file out: the ELF header, the sections, the section
+  // header string table and the section headers
+  uint64_t ehdr_size =
+      is64 ? sizeof(llvm::ELF::Elf64_Ehdr) : sizeof(llvm::ELF::Elf32_Ehdr);
+  uint64_t shdr_size =
+      is64 ? sizeof(llvm::ELF::Elf64_Shdr) : sizeof(llvm::ELF::Elf32_Shdr);
+  std::vector<OutputSection> sections;
+  OutputSection null_sect = {"", 0, 0, 0, 0, 0, llvm::ELF::SHT_NULL};
+  sections.push_back(null_sect);
+  uint64_t section_offsets[NumOfSections] = {0};
+  uint64_t offset = ehdr_size;
+  for (unsigned int i = 0; i < NumOfSections; ++i) {
+    SectionKind kind = kOutputOrder[i];
+    if (sizes[kind] == 0)
+      continue;
+    OutputSection sect = {kSections[kind].name, offset, sizes[kind], 1,
+                          llvm::ELF::SHF_EXCLUDE, 0,
+                          llvm::ELF::SHT_PROGBITS};
+    if (kind == StrSection) {
+      sect.flags |= llvm::ELF::SHF_MERGE | llvm::ELF::SHF_STRINGS;
+      sect.entsize = 1;
+    }
+    section_offsets[kind] = offset;
+    sections.push_back(sect);
+    offset += sizes[kind];
+  }
+  offset = (offset + 7) & ~static_cast<uint64_t>(7);
+  OutputSection cu_sect = {".debug_cu_index", offset, cu_index.size(), 8,
+                           0, 0, llvm::ELF::SHT_PROGBITS};
+  sections.push_back(cu_sect);
+  offset += cu_index.size();
+  uint64_t tu_offset = 0;
+  if (!tu_index.empty()) {
+    offset = (offset + 7) & ~static_cast<uint64_t>(7);
+    tu_offset = offset;
+    OutputSection tu_sect = {".debug_tu_index", offset, tu_index.size(), 8,
+                             0, 0, llvm::ELF::SHT_PROGBITS};
+    sections.push_back(tu_sect);
+    offset += tu_index.size();
+  }
+
+  std::string shstrtab(1, '\0');
+  std::vector<uint32_t> names;
+  for (size_t i = 0; i < sections.size(); ++i) {
+    names.push_back(sections[i].name.empty() ? 0 : shstrtab.size());
+    if (!sections[i].name.empty())
+      shstrtab.append(sections[i].name.c_str(), sections[i].name.size() + 1);
+  }
+  names.push_back(shstrtab.size());
+  shstrtab.append(".shstrtab", sizeof(".shstrtab"));
+  OutputSection shstr_sect = {".shstrtab", offset, shstrtab.size(), 1,
+                              0, 0, llvm::ELF::SHT_STRTAB};
+  sections.push_back(shstr_sect);
+  offset += shstrtab.size();
+  uint64_t shoff = (offset + 7) & ~static_cast<uint64_t>(7);
+  uint64_t file_size = shoff + sections.size() * shdr_size;
+
+  // copy the contributions of the .dwo files in parallel
+  std::vector<char> out(file_size, 0);
+  char* base = out.data();
+  parallelFor(pPool, 0, dwos.size(), [&](size_t pIndex) {
+    const DwoFile& dwo = dwos[pIndex];
+    if (!dwo.packaged)
+      return;
+    for (unsigned int kind = 0; kind < NumOfSections; ++kind) {
+      if (kind == InfoSection || kind == StrSection ||
+          dwo.sections[kind].empty())
+        continue;
+      char* place = base + section_offsets[kind] + dwo.out_offsets[kind];
+      std::memcpy(place, dwo.sections[kind].data(),
+                  dwo.sections[kind].size());
+      if (kind == StrOffsetsSection)
+        rewriteStrOffsets(dwo, place);
+    }
+  });
+  parallelFor(pPool, 0, info_units.size(), [&](size_t pIndex) {
+    const InfoUnit& info_unit = info_units[pIndex];
+    std::memcpy(base + section_offsets[InfoSection] + info_unit.offset,
+                info_unit.dwo->sections[InfoSection].data() +
+                    info_unit.unit->offset,
+                info_unit.unit->size);
+  });
+  uint64_t str_offset = section_offsets[StrSection];
+  for (size_t i = 0; i < out_strings.size(); ++i) {
+    std::memcpy(base + str_offset, out_strings[i].data(),
+                out_strings[i].size());
+    str_offset += out_strings[i].size() + 1;
+  }
+  std::memcpy(base + cu_sect.offset, cu_index.data(), cu_index.size());
+  if (!tu_index.empty())
+    std::memcpy(base + tu_offset, tu_index.data(), tu_index.size());
+  std::memcpy(base + shstr_sect.offset, shstrtab.data(), shstrtab.size());
+
+  // Elf32_Ehdr or Elf64_Ehdr of a relocatable object
+  unsigned int word = is64 ? 8 : 4;
+  std::memcpy(base, "\x7f" "ELF", 4);
+  base[llvm::ELF::EI_CLASS] =
+      is64 ? llvm::ELF::ELFCLASS64 : llvm::ELF::ELFCLASS32;
+  base[llvm::ELF::EI_DATA] = llvm::ELF::ELFDATA2LSB;
+  base[llvm::ELF::EI_VERSION] = llvm::ELF::EV_CURRENT;
+  char* field = base + llvm::ELF::EI_NIDENT;
+  writeLE(field, llvm::ELF::ET_REL, 2);
+  writeLE(field + 2, machine, 2);
+  writeLE(field + 4, llvm::ELF::EV_CURRENT, 4);
+  field += 8 + 2 * word;  // e_entry and e_phoff
+  writeLE(field, shoff, word);
+  field += word + 4;  // e_flags
+  writeLE(field, ehdr_size, 2);
+  writeLE(field + 6, shdr_size, 2);
+  writeLE(field + 8, sections.size(), 2);
+  writeLE(field + 10, sections.size() - 1, 2);
+
+  // Elf32_Shdr or Elf64_Shdr
+  for (size_t i = 1; i < sections.size(); ++i) {
+    const OutputSection& sect = sections[i];
+    char* shdr = base + shoff + i * shdr_size;
+    writeLE(shdr, names[i], 4);
+    writeLE(shdr + 4, sect.type, 4);
+    writeLE(shdr + 8, sect.flags, word);
+    field = shdr + 8 + 2 * word;  // sh_addr
+    writeLE(field, sect.offset, word);
+    writeLE(field + word, sect.size, word);
+    field += 2 * word + 8;  // sh_link and sh_info
+    writeLE(field, sect.align, word);
+    writeLE(field + word, sect.entsize, word);
+  }
+
+  std::error_code ec;
+  mcld::raw_fd_ostream os(pPath.c_str(), ec);
+  if (!ec) {
+    os.write(base, out.size());
+    os.close();
+    if (os.has_error()) {
+      ec = std::make_error_code(std::errc::io_error);
+      os.clear_error();
+    }
+  }
+  if (ec) {
+    error(diag::err_cannot_write_dwp) << pPath << ec.message();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace mcld
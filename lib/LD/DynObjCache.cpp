@@ -0,0 +1,249 @@
+//===- DynObjCache.cpp ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/DynObjCache.h"
+
+#include "mcld/Config/Config.h"
+#include "mcld/LD/LDContext.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/MC/Input.h"
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <cstring>
+#include <sys/stat.h>
+#include <vector>
+
+namespace mcld {
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+const char kMagic[8] = {'M', 'C', 'L', 'D', 'D', 'S', 'O', '1'};
+
+const uint32_t kByteOrder = 0x01020304;
+
+const uint32_t kNoSection = ~0U;
+
+/// Header - the beginning of an entry. The key and the SONAME follow it, and
+/// the records start at the next multiple of 8.
+struct Header {
+  char magic[8];
+  uint32_t byte_order;
+  uint32_t key_size;
+  uint32_t soname_size;
+  uint32_t num_symbols;
+  uint32_t strtab_size;
+  uint32_t reserved;
+};
+
+/// Record - a symbol of the shared object
+struct Record {
+  uint64_t value;
+  uint64_t size;
+  uint32_t name;
+  uint32_t hash;
+  uint32_t section;
+  uint8_t type;
+  uint8_t desc;
+  uint8_t binding;
+  uint8_t visibility;
+};
+
+size_t getRecordOffset(const Header& pHeader) {
+  size_t offset = sizeof(Header) + pHeader.key_size + pHeader.soname_size;
+  return (offset + 7) & ~static_cast<size_t>(7);
+}
+
+/// getEntryPath - the entry of pKey in pDir
+std::string getEntryPath(const std::string& pDir, llvm::StringRef pKey) {
+  llvm::SHA1 sha1;
+  sha1.update(llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t*>(pKey.data()), pKey.size()));
+  std::string digest = llvm::toHex(llvm::StringRef(
+      reinterpret_cast<const char*>(sha1.final().data()), 20));
+
+  llvm::SmallString<256> path(pDir);
+  llvm::sys::path::append(path, digest + ".dso");
+  return path.str().str();
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// DynObjCache
+//===----------------------------------------------------------------------===//
+DynObjCache::DynObjCache(const std::string& pDir)
+    : m_Dir(pDir), m_pInput(NULL) {
+}
+
+DynObjCache::~DynObjCache() {
+}
+
+bool DynObjCache::open(const Input& pInput, llvm::StringRef pBuildID) {
+  m_pInput = NULL;
+  m_pEntry.reset();
+
+  // the shared objects in archives are not cached. The records written by
+  // another version of the linker may mean other things.
+  const std::string& path = pInput.path().native();
+  struct ::stat file_stat;
+  if (pInput.fileOffset() != 0 || ::stat(path.c_str(), &file_stat) != 0)
+    return false;
+
+  m_Key.clear();
+  llvm::raw_string_ostream key(m_Key);
+  key << MCLD_VERSION << '\0' << path << '\0'
+      << static_cast<uint64_t>(file_stat.st_size) << '\0'
+      << static_cast<int64_t>(file_stat.st_mtime) << '\0';
+  for (size_t i = 0; i < pBuildID.size(); ++i)
+    key.write_hex(static_cast<unsigned char>(pBuildID[i]));
+  key.flush();
+
+  m_File = getEntryPath(m_Dir, m_Key);
+  m_pInput = &pInput;
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer> > buffer =
+      llvm::MemoryBuffer::getFile(m_File,
+                                  /*FileSize*/ -1,
+                                  /*RequiresNullTerminator*/ false);
+  if (!buffer)
+    return false;
+
+  // an entry of another key, of another host or cut short is a miss
+  llvm::StringRef content = (*buffer)->getBuffer();
+  if (content.size() < sizeof(Header))
+    return false;
+  const Header* header = reinterpret_cast<const Header*>(content.data());
+  uint64_t size = getRecordOffset(*header) +
+                  uint64_t(header->num_symbols) * sizeof(Record) +
+                  header->strtab_size;
+  if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 ||
+      header->byte_order != kByteOrder || size != content.size() ||
+      content.substr(sizeof(Header), header->key_size) != m_Key ||
+      header->strtab_size == 0 || content.back() != '\0')
+    return false;
+
+  m_pEntry = std::move(*buffer);
+  return true;
+}
+
+llvm::StringRef DynObjCache::getSOName() const {
+  const char* data = m_pEntry->getBufferStart();
+  const Header* header = reinterpret_cast<const Header*>(data);
+  return llvm::StringRef(data + sizeof(Header) + header->key_size,
+                         header->soname_size);
+}
+
+void DynObjCache::getSymbols(Input& pInput,
+                             ObjectReader::SymbolStage& pStage) const {
+  const char* data = m_pEntry->getBufferStart();
+  const Header* header = reinterpret_cast<const Header*>(data);
+  const Record* records =
+      reinterpret_cast<const Record*>(data + getRecordOffset(*header));
+  const char* strtab =
+      reinterpret_cast<const char*>(records + header->num_symbols);
+
+  pStage.reserve(pStage.size() + header->num_symbols);
+  for (uint32_t i = 0; i < header->num_symbols; ++i) {
+    const Record& record = records[i];
+    pStage.push_back(ObjectReader::StagedSymbol());
+    ObjectReader::StagedSymbol& sym = pStage.back();
+    if (record.name < header->strtab_size)
+      sym.name = strtab + record.name;
+    sym.hash = record.hash;
+    sym.type = static_cast<ResolveInfo::Type>(record.type);
+    sym.desc = static_cast<ResolveInfo::Desc>(record.desc);
+    sym.binding = static_cast<ResolveInfo::Binding>(record.binding);
+    sym.size = record.size;
+    sym.value = record.value;
+    sym.section = NULL;
+    if (record.section != kNoSection)
+      sym.section = pInput.context()->getSection(record.section);
+    sym.visibility = static_cast<ResolveInfo::Visibility>(record.visibility);
+  }
+}
+
+bool DynObjCache::store(llvm::StringRef pSOName,
+                        const ObjectReader::SymbolStage& pStage) {
+  if (m_pInput == NULL || m_pEntry != NULL)
+    return false;
+
+  Header header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.byte_order = kByteOrder;
+  header.key_size = m_Key.size();
+  header.soname_size = pSOName.size();
+  header.num_symbols = pStage.size();
+  header.reserved = 0;
+
+  std::string strtab;
+  std::vector<Record> records(pStage.size());
+  for (size_t i = 0; i < pStage.size(); ++i) {
+    const ObjectReader::StagedSymbol& sym = pStage[i];
+    Record& record = records[i];
+    record.value = sym.value;
+    record.size = sym.size;
+    record.name = strtab.size();
+    record.hash = sym.hash;
+    record.section = kNoSection;
+    if (sym.section != NULL)
+      record.section = sym.section->index();
+    record.type = sym.type;
+    record.desc = sym.desc;
+    record.binding = sym.binding;
+    record.visibility = sym.visibility;
+    strtab.append(sym.name.data(), sym.name.size());
+    strtab.push_back('\0');
+  }
+  if (strtab.empty())
+    strtab.push_back('\0');
+  header.strtab_size = strtab.size();
+
+  std::string content(reinterpret_cast<const char*>(&header), sizeof(header));
+  content += m_Key;
+  content += pSOName;
+  content.resize(getRecordOffset(header), '\0');
+  if (!records.empty())
+    content.append(reinterpret_cast<const char*>(records.data()),
+                   records.size() * sizeof(Record));
+  content += strtab;
+
+  // write aside and rename, so that the links sharing the directory never
+  // read a partial entry. Failing to write is not an error.
+  int fd = -1;
+  llvm::SmallString<256> temp;
+  if (llvm::sys::fs::createUniqueFile(m_File + "-%%%%%%", fd, temp))
+    return false;
+  {
+    llvm::raw_fd_ostream out(fd, /*shouldClose*/ true);
+    out << content;
+    out.close();
+    if (out.has_error()) {
+      out.clear_error();
+      llvm::sys::fs::remove(temp.str());
+      return false;
+    }
+  }
+  if (llvm::sys::fs::rename(temp.str(), m_File)) {
+    llvm::sys::fs::remove(temp.str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace mcld
@@ -0,0 +1,212 @@
+//===- ELFDynObjIndex.cpp -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/ELFDynObjIndex.h"
+
+#include "mcld/LD/ELFReaderIf.h"
+#include "mcld/LD/ObjectReader.h"
+#include "mcld/MC/Input.h"
+
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/Endian.h>
+
+#include <algorithm>
+
+namespace mcld {
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+uint16_t read16(const char* pPlace) {
+  return llvm::support::endian::read16le(pPlace);
+}
+
+uint32_t read32(const char* pPlace) {
+  return llvm::support::endian::read32le(pPlace);
+}
+
+uint64_t read64(const char* pPlace) {
+  return llvm::support::endian::read64le(pPlace);
+}
+
+/// gnuHash - the hash function of .gnu.hash
+uint32_t gnuHash(llvm::StringRef pName) {
+  uint32_t hash = 5381;
+  for (size_t i = 0; i < pName.size(); ++i)
+    hash = hash * 33 + static_cast<unsigned char>(pName[i]);
+  return hash;
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// ELFDynObjIndex
+//===----------------------------------------------------------------------===//
+ELFDynObjIndex::ELFDynObjIndex(Input& pInput,
+                               const ELFReaderIF& pReader,
+                               bool pIs64Bits)
+    : m_Input(pInput),
+      m_Reader(pReader),
+      m_bIs64Bits(pIs64Bits),
+      m_EntSize(pIs64Bits ? sizeof(llvm::ELF::Elf64_Sym)
+                          : sizeof(llvm::ELF::Elf32_Sym)),
+      m_NumOfSymbols(0),
+      m_NumOfBuckets(0),
+      m_SymOffset(0),
+      m_BloomSize(0),
+      m_BloomShift(0),
+      m_pBloom(NULL),
+      m_pBuckets(NULL),
+      m_pChains(NULL),
+      m_bIndexedObjects(false) {
+}
+
+ELFDynObjIndex::~ELFDynObjIndex() {
+}
+
+bool ELFDynObjIndex::parse(llvm::StringRef pSymTab,
+                           llvm::StringRef pStrTab,
+                           llvm::StringRef pGNUHash) {
+  // the names are read in place, so the string table must end with a NUL
+  if (pStrTab.empty() || pStrTab.back() != '\0' || pGNUHash.size() < 16)
+    return false;
+
+  m_SymTab = pSymTab;
+  m_StrTab = pStrTab;
+  m_NumOfSymbols = pSymTab.size() / m_EntSize;
+
+  const char* data = pGNUHash.data();
+  m_NumOfBuckets = read32(data);
+  m_SymOffset = read32(data + 4);
+  m_BloomSize = read32(data + 8);
+  m_BloomShift = read32(data + 12);
+  if (m_NumOfBuckets == 0 || m_BloomSize == 0 || m_BloomShift >= 32 ||
+      m_SymOffset == 0 || m_SymOffset > m_NumOfSymbols)
+    return false;
+
+  uint64_t word_size = m_bIs64Bits ? 8 : 4;
+  uint64_t size = 16 + m_BloomSize * word_size + m_NumOfBuckets * UINT64_C(4) +
+                  (m_NumOfSymbols - m_SymOffset) * UINT64_C(4);
+  if (size > pGNUHash.size())
+    return false;
+
+  m_pBloom = data + 16;
+  m_pBuckets = m_pBloom + m_BloomSize * word_size;
+  m_pChains = m_pBuckets + m_NumOfBuckets * 4;
+  return true;
+}
+
+void ELFDynObjIndex::lookUp(llvm::StringRef pName,
+                            llvm::SmallVectorImpl<uint32_t>& pIndices) const {
+  uint32_t hash = gnuHash(pName);
+
+  // most of the names are not in the library, and the bloom filter says so
+  unsigned bits = m_bIs64Bits ? 64 : 32;
+  const char* place = m_pBloom + ((hash / bits) % m_BloomSize) * (bits / 8);
+  uint64_t word = m_bIs64Bits ? read64(place) : read32(place);
+  uint64_t mask = (UINT64_C(1) << (hash % bits)) |
+                  (UINT64_C(1) << ((hash >> m_BloomShift) % bits));
+  if ((word & mask) != mask)
+    return;
+
+  // the symbols of a bucket are contiguous, and the last one has the low
+  // bit of its chain value set
+  uint32_t index = read32(m_pBuckets + (hash % m_NumOfBuckets) * 4);
+  if (index < m_SymOffset)
+    return;
+  for (; index < m_NumOfSymbols; ++index) {
+    uint32_t chain = read32(m_pChains + (index - m_SymOffset) * 4);
+    if ((chain | 1) == (hash | 1) && getName(index) == pName)
+      pIndices.push_back(index);
+    if ((chain & 1) != 0)
+      break;
+  }
+}
+
+llvm::StringRef ELFDynObjIndex::getName(uint32_t pIndex) const {
+  uint32_t offset = read32(m_SymTab.data() + pIndex * m_EntSize);
+  if (offset >= m_StrTab.size())
+    return llvm::StringRef();
+  return llvm::StringRef(m_StrTab.data() + offset);
+}
+
+uint64_t ELFDynObjIndex::getValue(uint32_t pIndex) const {
+  const char* sym = m_SymTab.data() + pIndex * m_EntSize;
+  if (m_bIs64Bits)
+    return read64(sym + 8);
+  return read32(sym + 4);
+}
+
+bool ELFDynObjIndex::isAliasCandidate(uint32_t pIndex) const {
+  const char* sym = m_SymTab.data() + pIndex * m_EntSize;
+  uint8_t info = m_bIs64Bits ? sym[4] : sym[12];
+  uint8_t other = m_bIs64Bits ? sym[5] : sym[13];
+  uint16_t shndx = read16(m_bIs64Bits ? sym + 6 : sym + 14);
+  uint8_t binding = info >> 4;
+  uint8_t visibility = other & 0x3;
+  return (info & 0xF) == llvm::ELF::STT_OBJECT &&
+         shndx != llvm::ELF::SHN_UNDEF &&
+         (binding == llvm::ELF::STB_GLOBAL || binding == llvm::ELF::STB_WEAK) &&
+         visibility != llvm::ELF::STV_HIDDEN &&
+         visibility != llvm::ELF::STV_INTERNAL;
+}
+
+void ELFDynObjIndex::indexObjects() {
+  for (uint32_t index = m_SymOffset; index < m_NumOfSymbols; ++index) {
+    if (isAliasCandidate(index))
+      m_Objects.push_back(std::make_pair(getValue(index), index));
+  }
+  std::sort(m_Objects.begin(), m_Objects.end());
+  m_bIndexedObjects = true;
+}
+
+void ELFDynObjIndex::addSymbols(llvm::StringRef pName,
+                                IRBuilder& pBuilder,
+                                std::vector<std::string>& pAliases) {
+  llvm::SmallVector<uint32_t, 4> indices;
+  lookUp(pName, indices);
+
+  // parseSymbols skips the first entry as the null symbol, so that a symbol
+  // is decoded from the window of two entries which ends with it
+  ObjectReader::SymbolStage stage;
+  llvm::SmallVector<uint32_t, 4>::const_iterator it, end = indices.end();
+  for (it = indices.begin(); it != end; ++it) {
+    if (!m_Added.insert(*it).second)
+      continue;
+    m_Reader.parseSymbols(m_Input,
+                          m_SymTab.substr((*it - 1) * m_EntSize, 2 * m_EntSize),
+                          m_StrTab.data(),
+                          stage);
+    if (!isAliasCandidate(*it))
+      continue;
+
+    // add the symbols at the same address, which may be its aliases
+    if (!m_bIndexedObjects)
+      indexObjects();
+    std::pair<uint64_t, uint32_t> key(getValue(*it), 0);
+    ObjectList::const_iterator alias =
+        std::lower_bound(m_Objects.begin(), m_Objects.end(), key);
+    for (; alias != m_Objects.end() && alias->first == key.first; ++alias) {
+      if (!m_Added.insert(alias->second).second)
+        continue;
+      m_Reader.parseSymbols(
+          m_Input,
+          m_SymTab.substr((alias->second - 1) * m_EntSize, 2 * m_EntSize),
+          m_StrTab.data(),
+          stage);
+      pAliases.push_back(getName(alias->second).str());
+    }
+  }
+
+  if (!stage.empty())
+    m_Reader.appendSymbols(m_Input, pBuilder, stage);
+}
+
+}  // namespace mcld
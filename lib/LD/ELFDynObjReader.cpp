@@ -10,7 +10,10 @@
 
 #include "mcld/IRBuilder.h"
 #include "mcld/LinkerConfig.h"
+#include "mcld/LD/DynObjCache.h"
+#include "mcld/LD/ELFDynObjIndex.h"
 #include "mcld/LD/ELFReader.h"
+#include "mcld/LD/InputCostReport.h"
 #include "mcld/LD/LDContext.h"
 #include "mcld/MC/Input.h"
 #include "mcld/Support/MemoryArea.h"
@@ -18,6 +21,8 @@
 
 #include <llvm/ADT/StringRef.h>
 #include <llvm/ADT/Twine.h>
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/Endian.h>
 #include <llvm/Support/ErrorHandling.h>
 
 #include <string>
@@ -30,15 +35,23 @@ namespace mcld {
 ELFDynObjReader::ELFDynObjReader(GNULDBackend& pBackend,
                                  IRBuilder& pBuilder,
                                  const LinkerConfig& pConfig)
-    : DynObjReader(), m_pELFReader(0), m_Builder(pBuilder) {
+    : DynObjReader(),
+      m_Config(pConfig),
+      m_pELFReader(0),
+      m_Builder(pBuilder),
+      m_pCache(NULL) {
   if (pConfig.targets().is32Bits() && pConfig.targets().isLittleEndian())
     m_pELFReader = new ELFReader<32, true>(pBackend);
   else if (pConfig.targets().is64Bits() && pConfig.targets().isLittleEndian())
     m_pELFReader = new ELFReader<64, true>(pBackend);
+
+  if (pConfig.options().hasDSOCache())
+    m_pCache = new DynObjCache(pConfig.options().getDSOCacheDir());
 }
 
 ELFDynObjReader::~ELFDynObjReader() {
   delete m_pELFReader;
+  delete m_pCache;
 }
 
 /// isMyFormat
@@ -75,6 +88,7 @@ bool ELFDynObjReader::isMyFormat(Input& pInput, bool& pContinue) const {
 /// readHeader
 bool ELFDynObjReader::readHeader(Input& pInput) {
   assert(pInput.hasMemArea());
+  InputCostReport::Scope cost(pInput, InputCostReport::Read);
 
   size_t hdr_size = m_pELFReader->getELFHeaderSize();
   llvm::StringRef region =
@@ -83,6 +97,13 @@ bool ELFDynObjReader::readHeader(Input& pInput) {
 
   bool shdr_result = m_pELFReader->readSectionHeaders(pInput, ELF_hdr);
 
+  // the cached entry knows the SONAME
+  if (shdr_result && m_pCache != NULL &&
+      m_pCache->open(pInput, getBuildID(pInput))) {
+    pInput.setName(m_pCache->getSOName().str());
+    return true;
+  }
+
   // read .dynamic to get the correct SONAME
   bool dyn_result = m_pELFReader->readDynamic(pInput);
 
@@ -92,6 +113,7 @@ bool ELFDynObjReader::readHeader(Input& pInput) {
 /// readSymbols
 bool ELFDynObjReader::readSymbols(Input& pInput) {
   assert(pInput.hasMemArea());
+  InputCostReport::Scope cost(pInput, InputCostReport::Resolve);
 
   LDSection* symtab_shdr = pInput.context()->getSection(".dynsym");
   if (symtab_shdr == NULL) {
@@ -112,10 +134,67 @@ bool ELFDynObjReader::readSymbols(Input& pInput) {
 
   llvm::StringRef strtab_region = pInput.memArea()->request(
       pInput.fileOffset() + strtab_shdr->offset(), strtab_shdr->size());
+  if (m_Config.options().lazyDSOSymbols() &&
+      readLazySymbols(pInput, symtab_region, strtab_region))
+    return true;
+
+  ObjectReader::SymbolStage stage;
+  if (m_pCache != NULL && m_pCache->isOpen(pInput)) {
+    m_pCache->getSymbols(pInput, stage);
+    return m_pELFReader->addSymbols(pInput, m_Builder, stage);
+  }
+
   const char* strtab = strtab_region.begin();
-  bool result =
-      m_pELFReader->readSymbols(pInput, m_Builder, symtab_region, strtab);
-  return result;
+  if (!m_pELFReader->parseSymbols(pInput, symtab_region, strtab, stage))
+    return false;
+  if (m_pCache != NULL && m_pCache->isMissed(pInput))
+    m_pCache->store(pInput.name(), stage);
+  return m_pELFReader->addSymbols(pInput, m_Builder, stage);
+}
+
+bool ELFDynObjReader::readLazySymbols(Input& pInput,
+                                      llvm::StringRef pSymTab,
+                                      llvm::StringRef pStrTab) {
+  LDContext::sect_iterator sect, sectEnd = pInput.context()->sectEnd();
+  for (sect = pInput.context()->sectBegin(); sect != sectEnd; ++sect) {
+    if ((*sect)->type() == llvm::ELF::SHT_GNU_HASH)
+      break;
+  }
+  if (sect == sectEnd)
+    return false;
+
+  llvm::StringRef hash_region = pInput.memArea()->request(
+      pInput.fileOffset() + (*sect)->offset(), (*sect)->size());
+  ELFDynObjIndex* index = new ELFDynObjIndex(
+      pInput, *m_pELFReader, m_Config.targets().is64Bits());
+  if (!index->parse(pSymTab, pStrTab, hash_region)) {
+    delete index;
+    return false;
+  }
+
+  // the symbols before symoffset are not hashed, e.g., the undefined ones
+  m_pELFReader->readSymbols(
+      pInput, m_Builder, index->getUnhashedSymbols(), pStrTab.begin());
+  m_Builder.AddLazyDynObj(index);
+  return true;
+}
+
+llvm::StringRef ELFDynObjReader::getBuildID(Input& pInput) const {
+  LDSection* note = pInput.context()->getSection(".note.gnu.build-id");
+  if (note == NULL || note->type() != llvm::ELF::SHT_NOTE || note->size() < 12)
+    return llvm::StringRef();
+
+  // namesz, descsz and type, then the name and the descriptor aligned to 4
+  llvm::StringRef region = pInput.memArea()->request(
+      pInput.fileOffset() + note->offset(), note->size());
+  uint32_t name_size = llvm::support::endian::read32le(region.data());
+  uint32_t desc_size = llvm::support::endian::read32le(region.data() + 4);
+  uint32_t type = llvm::support::endian::read32le(region.data() + 8);
+  uint64_t desc_offset = 12 + ((uint64_t(name_size) + 3) & ~UINT64_C(3));
+  if (type != llvm::ELF::NT_GNU_BUILD_ID ||
+      desc_offset + desc_size > region.size())
+    return llvm::StringRef();
+  return region.substr(desc_offset, desc_size);
 }
 
 }  // namespace mcld
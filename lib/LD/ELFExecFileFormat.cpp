@@ -9,6 +9,7 @@
 #include "mcld/LD/ELFExecFileFormat.h"
 #include "mcld/LD/LDSection.h"
 #include "mcld/Object/ObjectBuilder.h"
+#include "mcld/Support/ELF.h"
 
 #include <llvm/Support/ELF.h>
 
@@ -53,6 +54,11 @@ void ELFExecFileFormat::initObjectFormat(ObjectBuilder& pBuilder,
                                       llvm::ELF::SHT_RELA,
                                       llvm::ELF::SHF_ALLOC,
                                       pBitClass / 8);
+  f_pRelrDyn = pBuilder.CreateSection(".relr.dyn",
+                                      LDFileFormat::Relocation,
+                                      ELF::SHT_RELR,
+                                      llvm::ELF::SHF_ALLOC,
+                                      pBitClass / 8);
   f_pRelDyn = pBuilder.CreateSection(".rel.dyn",
                                      LDFileFormat::Relocation,
                                      llvm::ELF::SHT_REL,
@@ -90,6 +96,16 @@ void ELFExecFileFormat::initObjectFormat(ObjectBuilder& pBuilder,
                                          llvm::ELF::SHT_GNU_HASH,
                                          llvm::ELF::SHF_ALLOC,
                                          pBitClass / 8);
+  f_pBuildID = pBuilder.CreateSection(".note.gnu.build-id",
+                                      LDFileFormat::Note,
+                                      llvm::ELF::SHT_NOTE,
+                                      llvm::ELF::SHF_ALLOC,
+                                      0x4);
+  f_pGdbIndex = pBuilder.CreateSection(".gdb_index",
+                                       LDFileFormat::Note,
+                                       llvm::ELF::SHT_PROGBITS,
+                                       0x0,
+                                       0x4);
 }
 
 }  // namespace mcld
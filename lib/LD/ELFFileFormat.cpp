@@ -22,6 +22,7 @@ ELFFileFormat::ELFFileFormat()
       f_pRelPlt(NULL),
       f_pRelaDyn(NULL),
       f_pRelaPlt(NULL),
+      f_pRelrDyn(NULL),
       f_pComment(NULL),
       f_pData1(NULL),
       f_pDebug(NULL),
@@ -60,7 +61,9 @@ ELFFileFormat::ELFFileFormat()
       f_pStack(NULL),
       f_pStackNote(NULL),
       f_pDataRelRoLocal(NULL),
-      f_pGNUHashTab(NULL) {
+      f_pGNUHashTab(NULL),
+      f_pBuildID(NULL),
+      f_pGdbIndex(NULL) {
 }
 
 void ELFFileFormat::initStdSections(ObjectBuilder& pBuilder,
@@ -13,16 +13,22 @@
 #include "mcld/LD/ELFReader.h"
 #include "mcld/LD/EhFrameReader.h"
 #include "mcld/LD/EhFrame.h"
+#include "mcld/LD/InputCostReport.h"
 #include "mcld/LD/LDContext.h"
+#include "mcld/Fragment/RegionFragment.h"
 #include "mcld/Target/GNULDBackend.h"
+#include "mcld/Support/ELF.h"
 #include "mcld/Support/MsgHandling.h"
 #include "mcld/Support/MemoryArea.h"
+#include "mcld/Support/ThreadPool.h"
 #include "mcld/Object/ObjectBuilder.h"
 
 #include <llvm/Support/ELF.h>
 #include <llvm/ADT/Twine.h>
 #include <llvm/ADT/StringRef.h>
 
+#include <zlib.h>
+
 #include <string>
 #include <cassert>
 
@@ -92,6 +98,7 @@ bool ELFObjectReader::isMyFormat(Input& pInput, bool& pContinue) const {
 /// readHeader - read section header and create LDSections.
 bool ELFObjectReader::readHeader(Input& pInput) {
   assert(pInput.hasMemArea());
+  InputCostReport::Scope cost(pInput, InputCostReport::Read);
 
   size_t hdr_size = m_pELFReader->getELFHeaderSize();
   if (pInput.memArea()->size() < hdr_size)
@@ -101,55 +108,77 @@ bool ELFObjectReader::readHeader(Input& pInput) {
       pInput.memArea()->request(pInput.fileOffset(), hdr_size);
   const char* ELF_hdr = region.begin();
   m_Backend.mergeFlags(pInput, ELF_hdr);
-  bool result = m_pELFReader->readSectionHeaders(pInput, ELF_hdr);
-  return result;
+  if (!m_pELFReader->readSectionHeaders(pInput, ELF_hdr))
+    return false;
+
+  // --strip-debug and --strip-all drop the debug sections here, so that
+  // neither their contents nor their relocations are ever read, whatever
+  // the order of the sections.
+  if (m_Config.options().stripDebug()) {
+    LDContext::sect_iterator sect, sectEnd = pInput.context()->sectEnd();
+    for (sect = pInput.context()->sectBegin(); sect != sectEnd; ++sect) {
+      if (*sect != NULL && (LDFileFormat::Debug == (*sect)->kind() ||
+                            LDFileFormat::DebugString == (*sect)->kind()))
+        (*sect)->setKind(LDFileFormat::Ignore);
+    }
+  }
+  return true;
+}
+
+/// readGroup - the inputs are read one by one in the order of the command
+/// line, so the first input of a signature keeps its group.
+void ELFObjectReader::readGroup(Input& pInput, LDSection& pGroup) {
+  assert(pGroup.getLink() != NULL);
+  llvm::StringRef signature =
+      m_pELFReader->readSignature(pInput, *pGroup.getLink(), pGroup.getInfo());
+
+  // if the signature is a section symbol in input object, we use the section
+  // name as group signature.
+  bool exist = false;
+  if (signature.empty())
+    signatures().insert(pGroup.name(), exist);
+  else
+    signatures().insert(signature, exist);
+  if (!exist)
+    return;
+
+  // if this is not the first time we see this group signature, then ignore
+  // all the members in this group (set Ignore)
+  llvm::StringRef region = pInput.memArea()->request(
+      pInput.fileOffset() + pGroup.offset(), pGroup.size());
+  const llvm::ELF::Elf32_Word* value =
+      reinterpret_cast<const llvm::ELF::Elf32_Word*>(region.begin());
+
+  size_t size = region.size() / sizeof(llvm::ELF::Elf32_Word);
+  if (size == 0 || llvm::ELF::GRP_COMDAT != *value)
+    return;
+  for (size_t index = 1; index < size; ++index) {
+    LDSection* member = pInput.context()->getSection(value[index]);
+    if (member != NULL)
+      member->setKind(LDFileFormat::Ignore);
+  }
 }
 
 /// readSections - read all regular sections.
 bool ELFObjectReader::readSections(Input& pInput) {
-  // handle sections
+  InputCostReport::Scope cost(pInput, InputCostReport::Read);
+
+  // The groups are resolved before any section is read, so that the members
+  // of a discarded group are never read, even if they come before their
+  // group section.
   LDContext::sect_iterator section, sectEnd = pInput.context()->sectEnd();
+  for (section = pInput.context()->sectBegin(); section != sectEnd; ++section) {
+    if (*section != NULL && (*section)->kind() == LDFileFormat::Group)
+      readGroup(pInput, **section);
+  }
+
+  // handle sections
   for (section = pInput.context()->sectBegin(); section != sectEnd; ++section) {
     // ignore the section if the LDSection* in input context is NULL
     if (*section == NULL)
       continue;
 
     switch ((*section)->kind()) {
-      /** group sections **/
-      case LDFileFormat::Group: {
-        assert((*section)->getLink() != NULL);
-        ResolveInfo* signature = m_pELFReader->readSignature(
-            pInput, *(*section)->getLink(), (*section)->getInfo());
-
-        bool exist = false;
-        if (signature->nameSize() == 0 &&
-            ResolveInfo::Section == signature->type()) {
-          // if the signature is a section symbol in input object, we use the
-          // section name as group signature.
-          signatures().insert((*section)->name(), exist);
-        } else {
-          signatures().insert(signature->name(), exist);
-        }
-
-        if (exist) {
-          // if this is not the first time we see this group signature, then
-          // ignore all the members in this group (set Ignore)
-          llvm::StringRef region = pInput.memArea()->request(
-              pInput.fileOffset() + (*section)->offset(), (*section)->size());
-          const llvm::ELF::Elf32_Word* value =
-              reinterpret_cast<const llvm::ELF::Elf32_Word*>(region.begin());
-
-          size_t size = region.size() / sizeof(llvm::ELF::Elf32_Word);
-          if (llvm::ELF::GRP_COMDAT == *value) {
-            for (size_t index = 1; index < size; ++index) {
-              pInput.context()->getSection(value[index])->setKind(
-                  LDFileFormat::Ignore);
-            }
-          }
-        }
-        ResolveInfo::Destroy(signature);
-        break;
-      }
       /** linkonce sections **/
       case LDFileFormat::LinkOnce: {
         bool exist = false;
@@ -162,11 +191,8 @@ bool ELFObjectReader::readSections(Input& pInput) {
             (*section)->setKind(LDFileFormat::Debug);
             if (m_Config.options().stripDebug())
               (*section)->setKind(LDFileFormat::Ignore);
-            else {
-              SectionData* sd = IRBuilder::CreateSectionData(**section);
-              if (!m_pELFReader->readRegularSection(pInput, *sd))
-                fatal(diag::err_cannot_read_section) << (*section)->name();
-            }
+            else if (!readDebugSection(pInput, **section))
+              fatal(diag::err_cannot_read_section) << (*section)->name();
           } else {
             if (((*section)->flag() & llvm::ELF::SHF_EXECINSTR) != 0)
               (*section)->setKind(LDFileFormat::TEXT);
@@ -209,30 +235,20 @@ bool ELFObjectReader::readSections(Input& pInput) {
           fatal(diag::err_cannot_read_section) << (*section)->name();
         break;
       }
+      // the debug sections are already ignored under --strip-debug
       case LDFileFormat::Debug:
       case LDFileFormat::DebugString: {
-        if (m_Config.options().stripDebug()) {
-          (*section)->setKind(LDFileFormat::Ignore);
-        } else {
-          SectionData* sd = IRBuilder::CreateSectionData(**section);
-          if (!m_pELFReader->readRegularSection(pInput, *sd)) {
-            fatal(diag::err_cannot_read_section) << (*section)->name();
-          }
-        }
+        if (!readDebugSection(pInput, **section))
+          fatal(diag::err_cannot_read_section) << (*section)->name();
         break;
       }
       case LDFileFormat::EhFrame: {
         EhFrame* eh_frame = IRBuilder::CreateEhFrame(**section);
 
-        // We don't really parse EhFrame if this is a partial linking
-        if ((m_Config.codeGenType() != LinkerConfig::Object) &&
-            (m_ReadFlag & ParseEhFrame)) {
-          if (!m_pEhFrameReader->read<32, true>(pInput, *eh_frame)) {
-            // if we failed to parse a .eh_frame, we should not parse the rest
-            // .eh_frame.
-            m_ReadFlag ^= ParseEhFrame;
-          }
-        } else {
+        // We don't really parse EhFrame if this is a partial linking.
+        // Otherwise, it is parsed by readEhFrames.
+        if ((m_Config.codeGenType() == LinkerConfig::Object) ||
+            !(m_ReadFlag & ParseEhFrame)) {
           if (!m_pELFReader->readRegularSection(pInput,
                                                 *eh_frame->getSectionData())) {
             fatal(diag::err_cannot_read_section) << (*section)->name();
@@ -254,11 +270,18 @@ bool ELFObjectReader::readSections(Input& pInput) {
         break;
       }
       // ignore
+      case LDFileFormat::Group:
       case LDFileFormat::Null:
       case LDFileFormat::NamePool:
       case LDFileFormat::Ignore:
       case LDFileFormat::StackNote:
         continue;
+      // SHF_EXCLUDE sections, such as .llvm.call-graph-profile, are read by
+      // the linker itself. Their relocation sections follow them and are
+      // ignored with them.
+      case LDFileFormat::Exclude:
+        (*section)->setKind(LDFileFormat::Ignore);
+        continue;
       // warning
       case LDFileFormat::EhFrameHdr:
       default: {
@@ -272,10 +295,131 @@ bool ELFObjectReader::readSections(Input& pInput) {
   return true;
 }
 
+/// readDebugSection - read a debug section, and keep a compressed one to be
+/// inflated by decompressSections. The section is resized to its
+/// uncompressed content and is not SHF_COMPRESSED anymore, so that merging,
+/// relocating and emitting it see the plain content.
+bool ELFObjectReader::readDebugSection(Input& pInput, LDSection& pSection) {
+  SectionData* sd = IRBuilder::CreateSectionData(pSection);
+  if ((pSection.flag() & ELF::SHF_COMPRESSED) == 0)
+    return m_pELFReader->readRegularSection(pInput, *sd);
+
+  uint32_t type = 0x0;
+  uint64_t size = 0x0;
+  uint64_t align = 0x0;
+  size_t hdr_size = 0x0;
+  if (!m_pELFReader->readCompressionHeader(
+          pInput, pSection, type, size, align, hdr_size))
+    return false;
+  if (ELF::ELFCOMPRESS_ZLIB != type)
+    return false;
+
+  CompressedInput compressed;
+  compressed.input = &pInput;
+  compressed.section = &pSection;
+  compressed.data = pInput.memArea()->request(
+      pInput.fileOffset() + pSection.offset() + hdr_size,
+      pSection.size() - hdr_size);
+  compressed.buffer = m_DebugAllocator.Allocate<char>(size);
+  m_CompressedInputs.push_back(compressed);
+
+  pSection.setFlag(pSection.flag() & ~ELF::SHF_COMPRESSED);
+  pSection.setSize(size);
+  pSection.setAlign(align);
+  Fragment* frag =
+      new RegionFragment(llvm::StringRef(compressed.buffer, size));
+  ObjectBuilder::AppendFragment(*frag, *sd);
+  return true;
+}
+
+/// decompressSections - inflate the SHF_COMPRESSED debug sections. Only the
+/// sections that readSections kept are inflated, so the debug sections of
+/// ignored group members or of a stripped link are never decompressed.
+bool ELFObjectReader::decompressSections(ThreadPool& pPool) {
+  std::vector<uint8_t> failed(m_CompressedInputs.size(), 0);
+  parallelFor(pPool, 0, m_CompressedInputs.size(), [&](size_t pIndex) {
+    const CompressedInput& compressed = m_CompressedInputs[pIndex];
+    uLongf size = compressed.section->size();
+    int result = uncompress(
+        reinterpret_cast<Bytef*>(compressed.buffer),
+        &size,
+        reinterpret_cast<const Bytef*>(compressed.data.data()),
+        compressed.data.size());
+    if ((Z_OK != result) || (compressed.section->size() != size))
+      failed[pIndex] = 1;
+  });
+
+  // report in input order, not in the order the threads failed
+  bool result = true;
+  for (size_t i = 0; i < m_CompressedInputs.size(); ++i) {
+    if (failed[i] != 0) {
+      fatal(diag::err_cannot_decompress_section)
+          << m_CompressedInputs[i].section->name()
+          << m_CompressedInputs[i].input->path();
+      result = false;
+    }
+  }
+  m_CompressedInputs.clear();
+  return result;
+}
+
+/// readEhFrames - parse the .eh_frame sections which readSections left.
+bool ELFObjectReader::readEhFrames(Input& pInput) {
+  if ((m_Config.codeGenType() == LinkerConfig::Object) ||
+      !(m_ReadFlag & ParseEhFrame))
+    return true;
+
+  LDContext::sect_iterator section, sectEnd = pInput.context()->sectEnd();
+  for (section = pInput.context()->sectBegin(); section != sectEnd;
+       ++section) {
+    if ((LDFileFormat::EhFrame != (*section)->kind()) ||
+        !(*section)->hasEhFrame())
+      continue;
+
+    // If we failed to parse a .eh_frame, we just copy it to the output as it
+    // is.
+    EhFrame* eh_frame = (*section)->getEhFrame();
+    if (!m_pEhFrameReader->read<32, true>(pInput, *eh_frame)) {
+      eh_frame->clearRecords();
+      if (!m_pELFReader->readRegularSection(pInput,
+                                            *eh_frame->getSectionData())) {
+        fatal(diag::err_cannot_read_section) << (*section)->name();
+      }
+    }
+  }
+  return true;
+}
+
 /// readSymbols - read symbols from the input relocatable object.
 bool ELFObjectReader::readSymbols(Input& pInput) {
+  SymbolStage stage;
+  parseSymbols(pInput, stage);
+  return addSymbols(pInput, stage);
+}
+
+/// parseSymbols - decode the symbols of the input relocatable object.
+bool ELFObjectReader::parseSymbols(Input& pInput, SymbolStage& pStage) const {
   assert(pInput.hasMemArea());
+  InputCostReport::Scope cost(pInput, InputCostReport::Read);
+
+  // Diagnostics are not thread-safe. Missing tables are reported later by
+  // addSymbols.
+  LDSection* symtab_shdr = pInput.context()->getSection(".symtab");
+  if (symtab_shdr == NULL || symtab_shdr->getLink() == NULL)
+    return false;
+
+  LDSection* strtab_shdr = symtab_shdr->getLink();
+  llvm::StringRef symtab_region = pInput.memArea()->request(
+      pInput.fileOffset() + symtab_shdr->offset(), symtab_shdr->size());
+  llvm::StringRef strtab_region = pInput.memArea()->request(
+      pInput.fileOffset() + strtab_shdr->offset(), strtab_shdr->size());
+  const char* strtab = strtab_region.begin();
+  return m_pELFReader->parseSymbols(pInput, symtab_region, strtab, pStage);
+}
 
+/// addSymbols - add the decoded symbols of the input into the module.
+bool ELFObjectReader::addSymbols(Input& pInput, const SymbolStage& pStage) {
+  InputCostReport::Scope cost(pInput, InputCostReport::Resolve);
   LDSection* symtab_shdr = pInput.context()->getSection(".symtab");
   if (symtab_shdr == NULL) {
     note(diag::note_has_no_symtab) << pInput.name() << pInput.path()
@@ -283,57 +427,46 @@ bool ELFObjectReader::readSymbols(Input& pInput) {
     return true;
   }
 
-  LDSection* strtab_shdr = symtab_shdr->getLink();
-  if (strtab_shdr == NULL) {
+  if (symtab_shdr->getLink() == NULL) {
     fatal(diag::fatal_cannot_read_strtab) << pInput.name() << pInput.path()
                                           << ".symtab";
     return false;
   }
 
-  llvm::StringRef symtab_region = pInput.memArea()->request(
-      pInput.fileOffset() + symtab_shdr->offset(), symtab_shdr->size());
-  llvm::StringRef strtab_region = pInput.memArea()->request(
-      pInput.fileOffset() + strtab_shdr->offset(), strtab_shdr->size());
-  const char* strtab = strtab_region.begin();
-  bool result =
-      m_pELFReader->readSymbols(pInput, m_Builder, symtab_region, strtab);
-  return result;
+  return m_pELFReader->addSymbols(pInput, m_Builder, pStage);
 }
 
 bool ELFObjectReader::readRelocations(Input& pInput) {
-  assert(pInput.hasMemArea());
-
-  MemoryArea* mem = pInput.memArea();
+  InputCostReport::Scope cost(pInput, InputCostReport::Read);
   LDContext::sect_iterator rs, rsEnd = pInput.context()->relocSectEnd();
   for (rs = pInput.context()->relocSectBegin(); rs != rsEnd; ++rs) {
     if (LDFileFormat::Ignore == (*rs)->kind())
       continue;
 
-    uint32_t offset = pInput.fileOffset() + (*rs)->offset();
-    uint32_t size = (*rs)->size();
-    llvm::StringRef region = mem->request(offset, size);
-    IRBuilder::CreateRelocData(
-        **rs);  ///< create relocation data for the header
-    switch ((*rs)->type()) {
-      case llvm::ELF::SHT_RELA: {
-        if (!m_pELFReader->readRela(pInput, **rs, region)) {
-          return false;
-        }
-        break;
-      }
-      case llvm::ELF::SHT_REL: {
-        if (!m_pELFReader->readRel(pInput, **rs, region)) {
-          return false;
-        }
-        break;
-      }
-      default: {  ///< should not enter
-        return false;
-      }
-    }  // end of switch
+    if (!readRelocation(pInput, **rs))
+      return false;
   }  // end of for all relocation data
 
   return true;
 }
 
+bool ELFObjectReader::readRelocation(Input& pInput, LDSection& pRelocSect) {
+  assert(pInput.hasMemArea());
+
+  MemoryArea* mem = pInput.memArea();
+  uint32_t offset = pInput.fileOffset() + pRelocSect.offset();
+  uint32_t size = pRelocSect.size();
+  llvm::StringRef region = mem->request(offset, size);
+  IRBuilder::CreateRelocData(
+      pRelocSect);  ///< create relocation data for the header
+  switch (pRelocSect.type()) {
+    case llvm::ELF::SHT_RELA:
+      return m_pELFReader->readRela(pInput, pRelocSect, region);
+    case llvm::ELF::SHT_REL:
+      return m_pELFReader->readRel(pInput, pRelocSect, region);
+    default:  ///< should not enter
+      return false;
+  }  // end of switch
+}
+
 }  // namespace mcld
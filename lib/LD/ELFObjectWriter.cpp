@@ -22,21 +22,288 @@
 #include "mcld/LD/ELFFileFormat.h"
 #include "mcld/LD/ELFSegment.h"
 #include "mcld/LD/ELFSegmentFactory.h"
+#include "mcld/LD/LDContext.h"
 #include "mcld/LD/LDSection.h"
 #include "mcld/LD/LDSymbol.h"
 #include "mcld/LD/RelocData.h"
 #include "mcld/LD/SectionData.h"
+#include "mcld/MC/Input.h"
+#include "mcld/Support/ELF.h"
+#include "mcld/Support/FileOutputBuffer.h"
+#include "mcld/Support/MemoryArea.h"
 #include "mcld/Support/MsgHandling.h"
+#include "mcld/Support/ThreadPool.h"
 #include "mcld/Target/GNUInfo.h"
 #include "mcld/Target/GNULDBackend.h"
+#include "mcld/Target/OutputPackedRelocSection.h"
+#include "mcld/Target/OutputRelrSection.h"
 
+#include <llvm/ADT/DenseSet.h>
 #include <llvm/Support/Casting.h>
 #include <llvm/Support/ELF.h>
 #include <llvm/Support/Errc.h>
 #include <llvm/Support/ErrorHandling.h>
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+#include <utility>
+#include <vector>
+
 namespace mcld {
 
+/// kEmitChunkSize - the preferred size of a run of fragments written by one
+/// thread
+static const size_t kEmitChunkSize = 1 << 20;
+
+/// EmitChunk - a run of fragments of a section and its output region
+struct EmitChunk {
+  EmitChunk(SectionData::const_iterator pBegin,
+            SectionData::const_iterator pEnd,
+            MemoryRegion pRegion)
+      : begin(pBegin), end(pEnd), region(pRegion) {}
+
+  SectionData::const_iterator begin;
+  SectionData::const_iterator end;
+  MemoryRegion region;
+};
+
+/// kZeroPageSize - the unit in which the zero bytes of a region fragment are
+/// not copied into a zeroed output
+static const size_t kZeroPageSize = 4096;
+
+/// isZero - the pSize bytes at pData are all zeros
+static bool isZero(const char* pData, size_t pSize) {
+  return pSize == 0 ||
+         (pData[0] == 0 && std::memcmp(pData, pData + 1, pSize - 1) == 0);
+}
+
+/// copyRegion - copy pSize bytes from pFrom to pTo. If pTo is zeroed, the
+/// pages of pFrom which are all zeros are skipped, so that the large zero
+/// tables in .data leave the pages of the output clean.
+static void copyRegion(uint8_t* pTo,
+                       const char* pFrom,
+                       size_t pSize,
+                       bool pZeroed) {
+  if (!pZeroed || pSize < kZeroPageSize) {
+    std::memcpy(pTo, pFrom, pSize);
+    return;
+  }
+
+  size_t cur = 0;
+  while (cur < pSize) {
+    // a run ends at a page boundary of the output
+    uintptr_t to = reinterpret_cast<uintptr_t>(pTo + cur);
+    size_t length = std::min(pSize - cur, kZeroPageSize - to % kZeroPageSize);
+    if (!isZero(pFrom + cur, length))
+      std::memcpy(pTo + cur, pFrom + cur, length);
+    cur += length;
+  }
+}
+
+/// kCopyFileSize - the smallest region fragment copied from its input file
+/// rather than through the memory of the link
+static const size_t kCopyFileSize = 1 << 20;
+
+/// FileCopier - copy the large region fragments which are not relocated from
+/// the files of their inputs into the output by FileOutputBuffer::copyFile.
+class FileCopier {
+ public:
+  FileCopier(const Module& pModule, FileOutputBuffer& pOutput)
+      : m_Output(pOutput) {
+    Module::const_obj_iterator obj, objEnd = pModule.obj_end();
+    for (obj = pModule.obj_begin(); obj != objEnd; ++obj) {
+      if ((*obj)->hasMemArea() && !(*obj)->memArea()->path().empty()) {
+        MemoryArea* area = const_cast<MemoryArea*>((*obj)->memArea());
+        const char* begin = area->request(0, area->size()).data();
+        m_Areas.push_back(File(begin, begin + area->size(), area));
+      }
+
+      // the relocations are applied to the output after the sections are
+      // written, so their fragments must stay in memory
+      const LDContext* context = (*obj)->context();
+      if (context == NULL)
+        continue;
+      LDContext::const_sect_iterator rs, rsEnd = context->relocSectEnd();
+      for (rs = context->relocSectBegin(); rs != rsEnd; ++rs) {
+        if (*rs == NULL || !(*rs)->hasRelocData())
+          continue;
+        const RelocData* relocs = (*rs)->getRelocData();
+        RelocData::const_iterator reloc, relocEnd = relocs->end();
+        for (reloc = relocs->begin(); reloc != relocEnd; ++reloc)
+          m_Relocated.insert(reloc->targetRef().frag());
+      }
+    }
+    std::sort(m_Areas.begin(), m_Areas.end());
+  }
+
+  /// copy - copy pFragment to pTo of the output
+  /// @return false if pFragment has to be copied in memory
+  bool copy(const RegionFragment& pFragment, uint8_t* pTo) const {
+    llvm::StringRef region = pFragment.getRegion();
+    if (region.size() < kCopyFileSize || m_Relocated.count(&pFragment) != 0)
+      return false;
+
+    // the area which holds the region
+    std::vector<File>::const_iterator file = std::upper_bound(
+        m_Areas.begin(), m_Areas.end(), File(region.data(), NULL, NULL));
+    if (file == m_Areas.begin())
+      return false;
+    --file;
+    if (region.data() + region.size() > file->end)
+      return false;
+
+    return m_Output.copyFile(file->area->path(),
+                             region.data() - file->begin,
+                             pTo - m_Output.getBufferStart(),
+                             region.size());
+  }
+
+ private:
+  struct File {
+    File(const char* pBegin, const char* pEnd, const MemoryArea* pArea)
+        : begin(pBegin), end(pEnd), area(pArea) {}
+
+    bool operator<(const File& pOther) const {
+      return std::less<const char*>()(begin, pOther.begin);
+    }
+
+    const char* begin;
+    const char* end;
+    const MemoryArea* area;
+  };
+
+ private:
+  FileOutputBuffer& m_Output;
+  std::vector<File> m_Areas;
+  llvm::DenseSet<const Fragment*> m_Relocated;
+};
+
+/// fillPadding - fill the pSize bytes of padding at pTo, which is at the
+/// address pAddress. The padding of code is filled with the no-ops of
+/// pCodeTarget, and the other padding with zeros unless pTo is zeroed.
+static void fillPadding(uint8_t* pTo,
+                        uint64_t pAddress,
+                        size_t pSize,
+                        bool pZeroed,
+                        const GNULDBackend* pCodeTarget) {
+  if (pSize == 0)
+    return;
+  if (pCodeTarget != NULL &&
+      pCodeTarget->fillCodePadding(pTo, pAddress, pSize))
+    return;
+  if (!pZeroed)
+    std::memset(pTo, 0x0, pSize);
+}
+
+/// emitFragments - copy the fragments in [pBegin, pEnd) into pRegion, which
+/// starts at the offset of pBegin. The padding in front of the aligned
+/// fragments and at the end of pRegion is filled by fillPadding, with the
+/// no-ops of pCodeTarget if it is not NULL. If pZeroed, pRegion is already
+/// zeroed and the zero bytes are not written. The region fragments which
+/// pCopier copies from the files are not read at all.
+static void emitFragments(SectionData::const_iterator pBegin,
+                          SectionData::const_iterator pEnd,
+                          MemoryRegion pRegion,
+                          bool pZeroed,
+                          const FileCopier* pCopier,
+                          const GNULDBackend* pCodeTarget) {
+  if (pBegin == pEnd) {
+    fillPadding(pRegion.begin(), 0x0, pRegion.size(), pZeroed, NULL);
+    return;
+  }
+
+  uint64_t address = pBegin->getParent()->getSection().addr() +
+                     pBegin->getOffset();
+  SectionData::const_iterator fragIter;
+  size_t cur_offset = 0;
+  for (fragIter = pBegin; fragIter != pEnd; ++fragIter) {
+    if (fragIter != pBegin && fragIter->getAlign() > 1) {
+      size_t offset = fragIter->getOffset() - pBegin->getOffset();
+      fillPadding(pRegion.begin() + cur_offset, address + cur_offset,
+                  offset - cur_offset, pZeroed, pCodeTarget);
+      cur_offset = offset;
+    }
+
+    size_t size = fragIter->size();
+    switch (fragIter->getKind()) {
+      case Fragment::Region: {
+        const RegionFragment& region_frag =
+            llvm::cast<RegionFragment>(*fragIter);
+        if (pCopier != NULL &&
+            pCopier->copy(region_frag, pRegion.begin() + cur_offset))
+          break;
+        const char* from = region_frag.getRegion().begin();
+        copyRegion(pRegion.begin() + cur_offset, from, size, pZeroed);
+        break;
+      }
+      case Fragment::Alignment: {
+        // TODO: emit values with different sizes (> 1 byte), and emit nops
+        const AlignFragment& align_frag = llvm::cast<AlignFragment>(*fragIter);
+        uint64_t count = size / align_frag.getValueSize();
+        switch (align_frag.getValueSize()) {
+          case 1u:
+            if (align_frag.getValue() == 0x0) {
+              fillPadding(pRegion.begin() + cur_offset, address + cur_offset,
+                          count, pZeroed, pCodeTarget);
+              break;
+            }
+            std::memset(
+                pRegion.begin() + cur_offset, align_frag.getValue(), count);
+            break;
+          default:
+            llvm::report_fatal_error(
+                "unsupported value size for align fragment emission yet.\n");
+            break;
+        }
+        break;
+      }
+      case Fragment::Fillment: {
+        const FillFragment& fill_frag = llvm::cast<FillFragment>(*fragIter);
+        if (0 == size || 0 == fill_frag.getValueSize() ||
+            0 == fill_frag.size()) {
+          // ignore virtual fillment
+          break;
+        }
+        if (pZeroed && fill_frag.getValue() == 0x0)
+          break;
+
+        uint64_t num_tiles = fill_frag.size() / fill_frag.getValueSize();
+        for (uint64_t i = 0; i != num_tiles; ++i) {
+          std::memset(pRegion.begin() + cur_offset,
+                      fill_frag.getValue(),
+                      fill_frag.getValueSize());
+        }
+        break;
+      }
+      case Fragment::Stub: {
+        const Stub& stub_frag = llvm::cast<Stub>(*fragIter);
+        memcpy(pRegion.begin() + cur_offset, stub_frag.getContent(), size);
+        break;
+      }
+      case Fragment::Null: {
+        assert(0x0 == size);
+        break;
+      }
+      case Fragment::Target:
+        llvm::report_fatal_error(
+            "Target fragment should not be in a regular section.\n");
+        break;
+      default:
+        llvm::report_fatal_error(
+            "invalid fragment should not be in a regular section.\n");
+        break;
+    }
+    cur_offset += size;
+  }
+  if (cur_offset < pRegion.size()) {
+    fillPadding(pRegion.begin() + cur_offset, address + cur_offset,
+                pRegion.size() - cur_offset, pZeroed, pCodeTarget);
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // ELFObjectWriter
 //===----------------------------------------------------------------------===//
@@ -88,34 +355,149 @@ void ELFObjectWriter::writeSection(Module& pModule,
   }
 
   // Write out sections with data
-  switch (section->kind()) {
+  emitSectionContent(pModule, *section, region);
+}
+
+void ELFObjectWriter::emitSectionContent(Module& pModule,
+                                         LDSection& pSection,
+                                         MemoryRegion& pRegion) {
+  switch (pSection.kind()) {
     case LDFileFormat::GCCExceptTable:
     case LDFileFormat::TEXT:
     case LDFileFormat::DATA:
     case LDFileFormat::Debug:
     case LDFileFormat::Note:
-      emitSectionData(*section, region);
+      emitSectionData(pSection, pRegion);
       break;
     case LDFileFormat::EhFrame:
-      emitEhFrame(pModule, *section->getEhFrame(), region);
+      emitEhFrame(pModule, *pSection.getEhFrame(), pRegion);
       break;
     case LDFileFormat::Relocation:
       // sort relocation for the benefit of the dynamic linker.
-      target().sortRelocation(*section);
+      target().sortRelocation(pSection);
 
-      emitRelocation(m_Config, *section, region);
+      emitRelocation(m_Config, pSection, pRegion);
       break;
     case LDFileFormat::Target:
-      target().emitSectionData(*section, region);
+      target().emitSectionData(pSection, pRegion);
       break;
     case LDFileFormat::DebugString:
-      section->getDebugString()->emit(region);
+      pSection.getDebugString()->emit(pRegion);
       break;
     default:
       llvm_unreachable("invalid section kind");
   }
 }
 
+/// isPlainSection - check if the content of the section is only a copy of its
+/// fragments, so that it can be written without the help of the backend.
+static bool isPlainSection(const LDSection& pSection) {
+  switch (pSection.kind()) {
+    case LDFileFormat::Note:
+      return (pSection.getSectionData() != NULL);
+    case LDFileFormat::TEXT:
+    case LDFileFormat::DATA:
+    case LDFileFormat::Debug:
+    case LDFileFormat::GCCExceptTable:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/// isPartialRelocation - check if pSection is a .rel or .rela section of a
+/// relocatable output. sortRelocation leaves them as they are.
+static bool isPartialRelocation(const LinkerConfig& pConfig,
+                                const LDSection& pSection) {
+  if (LinkerConfig::Object != pConfig.codeGenType() ||
+      LDFileFormat::Relocation != pSection.kind() ||
+      !pSection.hasRelocData())
+    return false;
+  return (llvm::ELF::SHT_REL == pSection.type() ||
+          llvm::ELF::SHT_RELA == pSection.type());
+}
+
+/// addEmitChunks - split the fragments of a plain section into runs of about
+/// kEmitChunkSize bytes, so that a large section such as .text or .debug_info
+/// is written by several threads.
+static void addEmitChunks(const SectionData& pSD,
+                          MemoryRegion pRegion,
+                          std::vector<EmitChunk>& pChunks) {
+  SectionData::const_iterator begin = pSD.begin(), fragEnd = pSD.end();
+  size_t begin_offset = 0, cur_offset = 0;
+  for (SectionData::const_iterator frag = begin; frag != fragEnd; ++frag) {
+    if (frag->getAlign() > 1)
+      cur_offset = frag->getOffset();
+    if (cur_offset - begin_offset >= kEmitChunkSize) {
+      pChunks.push_back(EmitChunk(begin, frag,
+          pRegion.slice(begin_offset, cur_offset - begin_offset)));
+      begin = frag;
+      begin_offset = cur_offset;
+    }
+    cur_offset += frag->size();
+  }
+  if (begin != fragEnd) {
+    pChunks.push_back(EmitChunk(begin, fragEnd,
+        pRegion.slice(begin_offset, pRegion.size() - begin_offset)));
+  }
+}
+
+void ELFObjectWriter::writeSections(Module& pModule,
+                                    FileOutputBuffer& pOutput,
+                                    const std::vector<LDSection*>& pSections) {
+  // Sections which need the backend (relocations, target sections, .eh_frame
+  // and the merged strings) are written here. Plain sections only copy their
+  // fragments into disjoint ranges of the output, so they are chunked and
+  // written in parallel afterwards.
+  //
+  // The .rel and .rela sections of a relocatable output only encode their own
+  // relocations with the final symbol indices, so they are written in
+  // parallel as well. A partial link has many large ones, such as those of
+  // the debug sections.
+  std::vector<EmitChunk> chunks;
+  std::vector<std::pair<LDSection*, MemoryRegion> > relocs;
+  std::vector<LDSection*>::const_iterator sect, sectEnd = pSections.end();
+  for (sect = pSections.begin(); sect != sectEnd; ++sect) {
+    if (isPartialRelocation(m_Config, **sect)) {
+      MemoryRegion region = pOutput.request((*sect)->offset(), (*sect)->size());
+      if (region.size() != 0)
+        relocs.push_back(std::make_pair(*sect, region));
+      continue;
+    }
+
+    if (!isPlainSection(**sect)) {
+      writeSection(pModule, pOutput, *sect);
+      continue;
+    }
+
+    MemoryRegion region = pOutput.request((*sect)->offset(), (*sect)->size());
+    if (region.size() == 0)
+      continue;
+    addEmitChunks(*(*sect)->getSectionData(), region, chunks);
+  }
+
+  ThreadPool pool(m_Config.options().numThreads());
+  parallelFor(pool, 0, relocs.size(), [this, &relocs](size_t pIndex) {
+    emitRelocation(m_Config, *relocs[pIndex].first, relocs[pIndex].second);
+  });
+  bool zeroed = pOutput.isZeroed();
+  std::unique_ptr<FileCopier> copier;
+  if (pOutput.canCopyFile())
+    copier.reset(new FileCopier(pModule, pOutput));
+  const FileCopier* copier_ptr = copier.get();
+  const GNULDBackend* backend = &target();
+  parallelFor(pool, 0, chunks.size(),
+              [&chunks, zeroed, copier_ptr, backend](size_t pIndex) {
+    // the padding of code is executed when the code falls through it
+    const LDSection& section = chunks[pIndex].begin->getParent()->getSection();
+    const GNULDBackend* code_target = NULL;
+    if ((section.flag() & llvm::ELF::SHF_EXECINSTR) != 0)
+      code_target = backend;
+    emitFragments(chunks[pIndex].begin, chunks[pIndex].end,
+                  chunks[pIndex].region, zeroed, copier_ptr, code_target);
+  });
+}
+
 std::error_code ELFObjectWriter::writeObject(Module& pModule,
                                              FileOutputBuffer& pOutput) {
   bool is_dynobj = m_Config.codeGenType() == LinkerConfig::DynObj;
@@ -136,8 +518,17 @@ std::error_code ELFObjectWriter::writeObject(Module& pModule,
     target().emitDynNamePools(pModule, pOutput);
   }
 
-  if (is_object || is_dynobj || is_exec) {
-    // Write out name pool sections: .symtab, .strtab
+  // Write out name pool sections: .symtab, .strtab. They have their own range
+  // of the output and the symbol values are final, so they are written while
+  // the sections are copied. The relocations of a relocatable output refer to
+  // the .symtab indices, so it writes the symbols first.
+  std::future<void> reg_name_pools;
+  if ((is_dynobj || is_exec) && m_Config.options().numThreads() > 1) {
+    reg_name_pools =
+        std::async(std::launch::async, [this, &pModule, &pOutput]() {
+          target().emitRegNamePools(pModule, pOutput);
+        });
+  } else if (is_object || is_dynobj || is_exec) {
     target().emitRegNamePools(pModule, pOutput);
   }
 
@@ -145,18 +536,17 @@ std::error_code ELFObjectWriter::writeObject(Module& pModule,
     // Iterate over the loadable segments and write the corresponding sections
     ELFSegmentFactory::iterator seg, segEnd = target().elfSegmentTable().end();
 
+    std::vector<LDSection*> sections;
     for (seg = target().elfSegmentTable().begin(); seg != segEnd; ++seg) {
-      if (llvm::ELF::PT_LOAD == (*seg)->type()) {
-        ELFSegment::iterator sect, sectEnd = (*seg)->end();
-        for (sect = (*seg)->begin(); sect != sectEnd; ++sect)
-          writeSection(pModule, pOutput, *sect);
-      }
+      if (llvm::ELF::PT_LOAD == (*seg)->type())
+        sections.insert(sections.end(), (*seg)->begin(), (*seg)->end());
     }
+    writeSections(pModule, pOutput, sections);
   } else {
     // Write out regular ELF sections
-    Module::iterator sect, sectEnd = pModule.end();
-    for (sect = pModule.begin(); sect != sectEnd; ++sect)
-      writeSection(pModule, pOutput, *sect);
+    writeSections(pModule, pOutput, pModule.getSectionTable());
+    if (reg_name_pools.valid())
+      reg_name_pools.get();
 
     emitShStrTab(target().getOutputFormat()->getShStrTab(), pModule, pOutput);
 
@@ -469,6 +859,13 @@ void ELFObjectWriter::emitRelocation(const LinkerConfig& pConfig,
       fatal(diag::unsupported_bitclass) << pConfig.targets().triple().str()
                                         << pConfig.targets().bitclass();
     }
+  } else if (pSection.type() == ELF::SHT_RELR) {
+    assert(target().getRelrDyn() != NULL);
+    target().getRelrDyn()->emit(pRegion);
+  } else if (pSection.type() == ELF::SHT_ANDROID_REL ||
+             pSection.type() == ELF::SHT_ANDROID_RELA) {
+    assert(target().getPackedRelDyn() != NULL);
+    target().getPackedRelDyn()->emit(pRegion);
   } else
     llvm::report_fatal_error("unsupported relocation section type!");
 }
@@ -566,6 +963,7 @@ uint64_t ELFObjectWriter::getSectEntrySize(const LDSection& pSection) const {
   typedef typename ELFSizeTraits<SIZE>::Rel ElfXX_Rel;
   typedef typename ELFSizeTraits<SIZE>::Rela ElfXX_Rela;
   typedef typename ELFSizeTraits<SIZE>::Dyn ElfXX_Dyn;
+  typedef typename ELFSizeTraits<SIZE>::Addr ElfXX_Addr;
 
   if (llvm::ELF::SHT_DYNSYM == pSection.type() ||
       llvm::ELF::SHT_SYMTAB == pSection.type())
@@ -574,6 +972,11 @@ uint64_t ELFObjectWriter::getSectEntrySize(const LDSection& pSection) const {
     return sizeof(ElfXX_Rel);
   if (llvm::ELF::SHT_RELA == pSection.type())
     return sizeof(ElfXX_Rela);
+  if (ELF::SHT_RELR == pSection.type())
+    return sizeof(ElfXX_Addr);
+  if (ELF::SHT_ANDROID_REL == pSection.type() ||
+      ELF::SHT_ANDROID_RELA == pSection.type())
+    return 0x1;
   if (llvm::ELF::SHT_HASH == pSection.type() ||
       llvm::ELF::SHT_GNU_HASH == pSection.type())
     return sizeof(ElfXX_Word);
@@ -600,6 +1003,9 @@ uint64_t ELFObjectWriter::getSectLink(const LDSection& pSection,
   if (llvm::ELF::SHT_HASH == pSection.type() ||
       llvm::ELF::SHT_GNU_HASH == pSection.type())
     return target().getOutputFormat()->getDynSymTab().index();
+  if (ELF::SHT_ANDROID_REL == pSection.type() ||
+      ELF::SHT_ANDROID_RELA == pSection.type())
+    return target().getOutputFormat()->getDynSymTab().index();
   if (llvm::ELF::SHT_REL == pSection.type() ||
       llvm::ELF::SHT_RELA == pSection.type()) {
     if (LinkerConfig::Object == pConfig.codeGenType())
@@ -648,70 +1054,7 @@ uint64_t ELFObjectWriter::getLastStartOffset<64>(const Module& pModule) const {
 /// emitSectionData
 void ELFObjectWriter::emitSectionData(const SectionData& pSD,
                                       MemoryRegion& pRegion) const {
-  SectionData::const_iterator fragIter, fragEnd = pSD.end();
-  size_t cur_offset = 0;
-  for (fragIter = pSD.begin(); fragIter != fragEnd; ++fragIter) {
-    size_t size = fragIter->size();
-    switch (fragIter->getKind()) {
-      case Fragment::Region: {
-        const RegionFragment& region_frag =
-            llvm::cast<RegionFragment>(*fragIter);
-        const char* from = region_frag.getRegion().begin();
-        memcpy(pRegion.begin() + cur_offset, from, size);
-        break;
-      }
-      case Fragment::Alignment: {
-        // TODO: emit values with different sizes (> 1 byte), and emit nops
-        const AlignFragment& align_frag = llvm::cast<AlignFragment>(*fragIter);
-        uint64_t count = size / align_frag.getValueSize();
-        switch (align_frag.getValueSize()) {
-          case 1u:
-            std::memset(
-                pRegion.begin() + cur_offset, align_frag.getValue(), count);
-            break;
-          default:
-            llvm::report_fatal_error(
-                "unsupported value size for align fragment emission yet.\n");
-            break;
-        }
-        break;
-      }
-      case Fragment::Fillment: {
-        const FillFragment& fill_frag = llvm::cast<FillFragment>(*fragIter);
-        if (0 == size || 0 == fill_frag.getValueSize() ||
-            0 == fill_frag.size()) {
-          // ignore virtual fillment
-          break;
-        }
-
-        uint64_t num_tiles = fill_frag.size() / fill_frag.getValueSize();
-        for (uint64_t i = 0; i != num_tiles; ++i) {
-          std::memset(pRegion.begin() + cur_offset,
-                      fill_frag.getValue(),
-                      fill_frag.getValueSize());
-        }
-        break;
-      }
-      case Fragment::Stub: {
-        const Stub& stub_frag = llvm::cast<Stub>(*fragIter);
-        memcpy(pRegion.begin() + cur_offset, stub_frag.getContent(), size);
-        break;
-      }
-      case Fragment::Null: {
-        assert(0x0 == size);
-        break;
-      }
-      case Fragment::Target:
-        llvm::report_fatal_error(
-            "Target fragment should not be in a regular section.\n");
-        break;
-      default:
-        llvm::report_fatal_error(
-            "invalid fragment should not be in a regular section.\n");
-        break;
-    }
-    cur_offset += size;
-  }
+  emitFragments(pSD.begin(), pSD.end(), pRegion, false, NULL, NULL);
 }
 
 }  // namespace mcld
@@ -61,11 +61,39 @@ bool ELFReader<32, true>::readRegularSection(Input& pInput,
   return true;
 }
 
-/// readSymbols - read ELF symbols and create LDSymbol
-bool ELFReader<32, true>::readSymbols(Input& pInput,
-                                      IRBuilder& pBuilder,
-                                      llvm::StringRef pRegion,
-                                      const char* pStrTab) const {
+/// readCompressionHeader - read the ElfXX_Chdr of a compressed section
+bool ELFReader<32, true>::readCompressionHeader(Input& pInput,
+                                                const LDSection& pSection,
+                                                uint32_t& pType,
+                                                uint64_t& pSize,
+                                                uint64_t& pAlign,
+                                                size_t& pHeaderSize) const {
+  // Elf32_Chdr is {ch_type, ch_size, ch_addralign}
+  pHeaderSize = 12;
+  if (pSection.size() < pHeaderSize)
+    return false;
+
+  llvm::StringRef region = pInput.memArea()->request(
+      pInput.fileOffset() + pSection.offset(), pHeaderSize);
+  uint32_t fields[2];
+  std::memcpy(&pType, region.data(), 4);
+  std::memcpy(fields, region.data() + 4, sizeof(fields));
+  if (!llvm::sys::IsLittleEndianHost) {
+    pType = mcld::bswap32(pType);
+    fields[0] = mcld::bswap32(fields[0]);
+    fields[1] = mcld::bswap32(fields[1]);
+  }
+  pSize = fields[0];
+  pAlign = fields[1];
+  return true;
+}
+
+/// parseSymbols - decode ELF symbols into pStage
+bool ELFReader<32, true>::parseSymbols(
+    Input& pInput,
+    llvm::StringRef pRegion,
+    const char* pStrTab,
+    ObjectReader::SymbolStage& pStage) const {
   // get number of symbols
   size_t entsize = pRegion.size() / sizeof(llvm::ELF::Elf32_Sym);
   const llvm::ELF::Elf32_Sym* symtab =
@@ -79,11 +107,8 @@ bool ELFReader<32, true>::readSymbols(Input& pInput,
   uint16_t st_shndx = 0x0;
 
   // skip the first NULL symbol
-  pInput.context()->addSymbol(LDSymbol::Null());
-
-  /// recording symbols added from DynObj to analyze weak alias
-  std::vector<AliasInfo> potential_aliases;
-  bool is_dyn_obj = (pInput.type() == Input::DynObj);
+  if (entsize > 1)
+    pStage.reserve(entsize - 1);
   for (size_t idx = 1; idx < entsize; ++idx) {
     st_info = symtab[idx].st_info;
     st_other = symtab[idx].st_other;
@@ -108,92 +133,46 @@ bool ELFReader<32, true>::readSymbols(Input& pInput,
         st_shndx = llvm::ELF::SHN_UNDEF;
     }
 
+    pStage.push_back(ObjectReader::StagedSymbol());
+    ObjectReader::StagedSymbol& sym = pStage.back();
+
     // get ld_type
-    ResolveInfo::Type ld_type = getSymType(st_info, st_shndx);
+    sym.type = getSymType(st_info, st_shndx);
 
     // get ld_desc
-    ResolveInfo::Desc ld_desc = getSymDesc(st_shndx, pInput);
+    sym.desc = getSymDesc(st_shndx, pInput);
 
     // get ld_binding
-    ResolveInfo::Binding ld_binding =
-        getSymBinding((st_info >> 4), st_shndx, st_other);
+    sym.binding = getSymBinding((st_info >> 4), st_shndx, st_other);
 
     // get ld_value - ld_value must be section relative.
-    uint64_t ld_value = getSymValue(st_value, st_shndx, pInput);
+    sym.value = getSymValue(st_value, st_shndx, pInput);
 
     // get ld_vis
-    ResolveInfo::Visibility ld_vis = getSymVisibility(st_other);
+    sym.visibility = getSymVisibility(st_other);
+
+    sym.size = st_size;
 
     // get section
-    LDSection* section = NULL;
+    sym.section = NULL;
     if (st_shndx < llvm::ELF::SHN_LORESERVE)  // including ABS and COMMON
-      section = pInput.context()->getSection(st_shndx);
+      sym.section = pInput.context()->getSection(st_shndx);
 
     // get ld_name
-    std::string ld_name;
-    if (ResolveInfo::Section == ld_type) {
+    if (ResolveInfo::Section == sym.type) {
       // Section symbol's st_name is the section index.
-      assert(section != NULL && "get a invalid section");
-      ld_name = section->name();
+      assert(sym.section != NULL && "get a invalid section");
+      sym.name = sym.section->name();
     } else {
-      ld_name = std::string(pStrTab + st_name);
+      sym.name = llvm::StringRef(pStrTab + st_name);
     }
 
-    LDSymbol* psym = pBuilder.AddSymbol(pInput,
-                                        ld_name,
-                                        ld_type,
-                                        ld_desc,
-                                        ld_binding,
-                                        st_size,
-                                        ld_value,
-                                        section,
-                                        ld_vis);
-
-    if (is_dyn_obj && psym != NULL && ResolveInfo::Undefined != ld_desc &&
-        (ResolveInfo::Global == ld_binding ||
-         ResolveInfo::Weak == ld_binding) &&
-        ResolveInfo::Object == ld_type) {
-      AliasInfo p;
-      p.pt_alias = psym;
-      p.ld_binding = ld_binding;
-      p.ld_value = ld_value;
-      potential_aliases.push_back(p);
-    }
+    // hash the name here so that the decoding threads share the work
+    sym.hash = 0;
+    if (ResolveInfo::Local != sym.binding)
+      sym.hash = ResolveInfo::hasher()(sym.name);
   }  // end of for loop
 
-  // analyze weak alias
-  // FIXME: it is better to let IRBuilder handle alias anlysis.
-  //        1. eliminate code duplication
-  //        2. easy to know if a symbol is from .so
-  //           (so that it may be a potential alias)
-  if (is_dyn_obj) {
-    // sort symbols by symbol value and then weak before strong
-    std::sort(potential_aliases.begin(), potential_aliases.end(), less);
-
-    // for each weak symbol, find out all its aliases, and
-    // then link them as a circular list in Module
-    std::vector<AliasInfo>::iterator sym_it, sym_e;
-    sym_e = potential_aliases.end();
-    for (sym_it = potential_aliases.begin(); sym_it != sym_e; ++sym_it) {
-      if (ResolveInfo::Weak != sym_it->ld_binding)
-        continue;
-
-      Module& pModule = pBuilder.getModule();
-      std::vector<AliasInfo>::iterator alias_it = sym_it + 1;
-      while (alias_it != sym_e) {
-        if (sym_it->ld_value != alias_it->ld_value)
-          break;
-
-        if (sym_it + 1 == alias_it)
-          pModule.CreateAliasList(*sym_it->pt_alias->resolveInfo());
-        pModule.addAlias(*alias_it->pt_alias->resolveInfo());
-        ++alias_it;
-      }
-
-      sym_it = alias_it - 1;
-    }  // end of for loop
-  }
-
   return true;
 }
 
@@ -336,6 +315,7 @@ bool ELFReader<32, true>::readSectionHeaders(Input& pInput,
   uint32_t sh_link = 0x0;
   uint32_t sh_info = 0x0;
   uint32_t sh_addralign = 0x0;
+  uint32_t sh_entsize = 0x0;
 
   // if shnum and shstrtab overflow, the actual values are in the 1st shdr
   if (shnum == llvm::ELF::SHN_UNDEF || shstrtab == llvm::ELF::SHN_XINDEX) {
@@ -391,6 +371,7 @@ bool ELFReader<32, true>::readSectionHeaders(Input& pInput,
       sh_link = shdrTab[idx].sh_link;
       sh_info = shdrTab[idx].sh_info;
       sh_addralign = shdrTab[idx].sh_addralign;
+      sh_entsize = shdrTab[idx].sh_entsize;
     } else {
       sh_name = mcld::bswap32(shdrTab[idx].sh_name);
       sh_type = mcld::bswap32(shdrTab[idx].sh_type);
@@ -400,6 +381,7 @@ bool ELFReader<32, true>::readSectionHeaders(Input& pInput,
       sh_link = mcld::bswap32(shdrTab[idx].sh_link);
       sh_info = mcld::bswap32(shdrTab[idx].sh_info);
       sh_addralign = mcld::bswap32(shdrTab[idx].sh_addralign);
+      sh_entsize = mcld::bswap32(shdrTab[idx].sh_entsize);
     }
 
     LDSection* section = IRBuilder::CreateELFHeader(
@@ -407,6 +389,7 @@ bool ELFReader<32, true>::readSectionHeaders(Input& pInput,
     section->setSize(sh_size);
     section->setOffset(sh_offset);
     section->setInfo(sh_info);
+    section->setEntSize(sh_entsize);
 
     if (sh_link != 0x0 || sh_info != 0x0) {
       LinkInfo link_info = {section, sh_link, sh_info};
@@ -426,50 +409,37 @@ bool ELFReader<32, true>::readSectionHeaders(Input& pInput,
   return true;
 }
 
-/// readSignature - read a symbol from the given Input and index in symtab
-/// This is used to get the signature of a group section.
-ResolveInfo* ELFReader<32, true>::readSignature(Input& pInput,
-                                                LDSection& pSymTab,
-                                                uint32_t pSymIdx) const {
+/// readSignature - read the name of a symbol from the given Input and index
+/// in symtab. This is used to get the signature of a group section.
+llvm::StringRef ELFReader<32, true>::readSignature(Input& pInput,
+                                                   LDSection& pSymTab,
+                                                   uint32_t pSymIdx) const {
   LDSection* symtab = &pSymTab;
   LDSection* strtab = symtab->getLink();
   assert(symtab != NULL && strtab != NULL);
 
   uint32_t offset = pInput.fileOffset() + symtab->offset() +
-                    sizeof(llvm::ELF::Elf32_Sym) * pSymIdx;
+                  sizeof(llvm::ELF::Elf32_Sym) * pSymIdx;
   llvm::StringRef symbol_region =
       pInput.memArea()->request(offset, sizeof(llvm::ELF::Elf32_Sym));
   const llvm::ELF::Elf32_Sym* entry =
       reinterpret_cast<const llvm::ELF::Elf32_Sym*>(symbol_region.begin());
 
-  uint32_t st_name = 0x0;
-  uint8_t st_info = 0x0;
-  uint8_t st_other = 0x0;
-  uint16_t st_shndx = 0x0;
-  st_info = entry->st_info;
-  st_other = entry->st_other;
-  if (llvm::sys::IsLittleEndianHost) {
-    st_name = entry->st_name;
-    st_shndx = entry->st_shndx;
-  } else {
-    st_name = mcld::bswap32(entry->st_name);
-    st_shndx = mcld::bswap16(entry->st_shndx);
-  }
+  // a section symbol has no name of its own
+  if (llvm::ELF::STT_SECTION == (entry->st_info & 0xF))
+    return llvm::StringRef();
+
+  uint32_t st_name = entry->st_name;
+  if (!llvm::sys::IsLittleEndianHost)
+    st_name = mcld::bswap32(st_name);
 
   llvm::StringRef strtab_region = pInput.memArea()->request(
       pInput.fileOffset() + strtab->offset(), strtab->size());
+  if (st_name >= strtab_region.size())
+    return llvm::StringRef();
 
   // get ld_name
-  llvm::StringRef ld_name(strtab_region.begin() + st_name);
-
-  ResolveInfo* result = ResolveInfo::Create(ld_name);
-  result->setSource(pInput.type() == Input::DynObj);
-  result->setType(static_cast<ResolveInfo::Type>(st_info & 0xF));
-  result->setDesc(getSymDesc(st_shndx, pInput));
-  result->setBinding(getSymBinding((st_info >> 4), st_shndx, st_other));
-  result->setVisibility(getSymVisibility(st_other));
-
-  return result;
+  return llvm::StringRef(strtab_region.begin() + st_name);
 }
 
 /// readDynamic - read ELF .dynamic in input dynobj
@@ -561,11 +531,40 @@ bool ELFReader<64, true>::readRegularSection(Input& pInput,
   return true;
 }
 
-/// readSymbols - read ELF symbols and create LDSymbol
-bool ELFReader<64, true>::readSymbols(Input& pInput,
-                                      IRBuilder& pBuilder,
-                                      llvm::StringRef pRegion,
-                                      const char* pStrTab) const {
+/// readCompressionHeader - read the ElfXX_Chdr of a compressed section
+bool ELFReader<64, true>::readCompressionHeader(Input& pInput,
+                                                const LDSection& pSection,
+                                                uint32_t& pType,
+                                                uint64_t& pSize,
+                                                uint64_t& pAlign,
+                                                size_t& pHeaderSize) const {
+  // Elf64_Chdr is {ch_type, ch_reserved, ch_size,
+  // ch_addralign}
+  pHeaderSize = 24;
+  if (pSection.size() < pHeaderSize)
+    return false;
+
+  llvm::StringRef region = pInput.memArea()->request(
+      pInput.fileOffset() + pSection.offset(), pHeaderSize);
+  uint64_t fields[2];
+  std::memcpy(&pType, region.data(), 4);
+  std::memcpy(fields, region.data() + 8, sizeof(fields));
+  if (!llvm::sys::IsLittleEndianHost) {
+    pType = mcld::bswap32(pType);
+    fields[0] = mcld::bswap64(fields[0]);
+    fields[1] = mcld::bswap64(fields[1]);
+  }
+  pSize = fields[0];
+  pAlign = fields[1];
+  return true;
+}
+
+/// parseSymbols - decode ELF symbols into pStage
+bool ELFReader<64, true>::parseSymbols(
+    Input& pInput,
+    llvm::StringRef pRegion,
+    const char* pStrTab,
+    ObjectReader::SymbolStage& pStage) const {
   // get number of symbols
   size_t entsize = pRegion.size() / sizeof(llvm::ELF::Elf64_Sym);
   const llvm::ELF::Elf64_Sym* symtab =
@@ -579,11 +578,8 @@ bool ELFReader<64, true>::readSymbols(Input& pInput,
   uint16_t st_shndx = 0x0;
 
   // skip the first NULL symbol
-  pInput.context()->addSymbol(LDSymbol::Null());
-
-  /// recording symbols added from DynObj to analyze weak alias
-  std::vector<AliasInfo> potential_aliases;
-  bool is_dyn_obj = (pInput.type() == Input::DynObj);
+  if (entsize > 1)
+    pStage.reserve(entsize - 1);
   for (size_t idx = 1; idx < entsize; ++idx) {
     st_info = symtab[idx].st_info;
     st_other = symtab[idx].st_other;
@@ -608,87 +604,46 @@ bool ELFReader<64, true>::readSymbols(Input& pInput,
         st_shndx = llvm::ELF::SHN_UNDEF;
     }
 
+    pStage.push_back(ObjectReader::StagedSymbol());
+    ObjectReader::StagedSymbol& sym = pStage.back();
+
     // get ld_type
-    ResolveInfo::Type ld_type = getSymType(st_info, st_shndx);
+    sym.type = getSymType(st_info, st_shndx);
 
     // get ld_desc
-    ResolveInfo::Desc ld_desc = getSymDesc(st_shndx, pInput);
+    sym.desc = getSymDesc(st_shndx, pInput);
 
     // get ld_binding
-    ResolveInfo::Binding ld_binding =
-        getSymBinding((st_info >> 4), st_shndx, st_other);
+    sym.binding = getSymBinding((st_info >> 4), st_shndx, st_other);
 
     // get ld_value - ld_value must be section relative.
-    uint64_t ld_value = getSymValue(st_value, st_shndx, pInput);
+    sym.value = getSymValue(st_value, st_shndx, pInput);
 
     // get ld_vis
-    ResolveInfo::Visibility ld_vis = getSymVisibility(st_other);
+    sym.visibility = getSymVisibility(st_other);
+
+    sym.size = st_size;
 
     // get section
-    LDSection* section = NULL;
+    sym.section = NULL;
     if (st_shndx < llvm::ELF::SHN_LORESERVE)  // including ABS and COMMON
-      section = pInput.context()->getSection(st_shndx);
+      sym.section = pInput.context()->getSection(st_shndx);
 
     // get ld_name
-    std::string ld_name;
-    if (ResolveInfo::Section == ld_type) {
+    if (ResolveInfo::Section == sym.type) {
       // Section symbol's st_name is the section index.
-      assert(section != NULL && "get a invalid section");
-      ld_name = section->name();
+      assert(sym.section != NULL && "get a invalid section");
+      sym.name = sym.section->name();
     } else {
-      ld_name = std::string(pStrTab + st_name);
+      sym.name = llvm::StringRef(pStrTab + st_name);
     }
 
-    LDSymbol* psym = pBuilder.AddSymbol(pInput,
-                                        ld_name,
-                                        ld_type,
-                                        ld_desc,
-                                        ld_binding,
-                                        st_size,
-                                        ld_value,
-                                        section,
-                                        ld_vis);
-
-    if (is_dyn_obj && psym != NULL && ResolveInfo::Undefined != ld_desc &&
-        (ResolveInfo::Global == ld_binding ||
-         ResolveInfo::Weak == ld_binding) &&
-        ResolveInfo::Object == ld_type) {
-      AliasInfo p;
-      p.pt_alias = psym;
-      p.ld_binding = ld_binding;
-      p.ld_value = ld_value;
-      potential_aliases.push_back(p);
-    }
+    // hash the name here so that the decoding threads share the work
+    sym.hash = 0;
+    if (ResolveInfo::Local != sym.binding)
+      sym.hash = ResolveInfo::hasher()(sym.name);
   }  // end of for loop
 
-  // analyze weak alias here
-  if (is_dyn_obj) {
-    // sort symbols by symbol value and then weak before strong
-    std::sort(potential_aliases.begin(), potential_aliases.end(), less);
-
-    // for each weak symbol, find out all its aliases, and
-    // then link them as a circular list in Module
-    std::vector<AliasInfo>::iterator sym_it, sym_e;
-    sym_e = potential_aliases.end();
-    for (sym_it = potential_aliases.begin(); sym_it != sym_e; ++sym_it) {
-      if (ResolveInfo::Weak != sym_it->ld_binding)
-        continue;
-
-      Module& pModule = pBuilder.getModule();
-      std::vector<AliasInfo>::iterator alias_it = sym_it + 1;
-      while (alias_it != sym_e) {
-        if (sym_it->ld_value != alias_it->ld_value)
-          break;
-
-        if (sym_it + 1 == alias_it)
-          pModule.CreateAliasList(*sym_it->pt_alias->resolveInfo());
-        pModule.addAlias(*alias_it->pt_alias->resolveInfo());
-        ++alias_it;
-      }
-
-      sym_it = alias_it - 1;
-    }  // end of for loop
-  }
   return true;
 }
 
@@ -830,6 +785,7 @@ bool ELFReader<64, true>::readSectionHeaders(Input& pInput,
   uint32_t sh_link = 0x0;
   uint32_t sh_info = 0x0;
   uint64_t sh_addralign = 0x0;
+  uint64_t sh_entsize = 0x0;
 
   // if shnum and shstrtab overflow, the actual values are in the 1st shdr
   if (shnum == llvm::ELF::SHN_UNDEF || shstrtab == llvm::ELF::SHN_XINDEX) {
@@ -885,6 +841,7 @@ bool ELFReader<64, true>::readSectionHeaders(Input& pInput,
       sh_link = shdrTab[idx].sh_link;
       sh_info = shdrTab[idx].sh_info;
       sh_addralign = shdrTab[idx].sh_addralign;
+      sh_entsize = shdrTab[idx].sh_entsize;
     } else {
       sh_name = mcld::bswap32(shdrTab[idx].sh_name);
       sh_type = mcld::bswap32(shdrTab[idx].sh_type);
@@ -894,6 +851,7 @@ bool ELFReader<64, true>::readSectionHeaders(Input& pInput,
       sh_link = mcld::bswap32(shdrTab[idx].sh_link);
       sh_info = mcld::bswap32(shdrTab[idx].sh_info);
       sh_addralign = mcld::bswap64(shdrTab[idx].sh_addralign);
+      sh_entsize = mcld::bswap64(shdrTab[idx].sh_entsize);
     }
 
     LDSection* section = IRBuilder::CreateELFHeader(
@@ -901,6 +859,7 @@ bool ELFReader<64, true>::readSectionHeaders(Input& pInput,
     section->setSize(sh_size);
     section->setOffset(sh_offset);
     section->setInfo(sh_info);
+    section->setEntSize(sh_entsize);
 
     if (sh_link != 0x0 || sh_info != 0x0) {
       LinkInfo link_info = {section, sh_link, sh_info};
@@ -920,50 +879,37 @@ bool ELFReader<64, true>::readSectionHeaders(Input& pInput,
   return true;
 }
 
-/// readSignature - read a symbol from the given Input and index in symtab
-/// This is used to get the signature of a group section.
-ResolveInfo* ELFReader<64, true>::readSignature(Input& pInput,
-                                                LDSection& pSymTab,
-                                                uint32_t pSymIdx) const {
+/// readSignature - read the name of a symbol from the given Input and index
+/// in symtab. This is used to get the signature of a group section.
+llvm::StringRef ELFReader<64, true>::readSignature(Input& pInput,
+                                                   LDSection& pSymTab,
+                                                   uint32_t pSymIdx) const {
   LDSection* symtab = &pSymTab;
   LDSection* strtab = symtab->getLink();
   assert(symtab != NULL && strtab != NULL);
 
   uint64_t offset = pInput.fileOffset() + symtab->offset() +
-                    sizeof(llvm::ELF::Elf64_Sym) * pSymIdx;
+                  sizeof(llvm::ELF::Elf64_Sym) * pSymIdx;
   llvm::StringRef symbol_region =
       pInput.memArea()->request(offset, sizeof(llvm::ELF::Elf64_Sym));
   const llvm::ELF::Elf64_Sym* entry =
       reinterpret_cast<const llvm::ELF::Elf64_Sym*>(symbol_region.begin());
 
-  uint32_t st_name = 0x0;
-  uint8_t st_info = 0x0;
-  uint8_t st_other = 0x0;
-  uint16_t st_shndx = 0x0;
-  st_info = entry->st_info;
-  st_other = entry->st_other;
-  if (llvm::sys::IsLittleEndianHost) {
-    st_name = entry->st_name;
-    st_shndx = entry->st_shndx;
-  } else {
-    st_name = mcld::bswap32(entry->st_name);
-    st_shndx = mcld::bswap16(entry->st_shndx);
-  }
+  // a section symbol has no name of its own
+  if (llvm::ELF::STT_SECTION == (entry->st_info & 0xF))
+    return llvm::StringRef();
+
+  uint32_t st_name = entry->st_name;
+  if (!llvm::sys::IsLittleEndianHost)
+    st_name = mcld::bswap32(st_name);
 
   llvm::StringRef strtab_region = pInput.memArea()->request(
       pInput.fileOffset() + strtab->offset(), strtab->size());
+  if (st_name >= strtab_region.size())
+    return llvm::StringRef();
 
   // get ld_name
-  llvm::StringRef ld_name(strtab_region.begin() + st_name);
-
-  ResolveInfo* result = ResolveInfo::Create(ld_name);
-  result->setSource(pInput.type() == Input::DynObj);
-  result->setType(static_cast<ResolveInfo::Type>(st_info & 0xF));
-  result->setDesc(getSymDesc(st_shndx, pInput));
-  result->setBinding(getSymBinding((st_info >> 4), st_shndx, st_other));
-  result->setVisibility(getSymVisibility(st_other));
-
-  return result;
+  return llvm::StringRef(strtab_region.begin() + st_name);
 }
 
 /// readDynamic - read ELF .dynamic in input dynobj
@@ -9,9 +9,11 @@
 #include "mcld/LD/ELFReaderIf.h"
 
 #include "mcld/IRBuilder.h"
+#include "mcld/Module.h"
 #include "mcld/Fragment/FillFragment.h"
 #include "mcld/LD/EhFrame.h"
 #include "mcld/LD/LDContext.h"
+#include "mcld/LD/LDSymbol.h"
 #include "mcld/LD/SectionData.h"
 #include "mcld/Target/GNULDBackend.h"
 
@@ -20,13 +22,103 @@
 #include <llvm/Support/ELF.h>
 #include <llvm/Support/Host.h>
 
+#include <algorithm>
 #include <cstring>
+#include <vector>
 
 namespace mcld {
 
 //===----------------------------------------------------------------------===//
 // ELFReaderIF
 //===----------------------------------------------------------------------===//
+/// readSymbols - read ELF symbols and create LDSymbol
+bool ELFReaderIF::readSymbols(Input& pInput,
+                              IRBuilder& pBuilder,
+                              llvm::StringRef pRegion,
+                              const char* pStrTab) const {
+  ObjectReader::SymbolStage stage;
+  if (!parseSymbols(pInput, pRegion, pStrTab, stage))
+    return false;
+  return addSymbols(pInput, pBuilder, stage);
+}
+
+/// addSymbols - create LDSymbols for the symbols decoded by parseSymbols.
+bool ELFReaderIF::addSymbols(Input& pInput,
+                             IRBuilder& pBuilder,
+                             const ObjectReader::SymbolStage& pStage) const {
+  // skip the first NULL symbol
+  pInput.context()->addSymbol(LDSymbol::Null());
+  return appendSymbols(pInput, pBuilder, pStage);
+}
+
+/// appendSymbols - create LDSymbols for more symbols of pInput.
+bool ELFReaderIF::appendSymbols(Input& pInput,
+                                IRBuilder& pBuilder,
+                                const ObjectReader::SymbolStage& pStage) const {
+  /// recording symbols added from DynObj to analyze weak alias
+  std::vector<AliasInfo> potential_aliases;
+  bool is_dyn_obj = (pInput.type() == Input::DynObj);
+  ObjectReader::SymbolStage::const_iterator sym, symEnd = pStage.end();
+  for (sym = pStage.begin(); sym != symEnd; ++sym) {
+    LDSymbol* psym = pBuilder.AddSymbol(pInput,
+                                        sym->name,
+                                        sym->hash,
+                                        sym->type,
+                                        sym->desc,
+                                        sym->binding,
+                                        sym->size,
+                                        sym->value,
+                                        sym->section,
+                                        sym->visibility);
+
+    if (is_dyn_obj && psym != NULL && ResolveInfo::Undefined != sym->desc &&
+        (ResolveInfo::Global == sym->binding ||
+         ResolveInfo::Weak == sym->binding) &&
+        ResolveInfo::Object == sym->type) {
+      AliasInfo p;
+      p.pt_alias = psym;
+      p.ld_binding = sym->binding;
+      p.ld_value = sym->value;
+      potential_aliases.push_back(p);
+    }
+  }  // end of for loop
+
+  // analyze weak alias
+  // FIXME: it is better to let IRBuilder handle alias anlysis.
+  //        1. eliminate code duplication
+  //        2. easy to know if a symbol is from .so
+  //           (so that it may be a potential alias)
+  if (is_dyn_obj) {
+    // sort symbols by symbol value and then weak before strong
+    std::sort(potential_aliases.begin(), potential_aliases.end(), less);
+
+    // for each weak symbol, find out all its aliases, and
+    // then link them as a circular list in Module
+    std::vector<AliasInfo>::iterator sym_it, sym_e;
+    sym_e = potential_aliases.end();
+    for (sym_it = potential_aliases.begin(); sym_it != sym_e; ++sym_it) {
+      if (ResolveInfo::Weak != sym_it->ld_binding)
+        continue;
+
+      Module& pModule = pBuilder.getModule();
+      std::vector<AliasInfo>::iterator alias_it = sym_it + 1;
+      while (alias_it != sym_e) {
+        if (sym_it->ld_value != alias_it->ld_value)
+          break;
+
+        if (sym_it + 1 == alias_it)
+          pModule.CreateAliasList(*sym_it->pt_alias->resolveInfo());
+        pModule.addAlias(*alias_it->pt_alias->resolveInfo());
+        ++alias_it;
+      }
+
+      sym_it = alias_it - 1;
+    }  // end of for loop
+  }
+
+  return true;
+}
+
 /// getSymType
 ResolveInfo::Type ELFReaderIF::getSymType(uint8_t pInfo,
                                           uint16_t pShndx) const {
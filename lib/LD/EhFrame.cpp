@@ -21,12 +21,25 @@
 
 #include <llvm/Support/ManagedStatic.h>
 
+#include <algorithm>
+#include <string>
+#include <utility>
+
 namespace mcld {
 
 typedef GCFactory<EhFrame, MCLD_SECTIONS_PER_INPUT> EhFrameFactory;
 
 static llvm::ManagedStatic<EhFrameFactory> g_EhFrameFactory;
 
+/// getCIEKey - the contents that operator== compares. A symbol name never
+/// contains NUL, so the key is unique for each pair.
+static std::string getCIEKey(const EhFrame::CIE& pCIE) {
+  std::string key = pCIE.getPersonalityName();
+  key += '\0';
+  key += pCIE.getAugmentationData();
+  return key;
+}
+
 //===----------------------------------------------------------------------===//
 // EhFrame::Record
 //===----------------------------------------------------------------------===//
@@ -138,6 +151,7 @@ void EhFrame::addFragment(Fragment& pFrag) {
 
 void EhFrame::addCIE(EhFrame::CIE& pCIE, bool pAlsoAddFragment) {
   m_CIEs.push_back(&pCIE);
+  m_CIEIndex.insert(std::make_pair(getCIEKey(pCIE), &pCIE));
   if (pAlsoAddFragment)
     addFragment(pCIE);
 }
@@ -148,6 +162,22 @@ void EhFrame::addFDE(EhFrame::FDE& pFDE, bool pAlsoAddFragment) {
     addFragment(pFDE);
 }
 
+EhFrame::CIE* EhFrame::findCIE(const EhFrame::CIE& pCIE) const {
+  // The personality name of an input CIE is set up right before it is merged,
+  // so the keys of the merged CIEs are up to date.
+  llvm::StringMap<CIE*>::const_iterator it = m_CIEIndex.find(getCIEKey(pCIE));
+  if (it == m_CIEIndex.end())
+    return NULL;
+  return it->getValue();
+}
+
+void EhFrame::clearRecords() {
+  m_CIEs.clear();
+  m_FoundCIEs.clear();
+  m_CIEIndex.clear();
+  m_pSectionData->getFragmentList().clear();
+}
+
 size_t EhFrame::numOfFDEs() const {
   // FDE number only used by .eh_frame_hdr computation, and the number of CIE
   // is usually not too many. It is worthy to compromise space by time
@@ -182,24 +212,15 @@ EhFrame& EhFrame::merge(const Input& pInput, EhFrame& pFrame) {
   // Most CIE will be merged, so we don't reserve space first.
   for (cie_iterator i = pFrame.cie_begin(), e = pFrame.cie_end(); i != e; ++i) {
     CIE& input_cie = **i;
-    // CIE number is usually very few, so we just use vector sequential search.
-    if (!input_cie.getMergeable()) {
-      moveInputFragments(pFrame, input_cie);
-      addCIE(input_cie, /*AlsoAddFragment=*/false);
-      continue;
-    }
-
-    cie_iterator out_i = cie_begin();
-    for (cie_iterator out_e = cie_end(); out_i != out_e; ++out_i) {
-      CIE& output_cie = **out_i;
-      if (output_cie == input_cie) {
-        // This input CIE can be merged
-        moveInputFragments(pFrame, input_cie, &output_cie);
-        removeAndUpdateCIEForFDE(pFrame, input_cie, output_cie, rel_sec);
-        break;
-      }
-    }
-    if (out_i == cie_end()) {
+    CIE* output_cie = NULL;
+    if (input_cie.getMergeable())
+      output_cie = findCIE(input_cie);
+
+    if (output_cie != NULL) {
+      // This input CIE can be merged
+      moveInputFragments(pFrame, input_cie, output_cie);
+      removeAndUpdateCIEForFDE(pFrame, input_cie, *output_cie, rel_sec);
+    } else {
       moveInputFragments(pFrame, input_cie);
       addCIE(input_cie, /*AlsoAddFragment=*/false);
     }
@@ -208,9 +229,29 @@ EhFrame& EhFrame::merge(const Input& pInput, EhFrame& pFrame) {
 }
 
 void EhFrame::setupAttributes(const LDSection* rel_sec) {
+  // index the relocations once for all the CIEs and FDEs. The assemblers
+  // write them in order, so they are seldom sorted here.
+  RelocIndex relocs;
+  if (rel_sec != NULL) {
+    const RelocData* reloc_data = rel_sec->getRelocData();
+    for (RelocData::const_iterator ri = reloc_data->begin(),
+                                   re = reloc_data->end();
+         ri != re;
+         ++ri) {
+      Relocation& rel = const_cast<Relocation&>(*ri);
+      relocs.push_back(std::make_pair(rel.targetRef().getOutputOffset(), &rel));
+    }
+    auto byOffset = [](const std::pair<uint64_t, Relocation*>& pA,
+                       const std::pair<uint64_t, Relocation*>& pB) {
+      return pA.first < pB.first;
+    };
+    if (!std::is_sorted(relocs.begin(), relocs.end(), byOffset))
+      std::stable_sort(relocs.begin(), relocs.end(), byOffset);
+  }
+
   for (cie_iterator i = cie_begin(), e = cie_end(); i != e; ++i) {
     CIE* cie = *i;
-    removeDiscardedFDE(*cie, rel_sec);
+    removeDiscardedFDE(*cie, rel_sec, relocs);
 
     if (cie->getPersonalityName().size() == 0) {
       // There's no personality data encoding inside augmentation string.
@@ -222,19 +263,12 @@ void EhFrame::setupAttributes(const LDSection* rel_sec) {
                "PR name should be a symbol address or offset");
         continue;
       }
-      const RelocData* reloc_data = rel_sec->getRelocData();
-      for (RelocData::const_iterator ri = reloc_data->begin(),
-                                     re = reloc_data->end();
-           ri != re;
-           ++ri) {
-        const Relocation& rel = *ri;
-        if (rel.targetRef().getOutputOffset() ==
-            cie->getOffset() + cie->getPersonalityOffset()) {
-          cie->setMergeable();
-          cie->setPersonalityName(rel.symInfo()->outSymbol()->name());
-          cie->setRelocation(rel);
-          break;
-        }
+      const Relocation* rel =
+          findReloc(relocs, cie->getOffset() + cie->getPersonalityOffset());
+      if (rel != NULL) {
+        cie->setMergeable();
+        cie->setPersonalityName(rel->symInfo()->outSymbol()->name());
+        cie->setRelocation(*rel);
       }
 
       assert(cie->getPersonalityName() != "" &&
@@ -243,32 +277,41 @@ void EhFrame::setupAttributes(const LDSection* rel_sec) {
   }
 }
 
-void EhFrame::removeDiscardedFDE(CIE& pCIE, const LDSection* pRelocSect) {
+Relocation* EhFrame::findReloc(const RelocIndex& pRelocs, uint64_t pOffset) {
+  RelocIndex::const_iterator reloc = std::lower_bound(
+      pRelocs.begin(), pRelocs.end(),
+      std::make_pair(pOffset, static_cast<Relocation*>(NULL)),
+      [](const std::pair<uint64_t, Relocation*>& pA,
+         const std::pair<uint64_t, Relocation*>& pB) {
+        return pA.first < pB.first;
+      });
+  for (; reloc != pRelocs.end() && reloc->first == pOffset; ++reloc) {
+    if (reloc->second != NULL)
+      return reloc->second;
+  }
+  return NULL;
+}
+
+void EhFrame::removeDiscardedFDE(CIE& pCIE,
+                                 const LDSection* pRelocSect,
+                                 RelocIndex& pRelocs) {
   if (!pRelocSect)
     return;
 
   typedef std::vector<FDE*> FDERemoveList;
   FDERemoveList to_be_removed_fdes;
-  const RelocData* reloc_data = pRelocSect->getRelocData();
   for (fde_iterator i = pCIE.begin(), e = pCIE.end(); i != e; ++i) {
     FDE& fde = **i;
-    for (RelocData::const_iterator ri = reloc_data->begin(),
-                                   re = reloc_data->end();
-         ri != re;
-         ++ri) {
-      const Relocation& rel = *ri;
-      if (rel.targetRef().getOutputOffset() ==
-          fde.getOffset() + getDataStartOffset<32>()) {
-        bool has_section = rel.symInfo()->outSymbol()->hasFragRef();
-        if (!has_section)
-          // The section was discarded, just ignore this FDE.
-          // This may happen when redundant group section was read.
-          to_be_removed_fdes.push_back(&fde);
-        break;
-      }
+    const Relocation* rel =
+        findReloc(pRelocs, fde.getOffset() + getDataStartOffset<32>());
+    if (rel != NULL && !rel->symInfo()->outSymbol()->hasFragRef()) {
+      // The section was discarded, just ignore this FDE.
+      // This may happen when redundant group section was read.
+      to_be_removed_fdes.push_back(&fde);
     }
   }
 
+  RelocData* reloc_data = const_cast<RelocData*>(pRelocSect->getRelocData());
   for (FDERemoveList::iterator i = to_be_removed_fdes.begin(),
                                e = to_be_removed_fdes.end();
        i != e;
@@ -276,17 +319,21 @@ void EhFrame::removeDiscardedFDE(CIE& pCIE, const LDSection* pRelocSect) {
     FDE& fde = **i;
     fde.getCIE().remove(fde);
 
-    // FIXME: This traverses relocations from the beginning on each FDE, which
-    // may cause performance degration. Actually relocations will be sequential
-    // order, so we can bookkeep the previously found relocation for next use.
-    // Note: We must ensure FDE order is ordered.
-    for (RelocData::const_iterator ri = reloc_data->begin(),
-                                   re = reloc_data->end();
-         ri != re;) {
-      Relocation& rel = const_cast<Relocation&>(*ri++);
-      if (rel.targetRef().getOutputOffset() >= fde.getOffset() &&
-          rel.targetRef().getOutputOffset() < fde.getOffset() + fde.size()) {
-        const_cast<RelocData*>(reloc_data)->remove(rel);
+    // the relocations of the FDE are adjacent in the index
+    RelocIndex::iterator reloc = std::lower_bound(
+        pRelocs.begin(), pRelocs.end(),
+        std::make_pair(uint64_t(fde.getOffset()),
+                       static_cast<Relocation*>(NULL)),
+        [](const std::pair<uint64_t, Relocation*>& pA,
+           const std::pair<uint64_t, Relocation*>& pB) {
+          return pA.first < pB.first;
+        });
+    for (; reloc != pRelocs.end() &&
+           reloc->first < fde.getOffset() + fde.size();
+         ++reloc) {
+      if (reloc->second != NULL) {
+        reloc_data->remove(*reloc->second);
+        reloc->second = NULL;
       }
     }
   }
@@ -10,34 +10,113 @@
 
 #include "mcld/LD/EhFrame.h"
 #include "mcld/LD/LDSection.h"
+#include "mcld/Support/MsgHandling.h"
+#include "mcld/Support/ThreadPool.h"
 
 #include <llvm/Support/Dwarf.h>
 #include <llvm/Support/DataTypes.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <vector>
 
 namespace mcld {
 
 //===----------------------------------------------------------------------===//
 // Helper Function
 //===----------------------------------------------------------------------===//
-namespace bit32 {
+namespace {
 
-typedef std::pair<SizeTraits<32>::Address, SizeTraits<32>::Address> Entry;
+/// Entry - an entry of the binary search table
+template <size_t SIZE>
+struct Entry {
+  typename SizeTraits<SIZE>::Address pc;
+  typename SizeTraits<SIZE>::Address fde_addr;
+};
 
-bool EntryCompare(const Entry& pX, const Entry& pY) {
-  return (pX.first < pY.first);
-}
+}  // anonymous namespace
+
+/// radixSort - sort pTable by the pc of entries. Each pass distributes the
+/// entries by one byte of the pc. The pool sorts one slice of the table per
+/// thread, and the entries with the same pc keep their order.
+template <size_t SIZE>
+static void radixSort(std::vector<Entry<SIZE> >& pTable, ThreadPool& pPool) {
+  typedef std::vector<Entry<SIZE> > TableType;
+  const size_t num_buckets = 256;
+  size_t num_slices = std::min<size_t>(pPool.size(), pTable.size());
+  size_t slice = (pTable.size() + num_slices - 1) / num_slices;
+
+  TableType buffer(pTable.size());
+  std::vector<size_t> counts(num_slices * num_buckets);
+  for (unsigned shift = 0; shift < SIZE; shift += 8) {
+    std::fill(counts.begin(), counts.end(), 0);
+    parallelFor(pPool, 0, num_slices, [&](size_t pSlice) {
+      size_t* count = &counts[pSlice * num_buckets];
+      size_t end = std::min(pTable.size(), (pSlice + 1) * slice);
+      for (size_t i = pSlice * slice; i < end; ++i)
+        ++count[(pTable[i].pc >> shift) & 0xff];
+    });
 
-}  // namespace bit32
+    // Turn the counts into the output positions of each slice. Skip the
+    // pass if all entries have the same byte.
+    bool sorted = false;
+    size_t offset = 0;
+    for (size_t bucket = 0; bucket < num_buckets; ++bucket) {
+      size_t size = 0;
+      for (size_t i = 0; i < num_slices; ++i) {
+        size_t count = counts[i * num_buckets + bucket];
+        counts[i * num_buckets + bucket] = offset;
+        offset += count;
+        size += count;
+      }
+      if (size == pTable.size())
+        sorted = true;
+    }
+    if (sorted)
+      continue;
+
+    parallelFor(pPool, 0, num_slices, [&](size_t pSlice) {
+      size_t* pos = &counts[pSlice * num_buckets];
+      size_t end = std::min(pTable.size(), (pSlice + 1) * slice);
+      for (size_t i = pSlice * slice; i < end; ++i)
+        buffer[pos[(pTable[i].pc >> shift) & 0xff]++] = pTable[i];
+    });
+    pTable.swap(buffer);
+  }
+}
 
 //===----------------------------------------------------------------------===//
 // Template Specification Functions
 //===----------------------------------------------------------------------===//
 /// emitOutput<32> - write out eh_frame_hdr
 template <>
-void EhFrameHdr::emitOutput<32>(FileOutputBuffer& pOutput) {
+void EhFrameHdr::emitOutput<32>(FileOutputBuffer& pOutput, ThreadPool& pPool) {
+  doEmitOutput<32>(pOutput, pPool);
+}
+
+/// emitOutput<64> - write out eh_frame_hdr
+template <>
+void EhFrameHdr::emitOutput<64>(FileOutputBuffer& pOutput, ThreadPool& pPool) {
+  doEmitOutput<64>(pOutput, pPool);
+}
+
+//===----------------------------------------------------------------------===//
+// EhFrameHdr
+//===----------------------------------------------------------------------===//
+
+EhFrameHdr::EhFrameHdr(LDSection& pEhFrameHdr, const LDSection& pEhFrame)
+    : m_EhFrameHdr(pEhFrameHdr), m_EhFrame(pEhFrame) {
+}
+
+EhFrameHdr::~EhFrameHdr() {
+}
+
+/// doEmitOutput - write out eh_frame_hdr of a SIZE-bit output
+template <size_t SIZE>
+void EhFrameHdr::doEmitOutput(FileOutputBuffer& pOutput, ThreadPool& pPool) {
+  typedef typename SizeTraits<SIZE>::Address Address;
+
   MemoryRegion ehframehdr_region =
       pOutput.request(m_EhFrameHdr.offset(), m_EhFrameHdr.size());
 
@@ -51,8 +130,8 @@ void EhFrameHdr::emitOutput<32>(FileOutputBuffer& pOutput) {
   data[1] = llvm::dwarf::DW_EH_PE_pcrel | llvm::dwarf::DW_EH_PE_sdata4;
 
   // eh_frame_ptr
-  uint32_t* eh_frame_ptr = reinterpret_cast<uint32_t*>(data + 4);
-  *eh_frame_ptr = m_EhFrame.addr() - (m_EhFrameHdr.addr() + 4);
+  int32_t* eh_frame_ptr = reinterpret_cast<int32_t*>(data + 4);
+  *eh_frame_ptr = getSData4<SIZE>(m_EhFrame.addr(), m_EhFrameHdr.addr() + 4);
 
   // fde_count
   uint32_t* fde_count = reinterpret_cast<uint32_t*>(data + 8);
@@ -66,57 +145,60 @@ void EhFrameHdr::emitOutput<32>(FileOutputBuffer& pOutput) {
     data[2] = llvm::dwarf::DW_EH_PE_omit;
     // table_enc
     data[3] = llvm::dwarf::DW_EH_PE_omit;
-  } else {
-    // fde_count_enc
-    data[2] = llvm::dwarf::DW_EH_PE_udata4;
-    // table_enc
-    data[3] = llvm::dwarf::DW_EH_PE_datarel | llvm::dwarf::DW_EH_PE_sdata4;
-
-    // prepare the binary search table
-    typedef std::vector<bit32::Entry> SearchTableType;
-    SearchTableType search_table;
-
-    for (EhFrame::const_cie_iterator i = m_EhFrame.getEhFrame()->cie_begin(),
-                                     e = m_EhFrame.getEhFrame()->cie_end();
-         i != e;
-         ++i) {
-      EhFrame::CIE& cie = **i;
-      for (EhFrame::const_fde_iterator fi = cie.begin(), fe = cie.end();
-           fi != fe;
-           ++fi) {
-        EhFrame::FDE& fde = **fi;
-        SizeTraits<32>::Offset offset;
-        SizeTraits<32>::Address fde_pc;
-        SizeTraits<32>::Address fde_addr;
-        offset = fde.getOffset();
-        fde_pc = computePCBegin(fde, ehframe_region);
-        fde_addr = m_EhFrame.addr() + offset;
-        search_table.push_back(std::make_pair(fde_pc, fde_addr));
-      }
-    }
+    return;
+  }
 
-    std::sort(search_table.begin(), search_table.end(), bit32::EntryCompare);
+  // fde_count_enc
+  data[2] = llvm::dwarf::DW_EH_PE_udata4;
+  // table_enc
+  data[3] = llvm::dwarf::DW_EH_PE_datarel | llvm::dwarf::DW_EH_PE_sdata4;
 
-    // write out the binary search table
-    uint32_t* bst = reinterpret_cast<uint32_t*>(data + 12);
-    SearchTableType::const_iterator entry, entry_end = search_table.end();
-    size_t id = 0;
-    for (entry = search_table.begin(); entry != entry_end; ++entry) {
-      bst[id++] = (*entry).first - m_EhFrameHdr.addr();
-      bst[id++] = (*entry).second - m_EhFrameHdr.addr();
-    }
+  // prepare the binary search table. Reading the pc of FDEs is independent
+  // of each other, so they are read in parallel.
+  std::vector<const EhFrame::FDE*> fdes;
+  fdes.reserve(*fde_count);
+  for (EhFrame::const_cie_iterator i = m_EhFrame.getEhFrame()->cie_begin(),
+                                   e = m_EhFrame.getEhFrame()->cie_end();
+       i != e;
+       ++i) {
+    const EhFrame::CIE& cie = **i;
+    fdes.insert(fdes.end(), cie.begin(), cie.end());
   }
-}
 
-//===----------------------------------------------------------------------===//
-// EhFrameHdr
-//===----------------------------------------------------------------------===//
+  std::vector<Entry<SIZE> > search_table(fdes.size());
+  parallelFor(pPool, 0, fdes.size(), [&](size_t pIndex) {
+    const EhFrame::FDE& fde = *fdes[pIndex];
+    search_table[pIndex].pc = computePCBegin<SIZE>(fde, ehframe_region);
+    search_table[pIndex].fde_addr = m_EhFrame.addr() + fde.getOffset();
+  });
 
-EhFrameHdr::EhFrameHdr(LDSection& pEhFrameHdr, const LDSection& pEhFrame)
-    : m_EhFrameHdr(pEhFrameHdr), m_EhFrame(pEhFrame) {
+  radixSort(search_table, pPool);
+
+  // The entries of the lowest and the highest pc bound all pc offsets in the
+  // table.
+  Address base = m_EhFrameHdr.addr();
+  getSData4<SIZE>(search_table.front().pc, base);
+  getSData4<SIZE>(search_table.back().pc, base);
+
+  // write out the binary search table
+  int32_t* bst = reinterpret_cast<int32_t*>(data + 12);
+  parallelFor(pPool, 0, search_table.size(), [&](size_t pIndex) {
+    bst[2 * pIndex] = static_cast<int32_t>(search_table[pIndex].pc - base);
+    bst[2 * pIndex + 1] =
+        static_cast<int32_t>(search_table[pIndex].fde_addr - base);
+  });
 }
 
-EhFrameHdr::~EhFrameHdr() {
+/// getSData4 - return pAddr - pBase as a DW_EH_PE_sdata4 value. The offsets
+/// in a 32-bit address space always fit.
+template <size_t SIZE>
+int32_t EhFrameHdr::getSData4(typename SizeTraits<SIZE>::Address pAddr,
+                              typename SizeTraits<SIZE>::Address pBase) const {
+  typedef typename SizeTraits<SIZE>::SWord SWord;
+  SWord value = static_cast<SWord>(pAddr - pBase);
+  if ((value < INT32_MIN) || (value > INT32_MAX))
+    error(diag::err_eh_frame_hdr_out_of_range) << pAddr << pBase;
+  return static_cast<int32_t>(value);
 }
 
 /// @ref lsb core generic 4.1
@@ -138,14 +220,17 @@ void EhFrameHdr::sizeOutput() {
 }
 
 /// computePCBegin - return the address of FDE's pc
-uint32_t EhFrameHdr::computePCBegin(const EhFrame::FDE& pFDE,
-                                    const MemoryRegion& pEhFrameRegion) {
+template <size_t SIZE>
+typename SizeTraits<SIZE>::Address EhFrameHdr::computePCBegin(
+    const EhFrame::FDE& pFDE,
+    const MemoryRegion& pEhFrameRegion) const {
   uint8_t fde_encoding = pFDE.getCIE().getFDEEncode();
   unsigned int eh_value = fde_encoding & 0x7;
 
   // check the size to read in
   if (eh_value == llvm::dwarf::DW_EH_PE_absptr) {
-    eh_value = llvm::dwarf::DW_EH_PE_udata4;
+    eh_value = (SIZE == 64) ? llvm::dwarf::DW_EH_PE_udata8
+                            : llvm::dwarf::DW_EH_PE_udata4;
   }
 
   size_t pc_size = 0x0;
@@ -164,15 +249,20 @@ uint32_t EhFrameHdr::computePCBegin(const EhFrame::FDE& pFDE,
       break;
   }
 
-  SizeTraits<32>::Address pc = 0x0;
+  typename SizeTraits<SIZE>::Address pc = 0x0;
+  if (pc_size > sizeof(pc))
+    pc_size = sizeof(pc);
   const uint8_t* offset = (const uint8_t*)pEhFrameRegion.begin() +
                           pFDE.getOffset() + EhFrame::getDataStartOffset<32>();
   std::memcpy(&pc, offset, pc_size);
 
   // adjust the signed value
   bool is_signed = (fde_encoding & llvm::dwarf::DW_EH_PE_signed) != 0x0;
-  if (llvm::dwarf::DW_EH_PE_udata2 == eh_value && is_signed)
-    pc = (pc ^ 0x8000) - 0x8000;
+  if (is_signed && (pc_size != 0) && (pc_size < sizeof(pc))) {
+    typename SizeTraits<SIZE>::Address sign = 1;
+    sign <<= 8 * pc_size - 1;
+    pc = (pc ^ sign) - sign;
+  }
 
   // handle eh application
   switch (fde_encoding & 0x70) {
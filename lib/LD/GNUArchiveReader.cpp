@@ -21,15 +21,68 @@
 #include "mcld/Support/MemoryArea.h"
 #include "mcld/Support/MsgHandling.h"
 #include "mcld/Support/Path.h"
+#include "mcld/Support/ThreadPool.h"
 
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
 #include <llvm/ADT/StringRef.h>
+#include <llvm/ADT/StringSet.h>
 #include <llvm/Support/Host.h>
 
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 
 namespace mcld {
 
+//===----------------------------------------------------------------------===//
+// Helper Functions
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// getThinMemberName - the name of a member of a thin archive, whose header
+/// names it by pNameField in the strtab of pArchiveRoot. The offset of the
+/// member in its nested archive, if any, is returned in pNestedOffset.
+std::string getThinMemberName(const Archive& pArchiveRoot,
+                              llvm::StringRef pNameField,
+                              uint32_t& pNestedOffset) {
+  size_t begin = 1;
+  size_t end = pNameField.find_first_of(" :");
+  uint32_t name_offset = 0;
+  // parse the name offset
+  pNameField.substr(begin, end - begin).getAsInteger(10, name_offset);
+
+  if (pNameField[end] == ':') {
+    // there is a nested offset
+    begin = end + 1;
+    end = pNameField.find_first_of(' ', begin);
+    pNameField.substr(begin, end - begin).getAsInteger(10, pNestedOffset);
+  }
+
+  // get the member name from the extended name table
+  assert(pArchiveRoot.hasStrTable());
+  begin = name_offset;
+  end = pArchiveRoot.getStrTable().find_first_of('\n', begin);
+  return pArchiveRoot.getStrTable().substr(begin, end - begin - 1);
+}
+
+/// getThinMemberPath - the path of the member pName of the thin archive
+/// pArchiveFile. The name of a member is relative to its archive.
+sys::fs::Path getThinMemberPath(const Input& pArchiveFile,
+                                const std::string& pName) {
+  sys::fs::Path input_path(pArchiveFile.path().parent_path());
+  if (!input_path.empty())
+    input_path.append(sys::fs::Path(pName));
+  else
+    input_path.assign(pName);
+  return input_path;
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// GNUArchiveReader
+//===----------------------------------------------------------------------===//
 GNUArchiveReader::GNUArchiveReader(Module& pModule,
                                    ELFObjectReader& pELFObjectReader)
     : m_Module(pModule), m_ELFObjectReader(pELFObjectReader) {
@@ -96,6 +149,10 @@ bool GNUArchiveReader::readArchive(const LinkerConfig& pConfig,
     // read the symtab of the archive
     readSymbolTable(pArchive);
 
+    // the symtab lists every global symbol that the members may define
+    m_Module.getNamePool().reserve(m_Module.getNamePool().size() +
+                                   pArchive.numOfSymbols());
+
     // read the strtab of the archive
     readStringTable(pArchive);
 
@@ -105,33 +162,80 @@ bool GNUArchiveReader::readArchive(const LinkerConfig& pConfig,
                               &InputTree::Downward);
   }
 
-  // include the needed members in the archive and build up the input tree
+  // collect the symbols that we have not decided to include or not, and the
+  // symbols that the symtab lists for each member
+  std::vector<size_t> pending;
+  llvm::DenseMap<uint32_t, std::vector<size_t> > member_symbols;
+  for (size_t idx = 0; idx < pArchive.numOfSymbols(); ++idx) {
+    if (Archive::Symbol::Unknown == pArchive.getSymbolStatus(idx)) {
+      pending.push_back(idx);
+      member_symbols[pArchive.getObjFileOffset(idx)].push_back(idx);
+    }
+  }
+
+  // include the needed members in the archive and build up the input tree.
+  // Every round drops the decided symbols from the pending list, so later
+  // rounds only revisit symbols that are still unknown.
+  //
+  // The members of a round are read in order, and their symbol tables are
+  // decoded together on the pool and resolved in the same order at the end
+  // of the round. A member defines every symbol the symtab lists for it, so
+  // the symbols defined by the earlier members of the round are excluded as
+  // if those members were already resolved. The undefined symbols of a
+  // member are only seen by the next round.
+  //
+  // The members of a round are all decided before the first of them is
+  // read, so the files of the members of a thin archive are opened together
+  // on the pool.
+  ThreadPool pool(pConfig.options().numThreads());
+  bool isThinAR = isThinArchive(pArchive.getARFile());
+  std::vector<Input*> staged;
   bool willSymResolved;
   do {
     willSymResolved = false;
-    for (size_t idx = 0; idx < pArchive.numOfSymbols(); ++idx) {
-      // bypass if we already decided to include this symbol or not
-      if (Archive::Symbol::Unknown != pArchive.getSymbolStatus(idx))
-        continue;
+    llvm::StringSet<> defined;
+    std::vector<uint32_t> members;
+    llvm::DenseSet<uint32_t> chosen;
+    std::vector<size_t>::iterator sym, symEnd = pending.end();
+    std::vector<size_t>::iterator unknown = pending.begin();
+    for (sym = pending.begin(); sym != symEnd; ++sym) {
+      size_t idx = *sym;
 
       // bypass if another symbol with the same object file offset is included
-      if (pArchive.hasObjectMember(pArchive.getObjFileOffset(idx))) {
+      uint32_t offset = pArchive.getObjFileOffset(idx);
+      if (pArchive.hasObjectMember(offset) || chosen.count(offset) != 0) {
         pArchive.setSymbolStatus(idx, Archive::Symbol::Include);
         continue;
       }
 
       // check if we should include this defined symbol
-      Archive::Symbol::Status status =
-          shouldIncludeSymbol(pArchive.getSymbolName(idx));
-      if (Archive::Symbol::Unknown != status)
-        pArchive.setSymbolStatus(idx, status);
+      Archive::Symbol::Status status = Archive::Symbol::Exclude;
+      if (defined.count(pArchive.getSymbolName(idx)) == 0)
+        status = shouldIncludeSymbol(pArchive.getSymbolName(idx));
+      if (Archive::Symbol::Unknown == status) {
+        *unknown++ = idx;
+        continue;
+      }
+      pArchive.setSymbolStatus(idx, status);
 
       if (Archive::Symbol::Include == status) {
         // include the object member from the given offset
-        includeMember(pConfig, pArchive, pArchive.getObjFileOffset(idx));
+        members.push_back(offset);
+        chosen.insert(offset);
+        const std::vector<size_t>& symbols = member_symbols[offset];
+        for (size_t i = 0; i < symbols.size(); ++i)
+          defined.insert(pArchive.getSymbolName(symbols[i]));
         willSymResolved = true;
       }  // end of if
     }    // end of for
+    pending.erase(unknown, symEnd);
+
+    if (isThinAR && members.size() > 1)
+      prefetchMembers(pArchive, members, pool);
+    std::vector<uint32_t>::iterator member, memEnd = members.end();
+    for (member = members.begin(); member != memEnd; ++member)
+      includeMember(pConfig, pArchive, *member, &staged);
+    m_ELFObjectReader.addStagedSymbols(pool, m_Module.getNamePool(), staged);
   } while (willSymResolved);
 
   return true;
@@ -172,25 +276,7 @@ Input* GNUArchiveReader::readMemberHeader(Archive& pArchiveRoot,
     member_name.assign(name_field.substr(0, pos).str());
   } else {
     // this is an object/archive file in a thin archive
-    size_t begin = 1;
-    size_t end = name_field.find_first_of(" :");
-    uint32_t name_offset = 0;
-    // parse the name offset
-    name_field.substr(begin, end - begin).getAsInteger(10, name_offset);
-
-    if (name_field[end] == ':') {
-      // there is a nested offset
-      begin = end + 1;
-      end = name_field.find_first_of(' ', begin);
-      name_field.substr(begin, end - begin).getAsInteger(10, pNestedOffset);
-    }
-
-    // get the member name from the extended name table
-    assert(pArchiveRoot.hasStrTable());
-    begin = name_offset;
-    end = pArchiveRoot.getStrTable().find_first_of('\n', begin);
-    member_name.assign(
-        pArchiveRoot.getStrTable().substr(begin, end - begin - 1));
+    member_name = getThinMemberName(pArchiveRoot, name_field, pNestedOffset);
   }
 
   Input* member = NULL;
@@ -214,14 +300,11 @@ Input* GNUArchiveReader::readMemberHeader(Archive& pArchiveRoot,
 
     // get nested file path, the nested file's member name is the relative
     // path to the archive containing it.
-    sys::fs::Path input_path(pArchiveFile.path().parent_path());
-    if (!input_path.empty())
-      input_path.append(sys::fs::Path(member_name));
-    else
-      input_path.assign(member_name);
-
-    member = pArchiveRoot.getMemberFile(
-        pArchiveFile, isThinAR, member_name, input_path);
+    member = pArchiveRoot.getMemberFile(pArchiveFile,
+                                        isThinAR,
+                                        member_name,
+                                        getThinMemberPath(pArchiveFile,
+                                                          member_name));
   }
 
   return member;
@@ -245,13 +328,16 @@ static void readSymbolTableEntries(Archive& pArchive,
   ++data;
   const char* name = reinterpret_cast<const char*>(data + number);
 
-  // add the archive symbols
+  // add the archive symbols. The names are not copied, they refer to the
+  // armap in the memory area of the archive.
+  pArchive.reserveSymbols(number);
   for (Offset i = 0; i < number; ++i) {
+    llvm::StringRef sym_name(name);
     if (llvm::sys::IsLittleEndianHost)
-      pArchive.addSymbol(name, mcld::bswap<SIZE>(*data));
+      pArchive.addSymbol(sym_name, mcld::bswap<SIZE>(*data));
     else
-      pArchive.addSymbol(name, *data);
-    name += strlen(name) + 1;
+      pArchive.addSymbol(sym_name, *data);
+    name += sym_name.size() + 1;
     ++data;
   }
 }
@@ -341,6 +427,36 @@ enum Archive::Symbol::Status GNUArchiveReader::shouldIncludeSymbol(
   return Archive::Symbol::Unknown;
 }
 
+/// prefetchMembers - read the member files of the thin archive pArchive whose
+/// headers are at pOffsets on pPool, before they are included one by one
+void GNUArchiveReader::prefetchMembers(Archive& pArchive,
+                                       const std::vector<uint32_t>& pOffsets,
+                                       ThreadPool& pPool) {
+  Input& ar_file = pArchive.getARFile();
+  std::vector<sys::fs::Path> paths;
+  paths.reserve(pOffsets.size());
+  std::vector<uint32_t>::const_iterator offset, offEnd = pOffsets.end();
+  for (offset = pOffsets.begin(); offset != offEnd; ++offset) {
+    llvm::StringRef header_region = ar_file.memArea()->request(
+        ar_file.fileOffset() + *offset, sizeof(Archive::MemberHeader));
+    const Archive::MemberHeader* header =
+        reinterpret_cast<const Archive::MemberHeader*>(header_region.begin());
+    if (header->name[0] != '/')
+      continue;
+
+    // a nested archive opened before is not read again
+    uint32_t nested_offset = 0;
+    std::string member_name = getThinMemberName(
+        pArchive,
+        llvm::StringRef(header->name, sizeof(header->name)),
+        nested_offset);
+    if (pArchive.getArchiveMember(member_name) != NULL)
+      continue;
+    paths.push_back(getThinMemberPath(ar_file, member_name));
+  }
+  pArchive.prefetchMemberFiles(paths, pPool);
+}
+
 /// includeMember - include the object member in the given file offset, and
 /// return the size of the object
 /// @param pConfig - LinkerConfig
@@ -348,7 +464,8 @@ enum Archive::Symbol::Status GNUArchiveReader::shouldIncludeSymbol(
 /// @param pFileOffset  - file offset of the member header in the archive
 size_t GNUArchiveReader::includeMember(const LinkerConfig& pConfig,
                                        Archive& pArchive,
-                                       uint32_t pFileOffset) {
+                                       uint32_t pFileOffset,
+                                       std::vector<Input*>* pStaged) {
   Input* cur_archive = &(pArchive.getARFile());
   Input* member = NULL;
   uint32_t file_offset = pFileOffset;
@@ -389,7 +506,10 @@ size_t GNUArchiveReader::includeMember(const LinkerConfig& pConfig,
       pArchive.addObjectMember(pFileOffset, parent->lastPos);
       m_ELFObjectReader.readHeader(*member);
       m_ELFObjectReader.readSections(*member);
-      m_ELFObjectReader.readSymbols(*member);
+      if (pStaged != NULL)
+        pStaged->push_back(member);
+      else
+        m_ELFObjectReader.readSymbols(*member);
       m_Module.getObjectList().push_back(member);
     } else if (doContinue && isMyFormat(*member, doContinue)) {
       member->setType(Input::Archive);
@@ -432,10 +552,27 @@ bool GNUArchiveReader::includeAllMembers(const LinkerConfig& pConfig,
     begin_offset +=
         sizeof(Archive::MemberHeader) + pArchive.getStrTable().size();
   }
+  // Every member is included, so there is nothing to resolve against the
+  // armap. Walk the member headers in one pass, and decode the symbols of all
+  // members together afterwards, as it is done for the objects on the
+  // command line.
+  //
+  // The headers of a thin archive are back to back, so the member files are
+  // opened together on the pool first.
+  ThreadPool pool(pConfig.options().numThreads());
   uint32_t end_offset = pArchive.getARFile().memArea()->size();
+  if (isThinAR) {
+    std::vector<uint32_t> members;
+    for (uint32_t offset = begin_offset; offset < end_offset;
+         offset += sizeof(Archive::MemberHeader))
+      members.push_back(offset);
+    prefetchMembers(pArchive, members, pool);
+  }
+
+  std::vector<Input*> staged;
   for (uint32_t offset = begin_offset; offset < end_offset;
        offset += sizeof(Archive::MemberHeader)) {
-    size_t size = includeMember(pConfig, pArchive, offset);
+    size_t size = includeMember(pConfig, pArchive, offset, &staged);
 
     if (!isThinAR) {
       offset += size;
@@ -444,6 +581,8 @@ bool GNUArchiveReader::includeAllMembers(const LinkerConfig& pConfig,
     if ((offset & 1) != 0x0)
       ++offset;
   }
+
+  m_ELFObjectReader.addStagedSymbols(pool, m_Module.getNamePool(), staged);
   return true;
 }
 
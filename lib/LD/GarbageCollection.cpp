@@ -10,10 +10,12 @@
 
 #include "mcld/Fragment/Fragment.h"
 #include "mcld/Fragment/Relocation.h"
+#include "mcld/LD/InputCostReport.h"
 #include "mcld/LD/LDContext.h"
 #include "mcld/LD/LDFileFormat.h"
 #include "mcld/LD/LDSection.h"
 #include "mcld/LD/LDSymbol.h"
+#include "mcld/LD/ObjectReader.h"
 #include "mcld/LD/SectionData.h"
 #include "mcld/LD/RelocData.h"
 #include "mcld/LinkerConfig.h"
@@ -22,17 +24,9 @@
 #include "mcld/Support/MsgHandling.h"
 #include "mcld/Target/TargetLDBackend.h"
 
+#include <llvm/ADT/StringRef.h>
 #include <llvm/Support/Casting.h>
-
-#include <queue>
-#if !defined(MCLD_ON_WIN32)
-#include <fnmatch.h>
-#define fnmatch0(pattern, string) (fnmatch(pattern, string, 0) == 0)
-#else
-#include <windows.h>
-#include <shlwapi.h>
-#define fnmatch0(pattern, string) (PathMatchSpec(string, pattern) == true)
-#endif
+#include <llvm/Support/ELF.h>
 
 namespace mcld {
 
@@ -42,23 +36,31 @@ namespace mcld {
 // FIXME: these rules should be added into SectionMap, while currently adding to
 // SectionMap will cause the output order change in .text section and leads to
 // the .ARM.exidx order incorrect. We should sort the .ARM.exidx.
-static const char* pattern_to_keep[] = {".text*personality*",
-                                        ".data*personality*",
-                                        ".gnu.linkonce.d*personality*",
-                                        ".sdata*personality*"};
+//
+// The rules are the globs `<prefix>*personality*`. They are matched as a
+// prefix and a substring rather than by fnmatch, since every input section
+// is checked against all of them.
+static const char* prefix_to_keep[] = {".text",
+                                       ".data",
+                                       ".gnu.linkonce.d",
+                                       ".sdata"};
 
 /// shouldKeep - check the section name for the keep sections
-static bool shouldKeep(const std::string& pName) {
-  static const unsigned int pattern_size =
-      sizeof(pattern_to_keep) / sizeof(pattern_to_keep[0]);
-  for (unsigned int i = 0; i < pattern_size; ++i) {
-    if (fnmatch0(pattern_to_keep[i], pName.c_str()))
+static bool shouldKeep(llvm::StringRef pName) {
+  static const unsigned int prefix_size =
+      sizeof(prefix_to_keep) / sizeof(prefix_to_keep[0]);
+  if (pName.find("personality") == llvm::StringRef::npos)
+    return false;
+  for (unsigned int i = 0; i < prefix_size; ++i) {
+    llvm::StringRef prefix(prefix_to_keep[i]);
+    if (pName.startswith(prefix) &&
+        pName.find("personality", prefix.size()) != llvm::StringRef::npos)
       return true;
   }
   return false;
 }
 
-/// shouldProcessGC - check if the section kind is handled in GC
+/// mayProcessGC - check if the section kind is handled in GC
 static bool mayProcessGC(const LDSection& pSection) {
   if (pSection.kind() == LDFileFormat::TEXT ||
       pSection.kind() == LDFileFormat::DATA ||
@@ -74,7 +76,7 @@ static bool mayProcessGC(const LDSection& pSection) {
 void GarbageCollection::SectionReachedListMap::addReference(
     const LDSection& pFrom,
     const LDSection& pTo) {
-  m_ReachedSections[&pFrom].insert(&pTo);
+  m_ReachedSections[&pFrom].push_back(&pTo);
 }
 
 GarbageCollection::SectionListTy&
@@ -97,8 +99,12 @@ GarbageCollection::SectionReachedListMap::findReachedList(
 //===----------------------------------------------------------------------===//
 GarbageCollection::GarbageCollection(const LinkerConfig& pConfig,
                                      const TargetLDBackend& pBackend,
-                                     Module& pModule)
-    : m_Config(pConfig), m_Backend(pBackend), m_Module(pModule) {
+                                     Module& pModule,
+                                     ObjectReader& pObjectReader)
+    : m_Config(pConfig),
+      m_Backend(pBackend),
+      m_Module(pModule),
+      m_ObjectReader(pObjectReader) {
 }
 
 GarbageCollection::~GarbageCollection() {
@@ -122,62 +128,92 @@ bool GarbageCollection::run() {
   return true;
 }
 
+bool GarbageCollection::mayDeferRelocations(const LDSection& pSection) {
+  // target-specific section types may be handled by the backend, which needs
+  // their relocations before garbage collection starts
+  return mayProcessGC(pSection) &&
+         (pSection.type() == llvm::ELF::SHT_PROGBITS ||
+          pSection.type() == llvm::ELF::SHT_NOBITS);
+}
+
 void GarbageCollection::setUpReachedSections() {
   // traverse all the input relocations to setup the reached sections
   Module::obj_iterator input, inEnd = m_Module.obj_end();
   for (input = m_Module.obj_begin(); input != inEnd; ++input) {
+    InputCostReport::Scope cost(**input, InputCostReport::GC);
     LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
     for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
-      // bypass the discarded relocation section
-      // 1. its section kind is changed to Ignore. (The target section is a
-      // discarded group section.)
-      // 2. it has no reloc data. (All symbols in the input relocs are in the
-      // discarded group sections)
+      // bypass the discarded relocation section. Its section kind is changed
+      // to Ignore. (The target section is a discarded group section.)
       LDSection* reloc_sect = *rs;
       LDSection* apply_sect = reloc_sect->getLink();
-      if ((LDFileFormat::Ignore == reloc_sect->kind()) ||
-          (!reloc_sect->hasRelocData()))
+      if (LDFileFormat::Ignore == reloc_sect->kind())
         continue;
 
       // bypass the apply target sections which are not handled by gc
       if (!mayProcessGC(*apply_sect))
         continue;
 
-      bool add_first = false;
-      SectionListTy* reached_sects = NULL;
-      RelocData::iterator reloc_it, rEnd = reloc_sect->getRelocData()->end();
-      for (reloc_it = reloc_sect->getRelocData()->begin(); reloc_it != rEnd;
-           ++reloc_it) {
-        Relocation* reloc = llvm::cast<Relocation>(reloc_it);
-        ResolveInfo* sym = reloc->symInfo();
-        // only the target symbols defined in the input fragments can make the
-        // reference
-        if (sym == NULL)
-          continue;
-        if (!sym->isDefine() || !sym->outSymbol()->hasFragRef())
-          continue;
-
-        // only the target symbols defined in the concerned sections can make
-        // the reference
-        const LDSection* target_sect =
-            &sym->outSymbol()->fragRef()->frag()->getParent()->getSection();
-        if (!mayProcessGC(*target_sect))
-          continue;
-
-        // setup the reached list, if we first add the element to reached list
-        // of this section, create an entry in ReachedSections map
-        if (!add_first) {
-          reached_sects = &m_SectionReachedListMap.getReachedList(*apply_sect);
-          add_first = true;
+      // read the relocations later if the target section is reached
+      if (!reloc_sect->hasRelocData()) {
+        if (mayDeferRelocations(*apply_sect)) {
+          m_PendingRelocSections[apply_sect].push_back(
+              std::make_pair(*input, reloc_sect));
         }
-        reached_sects->insert(target_sect);
+        continue;
       }
-      reached_sects = NULL;
-      add_first = false;
+
+      addReachedSections(*reloc_sect);
     }
   }
 }
 
+void GarbageCollection::addReachedSections(const LDSection& pRelocSect) {
+  const LDSection* apply_sect = pRelocSect.getLink();
+  SectionListTy* reached_sects = NULL;
+  RelocData::const_iterator reloc_it, rEnd = pRelocSect.getRelocData()->end();
+  for (reloc_it = pRelocSect.getRelocData()->begin(); reloc_it != rEnd;
+       ++reloc_it) {
+    const Relocation* reloc = llvm::cast<Relocation>(reloc_it);
+    const ResolveInfo* sym = reloc->symInfo();
+    // only the target symbols defined in the input fragments can make the
+    // reference
+    if (sym == NULL)
+      continue;
+    if (!sym->isDefine() || !sym->outSymbol()->hasFragRef())
+      continue;
+
+    // only the target symbols defined in the concerned sections can make
+    // the reference
+    const LDSection* target_sect =
+        &sym->outSymbol()->fragRef()->frag()->getParent()->getSection();
+    if (!mayProcessGC(*target_sect))
+      continue;
+
+    // setup the reached list, if we first add the element to reached list
+    // of this section, create an entry in ReachedSections map
+    if (reached_sects == NULL)
+      reached_sects = &m_SectionReachedListMap.getReachedList(*apply_sect);
+    if (reached_sects->empty() || reached_sects->back() != target_sect)
+      reached_sects->push_back(target_sect);
+  }
+}
+
+void GarbageCollection::readPendingRelocations(const LDSection& pSection) {
+  PendingRelocSections::iterator pending =
+      m_PendingRelocSections.find(&pSection);
+  if (pending == m_PendingRelocSections.end())
+    return;
+
+  RelocSectionList::iterator rs, rsEnd = pending->second.end();
+  for (rs = pending->second.begin(); rs != rsEnd; ++rs) {
+    m_ObjectReader.readRelocation(*rs->first, *rs->second);
+    if (rs->second->hasRelocData())
+      addReachedSections(*rs->second);
+  }
+  m_PendingRelocSections.erase(pending);
+}
+
 void GarbageCollection::getEntrySections(SectionVecTy& pEntry) {
   // all the KEEP sections defined in ldscript are entries, traverse all the
   // input sections and check the SectionMap to find the KEEP sections
@@ -285,39 +321,35 @@ void GarbageCollection::getEntrySections(SectionVecTy& pEntry) {
 }
 
 void GarbageCollection::findReferencedSections(SectionVecTy& pEntry) {
-  // list of sections waiting to be processed
-  typedef std::queue<const LDSection*> WorkListTy;
-  WorkListTy work_list;
-  // start from each entry, resolve the transitive closure
+  // list of sections waiting to be processed. A section is marked referenced
+  // when it is put into the list, so that it is never put twice.
+  SectionVecTy work_list;
   SectionVecTy::iterator entry_it, entry_end = pEntry.end();
   for (entry_it = pEntry.begin(); entry_it != entry_end; ++entry_it) {
-    // add entry point to work list
-    work_list.push(*entry_it);
-
-    // add section from the work_list to the referencedSections until every
-    // reached sections are added
-    while (!work_list.empty()) {
-      const LDSection* sect = work_list.front();
-      work_list.pop();
-      // add section to the ReferencedSections, if the section has been put into
-      // referencedSections, skip this section
-      if (!m_ReferencedSections.insert(sect).second)
-        continue;
+    if (m_ReferencedSections.insert(*entry_it).second)
+      work_list.push_back(*entry_it);
+  }
 
-      // get the section reached list, if the section do not has one, which
-      // means no referenced between it and other sections, then skip it
-      SectionListTy* reach_list =
-          m_SectionReachedListMap.findReachedList(*sect);
-      if (reach_list == NULL)
-        continue;
+  // resolve the transitive closure of the entries
+  while (!work_list.empty()) {
+    const LDSection* sect = work_list.back();
+    work_list.pop_back();
 
-      // put the reached sections to work list, skip the one already be in
-      // referencedSections
-      SectionListTy::iterator it, end = reach_list->end();
-      for (it = reach_list->begin(); it != end; ++it) {
-        if (m_ReferencedSections.find(*it) == m_ReferencedSections.end())
-          work_list.push(*it);
-      }
+    // the references of the section are known once its relocations are read
+    readPendingRelocations(*sect);
+
+    // get the section reached list, if the section do not has one, which
+    // means no referenced between it and other sections, then skip it
+    SectionListTy* reach_list = m_SectionReachedListMap.findReachedList(*sect);
+    if (reach_list == NULL)
+      continue;
+
+    // put the reached sections to work list, skip the one already be in
+    // referencedSections
+    SectionListTy::iterator it, end = reach_list->end();
+    for (it = reach_list->begin(); it != end; ++it) {
+      if (m_ReferencedSections.insert(*it).second)
+        work_list.push_back(*it);
     }
   }
 }
@@ -333,7 +365,7 @@ void GarbageCollection::stripSections() {
       if (!mayProcessGC(*section))
         continue;
 
-      if (m_ReferencedSections.find(section) == m_ReferencedSections.end()) {
+      if (m_ReferencedSections.count(section) == 0) {
         section->setKind(LDFileFormat::Ignore);
         debug(diag::debug_print_gc_sections) << section->name()
                                              << (*obj)->name();
@@ -0,0 +1,506 @@
+//===- GdbIndex.cpp -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/GdbIndex.h"
+
+#include "mcld/Module.h"
+#include "mcld/Fragment/RegionFragment.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/LD/SectionData.h"
+#include "mcld/Support/FileOutputBuffer.h"
+#include "mcld/Support/ThreadPool.h"
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/Endian.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <utility>
+
+namespace mcld {
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+const uint32_t kVersion = 7;
+
+/// the size of the header, the version and five offsets
+const uint32_t kHeaderSize = 24;
+
+const uint32_t kNoUnit = ~0U;
+
+/// NameSection - a section of public names, and whether its entries have
+/// the GNU flags
+struct NameSection {
+  const char* name;
+  bool gnu;
+};
+
+const NameSection kNameSections[] = {
+    {".debug_gnu_pubnames", true},
+    {".debug_gnu_pubtypes", true},
+    {".debug_pubnames", false},
+    {".debug_pubtypes", false},
+};
+
+/// DW_UT_compile, DW_UT_partial and DW_UT_skeleton, the units of DWARF 5
+/// that the unit list holds
+const uint8_t kCompileUnit = 0x01;
+const uint8_t kPartialUnit = 0x03;
+const uint8_t kSkeletonUnit = 0x04;
+
+enum RegionKind { UnitRegion, RangeRegion, NameRegion, GNUNameRegion };
+
+/// DebugRegion - a region of a debug section, its offset in the section and
+/// the index of the section in the relocated sections
+struct DebugRegion {
+  uint64_t offset;
+  llvm::StringRef data;
+  RegionKind kind;
+  uint32_t section;
+};
+
+typedef std::vector<DebugRegion> RegionList;
+
+/// ParsedName - a name of the pSet-th set of a region
+struct ParsedName {
+  uint32_t set;
+  uint8_t flags;
+  llvm::StringRef name;
+};
+
+/// ParsedRegion - the units, the sets and the names read from a region
+struct ParsedRegion {
+  std::vector<std::pair<uint64_t, uint64_t> > units;
+  std::vector<std::pair<uint64_t, uint32_t> > sets;
+  std::vector<ParsedName> names;
+};
+
+uint64_t readWord(const char* pPlace, bool pIs64) {
+  if (pIs64)
+    return llvm::support::endian::read64le(pPlace);
+  return llvm::support::endian::read32le(pPlace);
+}
+
+/// readLength - the size of the unit or the set at pPos, including its
+/// initial length, or 0 if it does not fit in pData
+uint64_t readLength(llvm::StringRef pData, uint64_t pPos, bool& pIs64) {
+  if (pPos + 4 > pData.size())
+    return 0;
+  uint64_t length = llvm::support::endian::read32le(pData.data() + pPos);
+  uint64_t header = 4;
+  pIs64 = false;
+  if (length == 0xffffffff) {
+    if (pPos + 12 > pData.size())
+      return 0;
+    length = llvm::support::endian::read64le(pData.data() + pPos + 4);
+    header = 12;
+    pIs64 = true;
+  } else if (length >= 0xfffffff0) {
+    return 0;
+  }
+  if (length > pData.size() - pPos - header)
+    return 0;
+  return header + length;
+}
+
+/// readInfoOffset - the offset in .debug_info of the set at pPos. A set of
+/// names or of ranges starts with its length, a version and this offset.
+uint64_t readInfoOffset(llvm::StringRef pData, uint64_t pPos) {
+  bool is64 = false;
+  uint64_t size = readLength(pData, pPos, is64);
+  uint64_t offset = (is64 ? 12 : 4) + 2;
+  if (size < offset + (is64 ? 8 : 4))
+    return ~UINT64_C(0);
+  return readWord(pData.data() + pPos + offset, is64);
+}
+
+/// readRanges - call pFunc with the address and the length of each range
+/// of the set at pPos in .debug_aranges, but the empty ones. The terminator
+/// is not looked for, since an empty range before relocation looks like it.
+/// @return the end of the set
+template <typename Func>
+uint64_t readRanges(llvm::StringRef pData, uint64_t pPos, Func pFunc) {
+  bool is64 = false;
+  uint64_t size = readLength(pData, pPos, is64);
+  if (size == 0)
+    return pData.size();
+  uint64_t end = pPos + size;
+  uint64_t header = (is64 ? 12 : 4) + 2 + (is64 ? 8 : 4) + 2;
+  if (size < header)
+    return end;
+
+  // the tuples start at a multiple of their size from the set
+  uint8_t addr_size = pData[pPos + header - 2];
+  uint8_t seg_size = pData[pPos + header - 1];
+  if ((addr_size != 4 && addr_size != 8) || seg_size != 0)
+    return end;
+  uint64_t tuple_size = 2 * addr_size;
+  uint64_t cur = pPos + (header + tuple_size - 1) / tuple_size * tuple_size;
+  for (; cur + tuple_size <= end; cur += tuple_size) {
+    uint64_t addr = readWord(pData.data() + cur, addr_size == 8);
+    uint64_t length = readWord(pData.data() + cur + addr_size, addr_size == 8);
+    if (length != 0)
+      pFunc(addr, length);
+  }
+  return end;
+}
+
+void parseUnits(llvm::StringRef pData, uint64_t pBase, ParsedRegion& pResult) {
+  uint64_t pos = 0;
+  while (pos < pData.size()) {
+    bool is64 = false;
+    uint64_t size = readLength(pData, pos, is64);
+    if (size == 0)
+      break;
+    // the version, and the unit type since DWARF 5
+    uint64_t header = is64 ? 12 : 4;
+    if (size >= header + 3) {
+      uint16_t version =
+          llvm::support::endian::read16le(pData.data() + pos + header);
+      uint8_t type = pData[pos + header + 2];
+      if (version < 5 || type == kCompileUnit || type == kPartialUnit ||
+          type == kSkeletonUnit)
+        pResult.units.push_back(std::make_pair(pBase + pos, size));
+    }
+    pos += size;
+  }
+}
+
+void parseNames(llvm::StringRef pData,
+                uint64_t pBase,
+                bool pGNU,
+                ParsedRegion& pResult) {
+  uint64_t pos = 0;
+  while (pos < pData.size()) {
+    bool is64 = false;
+    uint64_t size = readLength(pData, pos, is64);
+    if (size == 0)
+      break;
+    uint64_t end = pos + size;
+    uint64_t word = is64 ? 8 : 4;
+    uint32_t set = pResult.sets.size();
+    pResult.sets.push_back(std::make_pair(pBase + pos, 0));
+
+    // the entries follow the version, the offset and the size of the unit,
+    // and end with a zero offset
+    uint64_t cur = pos + (is64 ? 12 : 4) + 2 + 2 * word;
+    while (cur + word <= end) {
+      uint64_t die = readWord(pData.data() + cur, is64);
+      cur += word;
+      if (die == 0)
+        break;
+      ParsedName entry;
+      entry.set = set;
+      entry.flags = 0;
+      if (pGNU) {
+        if (cur >= end)
+          break;
+        entry.flags = pData[cur++];
+      }
+      size_t nul = pData.find('\0', cur);
+      if (nul == llvm::StringRef::npos || nul >= end)
+        break;
+      entry.name = pData.slice(cur, nul);
+      pResult.names.push_back(entry);
+      cur = nul + 1;
+    }
+    pos = end;
+  }
+}
+
+void parseRanges(llvm::StringRef pData,
+                 uint64_t pBase,
+                 ParsedRegion& pResult) {
+  uint64_t pos = 0;
+  while (pos < pData.size()) {
+    bool is64 = false;
+    if (readLength(pData, pos, is64) == 0)
+      break;
+    uint32_t count = 0;
+    uint64_t end =
+        readRanges(pData, pos, [&count](uint64_t, uint64_t) { ++count; });
+    pResult.sets.push_back(std::make_pair(pBase + pos, count));
+    pos = end;
+  }
+}
+
+/// getRegions - append the regions of pSection to pRegions
+/// @return true if pSection has any
+bool getRegions(const LDSection* pSection,
+                RegionKind pKind,
+                uint32_t pIndex,
+                RegionList& pRegions) {
+  if (pSection == NULL || !pSection->hasSectionData())
+    return false;
+  size_t size = pRegions.size();
+  SectionData::const_iterator frag, fragEnd = pSection->getSectionData()->end();
+  for (frag = pSection->getSectionData()->begin(); frag != fragEnd; ++frag) {
+    const RegionFragment* region = llvm::dyn_cast<RegionFragment>(&*frag);
+    if (region == NULL)
+      continue;
+    DebugRegion entry = {frag->getOffset(), region->getRegion(), pKind, pIndex};
+    pRegions.push_back(entry);
+  }
+  return pRegions.size() != size;
+}
+
+/// hashName - the hash of the symbol table since version 5
+uint32_t hashName(llvm::StringRef pName) {
+  uint32_t hash = 0;
+  for (size_t i = 0; i < pName.size(); ++i)
+    hash = hash * 67 + ::tolower(static_cast<unsigned char>(pName[i])) - 113;
+  return hash;
+}
+
+void write32(uint8_t* pPlace, uint32_t pValue) {
+  llvm::support::endian::write32le(pPlace, pValue);
+}
+
+void write64(uint8_t* pPlace, uint64_t pValue) {
+  llvm::support::endian::write64le(pPlace, pValue);
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// GdbIndex
+//===----------------------------------------------------------------------===//
+GdbIndex::GdbIndex(LDSection& pSection) : m_Section(pSection), m_PoolSize(0) {
+}
+
+GdbIndex::~GdbIndex() {
+}
+
+void GdbIndex::sizeOutput(Module& pModule, ThreadPool& pPool) {
+  m_Section.setSize(0);
+  const LDSection* info = pModule.getSection(".debug_info");
+  if (info == NULL || info->size() == 0)
+    return;
+
+  // the units, the sets of ranges and the sets of names, each region read
+  // on its own
+  RegionList regions;
+  getRegions(info, UnitRegion, 0, regions);
+  LDSection* aranges = pModule.getSection(".debug_aranges");
+  if (getRegions(aranges, RangeRegion, m_RelocatedSections.size(), regions))
+    m_RelocatedSections.push_back(aranges);
+  for (size_t i = 0; i < sizeof(kNameSections) / sizeof(NameSection); ++i) {
+    LDSection* names = pModule.getSection(kNameSections[i].name);
+    RegionKind kind = kNameSections[i].gnu ? GNUNameRegion : NameRegion;
+    if (getRegions(names, kind, m_RelocatedSections.size(), regions))
+      m_RelocatedSections.push_back(names);
+  }
+
+  std::vector<ParsedRegion> parsed(regions.size());
+  parallelFor(pPool, 0, regions.size(), [&](size_t pIndex) {
+    const DebugRegion& region = regions[pIndex];
+    switch (region.kind) {
+      case UnitRegion:
+        parseUnits(region.data, region.offset, parsed[pIndex]);
+        break;
+      case RangeRegion:
+        parseRanges(region.data, region.offset, parsed[pIndex]);
+        break;
+      case NameRegion:
+      case GNUNameRegion:
+        parseNames(region.data, region.offset, region.kind == GNUNameRegion,
+                   parsed[pIndex]);
+        break;
+    }
+  });
+
+  // merge the regions in order, so that the index does not depend on the
+  // number of threads
+  llvm::StringMap<uint32_t> symbol_map;
+  for (size_t i = 0; i < regions.size(); ++i) {
+    ParsedRegion& region = parsed[i];
+    uint32_t section = regions[i].section;
+    switch (regions[i].kind) {
+      case UnitRegion:
+        for (size_t j = 0; j < region.units.size(); ++j) {
+          Unit unit = {region.units[j].first, region.units[j].second};
+          m_Units.push_back(unit);
+        }
+        break;
+      case RangeRegion:
+        for (size_t j = 0; j < region.sets.size(); ++j) {
+          Set set = {section, region.sets[j].first, kNoUnit};
+          m_RangeSets.push_back(set);
+          m_NumOfRanges.push_back(region.sets[j].second);
+        }
+        break;
+      case NameRegion:
+      case GNUNameRegion: {
+        uint32_t first_set = m_NameSets.size();
+        for (size_t j = 0; j < region.sets.size(); ++j) {
+          Set set = {section, region.sets[j].first, kNoUnit};
+          m_NameSets.push_back(set);
+        }
+        for (size_t j = 0; j < region.names.size(); ++j) {
+          const ParsedName& name = region.names[j];
+          std::pair<llvm::StringMap<uint32_t>::iterator, bool> entry =
+              symbol_map.insert(std::make_pair(name.name, m_Symbols.size()));
+          if (entry.second) {
+            m_Symbols.push_back(Symbol());
+            m_Symbols.back().name = name.name;
+          }
+          Entry value = {first_set + name.set, name.flags};
+          m_Symbols[entry.first->second].entries.push_back(value);
+        }
+        break;
+      }
+    }
+    region = ParsedRegion();
+  }
+
+  size_t total_ranges = 0;
+  for (size_t i = 0; i < m_NumOfRanges.size(); ++i)
+    total_ranges += m_NumOfRanges[i];
+  Range empty = {0, 0, kNoUnit};
+  m_Ranges.assign(total_ranges, empty);
+
+  // an open addressing table at most three quarters full, probed as gdb
+  // does
+  size_t table_size = 1;
+  while (table_size * 3 < m_Symbols.size() * 4)
+    table_size <<= 1;
+  m_HashTable.assign(table_size, 0);
+  uint32_t mask = table_size - 1;
+  for (size_t i = 0; i < m_Symbols.size(); ++i) {
+    uint32_t hash = hashName(m_Symbols[i].name);
+    uint32_t slot = hash & mask;
+    uint32_t step = ((hash * 17) & mask) | 1;
+    while (m_HashTable[slot] != 0)
+      slot = (slot + step) & mask;
+    m_HashTable[slot] = i + 1;
+  }
+
+  // the unit vectors come first in the constant pool, then the names
+  m_PoolSize = 0;
+  for (size_t i = 0; i < m_Symbols.size(); ++i) {
+    m_Symbols[i].vec_offset = m_PoolSize;
+    m_PoolSize += 4 * (m_Symbols[i].entries.size() + 1);
+  }
+  for (size_t i = 0; i < m_Symbols.size(); ++i) {
+    m_Symbols[i].name_offset = m_PoolSize;
+    m_PoolSize += m_Symbols[i].name.size() + 1;
+  }
+
+  m_Section.setSize(kHeaderSize + m_Units.size() * 16 + m_Ranges.size() * 20 +
+                    m_HashTable.size() * 8 + m_PoolSize);
+}
+
+uint32_t GdbIndex::findUnit(uint64_t pOffset) const {
+  std::vector<Unit>::const_iterator unit = std::lower_bound(
+      m_Units.begin(), m_Units.end(), pOffset,
+      [](const Unit& pUnit, uint64_t pValue) { return pUnit.offset < pValue; });
+  if (unit == m_Units.end() || unit->offset != pOffset)
+    return kNoUnit;
+  return unit - m_Units.begin();
+}
+
+void GdbIndex::resolve(const std::vector<std::vector<uint8_t> >& pContents) {
+  std::vector<Set>::iterator set, setEnd = m_NameSets.end();
+  for (set = m_NameSets.begin(); set != setEnd; ++set) {
+    const std::vector<uint8_t>& content = pContents[set->section];
+    llvm::StringRef data(reinterpret_cast<const char*>(content.data()),
+                         content.size());
+    set->unit = findUnit(readInfoOffset(data, set->offset));
+  }
+
+  // a set whose unit is not found keeps its ranges empty
+  size_t next = 0;
+  for (size_t i = 0; i < m_RangeSets.size(); ++i) {
+    Set& ranges = m_RangeSets[i];
+    const std::vector<uint8_t>& content = pContents[ranges.section];
+    llvm::StringRef data(reinterpret_cast<const char*>(content.data()),
+                         content.size());
+    ranges.unit = findUnit(readInfoOffset(data, ranges.offset));
+    size_t end = next + m_NumOfRanges[i];
+    if (ranges.unit != kNoUnit) {
+      size_t cur = next;
+      readRanges(data, ranges.offset, [&](uint64_t pAddr, uint64_t pLength) {
+        if (cur == end)
+          return;
+        Range range = {pAddr, pAddr + pLength, ranges.unit};
+        m_Ranges[cur++] = range;
+      });
+    }
+    next = end;
+  }
+}
+
+void GdbIndex::emitOutput(FileOutputBuffer& pOutput, ThreadPool& pPool) const {
+  MemoryRegion region = pOutput.request(m_Section.offset(), m_Section.size());
+  uint8_t* data = region.begin();
+  std::memset(data, 0x0, m_Section.size());
+
+  uint32_t units_offset = kHeaderSize;
+  uint32_t ranges_offset = units_offset + m_Units.size() * 16;
+  uint32_t table_offset = ranges_offset + m_Ranges.size() * 20;
+  uint32_t pool_offset = table_offset + m_HashTable.size() * 8;
+  write32(data, kVersion);
+  write32(data + 4, units_offset);
+  write32(data + 8, ranges_offset);  // no type units
+  write32(data + 12, ranges_offset);
+  write32(data + 16, table_offset);
+  write32(data + 20, pool_offset);
+
+  uint8_t* place = data + units_offset;
+  for (size_t i = 0; i < m_Units.size(); ++i, place += 16) {
+    write64(place, m_Units[i].offset);
+    write64(place + 8, m_Units[i].size);
+  }
+
+  for (size_t i = 0; i < m_Ranges.size(); ++i, place += 20) {
+    if (m_Ranges[i].unit == kNoUnit)
+      continue;
+    write64(place, m_Ranges[i].low);
+    write64(place + 8, m_Ranges[i].high);
+    write32(place + 16, m_Ranges[i].unit);
+  }
+
+  for (size_t i = 0; i < m_HashTable.size(); ++i, place += 8) {
+    if (m_HashTable[i] == 0)
+      continue;
+    const Symbol& symbol = m_Symbols[m_HashTable[i] - 1];
+    write32(place, symbol.name_offset);
+    write32(place + 4, symbol.vec_offset);
+  }
+
+  // each unit is listed once per kind of a name. The vectors have room for
+  // all entries, and the ones of lost units are left out.
+  uint8_t* pool = data + pool_offset;
+  parallelFor(pPool, 0, m_Symbols.size(), [&](size_t pIndex) {
+    const Symbol& symbol = m_Symbols[pIndex];
+    std::vector<uint32_t> values;
+    values.reserve(symbol.entries.size());
+    std::vector<Entry>::const_iterator entry, entryEnd = symbol.entries.end();
+    for (entry = symbol.entries.begin(); entry != entryEnd; ++entry) {
+      uint32_t unit = m_NameSets[entry->set].unit;
+      if (unit != kNoUnit)
+        values.push_back(unit | (static_cast<uint32_t>(entry->flags) << 24));
+    }
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+
+    uint8_t* vec = pool + symbol.vec_offset;
+    write32(vec, values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+      write32(vec + 4 * (i + 1), values[i]);
+    std::memcpy(pool + symbol.name_offset, symbol.name.data(),
+                symbol.name.size());
+  });
+}
+
+}  // namespace mcld
@@ -12,13 +12,54 @@
 #include "mcld/LD/ArchiveReader.h"
 #include "mcld/LD/BinaryReader.h"
 #include "mcld/LD/DynObjReader.h"
+#include "mcld/LD/LDContext.h"
+#include "mcld/LD/LDSymbol.h"
+#include "mcld/LD/LTOCodeGen.h"
 #include "mcld/LD/ObjectReader.h"
+#include "mcld/LD/ResolveInfo.h"
 #include "mcld/LinkerConfig.h"
 #include "mcld/MC/Attribute.h"
+#include "mcld/MC/Input.h"
 #include "mcld/Support/MsgHandling.h"
 
+#include <llvm/ADT/StringMap.h>
+
+#include <vector>
+
 namespace mcld {
 
+/// ArchiveIndex - map the name of an undecided armap symbol to the positions
+/// of the archives that define it in the archive list of a group.
+typedef llvm::StringMap<std::vector<size_t> > ArchiveIndex;
+
+/// markArchives - mark the archives that define a symbol which is still
+/// undefined and is referred by the objects in [pBegin, end of the object
+/// list). Return the end of the object list.
+static size_t markArchives(const Module& pModule,
+                           size_t pBegin,
+                           const ArchiveIndex& pIndex,
+                           std::vector<bool>& pDirty) {
+  const Module::ObjectList& objects = pModule.getObjectList();
+  for (size_t obj = pBegin; obj < objects.size(); ++obj) {
+    const LDContext* context = objects[obj]->context();
+    LDContext::const_sym_iterator sym, symEnd = context->symTabEnd();
+    for (sym = context->symTabBegin(); sym != symEnd; ++sym) {
+      const ResolveInfo* info = (*sym)->resolveInfo();
+      // only a strong undefined symbol makes an archive member included
+      if (info == NULL || !info->isUndef() || info->isWeak())
+        continue;
+
+      ArchiveIndex::const_iterator entry = pIndex.find(info->name());
+      if (entry == pIndex.end())
+        continue;
+      std::vector<size_t>::const_iterator ar, arEnd = entry->second.end();
+      for (ar = entry->second.begin(); ar != arEnd; ++ar)
+        pDirty[*ar] = true;
+    }
+  }
+  return objects.size();
+}
+
 GroupReader::GroupReader(Module& pModule,
                          ObjectReader& pObjectReader,
                          DynObjReader& pDynObjReader,
@@ -38,15 +79,13 @@ bool GroupReader::readGroup(Module::input_iterator pRoot,
                             Module::input_iterator pEnd,
                             InputBuilder& pBuilder,
                             const LinkerConfig& pConfig) {
-  // record the number of total objects included in this sub-tree
-  size_t cur_obj_cnt = 0;
-  size_t last_obj_cnt = 0;
-  size_t non_ar_obj_cnt = 0;
-
   // record the archive files in this sub-tree
   typedef std::vector<ArchiveListEntry*> ArchiveListType;
   ArchiveListType ar_list;
 
+  // the objects included by this group start here
+  size_t obj_begin = m_Module.getObjectList().size();
+
   Module::input_iterator input = --pRoot;
 
   // first time read the sub-tree
@@ -80,7 +119,6 @@ bool GroupReader::readGroup(Module::input_iterator pRoot,
       ar_list.push_back(entry);
       // read archive
       m_ArchiveReader.readArchive(pConfig, *ar);
-      cur_obj_cnt += ar->numOfObjectMember();
     } else if (doContinue && m_BinaryReader.isMyFormat(**input, doContinue)) {
       // read input as a binary file
       (*input)->setType(Input::Object);
@@ -93,14 +131,15 @@ bool GroupReader::readGroup(Module::input_iterator pRoot,
       m_ObjectReader.readSections(**input);
       m_ObjectReader.readSymbols(**input);
       m_Module.getObjectList().push_back(*input);
-      ++cur_obj_cnt;
-      ++non_ar_obj_cnt;
     } else if (doContinue && m_DynObjReader.isMyFormat(**input, doContinue)) {
       // is a shared object file
       (*input)->setType(Input::DynObj);
       m_DynObjReader.readHeader(**input);
       m_DynObjReader.readSymbols(**input);
       m_Module.getLibraryList().push_back(*input);
+    } else if (doContinue && LTOCodeGen::isBitcode(**input)) {
+      // compiled by the LTO stage of Linker, which reads the objects
+      (*input)->setType(Input::External);
     } else {
       warning(diag::warn_unrecognized_input_file)
           << (*input)->path() << pConfig.targets().triple().str();
@@ -108,23 +147,43 @@ bool GroupReader::readGroup(Module::input_iterator pRoot,
     ++input;
   }
 
-  // after read in all the archives, traverse the archive list in a loop until
-  // there is no unresolved symbols added
-  ArchiveListType::iterator it = ar_list.begin();
-  ArchiveListType::iterator end = ar_list.end();
-  while (cur_obj_cnt != last_obj_cnt) {
-    last_obj_cnt = cur_obj_cnt;
-    cur_obj_cnt = non_ar_obj_cnt;
-    for (it = ar_list.begin(); it != end; ++it) {
-      Archive& ar = (*it)->archive;
-      // if --whole-archive is given to this archive, no need to read it again
-      if (ar.getARFile().attribute()->isWholeArchive())
+  // after read in all the archives, index the symbols that no archive has
+  // decided to include or not yet.
+  ArchiveIndex index;
+  for (size_t ar_idx = 0; ar_idx < ar_list.size(); ++ar_idx) {
+    Archive& ar = ar_list[ar_idx]->archive;
+    // if --whole-archive is given to this archive, no need to read it again
+    if (ar.getARFile().attribute()->isWholeArchive())
+      continue;
+    for (size_t sym = 0; sym < ar.numOfSymbols(); ++sym) {
+      if (Archive::Symbol::Unknown != ar.getSymbolStatus(sym))
+        continue;
+      std::vector<size_t>& definers = index[ar.getSymbolName(sym)];
+      if (definers.empty() || definers.back() != ar_idx)
+        definers.push_back(ar_idx);
+    }
+  }
+
+  // An archive is read again only if an object included after its last read
+  // refers to an undefined symbol that the archive may define. Keep going
+  // until no archive is marked.
+  std::vector<bool> dirty(ar_list.size(), false);
+  size_t obj_end = markArchives(m_Module, obj_begin, index, dirty);
+  bool has_dirty = true;
+  while (has_dirty) {
+    has_dirty = false;
+    for (size_t ar_idx = 0; ar_idx < ar_list.size(); ++ar_idx) {
+      if (!dirty[ar_idx])
         continue;
-      m_ArchiveReader.readArchive(pConfig, ar);
-      cur_obj_cnt += ar.numOfObjectMember();
+      dirty[ar_idx] = false;
+      m_ArchiveReader.readArchive(pConfig, ar_list[ar_idx]->archive);
+      obj_end = markArchives(m_Module, obj_end, index, dirty);
+      has_dirty = true;
     }
   }
 
+  ArchiveListType::iterator it, end = ar_list.end();
+
   // after all needed member included, merge the archive sub-tree to main
   // InputTree
   for (it = ar_list.begin(); it != end; ++it) {
@@ -13,6 +13,7 @@
 #include "mcld/Fragment/RegionFragment.h"
 #include "mcld/LD/LDContext.h"
 #include "mcld/LD/LDSection.h"
+#include "mcld/LD/MemoryReport.h"
 #include "mcld/LD/RelocData.h"
 #include "mcld/LD/Relocator.h"
 #include "mcld/LD/ResolveInfo.h"
@@ -21,17 +22,17 @@
 #include "mcld/MC/Input.h"
 #include "mcld/Support/Demangle.h"
 #include "mcld/Support/MsgHandling.h"
+#include "mcld/Support/ThreadPool.h"
 #include "mcld/Target/GNULDBackend.h"
 
+#include <llvm/ADT/Hashing.h>
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Support/Casting.h>
-#include <llvm/Support/Format.h>
+#include <llvm/Support/ELF.h>
 
 #include <cassert>
-#include <map>
 #include <set>
-
-#include <zlib.h>
+#include <unordered_map>
 
 namespace mcld {
 
@@ -45,6 +46,18 @@ static bool isSymCtorOrDtor(const ResolveInfo& pSym) {
   return isCtorOrDtor(pSym.name(), pSym.nameSize());
 }
 
+/// isReadOnlyData - a section of constants. --icf=all folds them like code,
+/// since nothing but its address tells two identical constants apart.
+static bool isReadOnlyData(const LDSection& pSection) {
+  const uint32_t excluded = llvm::ELF::SHF_WRITE | llvm::ELF::SHF_TLS |
+                            llvm::ELF::SHF_LINK_ORDER;
+  return (LDFileFormat::DATA == pSection.kind()) &&
+         (llvm::ELF::SHT_PROGBITS == pSection.type()) &&
+         ((pSection.flag() & llvm::ELF::SHF_ALLOC) != 0x0) &&
+         ((pSection.flag() & excluded) == 0x0) &&
+         llvm::StringRef(pSection.name()).startswith(".rodata");
+}
+
 IdenticalCodeFolding::IdenticalCodeFolding(const LinkerConfig& pConfig,
                                            const TargetLDBackend& pBackend,
                                            Module& pModule)
@@ -56,22 +69,41 @@ void IdenticalCodeFolding::foldIdenticalCode() {
   FoldingCandidates candidate_list;
   findCandidates(candidate_list);
 
-  // 2. Initialize constant section content
-  for (size_t i = 0; i < candidate_list.size(); ++i) {
-    candidate_list[i].initConstantContent(m_Backend, m_KeptSections);
-  }
+  // 2. Initialize constant section content. Every candidate only reads its
+  // own sections, so this is done in parallel.
+  ThreadPool pool(m_Config.options().numThreads());
+  parallelFor(pool, 0, candidate_list.size(), [&](size_t pIndex) {
+    candidate_list[pIndex].initConstantContent(m_Backend, m_KeptSections);
+  });
 
-  // 3. Find identical code until convergence
+  // 3. Find identical code until convergence. Only the candidates that
+  // refer to a section folded in the previous pass are rehashed.
+  Dependents dependents;
+  findDependents(candidate_list, dependents);
+  std::vector<bool> outdated(candidate_list.size(), true);
   bool converged = false;
   size_t iterations = 0;
   while (!converged && (iterations < m_Config.options().getICFIterations())) {
-    converged = matchCandidates(candidate_list);
+    converged = matchCandidates(candidate_list, dependents, outdated);
     ++iterations;
   }
   if (m_Config.options().printICFSections()) {
     debug(diag::debug_icf_iterations) << iterations;
   }
 
+  // the candidates are gone when the pass ends, count them now
+  if (MemoryReport* report = MemoryReport::Current()) {
+    uint64_t bytes = candidate_list.capacity() * sizeof(FoldingCandidate);
+    FoldingCandidates::const_iterator cand, candEnd = candidate_list.end();
+    for (cand = candidate_list.begin(); cand != candEnd; ++cand) {
+      bytes += cand->regions.capacity() * sizeof(llvm::StringRef) +
+               cand->relocs.capacity() * sizeof(RelocContent) +
+               cand->variable_relocs.capacity() * sizeof(Relocation*) +
+               cand->variable_content.capacity() * sizeof(size_t);
+    }
+    report->add("ICF candidates", candidate_list.size(), bytes);
+  }
+
   // 4. Fold the identical code
   typedef std::set<Input*> FoldedObjects;
   FoldedObjects folded_objs;
@@ -101,7 +133,8 @@ void IdenticalCodeFolding::foldIdenticalCode() {
   for (fobj = folded_objs.begin(); fobj != fobjEnd; ++fobj) {
     LDContext::sym_iterator sym, symEnd = (*fobj)->context()->symTabEnd();
     for (sym = (*fobj)->context()->symTabBegin(); sym != symEnd; ++sym) {
-      if ((*sym)->hasFragRef() && ((*sym)->type() == ResolveInfo::Function)) {
+      // the objects and the section symbols of the folded data move as well
+      if ((*sym)->hasFragRef()) {
         LDSymbol* out_sym = (*sym)->resolveInfo()->outSymbol();
         FragmentRef* frag_ref = out_sym->fragRef();
         LDSection* sect = &(frag_ref->frag()->getParent()->getSection());
@@ -119,21 +152,37 @@ void IdenticalCodeFolding::foldIdenticalCode() {
 void IdenticalCodeFolding::findCandidates(FoldingCandidates& pCandidateList) {
   Module::obj_iterator obj, objEnd = m_Module.obj_end();
   for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
-    std::set<const LDSection*> funcptr_access_set;
-    typedef std::map<LDSection*, LDSection*> CandidateMap;
-    CandidateMap candidate_map;
-    LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
-    for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+    // The tables are indexed by the section index of the object. A section
+    // whose function pointer is taken is only recorded if it belongs to this
+    // object, since the sections of the other objects are never candidates
+    // here. The read-only data is only folded by --icf=all, since safe ICF
+    // cannot tell whose address is compared.
+    LDContext* context = (*obj)->context();
+    size_t num_sects = context->numOfSections();
+    std::vector<LDSection*> candidate_relocs(num_sects, NULL);
+    std::vector<char> is_candidate(num_sects, 0);
+    std::vector<char> funcptr_access(num_sects, 0);
+    bool fold_data =
+        (m_Config.options().getICFMode() == GeneralOptions::ICF::All);
+    LDContext::sect_iterator sect, sectEnd = context->sectEnd();
+    for (sect = context->sectBegin(); sect != sectEnd; ++sect) {
       switch ((*sect)->kind()) {
         case LDFileFormat::TEXT: {
-          candidate_map.insert(
-              std::make_pair(*sect, reinterpret_cast<LDSection*>(NULL)));
+          is_candidate[(*sect)->index()] = 1;
+          break;
+        }
+        case LDFileFormat::DATA: {
+          if (fold_data && isReadOnlyData(**sect))
+            is_candidate[(*sect)->index()] = 1;
           break;
         }
         case LDFileFormat::Relocation: {
           LDSection* target = (*sect)->getLink();
-          if (target->kind() == LDFileFormat::TEXT) {
-            candidate_map[target] = *sect;
+          if ((target->kind() == LDFileFormat::TEXT ||
+               (fold_data && isReadOnlyData(*target))) &&
+              context->getSection(target->index()) == target) {
+            is_candidate[target->index()] = 1;
+            candidate_relocs[target->index()] = *sect;
           }
 
           // Safe icf
@@ -144,11 +193,13 @@ void IdenticalCodeFolding::findCandidates(FoldingCandidates& pCandidateList) {
               if (sym->hasFragRef() && (sym->type() == ResolveInfo::Function)) {
                 const LDSection* def =
                     &sym->fragRef()->frag()->getParent()->getSection();
-                if (!isSymCtorOrDtor(*rel->symInfo()) &&
+                if (def->index() < num_sects &&
+                    context->getSection(def->index()) == def &&
+                    !isSymCtorOrDtor(*rel->symInfo()) &&
                     m_Backend.mayHaveUnsafeFunctionPointerAccess(*target) &&
                     m_Backend.getRelocator()
                         ->mayHaveFunctionPointerAccess(*rel)) {
-                  funcptr_access_set.insert(def);
+                  funcptr_access[def->index()] = 1;
                 }
               }
             }  // for each reloc
@@ -163,48 +214,82 @@ void IdenticalCodeFolding::findCandidates(FoldingCandidates& pCandidateList) {
       }  // end of switch
     }    // for each section
 
-    CandidateMap::iterator candidate, candidateEnd = candidate_map.end();
-    for (candidate = candidate_map.begin(); candidate != candidateEnd;
-         ++candidate) {
+    // The candidates are kept in the order of the sections.
+    for (size_t idx = 0; idx < num_sects; ++idx) {
+      if (is_candidate[idx] == 0)
+        continue;
       if ((m_Config.options().getICFMode() == GeneralOptions::ICF::All) ||
-          (funcptr_access_set.count(candidate->first) == 0)) {
+          (funcptr_access[idx] == 0)) {
+        LDSection* candidate = context->getSection(idx);
         size_t index = m_KeptSections.size();
-        m_KeptSections[candidate->first] = ObjectAndId(*obj, index);
+        m_KeptSections[candidate] = ObjectAndId(*obj, index);
         pCandidateList.push_back(
-            FoldingCandidate(candidate->first, candidate->second, *obj));
+            FoldingCandidate(candidate, candidate_relocs[idx], *obj));
       }
     }  // for each possible candidate
   }  // for each obj
 }
 
-bool IdenticalCodeFolding::matchCandidates(FoldingCandidates& pCandidateList) {
-  typedef std::multimap<uint32_t, size_t> ChecksumMap;
-  ChecksumMap checksum_map;
-  std::vector<std::string> contents(pCandidateList.size());
-  bool converged = true;
+void IdenticalCodeFolding::findDependents(
+    const FoldingCandidates& pCandidateList,
+    Dependents& pDependents) const {
+  pDependents.resize(m_KeptSections.size());
+  for (size_t index = 0; index < pCandidateList.size(); ++index) {
+    const std::vector<Relocation*>& relocs =
+        pCandidateList[index].variable_relocs;
+    std::vector<Relocation*>::const_iterator rel, relEnd = relocs.end();
+    for (rel = relocs.begin(); rel != relEnd; ++rel) {
+      LDSymbol* sym = (*rel)->symInfo()->outSymbol();
+      LDSection* def = &sym->fragRef()->frag()->getParent()->getSection();
+      KeptSections::const_iterator it = m_KeptSections.find(def);
+      std::vector<size_t>& users = pDependents[it - m_KeptSections.begin()];
+      if (users.empty() || (users.back() != index))
+        users.push_back(index);
+    }
+  }
+}
 
+bool IdenticalCodeFolding::matchCandidates(FoldingCandidates& pCandidateList,
+                                           const Dependents& pDependents,
+                                           std::vector<bool>& pOutdated) {
+  // Refresh the content of the candidates whose callees changed their kept
+  // section in the last pass. The others hash the same as before.
   for (size_t index = 0; index < pCandidateList.size(); ++index) {
-    contents[index] = pCandidateList[index].getContentWithVariables(
-        m_Backend, m_KeptSections);
-    uint32_t checksum = ::crc32(0xFFFFFFFF,
-                                (const uint8_t*)contents[index].c_str(),
-                                contents[index].length());
-
-    size_t count = checksum_map.count(checksum);
-    if (count == 0) {
-      checksum_map.insert(std::make_pair(checksum, index));
-    } else {
-      std::pair<ChecksumMap::iterator, ChecksumMap::iterator> ret =
-          checksum_map.equal_range(checksum);
-      for (ChecksumMap::iterator it = ret.first; it != ret.second; ++it) {
-        size_t kept_index = (*it).second;
-        if (contents[index].compare(contents[kept_index]) == 0) {
-          m_KeptSections[pCandidateList[index].sect].second = kept_index;
-          converged = false;
-          break;
-        }
+    if (pOutdated[index]) {
+      pCandidateList[index].updateVariableContent(m_KeptSections);
+      pOutdated[index] = false;
+    }
+  }
+
+  // The first candidate of each content is kept, and the later ones are
+  // folded into it.
+  typedef std::unordered_multimap<uint64_t, size_t> HashMap;
+  HashMap hash_map;
+  hash_map.reserve(pCandidateList.size());
+  bool converged = true;
+  for (size_t index = 0; index < pCandidateList.size(); ++index) {
+    const FoldingCandidate& candidate = pCandidateList[index];
+    size_t kept_index = index;
+    std::pair<HashMap::iterator, HashMap::iterator> ret =
+        hash_map.equal_range(candidate.content_hash);
+    for (HashMap::iterator it = ret.first; it != ret.second; ++it) {
+      if (candidate.hasSameContent(pCandidateList[(*it).second])) {
+        kept_index = (*it).second;
+        break;
       }
     }
+    if (kept_index == index)
+      hash_map.insert(std::make_pair(candidate.content_hash, index));
+
+    size_t& current = (*(m_KeptSections.begin() + index)).second.second;
+    if (current != kept_index) {
+      current = kept_index;
+      converged = false;
+      const std::vector<size_t>& users = pDependents[index];
+      std::vector<size_t>::const_iterator user, userEnd = users.end();
+      for (user = users.begin(); user != userEnd; ++user)
+        pOutdated[*user] = true;
+    }
   }
 
   return converged;
@@ -215,12 +300,17 @@ void IdenticalCodeFolding::FoldingCandidate::initConstantContent(
     const IdenticalCodeFolding::KeptSections& pKeptSections) {
   // Get the static content from text.
   assert(sect != NULL && sect->hasSectionData());
+  // code is not folded into data, nor into a section with less alignment
+  llvm::hash_code code =
+      llvm::hash_combine(sect->kind(), sect->align(), sect->size());
   SectionData::const_iterator frag, fragEnd = sect->getSectionData()->end();
   for (frag = sect->getSectionData()->begin(); frag != fragEnd; ++frag) {
     switch (frag->getKind()) {
       case Fragment::Region: {
         const RegionFragment& region = llvm::cast<RegionFragment>(*frag);
-        content.append(region.getRegion().begin(), region.size());
+        llvm::StringRef bytes(region.getRegion().begin(), region.size());
+        regions.push_back(bytes);
+        code = llvm::hash_combine(code, bytes);
         break;
       }
       default: {
@@ -233,66 +323,108 @@ void IdenticalCodeFolding::FoldingCandidate::initConstantContent(
   // Get the static content from relocs.
   if (reloc_sect != NULL && reloc_sect->hasRelocData()) {
     for (Relocation& rel : *reloc_sect->getRelocData()) {
-      llvm::format_object<Relocation::Type,
-                          Relocation::Address,
-                          Relocation::Address,
-                          Relocation::Address> rel_info("%x%llx%llx%llx",
-                                                        rel.type(),
-                                                        rel.symValue(),
-                                                        rel.addend(),
-                                                        rel.place());
-      char rel_str[48];
-      rel_info.print(rel_str, sizeof(rel_str));
-      content.append(rel_str);
-
-      // Handle the recursive call.
+      RelocContent reloc;
+      reloc.kind = RelocContent::Symbolic;
+      reloc.type = rel.type();
+      reloc.sym_value = rel.symValue();
+      reloc.addend = rel.addend();
+      reloc.place = rel.place();
+      reloc.scope = NULL;
+
       LDSymbol* sym = rel.symInfo()->outSymbol();
-      if ((sym->type() == ResolveInfo::Function) && sym->hasFragRef()) {
+      bool recursive = false;
+      if (sym->hasFragRef()) {
         LDSection* def = &sym->fragRef()->frag()->getParent()->getSection();
-        if (def == sect) {
-          continue;
-        }
+        recursive = (def == sect);
       }
 
-      if (!pBackend.isSymbolPreemptible(*rel.symInfo()) && sym->hasFragRef() &&
-          (pKeptSections.find(
-               &sym->fragRef()->frag()->getParent()->getSection()) !=
-           pKeptSections.end())) {
+      if (recursive) {
+        // Handle the recursive call.
+        reloc.kind = RelocContent::Recursive;
+      } else if (!pBackend.isSymbolPreemptible(*rel.symInfo()) &&
+                 sym->hasFragRef() &&
+                 (pKeptSections.find(
+                      &sym->fragRef()->frag()->getParent()->getSection()) !=
+                  pKeptSections.end())) {
         // Mark this reloc as a variable.
+        reloc.kind = RelocContent::Variable;
         variable_relocs.push_back(&rel);
       } else {
         // TODO: Support inlining merge sections if possible (target-dependent).
+        reloc.name = sym->name();
         if ((sym->binding() == ResolveInfo::Local) ||
             (sym->binding() == ResolveInfo::Absolute)) {
           // ABS or Local symbols.
-          content.append(sym->name()).append(obj->name()).append(
-              obj->path().native());
-        } else {
-          content.append(sym->name());
+          reloc.scope = obj;
         }
       }
+
+      code = llvm::hash_combine(code, reloc.kind, reloc.type, reloc.sym_value,
+                                reloc.addend, reloc.place, reloc.name);
+      if (reloc.scope != NULL) {
+        llvm::StringRef scope_name(reloc.scope->name());
+        llvm::StringRef scope_path(reloc.scope->path().native());
+        code = llvm::hash_combine(code, scope_name, scope_path);
+      }
+      relocs.push_back(reloc);
     }
   }
+  constant_hash = code;
 }
 
-std::string IdenticalCodeFolding::FoldingCandidate::getContentWithVariables(
-    const TargetLDBackend& pBackend,
+void IdenticalCodeFolding::FoldingCandidate::updateVariableContent(
     const IdenticalCodeFolding::KeptSections& pKeptSections) {
-  std::string result(content);
   // Compute the variable content from relocs.
+  variable_content.clear();
   std::vector<Relocation*>::const_iterator rel, relEnd = variable_relocs.end();
   for (rel = variable_relocs.begin(); rel != relEnd; ++rel) {
     LDSymbol* sym = (*rel)->symInfo()->outSymbol();
     LDSection* def = &sym->fragRef()->frag()->getParent()->getSection();
     // Use the kept section index.
     KeptSections::const_iterator it = pKeptSections.find(def);
-    llvm::format_object<size_t> kept_info("%x", (*it).second.second);
-    char kept_str[8];
-    kept_info.print(kept_str, sizeof(kept_str));
-    result.append(kept_str);
+    variable_content.push_back((*it).second.second);
   }
+  content_hash = llvm::hash_combine(
+      constant_hash,
+      llvm::hash_combine_range(variable_content.begin(),
+                               variable_content.end()));
+}
 
-  return result;
+/// isSameScope - local and absolute symbols only match if they come from an
+/// object of the same name and path.
+static bool isSameScope(const Input* pA, const Input* pB) {
+  if ((pA == NULL) || (pB == NULL))
+    return (pA == pB);
+  return (pA->name() == pB->name()) &&
+         (pA->path().native() == pB->path().native());
+}
+
+bool IdenticalCodeFolding::FoldingCandidate::hasSameContent(
+    const FoldingCandidate& pOther) const {
+  if ((content_hash != pOther.content_hash) ||
+      (constant_hash != pOther.constant_hash) ||
+      (sect->kind() != pOther.sect->kind()) ||
+      (sect->align() != pOther.sect->align()) ||
+      (variable_content != pOther.variable_content) ||
+      (regions.size() != pOther.regions.size()) ||
+      (relocs.size() != pOther.relocs.size()))
+    return false;
+
+  for (size_t i = 0; i < regions.size(); ++i) {
+    if (regions[i] != pOther.regions[i])
+      return false;
+  }
+
+  for (size_t i = 0; i < relocs.size(); ++i) {
+    const RelocContent& a = relocs[i];
+    const RelocContent& b = pOther.relocs[i];
+    if ((a.kind != b.kind) || (a.type != b.type) ||
+        (a.sym_value != b.sym_value) || (a.addend != b.addend) ||
+        (a.place != b.place) || (a.name != b.name) ||
+        !isSameScope(a.scope, b.scope))
+      return false;
+  }
+  return true;
 }
 
 }  // namespace mcld
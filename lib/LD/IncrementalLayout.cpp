@@ -0,0 +1,312 @@
+//===- IncrementalLayout.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/IncrementalLayout.h"
+
+#include "mcld/Module.h"
+#include "mcld/Fragment/FillFragment.h"
+#include "mcld/Fragment/Fragment.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/LD/LDSymbol.h"
+#include "mcld/LD/ResolveInfo.h"
+#include "mcld/LD/SectionData.h"
+#include "mcld/MC/Input.h"
+#include "mcld/Support/Statistic.h"
+#include "mcld/Support/raw_ostream.h"
+
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+#include <cctype>
+#include <memory>
+#include <system_error>
+
+namespace mcld {
+
+static Statistic NumReusedSections("incremental.reused-sections",
+                                   "The # of sections fit in the reservation");
+static Statistic NumOverflowSections("incremental.overflowed-sections",
+                                     "The # of sections grew out of the slack");
+static Statistic NumMovedSections("incremental.moved-sections",
+                                  "The # of sections which moved");
+static Statistic NumMovedSymbols("incremental.moved-symbols",
+                                 "The # of global symbols which moved");
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+const char* kMagic = "mcld-incremental-layout 2";
+
+/// getInputKey - the name of pInput in the layout file. The members of an
+/// archive share the path of the archive.
+std::string getInputKey(const Input& pInput) {
+  std::string key = pInput.path().native();
+  if (pInput.fileOffset() != 0)
+    key += "(" + pInput.name() + ")";
+  return key;
+}
+
+/// getSectionKey - the name of pSection of pInput in the layout file
+std::string getSectionKey(const Input& pInput, const LDSection& pSection) {
+  return getInputKey(pInput) + "\t" + std::to_string(pSection.index()) + "\t" +
+         pSection.name();
+}
+
+/// isCIdentifier - a section of such a name may be walked through with its
+/// __start_ and __stop_ symbols
+bool isCIdentifier(llvm::StringRef pName) {
+  if (pName.empty() || std::isdigit(static_cast<unsigned char>(pName[0])))
+    return false;
+  for (size_t i = 0; i < pName.size(); ++i) {
+    if (!std::isalnum(static_cast<unsigned char>(pName[i])) && pName[i] != '_')
+      return false;
+  }
+  return true;
+}
+
+/// isReservable - the code and data sections whose bytes come from one input
+/// section. The merged strings and the other sections laid out by their own
+/// rules are left alone, and so are the sections read as arrays or as code
+/// that falls through to the next input: a slack would be read or run.
+bool isReservable(const LDSection& pSection) {
+  switch (pSection.kind()) {
+    case LDFileFormat::TEXT:
+    case LDFileFormat::DATA:
+    case LDFileFormat::BSS:
+      break;
+    default:
+      return false;
+  }
+
+  if (!pSection.hasSectionData() || pSection.getSectionData()->empty() ||
+      (pSection.flag() & llvm::ELF::SHF_MERGE) != 0)
+    return false;
+
+  switch (pSection.type()) {
+    case llvm::ELF::SHT_INIT_ARRAY:
+    case llvm::ELF::SHT_FINI_ARRAY:
+    case llvm::ELF::SHT_PREINIT_ARRAY:
+      return false;
+    default:
+      break;
+  }
+
+  llvm::StringRef name(pSection.name());
+  if (name == ".init" || name == ".fini" || name == ".jcr" ||
+      name.startswith(".ctors") || name.startswith(".dtors") ||
+      name.startswith(".init_array") || name.startswith(".fini_array") ||
+      name.startswith(".preinit_array") || isCIdentifier(name))
+    return false;
+  return true;
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// IncrementalLayout
+//===----------------------------------------------------------------------===//
+IncrementalLayout::IncrementalLayout()
+    : m_bRead(false), m_OutputSize(0), m_OldStringsKey(0), m_StringsKey(0) {
+}
+
+IncrementalLayout::~IncrementalLayout() {
+}
+
+bool IncrementalLayout::read(const std::string& pFile) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer> > buffer =
+      llvm::MemoryBuffer::getFile(pFile);
+  if (!buffer)
+    return false;
+
+  llvm::StringRef content = (*buffer)->getBuffer();
+  std::pair<llvm::StringRef, llvm::StringRef> line = content.split('\n');
+  if (line.first != kMagic)
+    return false;
+
+  RecordMap records;
+  SymbolMap symbols;
+  KeyMap reloc_keys;
+  uint64_t output_size = 0;
+  uint64_t strings_key = 0;
+  for (content = line.second; !content.empty(); content = line.second) {
+    line = content.split('\n');
+    llvm::SmallVector<llvm::StringRef, 8> fields;
+    line.first.split(fields, "\t");
+
+    if (fields[0] == "output" && fields.size() == 2) {
+      if (fields[1].getAsInteger(10, output_size))
+        return false;
+    } else if (fields[0] == "section" && fields.size() == 7) {
+      // section <input> <index> <name> <offset> <size> <reserved>
+      Record record;
+      uint64_t size;
+      if (fields[4].getAsInteger(10, record.offset) ||
+          fields[5].getAsInteger(10, size) ||
+          fields[6].getAsInteger(10, record.reserved))
+        return false;
+      std::string key = fields[1].str() + "\t" + fields[2].str() + "\t" +
+                        fields[3].str();
+      records[key] = record;
+    } else if (fields[0] == "relocated" && fields.size() == 5) {
+      // relocated <input> <index> <name> <key>
+      uint64_t key;
+      if (fields[4].getAsInteger(16, key))
+        return false;
+      reloc_keys[fields[1].str() + "\t" + fields[2].str() + "\t" +
+                 fields[3].str()] = key;
+    } else if (fields[0] == "strings" && fields.size() == 2) {
+      if (fields[1].getAsInteger(16, strings_key))
+        return false;
+    } else if (fields[0] == "symbol" && fields.size() == 3) {
+      // symbol <value> <name>
+      uint64_t value;
+      if (fields[1].getAsInteger(16, value))
+        return false;
+      symbols[fields[2].str()] = value;
+    } else if (!line.first.empty()) {
+      return false;
+    }
+  }
+
+  m_Records.swap(records);
+  m_Symbols.swap(symbols);
+  m_OldRelocKeys.swap(reloc_keys);
+  m_OutputSize = output_size;
+  m_OldStringsKey = strings_key;
+  m_bRead = true;
+  return true;
+}
+
+void IncrementalLayout::reserve(const Input& pInput, LDSection& pSection) {
+  if (!isReservable(pSection))
+    return;
+
+  Entry entry;
+  entry.key = getSectionKey(pInput, pSection);
+  entry.first = &pSection.getSectionData()->front();
+  entry.size = pSection.size();
+  entry.reserved = entry.size + getSlack(entry.size);
+
+  RecordMap::const_iterator record = m_Records.find(entry.key);
+  if (record != m_Records.end()) {
+    if (entry.size <= record->second.reserved) {
+      entry.reserved = record->second.reserved;
+      ++NumReusedSections;
+    } else {
+      ++NumOverflowSections;
+    }
+  }
+
+  if (entry.reserved > entry.size) {
+    SectionData* data = pSection.getSectionData();
+    FillFragment* slack = new FillFragment(0x0, 1, entry.reserved - entry.size);
+    slack->setParent(data);
+    slack->setOffset(entry.size);
+    data->getFragmentList().push_back(slack);
+    pSection.setSize(entry.reserved);
+  }
+  m_Entries.push_back(entry);
+}
+
+bool IncrementalLayout::isRelocated(const Input& pInput,
+                                    const LDSection& pSection,
+                                    uint64_t pKey) const {
+  KeyMap::const_iterator old = m_OldRelocKeys.find(
+      getSectionKey(pInput, pSection));
+  return old != m_OldRelocKeys.end() && old->second == pKey;
+}
+
+void IncrementalLayout::addRelocated(const Input& pInput,
+                                     const LDSection& pSection,
+                                     uint64_t pKey) {
+  m_RelocKeys[getSectionKey(pInput, pSection)] = pKey;
+}
+
+bool IncrementalLayout::write(const std::string& pFile,
+                              const Module& pModule,
+                              uint64_t pOutputSize) const {
+  std::error_code ec;
+  mcld::raw_fd_ostream os(pFile.c_str(), ec);
+  if (ec)
+    return false;
+
+  os << kMagic << "\n";
+  os << "output\t" << pOutputSize << "\n";
+
+  std::vector<Entry>::const_iterator entry, eEnd = m_Entries.end();
+  for (entry = m_Entries.begin(); entry != eEnd; ++entry) {
+    // the first fragment now belongs to the output section
+    const LDSection& output = entry->first->getParent()->getSection();
+    uint64_t offset = output.offset() + entry->first->getOffset();
+    RecordMap::const_iterator record = m_Records.find(entry->key);
+    if (record != m_Records.end() && record->second.offset != offset)
+      ++NumMovedSections;
+
+    os << "section\t" << entry->key << "\t" << offset << "\t" << entry->size
+       << "\t" << entry->reserved << "\n";
+  }
+
+  KeyMap::const_iterator key, keyEnd = m_RelocKeys.end();
+  for (key = m_RelocKeys.begin(); key != keyEnd; ++key) {
+    os << "relocated\t" << key->first << "\t";
+    os.write_hex(key->second);
+    os << "\n";
+  }
+  if (!m_RelocKeys.empty()) {
+    os << "strings\t";
+    os.write_hex(m_StringsKey);
+    os << "\n";
+  }
+
+  Module::const_sym_iterator symbol, symEnd = pModule.sym_end();
+  for (symbol = pModule.getSymbolTable().commonBegin(); symbol != symEnd;
+       ++symbol) {
+    const ResolveInfo* info = (*symbol)->resolveInfo();
+    if (info == NULL || !info->isDefine())
+      continue;
+    SymbolMap::const_iterator old = m_Symbols.find(info->name());
+    if (old != m_Symbols.end() && old->second != (*symbol)->value())
+      ++NumMovedSymbols;
+    os << "symbol\t";
+    os.write_hex((*symbol)->value());
+    os << "\t" << info->name() << "\n";
+  }
+
+  os.close();
+  if (os.has_error()) {
+    os.clear_error();
+    return false;
+  }
+  return true;
+}
+
+bool IncrementalLayout::canPatch(const std::string& pOutput,
+                                 uint64_t pSize) const {
+  if (!m_bRead || m_OutputSize != pSize)
+    return false;
+
+  bool regular = false;
+  uint64_t size = 0;
+  if (llvm::sys::fs::is_regular_file(pOutput, regular) || !regular ||
+      llvm::sys::fs::file_size(pOutput, size))
+    return false;
+  return size == pSize;
+}
+
+uint64_t IncrementalLayout::getSlack(uint64_t pSize) {
+  // a sixteenth keeps the output small, and the minimum absorbs the small
+  // edits of the small sections of -ffunction-sections
+  return 16 + pSize / 16;
+}
+
+}  // namespace mcld
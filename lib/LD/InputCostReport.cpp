@@ -0,0 +1,232 @@
+//===- InputCostReport.cpp ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/InputCostReport.h"
+
+#include "mcld/Module.h"
+#include "mcld/Fragment/Fragment.h"
+#include "mcld/Fragment/FragmentRef.h"
+#include "mcld/Fragment/Relocation.h"
+#include "mcld/LD/LDContext.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/LD/LDSymbol.h"
+#include "mcld/LD/RelocData.h"
+#include "mcld/LD/ResolveInfo.h"
+#include "mcld/MC/Input.h"
+#include "mcld/Support/MemoryArea.h"
+#include "mcld/Support/TimeTrace.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+
+namespace mcld {
+
+static InputCostReport* g_pCurrentReport = NULL;
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// isStubBranch - pReloc has been redirected to a stub by relaxation
+bool isStubBranch(const Relocation& pReloc) {
+  const ResolveInfo* info = pReloc.symInfo();
+  if (info == NULL || info->outSymbol() == NULL ||
+      !info->outSymbol()->hasFragRef())
+    return false;
+  const Fragment* frag = info->outSymbol()->fragRef()->frag();
+  return frag != NULL && Fragment::Stub == frag->getKind();
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// InputCostReport::Scope
+//===----------------------------------------------------------------------===//
+InputCostReport::Scope::Scope(const Input& pInput, Phase pPhase)
+    : m_Input(pInput), m_Phase(pPhase) {
+  if (g_pCurrentReport != NULL)
+    m_Begin = std::chrono::steady_clock::now();
+}
+
+InputCostReport::Scope::~Scope() {
+  if (g_pCurrentReport == NULL)
+    return;
+  uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - m_Begin).count();
+  g_pCurrentReport->addTime(m_Input, m_Phase, micros);
+}
+
+//===----------------------------------------------------------------------===//
+// InputCostReport::Cost
+//===----------------------------------------------------------------------===//
+InputCostReport::Cost::Cost()
+    : bytes(0), symbols(0), relocations(0), sections(0), stubs(0) {
+  std::fill(times, times + NumOfPhases, 0);
+}
+
+uint64_t InputCostReport::Cost::time() const {
+  uint64_t total = 0;
+  for (size_t i = 0; i < NumOfPhases; ++i)
+    total += times[i];
+  return total;
+}
+
+//===----------------------------------------------------------------------===//
+// InputCostReport
+//===----------------------------------------------------------------------===//
+InputCostReport::InputCostReport() {
+}
+
+InputCostReport::~InputCostReport() {
+  if (g_pCurrentReport == this)
+    g_pCurrentReport = NULL;
+}
+
+InputCostReport* InputCostReport::Current() {
+  return g_pCurrentReport;
+}
+
+void InputCostReport::SetCurrent(InputCostReport* pReport) {
+  g_pCurrentReport = pReport;
+}
+
+const char* InputCostReport::PhaseName(Phase pPhase) {
+  switch (pPhase) {
+    case Read:
+      return "read";
+    case Resolve:
+      return "resolve";
+    case GC:
+      return "gc";
+    case Scan:
+      return "scan";
+    case Apply:
+      return "apply";
+    default:
+      break;
+  }
+  return "";
+}
+
+void InputCostReport::addTime(const Input& pInput,
+                              Phase pPhase,
+                              uint64_t pMicros) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Costs[pInput.path().native()].times[pPhase] += pMicros;
+}
+
+void InputCostReport::addModule(const Module& pModule) {
+  // the members of an archive map the archive once
+  llvm::DenseSet<const MemoryArea*> areas;
+  Module::const_obj_iterator obj, objEnd = pModule.obj_end();
+  for (obj = pModule.obj_begin(); obj != objEnd; ++obj) {
+    Cost& cost = m_Costs[(*obj)->path().native()];
+    if ((*obj)->hasMemArea() && areas.insert((*obj)->memArea()).second)
+      cost.bytes += (*obj)->memArea()->size();
+
+    const LDContext* context = (*obj)->context();
+    if (context == NULL)
+      continue;
+    cost.symbols += context->symTabEnd() - context->symTabBegin();
+    cost.sections += context->numOfSections();
+    LDContext::const_sect_iterator rs, rsEnd = context->relocSectEnd();
+    for (rs = context->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (!(*rs)->hasRelocData())
+        continue;
+      cost.relocations += (*rs)->getRelocData()->size();
+      RelocData::const_iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+        if (isStubBranch(*llvm::cast<Relocation>(reloc)))
+          ++cost.stubs;
+      }
+    }
+  }
+
+  Module::const_lib_iterator lib, libEnd = pModule.lib_end();
+  for (lib = pModule.lib_begin(); lib != libEnd; ++lib) {
+    Cost& cost = m_Costs[(*lib)->path().native()];
+    if ((*lib)->hasMemArea() && areas.insert((*lib)->memArea()).second)
+      cost.bytes += (*lib)->memArea()->size();
+    const LDContext* context = (*lib)->context();
+    if (context == NULL)
+      continue;
+    cost.symbols += context->symTabEnd() - context->symTabBegin();
+    cost.sections += context->numOfSections();
+  }
+}
+
+void InputCostReport::getTopInputs(
+    size_t pNumber,
+    std::vector<CostMap::const_iterator>& pInputs) const {
+  CostMap::const_iterator cost, costEnd = m_Costs.end();
+  for (cost = m_Costs.begin(); cost != costEnd; ++cost)
+    pInputs.push_back(cost);
+
+  // the map is ordered by the paths, which break the ties
+  std::stable_sort(pInputs.begin(), pInputs.end(),
+                   [](CostMap::const_iterator pA, CostMap::const_iterator pB) {
+    return pA->second.time() > pB->second.time();
+  });
+  if (pInputs.size() > pNumber)
+    pInputs.resize(pNumber);
+}
+
+void InputCostReport::print(llvm::raw_ostream& pOS, size_t pNumber) const {
+  std::vector<CostMap::const_iterator> inputs;
+  getTopInputs(pNumber, inputs);
+  if (inputs.empty())
+    return;
+
+  // the paths are unbounded, so they come last
+  pOS << "inputs by time (ms)\n"
+      << "     total      read   resolve        gc      scan     apply"
+      << "      bytes  symbols   relocs sections   stubs  input\n";
+  const char* times = "  %8.3f";
+  const char* counts = " %10llu %8llu %8llu %8llu %7llu  %s\n";
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    const Cost& cost = inputs[i]->second;
+    pOS << llvm::format(times, cost.time() / 1000.0);
+    for (size_t j = 0; j < NumOfPhases; ++j)
+      pOS << llvm::format(times, cost.times[j] / 1000.0);
+    pOS << llvm::format(counts,
+                        static_cast<unsigned long long>(cost.bytes),
+                        static_cast<unsigned long long>(cost.symbols),
+                        static_cast<unsigned long long>(cost.relocations),
+                        static_cast<unsigned long long>(cost.sections),
+                        static_cast<unsigned long long>(cost.stubs),
+                        inputs[i]->first.c_str());
+  }
+}
+
+void InputCostReport::addEvents(TimeTrace& pTrace, size_t pNumber) const {
+  std::vector<CostMap::const_iterator> inputs;
+  getTopInputs(pNumber, inputs);
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    const Cost& cost = inputs[i]->second;
+    TimeTrace::Args args;
+    for (size_t j = 0; j < NumOfPhases; ++j) {
+      args.push_back(std::make_pair(
+          std::string(PhaseName(static_cast<Phase>(j))) + " us",
+          cost.times[j]));
+    }
+    args.push_back(std::make_pair(std::string("bytes"), cost.bytes));
+    args.push_back(std::make_pair(std::string("symbols"), cost.symbols));
+    args.push_back(
+        std::make_pair(std::string("relocations"), cost.relocations));
+    args.push_back(std::make_pair(std::string("sections"), cost.sections));
+    args.push_back(std::make_pair(std::string("stubs"), cost.stubs));
+    pTrace.addInstant("input", inputs[i]->first, args);
+  }
+}
+
+}  // namespace mcld
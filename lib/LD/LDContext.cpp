@@ -17,6 +17,9 @@ namespace mcld {
 //===----------------------------------------------------------------------===//
 // LDContext
 //===----------------------------------------------------------------------===//
+LDContext::LDContext() : m_NumOfIndexed(0) {
+}
+
 LDContext& LDContext::appendSection(LDSection& pSection) {
   if (LDFileFormat::Relocation == pSection.kind())
     m_RelocSections.push_back(&pSection);
@@ -37,31 +40,37 @@ const LDSection* LDContext::getSection(unsigned int pIdx) const {
   return m_SectionTable[pIdx];
 }
 
-LDSection* LDContext::getSection(const std::string& pName) {
-  sect_iterator sect_iter, sect_end = sectEnd();
-  for (sect_iter = sectBegin(); sect_iter != sect_end; ++sect_iter) {
-    if (*sect_iter != NULL && (*sect_iter)->name() == pName)
-      return *sect_iter;
-  }
-  return NULL;
+LDSection* LDContext::getSection(const llvm::StringRef& pName) {
+  updateSectionIndex();
+  SectionIndex::const_iterator entry = m_SectionIndex.find(pName);
+  if (entry == m_SectionIndex.end())
+    return NULL;
+  return m_SectionTable[entry->getValue()];
 }
 
-const LDSection* LDContext::getSection(const std::string& pName) const {
-  const_sect_iterator sect_iter, sect_end = sectEnd();
-  for (sect_iter = sectBegin(); sect_iter != sect_end; ++sect_iter) {
-    if (*sect_iter != NULL && (*sect_iter)->name() == pName)
-      return *sect_iter;
-  }
-  return NULL;
+const LDSection* LDContext::getSection(const llvm::StringRef& pName) const {
+  updateSectionIndex();
+  SectionIndex::const_iterator entry = m_SectionIndex.find(pName);
+  if (entry == m_SectionIndex.end())
+    return NULL;
+  return m_SectionTable[entry->getValue()];
 }
 
-size_t LDContext::getSectionIdx(const std::string& pName) const {
-  size_t result = 1;
+size_t LDContext::getSectionIdx(const llvm::StringRef& pName) const {
+  updateSectionIndex();
+  SectionIndex::const_iterator entry = m_SectionIndex.find(pName);
+  if (entry == m_SectionIndex.end())
+    return 0;
+  return entry->getValue();
+}
+
+void LDContext::updateSectionIndex() const {
   size_t size = m_SectionTable.size();
-  for (; result != size; ++result)
-    if (m_SectionTable[result]->name() == pName)
-      return result;
-  return 0;
+  for (; m_NumOfIndexed < size; ++m_NumOfIndexed) {
+    const LDSection* sect = m_SectionTable[m_NumOfIndexed];
+    if (sect != NULL)
+      m_SectionIndex.insert(std::make_pair(sect->name(), m_NumOfIndexed));
+  }
 }
 
 LDSymbol* LDContext::getSymbol(unsigned int pIdx) {
@@ -12,17 +12,32 @@
 
 #include <llvm/Support/ManagedStatic.h>
 
+#include <unordered_set>
+
 namespace mcld {
 
 typedef GCFactory<LDSection, MCLD_SECTIONS_PER_INPUT> SectionFactory;
 
 static llvm::ManagedStatic<SectionFactory> g_SectFactory;
 
+// Input sections of a large link repeat the same few names (and the same
+// COMDAT names across objects) many times over. Each distinct name is kept
+// once here. Nodes of an unordered_set never move, so sections can point at
+// their names directly.
+typedef std::unordered_set<std::string> SectionNamePool;
+
+static llvm::ManagedStatic<SectionNamePool> g_SectNamePool;
+
+/// internName - return the pooled copy of pName
+static const std::string* internName(const std::string& pName) {
+  return &*g_SectNamePool->insert(pName).first;
+}
+
 //===----------------------------------------------------------------------===//
 // LDSection
 //===----------------------------------------------------------------------===//
 LDSection::LDSection()
-    : m_Name(),
+    : m_pName(internName(std::string())),
       m_Kind(LDFileFormat::Ignore),
       m_Type(0x0),
       m_Flag(0x0),
@@ -30,9 +45,11 @@ LDSection::LDSection()
       m_Offset(~uint64_t(0)),
       m_Addr(0x0),
       m_Align(0),
+      m_EntSize(0),
       m_Info(0),
       m_pLink(NULL),
-      m_Index(0) {
+      m_Index(0),
+      m_Order(~0U) {
   m_Data.sect_data = NULL;
 }
 
@@ -42,7 +59,7 @@ LDSection::LDSection(const std::string& pName,
                      uint32_t pFlag,
                      uint64_t pSize,
                      uint64_t pAddr)
-    : m_Name(pName),
+    : m_pName(internName(pName)),
       m_Kind(pKind),
       m_Type(pType),
       m_Flag(pFlag),
@@ -50,9 +67,11 @@ LDSection::LDSection(const std::string& pName,
       m_Offset(~uint64_t(0)),
       m_Addr(pAddr),
       m_Align(0),
+      m_EntSize(0),
       m_Info(0),
       m_pLink(NULL),
-      m_Index(0) {
+      m_Index(0),
+      m_Order(~0U) {
   m_Data.sect_data = NULL;
 }
 
@@ -82,6 +101,7 @@ void LDSection::Destroy(LDSection*& pSection) {
 
 void LDSection::Clear() {
   g_SectFactory->clear();
+  g_SectNamePool->clear();
 }
 
 bool LDSection::hasSectionData() const {
@@ -28,7 +28,12 @@ static llvm::ManagedStatic<LDSymbolFactory> g_LDSymbolFactory;
 //===----------------------------------------------------------------------===//
 // LDSymbol
 //===----------------------------------------------------------------------===//
-LDSymbol::LDSymbol() : m_pResolveInfo(NULL), m_pFragRef(NULL), m_Value(0) {
+LDSymbol::LDSymbol()
+    : m_pResolveInfo(NULL),
+      m_pFragRef(NULL),
+      m_Value(0),
+      m_SymIdx(NoSymIdx),
+      m_CategoryPos(~0U) {
 }
 
 LDSymbol::~LDSymbol() {
@@ -37,13 +42,16 @@ LDSymbol::~LDSymbol() {
 LDSymbol::LDSymbol(const LDSymbol& pCopy)
     : m_pResolveInfo(pCopy.m_pResolveInfo),
       m_pFragRef(pCopy.m_pFragRef),
-      m_Value(pCopy.m_Value) {
+      m_Value(pCopy.m_Value),
+      m_SymIdx(pCopy.m_SymIdx),
+      m_CategoryPos(~0U) {
 }
 
 LDSymbol& LDSymbol::operator=(const LDSymbol& pCopy) {
   m_pResolveInfo = pCopy.m_pResolveInfo;
   m_pFragRef = pCopy.m_pFragRef;
   m_Value = pCopy.m_Value;
+  m_SymIdx = pCopy.m_SymIdx;
   return (*this);
 }
 
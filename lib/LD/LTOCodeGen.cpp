@@ -0,0 +1,191 @@
+//===- LTOCodeGen.cpp -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/LTOCodeGen.h"
+
+#include "mcld/IRBuilder.h"
+#include "mcld/Module.h"
+#include "mcld/Config/Config.h"
+#include "mcld/MC/Input.h"
+#include "mcld/MC/InputBuilder.h"
+#include "mcld/Support/FileHandle.h"
+#include "mcld/Support/FileSystem.h"
+#include "mcld/Support/MemoryArea.h"
+#include "mcld/Support/MsgHandling.h"
+#include "mcld/Support/Statistic.h"
+#include "mcld/Support/ThreadPool.h"
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace mcld {
+
+static Statistic NumCompiled("lto.compiled-modules",
+                             "The # of compiled bitcode modules");
+static Statistic NumCached("lto.cached-modules",
+                           "The # of bitcode modules found in the cache");
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// getObjectPath - the object in pDir of the module pBitcode compiled by the
+/// compiler whose key is pKey
+std::string getObjectPath(const std::string& pDir,
+                          const std::string& pKey,
+                          llvm::StringRef pBitcode) {
+  std::string key;
+  llvm::raw_string_ostream key_os(key);
+  key_os << MCLD_VERSION << '\0' << pKey << '\0';
+  key_os.flush();
+
+  llvm::SHA1 sha1;
+  sha1.update(llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t*>(key.data()), key.size()));
+  sha1.update(llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t*>(pBitcode.data()), pBitcode.size()));
+  std::string digest = llvm::toHex(llvm::StringRef(
+      reinterpret_cast<const char*>(sha1.final().data()), 20));
+
+  llvm::SmallString<256> path(pDir);
+  llvm::sys::path::append(path, digest + ".o");
+  return path.str().str();
+}
+
+/// writeObject - write pObject aside and rename it to pPath, so that the
+/// links sharing the directory never read a partial object. Failing to
+/// write is not an error.
+void writeObject(const std::string& pPath, const std::string& pObject) {
+  int fd = -1;
+  llvm::SmallString<256> temp;
+  if (llvm::sys::fs::createUniqueFile(pPath + "-%%%%%%", fd, temp))
+    return;
+  {
+    llvm::raw_fd_ostream out(fd, /*shouldClose*/ true);
+    out << pObject;
+    out.close();
+    if (out.has_error()) {
+      out.clear_error();
+      llvm::sys::fs::remove(temp.str());
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(temp.str(), pPath))
+    llvm::sys::fs::remove(temp.str());
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// LTOCodeGen
+//===----------------------------------------------------------------------===//
+LTOCodeGen::LTOCodeGen(BitcodeCompiler& pCompiler,
+                       const std::string& pCacheDir)
+    : m_Compiler(pCompiler), m_CacheDir(pCacheDir), m_NumOfObjects(0) {
+}
+
+LTOCodeGen::~LTOCodeGen() {
+  std::vector<std::string*>::iterator object, objEnd = m_Objects.end();
+  for (object = m_Objects.begin(); object != objEnd; ++object)
+    delete *object;
+}
+
+bool LTOCodeGen::isBitcode(Input& pInput) {
+  if (!pInput.hasMemArea() ||
+      pInput.memArea()->size() < static_cast<size_t>(pInput.fileOffset()) + 4)
+    return false;
+
+  // the raw bitcode magic 'BC' 0xC0DE, and the magic 0x0B17C0DE of the
+  // wrapper in little endian
+  llvm::StringRef magic = pInput.memArea()->request(pInput.fileOffset(), 4);
+  return magic == llvm::StringRef("BC\xC0\xDE", 4) ||
+         magic == llvm::StringRef("\xDE\xC0\x17\x0B", 4);
+}
+
+bool LTOCodeGen::run(Module& pModule, IRBuilder& pBuilder, ThreadPool& pPool) {
+  // The bitcode inputs are External, and no reader reads them. The inputs
+  // given by --bitcode are not mapped yet.
+  std::vector<Input*> modules;
+  std::vector<llvm::StringRef> contents;
+  Module::InputList::const_iterator input,
+      inEnd = pModule.getInputList().end();
+  for (input = pModule.getInputList().begin(); input != inEnd; ++input) {
+    if (Input::External != (*input)->type() || m_Compiled.count(*input) != 0)
+      continue;
+    if (!(*input)->hasMemArea() && sys::fs::exists((*input)->path())) {
+      pBuilder.getInputBuilder().setMemory(
+          **input,
+          FileHandle::OpenMode(FileHandle::ReadOnly),
+          FileHandle::Permission(FileHandle::System));
+    }
+    if (!isBitcode(**input))
+      continue;
+
+    MemoryArea* area = (*input)->memArea();
+    modules.push_back(*input);
+    contents.push_back(area->request(
+        (*input)->fileOffset(), area->size() - (*input)->fileOffset()));
+    m_Compiled.insert(*input);
+  }
+
+  // compile the modules which are not in the cache
+  std::string key = m_Compiler.getCacheKey();
+  std::vector<std::string> paths(modules.size());
+  std::vector<std::string*> objects(modules.size(), NULL);
+  std::vector<char> failed(modules.size(), 0);
+  parallelFor(pPool, 0, modules.size(), [&](size_t pIndex) {
+    if (!m_CacheDir.empty()) {
+      paths[pIndex] = getObjectPath(m_CacheDir, key, contents[pIndex]);
+      if (llvm::sys::fs::exists(paths[pIndex]))
+        return;
+    }
+
+    std::string* object = new std::string();
+    if (!m_Compiler.compile(modules[pIndex]->name(), contents[pIndex],
+                            *object)) {
+      delete object;
+      failed[pIndex] = 1;
+      return;
+    }
+    objects[pIndex] = object;
+    if (!paths[pIndex].empty())
+      writeObject(paths[pIndex], *object);
+  });
+
+  // add the objects in the order of their modules, so the link does not
+  // depend on the number of threads
+  bool result = true;
+  for (size_t i = 0; i < modules.size(); ++i) {
+    if (failed[i] != 0) {
+      error(diag::err_cannot_compile_bitcode) << modules[i]->name()
+                                              << modules[i]->path();
+      result = false;
+      continue;
+    }
+
+    std::string name = modules[i]->name() + ".lto.o";
+    if (objects[i] == NULL) {
+      pBuilder.ReadInput(name, sys::fs::Path(paths[i]));
+      ++NumCached;
+    } else {
+      m_Objects.push_back(objects[i]);
+      pBuilder.ReadInput(name, &(*objects[i])[0], objects[i]->size());
+      ++NumCompiled;
+    }
+    ++m_NumOfObjects;
+  }
+  return result;
+}
+
+}  // namespace mcld
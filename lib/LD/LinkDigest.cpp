@@ -0,0 +1,153 @@
+//===- LinkDigest.cpp -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/LinkDigest.h"
+
+#include "mcld/Module.h"
+#include "mcld/Fragment/Fragment.h"
+#include "mcld/Fragment/FragmentRef.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/LD/LDSymbol.h"
+#include "mcld/LD/NamePool.h"
+#include "mcld/LD/ResolveInfo.h"
+#include "mcld/LD/SectionData.h"
+
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+
+namespace mcld {
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+void writeValue(llvm::raw_ostream& pOS, uint64_t pValue) {
+  pOS.write(reinterpret_cast<const char*>(&pValue), sizeof(pValue));
+}
+
+/// hashSymbol - the hash of pInfo and of where its output symbol is
+uint64_t hashSymbol(const ResolveInfo& pInfo) {
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  os << pInfo.name() << '\0';
+  writeValue(os, pInfo.bitfield());
+  writeValue(os, pInfo.size());
+  const LDSymbol* symbol = pInfo.outSymbol();
+  if (symbol != NULL) {
+    writeValue(os, symbol->value());
+    if (symbol->hasFragRef()) {
+      const Fragment* frag = symbol->fragRef()->frag();
+      if (frag != NULL && frag->getParent() != NULL)
+        os << frag->getParent()->getSection().name() << '\0';
+      writeValue(os, symbol->fragRef()->getOutputOffset());
+    }
+  }
+  os.flush();
+  return llvm::xxHash64(key);
+}
+
+/// hashSections - the hash of the output sections of pModule and of the
+/// fragments they hold, in their order
+uint64_t hashSections(const Module& pModule) {
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  Module::const_iterator sect, sectEnd = pModule.end();
+  for (sect = pModule.begin(); sect != sectEnd; ++sect) {
+    os << (*sect)->name() << '\0';
+    writeValue(os, (*sect)->kind());
+    writeValue(os, (*sect)->type());
+    writeValue(os, (*sect)->flag());
+    writeValue(os, (*sect)->align());
+    writeValue(os, (*sect)->addr());
+    writeValue(os, (*sect)->offset());
+    writeValue(os, (*sect)->size());
+    writeValue(os, (*sect)->index());
+    if (!(*sect)->hasSectionData())
+      continue;
+    const SectionData* data = (*sect)->getSectionData();
+    SectionData::const_iterator frag, fragEnd = data->end();
+    for (frag = data->begin(); frag != fragEnd; ++frag) {
+      writeValue(os, frag->getKind());
+      writeValue(os, frag->getOffset());
+      writeValue(os, frag->size());
+    }
+  }
+  os.flush();
+  return llvm::xxHash64(key);
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// LinkDigest
+//===----------------------------------------------------------------------===//
+LinkDigest::LinkDigest() {
+}
+
+LinkDigest::~LinkDigest() {
+}
+
+void LinkDigest::addPhase(llvm::StringRef pPhase, const Module& pModule) {
+  // the symbols are added up, so the order of the name pool does not count
+  Entry entry;
+  entry.phase = pPhase;
+  entry.symbols = 0;
+  const NamePool& names = pModule.getNamePool();
+  NamePool::const_syminfo_iterator info, infoEnd = names.syminfo_end();
+  for (info = names.syminfo_begin(); info != infoEnd; ++info)
+    entry.symbols += hashSymbol(*info.getEntry());
+  NamePool::const_freeinfo_iterator free, freeEnd = names.freeinfo_end();
+  for (free = names.freeinfo_begin(); free != freeEnd; ++free)
+    entry.symbols += hashSymbol(**free);
+  entry.sections = hashSections(pModule);
+  entry.output = 0;
+  m_Entries.push_back(entry);
+}
+
+void LinkDigest::addOutput(llvm::StringRef pContents) {
+  Entry entry;
+  entry.phase = "output";
+  entry.symbols = 0;
+  entry.sections = 0;
+  entry.output = llvm::xxHash64(pContents);
+  m_Entries.push_back(entry);
+}
+
+void LinkDigest::write(llvm::raw_ostream& pOS) const {
+  const char* line = "%s %016llx %016llx %016llx\n";
+  for (size_t i = 0; i < m_Entries.size(); ++i) {
+    const Entry& entry = m_Entries[i];
+    pOS << llvm::format(line, entry.phase.c_str(),
+                        static_cast<unsigned long long>(entry.symbols),
+                        static_cast<unsigned long long>(entry.sections),
+                        static_cast<unsigned long long>(entry.output));
+  }
+}
+
+bool LinkDigest::read(llvm::StringRef pContents) {
+  m_Entries.clear();
+  llvm::SmallVector<llvm::StringRef, 64> lines;
+  pContents.split(lines, '\n', /* MaxSplit */-1, /* KeepEmpty */false);
+  for (size_t i = 0; i < lines.size(); ++i) {
+    llvm::SmallVector<llvm::StringRef, 4> fields;
+    lines[i].split(fields, ' ');
+    Entry entry;
+    if (fields.size() != 4 || fields[1].getAsInteger(16, entry.symbols) ||
+        fields[2].getAsInteger(16, entry.sections) ||
+        fields[3].getAsInteger(16, entry.output))
+      return false;
+    entry.phase = fields[0];
+    m_Entries.push_back(entry);
+  }
+  return true;
+}
+
+}  // namespace mcld
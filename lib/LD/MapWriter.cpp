@@ -0,0 +1,143 @@
+//===- MapWriter.cpp ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/MapWriter.h"
+
+#include "mcld/Module.h"
+#include "mcld/Fragment/Fragment.h"
+#include "mcld/Fragment/FragmentRef.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/LD/LDSymbol.h"
+#include "mcld/LD/ResolveInfo.h"
+#include "mcld/LD/SectionData.h"
+#include "mcld/MC/Input.h"
+
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace mcld {
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// Item - an input section or a symbol laid out in an output section
+struct Item {
+  uint64_t offset;
+  const Input* input;
+  const LDSection* section;
+  const LDSymbol* symbol;
+};
+
+/// ItemCompare - the input sections before the symbols at their start
+struct ItemCompare {
+  bool operator()(const Item& pX, const Item& pY) const {
+    if (pX.offset != pY.offset)
+      return pX.offset < pY.offset;
+    return pX.symbol == NULL && pY.symbol != NULL;
+  }
+};
+
+typedef std::unordered_map<const LDSection*, std::vector<Item> > ItemMap;
+
+void writeColumns(llvm::raw_ostream& pOS,
+                  uint64_t pAddr,
+                  uint64_t pSize,
+                  uint64_t pAlign) {
+  pOS << llvm::format("%16llx %8llx %5llu ",
+                      static_cast<unsigned long long>(pAddr),
+                      static_cast<unsigned long long>(pSize),
+                      static_cast<unsigned long long>(pAlign));
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// MapWriter
+//===----------------------------------------------------------------------===//
+MapWriter::MapWriter() {
+}
+
+MapWriter::~MapWriter() {
+}
+
+void MapWriter::record(const Input& pInput, const LDSection& pSection) {
+  // the fragments of the merged strings are replaced when the strings are
+  // merged, so such a section shows up in its output section only
+  if (!pSection.hasSectionData() || pSection.getSectionData()->empty() ||
+      (pSection.flag() & llvm::ELF::SHF_MERGE) != 0)
+    return;
+
+  Entry entry;
+  entry.input = &pInput;
+  entry.section = &pSection;
+  entry.first = &pSection.getSectionData()->front();
+  m_Entries.push_back(entry);
+}
+
+void MapWriter::write(llvm::raw_ostream& pOS, const Module& pModule) const {
+  // the first fragments and the symbols now belong to the output sections
+  ItemMap items;
+  std::vector<Entry>::const_iterator entry, eEnd = m_Entries.end();
+  for (entry = m_Entries.begin(); entry != eEnd; ++entry) {
+    Item item = {
+        entry->first->getOffset(), entry->input, entry->section, NULL};
+    items[&entry->first->getParent()->getSection()].push_back(item);
+  }
+
+  Module::const_sym_iterator symbol, symEnd = pModule.sym_end();
+  for (symbol = pModule.sym_begin(); symbol != symEnd; ++symbol) {
+    const ResolveInfo* info = (*symbol)->resolveInfo();
+    if (info == NULL || !info->isDefine() || !(*symbol)->hasFragRef() ||
+        info->type() == ResolveInfo::Section ||
+        info->type() == ResolveInfo::File)
+      continue;
+    const FragmentRef* ref = (*symbol)->fragRef();
+    Item item = {ref->getOutputOffset(), NULL, NULL, *symbol};
+    items[&ref->frag()->getParent()->getSection()].push_back(item);
+  }
+
+  pOS << "             VMA     Size Align Out     In      Symbol\n";
+  Module::const_iterator out, outEnd = pModule.end();
+  for (out = pModule.begin(); out != outEnd; ++out) {
+    if (LDFileFormat::Null == (*out)->kind())
+      continue;
+    writeColumns(pOS, (*out)->addr(), (*out)->size(), (*out)->align());
+    pOS << (*out)->name() << "\n";
+
+    ItemMap::iterator list = items.find(*out);
+    if (list == items.end())
+      continue;
+    std::stable_sort(list->second.begin(), list->second.end(), ItemCompare());
+
+    std::vector<Item>::const_iterator item, itemEnd = list->second.end();
+    for (item = list->second.begin(); item != itemEnd; ++item) {
+      uint64_t addr = (*out)->addr() + item->offset;
+      if (item->symbol == NULL) {
+        writeColumns(pOS, addr, item->section->size(), item->section->align());
+        pOS << "        " << item->input->path().native();
+        if (item->input->fileOffset() != 0)
+          pOS << "(" << item->input->name() << ")";
+        pOS << ":(" << item->section->name() << ")\n";
+      } else {
+        pOS << llvm::format("%16llx %8llx       ",
+                            static_cast<unsigned long long>(addr),
+                            static_cast<unsigned long long>(
+                                item->symbol->resolveInfo()->size()));
+        pOS << "                " << item->symbol->name() << "\n";
+      }
+    }
+  }
+}
+
+}  // namespace mcld
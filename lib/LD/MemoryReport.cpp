@@ -0,0 +1,255 @@
+//===- MemoryReport.cpp ---------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/MemoryReport.h"
+
+#include "mcld/Module.h"
+#include "mcld/Fragment/AlignFragment.h"
+#include "mcld/Fragment/FillFragment.h"
+#include "mcld/Fragment/NullFragment.h"
+#include "mcld/Fragment/RegionFragment.h"
+#include "mcld/Fragment/Relocation.h"
+#include "mcld/Fragment/Stub.h"
+#include "mcld/Fragment/TargetFragment.h"
+#include "mcld/LD/DebugString.h"
+#include "mcld/LD/EhFrame.h"
+#include "mcld/LD/LDContext.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/LD/NamePool.h"
+#include "mcld/LD/RelocData.h"
+#include "mcld/LD/ResolveInfo.h"
+#include "mcld/LD/SectionData.h"
+#include "mcld/MC/Input.h"
+#include "mcld/Support/MemoryArea.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace mcld {
+
+static MemoryReport* g_pCurrentReport = NULL;
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// getFragmentSize - the bytes of the object of pFragment. The fragments of
+/// the targets and the stubs are counted by their base classes.
+size_t getFragmentSize(const Fragment& pFragment) {
+  switch (pFragment.getKind()) {
+    case Fragment::Alignment:
+      return sizeof(AlignFragment);
+    case Fragment::Fillment:
+      return sizeof(FillFragment);
+    case Fragment::Region:
+      return sizeof(RegionFragment);
+    case Fragment::Target:
+      return sizeof(TargetFragment);
+    case Fragment::Stub:
+      return sizeof(Stub);
+    case Fragment::Null:
+      return sizeof(NullFragment);
+  }
+  return sizeof(Fragment);
+}
+
+/// Totals - the structures of the sections of a module
+struct Totals {
+  Totals()
+      : fragments(0), fragment_bytes(0), section_data(0), relocations(0),
+        records(0), record_bytes(0), strings(0), string_bytes(0) {}
+
+  uint64_t fragments;
+  uint64_t fragment_bytes;
+  uint64_t section_data;
+  uint64_t relocations;
+  uint64_t records;
+  uint64_t record_bytes;
+  uint64_t strings;
+  uint64_t string_bytes;
+};
+
+void addSectionData(const SectionData& pData, Totals& pTotals) {
+  ++pTotals.section_data;
+  SectionData::const_iterator frag, fragEnd = pData.end();
+  for (frag = pData.begin(); frag != fragEnd; ++frag) {
+    ++pTotals.fragments;
+    pTotals.fragment_bytes += getFragmentSize(*frag);
+  }
+}
+
+void addSection(const LDSection& pSection, Totals& pTotals) {
+  switch (pSection.kind()) {
+    case LDFileFormat::Relocation:
+      if (pSection.hasRelocData())
+        pTotals.relocations += pSection.getRelocData()->size();
+      break;
+    case LDFileFormat::EhFrame:
+      if (pSection.hasEhFrame()) {
+        const EhFrame* eh_frame = pSection.getEhFrame();
+        uint64_t cies = eh_frame->numOfCIEs();
+        uint64_t fdes = eh_frame->numOfFDEs();
+        pTotals.records += cies + fdes;
+        pTotals.record_bytes += cies * sizeof(EhFrame::CIE) +
+                                fdes * sizeof(EhFrame::FDE) + sizeof(EhFrame);
+      }
+      break;
+    case LDFileFormat::DebugString:
+      if (pSection.hasDebugString()) {
+        const MergedStringTable& table =
+            pSection.getDebugString()->getStringTable();
+        pTotals.strings += table.numOfStrings();
+        pTotals.string_bytes += table.memoryUsage();
+      }
+      break;
+    default:
+      if (pSection.hasSectionData())
+        addSectionData(*pSection.getSectionData(), pTotals);
+      break;
+  }
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// MemoryReport
+//===----------------------------------------------------------------------===//
+MemoryReport::MemoryReport() {
+}
+
+MemoryReport::~MemoryReport() {
+  if (g_pCurrentReport == this)
+    g_pCurrentReport = NULL;
+}
+
+MemoryReport* MemoryReport::Current() {
+  return g_pCurrentReport;
+}
+
+void MemoryReport::SetCurrent(MemoryReport* pReport) {
+  g_pCurrentReport = pReport;
+}
+
+void MemoryReport::add(llvm::StringRef pName,
+                       uint64_t pObjects,
+                       uint64_t pBytes) {
+  std::vector<Usage>::iterator usage, usageEnd = m_Current.end();
+  for (usage = m_Current.begin(); usage != usageEnd; ++usage) {
+    if (usage->name == pName) {
+      usage->objects += pObjects;
+      usage->bytes += pBytes;
+      return;
+    }
+  }
+
+  Usage entry;
+  entry.name = pName;
+  entry.objects = pObjects;
+  entry.bytes = pBytes;
+  m_Current.push_back(entry);
+}
+
+void MemoryReport::addModule(const Module& pModule) {
+  // the resolved symbols and the local ones, with their names
+  const NamePool& names = pModule.getNamePool();
+  uint64_t infos = 0;
+  uint64_t info_bytes = 0;
+  NamePool::const_syminfo_iterator info, infoEnd = names.syminfo_end();
+  for (info = names.syminfo_begin(); info != infoEnd; ++info) {
+    ++infos;
+    info_bytes += sizeof(ResolveInfo) + info.getEntry()->nameSize() + 1;
+  }
+  NamePool::const_freeinfo_iterator free, freeEnd = names.freeinfo_end();
+  for (free = names.freeinfo_begin(); free != freeEnd; ++free) {
+    ++infos;
+    info_bytes += sizeof(ResolveInfo) + (*free)->nameSize() + 1;
+  }
+  add("NamePool", infos, info_bytes);
+
+  // a fragment belongs to an input section until the sections are merged,
+  // and to its output section afterwards, so it is counted once
+  Totals totals;
+  llvm::DenseSet<const MemoryArea*> areas;
+  Module::const_obj_iterator obj, objEnd = pModule.obj_end();
+  for (obj = pModule.obj_begin(); obj != objEnd; ++obj) {
+    if ((*obj)->hasMemArea())
+      areas.insert((*obj)->memArea());
+    const LDContext* context = (*obj)->context();
+    if (context == NULL)
+      continue;
+    LDContext::const_sect_iterator sect, sectEnd = context->sectEnd();
+    for (sect = context->sectBegin(); sect != sectEnd; ++sect) {
+      if (*sect != NULL)
+        addSection(**sect, totals);
+    }
+  }
+  Module::const_iterator sect, sectEnd = pModule.end();
+  for (sect = pModule.begin(); sect != sectEnd; ++sect)
+    addSection(**sect, totals);
+
+  add("Relocation", totals.relocations,
+      totals.relocations * sizeof(Relocation));
+  add("Fragment", totals.fragments, totals.fragment_bytes);
+  add("SectionData", totals.section_data,
+      totals.section_data * sizeof(SectionData));
+  add("EhFrame", totals.records, totals.record_bytes);
+  add("DebugString", totals.strings, totals.string_bytes);
+
+  // the inputs are mapped rather than read, so these bytes are only
+  // resident once they are touched
+  Module::const_lib_iterator lib, libEnd = pModule.lib_end();
+  for (lib = pModule.lib_begin(); lib != libEnd; ++lib) {
+    if ((*lib)->hasMemArea())
+      areas.insert((*lib)->memArea());
+  }
+  Module::InputList::const_iterator input,
+      inEnd = pModule.getInputList().end();
+  for (input = pModule.getInputList().begin(); input != inEnd; ++input) {
+    if ((*input)->hasMemArea())
+      areas.insert((*input)->memArea());
+  }
+  uint64_t mapped = 0;
+  llvm::DenseSet<const MemoryArea*>::const_iterator area,
+      areaEnd = areas.end();
+  for (area = areas.begin(); area != areaEnd; ++area)
+    mapped += (*area)->size();
+  add("MemoryArea", areas.size(), mapped);
+}
+
+void MemoryReport::endSample(llvm::StringRef pPhase) {
+  Sample sample;
+  sample.phase = pPhase;
+  sample.usages.swap(m_Current);
+  m_Samples.push_back(sample);
+}
+
+void MemoryReport::print(llvm::raw_ostream& pOS) const {
+  const char* objects = "objects";
+  const char* bytes = "bytes";
+  const char* total_name = "total";
+  const char* none = "";
+  for (size_t i = 0; i < m_Samples.size(); ++i) {
+    const Sample& sample = m_Samples[i];
+    std::string title = "after " + sample.phase;
+    pOS << llvm::format("%-24s %15s %14s\n", title.c_str(), objects, bytes);
+    uint64_t total = 0;
+    for (size_t j = 0; j < sample.usages.size(); ++j) {
+      const Usage& usage = sample.usages[j];
+      pOS << llvm::format("  %-22s %15llu %14llu\n", usage.name.c_str(),
+                          static_cast<unsigned long long>(usage.objects),
+                          static_cast<unsigned long long>(usage.bytes));
+      total += usage.bytes;
+    }
+    pOS << llvm::format("  %-22s %15s %14llu\n", total_name, none,
+                        static_cast<unsigned long long>(total));
+  }
+}
+
+}  // namespace mcld
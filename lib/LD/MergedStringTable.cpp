@@ -8,35 +8,263 @@
 //===----------------------------------------------------------------------===//
 #include "mcld/LD/MergedStringTable.h"
 
+#include "mcld/ADT/StringHash.h"
+#include "mcld/Support/ThreadPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
 namespace mcld {
 
-bool MergedStringTable::insertString(llvm::StringRef pString) {
-  return m_StringMap.insert(std::make_pair(pString, 0)).second;
+typedef MergedStringTable::StringMapTy::MapEntryTy StringEntry;
+
+/// getShard - the shard that holds pStr. The hash differs from the one of
+/// llvm::StringMap so that the strings of a shard still spread over its
+/// buckets.
+static unsigned getShard(llvm::StringRef pStr) {
+  hash::StringHash<hash::MURMUR> hasher;
+  return hasher(pStr) % MergedStringTable::NumShards;
+}
+
+/// isReverseLess - compare the strings from their last characters, so that a
+/// string sorts right before the strings that end with it.
+static bool isReverseLess(const StringEntry* pA, const StringEntry* pB) {
+  llvm::StringRef a = pA->getKey();
+  llvm::StringRef b = pB->getKey();
+  size_t len = std::min(a.size(), b.size());
+  for (size_t i = 1; i <= len; ++i) {
+    unsigned char ca = a[a.size() - i];
+    unsigned char cb = b[b.size() - i];
+    if (ca != cb)
+      return ca < cb;
+  }
+  return a.size() < b.size();
+}
+
+//===----------------------------------------------------------------------===//
+// MergedStringTable
+//===----------------------------------------------------------------------===//
+MergedStringTable::MergedStringTable(unsigned pEntSize, bool pIsStrings)
+    : m_EntSize(pEntSize == 0 ? 1 : pEntSize),
+      m_TermSize(pIsStrings ? m_EntSize : 0),
+      m_Shards(NumShards) {
+}
+
+void MergedStringTable::addStrings(llvm::StringRef pStrings) {
+  m_Blocks.push_back(pStrings);
+}
+
+bool MergedStringTable::isTerminator(llvm::StringRef pBlock,
+                                     uint64_t pOffset) const {
+  size_t end = std::min<uint64_t>(pOffset + m_EntSize, pBlock.size());
+  for (size_t i = pOffset; i < end; ++i) {
+    if (pBlock[i] != 0)
+      return false;
+  }
+  return true;
+}
+
+llvm::StringRef MergedStringTable::getPiece(llvm::StringRef pBlock,
+                                            uint64_t pOffset) const {
+  if (m_TermSize == 0)
+    return pBlock.substr(pOffset, m_EntSize);
+
+  if (m_EntSize == 1) {
+    const char* str = pBlock.begin() + pOffset;
+    const void* nul = ::memchr(str, 0, pBlock.size() - pOffset);
+    if (nul == NULL)
+      return pBlock.substr(pOffset);
+    return llvm::StringRef(str, static_cast<const char*>(nul) - str);
+  }
+
+  uint64_t end = pOffset;
+  while ((end < pBlock.size()) && !isTerminator(pBlock, end))
+    end += m_EntSize;
+  return pBlock.slice(pOffset, end);
+}
+
+void MergedStringTable::fillShards(ThreadPool& pPool) {
+  // Split the blocks into strings and pick the shard of each string.
+  typedef std::vector<std::pair<llvm::StringRef, unsigned> > Strings;
+  std::vector<Strings> split(m_Blocks.size());
+  parallelFor(pPool, 0, m_Blocks.size(), [this, &split](size_t pIndex) {
+    llvm::StringRef block = m_Blocks[pIndex];
+    uint64_t offset = 0;
+    while (offset < block.size()) {
+      llvm::StringRef piece = getPiece(block, offset);
+      split[pIndex].push_back(std::make_pair(piece, getShard(piece)));
+      offset += piece.size() + m_TermSize;
+    }
+  });
+
+  // Every shard takes its own strings in input order.
+  parallelFor(pPool, 0, NumShards, [this, &split](size_t pShard) {
+    StringMapTy& strings = m_Shards[pShard].strings;
+    std::vector<Strings>::const_iterator block, blockEnd = split.end();
+    for (block = split.begin(); block != blockEnd; ++block) {
+      Strings::const_iterator it, itEnd = block->end();
+      for (it = block->begin(); it != itEnd; ++it) {
+        if (it->second == pShard)
+          strings.insert(std::make_pair(it->first, Piece()));
+      }
+    }
+  });
+  m_Blocks.clear();
 }
 
-uint64_t MergedStringTable::finalizeOffset() {
-  // trverse the string table and set the offset
-  string_map_iterator it, end = m_StringMap.end();
-  size_t offset = 0;
-  for (it = m_StringMap.begin(); it != end; ++it) {
-    it->setValue(offset);
-    offset += it->getKey().size() + 1;
+void MergedStringTable::mergeTails(ThreadPool& pPool) {
+  // fixed-size entries have no tails to share
+  if (m_TermSize == 0)
+    return;
+
+  // Sort the strings of each shard, then merge the sorted shards pairwise.
+  std::vector<size_t> bounds(NumShards + 1, 0);
+  for (unsigned i = 0; i < NumShards; ++i)
+    bounds[i + 1] = bounds[i] + m_Shards[i].strings.size();
+
+  std::vector<StringEntry*> entries(bounds[NumShards]);
+  if (entries.empty())
+    return;
+
+  parallelFor(pPool, 0, NumShards, [this, &bounds, &entries](size_t pShard) {
+    std::vector<StringEntry*>::iterator out = entries.begin() + bounds[pShard];
+    string_map_iterator it, itEnd = m_Shards[pShard].strings.end();
+    for (it = m_Shards[pShard].strings.begin(); it != itEnd; ++it)
+      *(out++) = &(*it);
+    std::sort(entries.begin() + bounds[pShard],
+              entries.begin() + bounds[pShard + 1],
+              isReverseLess);
+  });
+
+  for (size_t width = 1; width < NumShards; width *= 2) {
+    parallelFor(pPool, 0, NumShards / (2 * width), [&](size_t pPair) {
+      size_t first = bounds[2 * width * pPair];
+      size_t middle = bounds[2 * width * pPair + width];
+      size_t last = bounds[2 * width * (pPair + 1)];
+      std::inplace_merge(entries.begin() + first,
+                         entries.begin() + middle,
+                         entries.begin() + last,
+                         isReverseLess);
+    });
+  }
+
+  // If the next string ends with this one, this one is a suffix of every
+  // string that the next one is a suffix of.
+  for (size_t i = entries.size() - 1; i > 0; --i) {
+    StringEntry* cur = entries[i - 1];
+    StringEntry* next = entries[i];
+    if (!next->getKey().endswith(cur->getKey()))
+      continue;
+
+    // wide characters are only shared at a character boundary
+    if (((next->getKey().size() - cur->getKey().size()) % m_EntSize) != 0)
+      continue;
+
+    Piece& piece = cur->getValue();
+    Piece& next_piece = next->getValue();
+    piece.owner = (next_piece.owner != NULL) ? next_piece.owner : &next_piece;
+    piece.delta =
+        next_piece.delta + next->getKey().size() - cur->getKey().size();
   }
+}
+
+uint64_t MergedStringTable::finalizeOffset(ThreadPool& pPool) {
+  fillShards(pPool);
+  mergeTails(pPool);
+
+  // Lay out the emitted strings of each shard.
+  parallelFor(pPool, 0, NumShards, [this](size_t pShard) {
+    Shard& shard = m_Shards[pShard];
+    string_map_iterator it, itEnd = shard.strings.end();
+    for (it = shard.strings.begin(); it != itEnd; ++it) {
+      if (it->getValue().owner == NULL) {
+        it->getValue().offset = shard.size;
+        shard.size += it->getKey().size() + m_TermSize;
+      }
+    }
+  });
+
+  // Place the shards one after another.
+  uint64_t offset = 0;
+  for (unsigned i = 0; i < NumShards; ++i) {
+    m_Shards[i].base = offset;
+    offset += m_Shards[i].size;
+  }
+
+  parallelFor(pPool, 0, NumShards, [this](size_t pShard) {
+    Shard& shard = m_Shards[pShard];
+    string_map_iterator it, itEnd = shard.strings.end();
+    for (it = shard.strings.begin(); it != itEnd; ++it) {
+      if (it->getValue().owner == NULL)
+        it->getValue().offset += shard.base;
+    }
+  });
+
+  // The suffixes point into their owners, which may be in other shards.
+  parallelFor(pPool, 0, NumShards, [this](size_t pShard) {
+    string_map_iterator it, itEnd = m_Shards[pShard].strings.end();
+    for (it = m_Shards[pShard].strings.begin(); it != itEnd; ++it) {
+      Piece& piece = it->getValue();
+      if (piece.owner != NULL)
+        piece.offset = piece.owner->offset + piece.delta;
+    }
+  });
   return offset;
 }
 
 void MergedStringTable::emit(MemoryRegion& pRegion) {
   char* ptr = reinterpret_cast<char*>(pRegion.begin());
-  string_map_iterator it, end = m_StringMap.end();
-  for (it = m_StringMap.begin(); it != end; ++it) {
-    ::memcpy(ptr, it->getKey().data(), it->getKey().size());
-    ptr += it->getKey().size() + 1;
+  std::vector<Shard>::iterator shard, shardEnd = m_Shards.end();
+  for (shard = m_Shards.begin(); shard != shardEnd; ++shard) {
+    string_map_iterator it, end = shard->strings.end();
+    for (it = shard->strings.begin(); it != end; ++it) {
+      if (it->getValue().owner == NULL) {
+        ::memcpy(ptr + it->getValue().offset,
+                 it->getKey().data(),
+                 it->getKey().size());
+      }
+    }
   }
 }
 
-size_t MergedStringTable::getOutputOffset(llvm::StringRef pStr) {
-  assert(m_StringMap.find(pStr) != m_StringMap.end());
-  return m_StringMap[pStr];
+size_t MergedStringTable::getOutputOffset(llvm::StringRef pStr) const {
+  const StringMapTy& strings = m_Shards[getShard(pStr)].strings;
+  const_string_map_iterator it = strings.find(pStr);
+  assert(it != strings.end());
+  return it->getValue().offset;
+}
+
+uint64_t MergedStringTable::getOutputOffset(llvm::StringRef pBlock,
+                                            uint64_t pOffset) const {
+  // find the beginning of the piece that holds pOffset
+  uint64_t begin = pOffset - (pOffset % m_EntSize);
+  if (m_TermSize != 0) {
+    while ((begin >= m_EntSize) && !isTerminator(pBlock, begin - m_EntSize))
+      begin -= m_EntSize;
+  }
+  return getOutputOffset(getPiece(pBlock, begin)) + (pOffset - begin);
+}
+
+size_t MergedStringTable::numOfStrings() const {
+  size_t result = 0;
+  for (size_t i = 0; i < m_Shards.size(); ++i)
+    result += m_Shards[i].strings.size();
+  return result;
+}
+
+uint64_t MergedStringTable::memoryUsage() const {
+  // a string map owns a copy of every key after its entry
+  uint64_t result = m_Blocks.capacity() * sizeof(llvm::StringRef) +
+                    m_Shards.capacity() * sizeof(Shard);
+  for (size_t i = 0; i < m_Shards.size(); ++i) {
+    const StringMapTy& strings = m_Shards[i].strings;
+    result += strings.getNumBuckets() * (sizeof(void*) + sizeof(unsigned));
+    const_string_map_iterator it, itEnd = strings.end();
+    for (it = strings.begin(); it != itEnd; ++it)
+      result += sizeof(StringEntry) + it->getKey().size() + 1;
+  }
+  return result;
 }
 
 }  // namespace mcld
@@ -29,7 +29,8 @@ void MsgHandler::addString(llvm::StringRef pStr) const {
   assert(m_NumArgs < DiagnosticEngine::MaxArguments &&
          "Too many arguments to diagnostic!");
   m_Engine.state().ArgumentKinds[m_NumArgs] = DiagnosticEngine::ak_std_string;
-  m_Engine.state().ArgumentStrs[m_NumArgs++] = pStr.data();
+  m_Engine.state().ArgumentStrs[m_NumArgs++].assign(pStr.data(),
+                                                    pStr.size());
 }
 
 void MsgHandler::addString(const std::string& pStr) const {
@@ -9,11 +9,18 @@
 #include "mcld/LD/NamePool.h"
 
 #include "mcld/LD/StaticResolver.h"
+#include "mcld/MC/Input.h"
+#include "mcld/Support/Statistic.h"
 
 #include <llvm/Support/raw_ostream.h>
 
 namespace mcld {
 
+static Statistic NumInsertSymbol("namepool.insert-symbol",
+                                 "The # of symbols inserted");
+static Statistic NumExistSymbol("namepool.existent-symbol",
+                                "The # of symbols resolved against another");
+
 //===----------------------------------------------------------------------===//
 // NamePool
 //===----------------------------------------------------------------------===//
@@ -22,12 +29,8 @@ NamePool::NamePool(NamePool::size_type pSize)
 }
 
 NamePool::~NamePool() {
+  // the free ResolveInfos are released with the entry factory of the table
   delete m_pResolver;
-
-  FreeInfoSet::iterator info, iEnd = m_FreeInfoSet.end();
-  for (info = m_FreeInfoSet.begin(); info != iEnd; ++info) {
-    ResolveInfo::Destroy(*info);
-  }
 }
 
 /// createSymbol - create a symbol
@@ -39,7 +42,7 @@ ResolveInfo* NamePool::createSymbol(const llvm::StringRef& pName,
                                     ResolveInfo::SizeType pSize,
                                     ResolveInfo::Visibility pVisibility) {
   ResolveInfo** result = m_FreeInfoSet.allocate();
-  (*result) = ResolveInfo::Create(pName);
+  (*result) = m_Table.getEntryFactory().produce(pName);
   (*result)->setIsSymbol(true);
   (*result)->setSource(pIsDyn);
   (*result)->setType(pType);
@@ -63,15 +66,41 @@ void NamePool::insertSymbol(const llvm::StringRef& pName,
                             ResolveInfo::Visibility pVisibility,
                             ResolveInfo* pOldInfo,
                             Resolver::Result& pResult) {
+  insertSymbol(pName,
+               ResolveInfo::hasher()(pName),
+               pIsDyn,
+               pType,
+               pDesc,
+               pBinding,
+               pSize,
+               pValue,
+               pVisibility,
+               pOldInfo,
+               pResult);
+}
+
+void NamePool::insertSymbol(const llvm::StringRef& pName,
+                            uint32_t pHashValue,
+                            bool pIsDyn,
+                            ResolveInfo::Type pType,
+                            ResolveInfo::Desc pDesc,
+                            ResolveInfo::Binding pBinding,
+                            ResolveInfo::SizeType pSize,
+                            LDSymbol::ValueType pValue,
+                            ResolveInfo::Visibility pVisibility,
+                            ResolveInfo* pOldInfo,
+                            Resolver::Result& pResult) {
   // We should check if there is any symbol with the same name existed.
   // If it already exists, we should use resolver to decide which symbol
   // should be reserved. Otherwise, we insert the symbol and set up its
   // attributes.
+  ++NumInsertSymbol;
   bool exist = false;
-  ResolveInfo* old_symbol = m_Table.insert(pName, exist);
+  ResolveInfo* old_symbol = m_Table.insert(pName, pHashValue, exist);
   ResolveInfo* new_symbol = NULL;
   if (exist && old_symbol->isSymbol()) {
-    new_symbol = m_Table.getEntryFactory().produce(pName);
+    ++NumExistSymbol;
+    new_symbol = m_Table.getEntryFactory().produce(pName, pHashValue);
   } else {
     exist = false;
     new_symbol = old_symbol;
@@ -108,6 +137,15 @@ void NamePool::insertSymbol(const llvm::StringRef& pName,
     m_pResolver->resolveAgain(*this, action, *old_symbol, *new_symbol, pResult);
   }
 
+  // a non-weak reference to the definition of a shared object uses it
+  if (ResolveInfo::Undefined == pDesc && ResolveInfo::Weak != pBinding &&
+      pResult.info->isDyn() && !pResult.info->isUndef()) {
+    llvm::DenseMap<const ResolveInfo*, Input*>::iterator definer =
+        m_DynDefiners.find(pResult.info);
+    if (definer != m_DynDefiners.end())
+      definer->second->setNeeded();
+  }
+
   m_Table.getEntryFactory().destroy(new_symbol);
   return;
 }
@@ -119,7 +157,10 @@ llvm::StringRef NamePool::insertString(const llvm::StringRef& pString) {
 }
 
 void NamePool::reserve(NamePool::size_type pSize) {
-  m_Table.rehash(pSize);
+  // keep the load factor below 3/4 after pSize symbols are inserted
+  size_type buckets = pSize + (pSize / 3) + 1;
+  if (buckets > m_Table.numOfBuckets())
+    m_Table.rehash(buckets);
 }
 
 NamePool::size_type NamePool::capacity() const {
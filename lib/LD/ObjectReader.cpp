@@ -0,0 +1,48 @@
+//===- ObjectReader.cpp ---------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/ObjectReader.h"
+
+#include "mcld/LD/NamePool.h"
+#include "mcld/Support/ThreadPool.h"
+
+namespace mcld {
+
+//===----------------------------------------------------------------------===//
+// ObjectReader
+//===----------------------------------------------------------------------===//
+void ObjectReader::addStagedSymbols(ThreadPool& pPool,
+                                    NamePool& pNamePool,
+                                    std::vector<Input*>& pInputs) {
+  if (pInputs.empty())
+    return;
+
+  std::vector<SymbolStage> stages(pInputs.size());
+  std::vector<size_t> num_globals(pInputs.size(), 0);
+  parallelFor(pPool, 0, pInputs.size(), [&](size_t pIndex) {
+    parseSymbols(*pInputs[pIndex], stages[pIndex]);
+    SymbolStage::const_iterator sym, symEnd = stages[pIndex].end();
+    for (sym = stages[pIndex].begin(); sym != symEnd; ++sym) {
+      if (ResolveInfo::Local != sym->binding)
+        ++num_globals[pIndex];
+    }
+  });
+
+  // Only non-local symbols go into the pool. Make room for all of them at
+  // once instead of rehashing the pool again and again while adding.
+  size_t total = pNamePool.size();
+  for (size_t i = 0; i < num_globals.size(); ++i)
+    total += num_globals[i];
+  pNamePool.reserve(total);
+
+  for (size_t i = 0; i < pInputs.size(); ++i)
+    addSymbols(*pInputs[i], stages[i]);
+  pInputs.clear();
+}
+
+}  // namespace mcld
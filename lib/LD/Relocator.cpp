@@ -10,14 +10,16 @@
 
 #include "mcld/Module.h"
 #include "mcld/Fragment/Fragment.h"
+#include "mcld/LD/DiagnosticLineInfo.h"
 #include "mcld/LD/LDContext.h"
 #include "mcld/LD/LDSection.h"
 #include "mcld/LD/LDSymbol.h"
 #include "mcld/LD/ResolveInfo.h"
 #include "mcld/LD/SectionData.h"
-#include "mcld/Support/Demangle.h"
 #include "mcld/Support/MsgHandling.h"
 
+#include <llvm/Support/ELF.h>
+
 #include <sstream>
 
 namespace mcld {
@@ -28,6 +30,12 @@ namespace mcld {
 Relocator::~Relocator() {
 }
 
+bool Relocator::mayNeedScan(const Relocation& pReloc,
+                            const LDSection& pSection) const {
+  assert(pSection.getLink() != NULL);
+  return (pSection.getLink()->flag() & llvm::ELF::SHF_ALLOC) != 0;
+}
+
 void Relocator::partialScanRelocation(Relocation& pReloc,
                                       Module& pModule) {
   // if we meet a section symbol
@@ -50,16 +58,59 @@ void Relocator::partialScanRelocation(Relocation& pReloc,
   }
 }
 
+void Relocator::applyRelocations(const RelocList& pRelocs,
+                                 FailureList& pFailures) {
+  RelocList::const_iterator reloc, rEnd = pRelocs.end();
+  for (reloc = pRelocs.begin(); reloc != rEnd; ++reloc) {
+    Result result = applyRelocation(**reloc);
+    if (result != OK)
+      pFailures.push_back(std::make_pair(*reloc, result));
+  }
+}
+
+void Relocator::issueApplyResult(Result pResult, Relocation& pReloc) {
+  switch (pResult) {
+    case Relocator::OK: {
+      // do nothing
+      return;
+    }
+    case Relocator::Overflow: {
+      error(diag::result_overflow) << getName(pReloc.type())
+                                   << pReloc.symInfo()->name();
+      return;
+    }
+    case Relocator::BadReloc: {
+      error(diag::result_badreloc) << getName(pReloc.type())
+                                   << pReloc.symInfo()->name();
+      return;
+    }
+    case Relocator::Unsupported: {
+      fatal(diag::unsupported_relocation) << pReloc.type()
+                                          << "mclinker@googlegroups.com";
+      return;
+    }
+    case Relocator::Unknown: {
+      fatal(diag::unknown_relocation) << pReloc.type()
+                                      << pReloc.symInfo()->name();
+      return;
+    }
+  }  // end of switch
+}
+
 void Relocator::issueUndefRef(Relocation& pReloc,
                               LDSection& pSection,
                               Input& pInput) {
+  // finding the caller is wasted on an ignored reference
+  if (!getDiagnosticEngine().isVisible(diag::undefined_reference) &&
+      !getDiagnosticEngine().isVisible(diag::undefined_reference_text))
+    return;
+
   FragmentRef::Offset undef_sym_pos = pReloc.targetRef().offset();
   std::string sect_name(pSection.name());
   // Drop .rel(a) prefix
   sect_name = sect_name.substr(sect_name.find('.', /*pos=*/1));
 
-  std::string reloc_sym(pReloc.symInfo()->name());
-  reloc_sym = demangleName(reloc_sym);
+  const ResolveInfo& reloc_sym = *pReloc.symInfo();
 
   std::stringstream ss;
   ss << "0x" << std::hex << undef_sym_pos;
@@ -73,7 +124,7 @@ void Relocator::issueUndefRef(Relocation& pReloc,
   }
 
   std::string caller_file_name;
-  std::string caller_func_name;
+  const ResolveInfo* caller_func = ResolveInfo::Null();
   for (LDContext::sym_iterator i = pInput.context()->symTabBegin(),
                                e = pInput.context()->symTabEnd();
        i != e;
@@ -85,15 +136,25 @@ void Relocator::issueUndefRef(Relocation& pReloc,
     if (sym.resolveInfo()->type() == ResolveInfo::Function &&
         sym.value() <= undef_sym_pos &&
         sym.value() + sym.size() > undef_sym_pos) {
-      caller_func_name = sym.name();
+      caller_func = sym.resolveInfo();
       break;
     }
   }
 
-  caller_func_name = demangleName(caller_func_name);
+  // the line of the reference, if the input has the line table for it
+  DiagnosticLineInfo* line_info = getDiagnosticEngine().getLineInfo();
+  std::string source_file;
+  unsigned int line = 0;
+  if (line_info != NULL && pSection.getLink() != NULL &&
+      line_info->getLine(pInput, *pSection.getLink(), undef_sym_pos,
+                         source_file, line)) {
+    std::stringstream loc;
+    loc << source_file << ':' << line;
+    caller_file_name = loc.str();
+  }
 
   fatal(diag::undefined_reference_text) << reloc_sym << pInput.path()
-                                        << caller_file_name << caller_func_name;
+                                        << caller_file_name << *caller_func;
 }
 
 }  // namespace mcld
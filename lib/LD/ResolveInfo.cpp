@@ -25,7 +25,7 @@ static ResolveInfo* g_NullResolveInfo = NULL;
 //===----------------------------------------------------------------------===//
 // ResolveInfo
 //===----------------------------------------------------------------------===//
-ResolveInfo::ResolveInfo() : m_Size(0), m_BitField(0) {
+ResolveInfo::ResolveInfo() : m_Size(0), m_BitField(0), m_HashValue(0) {
   m_Ptr.sym_ptr = 0;
 }
 
@@ -234,16 +234,27 @@ bool ResolveInfo::shouldForceLocal(const LinkerConfig& pConfig) {
 // ResolveInfo Factory Methods
 //===----------------------------------------------------------------------===//
 ResolveInfo* ResolveInfo::Create(const ResolveInfo::key_type& pKey) {
-  ResolveInfo* info =
-      static_cast<ResolveInfo*>(malloc(sizeof(ResolveInfo) + pKey.size() + 1));
-  if (info == NULL)
+  return Create(pKey, hasher()(pKey));
+}
+
+ResolveInfo* ResolveInfo::Create(const ResolveInfo::key_type& pKey,
+                                 uint32_t pHashValue) {
+  void* place = malloc(SizeOf(pKey));
+  if (place == NULL)
     return NULL;
+  return Create(place, pKey, pHashValue);
+}
 
-  new (info) ResolveInfo();  // call constructor at the `result` address.
+ResolveInfo* ResolveInfo::Create(void* pPlace,
+                                 const ResolveInfo::key_type& pKey,
+                                 uint32_t pHashValue) {
+  // call constructor at the `pPlace' address.
+  ResolveInfo* info = new (pPlace) ResolveInfo();
   std::memcpy(info->m_Name, pKey.data(), pKey.size());
   info->m_Name[pKey.size()] = '\0';
   info->m_BitField &= ~ResolveInfo::RESOLVE_MASK;
   info->m_BitField |= (pKey.size() << ResolveInfo::NAME_LENGTH_OFFSET);
+  info->m_HashValue = pHashValue;
   return info;
 }
 
@@ -266,6 +277,7 @@ ResolveInfo* ResolveInfo::Null() {
     new (g_NullResolveInfo) ResolveInfo();
     g_NullResolveInfo->m_Name[0] = '\0';
     g_NullResolveInfo->m_BitField = 0x0;
+    g_NullResolveInfo->m_HashValue = hasher()(llvm::StringRef());
     g_NullResolveInfo->setBinding(Local);
   }
   return g_NullResolveInfo;
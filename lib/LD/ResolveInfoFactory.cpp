@@ -0,0 +1,86 @@
+//===- ResolveInfoFactory.cpp ---------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/ResolveInfoFactory.h"
+
+#include <cstdlib>
+
+namespace mcld {
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// kChunkSize - the size of the chunks which entries are carved out of
+const size_t kChunkSize = 64 * 1024;
+
+/// kAlignment - every entry starts at a multiple of the alignment of
+/// ResolveInfo
+const size_t kAlignment = alignof(ResolveInfo);
+
+size_t getEntrySize(const ResolveInfo::key_type& pKey) {
+  size_t size = ResolveInfo::SizeOf(pKey);
+  return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// ResolveInfoFactory
+//===----------------------------------------------------------------------===//
+ResolveInfoFactory::ResolveInfoFactory() : m_pCurrent(NULL), m_pEnd(NULL) {
+}
+
+ResolveInfoFactory::~ResolveInfoFactory() {
+  // the destructor of ResolveInfo does nothing, so the chunks are simply
+  // freed.
+  std::vector<char*>::iterator chunk, cEnd = m_Chunks.end();
+  for (chunk = m_Chunks.begin(); chunk != cEnd; ++chunk)
+    free(*chunk);
+}
+
+void* ResolveInfoFactory::allocate(size_t pSize) {
+  if (static_cast<size_t>(m_pEnd - m_pCurrent) < pSize) {
+    // a very long name gets a chunk of its own. The current chunk is kept for
+    // the following entries.
+    if (pSize > kChunkSize / 4) {
+      char* chunk = static_cast<char*>(malloc(pSize));
+      m_Chunks.push_back(chunk);
+      return chunk;
+    }
+    m_pCurrent = static_cast<char*>(malloc(kChunkSize));
+    m_pEnd = m_pCurrent + kChunkSize;
+    m_Chunks.push_back(m_pCurrent);
+  }
+  void* result = m_pCurrent;
+  m_pCurrent += pSize;
+  return result;
+}
+
+ResolveInfo* ResolveInfoFactory::produce(const key_type& pKey) {
+  return produce(pKey, ResolveInfo::hasher()(pKey));
+}
+
+ResolveInfo* ResolveInfoFactory::produce(const key_type& pKey,
+                                         uint32_t pHashValue) {
+  return ResolveInfo::Create(allocate(getEntrySize(pKey)), pKey, pHashValue);
+}
+
+void ResolveInfoFactory::destroy(ResolveInfo*& pEntry) {
+  // give back the storage only if pEntry is the last entry in the current
+  // chunk
+  char* entry = reinterpret_cast<char*>(pEntry);
+  size_t size = getEntrySize(llvm::StringRef(pEntry->name(),
+                                             pEntry->nameSize()));
+  if (entry + size == m_pCurrent && entry >= m_pEnd - kChunkSize)
+    m_pCurrent = entry;
+  pEntry = NULL;
+}
+
+}  // namespace mcld
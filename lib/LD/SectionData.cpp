@@ -8,17 +8,55 @@
 //===----------------------------------------------------------------------===//
 #include "mcld/LD/SectionData.h"
 
+#include "mcld/Fragment/AlignFragment.h"
 #include "mcld/LD/LDSection.h"
 #include "mcld/Support/GCFactory.h"
+#include "mcld/Support/ThreadPool.h"
 
+#include <llvm/Support/Casting.h>
 #include <llvm/Support/ManagedStatic.h>
 
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
 namespace mcld {
 
 typedef GCFactory<SectionData, MCLD_SECTIONS_PER_INPUT> SectDataFactory;
 
 static llvm::ManagedStatic<SectDataFactory> g_SectDataFactory;
 
+/// the number of fragments a chunk of layout() has at least
+static const size_t kLayoutChunkSize = 4096;
+
+/// getLayoutAlign - the size of pFrag and its offset depend on the offset
+/// modulo the returned alignment.
+static uint32_t getLayoutAlign(const Fragment& pFrag) {
+  uint32_t align = pFrag.getAlign();
+  const AlignFragment* align_frag = llvm::dyn_cast<AlignFragment>(&pFrag);
+  if ((align_frag != NULL) && (align_frag->getAlignment() > align))
+    align = align_frag->getAlignment();
+  return align;
+}
+
+/// layoutFragments - lay out pFrags[pBegin, pEnd) from offset 0
+/// @return the end of the last fragment
+static uint64_t layoutFragments(const FragmentIndex& pFrags,
+                                size_t pBegin,
+                                size_t pEnd) {
+  uint64_t offset = 0;
+  for (size_t i = pBegin; i != pEnd; ++i) {
+    pFrags[i].setOffset(pFrags[i].alignOffset(offset));
+    offset = pFrags[i].getOffset() + pFrags[i].size();
+  }
+  return offset;
+}
+
+/// isBeforeFragment - the offset pOffset is before the fragment pFrag
+static bool isBeforeFragment(uint64_t pOffset, const Fragment* pFrag) {
+  return pOffset < pFrag->getOffset();
+}
+
 //===----------------------------------------------------------------------===//
 // SectionData
 //===----------------------------------------------------------------------===//
@@ -44,4 +82,99 @@ void SectionData::Clear() {
   g_SectDataFactory->clear();
 }
 
+void SectionData::updateOffsets(Fragment& pFrom) {
+  assert(pFrom.getParent() == this);
+  for (Fragment* frag = &pFrom; frag != NULL; frag = frag->getNextNode()) {
+    Fragment* prev = frag->getPrevNode();
+    uint64_t offset = 0;
+    if (prev != NULL)
+      offset = frag->alignOffset(prev->getOffset() + prev->size());
+    if (frag->hasOffset() && frag->getOffset() == offset)
+      break;
+    frag->setOffset(offset);
+  }
+}
+
+void SectionData::layout(ThreadPool& pPool) {
+  FragmentIndex frags(*this);
+  uint32_t max_align = 1;
+  for (size_t i = 0; i < frags.size(); ++i) {
+    uint32_t align = getLayoutAlign(frags[i]);
+    if (align > max_align)
+      max_align = align;
+  }
+
+  // A chunk starting at an offset aligned to max_align is laid out as if it
+  // started at 0, so that its size does not depend on the chunks before it.
+  std::vector<size_t> starts;
+  if (pPool.isParallel()) {
+    frags.split(kLayoutChunkSize, max_align, starts);
+  } else {
+    starts.push_back(0);
+    starts.push_back(frags.size());
+  }
+
+  size_t num_chunks = starts.size() - 1;
+  std::vector<uint64_t> bases(num_chunks);
+  parallelFor(pPool, 0, num_chunks, [&](size_t pIndex) {
+    bases[pIndex] = layoutFragments(frags, starts[pIndex], starts[pIndex + 1]);
+  });
+
+  uint64_t offset = 0;
+  for (size_t i = 0; i < num_chunks; ++i) {
+    uint64_t size = bases[i];
+    bases[i] = (i == 0) ? 0 : frags[starts[i]].alignOffset(offset);
+    offset = bases[i] + size;
+  }
+
+  parallelFor(pPool, 1, num_chunks, [&](size_t pIndex) {
+    for (size_t i = starts[pIndex]; i != starts[pIndex + 1]; ++i)
+      frags[i].setOffset(frags[i].getOffset() + bases[pIndex]);
+  });
+  getSection().setSize(offset);
+}
+
+//===----------------------------------------------------------------------===//
+// FragmentIndex
+//===----------------------------------------------------------------------===//
+FragmentIndex::FragmentIndex() {
+}
+
+FragmentIndex::FragmentIndex(SectionData& pData) {
+  build(pData);
+}
+
+void FragmentIndex::build(SectionData& pData) {
+  m_Fragments.clear();
+  m_Fragments.reserve(pData.size());
+  SectionData::iterator frag, fragEnd = pData.end();
+  for (frag = pData.begin(); frag != fragEnd; ++frag)
+    m_Fragments.push_back(&*frag);
+}
+
+size_t FragmentIndex::find(uint64_t pOffset) const {
+  // the last fragment starting at or before pOffset. Among the fragments at
+  // the same offset, the empty ones come first.
+  std::vector<Fragment*>::const_iterator it = std::upper_bound(
+      m_Fragments.begin(), m_Fragments.end(), pOffset, isBeforeFragment);
+  if (it == m_Fragments.begin())
+    return size();
+  --it;
+  if (pOffset >= (*it)->getOffset() + (*it)->size())
+    return size();
+  return it - m_Fragments.begin();
+}
+
+void FragmentIndex::split(size_t pMinSize,
+                          uint32_t pAlign,
+                          std::vector<size_t>& pStarts) const {
+  pStarts.push_back(0);
+  for (size_t i = pMinSize; i < m_Fragments.size(); ++i) {
+    if ((i - pStarts.back() >= pMinSize) &&
+        (m_Fragments[i]->getAlign() >= pAlign))
+      pStarts.push_back(i);
+  }
+  pStarts.push_back(m_Fragments.size());
+}
+
 }  // namespace mcld
@@ -0,0 +1,329 @@
+//===- SectionMerger.cpp --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/SectionMerger.h"
+
+#include "mcld/Fragment/FragmentRef.h"
+#include "mcld/Fragment/RegionFragment.h"
+#include "mcld/Fragment/Relocation.h"
+#include "mcld/LD/LDContext.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/LD/LDSymbol.h"
+#include "mcld/LD/MemoryReport.h"
+#include "mcld/LD/RelocData.h"
+#include "mcld/LD/ResolveInfo.h"
+#include "mcld/LD/SectionData.h"
+#include "mcld/MC/Input.h"
+#include "mcld/Module.h"
+#include "mcld/Support/ThreadPool.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/xxhash.h>
+
+#include <cassert>
+#include <string>
+
+namespace mcld {
+
+/// getDefinedFragment - the fragment that pSymbol is defined in, or NULL
+static const Fragment* getDefinedFragment(const LDSymbol* pSymbol) {
+  if ((pSymbol == NULL) || !pSymbol->hasFragRef())
+    return NULL;
+  return pSymbol->fragRef()->frag();
+}
+
+/// isMergedKind - whether the sections of pKind are merged. The .comment
+/// sections hold one version string of each compiler, and most inputs have
+/// the same one.
+static bool isMergedKind(LDFileFormat::Kind pKind) {
+  return (LDFileFormat::DATA == pKind) || (LDFileFormat::MetaData == pKind);
+}
+
+//===----------------------------------------------------------------------===//
+// SectionMerger::Group
+//===----------------------------------------------------------------------===//
+SectionMerger::Group::Group(SectionData& pData, const LDSection& pSection)
+    : data(&pData),
+      flag(pSection.flag() & (llvm::ELF::SHF_MERGE | llvm::ELF::SHF_STRINGS)),
+      ent_size(pSection.entSize()),
+      align(pSection.align()),
+      table(pSection.entSize(),
+            (pSection.flag() & llvm::ELF::SHF_STRINGS) != 0),
+      fragment(NULL) {
+}
+
+bool SectionMerger::Group::accepts(const SectionData& pData,
+                                   const LDSection& pSection) const {
+  uint32_t mask = llvm::ELF::SHF_MERGE | llvm::ELF::SHF_STRINGS;
+  return (data == &pData) && (flag == (pSection.flag() & mask)) &&
+         (ent_size == pSection.entSize()) && (align == pSection.align());
+}
+
+//===----------------------------------------------------------------------===//
+// SectionMerger
+//===----------------------------------------------------------------------===//
+SectionMerger::SectionMerger() {
+}
+
+SectionMerger::~SectionMerger() {
+  std::vector<Group*>::iterator group, groupEnd = m_Groups.end();
+  for (group = m_Groups.begin(); group != groupEnd; ++group)
+    delete *group;
+}
+
+bool SectionMerger::isMergeable(const LDSection& pSection) {
+  if (!isMergedKind(pSection.kind()) ||
+      (pSection.type() != llvm::ELF::SHT_PROGBITS) ||
+      ((pSection.flag() & llvm::ELF::SHF_MERGE) == 0) ||
+      ((pSection.flag() & llvm::ELF::SHF_WRITE) != 0) ||
+      (pSection.entSize() == 0) || (pSection.size() == 0) ||
+      ((pSection.size() % pSection.entSize()) != 0))
+    return false;
+
+  // the contents should be one region read from the input file
+  if (!pSection.hasSectionData() || (pSection.getSectionData()->size() != 1))
+    return false;
+  const Fragment& frag = pSection.getSectionData()->front();
+  return llvm::isa<RegionFragment>(frag) && (frag.size() == pSection.size());
+}
+
+void SectionMerger::collect(Module& pModule) {
+  // find the candidates
+  typedef llvm::DenseMap<const Fragment*, LDSection*> CandidateMap;
+  CandidateMap candidates;
+  std::vector<LDSection*> candidate_list;
+  Module::obj_iterator obj, objEnd = pModule.obj_end();
+  for (obj = pModule.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
+    for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      if (isMergeable(**sect)) {
+        candidates[&(*sect)->getSectionData()->front()] = *sect;
+        candidate_list.push_back(*sect);
+      }
+    }
+  }
+  if (candidate_list.empty())
+    return;
+
+  // A reference is redirected by the offset it points at. Leave the sections
+  // alone if the offset is hidden in the place of a REL relocation, or if it
+  // is not inside the section. Sections with relocations of their own are not
+  // merged either.
+  llvm::DenseSet<const LDSection*> excluded;
+  for (obj = pModule.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sym_iterator sym, symEnd = (*obj)->context()->symTabEnd();
+    for (sym = (*obj)->context()->symTabBegin(); sym != symEnd; ++sym) {
+      if (*sym == NULL)
+        continue;
+      CandidateMap::iterator it = candidates.find(getDefinedFragment(*sym));
+      if ((it != candidates.end()) &&
+          ((*sym)->fragRef()->offset() >= it->second->size()))
+        excluded.insert(it->second);
+    }
+
+    LDContext::sect_iterator rs, rsEnd = (*obj)->context()->relocSectEnd();
+    for (rs = (*obj)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if ((LDFileFormat::Relocation != (*rs)->kind()) ||
+          !(*rs)->hasRelocData())
+        continue;
+      if ((*rs)->getLink() != NULL)
+        excluded.insert((*rs)->getLink());
+
+      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+        ResolveInfo* info = reloc->symInfo();
+        if ((info == NULL) || (info->type() != ResolveInfo::Section))
+          continue;
+        CandidateMap::iterator it =
+            candidates.find(getDefinedFragment(info->outSymbol()));
+        if (it == candidates.end())
+          continue;
+        uint64_t offset =
+            info->outSymbol()->fragRef()->offset() + reloc->addend();
+        if (((*rs)->type() != llvm::ELF::SHT_RELA) ||
+            (offset >= it->second->size()))
+          excluded.insert(it->second);
+      }
+    }
+  }
+
+  std::vector<LDSection*>::iterator sect, sectEnd = candidate_list.end();
+  for (sect = candidate_list.begin(); sect != sectEnd; ++sect) {
+    if (excluded.count(*sect) != 0)
+      continue;
+    Member member;
+    member.section = *sect;
+    member.fragment =
+        llvm::cast<RegionFragment>(&(*sect)->getSectionData()->front());
+    member.group = NULL;
+    m_Members.push_back(member);
+  }
+}
+
+uint64_t SectionMerger::getOutputOffset(const Member& pMember,
+                                        uint64_t pOffset) const {
+  return pMember.group->table.getOutputOffset(pMember.fragment->getRegion(),
+                                              pOffset);
+}
+
+void SectionMerger::merge(Module& pModule, ThreadPool& pPool) {
+  // 1. Group the members by the section data they have been moved into. A
+  // member that was discarded is still in its own section data.
+  std::vector<Member>::iterator member, memberEnd = m_Members.end();
+  for (member = m_Members.begin(); member != memberEnd; ++member) {
+    SectionData* data = member->fragment->getParent();
+    if (!isMergedKind(member->section->kind()) ||
+        (data == member->section->getSectionData()))
+      continue;
+
+    Group* group = NULL;
+    std::vector<Group*>::iterator it, itEnd = m_Groups.end();
+    for (it = m_Groups.begin(); it != itEnd; ++it) {
+      if ((*it)->accepts(*data, *member->section)) {
+        group = *it;
+        break;
+      }
+    }
+    if (group == NULL) {
+      group = new Group(*data, *member->section);
+      m_Groups.push_back(group);
+    }
+
+    member->group = group;
+    group->members.push_back(&*member);
+    group->table.addStrings(member->fragment->getRegion());
+    m_MemberMap[member->fragment] = &*member;
+  }
+  if (m_Groups.empty())
+    return;
+
+  // 2. Merge the contents of each group.
+  std::vector<Group*>::iterator group, groupEnd = m_Groups.end();
+  for (group = m_Groups.begin(); group != groupEnd; ++group) {
+    uint64_t size = (*group)->table.finalizeOffset(pPool);
+    (*group)->contents.assign(size, 0);
+    MemoryRegion region((*group)->contents.data(), size);
+    (*group)->table.emit(region);
+    (*group)->fragment = new RegionFragment(llvm::StringRef(
+        reinterpret_cast<const char*>((*group)->contents.data()), size));
+  }
+
+  // 3. Redirect the references. Relocations refer to the symbols, so they go
+  // first. Each relocation is changed by itself.
+  Module::ObjectList& inputs = pModule.getObjectList();
+  parallelFor(pPool, 0, inputs.size(), [this, &inputs](size_t pIndex) {
+    LDContext* context = inputs[pIndex]->context();
+    LDContext::sect_iterator rs, rsEnd = context->relocSectEnd();
+    for (rs = context->relocSectBegin(); rs != rsEnd; ++rs) {
+      if ((LDFileFormat::Relocation != (*rs)->kind()) ||
+          !(*rs)->hasRelocData())
+        continue;
+      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc)
+        redirectRelocation(*llvm::cast<Relocation>(reloc));
+    }
+  });
+  redirectSymbols(pModule);
+
+  // 4. Put the merged fragments in place of the members, and lay out each
+  // section once.
+  std::vector<SectionData*> datas;
+  llvm::DenseSet<SectionData*> seen;
+  for (group = m_Groups.begin(); group != groupEnd; ++group) {
+    replaceFragments(**group);
+    if (seen.insert((*group)->data).second)
+      datas.push_back((*group)->data);
+  }
+  for (size_t i = 0; i < datas.size(); ++i)
+    datas[i]->layout(pPool);
+}
+
+uint64_t SectionMerger::hashContents() const {
+  std::string hashes;
+  std::vector<Group*>::const_iterator group, groupEnd = m_Groups.end();
+  for (group = m_Groups.begin(); group != groupEnd; ++group) {
+    uint64_t hash = llvm::xxHash64(llvm::StringRef(
+        reinterpret_cast<const char*>((*group)->contents.data()),
+        (*group)->contents.size()));
+    hashes.append(reinterpret_cast<const char*>(&hash), sizeof(hash));
+  }
+  return llvm::xxHash64(hashes);
+}
+
+void SectionMerger::addMemoryUsage(MemoryReport& pReport) const {
+  uint64_t strings = 0;
+  uint64_t bytes = m_Members.capacity() * sizeof(Member) +
+                   m_MemberMap.getMemorySize() +
+                   m_Groups.capacity() * sizeof(Group*);
+  std::vector<Group*>::const_iterator group, groupEnd = m_Groups.end();
+  for (group = m_Groups.begin(); group != groupEnd; ++group) {
+    strings += (*group)->table.numOfStrings();
+    bytes += sizeof(Group) + (*group)->table.memoryUsage() +
+             (*group)->members.capacity() * sizeof(Member*) +
+             (*group)->contents.capacity();
+  }
+  pReport.add("MergedStringTable", strings, bytes);
+}
+
+void SectionMerger::redirectRelocation(Relocation& pReloc) const {
+  // A relocation against a section symbol carries the offset in its addend.
+  // The symbol is moved to the beginning of the merged fragment later.
+  ResolveInfo* info = pReloc.symInfo();
+  if ((info == NULL) || (info->type() != ResolveInfo::Section))
+    return;
+  MemberMap::const_iterator it =
+      m_MemberMap.find(getDefinedFragment(info->outSymbol()));
+  if (it == m_MemberMap.end())
+    return;
+
+  uint64_t offset = info->outSymbol()->fragRef()->offset() + pReloc.addend();
+  pReloc.setAddend(getOutputOffset(*it->second, offset));
+}
+
+void SectionMerger::redirectSymbols(Module& pModule) {
+  Module::obj_iterator obj, objEnd = pModule.obj_end();
+  for (obj = pModule.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sym_iterator sym, symEnd = (*obj)->context()->symTabEnd();
+    for (sym = (*obj)->context()->symTabBegin(); sym != symEnd; ++sym) {
+      if (*sym == NULL)
+        continue;
+      LDSymbol* out_sym = (*sym)->resolveInfo()->outSymbol();
+      MemberMap::iterator it = m_MemberMap.find(getDefinedFragment(out_sym));
+      if (it == m_MemberMap.end())
+        continue;
+
+      // Once redirected, the symbol is not found in the map again.
+      FragmentRef* frag_ref = out_sym->fragRef();
+      Member& member = *it->second;
+      if (ResolveInfo::Section == out_sym->type())
+        frag_ref->assign(*member.group->fragment, 0);
+      else
+        frag_ref->assign(*member.group->fragment,
+                         getOutputOffset(member, frag_ref->offset()));
+    }  // for each symbol
+  }    // for each object
+}
+
+void SectionMerger::replaceFragments(Group& pGroup) {
+  assert(!pGroup.members.empty());
+  SectionData::FragmentListType& list = pGroup.data->getFragmentList();
+  pGroup.fragment->setParent(pGroup.data);
+  pGroup.fragment->setAlign(pGroup.align);
+  list.insert(SectionData::iterator(pGroup.members.front()->fragment),
+              pGroup.fragment);
+
+  // The members stay alive, so that a stale reference still reaches a valid
+  // fragment.
+  std::vector<Member*>::iterator member, memberEnd = pGroup.members.end();
+  for (member = pGroup.members.begin(); member != memberEnd; ++member)
+    list.remove(SectionData::iterator((*member)->fragment));
+}
+
+}  // namespace mcld
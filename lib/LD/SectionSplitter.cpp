@@ -0,0 +1,350 @@
+//===- SectionSplitter.cpp ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/SectionSplitter.h"
+
+#include "mcld/IRBuilder.h"
+#include "mcld/Module.h"
+#include "mcld/Fragment/FragmentRef.h"
+#include "mcld/Fragment/RegionFragment.h"
+#include "mcld/Fragment/Relocation.h"
+#include "mcld/LD/LDContext.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/LD/LDSymbol.h"
+#include "mcld/LD/ObjectReader.h"
+#include "mcld/LD/RelocData.h"
+#include "mcld/LD/ResolveInfo.h"
+#include "mcld/LD/SectionData.h"
+#include "mcld/MC/Input.h"
+#include "mcld/Object/ObjectBuilder.h"
+#include "mcld/Support/Statistic.h"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/ELF.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace mcld {
+
+static Statistic NumSplitSections("splitter.split-sections",
+                                  "The # of .text sections split at functions");
+static Statistic NumPieces("splitter.pieces",
+                           "The # of sections added by splitting .text");
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// getRegion - the fragment holding the contents of pSection, or NULL if
+/// pSection is not a .text section read as a whole
+const RegionFragment* getRegion(const LDSection& pSection) {
+  if (LDFileFormat::TEXT != pSection.kind() ||
+      llvm::ELF::SHT_PROGBITS != pSection.type() ||
+      (pSection.flag() & llvm::ELF::SHF_GROUP) != 0 ||
+      pSection.name() != ".text" || !pSection.hasSectionData())
+    return NULL;
+
+  // the reader appends the region and a null fragment after it
+  const SectionData* data = pSection.getSectionData();
+  if (data->size() != 2 || Fragment::Null != data->back().getKind())
+    return NULL;
+  const RegionFragment* region =
+      llvm::dyn_cast<RegionFragment>(&data->front());
+  if (region == NULL || region->size() != pSection.size())
+    return NULL;
+  return region;
+}
+
+/// findPiece - the index of the piece holding the offset pOffset
+size_t findPiece(const std::vector<uint64_t>& pBoundaries, uint64_t pOffset) {
+  return std::upper_bound(pBoundaries.begin(), pBoundaries.end(), pOffset) -
+         pBoundaries.begin() - 1;
+}
+
+/// isSectionSymbolOf - pInfo is the section symbol of the section whose
+/// contents are pRegion
+bool isSectionSymbolOf(const ResolveInfo* pInfo, const Fragment& pRegion) {
+  return pInfo != NULL && ResolveInfo::Section == pInfo->type() &&
+         pInfo->outSymbol() != NULL && pInfo->outSymbol()->hasFragRef() &&
+         pInfo->outSymbol()->fragRef()->frag() == &pRegion;
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// SectionSplitter
+//===----------------------------------------------------------------------===//
+SectionSplitter::SectionSplitter(Module& pModule,
+                                 IRBuilder& pBuilder,
+                                 ObjectReader& pReader)
+    : m_Module(pModule), m_Builder(pBuilder), m_Reader(pReader) {
+}
+
+SectionSplitter::~SectionSplitter() {
+}
+
+size_t SectionSplitter::run() {
+  size_t pieces = 0;
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext* context = (*obj)->context();
+    if (context == NULL)
+      continue;
+
+    // the pieces appended by a split are not split again
+    size_t num = context->numOfSections();
+    for (size_t i = 0; i < num; ++i) {
+      LDSection* sect = context->getSection(i);
+      Boundaries boundaries;
+      if (sect == NULL || !getBoundaries(**obj, *sect, boundaries) ||
+          !checkReferences(**obj, *sect, boundaries))
+        continue;
+
+      split(**obj, *sect, boundaries);
+      ++NumSplitSections;
+      NumPieces += boundaries.size() - 1;
+      pieces += boundaries.size() - 1;
+    }
+  }
+  return pieces;
+}
+
+bool SectionSplitter::getBoundaries(Input& pInput,
+                                    const LDSection& pSection,
+                                    Boundaries& pBoundaries) const {
+  const RegionFragment* region = getRegion(pSection);
+  if (region == NULL)
+    return false;
+
+  // the extents of the symbols are checked once all boundaries are known
+  std::vector<std::pair<uint64_t, uint64_t> > extents;
+  pBoundaries.assign(1, 0x0);
+  LDContext::sym_iterator sym, symEnd = pInput.context()->symTabEnd();
+  for (sym = pInput.context()->symTabBegin(); sym != symEnd; ++sym) {
+    if (*sym == NULL || !(*sym)->hasFragRef() ||
+        (*sym)->fragRef()->frag() != region ||
+        ResolveInfo::Section == (*sym)->type())
+      continue;
+
+    if (ResolveInfo::Local == (*sym)->binding()) {
+      // the mapping symbols of ARM and AArch64 only mark code and data
+      if (llvm::StringRef((*sym)->name()).startswith("$"))
+        continue;
+      return false;
+    }
+
+    uint64_t begin = (*sym)->fragRef()->offset();
+    uint64_t end = begin + (*sym)->size();
+    if (end > pSection.size())
+      return false;
+    if (ResolveInfo::Function == (*sym)->type()) {
+      if (begin == end)
+        return false;
+      pBoundaries.push_back(begin);
+    }
+    extents.push_back(std::make_pair(begin, end));
+  }
+
+  std::sort(pBoundaries.begin(), pBoundaries.end());
+  pBoundaries.erase(std::unique(pBoundaries.begin(), pBoundaries.end()),
+                    pBoundaries.end());
+  if (pBoundaries.size() < 2)
+    return false;
+
+  // every symbol ends in the piece it begins in
+  for (size_t i = 0; i < extents.size(); ++i) {
+    size_t piece = findPiece(pBoundaries, extents[i].first);
+    uint64_t limit = (piece + 1 < pBoundaries.size()) ? pBoundaries[piece + 1]
+                                                      : pSection.size();
+    if (extents[i].second > limit)
+      return false;
+  }
+  return true;
+}
+
+bool SectionSplitter::checkReferences(Input& pInput,
+                                      const LDSection& pSection,
+                                      const Boundaries& pBoundaries) {
+  const RegionFragment* region = getRegion(pSection);
+  LDContext* context = pInput.context();
+
+  // nothing but the relocations may be linked to the section
+  LDContext::sect_iterator sect, sectEnd = context->sectEnd();
+  for (sect = context->sectBegin(); sect != sectEnd; ++sect) {
+    if (*sect != NULL && LDFileFormat::Relocation != (*sect)->kind() &&
+        (*sect)->getLink() == &pSection)
+      return false;
+  }
+
+  LDContext::sect_iterator rs, rsEnd = context->relocSectEnd();
+  for (rs = context->relocSectBegin(); rs != rsEnd; ++rs) {
+    if (LDFileFormat::Ignore == (*rs)->kind())
+      continue;
+    if (!(*rs)->hasRelocData() && !m_Reader.readRelocation(pInput, **rs))
+      return false;
+
+    const LDSection* source = (*rs)->getLink();
+    RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+    for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+      Relocation* relocation = llvm::cast<Relocation>(reloc);
+      if (!isSectionSymbolOf(relocation->symInfo(), *region))
+        continue;
+
+      // an addend in the place cannot be moved to a piece
+      if (llvm::ELF::SHT_RELA != (*rs)->type() ||
+          relocation->addend() > pSection.size())
+        return false;
+
+      if (source == &pSection) {
+        // a reference within a function stays in its piece
+        if (findPiece(pBoundaries, relocation->targetRef().offset()) !=
+            findPiece(pBoundaries, relocation->addend()))
+          return false;
+      } else if ((source->flag() & llvm::ELF::SHF_ALLOC) != 0 &&
+                 LDFileFormat::EhFrame != source->kind()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void SectionSplitter::split(Input& pInput,
+                            LDSection& pSection,
+                            const Boundaries& pBoundaries) {
+  LDContext* context = pInput.context();
+  SectionData* data = pSection.getSectionData();
+  RegionFragment* region = llvm::cast<RegionFragment>(&data->front());
+  llvm::StringRef contents = region->getRegion();
+  size_t num = pBoundaries.size();
+
+  // the first piece keeps the section, and the others are appended to the
+  // object, aligned as their offsets in the section are
+  std::vector<LDSection*> sections(num, &pSection);
+  std::vector<Fragment*> pieces(num, region);
+  for (size_t i = 1; i < num; ++i) {
+    uint64_t begin = pBoundaries[i];
+    uint64_t end = (i + 1 < num) ? pBoundaries[i + 1] : pSection.size();
+    LDSection* piece = LDSection::Create(pSection.name(), pSection.kind(),
+                                         pSection.type(), pSection.flag());
+    piece->setAlign(
+        std::min<uint64_t>(pSection.align(), begin & (~begin + 1)));
+    piece->setOffset(pSection.offset() + begin);
+    piece->setSize(end - begin);
+    pieces[i] = new RegionFragment(contents.substr(begin, end - begin));
+    ObjectBuilder::AppendFragment(*pieces[i],
+                                  *IRBuilder::CreateSectionData(*piece));
+    context->appendSection(*piece);
+    sections[i] = piece;
+  }
+  region->setRegion(contents.substr(0, pBoundaries[1]));
+  data->back().setOffset(pBoundaries[1]);
+  pSection.setSize(pBoundaries[1]);
+
+  // an input symbol and its output symbol may share their reference
+  llvm::DenseSet<const LDSymbol*> visited;
+  llvm::DenseMap<const FragmentRef*, uint64_t> moved;
+  LDContext::sym_iterator sym, symEnd = context->symTabEnd();
+  for (sym = context->symTabBegin(); sym != symEnd; ++sym) {
+    if (*sym == NULL)
+      continue;
+    LDSymbol* symbols[2] = { *sym, (*sym)->resolveInfo()->outSymbol() };
+    for (size_t j = 0; j < 2; ++j) {
+      LDSymbol* symbol = symbols[j];
+      if (symbol == NULL || !symbol->hasFragRef() ||
+          !visited.insert(symbol).second)
+        continue;
+
+      FragmentRef* ref = symbol->fragRef();
+      if (ref->frag() == region) {
+        size_t i = findPiece(pBoundaries, ref->offset());
+        if (i == 0)
+          continue;
+        ref->assign(*pieces[i], ref->offset() - pBoundaries[i]);
+        moved[ref] = pBoundaries[i];
+      }
+      llvm::DenseMap<const FragmentRef*, uint64_t>::iterator shift =
+          moved.find(ref);
+      if (shift != moved.end())
+        symbol->setValue(symbol->value() - shift->second);
+    }
+  }
+
+  // the relocations applied to a piece move to a relocation section of its
+  // own, in their order
+  std::vector<LDSection*> targets;
+  LDContext::sect_iterator rs, rsEnd = context->relocSectEnd();
+  for (rs = context->relocSectBegin(); rs != rsEnd; ++rs) {
+    if (LDFileFormat::Ignore != (*rs)->kind() && (*rs)->hasRelocData() &&
+        (*rs)->getLink() == &pSection)
+      targets.push_back(*rs);
+  }
+  for (size_t t = 0; t < targets.size(); ++t) {
+    LDSection* target = targets[t];
+    RelocData::RelocationListType& list =
+        target->getRelocData()->getRelocationList();
+    uint64_t entry_size = list.empty() ? 0 : target->size() / list.size();
+    std::vector<LDSection*> relocs(num, NULL);
+    relocs[0] = target;
+    RelocData::iterator reloc = list.begin(), rEnd = list.end();
+    while (reloc != rEnd) {
+      Relocation* relocation = llvm::cast<Relocation>(reloc++);
+      uint64_t offset = relocation->targetRef().offset();
+      size_t i = findPiece(pBoundaries, offset);
+      if (i == 0)
+        continue;
+
+      if (relocs[i] == NULL) {
+        relocs[i] = LDSection::Create(target->name(), target->kind(),
+                                      target->type(), target->flag());
+        relocs[i]->setAlign(target->align());
+        relocs[i]->setLink(sections[i]);
+        IRBuilder::CreateRelocData(*relocs[i]);
+        context->appendSection(*relocs[i]);
+      }
+      relocation->targetRef().assign(*pieces[i], offset - pBoundaries[i]);
+      target->getRelocData()->remove(*relocation);
+      relocs[i]->getRelocData()->append(*relocation);
+    }
+    for (size_t i = 0; i < num; ++i) {
+      if (relocs[i] != NULL)
+        relocs[i]->setSize(entry_size * relocs[i]->getRelocData()->size());
+    }
+  }
+
+  // the references by the section symbol move to the local symbols of the
+  // pieces. The debugging sections only refer to a piece by their addends.
+  std::vector<ResolveInfo*> symbols(num, NULL);
+  rsEnd = context->relocSectEnd();
+  for (rs = context->relocSectBegin(); rs != rsEnd; ++rs) {
+    if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+      continue;
+    RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+    for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+      Relocation* relocation = llvm::cast<Relocation>(reloc);
+      if (!isSectionSymbolOf(relocation->symInfo(), *region))
+        continue;
+      size_t i = findPiece(pBoundaries, relocation->addend());
+      if (i == 0)
+        continue;
+
+      if (symbols[i] == NULL)
+        symbols[i] =
+            m_Builder.CreateLocalSymbol(*FragmentRef::Create(*pieces[i], 0));
+      relocation->setSymInfo(symbols[i]);
+      relocation->setAddend(relocation->addend() - pBoundaries[i]);
+    }
+  }
+}
+
+}  // namespace mcld
@@ -0,0 +1,183 @@
+//===- SizeReport.cpp -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/SizeReport.h"
+
+#include "mcld/LD/LDSection.h"
+#include "mcld/MC/Input.h"
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace mcld {
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+void writeJSONString(llvm::raw_ostream& pOS, llvm::StringRef pString) {
+  pOS << '"';
+  for (size_t i = 0; i < pString.size(); ++i) {
+    unsigned char c = pString[i];
+    if (c == '"' || c == '\\') {
+      pOS << '\\' << pString[i];
+    } else if (c < 0x20) {
+      pOS << "\\u00";
+      pOS.write_hex(c >> 4);
+      pOS.write_hex(c & 0xf);
+    } else {
+      pOS << pString[i];
+    }
+  }
+  pOS << '"';
+}
+
+void writeCSVField(llvm::raw_ostream& pOS, llvm::StringRef pField) {
+  if (pField.find_first_of(",\"\n") == llvm::StringRef::npos) {
+    pOS << pField;
+    return;
+  }
+  pOS << '"';
+  for (size_t i = 0; i < pField.size(); ++i) {
+    if (pField[i] == '"')
+      pOS << '"';
+    pOS << pField[i];
+  }
+  pOS << '"';
+}
+
+/// getMember - the name of an archive member, or empty
+llvm::StringRef getMember(const Input& pInput) {
+  if (pInput.fileOffset() == 0)
+    return llvm::StringRef();
+  return pInput.name();
+}
+
+void writeCSVLine(llvm::raw_ostream& pOS,
+                  const Input& pInput,
+                  llvm::StringRef pSection,
+                  uint64_t pBytes) {
+  writeCSVField(pOS, pInput.path().native());
+  pOS << ',';
+  writeCSVField(pOS, getMember(pInput));
+  pOS << ',';
+  writeCSVField(pOS, pSection);
+  pOS << ',' << pBytes << '\n';
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// SizeReport
+//===----------------------------------------------------------------------===//
+SizeReport::SizeReport() {
+}
+
+SizeReport::~SizeReport() {
+}
+
+SizeReport::Entry& SizeReport::getEntry(const Input& pInput) {
+  std::pair<std::unordered_map<const Input*, size_t>::iterator, bool> index =
+      m_Index.insert(std::make_pair(&pInput, m_Entries.size()));
+  if (index.second) {
+    Entry entry;
+    entry.input = &pInput;
+    entry.stripped = 0;
+    entry.folded = 0;
+    m_Entries.push_back(entry);
+  }
+  return m_Entries[index.first->second];
+}
+
+void SizeReport::addSection(const Input& pInput,
+                            const LDSection& pSection,
+                            const LDSection& pOutput) {
+  // an input has a few output sections, a linear search is enough
+  std::vector<OutputBytes>& outputs = getEntry(pInput).outputs;
+  std::vector<OutputBytes>::iterator out, outEnd = outputs.end();
+  for (out = outputs.begin(); out != outEnd; ++out) {
+    if (out->first == &pOutput) {
+      out->second += pSection.size();
+      return;
+    }
+  }
+  outputs.push_back(std::make_pair(&pOutput, pSection.size()));
+}
+
+void SizeReport::addStripped(const Input& pInput, const LDSection& pSection) {
+  getEntry(pInput).stripped += pSection.size();
+}
+
+void SizeReport::addFolded(const Input& pInput, const LDSection& pSection) {
+  getEntry(pInput).folded += pSection.size();
+}
+
+void SizeReport::writeJSON(llvm::raw_ostream& pOS) const {
+  std::vector<OutputBytes> totals;
+  uint64_t stripped = 0, folded = 0;
+
+  pOS << "{\n  \"inputs\": [";
+  std::vector<Entry>::const_iterator entry, eEnd = m_Entries.end();
+  for (entry = m_Entries.begin(); entry != eEnd; ++entry) {
+    pOS << (entry == m_Entries.begin() ? "\n" : ",\n") << "    {\"file\": ";
+    writeJSONString(pOS, entry->input->path().native());
+    pOS << ", \"member\": ";
+    writeJSONString(pOS, getMember(*entry->input));
+    pOS << ", \"sections\": {";
+
+    std::vector<OutputBytes>::const_iterator out, outEnd = entry->outputs.end();
+    for (out = entry->outputs.begin(); out != outEnd; ++out) {
+      if (out != entry->outputs.begin())
+        pOS << ", ";
+      writeJSONString(pOS, out->first->name());
+      pOS << ": " << out->second;
+
+      std::vector<OutputBytes>::iterator total, tEnd = totals.end();
+      for (total = totals.begin(); total != tEnd; ++total) {
+        if (total->first == out->first)
+          break;
+      }
+      if (total == tEnd)
+        totals.push_back(std::make_pair(out->first, out->second));
+      else
+        total->second += out->second;
+    }
+    pOS << "}, \"gc\": " << entry->stripped << ", \"icf\": " << entry->folded
+        << "}";
+    stripped += entry->stripped;
+    folded += entry->folded;
+  }
+
+  pOS << "\n  ],\n  \"sections\": {";
+  std::vector<OutputBytes>::const_iterator total, tEnd = totals.end();
+  for (total = totals.begin(); total != tEnd; ++total) {
+    if (total != totals.begin())
+      pOS << ", ";
+    writeJSONString(pOS, total->first->name());
+    pOS << ": " << total->second;
+  }
+  pOS << "},\n  \"gc\": " << stripped << ",\n  \"icf\": " << folded << "\n}\n";
+}
+
+void SizeReport::writeCSV(llvm::raw_ostream& pOS) const {
+  // the bytes removed are on the lines of the pseudo sections (gc) and (icf)
+  pOS << "file,member,section,bytes\n";
+  std::vector<Entry>::const_iterator entry, eEnd = m_Entries.end();
+  for (entry = m_Entries.begin(); entry != eEnd; ++entry) {
+    std::vector<OutputBytes>::const_iterator out, outEnd = entry->outputs.end();
+    for (out = entry->outputs.begin(); out != outEnd; ++out)
+      writeCSVLine(pOS, *entry->input, out->first->name(), out->second);
+    if (entry->stripped != 0)
+      writeCSVLine(pOS, *entry->input, "(gc)", entry->stripped);
+    if (entry->folded != 0)
+      writeCSVLine(pOS, *entry->input, "(icf)", entry->folded);
+  }
+}
+
+}  // namespace mcld
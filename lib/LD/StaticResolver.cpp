@@ -9,11 +9,17 @@
 #include "mcld/LD/StaticResolver.h"
 
 #include "mcld/LD/LDSymbol.h"
-#include "mcld/Support/Demangle.h"
 #include "mcld/Support/MsgHandling.h"
+#include "mcld/Support/Statistic.h"
 
 namespace mcld {
 
+static Statistic NumResolve("resolver.resolve", "The # of resolved symbols");
+static Statistic NumOverride("resolver.override",
+                             "The # of symbols overridden by a new one");
+static Statistic NumFailure("resolver.failure",
+                            "The # of symbols which cannot be resolved");
+
 //==========================
 // StaticResolver
 StaticResolver::~StaticResolver() {
@@ -72,6 +78,7 @@ bool StaticResolver::resolve(ResolveInfo& __restrict__ pOld,
       case FAIL: { /* abort.  */
         fatal(diag::fail_sym_resolution) << __FILE__ << __LINE__
                                          << "mclinker@googlegroups.com";
+        ++NumFailure;
         return false;
       }
       case NOACT: { /* no action.  */
@@ -179,13 +186,13 @@ bool StaticResolver::resolve(ResolveInfo& __restrict__ pOld,
             break;
           } else {
             error(diag::multiple_absolute_definitions)
-                << demangleName(pNew.name()) << pOld.outSymbol()->value()
+                << pOld << pOld.outSymbol()->value()
                 << pValue;
             break;
           }
         }
 
-        error(diag::multiple_definitions) << demangleName(pNew.name());
+        error(diag::multiple_definitions) << pOld;
         break;
       }
       case REFC: { /* Mark indirect symbol referenced and then CYCLE.  */
@@ -202,10 +209,14 @@ bool StaticResolver::resolve(ResolveInfo& __restrict__ pOld,
       default: {
         error(diag::undefined_situation) << action << old->name()
                                          << pNew.name();
+        ++NumFailure;
         return false;
       }
     }  // end of the big switch (action)
   } while (cycle);
+  ++NumResolve;
+  if (pOverride)
+    ++NumOverride;
   return true;
 }
 
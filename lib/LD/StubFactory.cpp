@@ -9,18 +9,30 @@
 #include "mcld/LD/StubFactory.h"
 
 #include "mcld/IRBuilder.h"
+#include "mcld/Module.h"
 #include "mcld/Fragment/FragmentRef.h"
 #include "mcld/Fragment/Relocation.h"
 #include "mcld/Fragment/Stub.h"
 #include "mcld/LD/BranchIsland.h"
 #include "mcld/LD/BranchIslandFactory.h"
+#include "mcld/LD/LDContext.h"
+#include "mcld/LD/LDSection.h"
 #include "mcld/LD/LDSymbol.h"
+#include "mcld/LD/RelocData.h"
 #include "mcld/LD/ResolveInfo.h"
+#include "mcld/MC/Input.h"
+#include "mcld/Support/Statistic.h"
+#include "mcld/Support/ThreadPool.h"
+
+#include <llvm/Support/Casting.h>
 
 #include <string>
+#include <utility>
 
 namespace mcld {
 
+static Statistic NumStubs("stub.create", "The # of stubs created");
+
 //===----------------------------------------------------------------------===//
 // StubFactory
 //===----------------------------------------------------------------------===//
@@ -34,6 +46,26 @@ StubFactory::~StubFactory() {
 /// addPrototype - register a stub prototype
 void StubFactory::addPrototype(Stub* pPrototype) {
   m_StubPool.push_back(pPrototype);
+
+  std::vector<Relocation::Type> types;
+  if (!pPrototype->getDutyTypes(types)) {
+    // probed for every type of relocation
+    m_AnyTypeStubs.push_back(pPrototype);
+    for (TypeTableType::iterator it = m_TypeTable.begin(),
+                                 ie = m_TypeTable.end(); it != ie; ++it)
+      it->second.push_back(pPrototype);
+    return;
+  }
+
+  for (std::vector<Relocation::Type>::iterator it = types.begin(),
+                                               ie = types.end(); it != ie;
+       ++it) {
+    std::pair<TypeTableType::iterator, bool> entry =
+        m_TypeTable.insert(std::make_pair(*it, m_AnyTypeStubs));
+    StubPoolType& pool = entry.first->second;
+    if (pool.empty() || pool.back() != pPrototype)
+      pool.push_back(pPrototype);
+  }
 }
 
 /// create - create a stub if needed, otherwise return NULL
@@ -42,36 +74,47 @@ Stub* StubFactory::create(Relocation& pReloc,
                           IRBuilder& pBuilder,
                           BranchIslandFactory& pBRIslandFactory) {
   // find if there is a prototype stub for the input relocation
-  Stub* stub = NULL;
   Stub* prototype = findPrototype(pReloc, pReloc.place(), pTargetSymValue);
-  if (prototype != NULL) {
-    const Fragment* frag = pReloc.targetRef().frag();
-    // find the islands for the input relocation
-    std::pair<BranchIsland*, BranchIsland*> islands =
-        pBRIslandFactory.getIslands(*frag);
-    if (islands.first == NULL) {
-      // early exit if we can not find the forward island.
-      return NULL;
-    }
+  if (prototype == NULL)
+    return NULL;
+  return create(pReloc, *prototype, pBuilder, pBRIslandFactory);
+}
 
-    // find if there is such a stub in the backward island first.
-    if (islands.second != NULL) {
-      stub = islands.second->findStub(prototype, pReloc);
-    }
+Stub* StubFactory::create(Relocation& pReloc,
+                          Stub& pPrototype,
+                          IRBuilder& pBuilder,
+                          BranchIslandFactory& pBRIslandFactory) {
+  const Fragment* frag = pReloc.targetRef().frag();
+  // find the islands for the input relocation
+  std::pair<BranchIsland*, BranchIsland*> islands =
+      pBRIslandFactory.getIslands(*frag);
+  if (islands.first == NULL) {
+    // early exit if we can not find the forward island.
+    return NULL;
+  }
 
+  // find if there is such a stub in the backward island first.
+  Stub* stub = NULL;
+  if (islands.second != NULL) {
+    stub = islands.second->findStub(&pPrototype, pReloc);
+  }
+
+  if (stub == NULL) {
+    // find if there is such a stub in the forward island, or else in any
+    // other island that the branch can reach.
+    stub = islands.first->findStub(&pPrototype, pReloc);
+    if (stub == NULL)
+      stub = pBRIslandFactory.findStub(&pPrototype, pReloc);
     if (stub == NULL) {
-      // find if there is such a stub in the forward island.
-      stub = islands.first->findStub(prototype, pReloc);
-      if (stub == NULL) {
-        // create a stub from the prototype
-        stub = prototype->clone();
+      // create a stub from the prototype
+      stub = pPrototype.clone();
+      ++NumStubs;
 
-        // apply fixups in this new stub
-        stub->applyFixup(pReloc, pBuilder, *islands.first);
+      // apply fixups in this new stub
+      stub->applyFixup(pReloc, pBuilder, *islands.first);
 
-        // add stub to the forward branch island
-        islands.first->addStub(prototype, pReloc, *stub);
-      }
+      // add stub to the forward branch island
+      islands.first->addStub(&pPrototype, pReloc, *stub);
     }
   }
   return stub;
@@ -92,6 +135,7 @@ Stub* StubFactory::create(FragmentRef& pFragRef,
     } else {
       // create a stub from the prototype
       Stub* stub = prototype->clone();
+      ++NumStubs;
 
       // apply fixups in this new stub
       stub->applyFixup(pFragRef, pBuilder, *islands.first);
@@ -104,13 +148,51 @@ Stub* StubFactory::create(FragmentRef& pFragRef,
   }  // if (prototype == NULL)
 }
 
+/// findStubs - find the relocations which need stubs, one object a task
+void StubFactory::findStubs(Module& pModule,
+                            const BranchTarget& pTarget,
+                            ThreadPool& pPool,
+                            CandidateList& pCandidates) const {
+  std::vector<Input*> objects(pModule.obj_begin(), pModule.obj_end());
+  std::vector<CandidateList> found(objects.size());
+  parallelFor(pPool, 0, objects.size(), [&](size_t pIndex) {
+    LDContext* context = objects[pIndex]->context();
+    LDContext::sect_iterator rs, rsEnd = context->relocSectEnd();
+    for (rs = context->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+        continue;
+      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+        Relocation* relocation = llvm::cast<Relocation>(reloc);
+        uint64_t target = 0x0;
+        if (!pTarget(*relocation, target))
+          continue;
+        Stub* prototype = findPrototype(*relocation, target);
+        if (prototype == NULL)
+          continue;
+        Candidate candidate;
+        candidate.reloc = relocation;
+        candidate.prototype = prototype;
+        found[pIndex].push_back(candidate);
+      }
+    }
+  });
+
+  for (size_t i = 0; i < found.size(); ++i)
+    pCandidates.insert(pCandidates.end(), found[i].begin(), found[i].end());
+}
+
 /// findPrototype - find if there is a registered stub prototype for the given
 /// relocation
 Stub* StubFactory::findPrototype(const Relocation& pReloc,
                                  uint64_t pSource,
                                  uint64_t pTargetSymValue) const {
-  for (StubPoolType::const_iterator it = m_StubPool.begin(),
-                                    ie = m_StubPool.end(); it != ie; ++it) {
+  // only the prototypes which may fix the type of pReloc are probed
+  TypeTableType::const_iterator entry = m_TypeTable.find(pReloc.type());
+  const StubPoolType& pool =
+      (entry != m_TypeTable.end()) ? entry->second : m_AnyTypeStubs;
+  for (StubPoolType::const_iterator it = pool.begin(), ie = pool.end();
+       it != ie; ++it) {
     if ((*it)->isMyDuty(pReloc, pSource, pTargetSymValue))
       return (*it);
   }
@@ -47,8 +47,10 @@ void TextDiagnosticPrinter::handleDiagnostic(
     const Diagnostic& pInfo) {
   DiagnosticPrinter::handleDiagnostic(pSeverity, pInfo);
 
+  // the message may be dropped by the verbose level, so format it lazily
   std::string out_string;
-  pInfo.format(out_string);
+  if (isVisible(pSeverity))
+    pInfo.format(out_string);
 
   switch (pSeverity) {
     case DiagnosticEngine::Unreachable: {
@@ -81,7 +83,7 @@ void TextDiagnosticPrinter::handleDiagnostic(
     }
     case DiagnosticEngine::Debug: {
       // show debug message only if verbose >= 0
-      if (m_Config.options().verbose() >= 0) {
+      if (isVisible(pSeverity)) {
         m_OStream.changeColor(DebugColor, true);
         m_OStream << "Debug: ";
         m_OStream.resetColor();
@@ -91,7 +93,7 @@ void TextDiagnosticPrinter::handleDiagnostic(
     }
     case DiagnosticEngine::Note: {
       // show ignored message only if verbose >= 1
-      if (m_Config.options().verbose() >= 1) {
+      if (isVisible(pSeverity)) {
         m_OStream.changeColor(NoteColor, true);
         m_OStream << "Note: ";
         m_OStream.resetColor();
@@ -101,7 +103,7 @@ void TextDiagnosticPrinter::handleDiagnostic(
     }
     case DiagnosticEngine::Ignore: {
       // show ignored message only if verbose >= 2
-      if (m_Config.options().verbose() >= 2) {
+      if (isVisible(pSeverity)) {
         m_OStream.changeColor(IgnoreColor, true);
         m_OStream << "Ignore: ";
         m_OStream.resetColor();
@@ -113,6 +115,10 @@ void TextDiagnosticPrinter::handleDiagnostic(
       break;
   }
 
+  // the trace output may be buffered, but a problem is shown at once
+  if (pSeverity <= DiagnosticEngine::Warning)
+    m_OStream.flush();
+
   switch (pSeverity) {
     case DiagnosticEngine::Unreachable: {
       m_OStream << "\n\n";
@@ -163,6 +169,22 @@ void TextDiagnosticPrinter::handleDiagnostic(
   }
 }
 
+bool TextDiagnosticPrinter::isVisible(
+    DiagnosticEngine::Severity pSeverity) const {
+  switch (pSeverity) {
+    case DiagnosticEngine::Debug:
+      return m_Config.options().verbose() >= 0;
+    case DiagnosticEngine::Note:
+      return m_Config.options().verbose() >= 1;
+    case DiagnosticEngine::Ignore:
+      return m_Config.options().verbose() >= 2;
+    case DiagnosticEngine::None:
+      return false;
+    default:
+      return true;
+  }
+}
+
 void TextDiagnosticPrinter::beginInput(const Input& pInput,
                                        const LinkerConfig& pConfig) {
   m_pInput = &pInput;
@@ -0,0 +1,267 @@
+//===- VersionScript.cpp --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/VersionScript.h"
+
+#include "mcld/Config/Config.h"
+
+#include <algorithm>
+#include <cctype>
+#include <utility>
+#if !defined(MCLD_ON_WIN32)
+#include <fnmatch.h>
+#define fnmatch0(pattern, string) (fnmatch(pattern, string, 0) == 0)
+#else
+#include <windows.h>
+#include <shlwapi.h>
+#define fnmatch0(pattern, string) (PathMatchSpec(string, pattern) == true)
+#endif
+
+namespace mcld {
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/** \class Lexer
+ *  \brief Lexer splits a version script into the punctuations `{', `}', `;'
+ *  and `:', the quoted strings and the words between them. A `::' is kept in
+ *  the word, as in the C++ names.
+ */
+class Lexer {
+ public:
+  explicit Lexer(llvm::StringRef pContent) : m_Rest(pContent) {}
+
+  /// next - the next token, or an empty one at the end of the script
+  llvm::StringRef next();
+
+ private:
+  llvm::StringRef m_Rest;
+};
+
+llvm::StringRef Lexer::next() {
+  // skip the spaces and the comments
+  while (true) {
+    m_Rest = m_Rest.ltrim();
+    if (m_Rest.startswith("/*")) {
+      size_t end = m_Rest.find("*/", 2);
+      m_Rest = (end == llvm::StringRef::npos) ? llvm::StringRef()
+                                              : m_Rest.substr(end + 2);
+    } else if (m_Rest.startswith("#")) {
+      m_Rest = m_Rest.substr(m_Rest.find('\n'));
+    } else {
+      break;
+    }
+  }
+  if (m_Rest.empty())
+    return llvm::StringRef();
+
+  size_t length = 0;
+  char c = m_Rest[0];
+  if (c == '{' || c == '}' || c == ';' || c == ':') {
+    length = 1;
+  } else if (c == '"') {
+    size_t end = m_Rest.find('"', 1);
+    length = (end == llvm::StringRef::npos) ? m_Rest.size() : end + 1;
+  } else {
+    while (length < m_Rest.size()) {
+      c = m_Rest[length];
+      if (::isspace(static_cast<unsigned char>(c)) || c == '{' || c == '}' ||
+          c == ';' || c == '"')
+        break;
+      if (c == ':') {
+        if (length + 1 >= m_Rest.size() || m_Rest[length + 1] != ':')
+          break;
+        ++length;
+      }
+      ++length;
+    }
+  }
+
+  llvm::StringRef token = m_Rest.substr(0, length);
+  m_Rest = m_Rest.substr(length);
+  return token;
+}
+
+bool isQuoted(llvm::StringRef pToken) {
+  return pToken.size() >= 2 && pToken.front() == '"' && pToken.back() == '"';
+}
+
+/// isWildcardFree - check if fnmatch treats pName as a plain string
+bool isWildcardFree(llvm::StringRef pName) {
+  return pName.find_first_of("*?[\\") == llvm::StringRef::npos;
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// VersionScript
+//===----------------------------------------------------------------------===//
+VersionScript::VersionScript() : m_AllScope(Unspecified) {
+}
+
+VersionScript::~VersionScript() {
+}
+
+bool VersionScript::parse(llvm::StringRef pContent, std::string& pError) {
+  Lexer lexer(pContent);
+  llvm::StringRef token = lexer.next();
+  while (!token.empty()) {
+    // the name of a version node is optional
+    if (token != "{")
+      token = lexer.next();
+    if (token != "{") {
+      pError = "expected `{' to start a version node";
+      return false;
+    }
+
+    Scope scope = Global;
+    bool in_extern = false, is_cxx = false;
+    token = lexer.next();
+    while (true) {
+      if (token.empty()) {
+        pError = "unterminated version node";
+        return false;
+      }
+
+      if (token == "}") {
+        if (!in_extern)
+          break;
+        in_extern = false;
+        token = lexer.next();
+        if (token == ";")
+          token = lexer.next();
+        continue;
+      }
+
+      llvm::StringRef next = lexer.next();
+      if (!in_extern && (token == "global" || token == "local") &&
+          next == ":") {
+        scope = (token == "global") ? Global : Local;
+        token = lexer.next();
+        continue;
+      }
+
+      if (!in_extern && token == "extern") {
+        if (!isQuoted(next) || lexer.next() != "{") {
+          pError = "expected a language and `{' after `extern'";
+          return false;
+        }
+        // the demangled names of extern "C++" cannot be matched
+        in_extern = true;
+        is_cxx = (next != "\"C\"");
+        token = lexer.next();
+        continue;
+      }
+
+      if (token == "{" || token == ";" || token == ":" ||
+          (token.front() == '"' && !isQuoted(token))) {
+        pError = "unexpected `" + token.str() + "' in a version node";
+        return false;
+      }
+      if (next != ";" && !(in_extern && next == "}")) {
+        pError = "expected `;' after `" + token.str() + "'";
+        return false;
+      }
+
+      if (!in_extern || !is_cxx) {
+        // a quoted name is never a pattern
+        if (isQuoted(token))
+          m_Names.insert(std::make_pair(token.substr(1, token.size() - 2),
+                                        scope));
+        else
+          addPattern(token, scope);
+      }
+      token = (next == ";") ? lexer.next() : next;
+    }
+
+    // the node may depend on the nodes named before its `;'
+    token = lexer.next();
+    while (!token.empty() && token != ";" && token != "{" && token != "}")
+      token = lexer.next();
+    if (token != ";") {
+      pError = "expected `;' after a version node";
+      return false;
+    }
+    token = lexer.next();
+  }
+  return true;
+}
+
+void VersionScript::addPattern(llvm::StringRef pPattern, Scope pScope) {
+  if (pPattern == "*") {
+    if (m_AllScope == Unspecified || pScope == Global)
+      m_AllScope = pScope;
+  } else if (isWildcardFree(pPattern)) {
+    std::pair<llvm::StringMap<Scope>::iterator, bool> name =
+        m_Names.insert(std::make_pair(pPattern, pScope));
+    if (!name.second && pScope == Global)
+      name.first->second = Global;
+  } else {
+    Patterns& patterns = (pScope == Global) ? m_Global : m_Local;
+    llvm::StringRef head = pPattern.substr(0, pPattern.find_first_of("*?[\\"));
+    if (head.size() + 1 == pPattern.size() && pPattern.back() == '*') {
+      if (patterns.prefixes.insert(std::make_pair(head, 0)).second) {
+        std::vector<size_t>::iterator size =
+            std::lower_bound(patterns.prefix_sizes.begin(),
+                             patterns.prefix_sizes.end(), head.size());
+        if (size == patterns.prefix_sizes.end() || *size != head.size())
+          patterns.prefix_sizes.insert(size, head.size());
+      }
+    } else {
+      patterns.globs.push_back(pPattern.str());
+      patterns.glob_heads.push_back(head.size());
+    }
+  }
+}
+
+bool VersionScript::match(const Patterns& pPatterns, llvm::StringRef pName) {
+  std::vector<size_t>::const_iterator size, sizeEnd =
+      pPatterns.prefix_sizes.end();
+  for (size = pPatterns.prefix_sizes.begin(); size != sizeEnd; ++size) {
+    if (*size > pName.size())
+      break;
+    if (pPatterns.prefixes.count(pName.substr(0, *size)) != 0)
+      return true;
+  }
+
+  if (pPatterns.globs.empty())
+    return false;
+  std::string symbol;
+  for (size_t i = 0; i < pPatterns.globs.size(); ++i) {
+    const std::string& glob = pPatterns.globs[i];
+    llvm::StringRef head(glob.data(), pPatterns.glob_heads[i]);
+    if (!pName.startswith(head))
+      continue;
+    if (symbol.empty())
+      symbol = pName.str();
+    if (fnmatch0(glob.c_str(), symbol.c_str()))
+      return true;
+  }
+  return false;
+}
+
+VersionScript::Scope VersionScript::scope(llvm::StringRef pName) const {
+  llvm::StringMap<Scope>::const_iterator name = m_Names.find(pName);
+  if (name != m_Names.end())
+    return name->second;
+
+  if (match(m_Global, pName))
+    return Global;
+  if (match(m_Local, pName))
+    return Local;
+  return m_AllScope;
+}
+
+bool VersionScript::empty() const {
+  return m_Names.empty() && m_Global.empty() && m_Local.empty() &&
+         m_AllScope == Unspecified;
+}
+
+}  // namespace mcld
@@ -11,8 +11,10 @@
 #include "mcld/LinkerConfig.h"
 #include "mcld/MC/Attribute.h"
 #include "mcld/MC/InputBuilder.h"
+#include "mcld/MC/Input.h"
 #include "mcld/MC/SearchDirs.h"
 #include "mcld/Support/MsgHandling.h"
+#include "mcld/Support/FileHandle.h"
 #include "mcld/Support/FileSystem.h"
 
 namespace mcld {
@@ -37,6 +39,27 @@ bool InputFileAction::activate(InputBuilder& pBuilder) const {
   return true;
 }
 
+//===----------------------------------------------------------------------===//
+// InputFilesAction
+//===----------------------------------------------------------------------===//
+InputFilesAction::InputFilesAction(unsigned int pPosition)
+    : InputAction(pPosition) {
+}
+
+bool InputFilesAction::activate(InputBuilder& pBuilder) const {
+  std::vector<const char*>::const_iterator file, fileEnd = m_Paths.end();
+  for (file = m_Paths.begin(); file != fileEnd; ++file) {
+    sys::fs::Path path(*file);
+    pBuilder.createNode<InputTree::Positional>(path.stem().native(), path);
+    Input* input = *pBuilder.getCurrentNode();
+    pBuilder.setContext(*input);
+    pBuilder.setMemory(*input,
+                       FileHandle::OpenMode(FileHandle::ReadOnly),
+                       FileHandle::Permission(FileHandle::System));
+  }
+  return true;
+}
+
 //===----------------------------------------------------------------------===//
 // NamespecAction
 //===----------------------------------------------------------------------===//
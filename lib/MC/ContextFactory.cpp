@@ -15,24 +15,18 @@ namespace mcld {
 //===---------------------------------------------------------------------===//
 // LDContextFactory
 ContextFactory::ContextFactory(size_t pNum)
-    : UniqueGCFactoryBase<sys::fs::Path, LDContext, 0>(pNum) {
+    : GCFactory<LDContext, 0>(pNum) {
 }
 
 ContextFactory::~ContextFactory() {
 }
 
 LDContext* ContextFactory::produce(const sys::fs::Path& pPath) {
-  LDContext* result = find(pPath);
-  if (result == NULL) {
-    result = UniqueGCFactoryBase<sys::fs::Path, LDContext, 0>::allocate();
-    new (result) LDContext();
-    f_KeyMap.insert(std::make_pair(pPath, result));
-  }
-  return result;
+  return produceFile(pPath.generic_string());
 }
 
 LDContext* ContextFactory::produce(const char* pPath) {
-  return produce(sys::fs::Path(pPath));
+  return produceFile(sys::fs::Path(pPath).generic_string());
 }
 
 LDContext* ContextFactory::produce() {
@@ -41,4 +35,13 @@ LDContext* ContextFactory::produce() {
   return result;
 }
 
+LDContext* ContextFactory::produceFile(llvm::StringRef pName) {
+  LDContext*& result = m_ContextMap[pName];
+  if (result == NULL) {
+    result = allocate();
+    new (result) LDContext();
+  }
+  return result;
+}
+
 }  // namespace mcld
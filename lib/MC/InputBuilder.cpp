@@ -132,6 +132,11 @@ bool InputBuilder::setMemory(Input& pInput, void* pMemBuffer, size_t pSize) {
   return true;
 }
 
+void InputBuilder::prefetchMemory(const std::vector<sys::fs::Path>& pPaths,
+                                  ThreadPool& pPool) {
+  m_pMemFactory->prefetch(pPaths, pPool);
+}
+
 const AttrConstraint& InputBuilder::getConstraint() const {
   return m_Config.attribute().constraint();
 }
@@ -14,10 +14,12 @@ namespace mcld {
 //===----------------------------------------------------------------------===//
 // MCLDDirectory
 //===----------------------------------------------------------------------===//
-MCLDDirectory::MCLDDirectory() : Directory(), m_Name(), m_bInSysroot(false) {
+MCLDDirectory::MCLDDirectory()
+    : Directory(), m_Name(), m_bInSysroot(false), m_bListed(false) {
 }
 
-MCLDDirectory::MCLDDirectory(const char* pName) : Directory(), m_Name(pName) {
+MCLDDirectory::MCLDDirectory(const char* pName)
+    : Directory(), m_Name(pName), m_bListed(false) {
   Directory::m_Path.assign(pName);
 
   if (!Directory::m_Path.empty())
@@ -31,7 +33,7 @@ MCLDDirectory::MCLDDirectory(const char* pName) : Directory(), m_Name(pName) {
 }
 
 MCLDDirectory::MCLDDirectory(const std::string& pName)
-    : Directory(), m_Name(pName) {
+    : Directory(), m_Name(pName), m_bListed(false) {
   Directory::m_Path.assign(pName);
 
   if (!Directory::m_Path.empty())
@@ -45,7 +47,7 @@ MCLDDirectory::MCLDDirectory(const std::string& pName)
 }
 
 MCLDDirectory::MCLDDirectory(llvm::StringRef pName)
-    : Directory(), m_Name(pName.data(), pName.size()) {
+    : Directory(), m_Name(pName.data(), pName.size()), m_bListed(false) {
   Directory::m_Path.assign(pName.str());
 
   if (!Directory::m_Path.empty())
@@ -74,6 +76,8 @@ MCLDDirectory& MCLDDirectory::assign(llvm::StringRef pName) {
   Directory::m_SymLinkStatus = sys::fs::FileStatus();
   Directory::m_Cache.clear();
   Directory::m_Handler = 0;
+  m_EntryMap.clear();
+  m_bListed = false;
   return (*this);
 }
 
@@ -95,4 +99,22 @@ void MCLDDirectory::setSysroot(const sys::fs::Path& pSysroot) {
   }
 }
 
+sys::fs::Path* MCLDDirectory::find(const std::string& pFileName) {
+  if (!m_bListed) {
+    // The entries live in the cache of the directory, and do not move when
+    // the cache grows.
+    iterator entry = begin(), enEnd = end();
+    while (entry != enEnd) {
+      m_EntryMap[entry.path()->filename().native()] = entry.path();
+      ++entry;
+    }
+    m_bListed = true;
+  }
+
+  EntryMap::iterator entry = m_EntryMap.find(pFileName);
+  if (entry == m_EntryMap.end())
+    return NULL;
+  return entry->getValue();
+}
+
 }  // namespace mcld
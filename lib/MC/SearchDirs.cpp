@@ -22,6 +22,49 @@ static inline void SpecToFilename(const std::string& pSpec,
   pFile += pSpec;
 }
 
+/// findInDirs - look for the file of pNamespec in each directory in turn. A
+/// shared object is preferred to an archive in the same directory.
+static sys::fs::Path* findInDirs(const SearchDirs::DirList& pDirList,
+                                 const std::string& pNamespec,
+                                 Input::Type pType) {
+  assert(Input::DynObj == pType || Input::Archive == pType ||
+         Input::Script == pType);
+
+  std::string file;
+  if (Input::Script == pType)
+    file.assign(pNamespec);
+  else
+    SpecToFilename(pNamespec, file);
+
+  std::string shared = file + sys::fs::detail::shared_library_extension;
+  std::string archive = file + sys::fs::detail::static_library_extension;
+
+  // for all MCLDDirectorys
+  SearchDirs::DirList::const_iterator mcld_dir, mcld_dir_end = pDirList.end();
+  for (mcld_dir = pDirList.begin(); mcld_dir != mcld_dir_end; ++mcld_dir) {
+    sys::fs::Path* path = NULL;
+    switch (pType) {
+      case Input::Script:
+        path = (*mcld_dir)->find(file);
+        break;
+      case Input::DynObj:
+        path = (*mcld_dir)->find(shared);
+        if (path == NULL)
+          path = (*mcld_dir)->find(archive);
+        break;
+      case Input::Archive:
+        path = (*mcld_dir)->find(archive);
+        break;
+      default:
+        break;
+    }  // end of switch
+
+    if (path != NULL)
+      return path;
+  }  // end of for
+  return NULL;
+}
+
 //===----------------------------------------------------------------------===//
 // SearchDirs
 //===----------------------------------------------------------------------===//
@@ -49,7 +92,8 @@ bool SearchDirs::insert(const std::string& pPath) {
   if (dir->isInSysroot())
     dir->setSysroot(m_SysRoot);
 
-  if (exists(dir->path()) && is_directory(dir->path())) {
+  // a directory exists, so one status is enough
+  if (is_directory(dir->path())) {
     m_DirList.push_back(dir);
     return true;
   } else {
@@ -69,132 +113,12 @@ bool SearchDirs::insert(const sys::fs::Path& pPath) {
 
 mcld::sys::fs::Path* SearchDirs::find(const std::string& pNamespec,
                                       mcld::Input::Type pType) {
-  assert(Input::DynObj == pType || Input::Archive == pType ||
-         Input::Script == pType);
-
-  std::string file;
-  switch (pType) {
-    case Input::Script:
-      file.assign(pNamespec);
-      break;
-    case Input::DynObj:
-    case Input::Archive:
-      SpecToFilename(pNamespec, file);
-      break;
-    default:
-      break;
-  }  // end of switch
-
-  // for all MCLDDirectorys
-  DirList::iterator mcld_dir, mcld_dir_end = m_DirList.end();
-  for (mcld_dir = m_DirList.begin(); mcld_dir != mcld_dir_end; ++mcld_dir) {
-    // for all entries in MCLDDirectory
-    MCLDDirectory::iterator entry = (*mcld_dir)->begin();
-    MCLDDirectory::iterator enEnd = (*mcld_dir)->end();
-
-    switch (pType) {
-      case Input::Script: {
-        while (entry != enEnd) {
-          if (file == entry.path()->filename().native())
-            return entry.path();
-          ++entry;
-        }
-        break;
-      }
-      case Input::DynObj: {
-        while (entry != enEnd) {
-          if (file == entry.path()->stem().native()) {
-            if (mcld::sys::fs::detail::shared_library_extension ==
-                entry.path()->extension().native()) {
-              return entry.path();
-            }
-          }
-          ++entry;
-        }
-      }
-      /** Fall through **/
-      case Input::Archive: {
-        entry = (*mcld_dir)->begin();
-        enEnd = (*mcld_dir)->end();
-        while (entry != enEnd) {
-          if (file == entry.path()->stem().native() &&
-              mcld::sys::fs::detail::static_library_extension ==
-                  entry.path()->extension().native()) {
-            return entry.path();
-          }
-          ++entry;
-        }
-      }
-      default:
-        break;
-    }  // end of switch
-  }    // end of for
-  return NULL;
+  return findInDirs(m_DirList, pNamespec, pType);
 }
 
 const mcld::sys::fs::Path* SearchDirs::find(const std::string& pNamespec,
                                             mcld::Input::Type pType) const {
-  assert(Input::DynObj == pType || Input::Archive == pType ||
-         Input::Script == pType);
-
-  std::string file;
-  switch (pType) {
-    case Input::Script:
-      file.assign(pNamespec);
-      break;
-    case Input::DynObj:
-    case Input::Archive:
-      SpecToFilename(pNamespec, file);
-      break;
-    default:
-      break;
-  }  // end of switch
-
-  // for all MCLDDirectorys
-  DirList::const_iterator mcld_dir, mcld_dir_end = m_DirList.end();
-  for (mcld_dir = m_DirList.begin(); mcld_dir != mcld_dir_end; ++mcld_dir) {
-    // for all entries in MCLDDirectory
-    MCLDDirectory::iterator entry = (*mcld_dir)->begin();
-    MCLDDirectory::iterator enEnd = (*mcld_dir)->end();
-
-    switch (pType) {
-      case Input::Script: {
-        while (entry != enEnd) {
-          if (file == entry.path()->filename().native())
-            return entry.path();
-          ++entry;
-        }
-        break;
-      }
-      case Input::DynObj: {
-        while (entry != enEnd) {
-          if (file == entry.path()->stem().native()) {
-            if (mcld::sys::fs::detail::shared_library_extension ==
-                entry.path()->extension().native()) {
-              return entry.path();
-            }
-          }
-          ++entry;
-        }
-      }
-      /** Fall through **/
-      case Input::Archive: {
-        entry = (*mcld_dir)->begin();
-        enEnd = (*mcld_dir)->end();
-        while (entry != enEnd) {
-          if (file == entry.path()->stem().native() &&
-              mcld::sys::fs::detail::static_library_extension ==
-                  entry.path()->extension().native()) {
-            return entry.path();
-          }
-          ++entry;
-        }
-      }
-      default:
-        break;
-    }  // end of switch
-  }    // end of for
-  return NULL;
+  return findInDirs(m_DirList, pNamespec, pType);
 }
 
 }  // namespace mcld
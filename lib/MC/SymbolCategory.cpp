@@ -64,8 +64,28 @@ SymbolCategory::~SymbolCategory() {
   }
 }
 
+size_t SymbolCategory::position(const LDSymbol& pSymbol) const {
+  size_t pos = pSymbol.m_CategoryPos;
+  if (pos < m_OutputSymbols.size() && m_OutputSymbols[pos] == &pSymbol)
+    return pos;
+
+  // The position is stale if the symbols are sorted through the iterators,
+  // e.g., the sorting of .dynsym for .gnu.hash. A symbol added more than
+  // once only remembers its last position.
+  OutputSymbols::const_iterator it =
+      std::find(m_OutputSymbols.begin(), m_OutputSymbols.end(), &pSymbol);
+  return (it - m_OutputSymbols.begin());
+}
+
+void SymbolCategory::swap(size_t pX, size_t pY) {
+  std::swap(m_OutputSymbols[pX], m_OutputSymbols[pY]);
+  m_OutputSymbols[pX]->m_CategoryPos = pX;
+  m_OutputSymbols[pY]->m_CategoryPos = pY;
+}
+
 SymbolCategory& SymbolCategory::add(LDSymbol& pSymbol, Category::Type pTarget) {
   Category* current = m_pRegular;
+  pSymbol.m_CategoryPos = m_OutputSymbols.size();
   m_OutputSymbols.push_back(&pSymbol);
 
   // use non-stable bubble sort to arrange the order of symbols.
@@ -74,10 +94,8 @@ SymbolCategory& SymbolCategory::add(LDSymbol& pSymbol, Category::Type pTarget) {
       current->end++;
       break;
     } else {
-      if (!current->empty()) {
-        std::swap(m_OutputSymbols[current->begin],
-                  m_OutputSymbols[current->end]);
-      }
+      if (!current->empty())
+        swap(current->begin, current->end);
       current->end++;
       current->begin++;
       current = current->prev;
@@ -95,6 +113,49 @@ SymbolCategory& SymbolCategory::forceLocal(LDSymbol& pSymbol) {
   return add(pSymbol, Category::Local);
 }
 
+SymbolCategory& SymbolCategory::add(const std::vector<LDSymbol*>& pSymbols,
+                                    const std::vector<bool>& pForceLocal) {
+  assert(pSymbols.size() == pForceLocal.size());
+  if (pSymbols.empty())
+    return *this;
+
+  // count the new symbols of each category
+  std::vector<unsigned char> types(pSymbols.size());
+  size_t counts[Category::Regular + 1] = {0};
+  for (size_t i = 0; i < pSymbols.size(); ++i) {
+    assert(pSymbols[i]->resolveInfo() != NULL);
+    types[i] = pForceLocal[i]
+                   ? Category::Local
+                   : Category::categorize(*pSymbols[i]->resolveInfo());
+    ++counts[types[i]];
+  }
+
+  // place the old symbols of each category, and leave room for the new ones
+  OutputSymbols symbols(m_OutputSymbols.size() + pSymbols.size());
+  size_t next[Category::Regular + 1];
+  size_t pos = 0;
+  for (Category* current = m_pFile; current != NULL; current = current->next) {
+    size_t begin = pos;
+    for (size_t i = current->begin; i != current->end; ++i) {
+      symbols[pos] = m_OutputSymbols[i];
+      symbols[pos]->m_CategoryPos = pos;
+      ++pos;
+    }
+    next[current->type] = pos;
+    pos += counts[current->type];
+    current->begin = begin;
+    current->end = pos;
+  }
+
+  for (size_t i = 0; i < pSymbols.size(); ++i) {
+    pos = next[types[i]]++;
+    symbols[pos] = pSymbols[i];
+    symbols[pos]->m_CategoryPos = pos;
+  }
+  m_OutputSymbols.swap(symbols);
+  return *this;
+}
+
 SymbolCategory& SymbolCategory::arrange(LDSymbol& pSymbol,
                                         Category::Type pSource,
                                         Category::Type pTarget) {
@@ -104,46 +165,18 @@ SymbolCategory& SymbolCategory::arrange(LDSymbol& pSymbol,
     return *this;
   }
 
-  // source and target are not in the same category
-  // find the category of source
+  // source and target are not in the same category. The symbol may not be
+  // in the given source category, e.g., if it has been forced to local, so
+  // find the category from its position.
+  size_t pos = position(pSymbol);
+  assert(pos != m_OutputSymbols.size() && "symbol is not in the categories");
+  if (pos == m_OutputSymbols.size())
+    return *this;
+
   Category* current = m_pFile;
-  while (current != NULL) {
-    if (pSource == current->type)
-      break;
+  while (pos >= current->end)
     current = current->next;
-  }
-
-  assert(current != NULL);
-  size_t pos = 0;
-  if (!current->empty()) {
-    // find the position of source
-    pos = current->begin;
-    while (pos != current->end) {
-      if (m_OutputSymbols[pos] == &pSymbol)
-        break;
-      ++pos;
-    }
-  }
-  // FIXME: Try to search the symbol explicitly, if symbol is not in the given
-  // source category. Or we need to add some logics like shouldForceLocal() in
-  // SymbolCategory::Category::categorize().
-  if (current->end == pos || current->empty()) {
-    current = m_pFile;
-    do {
-      pos = current->begin;
-      while (pos != current->end) {
-        if (m_OutputSymbols[pos] == &pSymbol) {
-          distance = pTarget - current->type;
-          break;
-        }
-        ++pos;
-      }
-      if (pos != current->end)
-        break;
-      current = current->next;
-    } while (current != NULL);
-    assert(current != NULL);
-  }
+  distance = pTarget - current->type;
 
   // The distance is positive. It means we should bubble sort downward.
   if (distance > 0) {
@@ -155,7 +188,7 @@ SymbolCategory& SymbolCategory::arrange(LDSymbol& pSymbol,
       } else {
         assert(!current->isLast() && "target category is wrong.");
         rear = current->end - 1;
-        std::swap(m_OutputSymbols[pos], m_OutputSymbols[rear]);
+        swap(pos, rear);
         pos = rear;
         current->next->begin--;
         current->end--;
@@ -174,7 +207,7 @@ SymbolCategory& SymbolCategory::arrange(LDSymbol& pSymbol,
         break;
       } else {
         assert(!current->isFirst() && "target category is wrong.");
-        std::swap(m_OutputSymbols[current->begin], m_OutputSymbols[pos]);
+        swap(current->begin, pos);
         pos = current->begin;
         current->begin++;
         current->prev->end++;
@@ -205,7 +238,7 @@ SymbolCategory& SymbolCategory::changeCommonsToGlobal() {
         m_pDynamic->begin--;
         break;
       case Category::Regular:
-        std::swap(m_OutputSymbols[pos], m_OutputSymbols[m_pDynamic->end - 1]);
+        swap(pos, m_pDynamic->end - 1);
         m_pCommon->end--;
         m_pDynamic->begin--;
         m_pDynamic->end--;
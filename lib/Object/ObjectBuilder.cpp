@@ -24,6 +24,28 @@
 
 namespace mcld {
 
+/// moveFragments - move the fragments of pFrom to pOffset of pTo. The first
+/// one carries pAlign instead of an AlignFragment in front of it.
+static void moveFragments(SectionData& pFrom,
+                          uint32_t pAlign,
+                          SectionData& pTo,
+                          uint64_t& pOffset) {
+  SectionData::FragmentListType& from_list = pFrom.getFragmentList();
+  if (from_list.empty())
+    return;
+  if (pAlign > from_list.front().getAlign())
+    from_list.front().setAlign(pAlign);
+
+  SectionData::FragmentListType::iterator frag, fragEnd = from_list.end();
+  for (frag = from_list.begin(); frag != fragEnd; ++frag) {
+    frag->setParent(&pTo);
+    frag->setOffset(frag->alignOffset(pOffset));
+    pOffset = frag->getOffset() + frag->size();
+  }
+  SectionData::FragmentListType& to_list = pTo.getFragmentList();
+  to_list.splice(to_list.end(), from_list);
+}
+
 //===----------------------------------------------------------------------===//
 // ObjectBuilder
 //===----------------------------------------------------------------------===//
@@ -46,7 +68,7 @@ LDSection* ObjectBuilder::CreateSection(const std::string& pName,
   if (output_sect == NULL) {
     output_sect = LDSection::Create(pName, pKind, pType, pFlag);
     output_sect->setAlign(pAlign);
-    m_Module.getSectionTable().push_back(output_sect);
+    m_Module.appendSection(*output_sect);
   }
   return output_sect;
 }
@@ -72,7 +94,7 @@ LDSection* ObjectBuilder::MergeSection(const Input& pInputFile,
                                pInputSection.type(),
                                pInputSection.flag());
     target->setAlign(pInputSection.align());
-    m_Module.getSectionTable().push_back(target);
+    m_Module.appendSection(*target);
   }
 
   switch (target->kind()) {
@@ -130,31 +152,9 @@ LDSection* ObjectBuilder::MergeSection(const Input& pInputFile,
 bool ObjectBuilder::MoveSectionData(SectionData& pFrom, SectionData& pTo) {
   assert(&pFrom != &pTo && "Cannot move section data to itself!");
 
-  uint64_t offset = pTo.getSection().size();
-  AlignFragment* align = NULL;
-  if (pFrom.getSection().align() > 1) {
-    // if the align constraint is larger than 1, append an alignment
-    unsigned int alignment = pFrom.getSection().align();
-    align = new AlignFragment(/*alignment*/alignment,
-                              /*the filled value*/0x0,
-                              /*the size of filled value*/1u,
-                              /*max bytes to emit*/alignment - 1);
-    align->setOffset(offset);
-    align->setParent(&pTo);
-    pTo.getFragmentList().push_back(align);
-    offset += align->size();
-  }
-
   // move fragments from pFrom to pTO
-  SectionData::FragmentListType& from_list = pFrom.getFragmentList();
-  SectionData::FragmentListType& to_list = pTo.getFragmentList();
-  SectionData::FragmentListType::iterator frag, fragEnd = from_list.end();
-  for (frag = from_list.begin(); frag != fragEnd; ++frag) {
-    frag->setParent(&pTo);
-    frag->setOffset(offset);
-    offset += frag->size();
-  }
-  to_list.splice(to_list.end(), from_list);
+  uint64_t offset = pTo.getSection().size();
+  moveFragments(pFrom, pFrom.getSection().align(), pTo, offset);
 
   // set up pTo's header
   pTo.getSection().setSize(offset);
@@ -162,6 +162,33 @@ bool ObjectBuilder::MoveSectionData(SectionData& pFrom, SectionData& pTo) {
   return true;
 }
 
+/// MoveSectionData - the first fragment moved also carries pAlign, where the
+/// two moves would have aligned it.
+void ObjectBuilder::MoveSectionData(const std::vector<SectionData*>& pFrom,
+                                    uint32_t pAlign,
+                                    SectionData& pTo) {
+  SectionData::FragmentListType& to_list = pTo.getFragmentList();
+  std::vector<SectionData*>::const_iterator from, fromEnd = pFrom.end();
+  for (from = pFrom.begin(); from != fromEnd; ++from) {
+    assert(*from != &pTo && "Cannot move section data to itself!");
+    SectionData::FragmentListType& from_list = (*from)->getFragmentList();
+    if (from_list.empty())
+      continue;
+
+    uint32_t align = (*from)->getSection().align();
+    if (pAlign > align)
+      align = pAlign;
+    pAlign = 1;
+    if (align > from_list.front().getAlign())
+      from_list.front().setAlign(align);
+
+    SectionData::FragmentListType::iterator frag, fragEnd = from_list.end();
+    for (frag = from_list.begin(); frag != fragEnd; ++frag)
+      frag->setParent(&pTo);
+    to_list.splice(to_list.end(), from_list);
+  }
+}
+
 /// UpdateSectionAlign - update alignment for input section
 void ObjectBuilder::UpdateSectionAlign(LDSection& pTo, const LDSection& pFrom) {
   if (pFrom.align() > pTo.align())
@@ -13,42 +13,86 @@
 #include "mcld/LinkerConfig.h"
 #include "mcld/LinkerScript.h"
 #include "mcld/Module.h"
+#include "mcld/ADT/SizeTraits.h"
+#include "mcld/Fragment/RegionFragment.h"
 #include "mcld/Fragment/Relocation.h"
 #include "mcld/LD/Archive.h"
 #include "mcld/LD/ArchiveReader.h"
 #include "mcld/LD/BinaryReader.h"
 #include "mcld/LD/BranchIslandFactory.h"
+#include "mcld/LD/CallGraphSort.h"
+#include "mcld/LD/CompressedSection.h"
 #include "mcld/LD/DebugString.h"
 #include "mcld/LD/DynObjReader.h"
 #include "mcld/LD/GarbageCollection.h"
+#include "mcld/LD/GdbIndex.h"
 #include "mcld/LD/GroupReader.h"
 #include "mcld/LD/IdenticalCodeFolding.h"
+#include "mcld/LD/IncrementalLayout.h"
+#include "mcld/LD/InputCostReport.h"
 #include "mcld/LD/LDContext.h"
 #include "mcld/LD/LDSection.h"
+#include "mcld/LD/LDSymbol.h"
+#include "mcld/LD/LTOCodeGen.h"
+#include "mcld/LD/MapWriter.h"
+#include "mcld/LD/MemoryReport.h"
+#include "mcld/LD/NamePool.h"
 #include "mcld/LD/ObjectReader.h"
 #include "mcld/LD/ObjectWriter.h"
 #include "mcld/LD/Relocator.h"
 #include "mcld/LD/RelocData.h"
 #include "mcld/LD/ResolveInfo.h"
 #include "mcld/LD/SectionData.h"
+#include "mcld/LD/SectionMerger.h"
+#include "mcld/LD/SectionSplitter.h"
+#include "mcld/LD/SizeReport.h"
+#include "mcld/LD/VersionScript.h"
 #include "mcld/Object/ObjectBuilder.h"
 #include "mcld/Script/Assignment.h"
 #include "mcld/Script/Operand.h"
 #include "mcld/Script/RpnEvaluator.h"
 #include "mcld/Script/ScriptFile.h"
 #include "mcld/Script/ScriptReader.h"
+#include "mcld/Support/ELF.h"
 #include "mcld/Support/FileOutputBuffer.h"
+#include "mcld/Support/MemoryArea.h"
 #include "mcld/Support/MsgHandling.h"
 #include "mcld/Support/RealPath.h"
+#include "mcld/Support/Statistic.h"
+#include "mcld/Support/ThreadPool.h"
+#include "mcld/Support/TimeTrace.h"
 #include "mcld/Target/TargetLDBackend.h"
 
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
 #include <llvm/Support/Casting.h>
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/ErrorOr.h>
 #include <llvm/Support/Host.h>
-
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/xxhash.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
 #include <system_error>
+#include <utility>
+#include <vector>
 
 namespace mcld {
 
+/// ApplyFailure - a relocation which can not be applied, and the reason
+typedef Relocator::FailureList::value_type ApplyFailure;
+
+static Statistic NumApply("relocator.apply", "The # of applied relocations");
+static Statistic NumOverflow("relocator.overflow",
+                             "The # of relocations which overflow");
+static Statistic NumReusedRelocated("incremental.reused-relocated-sections",
+                                    "The # of relocated sections reused");
+
 //===----------------------------------------------------------------------===//
 // ObjectLinker
 //===----------------------------------------------------------------------===//
@@ -64,7 +108,12 @@ ObjectLinker::ObjectLinker(const LinkerConfig& pConfig,
       m_pGroupReader(NULL),
       m_pBinaryReader(NULL),
       m_pScriptReader(NULL),
-      m_pWriter(NULL) {
+      m_pWriter(NULL),
+      m_pSectionMerger(NULL),
+      m_pIncremental(NULL),
+      m_pMapWriter(NULL),
+      m_pSizeReport(NULL),
+      m_NumOfNormalized(0) {
 }
 
 ObjectLinker::~ObjectLinker() {
@@ -75,6 +124,12 @@ ObjectLinker::~ObjectLinker() {
   delete m_pBinaryReader;
   delete m_pScriptReader;
   delete m_pWriter;
+  delete m_pSectionMerger;
+
+  std::vector<CompressedSection*>::iterator sect,
+      sectEnd = m_CompressedSections.end();
+  for (sect = m_CompressedSections.begin(); sect != sectEnd; ++sect)
+    delete *sect;
 }
 
 bool ObjectLinker::initialize(Module& pModule, IRBuilder& pBuilder) {
@@ -143,12 +198,113 @@ void ObjectLinker::addUndefinedSymbols() {
   }
 }
 
+/// isSymbolTable - whether pSection is a symbol, string or hash table.
+static bool isSymbolTable(const LDSection& pSection) {
+  return (LDFileFormat::NamePool == pSection.kind());
+}
+
+/// isEmittedData - whether the content of pSection is copied to the output.
+/// Sections removed by garbage collection or folded away are not.
+static bool isEmittedData(const LDSection& pSection) {
+  switch (pSection.kind()) {
+    case LDFileFormat::TEXT:
+    case LDFileFormat::DATA:
+    case LDFileFormat::Debug:
+    case LDFileFormat::DebugString:
+    case LDFileFormat::Target:
+    case LDFileFormat::EhFrame:
+    case LDFileFormat::GCCExceptTable:
+    case LDFileFormat::Note:
+    case LDFileFormat::MetaData:
+      return (llvm::ELF::SHT_NOBITS != pSection.type());
+    default:
+      return false;
+  }
+}
+
+/// adviseSections - give pAdvice on the file content of the input sections
+/// that pWanted selects.
+static void adviseSections(const std::vector<Input*>& pInputs,
+                           bool (*pWanted)(const LDSection&),
+                           MemoryArea::Advice pAdvice) {
+  std::vector<Input*>::const_iterator input, inEnd = pInputs.end();
+  for (input = pInputs.begin(); input != inEnd; ++input) {
+    if (!(*input)->hasMemArea() || !(*input)->hasContext())
+      continue;
+
+    LDContext::const_sect_iterator sect, sectEnd;
+    sectEnd = (*input)->context()->sectEnd();
+    for (sect = (*input)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      if (!(*sect)->hasOffset() || !pWanted(**sect))
+        continue;
+      (*input)->memArea()->advise(
+          (*input)->fileOffset() + (*sect)->offset(), (*sect)->size(),
+          pAdvice);
+    }
+  }
+}
+
+/// getIgnoredSections - the sections of pInputs that are not linked
+static void getIgnoredSections(const std::vector<Input*>& pInputs,
+                               std::set<const LDSection*>& pIgnored) {
+  std::vector<Input*>::const_iterator obj, objEnd = pInputs.end();
+  for (obj = pInputs.begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
+    for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      if (LDFileFormat::Ignore == (*sect)->kind())
+        pIgnored.insert(*sect);
+    }
+  }
+}
+
+/// prefetchInputs - start reading in every file of the input tree. Archive
+/// members share the file of their archive, which is advised only once.
+static void prefetchInputs(InputTree& pTree, ThreadPool& pPool) {
+  std::set<MemoryArea*> areas;
+  InputTree::dfs_iterator input, inEnd = pTree.dfs_end();
+  for (input = pTree.dfs_begin(); input != inEnd; ++input) {
+    if (!(*input)->hasMemArea())
+      continue;
+
+    MemoryArea* area = (*input)->memArea();
+    if (!areas.insert(area).second)
+      continue;
+    pPool.async([area]() {
+      area->advise(0, area->size(), MemoryArea::WillNeed);
+    });
+  }
+}
+
 void ObjectLinker::normalize() {
+  // The first touch of a file is slow on network file systems. Ask for all
+  // input files up front from a separate pool, so that they are warm by the
+  // time they are read one by one below. With --gc-sections, much of the
+  // contents may never be emitted, so only the sections that survive are
+  // asked for after garbage collection. See dataStrippingOpt.
+  ThreadPool io_pool(m_Config.options().numThreads());
+  if (!m_Config.options().GCSections() ||
+      (LinkerConfig::Object == m_Config.codeGenType()))
+    prefetchInputs(m_pModule->getInputTree(), io_pool);
+
+  // Relocatable objects are staged after their sections are read. The staged
+  // symbols must be added before reading any input which may add or look up
+  // symbols, such as archives, shared objects and groups.
+  ThreadPool pool(m_Config.options().numThreads());
+  NamePool& names = m_pModule->getNamePool();
+  std::vector<Input*> staged;
+  size_t obj_begin = m_pModule->getObjectList().size();
+
   // -----  set up inputs  ----- //
-  Module::input_iterator input, inEnd = m_pModule->input_end();
-  for (input = m_pModule->input_begin(); input != inEnd; ++input) {
+  // The inputs read by the last call, such as the runtime of a snapshot of
+  // Linker, are not read again.
+  Module::input_iterator input = m_pModule->input_begin(),
+                         inEnd = m_pModule->input_end();
+  for (size_t i = 0; i < m_NumOfNormalized && input != inEnd; ++i)
+    ++input;
+  for (; input != inEnd; ++input, ++m_NumOfNormalized) {
     // is a group node
     if (isGroup(input)) {
+      getObjectReader()->addStagedSymbols(pool, names, staged);
       getGroupReader()->readGroup(
           input, inEnd, m_pBuilder->getInputBuilder(), m_Config);
       continue;
@@ -174,6 +330,7 @@ void ObjectLinker::normalize() {
     bool doContinue = false;
     // read input as a binary file
     if (getBinaryReader()->isMyFormat(**input, doContinue)) {
+      getObjectReader()->addStagedSymbols(pool, names, staged);
       (*input)->setType(Input::Object);
       getBinaryReader()->readBinary(**input);
       m_pModule->getObjectList().push_back(*input);
@@ -183,11 +340,12 @@ void ObjectLinker::normalize() {
       (*input)->setType(Input::Object);
       getObjectReader()->readHeader(**input);
       getObjectReader()->readSections(**input);
-      getObjectReader()->readSymbols(**input);
+      staged.push_back(*input);
       m_pModule->getObjectList().push_back(*input);
     } else if (doContinue &&
                getDynObjReader()->isMyFormat(**input, doContinue)) {
       // is a shared object file
+      getObjectReader()->addStagedSymbols(pool, names, staged);
       (*input)->setType(Input::DynObj);
       getDynObjReader()->readHeader(**input);
       getDynObjReader()->readSymbols(**input);
@@ -195,6 +353,7 @@ void ObjectLinker::normalize() {
     } else if (doContinue &&
                getArchiveReader()->isMyFormat(**input, doContinue)) {
       // is an archive
+      getObjectReader()->addStagedSymbols(pool, names, staged);
       (*input)->setType(Input::Archive);
       if (m_Config.options().isInExcludeLIBS(**input)) {
         (*input)->setNoExport();
@@ -208,6 +367,7 @@ void ObjectLinker::normalize() {
     } else if (doContinue &&
                getScriptReader()->isMyFormat(**input, doContinue)) {
       // try to parse input as a linker script
+      getObjectReader()->addStagedSymbols(pool, names, staged);
       ScriptFile script(
           ScriptFile::LDScript, **input, m_pBuilder->getInputBuilder());
       if (getScriptReader()->readScript(m_Config, script)) {
@@ -218,12 +378,37 @@ void ObjectLinker::normalize() {
               input, script.inputs());
         }
       }
+    } else if (doContinue && LTOCodeGen::isBitcode(**input)) {
+      // compiled by the LTO stage of Linker, which reads the objects
+      (*input)->setType(Input::External);
     } else {
       if (m_Config.options().warnMismatch())
         warning(diag::warn_unrecognized_input_file)
             << (*input)->path() << m_Config.targets().triple().str();
     }
   }  // end of for
+
+  getObjectReader()->addStagedSymbols(pool, names, staged);
+
+  // The compressed debug sections of all inputs are inflated together.
+  getObjectReader()->decompressSections(pool);
+
+  // The input tree is complete. The later passes walk its flattened list.
+  m_pModule->buildInputList();
+
+  // The .eh_frame sections of different objects are parsed independently.
+  Module::ObjectList& objects = m_pModule->getObjectList();
+  parallelForEach(pool, objects.begin() + obj_begin, objects.end(),
+                  [this](Input* pInput) {
+    getObjectReader()->readEhFrames(*pInput);
+  });
+
+  // All symbols have been read, and the symbol tables are never read again.
+  // Let the system reclaim their pages.
+  adviseSections(
+      m_pModule->getObjectList(), isSymbolTable, MemoryArea::DontNeed);
+  adviseSections(
+      m_pModule->getLibraryList(), isSymbolTable, MemoryArea::DontNeed);
 }
 
 bool ObjectLinker::linkable() const {
@@ -261,6 +446,102 @@ bool ObjectLinker::linkable() const {
   return true;
 }
 
+/// readVersionNodes - read the version nodes of the file pPath into pScript
+static bool readVersionNodes(const std::string& pPath,
+                             unsigned int pReadError,
+                             unsigned int pParseError,
+                             VersionScript& pScript) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer> > buffer =
+      llvm::MemoryBuffer::getFile(pPath);
+  if (!buffer) {
+    error(pReadError) << pPath << buffer.getError().message();
+    return false;
+  }
+
+  std::string message;
+  if (!pScript.parse((*buffer)->getBuffer(), message)) {
+    error(pParseError) << pPath << message;
+    return false;
+  }
+  return true;
+}
+
+/// applyVersionScript - hide the defined symbols which the version script
+/// makes local. They are then neither exported nor preemptible, so the
+/// relocations against them need no symbol lookup at runtime.
+bool ObjectLinker::applyVersionScript() {
+  VersionScript script;
+  if (!readVersionNodes(m_Config.options().getVersionScript(),
+                        diag::err_cannot_read_version_script,
+                        diag::err_malformed_version_script,
+                        script))
+    return false;
+
+  // the symbols are classified in one parallel pass. Each task only
+  // changes its own symbols.
+  std::vector<ResolveInfo*> syms;
+  NamePool& names = m_pModule->getNamePool();
+  NamePool::syminfo_iterator info, infoEnd = names.syminfo_end();
+  for (info = names.syminfo_begin(); info != infoEnd; ++info) {
+    ResolveInfo* sym = info.getEntry();
+    if (sym->isDyn() || (!sym->isDefine() && !sym->isCommon()) ||
+        (!sym->isGlobal() && !sym->isWeak()))
+      continue;
+    if (sym->visibility() != ResolveInfo::Default &&
+        sym->visibility() != ResolveInfo::Protected)
+      continue;
+    syms.push_back(sym);
+  }
+
+  ThreadPool pool(m_Config.options().numThreads());
+  parallelFor(pool, 0, syms.size(), [&syms, &script](size_t pIndex) {
+    llvm::StringRef name(syms[pIndex]->name(), syms[pIndex]->nameSize());
+    if (VersionScript::Local == script.scope(name))
+      syms[pIndex]->setVisibility(ResolveInfo::Hidden);
+  });
+  return true;
+}
+
+/// applyDynamicList - tell the backend which defined symbols the dynamic
+/// list keeps preemptible. The references to the others are bound to their
+/// definitions in the shared object.
+bool ObjectLinker::applyDynamicList() {
+  VersionScript list;
+  if (!readVersionNodes(m_Config.options().getDynamicList(),
+                        diag::err_cannot_read_dynamic_list,
+                        diag::err_malformed_dynamic_list,
+                        list))
+    return false;
+
+  std::vector<const ResolveInfo*> syms;
+  NamePool& names = m_pModule->getNamePool();
+  NamePool::syminfo_iterator info, infoEnd = names.syminfo_end();
+  for (info = names.syminfo_begin(); info != infoEnd; ++info) {
+    const ResolveInfo* sym = info.getEntry();
+    if (!sym->isDyn() && sym->isDefine())
+      syms.push_back(sym);
+  }
+
+  // match in parallel, and add to the backend in the order of the pool
+  std::vector<char> listed(syms.size(), 0);
+  ThreadPool pool(m_Config.options().numThreads());
+  parallelFor(pool, 0, syms.size(), [&](size_t pIndex) {
+    llvm::StringRef name(syms[pIndex]->name(), syms[pIndex]->nameSize());
+    listed[pIndex] = (VersionScript::Global == list.scope(name));
+  });
+  for (size_t i = 0; i < syms.size(); ++i) {
+    if (listed[i] != 0)
+      m_LDBackend.addDynamicListSymbol(*syms[i]);
+  }
+  return true;
+}
+
+void ObjectLinker::addMemoryUsage(MemoryReport& pReport) const {
+  pReport.addModule(*m_pModule);
+  if (m_pSectionMerger != NULL)
+    m_pSectionMerger->addMemoryUsage(pReport);
+}
+
 void ObjectLinker::dataStrippingOpt() {
   if (m_Config.codeGenType() == LinkerConfig::Object) {
     return;
@@ -268,12 +549,53 @@ void ObjectLinker::dataStrippingOpt() {
 
   // Garbege collection
   if (m_Config.options().GCSections()) {
-    GarbageCollection GC(m_Config, m_LDBackend, *m_pModule);
+    TimeTrace::Scope scope("gcSections");
+
+    // the objects built without -ffunction-sections keep all functions in
+    // one .text, which is split for the collection to see them one by one
+    if (m_Config.options().splitTextForGC()) {
+      SectionSplitter splitter(*m_pModule, *m_pBuilder, *getObjectReader());
+      splitter.run();
+    }
+
+    GarbageCollection GC(m_Config, m_LDBackend, *m_pModule,
+                         *getObjectReader());
+
+    // the sections ignored before the collection, such as the discarded
+    // group members, are not counted as collected by --size-report
+    std::set<const LDSection*> ignored;
+    if (m_pSizeReport != NULL)
+      getIgnoredSections(m_pModule->getObjectList(), ignored);
+
     GC.run();
+
+    if (m_pSizeReport != NULL) {
+      Module::obj_iterator obj, objEnd = m_pModule->obj_end();
+      for (obj = m_pModule->obj_begin(); obj != objEnd; ++obj) {
+        LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
+        for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+          // the relocations of the collected sections are not output bytes
+          if (LDFileFormat::Ignore == (*sect)->kind() &&
+              ignored.count(*sect) == 0 &&
+              llvm::ELF::SHT_REL != (*sect)->type() &&
+              llvm::ELF::SHT_RELA != (*sect)->type())
+            m_pSizeReport->addStripped(**obj, **sect);
+        }
+      }
+    }
+
+    // the relocations of the sections that survive are needed from now on
+    readDeferredRelocations();
+
+    // start reading in the contents of the sections that survive. ICF and
+    // section merging read them before they are emitted.
+    adviseSections(
+        m_pModule->getObjectList(), isEmittedData, MemoryArea::WillNeed);
   }
 
   // Identical code folding
   if (m_Config.options().getICFMode() != GeneralOptions::ICF::None) {
+    TimeTrace::Scope scope("icf");
     IdenticalCodeFolding icf(m_Config, m_LDBackend, *m_pModule);
     icf.foldIdenticalCode();
   }
@@ -284,16 +606,54 @@ void ObjectLinker::dataStrippingOpt() {
 ///
 /// All symbols should be read and resolved before this function.
 bool ObjectLinker::readRelocations() {
+  // With --gc-sections, the relocations of the sections that garbage
+  // collection may discard are read when the collector reaches the sections,
+  // and the rest of them after garbage collection. See dataStrippingOpt.
+  bool defer = m_Config.options().GCSections() &&
+               LinkerConfig::Object != m_Config.codeGenType();
+
   // Bitcode is read by the other path. This function reads relocation sections
   // in object files.
-  mcld::InputTree::bfs_iterator input,
-      inEnd = m_pModule->getInputTree().bfs_end();
-  for (input = m_pModule->getInputTree().bfs_begin(); input != inEnd; ++input) {
-    if ((*input)->type() == Input::Object && (*input)->hasMemArea()) {
+  Module::InputList::const_iterator input,
+      inEnd = m_pModule->getInputList().end();
+  for (input = m_pModule->getInputList().begin(); input != inEnd; ++input) {
+    if ((*input)->type() != Input::Object || !(*input)->hasMemArea())
+      continue;  // ignore the other kinds of files.
+
+    if (!defer) {
       if (!getObjectReader()->readRelocations(**input))
         return false;
+      continue;
+    }
+
+    LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
+    for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() ||
+          GarbageCollection::mayDeferRelocations(*(*rs)->getLink()))
+        continue;
+      if (!getObjectReader()->readRelocation(**input, **rs))
+        return false;
+    }
+  }
+  return true;
+}
+
+/// readDeferredRelocations - read the relocation sections left by
+/// readRelocations and not read by garbage collection.
+bool ObjectLinker::readDeferredRelocations() {
+  Module::InputList::const_iterator input,
+      inEnd = m_pModule->getInputList().end();
+  for (input = m_pModule->getInputList().begin(); input != inEnd; ++input) {
+    if ((*input)->type() != Input::Object || !(*input)->hasMemArea())
+      continue;
+
+    LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
+    for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || (*rs)->hasRelocData())
+        continue;
+      if (!getObjectReader()->readRelocation(**input, **rs))
+        return false;
     }
-    // ignore the other kinds of files.
   }
   return true;
 }
@@ -335,11 +695,44 @@ bool ObjectLinker::mergeSections() {
     }  // for each output section description
   }
 
+  // The contents of SHF_MERGE sections are merged after the sections are
+  // moved into place.
+  // FIXME: disable the contents merge when doing partial link.
+  if (LinkerConfig::Object != m_Config.codeGenType()) {
+    delete m_pSectionMerger;
+    m_pSectionMerger = new SectionMerger();
+    m_pSectionMerger->collect(*m_pModule);
+  }
+
   ObjectBuilder builder(*m_pModule);
+
+  // --symbol-ordering-file moves the sections of the listed symbols in front
+  // of the other sections of the same input section description
+  SectionOrder order, written;
+  if (m_Config.options().hasSymbolOrderingFile()) {
+    if (!getSectionOrder(order))
+      return false;
+  } else if (m_Config.options().callGraphProfileSort() &&
+             LinkerConfig::Object != m_Config.codeGenType()) {
+    // the call graph orders the rest the same way
+    TimeTrace::Scope scope("callGraphSort");
+    if (!getCallGraphOrder(order))
+      return false;
+  }
+  // --data-ordering-file orders the data after the code
+  if (m_Config.options().hasDataOrderingFile() &&
+      !getDataOrder(order, written))
+    return false;
+  if (!order.empty() && !mergeOrderedSections(builder, order))
+    return false;
+
   Module::obj_iterator obj, objEnd = m_pModule->obj_end();
   for (obj = m_pModule->obj_begin(); obj != objEnd; ++obj) {
     LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
     for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      if (m_pSizeReport != NULL && LDFileFormat::Folded == (*sect)->kind())
+        m_pSizeReport->addFolded(**obj, **sect);
+
       switch ((*sect)->kind()) {
         // Some *INPUT sections should not be merged.
         case LDFileFormat::Folded:
@@ -376,6 +769,8 @@ bool ObjectLinker::mergeSections() {
                                                     << (*obj)->name();
               return false;
             }
+            if (m_pSizeReport != NULL)
+              m_pSizeReport->addSection(**obj, **sect, *out_sect);
           }
           break;
         }
@@ -389,21 +784,42 @@ bool ObjectLinker::mergeSections() {
           if (!(*sect)->hasSectionData())
             continue;  // skip
 
-          LDSection* out_sect = NULL;
-          if ((out_sect = builder.MergeSection(**obj, **sect)) != NULL) {
-            if (!m_LDBackend.updateSectionFlags(*out_sect, **sect)) {
-              error(diag::err_cannot_merge_section) << (*sect)->name()
-                                                    << (*obj)->name();
-              return false;
-            }
-          }
+          // merged ahead of the others, or after them
+          if ((!order.empty() && order.count(*sect) != 0) ||
+              (!written.empty() && written.count(*sect) != 0))
+            continue;
+
+          if (!mergeSection(builder, **obj, **sect))
+            return false;
           break;
         }
       }  // end of switch
     }    // for each section
   }      // for each obj
 
+  // --separate-written-data moves the written data behind the read-mostly
+  // data, onto pages of its own
+  if (!written.empty() &&
+      !mergeOrderedSections(builder, written, m_LDBackend.commonPageSize()))
+    return false;
+
+  if (m_pSectionMerger != NULL) {
+    ThreadPool pool(m_Config.options().numThreads());
+    m_pSectionMerger->merge(*m_pModule, pool);
+  }
+
+  // The input section descriptions are laid out in their output sections.
+  // Plan the alignments, the flags and the final section of every output
+  // section description first. Then the fragments are moved into the final
+  // sections, one output section per task, and each final section is laid
+  // out once.
   {
+    struct OutputMove {
+      LDSection* out_sect;
+      LDSection* target;
+      std::vector<SectionData*> from;
+    };
+    std::vector<OutputMove> moves;
     SectionMap::iterator out, outBegin, outEnd;
     outBegin = m_pModule->getScript().sectionMap().begin();
     outEnd = m_pModule->getScript().sectionMap().end();
@@ -413,25 +829,46 @@ bool ObjectLinker::mergeSections() {
       inBegin = (*out)->begin();
       inEnd = (*out)->end();
 
+      std::vector<SectionData*> from;
+      uint64_t size = 0x0;
       for (in = inBegin; in != inEnd; ++in) {
         LDSection* in_sect = (*in)->getSection();
-        if (builder.MoveSectionData(*in_sect->getSectionData(),
-                                    *out_sect->getSectionData())) {
-          builder.UpdateSectionAlign(*out_sect, *in_sect);
-          m_LDBackend.updateSectionFlags(*out_sect, *in_sect);
-        }
+        builder.UpdateSectionAlign(*out_sect, *in_sect);
+        m_LDBackend.updateSectionFlags(*out_sect, *in_sect);
+        from.push_back(in_sect->getSectionData());
+        size += in_sect->size();
       }  // for each input section description
 
-      if ((*out)->hasContent()) {
-        LDSection* target = m_pModule->getSection((*out)->name());
-        assert(target != NULL && target->hasSectionData());
-        if (builder.MoveSectionData(*out_sect->getSectionData(),
-                                    *target->getSectionData())) {
-          builder.UpdateSectionAlign(*target, *out_sect);
-          m_LDBackend.updateSectionFlags(*target, *out_sect);
-        }
+      // an output section description without content keeps its fragments
+      if (size == 0x0) {
+        for (size_t i = 0; i < from.size(); ++i)
+          builder.MoveSectionData(*from[i], *out_sect->getSectionData());
+        continue;
       }
+
+      LDSection* target = m_pModule->getSection((*out)->name());
+      assert(target != NULL && target->hasSectionData());
+      builder.UpdateSectionAlign(*target, *out_sect);
+      m_LDBackend.updateSectionFlags(*target, *out_sect);
+      moves.push_back(OutputMove());
+      moves.back().out_sect = out_sect;
+      moves.back().target = target;
+      moves.back().from.swap(from);
     }  // for each output section description
+
+    // the output section descriptions have different names, so each task
+    // has a final section of its own
+    ThreadPool pool(m_Config.options().numThreads());
+    parallelFor(pool, 0, moves.size(), [&moves](size_t pIndex) {
+      OutputMove& move = moves[pIndex];
+      ObjectBuilder::MoveSectionData(
+          move.from, move.out_sect->align(), *move.target->getSectionData());
+    });
+    for (size_t i = 0; i < moves.size(); ++i) {
+      uint64_t size = moves[i].target->size();
+      moves[i].target->getSectionData()->layout(pool);
+      moves[i].out_sect->setSize(moves[i].target->size() - size);
+    }
   }
 
   // run the target-dependent hooks after merging sections
@@ -440,11 +877,315 @@ bool ObjectLinker::mergeSections() {
   return true;
 }
 
-void ObjectLinker::addSymbolToOutput(ResolveInfo& pInfo, Module& pModule) {
+/// mergeSection - merge the section pSection of pInput with its output section
+bool ObjectLinker::mergeSection(ObjectBuilder& pBuilder,
+                                Input& pInput,
+                                LDSection& pSection) {
+  if (m_pIncremental != NULL)
+    m_pIncremental->reserve(pInput, pSection);
+  if (m_pMapWriter != NULL)
+    m_pMapWriter->record(pInput, pSection);
+
+  LDSection* out_sect = pBuilder.MergeSection(pInput, pSection);
+  if (out_sect == NULL)
+    return true;
+
+  if (!m_LDBackend.updateSectionFlags(*out_sect, pSection)) {
+    error(diag::err_cannot_merge_section) << pSection.name() << pInput.name();
+    return false;
+  }
+  if (m_pSizeReport != NULL)
+    m_pSizeReport->addSection(pInput, pSection, *out_sect);
+  return true;
+}
+
+/// getDefiningSection - the input section which defines pSymbol, or NULL
+static const LDSection* getDefiningSection(const LDSymbol* pSymbol) {
+  if (pSymbol == NULL)
+    return NULL;
+
+  // a global symbol is defined by its output symbol, which also follows the
+  // folded sections to the section kept
+  const ResolveInfo* info = pSymbol->resolveInfo();
+  if (info != NULL) {
+    if (!info->isDefine() || info->outSymbol() == NULL)
+      return NULL;
+    pSymbol = info->outSymbol();
+  }
+  if (!pSymbol->hasFragRef())
+    return NULL;
+  return &pSymbol->fragRef()->frag()->getParent()->getSection();
+}
+
+/// kCallGraphProfile - the section type of .llvm.call-graph-profile
+static const uint32_t kCallGraphProfile = 0x6fff4c02;
+
+/// readCallGraphProfile - add the edges of the .llvm.call-graph-profile
+/// sections of pInput to pGraph. An entry of the early format names the
+/// caller and the callee by their symbol indices. The current format only
+/// has the weight, and a pair of relocations per entry names the symbols.
+static void readCallGraphProfile(const LinkerConfig& pConfig,
+                                 Input& pInput,
+                                 CallGraphSort& pGraph) {
+  bool little = pConfig.targets().isLittleEndian();
+  LDContext::sect_iterator sect, sectEnd = pInput.context()->sectEnd();
+  for (sect = pInput.context()->sectBegin(); sect != sectEnd; ++sect) {
+    if (kCallGraphProfile != (*sect)->type())
+      continue;
+
+    // the symbol indices of the callers and the callees, in pairs
+    std::vector<uint32_t> symbols;
+    size_t entsize = (*sect)->entSize() == 8 ? 8 : 16;
+    LDContext::sect_iterator rs, rsEnd = pInput.context()->relocSectEnd();
+    for (rs = pInput.context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (entsize != 8 || (*rs)->getLink() != *sect)
+        continue;
+      bool rela = llvm::ELF::SHT_RELA == (*rs)->type();
+      size_t size = pConfig.targets().is64Bits() ? (rela ? 24 : 16)
+                                                 : (rela ? 12 : 8);
+      llvm::StringRef region = pInput.memArea()->request(
+          pInput.fileOffset() + (*rs)->offset(), (*rs)->size());
+      for (size_t offset = 0; offset + size <= region.size(); offset += size) {
+        // r_info follows r_offset, and the symbol is in its upper bits
+        const char* info = region.data() + offset + size / (rela ? 3 : 2);
+        if (pConfig.targets().is64Bits())
+          symbols.push_back(
+              (little ? llvm::support::endian::read64le(info)
+                      : llvm::support::endian::read64be(info)) >> 32);
+        else
+          symbols.push_back(
+              (little ? llvm::support::endian::read32le(info)
+                      : llvm::support::endian::read32be(info)) >> 8);
+      }
+    }
+
+    llvm::StringRef region = pInput.memArea()->request(
+        pInput.fileOffset() + (*sect)->offset(), (*sect)->size());
+    for (size_t i = 0; (i + 1) * entsize <= region.size(); ++i) {
+      const char* entry = region.data() + i * entsize;
+      uint32_t from, to;
+      if (entsize == 16) {
+        from = little ? llvm::support::endian::read32le(entry)
+                      : llvm::support::endian::read32be(entry);
+        to = little ? llvm::support::endian::read32le(entry + 4)
+                    : llvm::support::endian::read32be(entry + 4);
+        entry += 8;
+      } else if (2 * i + 1 < symbols.size()) {
+        from = symbols[2 * i];
+        to = symbols[2 * i + 1];
+      } else {
+        break;
+      }
+      uint64_t weight = little ? llvm::support::endian::read64le(entry)
+                               : llvm::support::endian::read64be(entry);
+
+      const LDSection* from_sect =
+          getDefiningSection(pInput.context()->getSymbol(from));
+      const LDSection* to_sect =
+          getDefiningSection(pInput.context()->getSymbol(to));
+      if (from_sect != NULL && to_sect != NULL &&
+          LDFileFormat::TEXT == from_sect->kind() &&
+          LDFileFormat::TEXT == to_sect->kind())
+        pGraph.addEdge(*from_sect, *to_sect, weight);
+    }
+  }
+}
+
+/// getSectionOrder - the priorities of the sections which define the symbols
+/// listed in the --symbol-ordering-file, one per line. The symbols are looked
+/// up in the name pool, so only the global symbols can be ordered.
+bool ObjectLinker::getSectionOrder(SectionOrder& pOrder) {
+  const std::string& path = m_Config.options().getSymbolOrderingFile();
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer> > buffer =
+      llvm::MemoryBuffer::getFile(path);
+  if (!buffer) {
+    error(diag::err_cannot_read_symbol_ordering_file)
+        << path << buffer.getError().message();
+    return false;
+  }
+
+  NamePool& names = m_pModule->getNamePool();
+  unsigned priority = 0;
+  llvm::StringRef content = (*buffer)->getBuffer();
+  while (!content.empty()) {
+    std::pair<llvm::StringRef, llvm::StringRef> line = content.split('\n');
+    content = line.second;
+    llvm::StringRef name = line.first.trim();
+    if (name.empty() || name.startswith("#"))
+      continue;
+
+    ResolveInfo* info = names.findInfo(name);
+    const LDSection* section =
+        info == NULL ? NULL : getDefiningSection(info->outSymbol());
+    if (section == NULL) {
+      warning(diag::warn_symbol_ordering_no_symbol) << name;
+      continue;
+    }
+
+    // a section keeps the priority of its first symbol in the file
+    switch (section->kind()) {
+      case LDFileFormat::TEXT:
+      case LDFileFormat::DATA:
+      case LDFileFormat::BSS:
+        pOrder.insert(std::make_pair(section, priority++));
+        break;
+      default:
+        break;
+    }
+  }
+  return true;
+}
+
+/// getCallGraphOrder - the priorities of the code sections by the call graph
+/// of the --call-graph-ordering-file, a "caller callee weight" per line. The
+/// .llvm.call-graph-profile sections of the inputs are read without it.
+bool ObjectLinker::getCallGraphOrder(SectionOrder& pOrder) {
+  CallGraphSort graph;
+  const std::string& path = m_Config.options().getCallGraphOrderingFile();
+  if (path.empty()) {
+    Module::obj_iterator obj, objEnd = m_pModule->obj_end();
+    for (obj = m_pModule->obj_begin(); obj != objEnd; ++obj) {
+      if ((*obj)->hasMemArea())
+        readCallGraphProfile(m_Config, **obj, graph);
+    }
+  } else {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer> > buffer =
+        llvm::MemoryBuffer::getFile(path);
+    if (!buffer) {
+      error(diag::err_cannot_read_call_graph_ordering_file)
+          << path << buffer.getError().message();
+      return false;
+    }
+
+    NamePool& names = m_pModule->getNamePool();
+    llvm::StringRef content = (*buffer)->getBuffer();
+    while (!content.empty()) {
+      std::pair<llvm::StringRef, llvm::StringRef> line = content.split('\n');
+      content = line.second;
+      llvm::SmallVector<llvm::StringRef, 3> fields;
+      line.first.split(fields, " ", -1, false);
+      uint64_t weight;
+      if (fields.empty() || fields[0].startswith("#"))
+        continue;
+      if (fields.size() != 3 || fields[2].trim().getAsInteger(10, weight)) {
+        warning(diag::warn_malformed_call_graph_edge) << line.first;
+        continue;
+      }
+
+      const ResolveInfo* caller = names.findInfo(fields[0]);
+      const ResolveInfo* callee = names.findInfo(fields[1]);
+      const LDSection* from =
+          caller == NULL ? NULL : getDefiningSection(caller->outSymbol());
+      const LDSection* to =
+          callee == NULL ? NULL : getDefiningSection(callee->outSymbol());
+      if (from != NULL && to != NULL && LDFileFormat::TEXT == from->kind() &&
+          LDFileFormat::TEXT == to->kind())
+        graph.addEdge(*from, *to, weight);
+    }
+  }
+
+  std::vector<const LDSection*> order;
+  graph.sort(order);
+  for (size_t i = 0; i < order.size(); ++i)
+    pOrder.insert(std::make_pair(order[i], i));
+  return true;
+}
+
+/// getDataOrder - the priorities of the data sections which define the
+/// symbols listed in the --data-ordering-file, one per line, after the
+/// priorities already in pOrder. A symbol followed by "written" is written
+/// often, and goes to pWritten instead with --separate-written-data.
+bool ObjectLinker::getDataOrder(SectionOrder& pOrder, SectionOrder& pWritten) {
+  const std::string& path = m_Config.options().getDataOrderingFile();
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer> > buffer =
+      llvm::MemoryBuffer::getFile(path);
+  if (!buffer) {
+    error(diag::err_cannot_read_data_ordering_file)
+        << path << buffer.getError().message();
+    return false;
+  }
+
+  unsigned priority = 0;
+  SectionOrder::const_iterator entry, entryEnd = pOrder.end();
+  for (entry = pOrder.begin(); entry != entryEnd; ++entry)
+    priority = std::max(priority, entry->second + 1);
+
+  NamePool& names = m_pModule->getNamePool();
+  llvm::StringRef content = (*buffer)->getBuffer();
+  while (!content.empty()) {
+    std::pair<llvm::StringRef, llvm::StringRef> line = content.split('\n');
+    content = line.second;
+    llvm::SmallVector<llvm::StringRef, 2> fields;
+    line.first.split(fields, " ", -1, false);
+    if (fields.empty() || fields[0].trim().empty() ||
+        fields[0].startswith("#"))
+      continue;
+
+    llvm::StringRef name = fields[0].trim();
+    ResolveInfo* info = names.findInfo(name);
+    const LDSection* section =
+        info == NULL ? NULL : getDefiningSection(info->outSymbol());
+    if (section == NULL) {
+      warning(diag::warn_data_ordering_no_symbol) << name;
+      continue;
+    }
+    if (LDFileFormat::DATA != section->kind() &&
+        LDFileFormat::BSS != section->kind())
+      continue;
+
+    // a section keeps the priority of its first symbol in the file
+    bool is_written = fields.size() > 1 && fields[1].trim() == "written";
+    if (is_written && m_Config.options().separateWrittenData()) {
+      if (pOrder.count(section) == 0)
+        pWritten.insert(std::make_pair(section, priority++));
+    } else if (pWritten.count(section) == 0) {
+      pOrder.insert(std::make_pair(section, priority++));
+    }
+  }
+  return true;
+}
+
+/// mergeOrderedSections - merge the sections of pOrder by their priorities
+bool ObjectLinker::mergeOrderedSections(ObjectBuilder& pBuilder,
+                                        const SectionOrder& pOrder,
+                                        uint64_t pPageSize) {
+  typedef std::pair<unsigned, std::pair<Input*, LDSection*> > OrderedSection;
+  std::vector<OrderedSection> sections;
+  Module::obj_iterator obj, objEnd = m_pModule->obj_end();
+  for (obj = m_pModule->obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
+    for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      SectionOrder::const_iterator entry = pOrder.find(*sect);
+      if (entry != pOrder.end() && (*sect)->hasSectionData())
+        sections.push_back(
+            std::make_pair(entry->second, std::make_pair(*obj, *sect)));
+    }
+  }
+
+  // the priorities are unique
+  std::sort(sections.begin(), sections.end());
+  std::set<const SectionMap::Input*> started;
+  std::vector<OrderedSection>::iterator it, end = sections.end();
+  for (it = sections.begin(); it != end; ++it) {
+    Input& input = *it->second.first;
+    LDSection& section = *it->second.second;
+    if (pPageSize != 0) {
+      SectionMap::mapping pair = m_pModule->getScript().sectionMap().find(
+          input.path().native(), section.name());
+      if (pair.second != NULL && started.insert(pair.second).second)
+        section.setAlign(std::max<uint64_t>(section.align(), pPageSize));
+    }
+    if (!mergeSection(pBuilder, input, section))
+      return false;
+  }
+  return true;
+}
+
+bool ObjectLinker::isOutputSymbol(const ResolveInfo& pInfo) const {
   // section symbols will be defined by linker later, we should not add section
   // symbols to output here
   if (ResolveInfo::Section == pInfo.type() || pInfo.outSymbol() == NULL)
-    return;
+    return false;
 
   // if the symbols defined in the Ignore sections (e.g. discared by GC), then
   // not to put them to output
@@ -453,43 +1194,54 @@ void ObjectLinker::addSymbolToOutput(ResolveInfo& pInfo, Module& pModule) {
   // will refer to input LDSection and has bad result when emitting their
   // section index. However, .debug_str actually does not need symobl in
   // shrad/executable objects, so it's fine to do so.
-  if (pInfo.outSymbol()->hasFragRef() &&
-      (LDFileFormat::Ignore ==
-           pInfo.outSymbol()
-               ->fragRef()
-               ->frag()
-               ->getParent()
-               ->getSection()
-               .kind() ||
-       LDFileFormat::DebugString ==
-           pInfo.outSymbol()
-               ->fragRef()
-               ->frag()
-               ->getParent()
-               ->getSection()
-               .kind()))
-    return;
-
-  if (pInfo.shouldForceLocal(m_Config))
-    pModule.getSymbolTable().forceLocal(*pInfo.outSymbol());
-  else
-    pModule.getSymbolTable().add(*pInfo.outSymbol());
+  if (pInfo.outSymbol()->hasFragRef()) {
+    LDFileFormat::Kind kind =
+        pInfo.outSymbol()->fragRef()->frag()->getParent()->getSection().kind();
+    if (LDFileFormat::Ignore == kind || LDFileFormat::DebugString == kind)
+      return false;
+  }
+  return true;
 }
 
 void ObjectLinker::addSymbolsToOutput(Module& pModule) {
-  // Traverse all the free ResolveInfo and add the output symobols to output
-  NamePool::freeinfo_iterator free_it,
-      free_end = pModule.getNamePool().freeinfo_end();
-  for (free_it = pModule.getNamePool().freeinfo_begin(); free_it != free_end;
-       ++free_it)
-    addSymbolToOutput(**free_it, pModule);
-
-  // Traverse all the resolveInfo and add the output symbol to output
-  NamePool::syminfo_iterator info_it,
-      info_end = pModule.getNamePool().syminfo_end();
-  for (info_it = pModule.getNamePool().syminfo_begin(); info_it != info_end;
-       ++info_it)
-    addSymbolToOutput(*info_it.getEntry(), pModule);
+  // Collect the free ResolveInfo first and then the resolveInfo of the pool,
+  // which is the order the output symbols are added in.
+  NamePool& name_pool = pModule.getNamePool();
+  std::vector<ResolveInfo*> infos;
+  NamePool::freeinfo_iterator free_it, free_end = name_pool.freeinfo_end();
+  for (free_it = name_pool.freeinfo_begin(); free_it != free_end; ++free_it)
+    infos.push_back(*free_it);
+
+  NamePool::syminfo_iterator info_it, info_end = name_pool.syminfo_end();
+  for (info_it = name_pool.syminfo_begin(); info_it != info_end; ++info_it)
+    infos.push_back(info_it.getEntry());
+
+  // Check the symbols on the threads. Each thread only writes its own slots.
+  enum { Skip, Add, ForceLocal };
+  std::vector<unsigned char> actions(infos.size());
+  ThreadPool pool(m_Config.options().numThreads());
+  parallelFor(pool, 0, infos.size(), [&](size_t pIndex) {
+    ResolveInfo& info = *infos[pIndex];
+    if (!isOutputSymbol(info))
+      actions[pIndex] = Skip;
+    else if (info.shouldForceLocal(m_Config))
+      actions[pIndex] = ForceLocal;
+    else
+      actions[pIndex] = Add;
+  });
+
+  // Place all the output symbols into their categories at once
+  std::vector<LDSymbol*> symbols;
+  std::vector<bool> force_local;
+  symbols.reserve(infos.size());
+  force_local.reserve(infos.size());
+  for (size_t i = 0; i < infos.size(); ++i) {
+    if (actions[i] == Skip)
+      continue;
+    symbols.push_back(infos[i]->outSymbol());
+    force_local.push_back(actions[i] == ForceLocal);
+  }
+  pModule.getSymbolTable().add(symbols, force_local);
 }
 
 /// addStandardSymbols - shared object and executable files need some
@@ -579,12 +1331,19 @@ bool ObjectLinker::addScriptSymbols() {
 }
 
 bool ObjectLinker::scanRelocations() {
-  // apply all relocations of all inputs
-  Module::obj_iterator input, inEnd = m_pModule->obj_end();
-  for (input = m_pModule->obj_begin(); input != inEnd; ++input) {
-    m_LDBackend.getRelocator()->initializeScan(**input);
-    LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
-    for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+  Relocator& relocator = *m_LDBackend.getRelocator();
+  bool partial = (LinkerConfig::Object == m_Config.codeGenType());
+
+  // Find the relocations to scan. This only reads the relocations, so the
+  // inputs are checked in parallel.
+  typedef std::vector<std::pair<Relocation*, LDSection*> > ScanList;
+  Module::ObjectList& inputs = m_pModule->getObjectList();
+  std::vector<ScanList> scans(inputs.size());
+  ThreadPool pool(m_Config.options().numThreads());
+  parallelFor(pool, 0, inputs.size(), [&](size_t pIndex) {
+    LDContext* context = inputs[pIndex]->context();
+    LDContext::sect_iterator rs, rsEnd = context->relocSectEnd();
+    for (rs = context->relocSectBegin(); rs != rsEnd; ++rs) {
       // bypass the reloc section if
       // 1. its section kind is changed to Ignore. (The target section is a
       // discarded group section.)
@@ -603,18 +1362,39 @@ bool ObjectLinker::scanRelocations() {
             ResolveInfo::Undefined == info->desc())
           continue;
 
-        // scan relocation
-        if (LinkerConfig::Object != m_Config.codeGenType()) {
-          m_LDBackend.getRelocator()->scanRelocation(
-              *relocation, *m_pBuilder, *m_pModule, **rs, **input);
-        } else {
-          m_LDBackend.getRelocator()->partialScanRelocation(
-              *relocation, *m_pModule);
-        }
+        if (partial || relocator.mayNeedScan(*relocation, **rs))
+          scans[pIndex].push_back(std::make_pair(relocation, *rs));
       }  // for all relocations
     }    // for all relocation section
-    m_LDBackend.getRelocator()->finalizeScan(**input);
+  });
+
+  // Scanning creates GOT, PLT and dynamic relocation entries. Scan in input
+  // order, so that the entries are laid out the same way for any number of
+  // threads.
+  std::map<Relocation::Type, uint64_t> scanned;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    InputCostReport::Scope cost(*inputs[i], InputCostReport::Scan);
+    relocator.initializeScan(*inputs[i]);
+    ScanList::iterator scan, scanEnd = scans[i].end();
+    for (scan = scans[i].begin(); scan != scanEnd; ++scan) {
+      if (MCLD_ENABLE_STATS)
+        ++scanned[scan->first->type()];
+      if (!partial) {
+        relocator.scanRelocation(
+            *scan->first, *m_pBuilder, *m_pModule, *scan->second, *inputs[i]);
+      } else {
+        relocator.partialScanRelocation(*scan->first, *m_pModule);
+      }
+    }
+    relocator.finalizeScan(*inputs[i]);
   }  // for all inputs
+
+  std::map<Relocation::Type, uint64_t>::const_iterator type, tEnd;
+  for (type = scanned.begin(), tEnd = scanned.end(); type != tEnd; ++type) {
+    Statistic::Add(std::string("relocator.scan.") +
+                       relocator.getName(type->first),
+                   type->second);
+  }
   return true;
 }
 
@@ -684,8 +1464,10 @@ bool ObjectLinker::prelayout() {
   // FIXME: disable debug string merge when doing partial link.
   if (LinkerConfig::Object != m_Config.codeGenType()) {
     LDSection* debug_str_sect = m_pModule->getSection(".debug_str");
-    if (debug_str_sect && debug_str_sect->hasDebugString())
-      debug_str_sect->getDebugString()->computeOffsetSize();
+    if (debug_str_sect && debug_str_sect->hasDebugString()) {
+      ThreadPool pool(m_Config.options().numThreads());
+      debug_str_sect->getDebugString()->computeOffsetSize(pool);
+    }
   }
   return true;
 }
@@ -771,6 +1553,153 @@ bool ObjectLinker::finalizeSymbolValue() {
   return finalized && scriptSymsFinalized && assertionsPassed;
 }
 
+/// applySectionRelocations - apply the relocations of pRelocSect. The
+/// relocations that fail are recorded in pFailures. pRelocs is the space for
+/// the batch.
+static void applySectionRelocations(LDSection& pRelocSect,
+                                    TargetLDBackend& pBackend,
+                                    LDSection* pDebugStrSect,
+                                    Relocator::RelocList& pRelocs,
+                                    std::vector<ApplyFailure>& pFailures) {
+  Relocator& relocator = *pBackend.getRelocator();
+  // only the merged .debug_str redirects the relocations against it
+  bool merged_debug_str =
+      (pDebugStrSect != NULL && pDebugStrSect->hasDebugString());
+  pRelocs.clear();
+  RelocData::iterator reloc, rEnd = pRelocSect.getRelocData()->end();
+  for (reloc = pRelocSect.getRelocData()->begin(); reloc != rEnd; ++reloc) {
+    Relocation* relocation = llvm::cast<Relocation>(reloc);
+
+    // bypass the reloc if the symbol is in the discarded input section
+    ResolveInfo* info = relocation->symInfo();
+    if (!info->outSymbol()->hasFragRef() &&
+        ResolveInfo::Section == info->type() &&
+        ResolveInfo::Undefined == info->desc())
+      continue;
+
+    // apply the relocation aginst symbol on DebugString
+    if (merged_debug_str && info->outSymbol()->hasFragRef() &&
+        info->outSymbol()->fragRef()->frag()->getKind()
+            == Fragment::Region &&
+        info->outSymbol()->fragRef()->frag()->getParent()->getSection()
+            .kind() == LDFileFormat::DebugString) {
+      pDebugStrSect->getDebugString()->applyOffset(*relocation, pBackend);
+      continue;
+    }
+
+    pRelocs.push_back(relocation);
+  }  // for all relocations
+
+  // apply the relocations of the section in one batch. Those of a debug
+  // section never need PLT or dynamic relocations.
+  size_t num_failures = pFailures.size();
+  const LDSection* target = pRelocSect.getLink();
+  if ((LDFileFormat::Debug == target->kind() ||
+       LDFileFormat::DebugString == target->kind()) &&
+      (target->flag() & llvm::ELF::SHF_ALLOC) == 0)
+    relocator.applyDebugRelocations(pRelocs, pFailures);
+  else
+    relocator.applyRelocations(pRelocs, pFailures);
+  NumApply += pRelocs.size();
+  for (size_t i = num_failures; i < pFailures.size(); ++i) {
+    if (pFailures[i].second == Relocator::Overflow)
+      ++NumOverflow;
+  }
+}
+
+/// sortInputRelocations - stable sort the relocations of every section of
+/// pInput by the output offsets of their targets, so that applying and
+/// syncing them walk the output pages in order
+static void sortInputRelocations(Input& pInput) {
+  LDContext::sect_iterator rs, rsEnd = pInput.context()->relocSectEnd();
+  for (rs = pInput.context()->relocSectBegin(); rs != rsEnd; ++rs) {
+    if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+      continue;
+    (*rs)->getRelocData()->sortByKey([](Relocation& pReloc) {
+      const FragmentRef& target = pReloc.targetRef();
+      return (target.frag() == NULL) ? FragmentRef::Offset(0)
+                                     : target.getOutputOffset();
+    });
+  }
+}
+
+/// applyInputRelocations - apply all relocations of an input, except those of
+/// the sections in pReused. The relocations that fail are recorded in
+/// pFailures instead of being reported, so that the diagnostics keep the
+/// input order even if inputs are applied in parallel.
+static void applyInputRelocations(
+    Input& pInput,
+    TargetLDBackend& pBackend,
+    LDSection* pDebugStrSect,
+    const llvm::DenseSet<const LDSection*>& pReused,
+    std::vector<ApplyFailure>& pFailures) {
+  Relocator& relocator = *pBackend.getRelocator();
+  relocator.initializeApply(pInput);
+  Relocator::RelocList relocs;
+  LDContext::sect_iterator rs, rsEnd = pInput.context()->relocSectEnd();
+  for (rs = pInput.context()->relocSectBegin(); rs != rsEnd; ++rs) {
+    // bypass the reloc section if
+    // 1. its section kind is changed to Ignore. (The target section is a
+    // discarded group section.)
+    // 2. it has no reloc data. (All symbols in the input relocs are in the
+    // discarded group sections)
+    // 3. its results are reused from the old output of --incremental
+    if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData() ||
+        pReused.count(*rs) != 0)
+      continue;
+    applySectionRelocations(**rs, pBackend, pDebugStrSect, relocs, pFailures);
+  }    // for all relocation section
+  relocator.finalizeApply(pInput);
+}
+
+/// getReusableTarget - the fragment of the debug section that pRelocSect
+/// applies to, if its relocated bytes only depend on its input, on the
+/// values of the symbols and on where it is placed
+static const Fragment* getReusableTarget(const LDSection& pRelocSect) {
+  const LDSection* target = pRelocSect.getLink();
+  if (LDFileFormat::Ignore == pRelocSect.kind() ||
+      !pRelocSect.hasRelocData() || pRelocSect.getRelocData()->empty() ||
+      target == NULL || LDFileFormat::Debug != target->kind() ||
+      (target->flag() & (llvm::ELF::SHF_ALLOC | ELF::SHF_COMPRESSED)) != 0)
+    return NULL;
+
+  // the section is one region, and every relocation applies to it
+  const Fragment* frag = llvm::cast<Relocation>(
+      pRelocSect.getRelocData()->front()).targetRef().frag();
+  if (frag == NULL || !llvm::isa<RegionFragment>(frag) ||
+      frag->size() != target->size())
+    return NULL;
+  return frag;
+}
+
+/// appendKey - append the bytes of pValue to the key pKey
+static void appendKey(std::string& pKey, uint64_t pValue) {
+  pKey.append(reinterpret_cast<const char*>(&pValue), sizeof(pValue));
+}
+
+/// getSymbolKey - the values of the symbols of pInput, in the order of its
+/// symbol table, as the relocations see them
+static std::string getSymbolKey(const Input& pInput) {
+  std::string key;
+  LDContext::const_sym_iterator sym, symEnd = pInput.context()->symTabEnd();
+  for (sym = pInput.context()->symTabBegin(); sym != symEnd; ++sym) {
+    uint64_t value = 0;
+    const ResolveInfo* info = (*sym != NULL) ? (*sym)->resolveInfo() : NULL;
+    const LDSymbol* out = (info != NULL) ? info->outSymbol() : NULL;
+    if (out != NULL) {
+      if (ResolveInfo::Section == info->type() && out->hasFragRef()) {
+        const FragmentRef* ref = out->fragRef();
+        value = ref->frag()->getParent()->getSection().addr() +
+                ref->getOutputOffset();
+      } else {
+        value = out->value();
+      }
+    }
+    appendKey(key, value);
+  }
+  return key;
+}
+
 /// relocate - applying relocation entries and create relocation
 /// section in the output files
 /// Create relocation section, asking TargetLDBackend to
@@ -782,49 +1711,42 @@ bool ObjectLinker::relocation() {
     return true;
 
   LDSection* debug_str_sect = m_pModule->getSection(".debug_str");
+  Relocator& relocator = *m_LDBackend.getRelocator();
+  Module::ObjectList& inputs = m_pModule->getObjectList();
+
+  // --sort-relocations
+  if (m_Config.options().sortRelocations() &&
+      relocator.mayReorderRelocations()) {
+    ThreadPool sort_pool(m_Config.options().numThreads());
+    parallelFor(sort_pool, 0, inputs.size(), [&inputs](size_t pIndex) {
+      sortInputRelocations(*inputs[pIndex]);
+    });
+  }
 
-  // apply all relocations of all inputs
-  Module::obj_iterator input, inEnd = m_pModule->obj_end();
-  for (input = m_pModule->obj_begin(); input != inEnd; ++input) {
-    m_LDBackend.getRelocator()->initializeApply(**input);
-    LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
-    for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
-      // bypass the reloc section if
-      // 1. its section kind is changed to Ignore. (The target section is a
-      // discarded group section.)
-      // 2. it has no reloc data. (All symbols in the input relocs are in the
-      // discarded group sections)
-      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
-        continue;
-      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
-      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
-        Relocation* relocation = llvm::cast<Relocation>(reloc);
-
-        // bypass the reloc if the symbol is in the discarded input section
-        ResolveInfo* info = relocation->symInfo();
-        if (!info->outSymbol()->hasFragRef() &&
-            ResolveInfo::Section == info->type() &&
-            ResolveInfo::Undefined == info->desc())
-          continue;
-
-        // apply the relocation aginst symbol on DebugString
-        if (info->outSymbol()->hasFragRef() &&
-            info->outSymbol()->fragRef()->frag()->getKind()
-                == Fragment::Region &&
-            info->outSymbol()->fragRef()->frag()->getParent()->getSection()
-                .kind() == LDFileFormat::DebugString) {
-          assert(debug_str_sect != NULL);
-          assert(debug_str_sect->hasDebugString());
-          debug_str_sect->getDebugString()->applyOffset(*relocation,
-                                                        m_LDBackend);
-          continue;
-        }
-
-        relocation->apply(*m_LDBackend.getRelocator());
-      }  // for all relocations
-    }    // for all relocation section
-    m_LDBackend.getRelocator()->finalizeApply(**input);
-  }  // for all inputs
+  // --incremental keeps the debug sections that would be relocated to the
+  // same bytes as in the old output
+  if (m_pIncremental != NULL)
+    reuseRelocatedSections();
+
+  relocator.prepareApply(*m_pModule);
+
+  // apply all relocations of all inputs. Inputs are independent of each
+  // other, so they are applied in parallel if the target allows.
+  std::vector<std::vector<ApplyFailure> > failures(inputs.size());
+  ThreadPool pool(relocator.mayApplyInParallel() ?
+                  m_Config.options().numThreads() : 1);
+  parallelFor(pool, 0, inputs.size(), [&](size_t pIndex) {
+    InputCostReport::Scope cost(*inputs[pIndex], InputCostReport::Apply);
+    applyInputRelocations(*inputs[pIndex], m_LDBackend, debug_str_sect,
+                          m_ReusedRelocs, failures[pIndex]);
+  });
+
+  // report the failed relocations in input order
+  for (size_t i = 0; i < failures.size(); ++i) {
+    std::vector<ApplyFailure>::iterator it, itEnd = failures[i].end();
+    for (it = failures[i].begin(); it != itEnd; ++it)
+      relocator.issueApplyResult(it->second, *it->first);
+  }
 
   // apply relocations created by relaxation
   BranchIslandFactory* br_factory = m_LDBackend.getBRIslandFactory();
@@ -843,11 +1765,272 @@ bool ObjectLinker::relocation() {
     iter->apply(*m_LDBackend.getRelocator());
   }
 
+  // the sets of .gdb_index refer to their units by relocated offsets
+  GdbIndex* gdb_index = m_LDBackend.getGdbIndex();
+  if (gdb_index != NULL) {
+    ThreadPool index_pool(m_Config.options().numThreads());
+    std::vector<std::vector<uint8_t> > contents;
+    emitRelocatedContents(gdb_index->getRelocatedSections(), contents,
+                          index_pool);
+    gdb_index->resolve(contents);
+  }
+
+  return true;
+}
+
+void ObjectLinker::reuseRelocatedSections() {
+  // the relocated contents of the compressed sections and of .gdb_index are
+  // read before the output is written
+  if (m_Config.options().hasCompressDebugSections() ||
+      m_LDBackend.getGdbIndex() != NULL)
+    return;
+
+  // the results may also depend on the addresses of the allocated sections,
+  // such as that of the TLS segment, and on the merged strings and constants
+  std::string link_key;
+  Module::iterator sect, sectEnd = m_pModule->end();
+  for (sect = m_pModule->begin(); sect != sectEnd; ++sect) {
+    if (((*sect)->flag() & llvm::ELF::SHF_ALLOC) == 0)
+      continue;
+    appendKey(link_key, (*sect)->addr());
+    appendKey(link_key, (*sect)->size());
+  }
+  if (m_pSectionMerger != NULL)
+    appendKey(link_key, m_pSectionMerger->hashContents());
+  uint64_t link_hash = llvm::xxHash64(link_key);
+
+  // key each debug section by its bytes, its relocations, the symbols of its
+  // input and its place in the output
+  Module::ObjectList& inputs = m_pModule->getObjectList();
+  std::vector<std::vector<ReusedSection> > candidates(inputs.size());
+  std::vector<std::vector<uint64_t> > keys(inputs.size());
+  ThreadPool pool(m_Config.options().numThreads());
+  parallelFor(pool, 0, inputs.size(), [&](size_t pIndex) {
+    Input& input = *inputs[pIndex];
+    std::string symbol_key;
+    LDContext::sect_iterator rs, rsEnd = input.context()->relocSectEnd();
+    for (rs = input.context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      const Fragment* frag = getReusableTarget(**rs);
+      if (frag == NULL)
+        continue;
+      if (symbol_key.empty())
+        symbol_key = getSymbolKey(input);
+
+      std::string key = symbol_key;
+      appendKey(key, link_hash);
+      appendKey(key, llvm::xxHash64(
+                         llvm::cast<RegionFragment>(frag)->getRegion()));
+      appendKey(key, llvm::xxHash64(input.memArea()->request(
+                         input.fileOffset() + (*rs)->offset(), (*rs)->size())));
+      appendKey(key, frag->getParent()->getSection().offset() +
+                         frag->getOffset());
+
+      ReusedSection candidate = {&input, *rs, frag};
+      candidates[pIndex].push_back(candidate);
+      keys[pIndex].push_back(llvm::xxHash64(key));
+    }
+  });
+
+  // the old bytes are only read back if the old output is patched
+  bool patch = m_pIncremental->canPatch(m_pModule->name(),
+                                        getWriter()->getOutputSize(*m_pModule));
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    for (size_t j = 0; j < candidates[i].size(); ++j) {
+      const LDSection& target = *candidates[i][j].reloc->getLink();
+      if (patch &&
+          m_pIncremental->isRelocated(*inputs[i], target, keys[i][j])) {
+        m_ReusedSections.push_back(candidates[i][j]);
+        m_ReusedRelocs.insert(candidates[i][j].reloc);
+      }
+      m_pIncremental->addRelocated(*inputs[i], target, keys[i][j]);
+    }
+  }
+}
+
+void ObjectLinker::restoreRelocatedSections(FileOutputBuffer& pOutput) {
+  // the results against the merged .debug_str depend on all its strings
+  LDSection* debug_str_sect = m_pModule->getSection(".debug_str");
+  uint64_t strings_key = 0;
+  if (debug_str_sect != NULL && debug_str_sect->hasDebugString()) {
+    strings_key = llvm::xxHash64(llvm::StringRef(
+        reinterpret_cast<const char*>(pOutput.getBufferStart() +
+                                      debug_str_sect->offset()),
+        debug_str_sect->size()));
+  }
+  bool same_strings = (strings_key == m_pIncremental->getStringsKey());
+  m_pIncremental->setStringsKey(strings_key);
+  if (m_ReusedSections.empty())
+    return;
+
+  // the old output can still be replaced if it cannot be opened for writing
+  std::vector<uint8_t> restored(m_ReusedSections.size(), 0);
+  ThreadPool pool(m_Config.options().numThreads());
+  parallelFor(pool, 0, m_ReusedSections.size(), [&](size_t pIndex) {
+    const Fragment& frag = *m_ReusedSections[pIndex].fragment;
+    restored[pIndex] =
+        same_strings &&
+        pOutput.restore(frag.getParent()->getSection().offset() +
+                            frag.getOffset(),
+                        frag.size());
+  });
+
+  // apply the relocations of the others now, in the input order
+  Relocator& relocator = *m_LDBackend.getRelocator();
+  Relocator::RelocList relocs;
+  for (size_t i = 0; i < m_ReusedSections.size(); ++i) {
+    if (restored[i]) {
+      ++NumReusedRelocated;
+      continue;
+    }
+    ReusedSection& reused = m_ReusedSections[i];
+    m_ReusedRelocs.erase(reused.reloc);
+    std::vector<ApplyFailure> failures;
+    relocator.initializeApply(*reused.input);
+    applySectionRelocations(*reused.reloc, m_LDBackend, debug_str_sect, relocs,
+                            failures);
+    relocator.finalizeApply(*reused.input);
+    std::vector<ApplyFailure>::iterator it, itEnd = failures.end();
+    for (it = failures.begin(); it != itEnd; ++it)
+      relocator.issueApplyResult(it->second, *it->first);
+  }
+}
+
+/// forEachSyncedRelocation - call pFunc with each relocation of pInput whose
+/// result is written to the output, except those of the sections in pReused
+template <typename Func>
+static void forEachSyncedRelocation(
+    Input& pInput,
+    const llvm::DenseSet<const LDSection*>& pReused,
+    Func pFunc) {
+  LDContext::sect_iterator rs, rsEnd = pInput.context()->relocSectEnd();
+  for (rs = pInput.context()->relocSectBegin(); rs != rsEnd; ++rs) {
+    // bypass the reloc section if
+    // 1. its section kind is changed to Ignore. (The target section is a
+    // discarded group section.)
+    // 2. it has no reloc data. (All symbols in the input relocs are in the
+    // discarded group sections)
+    // 3. its results are reused from the old output of --incremental
+    if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData() ||
+        pReused.count(*rs) != 0)
+      continue;
+    RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+    for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+      Relocation* relocation = llvm::cast<Relocation>(reloc);
+
+      // bypass the reloc if the symbol is in the discarded input section
+      ResolveInfo* info = relocation->symInfo();
+      if (!info->outSymbol()->hasFragRef() &&
+          ResolveInfo::Section == info->type() &&
+          ResolveInfo::Undefined == info->desc())
+        continue;
+
+      // bypass the relocation with NONE type. This is to avoid overwrite the
+      // target result by NONE type relocation if there is a place which has
+      // two relocations to apply to, and one of it is NONE type. The result
+      // we want is the value of the other relocation result. For example,
+      // in .exidx, there are usually an R_ARM_NONE and R_ARM_PREL31 apply to
+      // the same place
+      if (relocation->type() == 0x0)
+        continue;
+      pFunc(*relocation);
+    }  // for all relocations
+  }    // for all relocation section
+}
+
+/// isCompressibleSection - check if pSection is a .debug_* section that has
+/// content
+static bool isCompressibleSection(const LDSection& pSection) {
+  if ((LDFileFormat::Debug != pSection.kind()) &&
+      (LDFileFormat::DebugString != pSection.kind()))
+    return false;
+  if ((pSection.flag() & ELF::SHF_COMPRESSED) != 0)
+    return false;
+  return llvm::StringRef(pSection.name()).startswith(".debug") &&
+         (pSection.size() != 0);
+}
+
+void ObjectLinker::emitRelocatedContents(
+    const std::vector<LDSection*>& pSections,
+    std::vector<std::vector<uint8_t> >& pContents,
+    ThreadPool& pPool) {
+  pContents.resize(pSections.size());
+  parallelFor(pPool, 0, pSections.size(), [&](size_t pIndex) {
+    pContents[pIndex].resize(pSections[pIndex]->size());
+    MemoryRegion region(pContents[pIndex].data(), pContents[pIndex].size());
+    getWriter()->emitSectionContent(*m_pModule, *pSections[pIndex], region);
+  });
+
+  Module::ObjectList& inputs = m_pModule->getObjectList();
+  parallelFor(pPool, 0, inputs.size(), [&](size_t pIndex) {
+    forEachSyncedRelocation(*inputs[pIndex], m_ReusedRelocs,
+                            [&](Relocation& pReloc) {
+      const LDSection* target =
+          &pReloc.targetRef().frag()->getParent()->getSection();
+      std::vector<LDSection*>::const_iterator it =
+          std::find(pSections.begin(), pSections.end(), target);
+      if (it == pSections.end())
+        return;
+      uint8_t* content = pContents[it - pSections.begin()].data();
+      writeRelocationTarget(pReloc,
+                            content + pReloc.targetRef().getOutputOffset());
+    });
+  });
+}
+
+bool ObjectLinker::compressDebugSections() {
+  if (LinkerConfig::Object == m_Config.codeGenType() ||
+      !m_Config.options().hasCompressDebugSections())
+    return true;
+
+  // Only the sections after the last allocated section can be resized, since
+  // the others are already placed in segments.
+  Module::iterator first = m_pModule->end();
+  while ((first - 1) != m_pModule->begin() &&
+         ((*(first - 1))->flag() & llvm::ELF::SHF_ALLOC) == 0)
+    --first;
+
+  std::vector<LDSection*> sections;
+  for (Module::iterator sect = first; sect != m_pModule->end(); ++sect) {
+    if (isCompressibleSection(**sect))
+      sections.push_back(*sect);
+  }
+  if (sections.empty())
+    return true;
+
+  // write the content of the sections and the relocation results into memory
+  ThreadPool pool(m_Config.options().numThreads());
+  std::vector<std::vector<uint8_t> > contents;
+  emitRelocatedContents(sections, contents, pool);
+
+  for (size_t i = 0; i < sections.size(); ++i) {
+    CompressedSection* compressed = new CompressedSection(*sections[i],
+                                                          m_Config);
+    compressed->compress(contents[i], pool);
+    m_CompressedSections.push_back(compressed);
+    std::vector<uint8_t>().swap(contents[i]);
+  }
+
+  // place the sections after the compressed ones again
+  for (Module::iterator sect = first; sect != m_pModule->end(); ++sect) {
+    const LDSection* prev = *(sect - 1);
+    uint64_t offset;
+    if (LDFileFormat::Null == prev->kind())
+      offset = m_LDBackend.sectionStartOffset();
+    else if (LDFileFormat::BSS == prev->kind())
+      offset = prev->offset();
+    else
+      offset = prev->offset() + prev->size();
+    alignAddress(offset, (*sect)->align());
+    (*sect)->setOffset(offset);
+  }
   return true;
 }
 
 /// emitOutput - emit the output file.
 bool ObjectLinker::emitOutput(FileOutputBuffer& pOutput) {
+  // start reading in the input sections that are copied to the output
+  adviseSections(
+      m_pModule->getObjectList(), isEmittedData, MemoryArea::WillNeed);
   return std::error_code() == getWriter()->writeObject(*m_pModule, pOutput);
 }
 
@@ -868,41 +2051,16 @@ bool ObjectLinker::postProcessing(FileOutputBuffer& pOutput) {
 void ObjectLinker::normalSyncRelocationResult(FileOutputBuffer& pOutput) {
   uint8_t* data = pOutput.getBufferStart();
 
-  // sync all relocations of all inputs
-  Module::obj_iterator input, inEnd = m_pModule->obj_end();
-  for (input = m_pModule->obj_begin(); input != inEnd; ++input) {
-    LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
-    for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
-      // bypass the reloc section if
-      // 1. its section kind is changed to Ignore. (The target section is a
-      // discarded group section.)
-      // 2. it has no reloc data. (All symbols in the input relocs are in the
-      // discarded group sections)
-      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
-        continue;
-      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
-      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
-        Relocation* relocation = llvm::cast<Relocation>(reloc);
-
-        // bypass the reloc if the symbol is in the discarded input section
-        ResolveInfo* info = relocation->symInfo();
-        if (!info->outSymbol()->hasFragRef() &&
-            ResolveInfo::Section == info->type() &&
-            ResolveInfo::Undefined == info->desc())
-          continue;
+  if (m_pIncremental != NULL)
+    restoreRelocatedSections(pOutput);
 
-        // bypass the relocation with NONE type. This is to avoid overwrite the
-        // target result by NONE type relocation if there is a place which has
-        // two relocations to apply to, and one of it is NONE type. The result
-        // we want is the value of the other relocation result. For example,
-        // in .exidx, there are usually an R_ARM_NONE and R_ARM_PREL31 apply to
-        // the same place
-        if (relocation->type() == 0x0)
-          continue;
-        writeRelocationResult(*relocation, data);
-      }  // for all relocations
-    }    // for all relocation section
-  }      // for all inputs
+  // sync all relocations of all inputs. The relocations of different inputs
+  // target different fragments, so inputs are written in parallel.
+  Module::ObjectList& inputs = m_pModule->getObjectList();
+  ThreadPool pool(m_Config.options().numThreads());
+  parallelFor(pool, 0, inputs.size(), [this, &inputs, data](size_t pIndex) {
+    syncInputRelocationResult(*inputs[pIndex], data);
+  });
 
   // sync relocations created by relaxation
   BranchIslandFactory* br_factory = m_LDBackend.getBRIslandFactory();
@@ -924,18 +2082,32 @@ void ObjectLinker::normalSyncRelocationResult(FileOutputBuffer& pOutput) {
   }
 }
 
+void ObjectLinker::syncInputRelocationResult(Input& pInput,
+                                             uint8_t* pOutput) {
+  forEachSyncedRelocation(pInput, m_ReusedRelocs,
+                          [this, pOutput](Relocation& pReloc) {
+    writeRelocationResult(pReloc, pOutput);
+  });
+}
+
 void ObjectLinker::partialSyncRelocationResult(FileOutputBuffer& pOutput) {
   uint8_t* data = pOutput.getBufferStart();
 
-  // traverse outputs' LDSection to get RelocData
+  // traverse outputs' LDSection to get RelocData. Each relocation section of
+  // a relocatable output applies to its own output section, so the sections
+  // are written in parallel.
+  std::vector<RelocData*> relocs;
   Module::iterator sectIter, sectEnd = m_pModule->end();
   for (sectIter = m_pModule->begin(); sectIter != sectEnd; ++sectIter) {
-    if (LDFileFormat::Relocation != (*sectIter)->kind())
-      continue;
+    if (LDFileFormat::Relocation == (*sectIter)->kind())
+      relocs.push_back((*sectIter)->getRelocData());
+  }
 
-    RelocData* reloc_data = (*sectIter)->getRelocData();
-    RelocData::iterator relocIter, relocEnd = reloc_data->end();
-    for (relocIter = reloc_data->begin(); relocIter != relocEnd; ++relocIter) {
+  ThreadPool pool(m_Config.options().numThreads());
+  parallelFor(pool, 0, relocs.size(), [this, &relocs, data](size_t pIndex) {
+    RelocData::iterator relocIter, relocEnd = relocs[pIndex]->end();
+    for (relocIter = relocs[pIndex]->begin(); relocIter != relocEnd;
+         ++relocIter) {
       Relocation* reloc = llvm::cast<Relocation>(relocIter);
 
       // bypass the relocation with NONE type. This is to avoid overwrite the
@@ -948,16 +2120,25 @@ void ObjectLinker::partialSyncRelocationResult(FileOutputBuffer& pOutput) {
         continue;
       writeRelocationResult(*reloc, data);
     }
-  }
+  });
 }
 
 void ObjectLinker::writeRelocationResult(Relocation& pReloc, uint8_t* pOutput) {
+  // the results in the compressed sections are written before compression
+  const LDSection& section =
+      pReloc.targetRef().frag()->getParent()->getSection();
+  if (!m_CompressedSections.empty() &&
+      ((section.flag() & ELF::SHF_COMPRESSED) != 0))
+    return;
+
   // get output file offset
-  size_t out_offset =
-      pReloc.targetRef().frag()->getParent()->getSection().offset() +
-      pReloc.targetRef().getOutputOffset();
+  size_t out_offset = section.offset() + pReloc.targetRef().getOutputOffset();
+  writeRelocationTarget(pReloc, pOutput + out_offset);
+}
 
-  uint8_t* target_addr = pOutput + out_offset;
+void ObjectLinker::writeRelocationTarget(Relocation& pReloc,
+                                         uint8_t* pPlace) {
+  uint8_t* target_addr = pPlace;
   // byte swapping if target and host has different endian, and then write back
   if (llvm::sys::IsLittleEndianHost != m_Config.targets().isLittleEndian()) {
     uint64_t tmp_data = 0;
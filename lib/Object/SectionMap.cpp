@@ -18,19 +18,13 @@
 #include "mcld/Script/StringList.h"
 #include "mcld/Script/WildcardPattern.h"
 
+#include <llvm/ADT/StringMap.h>
 #include <llvm/Support/Casting.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <climits>
-#if !defined(MCLD_ON_WIN32)
-#include <fnmatch.h>
-#define fnmatch0(pattern, string) (fnmatch(pattern, string, 0) == 0)
-#else
-#include <windows.h>
-#include <shlwapi.h>
-#define fnmatch0(pattern, string) (PathMatchSpec(string, pattern) == true)
-#endif
 
 namespace mcld {
 
@@ -152,10 +146,181 @@ SectionMap::Output::dot_iterator SectionMap::Output::find_last_explicit_dot() {
   return dot_end();
 }
 
+//===----------------------------------------------------------------------===//
+// SectionMap::Matcher
+//===----------------------------------------------------------------------===//
+/** \class SectionMap::Matcher
+ *  \brief Matcher indexes the input section descriptions by their section
+ *  patterns, so that finding the rule of an input section only tests the
+ *  rules whose patterns may match the section name.
+ *
+ *  - a pattern without wildcards is put into an exact-name hash,
+ *  - a pattern like ".text.*" is put into a hash of prefixes, which is probed
+ *    once for each distinct prefix length,
+ *  - a pattern like "*.init_array" is put into a hash of suffixes in the same
+ *    way,
+ *  - any other pattern is tested one by one.
+ *
+ *  The rules are numbered in script order and the candidates are tried from
+ *  the lowest number, so the result is the same as trying every rule.
+ */
+class SectionMap::Matcher {
+ public:
+  struct Rule {
+    Output* output;
+    Input* input;
+    // the rule tests the name of the input file
+    bool isFileDependent;
+  };
+
+  typedef std::vector<size_t> RuleList;
+
+ public:
+  explicit Matcher(const OutputDescList& pOutputs);
+
+  /// candidates - the numbers of the rules whose section patterns may match
+  /// pSection, in script order.
+  void candidates(llvm::StringRef pSection, RuleList& pResult) const;
+
+  const Rule& rule(size_t pNumber) const { return m_Rules[pNumber]; }
+
+  size_t numOfRules() const { return m_Rules.size(); }
+
+  /// lookUpCache - the number of the rule found for pSection before, or
+  /// numOfRules() if no rule matched. Return false if pSection is not cached.
+  bool lookUpCache(llvm::StringRef pSection, size_t& pNumber) const;
+
+  /// cache - remember the result of pSection. Only results that do not depend
+  /// on the input file are cached.
+  void cache(llvm::StringRef pSection, size_t pNumber);
+
+ private:
+  static void addRule(RuleList& pList, size_t pNumber);
+
+ private:
+  std::vector<Rule> m_Rules;
+  llvm::StringMap<RuleList> m_ExactRules;
+  llvm::StringMap<RuleList> m_PrefixRules;
+  std::vector<size_t> m_PrefixLengths;
+  llvm::StringMap<RuleList> m_SuffixRules;
+  std::vector<size_t> m_SuffixLengths;
+  RuleList m_GlobRules;
+  llvm::StringMap<size_t> m_Cache;
+};
+
+SectionMap::Matcher::Matcher(const OutputDescList& pOutputs) {
+  OutputDescList::const_iterator out, outEnd = pOutputs.end();
+  for (out = pOutputs.begin(); out != outEnd; ++out) {
+    Output::iterator in, inEnd = (*out)->end();
+    for (in = (*out)->begin(); in != inEnd; ++in) {
+      const InputSectDesc::Spec& spec = (*in)->spec();
+      // a rule without section patterns never matches
+      if (!spec.hasSections())
+        continue;
+
+      Rule rule;
+      rule.output = *out;
+      rule.input = *in;
+      rule.isFileDependent =
+          (spec.hasFile() && spec.file().name().compare("*") != 0) ||
+          spec.hasExcludeFiles();
+
+      size_t number = m_Rules.size();
+      m_Rules.push_back(rule);
+
+      StringList::const_iterator sect, sectEnd = spec.sections().end();
+      for (sect = spec.sections().begin(); sect != sectEnd; ++sect) {
+        const WildcardPattern& pattern = llvm::cast<WildcardPattern>(**sect);
+        switch (pattern.matchKind()) {
+          case WildcardPattern::Exact:
+            addRule(m_ExactRules[pattern.literal()], number);
+            break;
+          case WildcardPattern::Prefix:
+            addRule(m_PrefixRules[pattern.literal()], number);
+            m_PrefixLengths.push_back(pattern.literal().size());
+            break;
+          case WildcardPattern::Suffix:
+            addRule(m_SuffixRules[pattern.literal()], number);
+            m_SuffixLengths.push_back(pattern.literal().size());
+            break;
+          default:
+            addRule(m_GlobRules, number);
+            break;
+        }
+      }
+    }
+  }
+
+  std::sort(m_PrefixLengths.begin(), m_PrefixLengths.end());
+  m_PrefixLengths.erase(
+      std::unique(m_PrefixLengths.begin(), m_PrefixLengths.end()),
+      m_PrefixLengths.end());
+  std::sort(m_SuffixLengths.begin(), m_SuffixLengths.end());
+  m_SuffixLengths.erase(
+      std::unique(m_SuffixLengths.begin(), m_SuffixLengths.end()),
+      m_SuffixLengths.end());
+}
+
+void SectionMap::Matcher::addRule(RuleList& pList, size_t pNumber) {
+  // patterns of the same rule are added one after another
+  if (pList.empty() || pList.back() != pNumber)
+    pList.push_back(pNumber);
+}
+
+void SectionMap::Matcher::candidates(llvm::StringRef pSection,
+                                     RuleList& pResult) const {
+  pResult.clear();
+
+  llvm::StringMap<RuleList>::const_iterator entry;
+  entry = m_ExactRules.find(pSection);
+  if (entry != m_ExactRules.end())
+    pResult.insert(pResult.end(), entry->second.begin(), entry->second.end());
+
+  std::vector<size_t>::const_iterator len, lenEnd = m_PrefixLengths.end();
+  for (len = m_PrefixLengths.begin(); len != lenEnd; ++len) {
+    if (*len > pSection.size())
+      break;
+    entry = m_PrefixRules.find(pSection.substr(0, *len));
+    if (entry != m_PrefixRules.end())
+      pResult.insert(pResult.end(), entry->second.begin(), entry->second.end());
+  }
+
+  lenEnd = m_SuffixLengths.end();
+  for (len = m_SuffixLengths.begin(); len != lenEnd; ++len) {
+    if (*len > pSection.size())
+      break;
+    entry = m_SuffixRules.find(pSection.substr(pSection.size() - *len));
+    if (entry != m_SuffixRules.end())
+      pResult.insert(pResult.end(), entry->second.begin(), entry->second.end());
+  }
+
+  pResult.insert(pResult.end(), m_GlobRules.begin(), m_GlobRules.end());
+
+  std::sort(pResult.begin(), pResult.end());
+  pResult.erase(std::unique(pResult.begin(), pResult.end()), pResult.end());
+}
+
+bool SectionMap::Matcher::lookUpCache(llvm::StringRef pSection,
+                                      size_t& pNumber) const {
+  llvm::StringMap<size_t>::const_iterator entry = m_Cache.find(pSection);
+  if (entry == m_Cache.end())
+    return false;
+  pNumber = entry->second;
+  return true;
+}
+
+void SectionMap::Matcher::cache(llvm::StringRef pSection, size_t pNumber) {
+  m_Cache[pSection] = pNumber;
+}
+
 //===----------------------------------------------------------------------===//
 // SectionMap
 //===----------------------------------------------------------------------===//
+SectionMap::SectionMap() : m_pMatcher(NULL) {
+}
+
 SectionMap::~SectionMap() {
+  delete m_pMatcher;
   iterator out, outBegin = begin(), outEnd = end();
   for (out = outBegin; out != outEnd; ++out) {
     if (*out != NULL) {
@@ -172,29 +337,38 @@ SectionMap::~SectionMap() {
 SectionMap::const_mapping SectionMap::find(
     const std::string& pInputFile,
     const std::string& pInputSection) const {
-  const_iterator out, outBegin = begin(), outEnd = end();
-  for (out = outBegin; out != outEnd; ++out) {
-    Output::const_iterator in, inBegin = (*out)->begin(), inEnd = (*out)->end();
-    for (in = inBegin; in != inEnd; ++in) {
-      if (matched(**in, pInputFile, pInputSection))
-        return std::make_pair(*out, *in);
-    }
-  }
-  return std::make_pair((const Output*)NULL, (const Input*)NULL);
+  return const_cast<SectionMap*>(this)->find(pInputFile, pInputSection);
 }
 
 SectionMap::mapping SectionMap::find(const std::string& pInputFile,
                                      const std::string& pInputSection) {
-  iterator out, outBegin = begin(), outEnd = end();
-  for (out = outBegin; out != outEnd; ++out) {
-    Output::iterator in, inBegin = (*out)->begin(), inEnd = (*out)->end();
-    for (in = inBegin; in != inEnd; ++in) {
-      if (matched(**in, pInputFile, pInputSection))
-        return std::make_pair(*out, *in);
+  Matcher& matcher = getMatcher();
+  size_t number = matcher.numOfRules();
+  if (!matcher.lookUpCache(pInputSection, number)) {
+    Matcher::RuleList candidates;
+    matcher.candidates(pInputSection, candidates);
+
+    bool is_file_dependent = false;
+    Matcher::RuleList::iterator cand, candEnd = candidates.end();
+    for (cand = candidates.begin(); cand != candEnd; ++cand) {
+      const Matcher::Rule& rule = matcher.rule(*cand);
+      is_file_dependent |= rule.isFileDependent;
+      if (matched(*rule.input, pInputFile, pInputSection)) {
+        number = *cand;
+        break;
+      }
     }
+
+    if (!is_file_dependent)
+      matcher.cache(pInputSection, number);
   }
-  return std::make_pair(reinterpret_cast<Output*>(NULL),
-                        reinterpret_cast<Input*>(NULL));
+
+  if (number == matcher.numOfRules()) {
+    return std::make_pair(reinterpret_cast<Output*>(NULL),
+                          reinterpret_cast<Input*>(NULL));
+  }
+  return std::make_pair(matcher.rule(number).output,
+                        matcher.rule(number).input);
 }
 
 SectionMap::const_iterator SectionMap::find(
@@ -220,6 +394,7 @@ std::pair<SectionMap::mapping, bool> SectionMap::insert(
     const std::string& pInputSection,
     const std::string& pOutputSection,
     InputSectDesc::KeepPolicy pPolicy) {
+  invalidateMatcher();
   iterator out, outBegin = begin(), outEnd = end();
   for (out = outBegin; out != outEnd; ++out) {
     if ((*out)->name().compare(pOutputSection) == 0)
@@ -252,6 +427,7 @@ std::pair<SectionMap::mapping, bool> SectionMap::insert(
 std::pair<SectionMap::mapping, bool> SectionMap::insert(
     const InputSectDesc& pInputDesc,
     const OutputSectDesc& pOutputDesc) {
+  invalidateMatcher();
   iterator out, outBegin = begin(), outEnd = end();
   for (out = outBegin; out != outEnd; ++out) {
     if ((*out)->name().compare(pOutputDesc.name()) == 0 &&
@@ -287,12 +463,60 @@ std::pair<SectionMap::mapping, bool> SectionMap::insert(
 
 SectionMap::iterator SectionMap::insert(iterator pPosition,
                                         LDSection* pSection) {
+  invalidateMatcher();
   Output* output = new Output(pSection->name());
   output->append(new Input(pSection->name(), InputSectDesc::NoKeep));
   output->setSection(pSection);
   return m_OutputDescList.insert(pPosition, output);
 }
 
+/// compareOrder - the order of the (order, section) pairs
+static bool compareOrder(const std::pair<size_t, LDSection*>& pLHS,
+                         const std::pair<size_t, LDSection*>& pRHS) {
+  return pLHS.first < pRHS.first;
+}
+
+void SectionMap::insertByOrder(OrderedSectionList& pSections) {
+  invalidateMatcher();
+  std::stable_sort(pSections.begin(), pSections.end(), compareOrder);
+
+  // A section goes before the first description of a larger order, which is
+  // never before that of a smaller order. So the sorted sections are merged
+  // into the list in one walk.
+  OutputDescList result;
+  result.reserve(m_OutputDescList.size() + pSections.size());
+  iterator out = begin(), outEnd = end();
+  OrderedSectionList::iterator sect, sectEnd = pSections.end();
+  for (sect = pSections.begin(); sect != sectEnd; ++sect) {
+    while ((out != outEnd) && ((*out)->order() <= sect->first))
+      result.push_back(*out++);
+
+    Output* output = new Output(sect->second->name());
+    output->append(new Input(sect->second->name(), InputSectDesc::NoKeep));
+    output->setSection(sect->second);
+    output->setOrder(sect->first);
+    result.push_back(output);
+  }
+  result.insert(result.end(), out, outEnd);
+  m_OutputDescList.swap(result);
+}
+
+void SectionMap::sortByOrder() {
+  invalidateMatcher();
+  std::stable_sort(begin(), end(), SHOCompare());
+}
+
+SectionMap::Matcher& SectionMap::getMatcher() const {
+  if (m_pMatcher == NULL)
+    m_pMatcher = new Matcher(m_OutputDescList);
+  return *m_pMatcher;
+}
+
+void SectionMap::invalidateMatcher() {
+  delete m_pMatcher;
+  m_pMatcher = NULL;
+}
+
 bool SectionMap::matched(const SectionMap::Input& pInput,
                          const std::string& pInputFile,
                          const std::string& pInputSection) const {
@@ -323,12 +547,7 @@ bool SectionMap::matched(const SectionMap::Input& pInput,
 
 bool SectionMap::matched(const WildcardPattern& pPattern,
                          const std::string& pName) const {
-  if (pPattern.isPrefix()) {
-    llvm::StringRef name(pName);
-    return name.startswith(pPattern.prefix());
-  } else {
-    return fnmatch0(pPattern.name().c_str(), pName.c_str());
-  }
+  return pPattern.matches(pName);
 }
 
 // fixupDotSymbols - ensure the dot symbols are valid
@@ -16,60 +16,93 @@
 #include "mcld/Support/MsgHandling.h"
 #include "mcld/Module.h"
 
+#include <llvm/ADT/SmallVector.h>
 #include <llvm/Support/Casting.h>
 #include <llvm/Support/DataTypes.h>
 
-#include <stack>
-
 #include <cassert>
 
 namespace mcld {
 
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// isPureOperator - check if the result of pOp only depends on its operands
+bool isPureOperator(const Operator& pOp) {
+  switch (pOp.type()) {
+    case Operator::ASSIGN:
+    case Operator::ADD_ASSIGN:
+    case Operator::SUB_ASSIGN:
+    case Operator::MUL_ASSIGN:
+    case Operator::DIV_ASSIGN:
+    case Operator::AND_ASSIGN:
+    case Operator::OR_ASSIGN:
+    case Operator::LS_ASSIGN:
+    case Operator::RS_ASSIGN:
+      return false;
+    case Operator::ALIGN:
+    case Operator::MAX:
+    case Operator::MIN:
+      return true;
+    default:
+      return pOp.type() < Operator::ASSIGN;
+  }
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// RpnEvaluator
+//===----------------------------------------------------------------------===//
 RpnEvaluator::RpnEvaluator(const Module& pModule,
                            const TargetLDBackend& pBackend)
     : m_Module(pModule), m_Backend(pBackend) {
 }
 
 bool RpnEvaluator::eval(const RpnExpr& pExpr, uint64_t& pResult) {
-  std::stack<Operand*> operandStack;
+  if (pExpr.isFolded()) {
+    pResult = pExpr.foldedValue();
+    return true;
+  }
+
+  // an expression of the integers and the pure operators is folded once
+  bool is_constant = true;
+  llvm::SmallVector<Operand*, 16> operandStack;
   for (RpnExpr::const_iterator it = pExpr.begin(), ie = pExpr.end(); it != ie;
        ++it) {
     switch ((*it)->kind()) {
       case ExprToken::OPERATOR: {
         Operator* op = llvm::cast<Operator>(*it);
+        is_constant = is_constant && isPureOperator(*op);
         switch (op->arity()) {
           case Operator::NULLARY: {
-            operandStack.push(op->eval(m_Module, m_Backend));
+            operandStack.push_back(op->eval(m_Module, m_Backend));
             break;
           }
           case Operator::UNARY: {
-            Operand* opd = operandStack.top();
-            operandStack.pop();
+            Operand* opd = operandStack.pop_back_val();
             op->appendOperand(opd);
-            operandStack.push(op->eval(m_Module, m_Backend));
+            operandStack.push_back(op->eval(m_Module, m_Backend));
             break;
           }
           case Operator::BINARY: {
-            Operand* opd2 = operandStack.top();
-            operandStack.pop();
-            Operand* opd1 = operandStack.top();
-            operandStack.pop();
+            Operand* opd2 = operandStack.pop_back_val();
+            Operand* opd1 = operandStack.pop_back_val();
             op->appendOperand(opd1);
             op->appendOperand(opd2);
-            operandStack.push(op->eval(m_Module, m_Backend));
+            operandStack.push_back(op->eval(m_Module, m_Backend));
             break;
           }
           case Operator::TERNARY: {
-            Operand* opd3 = operandStack.top();
-            operandStack.pop();
-            Operand* opd2 = operandStack.top();
-            operandStack.pop();
-            Operand* opd1 = operandStack.top();
-            operandStack.pop();
+            Operand* opd3 = operandStack.pop_back_val();
+            Operand* opd2 = operandStack.pop_back_val();
+            Operand* opd1 = operandStack.pop_back_val();
             op->appendOperand(opd1);
             op->appendOperand(opd2);
             op->appendOperand(opd3);
-            operandStack.push(op->eval(m_Module, m_Backend));
+            operandStack.push_back(op->eval(m_Module, m_Backend));
             break;
           }
         }  // end of switch operator arity
@@ -78,6 +111,7 @@ bool RpnEvaluator::eval(const RpnExpr& pExpr, uint64_t& pResult) {
 
       case ExprToken::OPERAND: {
         Operand* opd = llvm::cast<Operand>(*it);
+        is_constant = is_constant && (opd->type() == Operand::INTEGER);
         switch (opd->type()) {
           case Operand::SYMBOL: {
             // It's possible that there are no operators in an expression, so
@@ -92,11 +126,11 @@ bool RpnEvaluator::eval(const RpnExpr& pExpr, uint64_t& pResult) {
               }
               sym_opd->setValue(symbol->value());
             }
-            operandStack.push(opd);
+            operandStack.push_back(opd);
             break;
           }
           default:
-            operandStack.push(opd);
+            operandStack.push_back(opd);
             break;
         }  // end of switch operand type
         break;
@@ -105,10 +139,12 @@ bool RpnEvaluator::eval(const RpnExpr& pExpr, uint64_t& pResult) {
   }    // end of for
 
   // stack top is result
-  assert(operandStack.top()->type() == Operand::SYMBOL ||
-         operandStack.top()->type() == Operand::INTEGER ||
-         operandStack.top()->type() == Operand::FRAGMENT);
-  pResult = operandStack.top()->value();
+  assert(operandStack.back()->type() == Operand::SYMBOL ||
+         operandStack.back()->type() == Operand::INTEGER ||
+         operandStack.back()->type() == Operand::FRAGMENT);
+  pResult = operandStack.back()->value();
+  if (is_constant)
+    pExpr.setFoldedValue(pResult);
   return true;
 }
 
@@ -25,7 +25,7 @@ static llvm::ManagedStatic<ExprFactory> g_ExprFactory;
 //===----------------------------------------------------------------------===//
 // RpnExpr
 //===----------------------------------------------------------------------===//
-RpnExpr::RpnExpr() {
+RpnExpr::RpnExpr() : m_bFolded(false), m_FoldedValue(0) {
 }
 
 RpnExpr::~RpnExpr() {
@@ -48,6 +48,7 @@ void RpnExpr::dump() const {
 }
 
 void RpnExpr::push_back(ExprToken* pToken) {
+  m_bFolded = false;
   m_TokenQueue.push_back(pToken);
 }
 
@@ -68,10 +69,12 @@ void RpnExpr::clear() {
 }
 
 RpnExpr::iterator RpnExpr::insert(iterator pPosition, ExprToken* pToken) {
+  m_bFolded = false;
   return m_TokenQueue.insert(pPosition, pToken);
 }
 
 void RpnExpr::erase(iterator pPosition) {
+  m_bFolded = false;
   m_TokenQueue.erase(pPosition);
 }
 
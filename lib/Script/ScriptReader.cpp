@@ -8,18 +8,149 @@
 //===----------------------------------------------------------------------===//
 #include "mcld/Script/ScriptReader.h"
 
+#include "mcld/Config/Config.h"
+#include "mcld/LinkerConfig.h"
 #include "mcld/MC/Input.h"
 #include "mcld/Script/ScriptFile.h"
 #include "mcld/Script/ScriptScanner.h"
 #include "mcld/Support/MemoryArea.h"
 
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
 #include <llvm/ADT/StringRef.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/raw_ostream.h>
 
+#include <cstring>
 #include <istream>
+#include <memory>
 #include <sstream>
 
 namespace mcld {
 
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// kCacheMagic - the first word of a token file, followed by MCLD_VERSION.
+/// Change it when the tokens of ScriptParser.yy or the layout below change.
+const uint32_t kCacheMagic = 0x4d544b31;  // "MTK1"
+
+/// getCachePath - the token file of a script of pKind with pContent
+std::string getCachePath(const std::string& pDir,
+                         ScriptFile::Kind pKind,
+                         llvm::StringRef pContent) {
+  llvm::SHA1 sha1;
+  sha1.update(llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t*>(pContent.data()), pContent.size()));
+  std::string digest = llvm::toHex(llvm::StringRef(
+      reinterpret_cast<const char*>(sha1.final().data()), 20));
+
+  llvm::SmallString<256> path(pDir);
+  llvm::sys::path::append(path, digest + "-" + llvm::utostr(pKind) + ".tok");
+  return path.str().str();
+}
+
+template <typename T>
+void writeWord(std::string& pBuffer, T pValue) {
+  pBuffer.append(reinterpret_cast<const char*>(&pValue), sizeof(T));
+}
+
+template <typename T>
+bool readWord(llvm::StringRef& pBuffer, T& pValue) {
+  if (pBuffer.size() < sizeof(T))
+    return false;
+  std::memcpy(&pValue, pBuffer.data(), sizeof(T));
+  pBuffer = pBuffer.substr(sizeof(T));
+  return true;
+}
+
+/// loadTokens - read the token file pPath. A missing or broken file is a miss.
+bool loadTokens(const std::string& pPath, ScriptScanner::TokenList& pTokens) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer> > buffer_or_error =
+      llvm::MemoryBuffer::getFile(pPath,
+                                  /*FileSize*/ -1,
+                                  /*RequiresNullTerminator*/ false);
+  if (!buffer_or_error)
+    return false;
+
+  llvm::StringRef buffer = buffer_or_error.get()->getBuffer();
+  uint32_t magic = 0, count = 0;
+  llvm::StringRef version(MCLD_VERSION);
+  if (!readWord(buffer, magic) || magic != kCacheMagic ||
+      !buffer.startswith(version))
+    return false;
+  buffer = buffer.substr(version.size());
+  if (!readWord(buffer, count))
+    return false;
+
+  pTokens.resize(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    ScriptScanner::Token& tok = pTokens[i];
+    uint32_t type = 0, length = 0;
+    if (!readWord(buffer, type) || !readWord(buffer, tok.beginLine) ||
+        !readWord(buffer, tok.beginColumn) || !readWord(buffer, tok.endLine) ||
+        !readWord(buffer, tok.endColumn) || !readWord(buffer, tok.integer) ||
+        !readWord(buffer, length) || buffer.size() < length) {
+      pTokens.clear();
+      return false;
+    }
+    tok.type = type;
+    tok.text = buffer.substr(0, length).str();
+    buffer = buffer.substr(length);
+  }
+  return true;
+}
+
+/// storeTokens - write the token file pPath. The file is written aside and
+/// renamed, so that the links sharing the directory never read a partial
+/// file. Failing to write is not an error.
+void storeTokens(const std::string& pPath,
+                 const ScriptScanner::TokenList& pTokens) {
+  std::string buffer;
+  writeWord(buffer, kCacheMagic);
+  buffer.append(MCLD_VERSION);
+  writeWord(buffer, static_cast<uint32_t>(pTokens.size()));
+  ScriptScanner::TokenList::const_iterator tok, tokEnd = pTokens.end();
+  for (tok = pTokens.begin(); tok != tokEnd; ++tok) {
+    writeWord(buffer, static_cast<uint32_t>(tok->type));
+    writeWord(buffer, tok->beginLine);
+    writeWord(buffer, tok->beginColumn);
+    writeWord(buffer, tok->endLine);
+    writeWord(buffer, tok->endColumn);
+    writeWord(buffer, tok->integer);
+    writeWord(buffer, static_cast<uint32_t>(tok->text.size()));
+    buffer.append(tok->text);
+  }
+
+  int fd = -1;
+  llvm::SmallString<256> temp;
+  if (llvm::sys::fs::createUniqueFile(pPath + "-%%%%%%", fd, temp))
+    return;
+  {
+    llvm::raw_fd_ostream out(fd, /*shouldClose*/ true);
+    out << buffer;
+    out.close();
+    if (out.has_error()) {
+      out.clear_error();
+      llvm::sys::fs::remove(temp.str());
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(temp.str(), pPath))
+    llvm::sys::fs::remove(temp.str());
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// ScriptReader
+//===----------------------------------------------------------------------===//
 ScriptReader::ScriptReader(ObjectReader& pObjectReader,
                            ArchiveReader& pArchiveReader,
                            DynObjReader& pDynObjReader,
@@ -45,10 +176,26 @@ bool ScriptReader::readScript(const LinkerConfig& pConfig,
   Input& input = pScriptFile.input();
   size_t size = input.memArea()->size();
   llvm::StringRef region = input.memArea()->request(input.fileOffset(), size);
-  std::stringbuf buf(region.data());
 
+  // the tokens of a script seen before are replayed instead of scanned
+  std::string cache_path;
+  ScriptScanner::TokenList tokens;
+  bool replay = false;
+  if (pConfig.options().hasScriptCache()) {
+    cache_path = getCachePath(pConfig.options().getScriptCacheDir(),
+                              pScriptFile.getKind(),
+                              region);
+    replay = loadTokens(cache_path, tokens);
+  }
+
+  std::stringbuf buf(replay ? "" : region.data());
   std::istream in(&buf);
   ScriptScanner scanner(&in);
+  if (replay)
+    scanner.replay(tokens);
+  else if (!cache_path.empty())
+    scanner.record(tokens);
+
   ScriptParser parser(pConfig,
                       pScriptFile,
                       scanner,
@@ -56,7 +203,10 @@ bool ScriptReader::readScript(const LinkerConfig& pConfig,
                       m_ArchiveReader,
                       m_DynObjReader,
                       m_GroupReader);
-  return parser.parse() == 0;
+  bool result = (parser.parse() == 0);
+  if (result && !replay && !cache_path.empty() && !scanner.hasError())
+    storeTokens(cache_path, tokens);
+  return result;
 }
 
 }  // namespace mcld
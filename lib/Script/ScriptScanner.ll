@@ -286,7 +286,12 @@ WS [ \t\r]
 namespace mcld {
 
 ScriptScanner::ScriptScanner(std::istream* yyin, std::ostream* yyout)
-  : yyFlexLexer(yyin, yyout), m_Kind(ScriptFile::Unknown)
+  : yyFlexLexer(yyin, yyout),
+    m_Kind(ScriptFile::Unknown),
+    m_pRecord(NULL),
+    m_pReplay(NULL),
+    m_ReplayPos(0),
+    m_bHasError(false)
 {
 }
 
@@ -294,6 +299,50 @@ ScriptScanner::~ScriptScanner()
 {
 }
 
+ScriptParser::token_type
+ScriptScanner::lex(ScriptParser::semantic_type* yylval,
+                   ScriptParser::location_type* yylloc,
+                   const ScriptFile& pScriptFile)
+{
+  if (m_pReplay != NULL) {
+    if (m_ReplayPos == m_pReplay->size())
+      return token::END;
+
+    const Token& tok = (*m_pReplay)[m_ReplayPos++];
+    yylloc->begin.line = tok.beginLine;
+    yylloc->begin.column = tok.beginColumn;
+    yylloc->end.line = tok.endLine;
+    yylloc->end.column = tok.endColumn;
+    if (tok.type == token::INTEGER)
+      yylval->integer = tok.integer;
+    else if (tok.type == token::STRING || tok.type == token::LNAMESPEC)
+      yylval->string = &pScriptFile.createParserStr(tok.text.data(),
+                                                    tok.text.size());
+    return static_cast<token_type>(tok.type);
+  }
+
+  token_type type = scan(yylval, yylloc, pScriptFile);
+  if (m_pRecord != NULL) {
+    Token tok;
+    tok.type = type;
+    tok.beginLine = yylloc->begin.line;
+    tok.beginColumn = yylloc->begin.column;
+    tok.endLine = yylloc->end.line;
+    tok.endColumn = yylloc->end.column;
+    tok.integer = (type == token::INTEGER) ? yylval->integer : 0;
+    if (type == token::STRING || type == token::LNAMESPEC)
+      tok.text = *yylval->string;
+    m_pRecord->push_back(tok);
+  }
+  return type;
+}
+
+void ScriptScanner::replay(const TokenList& pTokens)
+{
+  m_pReplay = &pTokens;
+  m_ReplayPos = 0;
+}
+
 void ScriptScanner::enterComments(ScriptParser::location_type& pLocation)
 {
   const int start_line = pLocation.begin.line;
@@ -331,6 +380,7 @@ void ScriptScanner::enterComments(ScriptParser::location_type& pLocation)
       pLocation.lines(1);
 
     if (ch == EOF) {
+      m_bHasError = true;
       error(diag::err_unterminated_comment) << pLocation.begin.filename
                                             << start_line
                                             << start_col;
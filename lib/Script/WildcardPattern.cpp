@@ -13,6 +13,14 @@
 
 #include <llvm/Support/ManagedStatic.h>
 #include <cassert>
+#if !defined(MCLD_ON_WIN32)
+#include <fnmatch.h>
+#define fnmatch0(pattern, string) (fnmatch(pattern, string, 0) == 0)
+#else
+#include <windows.h>
+#include <shlwapi.h>
+#define fnmatch0(pattern, string) (PathMatchSpec(string, pattern) == true)
+#endif
 
 namespace mcld {
 
@@ -23,16 +31,15 @@ static llvm::ManagedStatic<WildcardPatternFactory> g_WildcardPatternFactory;
 //===----------------------------------------------------------------------===//
 // WildcardPattern
 //===----------------------------------------------------------------------===//
-WildcardPattern::WildcardPattern() : m_bIsPrefix(false) {
+WildcardPattern::WildcardPattern() : m_MatchKind(Exact) {
 }
 
 WildcardPattern::WildcardPattern(const std::string& pPattern,
                                  SortPolicy pPolicy)
-    : StrToken(StrToken::Wildcard, pPattern), m_SortPolicy(pPolicy) {
-  if (pPattern.find_first_of('*') == (pPattern.size() - 1))
-    m_bIsPrefix = true;
-  else
-    m_bIsPrefix = false;
+    : StrToken(StrToken::Wildcard, pPattern),
+      m_SortPolicy(pPolicy),
+      m_MatchKind(Exact) {
+  compile();
 }
 
 WildcardPattern::~WildcardPattern() {
@@ -40,11 +47,187 @@ WildcardPattern::~WildcardPattern() {
 
 llvm::StringRef WildcardPattern::prefix() const {
   if (isPrefix())
-    return llvm::StringRef(name().c_str(), name().size() - 1);
+    return m_Literal;
 
   return llvm::StringRef(name());
 }
 
+void WildcardPattern::compile() {
+  const std::string& pattern = name();
+
+  // the character classes like [[:alpha:]] are left to fnmatch
+  if (pattern.find("[:") != std::string::npos ||
+      pattern.find("[=") != std::string::npos ||
+      pattern.find("[.") != std::string::npos) {
+    m_MatchKind = Complex;
+    return;
+  }
+
+  bool has_wildcard = false;
+  size_t pos = 0;
+  while (pos < pattern.size()) {
+    Element elem;
+    char c = pattern[pos];
+    if (c == '*') {
+      ++pos;
+      // consecutive stars are the same as one
+      if (!m_Elements.empty() && m_Elements.back().type == Element::Star)
+        continue;
+      elem.type = Element::Star;
+      elem.value = 0;
+    } else if (c == '?') {
+      ++pos;
+      elem.type = Element::AnyChar;
+      elem.value = 0;
+      has_wildcard = true;
+    } else if (c == '[') {
+      CharClass cls;
+      size_t end = parseClass(pos, cls);
+      if (end == std::string::npos) {
+        // an unterminated `[' is an ordinary character
+        ++pos;
+        elem.type = Element::Char;
+        elem.value = static_cast<unsigned char>(c);
+      } else {
+        pos = end;
+        elem.type = Element::Class;
+        elem.value = m_Classes.size();
+        m_Classes.push_back(cls);
+        has_wildcard = true;
+      }
+    } else {
+      if (c == '\\' && pos + 1 < pattern.size())
+        c = pattern[++pos];
+      ++pos;
+      elem.type = Element::Char;
+      elem.value = static_cast<unsigned char>(c);
+    }
+    m_Elements.push_back(elem);
+  }
+
+  // the stars of the simple shapes may only be at the ends
+  size_t begin = 0, end = m_Elements.size();
+  bool leading = (end != 0 && m_Elements.front().type == Element::Star);
+  if (leading)
+    ++begin;
+  bool trailing = (end > begin && m_Elements.back().type == Element::Star);
+  if (trailing)
+    --end;
+  for (size_t i = begin; i != end; ++i) {
+    if (m_Elements[i].type != Element::Char)
+      has_wildcard = true;
+  }
+
+  if (has_wildcard) {
+    m_MatchKind = Glob;
+    return;
+  }
+
+  for (size_t i = begin; i != end; ++i)
+    m_Literal.push_back(static_cast<char>(m_Elements[i].value));
+
+  if (leading && trailing)
+    m_MatchKind = Contains;
+  else if (leading)
+    // a lone `*' is the empty prefix
+    m_MatchKind = (end == begin) ? Prefix : Suffix;
+  else if (trailing)
+    m_MatchKind = Prefix;
+  else
+    m_MatchKind = Exact;
+  m_Elements.clear();
+}
+
+size_t WildcardPattern::parseClass(size_t pPos, CharClass& pClass) {
+  const std::string& pattern = name();
+  size_t pos = pPos + 1;
+  bool negate = false;
+  if (pos < pattern.size() && (pattern[pos] == '!' || pattern[pos] == '^')) {
+    negate = true;
+    ++pos;
+  }
+
+  // a `]' right after the `[' is a member of the class
+  bool first = true;
+  while (pos < pattern.size() && (first || pattern[pos] != ']')) {
+    first = false;
+    unsigned char low = pattern[pos];
+    if (low == '\\' && pos + 1 < pattern.size())
+      low = pattern[++pos];
+    ++pos;
+
+    unsigned char high = low;
+    if (pos + 1 < pattern.size() && pattern[pos] == '-' &&
+        pattern[pos + 1] != ']') {
+      high = pattern[pos + 1];
+      pos += 2;
+      if (high == '\\' && pos < pattern.size())
+        high = pattern[pos++];
+    }
+    for (unsigned c = low; c <= high; ++c)
+      pClass.set(c);
+  }
+
+  if (pos >= pattern.size())
+    return std::string::npos;
+
+  if (negate)
+    pClass.flip();
+  return pos + 1;
+}
+
+bool WildcardPattern::matches(llvm::StringRef pName) const {
+  switch (m_MatchKind) {
+    case Exact:
+      return pName == m_Literal;
+    case Prefix:
+      return pName.startswith(m_Literal);
+    case Suffix:
+      return pName.endswith(m_Literal);
+    case Contains:
+      return pName.find(m_Literal) != llvm::StringRef::npos;
+    case Glob:
+      return matchGlob(pName);
+    case Complex:
+    default:
+      return fnmatch0(name().c_str(), pName.str().c_str());
+  }
+}
+
+bool WildcardPattern::matchGlob(llvm::StringRef pName) const {
+  // only the last star is retried: a later star can match anything that an
+  // earlier star would have to match when being retried
+  size_t elem = 0, pos = 0;
+  size_t star_elem = std::string::npos, star_pos = 0;
+  size_t num_elems = m_Elements.size();
+  while (pos < pName.size()) {
+    if (elem < num_elems) {
+      const Element& e = m_Elements[elem];
+      unsigned char c = pName[pos];
+      if (e.type == Element::Star) {
+        star_elem = ++elem;
+        star_pos = pos;
+        continue;
+      }
+      if ((e.type == Element::Char && e.value == c) ||
+          e.type == Element::AnyChar ||
+          (e.type == Element::Class && m_Classes[e.value].test(c))) {
+        ++elem;
+        ++pos;
+        continue;
+      }
+    }
+    if (star_elem == std::string::npos)
+      return false;
+    elem = star_elem;
+    pos = ++star_pos;
+  }
+
+  while (elem < num_elems && m_Elements[elem].type == Element::Star)
+    ++elem;
+  return elem == num_elems;
+}
+
 WildcardPattern* WildcardPattern::create(const std::string& pPattern,
                                          SortPolicy pPolicy) {
   WildcardPattern* result = g_WildcardPatternFactory->allocate();
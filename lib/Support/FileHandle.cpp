@@ -156,6 +156,19 @@ bool FileHandle::truncate(size_t pSize) {
   return true;
 }
 
+bool FileHandle::sync() {
+  if (!isOpened()) {
+    setState(BadBit);
+    return false;
+  }
+
+  if (sys::fs::detail::fsync(m_Handler) == -1) {
+    setState(FailBit);
+    return false;
+  }
+  return true;
+}
+
 bool FileHandle::read(void* pMemBuffer, size_t pStartOffset, size_t pLength) {
   if (!isOpened() || !isReadable()) {
     setState(BadBit);
@@ -8,16 +8,142 @@
 //===----------------------------------------------------------------------===//
 #include "mcld/Support/FileOutputBuffer.h"
 #include "mcld/Support/FileHandle.h"
+#include "mcld/Support/FileSystem.h"
 #include "mcld/Support/Path.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
 namespace mcld {
 
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// the largest size of a single pwrite
+const size_t kWriteChunkSize = 64 << 20;
+
+/// the unit of comparison in the patch mode
+const size_t kPatchBlockSize = 64 << 10;
+
+/// the unit of the holes left in the stream mode
+const size_t kSparseBlockSize = 64 << 10;
+
+/// writeRange - write pLength bytes of pData at pOffset of the file pFD
+std::error_code writeRange(int pFD,
+                           const uint8_t* pData,
+                           size_t pOffset,
+                           size_t pLength) {
+  while (pLength != 0) {
+    ssize_t size = sys::fs::detail::pwrite(
+        pFD, pData + pOffset, std::min(pLength, kWriteChunkSize), pOffset);
+    if (size < 0) {
+      if (errno == EINTR)
+        continue;
+      return std::error_code(errno, std::generic_category());
+    }
+    pOffset += size;
+    pLength -= size;
+  }
+  return std::error_code();
+}
+
+/// isZero - the pLength bytes at pData are all zeros
+bool isZero(const uint8_t* pData, size_t pLength) {
+  return pLength == 0 ||
+         (pData[0] == 0 && std::memcmp(pData, pData + 1, pLength - 1) == 0);
+}
+
+/// writeSparse - write the blocks of the range of pData which are not all
+/// zeros. The file already reads as zeros there.
+std::error_code writeSparse(int pFD,
+                            const uint8_t* pData,
+                            size_t pOffset,
+                            size_t pLength) {
+  size_t end = pOffset + pLength;
+  size_t begin = pOffset;  // the beginning of the blocks to write
+  while (pOffset < end) {
+    size_t next = std::min(end, (pOffset / kSparseBlockSize + 1) *
+                                    kSparseBlockSize);
+    if (isZero(pData + pOffset, next - pOffset)) {
+      if (begin < pOffset) {
+        std::error_code ec = writeRange(pFD, pData, begin, pOffset - begin);
+        if (ec)
+          return ec;
+      }
+      begin = next;
+    }
+    pOffset = next;
+  }
+  if (begin < end)
+    return writeRange(pFD, pData, begin, end - begin);
+  return std::error_code();
+}
+
+/// readRange - read up to pLength bytes at pOffset of the file pFD into
+/// pData, and return the number of bytes read
+size_t readRange(int pFD, uint8_t* pData, size_t pOffset, size_t pLength) {
+  size_t read = 0;
+  while (read < pLength) {
+    ssize_t size = sys::fs::detail::pread(
+        pFD, pData + read, pLength - read, pOffset + read);
+    if (size < 0 && errno == EINTR)
+      continue;
+    if (size <= 0)
+      break;
+    read += size;
+  }
+  return read;
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// FileOutputBuffer
+//===----------------------------------------------------------------------===//
 FileOutputBuffer::FileOutputBuffer(llvm::sys::fs::mapped_file_region* pRegion,
-                                   FileHandle& pFileHandle)
-    : m_pRegion(pRegion), m_FileHandle(pFileHandle) {
+                                   FileHandle& pFileHandle,
+                                   bool pZeroFile)
+    : m_Mode(MMap),
+      m_pRegion(pRegion),
+      m_pData(reinterpret_cast<uint8_t*>(pRegion->data())),
+      m_Size(pRegion->size()),
+      m_pFileHandle(&pFileHandle),
+      m_PatchedSize(0),
+      m_bCommitted(false),
+      m_bZeroFile(pZeroFile),
+      m_bZeroed(pZeroFile) {
+}
+
+FileOutputBuffer::FileOutputBuffer(uint8_t* pData,
+                                   size_t pSize,
+                                   FileHandle* pFileHandle,
+                                   Mode pMode,
+                                   bool pZeroFile)
+    : m_Mode(pMode),
+      m_pData(pData),
+      m_Size(pSize),
+      m_pFileHandle(pFileHandle),
+      m_PatchedSize(0),
+      m_bCommitted(false),
+      m_bZeroFile(pZeroFile),
+      m_bZeroed(true) {
 }
 
 FileOutputBuffer::~FileOutputBuffer() {
+  // the memory belongs to the caller
+  if (Memory == m_Mode)
+    return;
+
+  if (MMap != m_Mode) {
+    commit();
+    std::free(m_pData);
+    return;
+  }
+
   // Unmap buffer, letting OS flush dirty pages to file on disk.
   m_pRegion.reset();
 }
@@ -25,35 +151,173 @@ FileOutputBuffer::~FileOutputBuffer() {
 std::error_code
 FileOutputBuffer::create(FileHandle& pFileHandle,
                          size_t pSize,
-                         std::unique_ptr<FileOutputBuffer>& pResult) {
+                         std::unique_ptr<FileOutputBuffer>& pResult,
+                         Mode pMode) {
+  // the memory mode has no file
+  if (Memory == pMode)
+    return std::make_error_code(std::errc::invalid_argument);
+
   std::error_code ec;
 
-  // Resize the file before mapping the file region.
+  // Resize the file before mapping the file region. A new or truncated
+  // output is empty, so it reads as zeros after that.
+  bool zero_file = (pFileHandle.size() == 0);
   ec = llvm::sys::fs::resize_file(pFileHandle.handler(), pSize);
   if (ec)
     return ec;
 
+  if (MMap != pMode) {
+    // calloc gets large blocks from the system, which are zeroed lazily
+    uint8_t* data = static_cast<uint8_t*>(std::calloc(pSize + 1, 1));
+    if (data == NULL)
+      return std::make_error_code(std::errc::not_enough_memory);
+    pResult.reset(
+        new FileOutputBuffer(data, pSize, &pFileHandle, pMode, zero_file));
+    return std::error_code();
+  }
+
   std::unique_ptr<llvm::sys::fs::mapped_file_region> mapped_file(
       new llvm::sys::fs::mapped_file_region(pFileHandle.handler(),
           llvm::sys::fs::mapped_file_region::readwrite, pSize, 0, ec));
   if (ec)
     return ec;
 
-  pResult.reset(new FileOutputBuffer(mapped_file.get(), pFileHandle));
+  pResult.reset(
+      new FileOutputBuffer(mapped_file.get(), pFileHandle, zero_file));
   if (pResult)
     mapped_file.release();
 
   return std::error_code();
 }
 
+std::error_code
+FileOutputBuffer::create(uint8_t* pData,
+                         size_t pSize,
+                         std::unique_ptr<FileOutputBuffer>& pResult) {
+  pResult.reset(new FileOutputBuffer(pData, pSize, NULL, Memory, false));
+  return std::error_code();
+}
+
 MemoryRegion FileOutputBuffer::request(size_t pOffset, size_t pLength) {
   if (pOffset > getBufferSize() || (pOffset + pLength) > getBufferSize())
     return MemoryRegion();
   return MemoryRegion(getBufferStart() + pOffset, pLength);
 }
 
+void FileOutputBuffer::flush(size_t pOffset, size_t pLength) {
+  if ((Stream != m_Mode) || m_bCommitted || (pLength == 0) ||
+      (pOffset + pLength) > getBufferSize())
+    return;
+
+  m_Flushed.push_back(Range(pOffset, pLength));
+  m_Writes.push_back(std::async(std::launch::async, [this, pOffset, pLength]() {
+    return write(pOffset, pLength);
+  }));
+}
+
+std::error_code FileOutputBuffer::write(size_t pOffset, size_t pLength) const {
+  if (m_bZeroFile)
+    return writeSparse(m_pFileHandle->handler(), m_pData, pOffset, pLength);
+  return writeRange(m_pFileHandle->handler(), m_pData, pOffset, pLength);
+}
+
+std::error_code FileOutputBuffer::commit() {
+  if ((MMap == m_Mode) || (Memory == m_Mode) || m_bCommitted)
+    return std::error_code();
+  m_bCommitted = true;
+
+  if (Patch == m_Mode)
+    return commitPatch();
+
+  // write the gaps between the flushed ranges
+  std::sort(m_Flushed.begin(), m_Flushed.end());
+  std::error_code result;
+  size_t begin = 0;
+  for (size_t i = 0; i <= m_Flushed.size(); ++i) {
+    size_t end = (i == m_Flushed.size()) ? m_Size : m_Flushed[i].first;
+    if (end > begin) {
+      std::error_code ec = write(begin, end - begin);
+      if (ec && !result)
+        result = ec;
+    }
+    if (i != m_Flushed.size())
+      begin = std::max(begin, m_Flushed[i].first + m_Flushed[i].second);
+  }
+
+  for (size_t i = 0; i < m_Writes.size(); ++i) {
+    std::error_code ec = m_Writes[i].get();
+    if (ec && !result)
+      result = ec;
+  }
+  m_Writes.clear();
+  m_Flushed.clear();
+  return result;
+}
+
+std::error_code FileOutputBuffer::commitPatch() {
+  std::vector<uint8_t> old(kPatchBlockSize);
+  for (size_t offset = 0; offset < m_Size; offset += kPatchBlockSize) {
+    size_t length = std::min(kPatchBlockSize, m_Size - offset);
+    size_t read =
+        readRange(m_pFileHandle->handler(), old.data(), offset, length);
+    if ((read == length) &&
+        (std::memcmp(old.data(), m_pData + offset, length) == 0))
+      continue;
+
+    std::error_code ec =
+        writeRange(m_pFileHandle->handler(), m_pData, offset, length);
+    if (ec)
+      return ec;
+    m_PatchedSize += length;
+  }
+  return std::error_code();
+}
+
+bool FileOutputBuffer::restore(size_t pOffset, size_t pLength) {
+  if (Patch != m_Mode || pOffset + pLength > m_Size)
+    return false;
+  return readRange(m_pFileHandle->handler(), m_pData + pOffset, pOffset,
+                   pLength) == pLength;
+}
+
+bool FileOutputBuffer::copyFile(const std::string& pPath,
+                                size_t pFromOffset,
+                                size_t pOffset,
+                                size_t pLength) {
+  if (!canCopyFile() || pOffset + pLength > m_Size)
+    return false;
+
+  FileHandle input;
+  if (!input.open(sys::fs::Path(pPath),
+                  FileHandle::OpenMode(FileHandle::ReadOnly),
+                  FileHandle::Permission(FileHandle::System)))
+    return false;
+
+  bool result = true;
+  while (pLength != 0) {
+    ssize_t size = sys::fs::detail::copy_file_range(input.handler(),
+                                                   pFromOffset,
+                                                   m_pFileHandle->handler(),
+                                                   pOffset,
+                                                   pLength);
+    if (size < 0 && errno == EINTR)
+      continue;
+    if (size <= 0) {
+      result = false;
+      break;
+    }
+    pFromOffset += size;
+    pOffset += size;
+    pLength -= size;
+  }
+  input.close();
+  return result;
+}
+
 llvm::StringRef FileOutputBuffer::getPath() const {
-  return m_FileHandle.path().native();
+  if (m_pFileHandle == NULL)
+    return llvm::StringRef();
+  return m_pFileHandle->path().native();
 }
 
 }  // namespace mcld
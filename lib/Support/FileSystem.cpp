@@ -10,19 +10,57 @@
 #include "mcld/Support/FileSystem.h"
 #include "mcld/Support/Path.h"
 
+#include <llvm/ADT/StringMap.h>
+
+#include <mutex>
+
 //===----------------------------------------------------------------------===//
-// non-member functions
+// Helper Functions
 //===----------------------------------------------------------------------===//
-bool mcld::sys::fs::exists(const Path& pPath) {
+namespace {
+
+/// getStatusMutex, getStatusCache - the status of each path asked by exists
+/// and is_directory in this process. Inputs, -L directories and INPUT
+/// commands name the same paths again and again, and a stat is slow on a
+/// network file system.
+std::mutex& getStatusMutex() {
+  static std::mutex* mutex = new std::mutex();
+  return *mutex;
+}
+
+llvm::StringMap<mcld::sys::fs::FileStatus>& getStatusCache() {
+  static llvm::StringMap<mcld::sys::fs::FileStatus>* cache =
+      new llvm::StringMap<mcld::sys::fs::FileStatus>();
+  return *cache;
+}
+
+/// cachedStatus - stat pPath once, and give the same status afterwards
+mcld::sys::fs::FileStatus cachedStatus(const mcld::sys::fs::Path& pPath) {
+  std::lock_guard<std::mutex> lock(getStatusMutex());
+  llvm::StringMap<mcld::sys::fs::FileStatus>::iterator entry =
+      getStatusCache().find(pPath.native());
+  if (entry != getStatusCache().end())
+    return entry->getValue();
+
   mcld::sys::fs::FileStatus file_status;
   mcld::sys::fs::detail::status(pPath, file_status);
+  getStatusCache()[pPath.native()] = file_status;
+  return file_status;
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// non-member functions
+//===----------------------------------------------------------------------===//
+bool mcld::sys::fs::exists(const Path& pPath) {
+  mcld::sys::fs::FileStatus file_status = cachedStatus(pPath);
   return (file_status.type() != mcld::sys::fs::StatusError) &&
          (file_status.type() != mcld::sys::fs::FileNotFound);
 }
 
 bool mcld::sys::fs::is_directory(const Path& pPath) {
-  FileStatus file_status;
-  detail::status(pPath, file_status);
+  FileStatus file_status = cachedStatus(pPath);
   return (file_status.type() == mcld::sys::fs::DirectoryFile);
 }
 
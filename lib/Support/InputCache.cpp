@@ -0,0 +1,154 @@
+//===- InputCache.cpp -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Support/InputCache.h"
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+#include <memory>
+#include <mutex>
+#include <set>
+
+namespace mcld {
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+struct Entry {
+  llvm::sys::fs::file_status status;
+  std::unique_ptr<llvm::MemoryBuffer> buffer;
+};
+
+struct Cache {
+  std::mutex lock;
+  bool enabled;
+  llvm::StringMap<Entry> entries;
+  std::vector<std::string> misses;
+  std::set<std::string> recorded;
+
+  Cache() : enabled(false) {}
+};
+
+Cache& getCache() {
+  static Cache cache;
+  return cache;
+}
+
+/// isSameFile - pA and pB are the status of the same unchanged file
+bool isSameFile(const llvm::sys::fs::file_status& pA,
+                const llvm::sys::fs::file_status& pB) {
+  return pA.getUniqueID() == pB.getUniqueID() &&
+         pA.getSize() == pB.getSize() &&
+         pA.getLastModificationTime() == pB.getLastModificationTime();
+}
+
+/// isCacheable - only the files which rarely change between links are worth
+/// keeping: the shared objects and the archives.
+bool isCacheable(llvm::StringRef pContent) {
+  if (pContent.startswith("!<arch>\n") || pContent.startswith("!<thin>\n"))
+    return true;
+
+  // e_ident[EI_DATA] gives the byte order of e_type
+  if (pContent.size() < 18 || !pContent.startswith("\x7f" "ELF"))
+    return false;
+  unsigned char low = pContent[5] == 2 ? pContent[17] : pContent[16];
+  unsigned char high = pContent[5] == 2 ? pContent[16] : pContent[17];
+  return low == 3 /* ET_DYN */ && high == 0;
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// InputCache
+//===----------------------------------------------------------------------===//
+void InputCache::Enable(bool pEnable) {
+  Cache& cache = getCache();
+  std::lock_guard<std::mutex> guard(cache.lock);
+  cache.enabled = pEnable;
+  if (!pEnable) {
+    cache.entries.clear();
+    cache.misses.clear();
+    cache.recorded.clear();
+  }
+}
+
+bool InputCache::IsEnabled() {
+  Cache& cache = getCache();
+  std::lock_guard<std::mutex> guard(cache.lock);
+  return cache.enabled;
+}
+
+const llvm::MemoryBuffer* InputCache::Lookup(llvm::StringRef pPath) {
+  Cache& cache = getCache();
+  std::lock_guard<std::mutex> guard(cache.lock);
+  if (!cache.enabled)
+    return NULL;
+
+  llvm::StringMap<Entry>::iterator entry = cache.entries.find(pPath);
+  if (entry == cache.entries.end())
+    return NULL;
+
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(pPath, status) ||
+      !isSameFile(status, entry->getValue().status)) {
+    cache.entries.erase(entry);
+    return NULL;
+  }
+  return entry->getValue().buffer.get();
+}
+
+bool InputCache::Load(llvm::StringRef pPath) {
+  if (Lookup(pPath) != NULL)
+    return true;
+
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(pPath, status) ||
+      status.type() != llvm::sys::fs::file_type::regular_file)
+    return false;
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer> > buffer_or_error =
+      llvm::MemoryBuffer::getFile(pPath,
+                                  /*FileSize*/ -1,
+                                  /*RequiresNullTerminator*/ false);
+  if (!buffer_or_error ||
+      !isCacheable(buffer_or_error.get()->getBuffer()))
+    return false;
+
+  Cache& cache = getCache();
+  std::lock_guard<std::mutex> guard(cache.lock);
+  if (!cache.enabled)
+    return false;
+  Entry& entry = cache.entries[pPath];
+  entry.status = status;
+  entry.buffer = std::move(buffer_or_error.get());
+  return true;
+}
+
+void InputCache::RecordMiss(llvm::StringRef pPath) {
+  Cache& cache = getCache();
+  std::lock_guard<std::mutex> guard(cache.lock);
+  if (cache.enabled && cache.recorded.insert(pPath.str()).second)
+    cache.misses.push_back(pPath.str());
+}
+
+const std::vector<std::string>& InputCache::GetMisses() {
+  return getCache().misses;
+}
+
+size_t InputCache::size() {
+  Cache& cache = getCache();
+  std::lock_guard<std::mutex> guard(cache.lock);
+  return cache.entries.size();
+}
+
+}  // namespace mcld
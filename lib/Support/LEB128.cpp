@@ -8,10 +8,53 @@
 //===----------------------------------------------------------------------===//
 #include "mcld/Support/LEB128.h"
 
+#include <llvm/Support/Host.h>
+#include <llvm/Support/MathExtras.h>
+#include <llvm/Support/SwapByteOrder.h>
+
+#include <cstring>
+
 namespace mcld {
 
 namespace leb128 {
 
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// decodeWord - decode the ULEB128 integer at pBuf from the 8 bytes there.
+/// Return false if the integer is longer than 8 bytes.
+bool decodeWord(const ByteType*& pBuf, uint64_t& pValue) {
+  uint64_t word;
+  std::memcpy(&word, pBuf, sizeof(word));
+  if (!llvm::sys::IsLittleEndianHost)
+    word = llvm::sys::getSwappedBytes(word);
+
+  // the last byte of an integer is the first one without the high bit
+  uint64_t stops = ~word & 0x8080808080808080ULL;
+  if (stops == 0)
+    return false;
+  unsigned int length = (llvm::countTrailingZeros(stops) >> 3) + 1;
+  if (length < 8)
+    word &= (UINT64_C(1) << (length * 8)) - 1;
+
+  // squeeze the 7-bit groups together, doubling their width at each step
+  word &= 0x7f7f7f7f7f7f7f7fULL;
+  word = ((word & 0x7f007f007f007f00ULL) >> 1) |
+         (word & 0x007f007f007f007fULL);
+  word = ((word & 0x3fff00003fff0000ULL) >> 2) |
+         (word & 0x00003fff00003fffULL);
+  word = ((word & 0x0fffffff00000000ULL) >> 4) |
+         (word & 0x000000000fffffffULL);
+
+  pValue = word;
+  pBuf += length;
+  return true;
+}
+
+}  // anonymous namespace
+
 //===---------------------- LEB128 Encoding APIs -------------------------===//
 template <>
 size_t encode<uint64_t>(ByteType*& pBuf, uint64_t pValue) {
@@ -90,6 +133,17 @@ size_t encode<int32_t>(ByteType*& pBuf, int32_t pValue) {
   return encode<int64_t>(pBuf, static_cast<int64_t>(pValue));
 }
 
+template <>
+size_t size<int64_t>(int64_t pValue) {
+  size_t size = 1;
+  // the last byte keeps the sign in its bit 6
+  while (pValue < -0x40 || pValue >= 0x40) {
+    pValue >>= 7;
+    ++size;
+  }
+  return size;
+}
+
 //===---------------------- LEB128 Decoding APIs -------------------------===//
 
 template <>
@@ -220,5 +274,41 @@ int64_t decode<int64_t>(const ByteType*& pBuf) {
   return result;
 }
 
+
+size_t decodeBatch(const ByteType*& pBuf,
+                   const ByteType* pEnd,
+                   uint64_t* pValues,
+                   size_t pCount) {
+  size_t num = 0;
+  while (num < pCount) {
+    // most integers in the object files are small
+    if (pBuf != pEnd && (*pBuf & 0x80) == 0) {
+      pValues[num++] = *pBuf++;
+      continue;
+    }
+    if (pEnd - pBuf >= 8 && decodeWord(pBuf, pValues[num])) {
+      ++num;
+      continue;
+    }
+
+    // a long integer, or one near the end of the buffer
+    const ByteType* cur = pBuf;
+    uint64_t result = 0;
+    unsigned shift = 0;
+    ByteType byte = 0x80;
+    while (cur != pEnd && (byte & 0x80) != 0) {
+      byte = *cur++;
+      if (shift < 64)
+        result |= (static_cast<uint64_t>(byte & 0x7f) << shift);
+      shift += 7;
+    }
+    if ((byte & 0x80) != 0)
+      break;
+    pValues[num++] = result;
+    pBuf = cur;
+  }
+  return num;
+}
+
 }  // namespace leb128
 }  // namespace mcld
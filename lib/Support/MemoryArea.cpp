@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include "mcld/Support/MemoryArea.h"
+#include "mcld/Support/InputCache.h"
 #include "mcld/Support/MsgHandling.h"
 
 #include <llvm/Support/ErrorOr.h>
@@ -20,6 +21,14 @@ namespace mcld {
 // MemoryArea
 //===--------------------------------------------------------------------===//
 MemoryArea::MemoryArea(llvm::StringRef pFilename) {
+  // a link server keeps the unchanged libraries resident, share its copy
+  if (const llvm::MemoryBuffer* cached = InputCache::Lookup(pFilename)) {
+    m_pMemoryBuffer =
+        llvm::MemoryBuffer::getMemBuffer(cached->getMemBufferRef(),
+                                         /*RequiresNullTerminator*/ false);
+    return;
+  }
+
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer> > buffer_or_error =
       llvm::MemoryBuffer::getFile(pFilename,
                                   /*FileSize*/ -1,
@@ -28,6 +37,8 @@ MemoryArea::MemoryArea(llvm::StringRef pFilename) {
     fatal(diag::fatal_cannot_read_input) << pFilename.str();
   }
   m_pMemoryBuffer = std::move(buffer_or_error.get());
+  m_Path = pFilename.str();
+  InputCache::RecordMiss(pFilename);
 }
 
 MemoryArea::MemoryArea(const char* pMemBuffer, size_t pSize) {
@@ -38,6 +49,11 @@ MemoryArea::MemoryArea(const char* pMemBuffer, size_t pSize) {
                                        /*RequiresNullTerminator*/ false);
 }
 
+MemoryArea::MemoryArea(std::unique_ptr<llvm::MemoryBuffer> pBuffer,
+                       llvm::StringRef pFilename)
+    : m_pMemoryBuffer(std::move(pBuffer)), m_Path(pFilename.str()) {
+}
+
 llvm::StringRef MemoryArea::request(size_t pOffset, size_t pLength) {
   return llvm::StringRef(m_pMemoryBuffer->getBufferStart() + pOffset, pLength);
 }
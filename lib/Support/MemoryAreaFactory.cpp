@@ -7,8 +7,14 @@
 //
 //===----------------------------------------------------------------------===//
 #include "mcld/Support/MemoryAreaFactory.h"
+#include "mcld/Support/InputCache.h"
 #include "mcld/Support/MsgHandling.h"
 #include "mcld/Support/SystemUtils.h"
+#include "mcld/Support/ThreadPool.h"
+
+#include <llvm/ADT/StringSet.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/FileSystem.h>
 
 namespace mcld {
 
@@ -24,29 +30,41 @@ MemoryAreaFactory::~MemoryAreaFactory() {
 
 MemoryArea* MemoryAreaFactory::produce(const sys::fs::Path& pPath,
                                        FileHandle::OpenMode pMode) {
-  llvm::StringRef name(pPath.native());
-  if (m_AreaMap.find(name) == m_AreaMap.end()) {
-    MemoryArea* result = allocate();
-    new (result) MemoryArea(name);
-    m_AreaMap[name] = result;
-    return result;
-  }
-
-  return m_AreaMap[name];
+  return produceFile(pPath.native());
 }
 
 MemoryArea* MemoryAreaFactory::produce(const sys::fs::Path& pPath,
                                        FileHandle::OpenMode pMode,
                                        FileHandle::Permission pPerm) {
-  llvm::StringRef name(pPath.native());
-  if (m_AreaMap.find(name) == m_AreaMap.end()) {
-    MemoryArea* result = allocate();
-    new (result) MemoryArea(name);
-    m_AreaMap[name] = result;
-    return result;
+  return produceFile(pPath.native());
+}
+
+MemoryArea* MemoryAreaFactory::produceFile(llvm::StringRef pName) {
+  llvm::StringMap<MemoryArea*>::iterator area = m_AreaMap.find(pName);
+  if (area != m_AreaMap.end())
+    return area->second;
+
+  // the same file given by another path, e.g., through a symbolic link or a
+  // response file, shares the mapping of the first path.
+  llvm::sys::fs::UniqueID id;
+  bool has_id = !llvm::sys::fs::getUniqueID(pName, id);
+  if (has_id) {
+    std::map<llvm::sys::fs::UniqueID, MemoryArea*>::iterator file =
+        m_FileMap.find(id);
+    if (file != m_FileMap.end()) {
+      m_AreaMap[pName] = file->second;
+      return file->second;
+    }
   }
 
-  return m_AreaMap[name];
+  MemoryArea* result = allocate();
+  new (result) MemoryArea(pName);
+  // inputs are mostly read from front to back
+  result->advise(0, result->size(), MemoryArea::Sequential);
+  m_AreaMap[pName] = result;
+  if (has_id)
+    m_FileMap[id] = result;
+  return result;
 }
 
 MemoryArea* MemoryAreaFactory::produce(void* pMemBuffer, size_t pSize) {
@@ -67,6 +85,59 @@ MemoryArea* MemoryAreaFactory::produce(int pFD, FileHandle::OpenMode pMode) {
   return NULL;
 }
 
+void MemoryAreaFactory::prefetch(const std::vector<sys::fs::Path>& pPaths,
+                                 ThreadPool& pPool) {
+  // the files shared with a link server are not read again
+  std::vector<std::string> names;
+  llvm::StringSet<> seen;
+  std::vector<sys::fs::Path>::const_iterator path, pathEnd = pPaths.end();
+  for (path = pPaths.begin(); path != pathEnd; ++path) {
+    const std::string& name = path->native();
+    if (m_AreaMap.count(name) != 0 || !seen.insert(name).second ||
+        InputCache::Lookup(name) != NULL)
+      continue;
+    names.push_back(name);
+  }
+  if (names.empty())
+    return;
+
+  // only the reads run on the pool. GCFactory is not thread-safe
+  std::vector<std::unique_ptr<llvm::MemoryBuffer> > buffers(names.size());
+  std::vector<llvm::sys::fs::UniqueID> ids(names.size());
+  std::vector<char> has_id(names.size(), 0);
+  parallelFor(pPool, 0, names.size(), [&](size_t pIndex) {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer> > buffer_or_error =
+        llvm::MemoryBuffer::getFile(names[pIndex],
+                                    /*FileSize*/ -1,
+                                    /*RequiresNullTerminator*/ false);
+    if (!buffer_or_error)
+      return;
+    buffers[pIndex] = std::move(buffer_or_error.get());
+    has_id[pIndex] = !llvm::sys::fs::getUniqueID(names[pIndex], ids[pIndex]);
+  });
+
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (!buffers[i])
+      continue;
+    if (has_id[i] != 0) {
+      std::map<llvm::sys::fs::UniqueID, MemoryArea*>::iterator file =
+          m_FileMap.find(ids[i]);
+      if (file != m_FileMap.end()) {
+        m_AreaMap[names[i]] = file->second;
+        continue;
+      }
+    }
+
+    MemoryArea* result = allocate();
+    new (result) MemoryArea(std::move(buffers[i]), names[i]);
+    result->advise(0, result->size(), MemoryArea::Sequential);
+    InputCache::RecordMiss(names[i]);
+    m_AreaMap[names[i]] = result;
+    if (has_id[i] != 0)
+      m_FileMap[ids[i]] = result;
+  }
+}
+
 void MemoryAreaFactory::destruct(MemoryArea* pArea) {
   destroy(pArea);
   deallocate(pArea);
@@ -43,7 +43,11 @@ DiagnosticEngine& getDiagnosticEngine() {
   return *g_pEngine;
 }
 
+/// Diagnose - the phases of a link end here, so the buffered output of the
+/// phase is written out as well
 bool Diagnose() {
+  outs().flush();
+  errs().flush();
   if (g_pEngine->getPrinter()->getNumErrors() > 0) {
     // If we reached here, we are failing ungracefully. Run the interrupt
     // handlers
@@ -0,0 +1,86 @@
+//===- Statistic.cpp ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Support/Statistic.h"
+
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+struct Registry {
+  std::mutex lock;
+  std::vector<const Statistic*> statistics;
+  std::map<std::string, uint64_t> values;
+};
+
+/// getRegistry - the registry is created by the first counter, so it outlives
+/// all the static counters.
+Registry& getRegistry() {
+  static Registry registry;
+  return registry;
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// Statistic
+//===----------------------------------------------------------------------===//
+Statistic::Statistic(const char* pName, const char* pDesc)
+    : m_pName(pName), m_pDesc(pDesc), m_Value(0) {
+  Registry& registry = getRegistry();
+  std::lock_guard<std::mutex> guard(registry.lock);
+  registry.statistics.push_back(this);
+}
+
+Statistic::~Statistic() {
+}
+
+void Statistic::Add(llvm::StringRef pName, uint64_t pValue) {
+#if MCLD_ENABLE_STATS
+  Registry& registry = getRegistry();
+  std::lock_guard<std::mutex> guard(registry.lock);
+  registry.values[pName.str()] += pValue;
+#else
+  (void)pName;
+  (void)pValue;
+#endif
+}
+
+void Statistic::PrintAll(llvm::raw_ostream& pOS) {
+  Registry& registry = getRegistry();
+  std::lock_guard<std::mutex> guard(registry.lock);
+  std::map<std::string, uint64_t> values = registry.values;
+  for (size_t i = 0; i < registry.statistics.size(); ++i)
+    values[registry.statistics[i]->name()] += registry.statistics[i]->value();
+
+  bool header = false;
+  std::map<std::string, uint64_t>::const_iterator value, vEnd = values.end();
+  for (value = values.begin(); value != vEnd; ++value) {
+    if (value->second == 0)
+      continue;
+    if (!header) {
+      pOS << "statistic                           count\n";
+      header = true;
+    }
+    pOS << llvm::format("  %-30s %10llu\n", value->first.c_str(),
+                        static_cast<unsigned long long>(value->second));
+  }
+}
+
+}  // namespace mcld
@@ -0,0 +1,152 @@
+//===- TarWriter.cpp ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Support/TarWriter.h"
+
+#include <llvm/Support/FileSystem.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace mcld {
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+const size_t kBlockSize = 512;
+
+/// UstarHeader - the POSIX ustar header
+struct UstarHeader {
+  char Name[100];
+  char Mode[8];
+  char Uid[8];
+  char Gid[8];
+  char Size[12];
+  char Mtime[12];
+  char Checksum[8];
+  char TypeFlag;
+  char Linkname[100];
+  char Magic[6];
+  char Version[2];
+  char Uname[32];
+  char Gname[32];
+  char DevMajor[8];
+  char DevMinor[8];
+  char Prefix[155];
+  char Pad[12];
+};
+
+/// writeOctal - write pValue in pSize - 1 octal digits and a NUL
+void writeOctal(char* pField, size_t pSize, uint64_t pValue) {
+  snprintf(pField, pSize, "%0*llo", static_cast<int>(pSize - 1),
+           static_cast<unsigned long long>(pValue));
+}
+
+/// getPaxPath - a PAX record of the path. The length of a record counts its
+/// own digits.
+std::string getPaxPath(llvm::StringRef pPath) {
+  size_t size = pPath.size() + std::strlen(" path=\n");
+  size_t total = size + 1;
+  while (std::to_string(total).size() + size > total)
+    ++total;
+  return std::to_string(total) + " path=" + pPath.str() + "\n";
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// TarWriter
+//===----------------------------------------------------------------------===//
+std::error_code TarWriter::create(const std::string& pFile,
+                                  const std::string& pBaseDir,
+                                  std::unique_ptr<TarWriter>& pResult) {
+  int fd;
+  std::error_code ec =
+      llvm::sys::fs::openFileForWrite(pFile, fd, llvm::sys::fs::F_None);
+  if (ec)
+    return ec;
+  pResult.reset(new TarWriter(fd, pBaseDir));
+  return std::error_code();
+}
+
+TarWriter::TarWriter(int pFD, const std::string& pBaseDir)
+    : m_OS(pFD, true), m_BaseDir(pBaseDir) {
+}
+
+TarWriter::~TarWriter() {
+  // the errors are reported by close()
+  m_OS.clear_error();
+}
+
+void TarWriter::append(llvm::StringRef pPath, llvm::StringRef pData) {
+  std::string name = m_BaseDir + "/" + pPath.str();
+  if (!m_Files.insert(name).second)
+    return;
+
+  if (name.size() >= sizeof(UstarHeader().Name)) {
+    std::string record = getPaxPath(name);
+    writeHeader("././@PaxHeader", 'x', record.size());
+    m_OS << record;
+    writePadding(record.size());
+    name.resize(sizeof(UstarHeader().Name) - 1);
+  }
+
+  writeHeader(name, '0', pData.size());
+  m_OS << pData;
+  writePadding(pData.size());
+}
+
+std::error_code TarWriter::close() {
+  // the end of an archive is two zero blocks
+  std::string zeros(kBlockSize * 2, '\0');
+  m_OS << zeros;
+  m_OS.close();
+  if (m_OS.has_error()) {
+    m_OS.clear_error();
+    return std::make_error_code(std::errc::io_error);
+  }
+  return std::error_code();
+}
+
+void TarWriter::writeHeader(llvm::StringRef pName, char pType, uint64_t pSize) {
+  UstarHeader header;
+  std::memset(&header, 0x0, sizeof(header));
+  std::memcpy(header.Name, pName.data(),
+              std::min(pName.size(), sizeof(header.Name) - 1));
+  writeOctal(header.Mode, sizeof(header.Mode), 0644);
+  writeOctal(header.Uid, sizeof(header.Uid), 0);
+  writeOctal(header.Gid, sizeof(header.Gid), 0);
+  writeOctal(header.Size, sizeof(header.Size), pSize);
+  // a fixed mtime keeps the archive reproducible
+  writeOctal(header.Mtime, sizeof(header.Mtime), 0);
+  header.TypeFlag = pType;
+  std::memcpy(header.Magic, "ustar", 6);
+  std::memcpy(header.Version, "00", 2);
+
+  // the checksum is computed with the checksum field filled with spaces
+  std::memset(header.Checksum, ' ', sizeof(header.Checksum));
+  unsigned checksum = 0;
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&header);
+  for (size_t i = 0; i < sizeof(header); ++i)
+    checksum += bytes[i];
+  snprintf(header.Checksum, sizeof(header.Checksum), "%06o", checksum);
+
+  m_OS.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void TarWriter::writePadding(uint64_t pSize) {
+  size_t padding = (kBlockSize - pSize % kBlockSize) % kBlockSize;
+  for (size_t i = 0; i < padding; ++i)
+    m_OS << '\0';
+}
+
+}  // namespace mcld
@@ -20,8 +20,15 @@ Target::Target()
       TripleMatchQualityFn(NULL),
       TargetMachineCtorFn(NULL),
       MCLinkerCtorFn(NULL),
+      EmulationFn(NULL),
       TargetLDBackendCtorFn(NULL),
-      DiagnosticLineInfoCtorFn(NULL) {
+      DiagnosticLineInfoCtorFn(NULL),
+      InitializerFn(NULL) {
+}
+
+void Target::initialize() const {
+  if (InitializerFn != NULL)
+    InitializerFn();
 }
 
 unsigned int Target::getTripleQuality(const llvm::Triple& pTriple) const {
@@ -51,6 +58,8 @@ MCLinker* Target::createMCLinker(const std::string& pTriple,
 /// emulate - given MCLinker default values for the other aspects of the
 /// target system.
 bool Target::emulate(LinkerScript& pScript, LinkerConfig& pConfig) const {
+  if (EmulationFn == NULL)
+    initialize();
   if (EmulationFn == NULL)
     return false;
   return EmulationFn(pScript, pConfig);
@@ -58,6 +67,8 @@ bool Target::emulate(LinkerScript& pScript, LinkerConfig& pConfig) const {
 
 /// createLDBackend - create target-specific LDBackend
 TargetLDBackend* Target::createLDBackend(const LinkerConfig& pConfig) const {
+  if (TargetLDBackendCtorFn == NULL)
+    initialize();
   if (TargetLDBackendCtorFn == NULL)
     return NULL;
   return TargetLDBackendCtorFn(pConfig);
@@ -67,6 +78,8 @@ TargetLDBackend* Target::createLDBackend(const LinkerConfig& pConfig) const {
 DiagnosticLineInfo* Target::createDiagnosticLineInfo(
     const mcld::Target& pTarget,
     const std::string& pTriple) const {
+  if (DiagnosticLineInfoCtorFn == NULL)
+    initialize();
   if (DiagnosticLineInfoCtorFn == NULL)
     return NULL;
   return DiagnosticLineInfoCtorFn(pTarget, pTriple);
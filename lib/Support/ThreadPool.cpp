@@ -0,0 +1,203 @@
+//===- ThreadPool.cpp -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Support/ThreadPool.h"
+#include "mcld/Config/Config.h"
+#include "mcld/Support/Statistic.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#if defined(MCLD_ON_UNIX)
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace mcld {
+
+static Statistic NumTasks("threadpool.tasks",
+                          "Number of tasks queued to the worker threads");
+static Statistic NumHelpedTasks("threadpool.helped-tasks",
+                                "Number of tasks run by a waiting thread");
+
+//===----------------------------------------------------------------------===//
+// ThreadPool::Workers
+//===----------------------------------------------------------------------===//
+/** \class ThreadPool::Workers
+ *  \brief Workers are the threads shared by all pools, and the queue of the
+ *  tasks of every pool.
+ */
+class ThreadPool::Workers {
+ public:
+  Workers() : m_NumReserved(0), m_NumRunning(0) {}
+
+  /// reserve - reserve pNumThreads threads for a pool, and start threads
+  /// until there are enough for all the pools alive
+  void reserve(unsigned pNumThreads);
+
+  /// release - give back the threads of a pool that is gone
+  void release(unsigned pNumThreads);
+
+  void async(ThreadPool& pPool, Task pTask);
+
+  void wait(ThreadPool& pPool);
+
+ private:
+  struct Job {
+    ThreadPool* pool;
+    Task task;
+  };
+
+ private:
+  void work();
+
+  /// finish - count the job of pPool as done. The mutex is held.
+  void finish(ThreadPool& pPool);
+
+ private:
+  std::vector<std::thread> m_Threads;
+  std::deque<Job> m_Jobs;
+  std::mutex m_Mutex;
+  std::condition_variable m_TaskCond;
+  std::condition_variable m_DoneCond;
+  /// m_NumReserved - the threads of the pools alive. No more tasks than that
+  /// run on the workers at once, even if more threads were started for the
+  /// pools before.
+  unsigned m_NumReserved;
+  unsigned m_NumRunning;
+};
+
+void ThreadPool::Workers::reserve(unsigned pNumThreads) {
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_NumReserved += pNumThreads;
+  while (m_Threads.size() < m_NumReserved)
+    m_Threads.push_back(std::thread(&Workers::work, this));
+  m_TaskCond.notify_all();
+}
+
+void ThreadPool::Workers::release(unsigned pNumThreads) {
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_NumReserved -= pNumThreads;
+}
+
+void ThreadPool::Workers::async(ThreadPool& pPool, Task pTask) {
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    Job job = { &pPool, std::move(pTask) };
+    m_Jobs.push_back(std::move(job));
+    ++pPool.m_NumPending;
+  }
+  m_TaskCond.notify_one();
+  ++NumTasks;
+}
+
+void ThreadPool::Workers::wait(ThreadPool& pPool) {
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  while (pPool.m_NumPending != 0) {
+    // help with the queued tasks of pPool before sleeping on them
+    std::deque<Job>::iterator job, jobEnd = m_Jobs.end();
+    for (job = m_Jobs.begin(); job != jobEnd; ++job) {
+      if (job->pool == &pPool)
+        break;
+    }
+    if (job == jobEnd) {
+      m_DoneCond.wait(lock);
+      continue;
+    }
+
+    Task task = std::move(job->task);
+    m_Jobs.erase(job);
+    lock.unlock();
+    task();
+    ++NumHelpedTasks;
+    lock.lock();
+    finish(pPool);
+  }
+}
+
+void ThreadPool::Workers::work() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_TaskCond.wait(lock, [this]() {
+        return !m_Jobs.empty() && (m_NumRunning < m_NumReserved);
+      });
+      job = std::move(m_Jobs.front());
+      m_Jobs.pop_front();
+      ++m_NumRunning;
+    }
+
+    job.task();
+
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      --m_NumRunning;
+      finish(*job.pool);
+    }
+    m_TaskCond.notify_one();
+  }
+}
+
+void ThreadPool::Workers::finish(ThreadPool& pPool) {
+  if (--pPool.m_NumPending == 0)
+    m_DoneCond.notify_all();
+}
+
+//===----------------------------------------------------------------------===//
+// ThreadPool
+//===----------------------------------------------------------------------===//
+ThreadPool::ThreadPool(unsigned pNumThreads)
+    : m_pWorkers(NULL), m_NumThreads(pNumThreads), m_NumPending(0) {
+  if (pNumThreads < 2)
+    return;
+  m_pWorkers = &GetWorkers();
+  m_pWorkers->reserve(pNumThreads);
+}
+
+ThreadPool::~ThreadPool() {
+  if (m_pWorkers == NULL)
+    return;
+  m_pWorkers->wait(*this);
+  m_pWorkers->release(m_NumThreads);
+}
+
+/// GetWorkers - the workers are never deleted, since the idle threads may
+/// still be waiting for tasks when the process exits. A forked child has
+/// none of the threads of its parent, so it starts workers of its own.
+ThreadPool::Workers& ThreadPool::GetWorkers() {
+  static std::mutex mutex;
+  static Workers* workers = NULL;
+  std::unique_lock<std::mutex> lock(mutex);
+#if defined(MCLD_ON_UNIX)
+  static pid_t owner = 0;
+  if (owner != ::getpid())
+    workers = NULL;
+  owner = ::getpid();
+#endif
+  if (workers == NULL)
+    workers = new Workers();
+  return *workers;
+}
+
+void ThreadPool::async(Task pTask) {
+  if (m_pWorkers == NULL) {
+    pTask();
+    return;
+  }
+  m_pWorkers->async(*this, std::move(pTask));
+}
+
+void ThreadPool::wait() {
+  if (m_pWorkers != NULL)
+    m_pWorkers->wait(*this);
+}
+
+}  // namespace mcld
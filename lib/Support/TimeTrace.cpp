@@ -0,0 +1,159 @@
+//===- TimeTrace.cpp ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Support/TimeTrace.h"
+#include "mcld/Support/SystemUtils.h"
+
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace mcld {
+
+static TimeTrace* g_pCurrentTrace = NULL;
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// printString - print pString as a JSON string
+void printString(llvm::raw_ostream& pOS, llvm::StringRef pString) {
+  const char* escape = "\\u%04x";
+  pOS << '"';
+  for (size_t i = 0; i < pString.size(); ++i) {
+    unsigned char c = pString[i];
+    if (c == '"' || c == '\\')
+      pOS << '\\' << c;
+    else if (c < 0x20)
+      pOS << llvm::format(escape, static_cast<unsigned>(c));
+    else
+      pOS << c;
+  }
+  pOS << '"';
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// TimeTrace::Scope
+//===----------------------------------------------------------------------===//
+TimeTrace::Scope::Scope(const char* pName) : m_pName(pName), m_Begin(0) {
+  if (g_pCurrentTrace != NULL)
+    m_Begin = g_pCurrentTrace->now();
+}
+
+TimeTrace::Scope::~Scope() {
+  if (g_pCurrentTrace == NULL)
+    return;
+  g_pCurrentTrace->addEvent(m_pName, m_Begin,
+                            g_pCurrentTrace->now() - m_Begin);
+  if (g_pCurrentTrace->m_PhaseHook)
+    g_pCurrentTrace->m_PhaseHook(m_pName);
+}
+
+//===----------------------------------------------------------------------===//
+// TimeTrace
+//===----------------------------------------------------------------------===//
+TimeTrace::TimeTrace() : m_Start(std::chrono::steady_clock::now()) {
+}
+
+TimeTrace::~TimeTrace() {
+  if (g_pCurrentTrace == this)
+    g_pCurrentTrace = NULL;
+}
+
+TimeTrace* TimeTrace::Current() {
+  return g_pCurrentTrace;
+}
+
+void TimeTrace::SetCurrent(TimeTrace* pTrace) {
+  g_pCurrentTrace = pTrace;
+}
+
+uint64_t TimeTrace::now() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - m_Start).count();
+}
+
+void TimeTrace::addEvent(llvm::StringRef pName,
+                         uint64_t pBegin,
+                         uint64_t pDuration) {
+  Event event;
+  event.name = pName;
+  event.begin = pBegin;
+  event.duration = pDuration;
+  event.instant = false;
+  m_Events.push_back(event);
+}
+
+void TimeTrace::addInstant(llvm::StringRef pName,
+                           llvm::StringRef pDetail,
+                           const Args& pArgs) {
+  Event event;
+  event.name = pName;
+  event.begin = now();
+  event.duration = 0;
+  event.instant = true;
+  event.detail = pDetail;
+  event.args = pArgs;
+  m_Events.push_back(event);
+}
+
+void TimeTrace::addCount(llvm::StringRef pName, uint64_t pValue) {
+  m_Counts.push_back(Count(pName, pValue));
+}
+
+void TimeTrace::printChromeTrace(llvm::raw_ostream& pOS) const {
+  pOS << "{\"traceEvents\":[\n";
+  for (size_t i = 0; i < m_Events.size(); ++i) {
+    const Event& event = m_Events[i];
+    // the names of the events are plain identifiers, no escaping is needed
+    pOS << "{\"name\":\"" << event.name << "\",";
+    if (!event.instant) {
+      pOS << "\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":" << event.begin
+          << ",\"dur\":" << event.duration << "},\n";
+      continue;
+    }
+
+    // the details, such as the paths of inputs, are escaped
+    pOS << "\"ph\":\"i\",\"s\":\"p\",\"pid\":1,\"tid\":0,\"ts\":"
+        << event.begin << ",\"args\":{\"detail\":";
+    printString(pOS, event.detail);
+    for (size_t j = 0; j < event.args.size(); ++j)
+      pOS << ",\"" << event.args[j].first << "\":" << event.args[j].second;
+    pOS << "}},\n";
+  }
+
+  // the counters are shown at the end of the link
+  pOS << "{\"name\":\"stats\",\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":"
+      << now() << ",\"args\":{\"peak RSS\":" << sys::GetPeakRSS();
+  for (size_t i = 0; i < m_Counts.size(); ++i)
+    pOS << ",\"" << m_Counts[i].first << "\":" << m_Counts[i].second;
+  pOS << "}}\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void TimeTrace::printSummary(llvm::raw_ostream& pOS) const {
+  pOS << "phase                            time (ms)\n";
+  for (size_t i = 0; i < m_Events.size(); ++i) {
+    if (m_Events[i].instant)
+      continue;
+    pOS << llvm::format("  %-30s %10.3f\n", m_Events[i].name.c_str(),
+                        m_Events[i].duration / 1000.0);
+  }
+  const char* total = "total";
+  pOS << llvm::format("  %-30s %10.3f\n", total, now() / 1000.0);
+
+  pOS << llvm::format("peak RSS: %.1f MiB\n",
+                      sys::GetPeakRSS() / (1024.0 * 1024.0));
+  for (size_t i = 0; i < m_Counts.size(); ++i) {
+    pOS << llvm::format("  %-30s %10llu\n", m_Counts[i].first.c_str(),
+                        static_cast<unsigned long long>(m_Counts[i].second));
+  }
+}
+
+}  // namespace mcld
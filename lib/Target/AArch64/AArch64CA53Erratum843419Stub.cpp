@@ -52,7 +52,8 @@ bool AArch64CA53Erratum843419Stub::isErratum843419Sequence(unsigned insn1,
   unsigned rt2;
   bool is_pair;
   bool is_load;
-  return AArch64InsnHelpers::isMemOp(insn2, rt, rt2, is_pair, is_load) &&
+  return AArch64InsnHelpers::isADRP(insn1) &&
+         AArch64InsnHelpers::isMemOp(insn2, rt, rt2, is_pair, is_load) &&
          (!is_pair || (is_pair && !is_load)) &&
          AArch64InsnHelpers::isLDSTUIMM(insn3) &&
          (AArch64InsnHelpers::getRn(insn3) == AArch64InsnHelpers::getRd(insn1));
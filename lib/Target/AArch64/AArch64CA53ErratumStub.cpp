@@ -66,6 +66,11 @@ bool AArch64CA53ErratumStub::isMyDuty(const FragmentRef& pFragRef) const {
   return false;
 }
 
+bool AArch64CA53ErratumStub::getDutyTypes(std::vector<Type>& pTypes) const {
+  // the erratum stubs only fix the code sequences
+  return true;
+}
+
 void AArch64CA53ErratumStub::applyFixup(FragmentRef& pSrcFragRef,
                                         IRBuilder& pBuilder,
                                         BranchIsland& pIsland) {
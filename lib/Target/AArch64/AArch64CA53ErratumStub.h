@@ -35,6 +35,8 @@ class AArch64CA53ErratumStub : public Stub {
 
   bool isMyDuty(const FragmentRef& pFragRef) const;
 
+  bool getDutyTypes(std::vector<Type>& pTypes) const;
+
   void applyFixup(FragmentRef& pSrcFragRef,
                   IRBuilder& pBuilder,
                   BranchIsland& pIsland);
@@ -133,6 +133,10 @@ class AArch64InsnHelpers {
   }
 
   // Return true if INSN is a mac insn.
+  static bool isADRP(InsnType insn) {
+    return (insn & 0x9f000000) == 0x90000000;
+  }
+
   static bool isMAC(InsnType insn) {
     return (insn & 0xff000000) == 0x9b000000;
   }
@@ -269,6 +273,50 @@ class AArch64InsnHelpers {
     return 0x14000000;
   }
 
+  static InsnType buildNopInsn() {
+    return 0xd503201f;
+  }
+
+  // movz xd, #0, lsl #pShift
+  static InsnType buildMovzInsn(unsigned rd, unsigned pShift) {
+    return 0xd2800000 | ((pShift / 16) << 21) | rd;
+  }
+
+  // movk xd, #0
+  static InsnType buildMovkInsn(unsigned rd) {
+    return 0xf2800000 | rd;
+  }
+
+  // adrp xd, #0
+  static InsnType buildAdrpInsn(unsigned rd) {
+    return 0x90000000 | rd;
+  }
+
+  // adr xd, #0
+  static InsnType buildAdrInsn(unsigned rd) {
+    return 0x10000000 | rd;
+  }
+
+  // add xd, xn, #0
+  static InsnType buildAddInsn(unsigned rd, unsigned rn) {
+    return 0x91000000 | (rn << 5) | rd;
+  }
+
+  // ldr xt, [xn, #0]
+  static InsnType buildLdrInsn(unsigned rt, unsigned rn) {
+    return 0xf9400000 | (rn << 5) | rt;
+  }
+
+  // ldr wt, [xn, #0]
+  static InsnType buildLdrWInsn(unsigned rt, unsigned rn) {
+    return 0xb9400000 | (rn << 5) | rt;
+  }
+
+  // ldr xt, #0 and ldr wt, #0
+  static InsnType buildLdrLiteralInsn(unsigned rt, bool pIs64) {
+    return (pIs64 ? 0x58000000 : 0x18000000) | rt;
+  }
+
  private:
   DISALLOW_IMPLICIT_CONSTRUCTORS(AArch64InsnHelpers);
 };
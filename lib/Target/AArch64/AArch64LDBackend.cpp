@@ -23,6 +23,7 @@
 #include "mcld/Fragment/FillFragment.h"
 #include "mcld/Fragment/NullFragment.h"
 #include "mcld/Fragment/RegionFragment.h"
+#include "mcld/Fragment/Relocation.h"
 #include "mcld/Fragment/Stub.h"
 #include "mcld/LD/BranchIslandFactory.h"
 #include "mcld/LD/ELFFileFormat.h"
@@ -34,6 +35,7 @@
 #include "mcld/Support/MemoryArea.h"
 #include "mcld/Support/MsgHandling.h"
 #include "mcld/Support/TargetRegistry.h"
+#include "mcld/Support/ThreadPool.h"
 #include "mcld/Target/ELFAttribute.h"
 #include "mcld/Target/GNUInfo.h"
 #include "mcld/Object/ObjectBuilder.h"
@@ -43,7 +45,9 @@
 #include <llvm/Support/Casting.h>
 #include <llvm/Support/ELF.h>
 
+#include <algorithm>
 #include <cstring>
+#include <vector>
 
 namespace mcld {
 
@@ -60,7 +64,8 @@ AArch64GNULDBackend::AArch64GNULDBackend(const LinkerConfig& pConfig,
       m_pRelaDyn(NULL),
       m_pRelaPLT(NULL),
       m_pDynamic(NULL),
-      m_pGOTSymbol(NULL) {
+      m_pGOTSymbol(NULL),
+      m_bCollectedBranches(false) {
 }
 
 AArch64GNULDBackend::~AArch64GNULDBackend() {
@@ -109,7 +114,7 @@ void AArch64GNULDBackend::initTargetSections(Module& pModule,
 
     // initialize .plt
     LDSection& plt = file_format->getPLT();
-    m_pPLT = new AArch64PLT(plt, *m_pGOTPLT);
+    m_pPLT = new AArch64PLT(plt, *m_pGOTPLT, !config().options().hasNow());
 
     // initialize .rela.plt
     LDSection& relaplt = file_format->getRelaPlt();
@@ -232,6 +237,10 @@ void AArch64GNULDBackend::doPreLayout(IRBuilder& pBuilder) {
   }
 }
 
+bool AArch64GNULDBackend::isRelativeReloc(const Relocation& pReloc) const {
+  return (llvm::ELF::R_AARCH64_RELATIVE == pReloc.type());
+}
+
 void AArch64GNULDBackend::doPostLayout(Module& pModule, IRBuilder& pBuilder) {
   const ELFFileFormat* file_format = getOutputFormat();
 
@@ -289,6 +298,22 @@ uint64_t AArch64GNULDBackend::emitSectionData(const LDSection& pSection,
   return pRegion.size();
 }
 
+bool AArch64GNULDBackend::fillCodePadding(uint8_t* pData,
+                                          uint64_t pAddress,
+                                          size_t pSize) const {
+  // the bytes in front of the first word boundary are not code
+  const size_t insn_size = AArch64InsnHelpers::InsnSize;
+  size_t offset = (insn_size - pAddress % insn_size) % insn_size;
+  std::memset(pData, 0x0, std::min(offset, pSize));
+
+  uint32_t nop = AArch64InsnHelpers::buildNopInsn();
+  for (; offset + insn_size <= pSize; offset += insn_size)
+    std::memcpy(pData + offset, &nop, insn_size);
+  if (offset < pSize)
+    std::memset(pData + offset, 0x0, pSize - offset);
+  return true;
+}
+
 unsigned int AArch64GNULDBackend::getTargetSectionOrder(
     const LDSection& pSectHdr) const {
   const ELFFileFormat* file_format = getOutputFormat();
@@ -308,53 +333,140 @@ unsigned int AArch64GNULDBackend::getTargetSectionOrder(
   return SHO_UNDEFINED;
 }
 
+/// findErratumCandidates - collect the offsets of the instructions of
+/// pFrag which may start an erratum sequence. Only these are handed to the
+/// stub prototypes. pFrag is only read, so fragments are scanned in parallel.
+static void findErratumCandidates(const RegionFragment& pFrag,
+                                  bool pFix835769,
+                                  bool pFix843419,
+                                  std::vector<uint32_t>& pOffsets) {
+  llvm::StringRef region = pFrag.getRegion();
+  const uint64_t vma =
+      pFrag.getParent()->getSection().addr() + pFrag.getOffset();
+  const uint32_t size = region.size() & ~(AArch64InsnHelpers::InsnSize - 1);
+  for (uint32_t offset = 0; offset < size;
+       offset += AArch64InsnHelpers::InsnSize) {
+    // an erratum 843419 sequence starts with an ADRP at 0xFF8 or 0xFFC
+    const unsigned page_offset = (vma + offset) & 0xFFF;
+    if (pFix843419 && (page_offset == 0xFF8 || page_offset == 0xFFC)) {
+      uint32_t insn;
+      std::memcpy(&insn, region.data() + offset, sizeof(insn));
+      if (AArch64InsnHelpers::isADRP(insn)) {
+        pOffsets.push_back(offset);
+        continue;
+      }
+    }
+
+    // an erratum 835769 sequence continues with a multiply-accumulate
+    if (pFix835769 && offset + 2 * AArch64InsnHelpers::InsnSize <= size) {
+      uint32_t insn;
+      std::memcpy(&insn, region.data() + offset + AArch64InsnHelpers::InsnSize,
+                  sizeof(insn));
+      if (AArch64InsnHelpers::isMLXL(insn))
+        pOffsets.push_back(offset);
+    }
+  }
+}
+
 void AArch64GNULDBackend::scanErrata(Module& pModule,
                                      IRBuilder& pBuilder,
                                      size_t& num_new_stubs,
                                      size_t& stubs_strlen) {
   // TODO: Implement AArch64 ErrataStubFactory to create the specific erratum
   //       stub and simplify the logics.
+  std::vector<RegionFragment*> frags;
   for (Module::iterator sect = pModule.begin(), sectEnd = pModule.end();
        sect != sectEnd; ++sect) {
     if (((*sect)->kind() == LDFileFormat::TEXT) && (*sect)->hasSectionData()) {
       SectionData* sd = (*sect)->getSectionData();
       for (SectionData::iterator it = sd->begin(), ie = sd->end(); it != ie;
            ++it) {
-        Fragment* frag = llvm::dyn_cast<RegionFragment>(it);
-        if (frag != NULL) {
-          FragmentRef* frag_ref = FragmentRef::Create(*frag, 0);
-          for (unsigned offset = 0; offset < frag->size();
-               offset += AArch64InsnHelpers::InsnSize) {
-            Stub* stub = getStubFactory()->create(*frag_ref,
-                                                  pBuilder,
-                                                  *getBRIslandFactory());
-            if (stub != NULL) {
-              // A stub symbol should be local
-              assert(stub->symInfo() != NULL && stub->symInfo()->isLocal());
-              const AArch64CA53ErratumStub* erratum_stub =
-                  reinterpret_cast<const AArch64CA53ErratumStub*>(stub);
-              assert(erratum_stub != NULL);
-              // Rewrite the erratum instruction as a branch to the stub.
-              uint64_t offset = frag_ref->offset() +
-                                erratum_stub->getErratumInsnOffset();
-              Relocation* reloc =
-                  Relocation::Create(llvm::ELF::R_AARCH64_JUMP26,
-                                     *(FragmentRef::Create(*frag, offset)),
-                                     /* pAddend */0);
-              reloc->setSymInfo(stub->symInfo());
-              reloc->target() = AArch64InsnHelpers::buildBranchInsn();
-              addExtraRelocation(reloc);
-
-              ++num_new_stubs;
-              stubs_strlen += stub->symInfo()->nameSize() + 1;
-            }
-
-            frag_ref->assign(*frag, offset + AArch64InsnHelpers::InsnSize);
-          }  // for each INSN
-        }
+        RegionFragment* frag = llvm::dyn_cast<RegionFragment>(it);
+        if (frag != NULL)
+          frags.push_back(frag);
       }  // for each FRAGMENT
     }
   }  // for each TEXT section
+
+  // find the candidate sequences of all fragments in parallel, and then create
+  // the stubs in order
+  std::vector<std::vector<uint32_t> > candidates(frags.size());
+  const bool fix835769 = config().targets().fixCA53Erratum835769();
+  const bool fix843419 = config().targets().fixCA53Erratum843419();
+  ThreadPool pool(config().options().numThreads());
+  parallelFor(pool, 0, frags.size(), [&](size_t pIndex) {
+    findErratumCandidates(*frags[pIndex], fix835769, fix843419,
+                          candidates[pIndex]);
+  });
+
+  for (size_t i = 0; i < frags.size(); ++i) {
+    if (candidates[i].empty())
+      continue;
+    RegionFragment* frag = frags[i];
+    FragmentRef* frag_ref = FragmentRef::Create(*frag, 0);
+    std::vector<uint32_t>::const_iterator offset, end = candidates[i].end();
+    for (offset = candidates[i].begin(); offset != end; ++offset) {
+      frag_ref->assign(*frag, *offset);
+      Stub* stub = getStubFactory()->create(*frag_ref,
+                                            pBuilder,
+                                            *getBRIslandFactory());
+      if (stub != NULL) {
+        // A stub symbol should be local
+        assert(stub->symInfo() != NULL && stub->symInfo()->isLocal());
+        const AArch64CA53ErratumStub* erratum_stub =
+            reinterpret_cast<const AArch64CA53ErratumStub*>(stub);
+        assert(erratum_stub != NULL);
+        // Rewrite the erratum instruction as a branch to the stub.
+        uint64_t offset = frag_ref->offset() +
+                          erratum_stub->getErratumInsnOffset();
+        Relocation* reloc =
+            Relocation::Create(llvm::ELF::R_AARCH64_JUMP26,
+                               *(FragmentRef::Create(*frag, offset)),
+                               /* pAddend */0);
+        reloc->setSymInfo(stub->symInfo());
+        reloc->target() = AArch64InsnHelpers::buildBranchInsn();
+        addExtraRelocation(reloc);
+
+        ++num_new_stubs;
+        stubs_strlen += stub->symInfo()->nameSize() + 1;
+      }
+    }  // for each candidate
+  }
+}
+
+void AArch64GNULDBackend::collectBranches(Module& pModule) {
+  Module::obj_iterator input, inEnd = pModule.obj_end();
+  for (input = pModule.obj_begin(); input != inEnd; ++input) {
+    LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
+    for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+        continue;
+      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+        Relocation* relocation = llvm::cast<Relocation>(reloc);
+        if ((relocation->type() == llvm::ELF::R_AARCH64_CALL26) ||
+            (relocation->type() == llvm::ELF::R_AARCH64_JUMP26)) {
+          BranchReloc branch = {relocation, 0, 0};
+          m_Branches.push_back(branch);
+        }
+      }  // for all relocations
+    }  // for all relocation section
+  }  // for all inputs
+  m_bCollectedBranches = true;
+}
+
+uint64_t AArch64GNULDBackend::getBranchTarget(const Relocation& pReloc) const {
+  // FIXME: we need to find out the address of the specific plt entry
+  if ((pReloc.symInfo()->reserved() & AArch64Relocator::ReservePLT) != 0x0) {
+    assert(getOutputFormat()->hasPLT());
+    return getOutputFormat()->getPLT().addr();
+  }
+
+  const LDSymbol* symbol = pReloc.symInfo()->outSymbol();
+  if (!symbol->hasFragRef())
+    return 0x0;
+  return symbol->fragRef()->frag()->getParent()->getSection().addr() +
+         symbol->fragRef()->getOutputOffset();
 }
 
 bool AArch64GNULDBackend::doRelax(Module& pModule,
@@ -372,61 +484,55 @@ bool AArch64GNULDBackend::doRelax(Module& pModule,
     scanErrata(pModule, pBuilder, num_new_stubs, stubs_strlen);
   }
 
+  // check branch relocs and create the related stubs if needed. The first
+  // pass may add stubs to the branches close to their range as well.
   ELFFileFormat* file_format = getOutputFormat();
-  // check branch relocs and create the related stubs if needed
-  Module::obj_iterator input, inEnd = pModule.obj_end();
-  for (input = pModule.obj_begin(); input != inEnd; ++input) {
-    LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
-    for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
-      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
-        continue;
-      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
-      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
-        Relocation* relocation = llvm::cast<Relocation>(reloc);
-
-        switch (relocation->type()) {
-          case llvm::ELF::R_AARCH64_CALL26:
-          case llvm::ELF::R_AARCH64_JUMP26: {
-            // calculate the possible symbol value
-            uint64_t sym_value = 0x0;
-            LDSymbol* symbol = relocation->symInfo()->outSymbol();
-            if (symbol->hasFragRef()) {
-              uint64_t value = symbol->fragRef()->getOutputOffset();
-              uint64_t addr =
-                  symbol->fragRef()->frag()->getParent()->getSection().addr();
-              sym_value = addr + value;
-            }
-            if ((relocation->symInfo()->reserved() &
-                 AArch64Relocator::ReservePLT) != 0x0) {
-              // FIXME: we need to find out the address of the specific plt
-              // entry
-              assert(file_format->hasPLT());
-              sym_value = file_format->getPLT().addr();
-            }
-            Stub* stub = getStubFactory()->create(*relocation,  // relocation
-                                                  sym_value,    // symbol value
-                                                  pBuilder,
-                                                  *getBRIslandFactory());
-            if (stub != NULL) {
-              // a stub symbol should be local
-              assert(stub->symInfo() != NULL && stub->symInfo()->isLocal());
-              // reset the branch target of the reloc to this stub instead
-              relocation->setSymInfo(stub->symInfo());
-
-              ++num_new_stubs;
-              stubs_strlen += stub->symInfo()->nameSize() + 1;
-            }
-            break;
-          }
-          default: {
-            break;
-          }
-        }  // end of switch
-      }  // for all relocations
-    }  // for all relocation section
-  }  // for all inputs
+  bool first_pass = !m_bCollectedBranches;
+  uint64_t reserve = 0;
+  if (first_pass) {
+    collectBranches(pModule);
+    reserve = config().targets().getStubReserve();
+  }
+  // the layout is only read to find the prototypes, so the branches are
+  // probed in parallel and their stubs created in order
+  std::vector<Stub*> prototypes(m_Branches.size(), NULL);
+  ThreadPool pool(config().options().numThreads());
+  parallelFor(pool, 0, m_Branches.size(), [&](size_t pIndex) {
+    BranchReloc& branch = m_Branches[pIndex];
+    const Relocation* relocation = branch.reloc;
+    uint64_t place = relocation->place();
+    uint64_t sym_value = getBranchTarget(*relocation);
+    if (!first_pass && place == branch.place && sym_value == branch.target)
+      return;
+    branch.place = place;
+    branch.target = sym_value;
+
+    if (sym_value + relocation->addend() >= place)
+      sym_value += reserve;
+    else
+      sym_value -= reserve;
+    prototypes[pIndex] =
+        getStubFactory()->findPrototype(*relocation, sym_value);
+  });
+
+  for (size_t i = 0; i < m_Branches.size(); ++i) {
+    if (prototypes[i] == NULL)
+      continue;
+    Relocation* relocation = m_Branches[i].reloc;
+    Stub* stub = getStubFactory()->create(
+        *relocation, *prototypes[i], pBuilder, *getBRIslandFactory());
+    if (stub != NULL) {
+      // a stub symbol should be local
+      assert(stub->symInfo() != NULL && stub->symInfo()->isLocal());
+      // reset the branch target of the reloc to this stub instead
+      relocation->setSymInfo(stub->symInfo());
+
+      ++num_new_stubs;
+      stubs_strlen += stub->symInfo()->nameSize() + 1;
+    }
+  }  // for all branch relocations
 
-  // Find the first fragment w/ invalid offset due to stub insertion.
+  // Find the fragments w/ invalid offset due to stub insertion.
   std::vector<Fragment*> invalid_frags;
   pFinished = true;
   for (BranchIslandFactory::iterator island = getBRIslandFactory()->begin(),
@@ -448,11 +554,8 @@ bool AArch64GNULDBackend::doRelax(Module& pModule,
     }
 
     if (((*island).offset() + (*island).size()) > exit->getOffset()) {
-      if (invalid_frags.empty() ||
-          (invalid_frags.back()->getParent() != (*island).getParent())) {
-        invalid_frags.push_back(exit);
-        pFinished = false;
-      }
+      invalid_frags.push_back(exit);
+      pFinished = false;
       continue;
     }
   }
@@ -460,12 +563,7 @@ bool AArch64GNULDBackend::doRelax(Module& pModule,
   // Reset the offset of invalid fragments.
   for (auto it = invalid_frags.begin(), ie = invalid_frags.end(); it != ie;
        ++it) {
-    Fragment* invalid = *it;
-    while (invalid != NULL) {
-      invalid->setOffset(invalid->getPrevNode()->getOffset() +
-                         invalid->getPrevNode()->size());
-      invalid = invalid->getNextNode();
-    }
+    (*it)->getParent()->updateOffsets(**it);
   }
 
   // Fix up the size of .symtab, .strtab, and TEXT sections
@@ -82,6 +82,9 @@ class AArch64GNULDBackend : public GNULDBackend {
   uint64_t emitSectionData(const LDSection& pSection,
                            MemoryRegion& pRegion) const;
 
+  /// fillCodePadding - fill the padding with nop words
+  bool fillCodePadding(uint8_t* pData, uint64_t pAddress, size_t pSize) const;
+
   AArch64GOT& getGOT();
   const AArch64GOT& getGOT() const;
 
@@ -113,9 +116,26 @@ class AArch64GNULDBackend : public GNULDBackend {
   /// readSection - read target dependent sections
   bool readSection(Input& pInput, SectionData& pSD);
 
+ private:
+  /** \class BranchReloc
+   *  \brief BranchReloc is a branch relocation to check for a stub, and the
+   *  place and the target it was last checked with.
+   */
+  struct BranchReloc {
+    Relocation* reloc;
+    uint64_t place;
+    uint64_t target;
+  };
+
  private:
   void defineGOTSymbol(IRBuilder& pBuilder);
 
+  /// collectBranches - collect the branch relocations of all inputs
+  void collectBranches(Module& pModule);
+
+  /// getBranchTarget - the address a branch relocation may reach
+  uint64_t getBranchTarget(const Relocation& pReloc) const;
+
   int64_t maxFwdBranchOffset() const { return MAX_FWD_BRANCH_OFFSET; }
   int64_t maxBwdBranchOffset() const { return MAX_BWD_BRANCH_OFFSET; }
 
@@ -142,6 +162,9 @@ class AArch64GNULDBackend : public GNULDBackend {
   /// getRelEntrySize - the size in BYTE of rela type relocation
   size_t getRelaEntrySize() { return 24; }
 
+  /// isRelativeReloc - check if pReloc is R_AARCH64_RELATIVE
+  bool isRelativeReloc(const Relocation& pReloc) const;
+
   /// doCreateProgramHdrs - backend can implement this function to create the
   /// target-dependent segments
   virtual void doCreateProgramHdrs(Module& pModule);
@@ -163,6 +186,11 @@ class AArch64GNULDBackend : public GNULDBackend {
   AArch64ELFDynamic* m_pDynamic;
   LDSymbol* m_pGOTSymbol;
 
+  /// m_Branches - the worklist of the relaxation passes. A branch is checked
+  /// again only if its place or its target has moved since the last pass.
+  std::vector<BranchReloc> m_Branches;
+  bool m_bCollectedBranches;
+
   //     variable name           :  ELF
   // LDSection* m_pAttributes;      // .ARM.attributes
   // LDSection* m_pPreemptMap;      // .AArch64.preemptmap
@@ -92,6 +92,12 @@ bool AArch64LongBranchStub::isMyDuty(const Relocation& pReloc,
   return false;
 }
 
+bool AArch64LongBranchStub::getDutyTypes(std::vector<Type>& pTypes) const {
+  pTypes.push_back(llvm::ELF::R_AARCH64_CALL26);
+  pTypes.push_back(llvm::ELF::R_AARCH64_JUMP26);
+  return true;
+}
+
 static bool isValidForADRP(uint64_t pSource, uint64_t pDest) {
   int64_t imm = static_cast<int64_t>((helper_get_page_address(pDest) -
                                       helper_get_page_address(pSource))) >> 12;
@@ -135,6 +141,10 @@ size_t AArch64LongBranchStub::size() const {
 }
 
 size_t AArch64LongBranchStub::alignment() const {
+  // only the literals need 8 bytes, so the adrp veneers are packed with no
+  // padding between them
+  if (m_pData == ADRP_TEMPLATE)
+    return 4;
   return 8;
 }
 
@@ -31,6 +31,8 @@ class AArch64LongBranchStub : public Stub {
                 uint64_t pSource,
                 uint64_t pTargetSymValue) const;
 
+  bool getDutyTypes(std::vector<Type>& pTypes) const;
+
   void applyFixup(Relocation& pSrcReloc,
                   IRBuilder& pBuilder,
                   BranchIsland& pIsland);
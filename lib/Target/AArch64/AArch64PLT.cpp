@@ -27,42 +27,51 @@ AArch64PLT1::AArch64PLT1(SectionData& pParent)
     : PLT::Entry<sizeof(aarch64_plt1)>(pParent) {
 }
 
+AArch64NonLazyPLT1::AArch64NonLazyPLT1(SectionData& pParent)
+    : PLT::Entry<sizeof(aarch64_nonlazy_plt1)>(pParent) {
+}
+
 //===----------------------------------------------------------------------===//
 // AArch64PLT
 
-AArch64PLT::AArch64PLT(LDSection& pSection, AArch64GOT& pGOTPLT)
-    : PLT(pSection), m_GOT(pGOTPLT) {
-  new AArch64PLT0(*m_pSectionData);
+AArch64PLT::AArch64PLT(LDSection& pSection, AArch64GOT& pGOTPLT, bool pLazy)
+    : PLT(pSection), m_GOT(pGOTPLT), m_bLazy(pLazy) {
+  if (m_bLazy)
+    new AArch64PLT0(*m_pSectionData);
 }
 
 AArch64PLT::~AArch64PLT() {
 }
 
 bool AArch64PLT::hasPLT1() const {
-  return (m_pSectionData->size() > 1);
+  return (m_pSectionData->size() > (m_bLazy ? 1u : 0u));
 }
 
 void AArch64PLT::finalizeSectionSize() {
-  uint64_t size = (m_pSectionData->size() - 1) * sizeof(aarch64_plt1) +
-                  sizeof(aarch64_plt0);
-  m_Section.setSize(size);
-
   uint32_t offset = 0;
   SectionData::iterator frag, fragEnd = m_pSectionData->end();
   for (frag = m_pSectionData->begin(); frag != fragEnd; ++frag) {
     frag->setOffset(offset);
     offset += frag->size();
   }
+  m_Section.setSize(offset);
 }
 
-AArch64PLT1* AArch64PLT::create() {
-  AArch64PLT1* plt1_entry = new (std::nothrow) AArch64PLT1(*m_pSectionData);
+PLTEntryBase* AArch64PLT::create() {
+  PLTEntryBase* plt1_entry = NULL;
+  if (m_bLazy)
+    plt1_entry = new (std::nothrow) AArch64PLT1(*m_pSectionData);
+  else
+    plt1_entry = new (std::nothrow) AArch64NonLazyPLT1(*m_pSectionData);
   if (!plt1_entry)
     fatal(diag::fail_allocate_memory_plt);
   return plt1_entry;
 }
 
 void AArch64PLT::applyPLT0() {
+  if (!m_bLazy)
+    return;
+
   // malloc plt0
   iterator first = m_pSectionData->getFragmentList().begin();
   assert(first != m_pSectionData->getFragmentList().end() &&
@@ -112,17 +121,24 @@ void AArch64PLT::applyPLT1() {
   // first gotplt1 address
   uint32_t GOTEntryAddress = got_base + GOTEntrySize * 3;
   // first plt1 address
-  uint32_t PLTEntryAddress = plt_base + AArch64PLT0::EntrySize;
-
-  ++it;  // skip PLT0
-  uint32_t PLT1EntrySize = AArch64PLT1::EntrySize;
-  AArch64PLT1* plt1 = NULL;
+  uint32_t PLTEntryAddress = plt_base;
+  const uint8_t* PLT1Template = aarch64_nonlazy_plt1;
+  uint32_t PLT1EntrySize = AArch64NonLazyPLT1::EntrySize;
+  if (m_bLazy) {
+    PLTEntryAddress += AArch64PLT0::EntrySize;
+    PLT1Template = aarch64_plt1;
+    PLT1EntrySize = AArch64PLT1::EntrySize;
+    ++it;  // skip PLT0
+  }
+  PLTEntryBase* plt1 = NULL;
 
   uint32_t* Out = NULL;
   while (it != ie) {
-    plt1 = &(llvm::cast<AArch64PLT1>(*it));
-    Out = static_cast<uint32_t*>(malloc(AArch64PLT1::EntrySize));
-    memcpy(Out, aarch64_plt1, AArch64PLT1::EntrySize);
+    plt1 = &(llvm::cast<PLTEntryBase>(*it));
+    Out = static_cast<uint32_t*>(malloc(PLT1EntrySize));
+    if (Out == NULL)
+      fatal(diag::fail_allocate_memory_plt);
+    memcpy(Out, PLT1Template, PLT1EntrySize);
     // apply 1st instruction
     AArch64Relocator::DWord imm = helper_get_page_address(GOTEntryAddress) -
                                   helper_get_page_address(PLTEntryAddress);
@@ -130,9 +146,11 @@ void AArch64PLT::applyPLT1() {
     // apply 2nd instruction
     Out[1] = helper_reencode_add_imm(
         Out[1], helper_get_page_offset(GOTEntryAddress) >> 3);
-    // apply 3rd instruction
-    Out[2] = helper_reencode_add_imm(Out[2],
-                                     helper_get_page_offset(GOTEntryAddress));
+    // apply 3rd instruction, which the non-lazy entry does not have
+    if (m_bLazy) {
+      Out[2] = helper_reencode_add_imm(
+          Out[2], helper_get_page_offset(GOTEntryAddress));
+    }
 
     plt1->setValue(reinterpret_cast<unsigned char*>(Out));
     ++it;
@@ -141,27 +159,22 @@ void AArch64PLT::applyPLT1() {
     PLTEntryAddress += PLT1EntrySize;
   }
 
-  m_GOT.applyGOTPLT(plt_base);
+  // the loader binds the slots of a non-lazy PLT before they are used
+  if (m_bLazy)
+    m_GOT.applyGOTPLT(plt_base);
 }
 
 uint64_t AArch64PLT::emit(MemoryRegion& pRegion) {
   uint64_t result = 0x0;
-  iterator it = begin();
-
   unsigned char* buffer = pRegion.begin();
-  memcpy(buffer,
-         llvm::cast<AArch64PLT0>((*it)).getValue(),
-         AArch64PLT0::EntrySize);
-  result += AArch64PLT0::EntrySize;
-  ++it;
-
-  AArch64PLT1* plt1 = NULL;
-  AArch64PLT::iterator ie = end();
-  while (it != ie) {
-    plt1 = &(llvm::cast<AArch64PLT1>(*it));
-    memcpy(buffer + result, plt1->getValue(), AArch64PLT1::EntrySize);
-    result += AArch64PLT1::EntrySize;
-    ++it;
+
+  // PLT0, if any, and the PLT1 entries
+  PLTEntryBase* entry = NULL;
+  AArch64PLT::iterator it, ie = end();
+  for (it = begin(); it != ie; ++it) {
+    entry = &(llvm::cast<PLTEntryBase>(*it));
+    memcpy(buffer + result, entry->getValue(), entry->size());
+    result += entry->size();
   }
   return result;
 }
@@ -31,6 +31,13 @@ const uint8_t aarch64_plt1[] = {
     0x20, 0x02, 0x1f, 0xd6   /* br x17.  */
 };
 
+// the entry of the non-lazy PLT of -z now
+const uint8_t aarch64_nonlazy_plt1[] = {
+    0x10, 0x00, 0x00, 0x90,  /* adrp x16, PLTGOT + n * 8 */
+    0x11, 0x02, 0x40, 0xf9,  /* ldr x17, [x16, PLTGOT + n * 8] */
+    0x20, 0x02, 0x1f, 0xd6   /* br x17.  */
+};
+
 namespace mcld {
 
 class AArch64GOT;
@@ -45,12 +52,20 @@ class AArch64PLT1 : public PLT::Entry<sizeof(aarch64_plt1)> {
   AArch64PLT1(SectionData& pParent);
 };
 
+class AArch64NonLazyPLT1 : public PLT::Entry<sizeof(aarch64_nonlazy_plt1)> {
+ public:
+  AArch64NonLazyPLT1(SectionData& pParent);
+};
+
 /** \class AArch64PLT
  *  \brief AArch64 Procedure Linkage Table
+ *
+ *  A non-lazy PLT, for -z now, has no PLT0, and its entries only branch
+ *  through their slots.
  */
 class AArch64PLT : public PLT {
  public:
-  AArch64PLT(LDSection& pSection, AArch64GOT& pGOTPLT);
+  AArch64PLT(LDSection& pSection, AArch64GOT& pGOTPLT, bool pLazy);
   ~AArch64PLT();
 
   // finalizeSectionSize - set LDSection size
@@ -59,7 +74,10 @@ class AArch64PLT : public PLT {
   // hasPLT1 - return if this plt section has any plt1 entry
   bool hasPLT1() const;
 
-  AArch64PLT1* create();
+  // isLazy - return if the entries are bound by the lazy resolver of PLT0
+  bool isLazy() const { return m_bLazy; }
+
+  PLTEntryBase* create();
 
   AArch64PLT0* getPLT0() const;
 
@@ -71,6 +89,7 @@ class AArch64PLT : public PLT {
 
  private:
   AArch64GOT& m_GOT;
+  bool m_bLazy;
 };
 
 }  // namespace mcld
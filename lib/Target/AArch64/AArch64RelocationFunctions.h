@@ -19,12 +19,18 @@
   DECL_AARCH64_APPLY_RELOC_FUNC(rel)              \
   DECL_AARCH64_APPLY_RELOC_FUNC(call)             \
   DECL_AARCH64_APPLY_RELOC_FUNC(condbr)           \
+  DECL_AARCH64_APPLY_RELOC_FUNC(ld_prel_lo19)     \
   DECL_AARCH64_APPLY_RELOC_FUNC(adr_prel_lo21)    \
   DECL_AARCH64_APPLY_RELOC_FUNC(adr_prel_pg_hi21) \
   DECL_AARCH64_APPLY_RELOC_FUNC(add_abs_lo12)     \
   DECL_AARCH64_APPLY_RELOC_FUNC(adr_got_page)     \
   DECL_AARCH64_APPLY_RELOC_FUNC(ld64_got_lo12)    \
   DECL_AARCH64_APPLY_RELOC_FUNC(ldst_abs_lo12)    \
+  DECL_AARCH64_APPLY_RELOC_FUNC(gottprel_page)    \
+  DECL_AARCH64_APPLY_RELOC_FUNC(gottprel_lo12)    \
+  DECL_AARCH64_APPLY_RELOC_FUNC(tprel_movw)       \
+  DECL_AARCH64_APPLY_RELOC_FUNC(tprel_add)        \
+  DECL_AARCH64_APPLY_RELOC_FUNC(tprel_ldst)       \
   DECL_AARCH64_APPLY_RELOC_FUNC(unsupported)
 
 #define DECL_AARCH64_APPLY_RELOC_FUNC_PTRS(ValueType, MappedType)                              /* NOLINT */\
@@ -47,7 +53,7 @@
   ValueType(0x10e, MappedType(&unsupported,      "R_AARCH64_MOVW_SABS_G0",                0)), /* NOLINT */\
   ValueType(0x10f, MappedType(&unsupported,      "R_AARCH64_MOVW_SABS_G1",                0)), /* NOLINT */\
   ValueType(0x110, MappedType(&unsupported,      "R_AARCH64_MOVW_SABS_G2",                0)), /* NOLINT */\
-  ValueType(0x111, MappedType(&unsupported,      "R_AARCH64_LD_PREL_LO19",                0)), /* NOLINT */\
+  ValueType(0x111, MappedType(&ld_prel_lo19,     "R_AARCH64_LD_PREL_LO19",               32)), /* NOLINT */\
   ValueType(0x112, MappedType(&adr_prel_lo21,    "R_AARCH64_ADR_PREL_LO21",              32)), /* NOLINT */\
   ValueType(0x113, MappedType(&adr_prel_pg_hi21, "R_AARCH64_ADR_PREL_PG_HI21",           32)), /* NOLINT */\
   ValueType(0x114, MappedType(&adr_prel_pg_hi21, "R_AARCH64_ADR_PREL_PG_HI21_NC",        32)), /* NOLINT */\
@@ -63,6 +69,17 @@
   ValueType(0x12b, MappedType(&ldst_abs_lo12,    "R_AARCH64_LDST128_ABS_LO12_NC",        32)), /* NOLINT */\
   ValueType(0x137, MappedType(&adr_got_page,     "R_AARCH64_ADR_GOT_PAGE",               32)), /* NOLINT */\
   ValueType(0x138, MappedType(&ld64_got_lo12,    "R_AARCH64_LD64_GOT_LO12_NC",           32)), /* NOLINT */\
+  ValueType(0x200, MappedType(&unsupported,      "R_AARCH64_TLSGD_ADR_PREL21",            0)), /* NOLINT */\
+  ValueType(0x201, MappedType(&unsupported,      "R_AARCH64_TLSGD_ADR_PAGE21",            0)), /* NOLINT */\
+  ValueType(0x202, MappedType(&unsupported,      "R_AARCH64_TLSGD_ADD_LO12_NC",           0)), /* NOLINT */\
+  ValueType(0x203, MappedType(&unsupported,      "R_AARCH64_TLSGD_MOVW_G1",               0)), /* NOLINT */\
+  ValueType(0x204, MappedType(&unsupported,      "R_AARCH64_TLSGD_MOVW_G0_NC",            0)), /* NOLINT */\
+  ValueType(0x205, MappedType(&unsupported,      "R_AARCH64_TLSLD_ADR_PREL21",            0)), /* NOLINT */\
+  ValueType(0x206, MappedType(&unsupported,      "R_AARCH64_TLSLD_ADR_PAGE21",            0)), /* NOLINT */\
+  ValueType(0x207, MappedType(&unsupported,      "R_AARCH64_TLSLD_ADD_LO12_NC",           0)), /* NOLINT */\
+  ValueType(0x208, MappedType(&unsupported,      "R_AARCH64_TLSLD_MOVW_G1",               0)), /* NOLINT */\
+  ValueType(0x209, MappedType(&unsupported,      "R_AARCH64_TLSLD_MOVW_G0_NC",            0)), /* NOLINT */\
+  ValueType(0x20a, MappedType(&unsupported,      "R_AARCH64_TLSLD_LD_PREL19",             0)), /* NOLINT */\
   ValueType(0x20b, MappedType(&unsupported,      "R_AARCH64_TLSLD_MOVW_DTPREL_G2",        0)), /* NOLINT */\
   ValueType(0x20c, MappedType(&unsupported,      "R_AARCH64_TLSLD_MOVW_DTPREL_G1",        0)), /* NOLINT */\
   ValueType(0x20d, MappedType(&unsupported,      "R_AARCH64_TLSLD_MOVW_DTPREL_G1_NC",     0)), /* NOLINT */\
@@ -81,28 +98,34 @@
   ValueType(0x21a, MappedType(&unsupported,      "R_AARCH64_TLSLD_LDST64_DTPREL_LO12_NC", 0)), /* NOLINT */\
   ValueType(0x21b, MappedType(&unsupported,      "R_AARCH64_TLSIE_MOVW_GOTTPREL_G1",      0)), /* NOLINT */\
   ValueType(0x21c, MappedType(&unsupported,      "R_AARCH64_TLSIE_MOVW_GOTTPREL_G0_NC",   0)), /* NOLINT */\
-  ValueType(0x21d, MappedType(&unsupported,      "R_AARCH64_TLSIE_ADR_GOTTPREL_PAGE21",   0)), /* NOLINT */\
-  ValueType(0x21e, MappedType(&unsupported,      "R_AARCH64_TLSIE_LD64_GOTTPREL_LO12_NC", 0)), /* NOLINT */\
+  ValueType(0x21d, MappedType(&gottprel_page,    "R_AARCH64_TLSIE_ADR_GOTTPREL_PAGE21",  32)), /* NOLINT */\
+  ValueType(0x21e, MappedType(&gottprel_lo12,    "R_AARCH64_TLSIE_LD64_GOTTPREL_LO12_NC", 32)), /* NOLINT */\
   ValueType(0x21f, MappedType(&unsupported,      "R_AARCH64_TLSIE_LD_GOTTPREL_PREL19",    0)), /* NOLINT */\
-  ValueType(0x220, MappedType(&unsupported,      "R_AARCH64_TLSLE_MOVW_TPREL_G2",         0)), /* NOLINT */\
-  ValueType(0x221, MappedType(&unsupported,      "R_AARCH64_TLSLE_MOVW_TPREL_G1",         0)), /* NOLINT */\
-  ValueType(0x222, MappedType(&unsupported,      "R_AARCH64_TLSLE_MOVW_TPREL_G1_NC",      0)), /* NOLINT */\
-  ValueType(0x223, MappedType(&unsupported,      "R_AARCH64_TLSLE_MOVW_TPREL_G0",         0)), /* NOLINT */\
-  ValueType(0x224, MappedType(&unsupported,      "R_AARCH64_TLSLE_MOVW_TPREL_G0_NC",      0)), /* NOLINT */\
-  ValueType(0x225, MappedType(&unsupported,      "R_AARCH64_TLSLE_ADD_TPREL_HI12",        0)), /* NOLINT */\
-  ValueType(0x226, MappedType(&unsupported,      "R_AARCH64_TLSLE_ADD_TPREL_LO12",        0)), /* NOLINT */\
-  ValueType(0x227, MappedType(&unsupported,      "R_AARCH64_TLSLE_ADD_TPREL_LO12_NC",     0)), /* NOLINT */\
-  ValueType(0x228, MappedType(&unsupported,      "R_AARCH64_TLSLE_LDST8_TPREL_LO12",      0)), /* NOLINT */\
-  ValueType(0x229, MappedType(&unsupported,      "R_AARCH64_TLSLE_LDST8_TPREL_LO12_NC",   0)), /* NOLINT */\
-  ValueType(0x22a, MappedType(&unsupported,      "R_AARCH64_TLSLE_LDST16_TPREL_LO12",     0)), /* NOLINT */\
-  ValueType(0x22b, MappedType(&unsupported,      "R_AARCH64_TLSLE_LDST16_TPREL_LO12_NC",  0)), /* NOLINT */\
-  ValueType(0x22c, MappedType(&unsupported,      "R_AARCH64_TLSLE_LDST32_TPREL_LO12",     0)), /* NOLINT */\
-  ValueType(0x22d, MappedType(&unsupported,      "R_AARCH64_TLSLE_LDST32_TPREL_LO12_NC",  0)), /* NOLINT */\
-  ValueType(0x22e, MappedType(&unsupported,      "R_AARCH64_TLSLE_LDST64_TPREL_LO12",     0)), /* NOLINT */\
-  ValueType(0x22f, MappedType(&unsupported,      "R_AARCH64_TLSLE_LDST64_TPREL_LO12_NC",  0)), /* NOLINT */\
+  ValueType(0x220, MappedType(&tprel_movw,       "R_AARCH64_TLSLE_MOVW_TPREL_G2",        32)), /* NOLINT */\
+  ValueType(0x221, MappedType(&tprel_movw,       "R_AARCH64_TLSLE_MOVW_TPREL_G1",        32)), /* NOLINT */\
+  ValueType(0x222, MappedType(&tprel_movw,       "R_AARCH64_TLSLE_MOVW_TPREL_G1_NC",     32)), /* NOLINT */\
+  ValueType(0x223, MappedType(&tprel_movw,       "R_AARCH64_TLSLE_MOVW_TPREL_G0",        32)), /* NOLINT */\
+  ValueType(0x224, MappedType(&tprel_movw,       "R_AARCH64_TLSLE_MOVW_TPREL_G0_NC",     32)), /* NOLINT */\
+  ValueType(0x225, MappedType(&tprel_add,        "R_AARCH64_TLSLE_ADD_TPREL_HI12",       32)), /* NOLINT */\
+  ValueType(0x226, MappedType(&tprel_add,        "R_AARCH64_TLSLE_ADD_TPREL_LO12",       32)), /* NOLINT */\
+  ValueType(0x227, MappedType(&tprel_add,        "R_AARCH64_TLSLE_ADD_TPREL_LO12_NC",    32)), /* NOLINT */\
+  ValueType(0x228, MappedType(&tprel_ldst,       "R_AARCH64_TLSLE_LDST8_TPREL_LO12",     32)), /* NOLINT */\
+  ValueType(0x229, MappedType(&tprel_ldst,       "R_AARCH64_TLSLE_LDST8_TPREL_LO12_NC",  32)), /* NOLINT */\
+  ValueType(0x22a, MappedType(&tprel_ldst,       "R_AARCH64_TLSLE_LDST16_TPREL_LO12",    32)), /* NOLINT */\
+  ValueType(0x22b, MappedType(&tprel_ldst,       "R_AARCH64_TLSLE_LDST16_TPREL_LO12_NC", 32)), /* NOLINT */\
+  ValueType(0x22c, MappedType(&tprel_ldst,       "R_AARCH64_TLSLE_LDST32_TPREL_LO12",    32)), /* NOLINT */\
+  ValueType(0x22d, MappedType(&tprel_ldst,       "R_AARCH64_TLSLE_LDST32_TPREL_LO12_NC", 32)), /* NOLINT */\
+  ValueType(0x22e, MappedType(&tprel_ldst,       "R_AARCH64_TLSLE_LDST64_TPREL_LO12",    32)), /* NOLINT */\
+  ValueType(0x22f, MappedType(&tprel_ldst,       "R_AARCH64_TLSLE_LDST64_TPREL_LO12_NC", 32)), /* NOLINT */\
+  ValueType(0x230, MappedType(&unsupported,      "R_AARCH64_TLSDESC_LD_PREL19",           0)), /* NOLINT */\
+  ValueType(0x231, MappedType(&unsupported,      "R_AARCH64_TLSDESC_ADR_PREL21",          0)), /* NOLINT */\
   ValueType(0x232, MappedType(&unsupported,      "R_AARCH64_TLSDESC_ADR_PAGE",            0)), /* NOLINT */\
   ValueType(0x233, MappedType(&unsupported,      "R_AARCH64_TLSDESC_LD64_LO12_NC",        0)), /* NOLINT */\
   ValueType(0x234, MappedType(&unsupported,      "R_AARCH64_TLSDESC_ADD_LO12_NC",         0)), /* NOLINT */\
+  ValueType(0x235, MappedType(&unsupported,      "R_AARCH64_TLSDESC_OFF_G1",              0)), /* NOLINT */\
+  ValueType(0x236, MappedType(&unsupported,      "R_AARCH64_TLSDESC_OFF_G0_NC",           0)), /* NOLINT */\
+  ValueType(0x237, MappedType(&unsupported,      "R_AARCH64_TLSDESC_LDR",                 0)), /* NOLINT */\
+  ValueType(0x238, MappedType(&unsupported,      "R_AARCH64_TLSDESC_ADD",                 0)), /* NOLINT */\
   ValueType(0x239, MappedType(&unsupported,      "R_AARCH64_TLSDESC_CALL",                0)), /* NOLINT */\
   ValueType(1024,  MappedType(&unsupported,      "R_AARCH64_COPY",                        0)), /* NOLINT */\
   ValueType(1025,  MappedType(&unsupported,      "R_AARCH64_GLOB_DAT",                    0)), /* NOLINT */\
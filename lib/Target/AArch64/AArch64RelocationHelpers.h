@@ -10,6 +10,9 @@
 #define TARGET_AARCH64_AARCH64RELOCATIONHELPERS_H_
 
 #include "AArch64Relocator.h"
+#include "mcld/LD/ELFSegment.h"
+#include "mcld/LD/ELFSegmentFactory.h"
+
 #include <llvm/Support/Host.h>
 
 namespace mcld {
@@ -65,6 +68,12 @@ static inline uint32_t helper_reencode_cond_branch_ofs_19(uint32_t pInst,
   return (pInst & ~(get_mask(19) << 5)) | ((pOff & get_mask(19)) << 5);
 }
 
+// Reencode the imm16 field of move wide immediate.
+static inline uint32_t helper_reencode_movw_imm(uint32_t pInst,
+                                                uint32_t pImm) {
+  return (pInst & ~(get_mask(16) << 5)) | ((pImm & get_mask(16)) << 5);
+}
+
 // Reencode the imm field of ld/st pos immediate.
 static inline uint32_t helper_reencode_ldst_pos_imm(uint32_t pInst,
                                                     uint32_t pImm) {
@@ -89,14 +98,14 @@ static inline Relocator::Address helper_get_PLT_address(
   return pParent.getTarget().getPLT().addr() + plt_entry->getOffset();
 }
 
-static inline AArch64PLT1& helper_PLT_init(Relocation& pReloc,
-                                           AArch64Relocator& pParent) {
+static inline PLTEntryBase& helper_PLT_init(Relocation& pReloc,
+                                            AArch64Relocator& pParent) {
   // rsym - The relocation target symbol
   ResolveInfo* rsym = pReloc.symInfo();
   AArch64GNULDBackend& ld_backend = pParent.getTarget();
   assert(pParent.getSymPLTMap().lookUp(*rsym) == NULL);
 
-  AArch64PLT1* plt_entry = ld_backend.getPLT().create();
+  PLTEntryBase* plt_entry = ld_backend.getPLT().create();
   pParent.getSymPLTMap().record(*rsym, *plt_entry);
 
   // initialize plt and the corresponding gotplt and dyn rel entry.
@@ -186,6 +195,51 @@ static inline AArch64GOTEntry& helper_GOT_init(Relocation& pReloc,
   return *got_entry;
 }
 
+/// helper_get_TP_offset - TPREL(S+A), the offset of S+A to the thread pointer.
+/// The thread pointer points to the 16-byte TCB, and the TLS block of the
+/// executable follows the TCB at the alignment of the TLS segment.
+static inline Relocator::DWord helper_get_TP_offset(Relocation& pReloc,
+                                                    AArch64Relocator& pParent) {
+  ELFSegmentFactory::const_iterator tls_seg =
+      pParent.getTarget().elfSegmentTable().find(
+          llvm::ELF::PT_TLS, llvm::ELF::PF_R, 0x0);
+  assert(tls_seg != pParent.getTarget().elfSegmentTable().end());
+  uint64_t align = (*tls_seg)->align();
+  if (align == 0)
+    align = 1;
+  Relocator::DWord tcb_size = (16 + align - 1) & ~(align - 1);
+  // the value of a TLS symbol is the offset to the TLS segment
+  return pReloc.symValue() + pReloc.addend() + tcb_size;
+}
+
+/// helper_TLS_GOT_init - reserve the GOT entry which holds the offset of the
+/// TLS symbol to the thread pointer, and the dynamic relocation to fill it
+static inline AArch64GOTEntry& helper_TLS_GOT_init(Relocation& pReloc,
+                                                   AArch64Relocator& pParent) {
+  // rsym - The relocation target symbol
+  ResolveInfo* rsym = pReloc.symInfo();
+  AArch64GNULDBackend& ld_backend = pParent.getTarget();
+  assert(pParent.getSymGOTMap().lookUp(*rsym) == NULL);
+
+  AArch64GOTEntry* got_entry = ld_backend.getGOT().createGOT();
+  pParent.getSymGOTMap().record(*rsym, *got_entry);
+  got_entry->setValue(0x0);
+
+  if (rsym->isLocal() || (rsym->isDefine() && !rsym->isDyn() &&
+                          !ld_backend.isSymbolPreemptible(*rsym))) {
+    // the offset to the TLS block of this module is known, the dynamic
+    // linker only adds the offset of the block to the thread pointer
+    Relocation& rel_entry = helper_DynRela_init(
+        NULL, *got_entry, 0x0, llvm::ELF::R_AARCH64_TLS_TPREL64, pParent);
+    rel_entry.setAddend(AArch64Relocator::SymVal);
+    pParent.getRelRelMap().record(pReloc, rel_entry);
+  } else {
+    helper_DynRela_init(
+        rsym, *got_entry, 0x0, llvm::ELF::R_AARCH64_TLS_TPREL64, pParent);
+  }
+  return *got_entry;
+}
+
 }  // namespace mcld
 
 #endif  // TARGET_AARCH64_AARCH64RELOCATIONHELPERS_H_
@@ -13,16 +13,25 @@
 #include "mcld/LD/LDSymbol.h"
 #include "mcld/LD/ELFFileFormat.h"
 #include "mcld/Object/ObjectBuilder.h"
+#include "mcld/Module.h"
+#include "mcld/LD/LDContext.h"
+#include "mcld/LD/RelocData.h"
+#include "mcld/Support/ThreadPool.h"
 
+#include "AArch64InsnHelpers.h"
 #include "AArch64Relocator.h"
 #include "AArch64RelocationFunctions.h"
 #include "AArch64RelocationHelpers.h"
 
 #include <llvm/ADT/Twine.h>
+#include <llvm/Support/Casting.h>
 #include <llvm/Support/DataTypes.h>
 #include <llvm/Support/ELF.h>
 #include <llvm/Support/Host.h>
 
+#include <algorithm>
+#include <utility>
+
 namespace mcld {
 
 //===----------------------------------------------------------------------===//
@@ -37,7 +46,7 @@ typedef Relocator::Result (*ApplyFunctionType)(Relocation& pReloc,
 // the table entry of applying functions
 class ApplyFunctionEntry {
  public:
-  ApplyFunctionEntry() {}
+  ApplyFunctionEntry() : func(NULL), name(NULL), size(0) {}
   ApplyFunctionEntry(ApplyFunctionType pFunc,
                      const char* pName,
                      size_t pSize = 0)
@@ -46,48 +55,242 @@ class ApplyFunctionEntry {
   const char* name;
   size_t size;
 };
-typedef std::map<Relocator::Type, ApplyFunctionEntry> ApplyFunctionMap;
+typedef std::pair<Relocator::Type, ApplyFunctionEntry> ApplyFunctionPair;
+
+static const ApplyFunctionPair ApplyFunctionList[] = {
+    DECL_AARCH64_APPLY_RELOC_FUNC_PTRS(ApplyFunctionPair, ApplyFunctionEntry)};
+
+/** \class ApplyFunctionTable
+ *  \brief ApplyFunctionTable indexes the applying functions by type.
+ *
+ *  The types 0x100 to R_AARCH64_IRELATIVE are at (type - 0x100), and the
+ *  internal types 0x0 and R_AARCH64_REWRITE_INSN follow them. The entries of
+ *  the types without an applying function are empty.
+ */
+class ApplyFunctionTable {
+ public:
+  ApplyFunctionTable();
+
+  /// lookup - the entry of pType, or NULL if pType is out of the table
+  const ApplyFunctionEntry* lookup(Relocator::Type pType) const;
+
+ private:
+  static const Relocator::Type kFirstType = 0x100;
+  static const Relocator::Type kLastType = 1032;  // R_AARCH64_IRELATIVE
+  static const size_t kNullIndex = kLastType - kFirstType + 1;
+  static const size_t kRewriteIndex = kNullIndex + 1;
+
+  static size_t index(Relocator::Type pType);
+
+ private:
+  ApplyFunctionEntry m_Entries[kRewriteIndex + 1];
+};
+
+ApplyFunctionTable::ApplyFunctionTable() {
+  size_t num = sizeof(ApplyFunctionList) / sizeof(ApplyFunctionList[0]);
+  for (size_t i = 0; i < num; ++i) {
+    size_t idx = index(ApplyFunctionList[i].first);
+    assert(idx <= kRewriteIndex && "the type is out of the table");
+    m_Entries[idx] = ApplyFunctionList[i].second;
+  }
+}
+
+size_t ApplyFunctionTable::index(Relocator::Type pType) {
+  if (pType == 0x0)
+    return kNullIndex;
+  if (pType == AArch64Relocator::R_AARCH64_REWRITE_INSN)
+    return kRewriteIndex;
+  if (pType < kFirstType || pType > kLastType)
+    return kRewriteIndex + 1;
+  return pType - kFirstType;
+}
 
-static const ApplyFunctionMap::value_type ApplyFunctionList[] = {
-    DECL_AARCH64_APPLY_RELOC_FUNC_PTRS(ApplyFunctionMap::value_type,
-                                       ApplyFunctionEntry)};
+const ApplyFunctionEntry* ApplyFunctionTable::lookup(
+    Relocator::Type pType) const {
+  size_t idx = index(pType);
+  if (idx > kRewriteIndex)
+    return NULL;
+  return &m_Entries[idx];
+}
 
 // declare the table of applying functions
-static ApplyFunctionMap ApplyFunctions(ApplyFunctionList,
-                                       ApplyFunctionList +
-                                           sizeof(ApplyFunctionList) /
-                                               sizeof(ApplyFunctionList[0]));
+static const ApplyFunctionTable ApplyFunctions;
 
 //===----------------------------------------------------------------------===//
 // AArch64Relocator
 //===----------------------------------------------------------------------===//
 AArch64Relocator::AArch64Relocator(AArch64GNULDBackend& pParent,
                                    const LinkerConfig& pConfig)
-    : Relocator(pConfig), m_Target(pParent) {
+    : Relocator(pConfig),
+      m_Target(pParent),
+      m_bCallMayOverflow(true),
+      m_bCondBrMayOverflow(true) {
 }
 
 AArch64Relocator::~AArch64Relocator() {
 }
 
 Relocator::Result AArch64Relocator::applyRelocation(Relocation& pRelocation) {
-  Relocation::Type type = pRelocation.type();
   // valid types are 0x0, 0x100-1032, and R_AARCH64_REWRITE_INSN
-  if ((type < 0x100 || type > 1032) &&
-      (type != 0x0) &&
-      (type != R_AARCH64_REWRITE_INSN)) {
+  const ApplyFunctionEntry* entry = ApplyFunctions.lookup(pRelocation.type());
+  if (entry == NULL || entry->func == NULL)
     return Relocator::Unknown;
+  return entry->func(pRelocation, *this);
+}
+
+void AArch64Relocator::applyDebugRelocations(const RelocList& pRelocs,
+                                             FailureList& pFailures) {
+  RelocList::const_iterator reloc, rEnd = pRelocs.end();
+  for (reloc = pRelocs.begin(); reloc != rEnd; ++reloc) {
+    Relocation& relocation = **reloc;
+    if (relocation.type() == llvm::ELF::R_AARCH64_ABS64 ||
+        relocation.type() == llvm::ELF::R_AARCH64_ABS32) {
+      relocation.target() =
+          relocation.symValue() + relocation.target() + relocation.addend();
+      continue;
+    }
+
+    Result result = applyRelocation(relocation);
+    if (result != OK)
+      pFailures.push_back(std::make_pair(&relocation, result));
   }
-  assert(ApplyFunctions.find(type) != ApplyFunctions.end());
-  return ApplyFunctions[type].func(pRelocation, *this);
+}
+
+void AArch64Relocator::applyRelocations(const RelocList& pRelocs,
+                                        FailureList& pFailures) {
+  // the ADRP and the instruction using the low 12 bits of its address are
+  // adjacent in the code and in the relocations
+  if (config().targets().relaxADRP()) {
+    for (size_t i = 0; i + 1 < pRelocs.size(); ++i) {
+      if (relaxADRP(*pRelocs[i], *pRelocs[i + 1]))
+        ++i;
+    }
+  }
+  Relocator::applyRelocations(pRelocs, pFailures);
 }
 
 const char* AArch64Relocator::getName(Relocator::Type pType) const {
-  assert(ApplyFunctions.find(pType) != ApplyFunctions.end());
-  return ApplyFunctions[pType].name;
+  const ApplyFunctionEntry* entry = ApplyFunctions.lookup(pType);
+  assert(entry != NULL && entry->name != NULL);
+  return entry->name;
 }
 
 Relocator::Size AArch64Relocator::getSize(Relocation::Type pType) const {
-  return ApplyFunctions[pType].size;
+  const ApplyFunctionEntry* entry = ApplyFunctions.lookup(pType);
+  assert(entry != NULL);
+  return entry->size;
+}
+
+/// BranchSpan - the lowest and the highest address that the branches of a
+/// kind jump from or to, and the largest magnitude of their addends
+struct BranchSpan {
+  Relocator::Address low;
+  Relocator::Address high;
+  Relocator::Address addend;
+
+  void add(Relocator::Address pAddress) {
+    low = std::min(low, pAddress);
+    high = std::max(high, pAddress);
+  }
+
+  /// reaches - the displacement of no branch can exceed [-pRange, pRange)
+  bool reaches(Relocator::Address pRange) const {
+    return (low > high) || (high - low + addend < pRange);
+  }
+};
+
+/// BranchSpans - the spans of the B and BL branches, and of the conditional
+/// branches
+struct BranchSpans {
+  BranchSpan call;
+  BranchSpan condbr;
+};
+
+static BranchSpan mergeSpans(const BranchSpan& pA, const BranchSpan& pB) {
+  BranchSpan result = {std::min(pA.low, pB.low),
+                       std::max(pA.high, pB.high),
+                       std::max(pA.addend, pB.addend)};
+  return result;
+}
+
+/// addBranch - add the place of pReloc, its addend, and any target outside
+/// the allocated sections, such as an absolute symbol, to pSpan
+static void addBranch(const Relocation& pReloc, BranchSpan& pSpan) {
+  pSpan.add(pReloc.place());
+  Relocator::Address addend = pReloc.addend();
+  if (static_cast<int64_t>(addend) < 0)
+    addend = -addend;
+  pSpan.addend = std::max(pSpan.addend, addend);
+  const ResolveInfo* info = pReloc.symInfo();
+  if (!(info->reserved() & AArch64Relocator::ReservePLT) &&
+      !info->outSymbol()->hasFragRef())
+    pSpan.add(pReloc.symValue());
+}
+
+/// prepareApply - a branch jumps from its place to a symbol or a PLT entry.
+/// If all of them are in the allocated sections and the addends are small,
+/// the span of the sections bounds every displacement. This pass visits the
+/// branches once instead of checking the range at each of them.
+void AArch64Relocator::prepareApply(const Module& pModule) {
+  BranchSpan empty = {~Relocator::Address(0), 0, 0};
+  BranchSpans spans = {empty, empty};
+
+  BranchSpan sections = empty;
+  Module::const_iterator sect, sectEnd = pModule.end();
+  for (sect = pModule.begin(); sect != sectEnd; ++sect) {
+    if (((*sect)->flag() & llvm::ELF::SHF_ALLOC) != 0 && (*sect)->size() != 0) {
+      sections.add((*sect)->addr());
+      sections.add((*sect)->addr() + (*sect)->size());
+    }
+  }
+
+  const Module::ObjectList& inputs = pModule.getObjectList();
+  ThreadPool pool(config().options().numThreads());
+  spans = parallelReduce(pool, 0, inputs.size(), spans,
+                         [&inputs, &empty](size_t pIndex) {
+    BranchSpans result = {empty, empty};
+    LDContext::const_sect_iterator rs,
+        rsEnd = inputs[pIndex]->context()->relocSectEnd();
+    for (rs = inputs[pIndex]->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+        continue;
+      RelocData::const_iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+        const Relocation& relocation = llvm::cast<Relocation>(*reloc);
+        switch (relocation.type()) {
+          case llvm::ELF::R_AARCH64_CALL26:
+          case llvm::ELF::R_AARCH64_JUMP26:
+            addBranch(relocation, result.call);
+            break;
+          case llvm::ELF::R_AARCH64_CONDBR19:
+            addBranch(relocation, result.condbr);
+            break;
+          default:
+            break;
+        }
+      }
+    }
+    return result;
+  }, [](const BranchSpans& pA, const BranchSpans& pB) {
+    BranchSpans result = {mergeSpans(pA.call, pB.call),
+                          mergeSpans(pA.condbr, pB.condbr)};
+    return result;
+  });
+
+  // the targets in the sections are anywhere in their span
+  if (spans.call.low <= spans.call.high)
+    spans.call = mergeSpans(spans.call, sections);
+  if (spans.condbr.low <= spans.condbr.high)
+    spans.condbr = mergeSpans(spans.condbr, sections);
+
+  m_bCallMayOverflow = !spans.call.reaches(Relocator::Address(1) << 27);
+  m_bCondBrMayOverflow = !spans.condbr.reaches(Relocator::Address(1) << 20);
+}
+
+bool AArch64Relocator::mayOverflow(Relocation::Type pType) const {
+  if (llvm::ELF::R_AARCH64_CONDBR19 == pType)
+    return m_bCondBrMayOverflow;
+  return m_bCallMayOverflow;
 }
 
 void AArch64Relocator::addCopyReloc(ResolveInfo& pSym) {
@@ -96,6 +299,7 @@ void AArch64Relocator::addCopyReloc(ResolveInfo& pSym) {
   assert(pSym.outSymbol()->hasFragRef());
   rel_entry.targetRef().assign(*pSym.outSymbol()->fragRef());
   rel_entry.setSymInfo(&pSym);
+  getTarget().noteCopyReloc(pSym);
 }
 
 /// defineSymbolForCopyReloc
@@ -192,6 +396,8 @@ void AArch64Relocator::scanLocalReloc(Relocation& pReloc,
 
     case llvm::ELF::R_AARCH64_ADR_GOT_PAGE:
     case llvm::ELF::R_AARCH64_LD64_GOT_LO12_NC: {
+      if (relaxGOTLoad(pReloc))
+        return;
       // Symbol needs GOT entry, reserve entry in .got
       // return if we already create GOT for this symbol
       if (rsym->reserved() & ReserveGOT)
@@ -217,13 +423,15 @@ void AArch64Relocator::scanGlobalReloc(Relocation& pReloc,
                                        const LDSection& pSection) {
   // rsym - The relocation target symbol
   ResolveInfo* rsym = pReloc.symInfo();
+  bool canonical_plt = false;
   switch (pReloc.type()) {
     case llvm::ELF::R_AARCH64_ABS64:
     case llvm::ELF::R_AARCH64_ABS32:
     case llvm::ELF::R_AARCH64_ABS16:
       // Absolute relocation type, symbol may needs PLT entry or
       // dynamic relocation entry
-      if (getTarget().symbolNeedsPLT(*rsym)) {
+      canonical_plt = getTarget().symbolNeedsCanonicalPLT(pReloc, *rsym);
+      if (canonical_plt) {
         // create plt for this symbol if it does not have one
         if (!(rsym->reserved() & ReservePLT)) {
           // Symbol needs PLT entry, we need a PLT entry
@@ -233,11 +441,12 @@ void AArch64Relocator::scanGlobalReloc(Relocation& pReloc,
           // set PLT bit
           rsym->setReserved(rsym->reserved() | ReservePLT);
         }
+        getTarget().noteCanonicalPLT(*rsym);
       }
 
-      if (getTarget()
-              .symbolNeedsDynRel(
-                  *rsym, (rsym->reserved() & ReservePLT), true)) {
+      // the place refers to the function itself if it is not canonical
+      if (getTarget().symbolNeedsDynRel(
+              *rsym, canonical_plt && (rsym->reserved() & ReservePLT), true)) {
         // symbol needs dynamic relocation entry, set up the dynrel entry
         if (getTarget().symbolNeedsCopyReloc(pReloc, *rsym)) {
           LDSymbol& cpy_sym = defineSymbolforCopyReloc(pBuilder, *rsym);
@@ -351,6 +560,8 @@ void AArch64Relocator::scanGlobalReloc(Relocation& pReloc,
 
     case llvm::ELF::R_AARCH64_ADR_GOT_PAGE:
     case llvm::ELF::R_AARCH64_LD64_GOT_LO12_NC: {
+      if (relaxGOTLoad(pReloc))
+        return;
       // Symbol needs GOT entry, reserve entry in .got
       // return if we already create GOT for this symbol
       if (rsym->reserved() & ReserveGOT)
@@ -386,10 +597,12 @@ void AArch64Relocator::scanRelocation(Relocation& pReloc,
 
   // Scan relocation type to determine if an GOT/PLT/Dynamic Relocation
   // entries should be created.
-  // FIXME: Below judgements concern nothing about TLS related relocation
-
+  // TLS relocation
+  if (pReloc.type() >= llvm::ELF::R_AARCH64_TLSGD_ADR_PREL21 &&
+      pReloc.type() <= llvm::ELF::R_AARCH64_TLSDESC_CALL)
+    scanTLSReloc(pReloc, pSection);
   // rsym is local
-  if (rsym->isLocal())
+  else if (rsym->isLocal())
     scanLocalReloc(pReloc, pSection);
   // rsym is external
   else
@@ -401,6 +614,200 @@ void AArch64Relocator::scanRelocation(Relocation& pReloc,
     issueUndefRef(pReloc, pSection, pInput);
 }
 
+bool AArch64Relocator::relaxGOTLoad(Relocation& pReloc) {
+  // the address of a non-preemptible symbol is fixed relative to the place
+  ResolveInfo* rsym = pReloc.symInfo();
+  if (!rsym->isDefine() || rsym->isDyn() ||
+      ResolveInfo::IndirectFunc == rsym->type() ||
+      getTarget().isSymbolPreemptible(*rsym) ||
+      (rsym->isAbsolute() && config().isCodeIndep()))
+    return false;
+
+  if (llvm::ELF::R_AARCH64_ADR_GOT_PAGE == pReloc.type()) {
+    // adrp xn, :got:foo => adrp xn, foo
+    pReloc.setType(llvm::ELF::R_AARCH64_ADR_PREL_PG_HI21);
+  } else {
+    // ldr xt, [xn, :got_lo12:foo] => add xt, xn, :lo12:foo
+    uint32_t insn = pReloc.target();
+    pReloc.setType(llvm::ELF::R_AARCH64_ADD_ABS_LO12_NC);
+    pReloc.target() = AArch64InsnHelpers::buildAddInsn(
+        AArch64InsnHelpers::getRt(insn), AArch64InsnHelpers::getRn(insn));
+  }
+  return true;
+}
+
+bool AArch64Relocator::relaxADRP(Relocation& pAdrp, Relocation& pLo12) {
+  if ((llvm::ELF::R_AARCH64_ADR_PREL_PG_HI21 != pAdrp.type() &&
+       llvm::ELF::R_AARCH64_ADR_PREL_PG_HI21_NC != pAdrp.type()) ||
+      pAdrp.symInfo() != pLo12.symInfo() || pAdrp.addend() != pLo12.addend() ||
+      pAdrp.place() + AArch64InsnHelpers::InsnSize != pLo12.place())
+    return false;
+
+  ResolveInfo* rsym = pAdrp.symInfo();
+  if (rsym->isUndef() && !(rsym->reserved() & ReservePLT))
+    return false;
+
+  // the ADRP and its user must write the same register, else the register
+  // of the ADRP may be read later
+  uint32_t adrp = pAdrp.target();
+  uint32_t lo12 = pLo12.target();
+  unsigned rd = AArch64InsnHelpers::getRd(adrp);
+  if (!AArch64InsnHelpers::isADRP(adrp) ||
+      AArch64InsnHelpers::getRn(lo12) != rd ||
+      AArch64InsnHelpers::getRd(lo12) != rd)
+    return false;
+
+  Relocator::Address S = pAdrp.symValue();
+  if (rsym->reserved() & ReservePLT)
+    S = helper_get_PLT_address(*rsym, *this);
+  Relocator::DWord X = S + pAdrp.addend() - pLo12.place();
+  if (helper_check_signed_overflow(X, 21))
+    return false;
+
+  // adrp xn, sym                 => nop
+  // add  xn, xn, :lo12:sym       => adr xn, sym
+  // ldr  xn, [xn, :lo12:sym]     => ldr xn, sym
+  uint32_t insn = 0x0;
+  Relocation::Type type = llvm::ELF::R_AARCH64_NONE;
+  switch (pLo12.type()) {
+    case llvm::ELF::R_AARCH64_ADD_ABS_LO12_NC:
+      if ((lo12 & ~(get_mask(12) << 10)) !=
+          AArch64InsnHelpers::buildAddInsn(rd, rd))
+        return false;
+      insn = AArch64InsnHelpers::buildAdrInsn(rd);
+      type = llvm::ELF::R_AARCH64_ADR_PREL_LO21;
+      break;
+    case llvm::ELF::R_AARCH64_LDST32_ABS_LO12_NC:
+    case llvm::ELF::R_AARCH64_LDST64_ABS_LO12_NC: {
+      bool is_64 = llvm::ELF::R_AARCH64_LDST64_ABS_LO12_NC == pLo12.type();
+      uint32_t ldr = is_64 ? AArch64InsnHelpers::buildLdrInsn(rd, rd)
+                           : AArch64InsnHelpers::buildLdrWInsn(rd, rd);
+      // the offset of the literal load counts words
+      if ((lo12 & ~(get_mask(12) << 10)) != ldr || (X & 0x3) != 0)
+        return false;
+      insn = AArch64InsnHelpers::buildLdrLiteralInsn(rd, is_64);
+      type = llvm::ELF::R_AARCH64_LD_PREL_LO19;
+      break;
+    }
+    default:
+      return false;
+  }
+
+  pAdrp.setType(R_AARCH64_REWRITE_INSN);
+  pAdrp.target() = AArch64InsnHelpers::buildNopInsn();
+  pLo12.setType(type);
+  pLo12.target() = insn;
+  return true;
+}
+
+void AArch64Relocator::scanTLSReloc(Relocation& pReloc,
+                                    const LDSection& pSection) {
+  // rsym - The relocation target symbol
+  ResolveInfo* rsym = pReloc.symInfo();
+  // An executable knows the offset of its own TLS symbols to the thread
+  // pointer, and only needs the GOT entry of the initial exec model for the
+  // TLS symbols of the shared objects.
+  bool is_exec = (LinkerConfig::DynObj != config().codeGenType()) ||
+                 config().options().isPIE();
+  bool to_le = is_exec && rsym->isDefine() && !rsym->isDyn();
+  uint32_t insn = pReloc.target();
+
+  switch (pReloc.type()) {
+    // adrp  x0, :tlsdesc:v           => movz x0, #:tprel_g1:v, lsl #16
+    //                                   adrp x0, :gottprel:v
+    // ldr   x1, [x0, :tlsdesc_lo12:v => movk x0, #:tprel_g0_nc:v
+    //                                   ldr  x0, [x0, :gottprel_lo12:v]
+    // add   x0, x0, :tlsdesc_lo12:v  => nop
+    // blr   x1                       => nop
+    case llvm::ELF::R_AARCH64_TLSDESC_ADR_PAGE21:
+      if (!is_exec)
+        return;
+      if (to_le) {
+        pReloc.setType(llvm::ELF::R_AARCH64_TLSLE_MOVW_TPREL_G1);
+        pReloc.target() = AArch64InsnHelpers::buildMovzInsn(0, 16);
+        return;
+      }
+      pReloc.setType(llvm::ELF::R_AARCH64_TLSIE_ADR_GOTTPREL_PAGE21);
+      pReloc.target() = AArch64InsnHelpers::buildAdrpInsn(0);
+      break;
+
+    case llvm::ELF::R_AARCH64_TLSDESC_LD64_LO12:
+      if (!is_exec)
+        return;
+      if (to_le) {
+        pReloc.setType(llvm::ELF::R_AARCH64_TLSLE_MOVW_TPREL_G0_NC);
+        pReloc.target() = AArch64InsnHelpers::buildMovkInsn(0);
+        return;
+      }
+      pReloc.setType(llvm::ELF::R_AARCH64_TLSIE_LD64_GOTTPREL_LO12_NC);
+      pReloc.target() = AArch64InsnHelpers::buildLdrInsn(0, 0);
+      break;
+
+    case llvm::ELF::R_AARCH64_TLSDESC_ADD_LO12:
+    case llvm::ELF::R_AARCH64_TLSDESC_CALL:
+      if (!is_exec)
+        return;
+      pReloc.setType(R_AARCH64_REWRITE_INSN);
+      pReloc.target() = AArch64InsnHelpers::buildNopInsn();
+      return;
+
+    // adrp  xn, :gottprel:v              => movz xn, #:tprel_g1:v, lsl #16
+    // ldr   xn, [xn, :gottprel_lo12:v]   => movk xn, #:tprel_g0_nc:v
+    case llvm::ELF::R_AARCH64_TLSIE_ADR_GOTTPREL_PAGE21:
+      if (to_le) {
+        pReloc.setType(llvm::ELF::R_AARCH64_TLSLE_MOVW_TPREL_G1);
+        pReloc.target() = AArch64InsnHelpers::buildMovzInsn(
+            AArch64InsnHelpers::getRd(insn), 16);
+        return;
+      }
+      break;
+
+    case llvm::ELF::R_AARCH64_TLSIE_LD64_GOTTPREL_LO12_NC:
+      if (to_le) {
+        pReloc.setType(llvm::ELF::R_AARCH64_TLSLE_MOVW_TPREL_G0_NC);
+        pReloc.target() = AArch64InsnHelpers::buildMovkInsn(
+            AArch64InsnHelpers::getRt(insn));
+        return;
+      }
+      break;
+
+    case llvm::ELF::R_AARCH64_TLSLE_MOVW_TPREL_G2:
+    case llvm::ELF::R_AARCH64_TLSLE_MOVW_TPREL_G1:
+    case llvm::ELF::R_AARCH64_TLSLE_MOVW_TPREL_G1_NC:
+    case llvm::ELF::R_AARCH64_TLSLE_MOVW_TPREL_G0:
+    case llvm::ELF::R_AARCH64_TLSLE_MOVW_TPREL_G0_NC:
+    case llvm::ELF::R_AARCH64_TLSLE_ADD_TPREL_HI12:
+    case llvm::ELF::R_AARCH64_TLSLE_ADD_TPREL_LO12:
+    case llvm::ELF::R_AARCH64_TLSLE_ADD_TPREL_LO12_NC:
+    case llvm::ELF::R_AARCH64_TLSLE_LDST8_TPREL_LO12:
+    case llvm::ELF::R_AARCH64_TLSLE_LDST8_TPREL_LO12_NC:
+    case llvm::ELF::R_AARCH64_TLSLE_LDST16_TPREL_LO12:
+    case llvm::ELF::R_AARCH64_TLSLE_LDST16_TPREL_LO12_NC:
+    case llvm::ELF::R_AARCH64_TLSLE_LDST32_TPREL_LO12:
+    case llvm::ELF::R_AARCH64_TLSLE_LDST32_TPREL_LO12_NC:
+    case llvm::ELF::R_AARCH64_TLSLE_LDST64_TPREL_LO12:
+    case llvm::ELF::R_AARCH64_TLSLE_LDST64_TPREL_LO12_NC:
+      // the local exec model cannot be used in a shared object
+      if (!is_exec)
+        error(diag::non_pic_relocation) << getName(pReloc.type())
+                                        << rsym->name();
+      return;
+
+    default:
+      // the general dynamic and the local dynamic models
+      return;
+  }
+
+  // Symbol needs the GOT entry of the initial exec model, reserve entry in
+  // .got
+  getTarget().setHasStaticTLS();
+  if (rsym->reserved() & ReserveGOT)
+    return;
+  helper_TLS_GOT_init(pReloc, *this);
+  // set GOT bit
+  rsym->setReserved(rsym->reserved() | ReserveGOT);
+}
+
 bool
 AArch64Relocator::mayHaveFunctionPointerAccess(const Relocation& pReloc) const {
   switch (pReloc.type()) {
@@ -609,7 +1016,9 @@ Relocator::Result call(Relocation& pReloc, AArch64Relocator& pParent) {
     S = helper_get_PLT_address(*pReloc.symInfo(), pParent);
 
   Relocator::DWord X = S + A - P;
-  // TODO: check overflow..
+  if (pParent.mayOverflow(pReloc.type()) &&
+      helper_check_signed_overflow(X, 28))
+    return Relocator::Overflow;
 
   pReloc.target() = helper_reencode_branch_offset_26(pReloc.target(), X >> 2);
 
@@ -638,7 +1047,28 @@ Relocator::Result condbr(Relocation& pReloc, AArch64Relocator& pParent) {
     S = helper_get_PLT_address(*pReloc.symInfo(), pParent);
 
   Relocator::DWord X = S + A - P;
-  // TODO: check overflow..
+  if (pParent.mayOverflow(pReloc.type()) &&
+      helper_check_signed_overflow(X, 21))
+    return Relocator::Overflow;
+
+  pReloc.target() = helper_reencode_cond_branch_ofs_19(pReloc.target(), X >> 2);
+
+  return Relocator::OK;
+}
+
+// R_AARCH64_LD_PREL_LO19: S + A - P
+Relocator::Result ld_prel_lo19(Relocation& pReloc, AArch64Relocator& pParent) {
+  ResolveInfo* rsym = pReloc.symInfo();
+  Relocator::Address S = pReloc.symValue();
+  // if plt entry exists, the S value is the plt entry address
+  if (rsym->reserved() & AArch64Relocator::ReservePLT) {
+    S = helper_get_PLT_address(*rsym, pParent);
+  }
+  Relocator::DWord A = pReloc.addend();
+  Relocator::DWord P = pReloc.place();
+  Relocator::DWord X = S + A - P;
+  if (helper_check_signed_overflow(X, 21))
+    return Relocator::Overflow;
 
   pReloc.target() = helper_reencode_cond_branch_ofs_19(pReloc.target(), X >> 2);
 
@@ -729,4 +1159,121 @@ Relocator::Result ldst_abs_lo12(Relocation& pReloc, AArch64Relocator& pParent) {
   return Relocator::OK;
 }
 
+// R_AARCH64_TLSIE_ADR_GOTTPREL_PAGE21: Page(G(GTPREL(S+A))) - Page(P)
+Relocator::Result gottprel_page(Relocation& pReloc, AArch64Relocator& pParent) {
+  if (!(pReloc.symInfo()->reserved() & AArch64Relocator::ReserveGOT)) {
+    return Relocator::BadReloc;
+  }
+
+  Relocator::Address GOT_S = helper_get_GOT_address(*pReloc.symInfo(), pParent);
+  Relocator::Address P = pReloc.place();
+  Relocator::DWord X =
+      helper_get_page_address(GOT_S) - helper_get_page_address(P);
+
+  pReloc.target() = helper_reencode_adr_imm(pReloc.target(), (X >> 12));
+
+  // setup relocation addend if needed
+  Relocation* dyn_rela = pParent.getRelRelMap().lookUp(pReloc);
+  if ((dyn_rela != NULL) && (AArch64Relocator::SymVal == dyn_rela->addend())) {
+    dyn_rela->setAddend(pReloc.symValue() + pReloc.addend());
+  }
+  return Relocator::OK;
+}
+
+// R_AARCH64_TLSIE_LD64_GOTTPREL_LO12_NC: G(GTPREL(S+A))
+Relocator::Result gottprel_lo12(Relocation& pReloc, AArch64Relocator& pParent) {
+  if (!(pReloc.symInfo()->reserved() & AArch64Relocator::ReserveGOT)) {
+    return Relocator::BadReloc;
+  }
+
+  Relocator::Address GOT_S = helper_get_GOT_address(*pReloc.symInfo(), pParent);
+  Relocator::DWord X = helper_get_page_offset(GOT_S);
+
+  pReloc.target() = helper_reencode_ldst_pos_imm(pReloc.target(), (X >> 3));
+
+  // setup relocation addend if needed
+  Relocation* dyn_rela = pParent.getRelRelMap().lookUp(pReloc);
+  if ((dyn_rela != NULL) && (AArch64Relocator::SymVal == dyn_rela->addend())) {
+    dyn_rela->setAddend(pReloc.symValue() + pReloc.addend());
+  }
+  return Relocator::OK;
+}
+
+// R_AARCH64_TLSLE_MOVW_TPREL_G2: TPREL(S+A) >> 32
+// R_AARCH64_TLSLE_MOVW_TPREL_G1: TPREL(S+A) >> 16
+// R_AARCH64_TLSLE_MOVW_TPREL_G1_NC: TPREL(S+A) >> 16
+// R_AARCH64_TLSLE_MOVW_TPREL_G0: TPREL(S+A)
+// R_AARCH64_TLSLE_MOVW_TPREL_G0_NC: TPREL(S+A)
+Relocator::Result tprel_movw(Relocation& pReloc, AArch64Relocator& pParent) {
+  Relocator::DWord X = helper_get_TP_offset(pReloc, pParent);
+  unsigned shift = 0;
+  bool check = true;
+
+  switch (pReloc.type()) {
+    case llvm::ELF::R_AARCH64_TLSLE_MOVW_TPREL_G2:
+      shift = 32;
+      break;
+    case llvm::ELF::R_AARCH64_TLSLE_MOVW_TPREL_G1_NC:
+      check = false;
+      // Fall through
+    case llvm::ELF::R_AARCH64_TLSLE_MOVW_TPREL_G1:
+      shift = 16;
+      break;
+    case llvm::ELF::R_AARCH64_TLSLE_MOVW_TPREL_G0_NC:
+      check = false;
+      break;
+    default:
+      break;
+  }
+
+  pReloc.target() = helper_reencode_movw_imm(pReloc.target(), (X >> shift));
+  if (check && (X >> (shift + 16)) != 0)
+    return Relocator::Overflow;
+  return Relocator::OK;
+}
+
+// R_AARCH64_TLSLE_ADD_TPREL_HI12: TPREL(S+A) >> 12
+// R_AARCH64_TLSLE_ADD_TPREL_LO12: TPREL(S+A)
+// R_AARCH64_TLSLE_ADD_TPREL_LO12_NC: TPREL(S+A)
+Relocator::Result tprel_add(Relocation& pReloc, AArch64Relocator& pParent) {
+  Relocator::DWord X = helper_get_TP_offset(pReloc, pParent);
+
+  switch (pReloc.type()) {
+    case llvm::ELF::R_AARCH64_TLSLE_ADD_TPREL_HI12:
+      pReloc.target() = helper_reencode_add_imm(pReloc.target(), (X >> 12));
+      if ((X >> 24) != 0)
+        return Relocator::Overflow;
+      break;
+    case llvm::ELF::R_AARCH64_TLSLE_ADD_TPREL_LO12:
+      pReloc.target() = helper_reencode_add_imm(pReloc.target(), X);
+      if ((X >> 12) != 0)
+        return Relocator::Overflow;
+      break;
+    default:
+      pReloc.target() = helper_reencode_add_imm(pReloc.target(), X);
+      break;
+  }
+  return Relocator::OK;
+}
+
+// R_AARCH64_TLSLE_LDST8_TPREL_LO12: TPREL(S+A)
+// R_AARCH64_TLSLE_LDST16_TPREL_LO12: TPREL(S+A)
+// R_AARCH64_TLSLE_LDST32_TPREL_LO12: TPREL(S+A)
+// R_AARCH64_TLSLE_LDST64_TPREL_LO12: TPREL(S+A)
+// and their _NC forms, which do not check overflow
+Relocator::Result tprel_ldst(Relocation& pReloc, AArch64Relocator& pParent) {
+  Relocator::DWord X = helper_get_TP_offset(pReloc, pParent);
+  // the types come in the pairs of 8, 16, 32 and 64-bit access, and each _NC
+  // type follows its checked one
+  unsigned index = pReloc.type() - llvm::ELF::R_AARCH64_TLSLE_LDST8_TPREL_LO12;
+  unsigned scale = index / 2;
+  bool check = (index % 2 == 0);
+
+  pReloc.target() = helper_reencode_ldst_pos_imm(
+      pReloc.target(), (helper_get_page_offset(X) >> scale));
+  if (check && (X >> 12) != 0)
+    return Relocator::Overflow;
+  return Relocator::OK;
+}
+
 }  // namespace mcld
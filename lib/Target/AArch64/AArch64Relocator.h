@@ -23,7 +23,7 @@ namespace mcld {
 class AArch64Relocator : public Relocator {
  public:
   typedef KeyEntryMap<ResolveInfo, AArch64GOTEntry> SymGOTMap;
-  typedef KeyEntryMap<ResolveInfo, AArch64PLT1> SymPLTMap;
+  typedef KeyEntryMap<ResolveInfo, PLTEntryBase> SymPLTMap;
   typedef KeyEntryMap<Relocation, Relocation> RelRelMap;
 
   /** \enum ReservedEntryType
@@ -69,6 +69,15 @@ class AArch64Relocator : public Relocator {
 
   Result applyRelocation(Relocation& pRelocation);
 
+  /// applyDebugRelocations - apply R_AARCH64_ABS64 and R_AARCH64_ABS32
+  /// without dispatching them
+  void applyDebugRelocations(const RelocList& pRelocs,
+                             FailureList& pFailures);
+
+  /// applyRelocations - apply the relocations of a section. With
+  /// --relax-adrp, the ADRP pairs are relaxed by relaxADRP first.
+  void applyRelocations(const RelocList& pRelocs, FailureList& pFailures);
+
   AArch64GNULDBackend& getTarget() { return m_Target; }
 
   const AArch64GNULDBackend& getTarget() const { return m_Target; }
@@ -77,6 +86,14 @@ class AArch64Relocator : public Relocator {
 
   Size getSize(Relocation::Type pType) const;
 
+  /// prepareApply - find the branch types whose displacements cannot
+  /// overflow in pModule
+  void prepareApply(const Module& pModule);
+
+  /// mayOverflow - check if the branches of pType may be out of range, so
+  /// that their displacements are checked one by one
+  bool mayOverflow(Relocation::Type pType) const;
+
   const SymGOTMap& getSymGOTMap() const { return m_SymGOTMap; }
   SymGOTMap& getSymGOTMap() { return m_SymGOTMap; }
 
@@ -120,6 +137,22 @@ class AArch64Relocator : public Relocator {
                        IRBuilder& pBuilder,
                        const LDSection& pSection);
 
+  /// relaxGOTLoad - rewrite the load of the GOT entry of a non-preemptible
+  /// symbol to the computation of its PC-relative address
+  /// @return true if pReloc no longer needs the GOT entry
+  bool relaxGOTLoad(Relocation& pReloc);
+
+  /// relaxADRP - rewrite the ADRP of pAdrp and the ADD or LDR of pLo12 on the
+  /// next instruction to a NOP and an ADR or a literal load, if they compute
+  /// the same address in the same register and the target is within 1MB
+  /// @return true if the pair is rewritten
+  bool relaxADRP(Relocation& pAdrp, Relocation& pLo12);
+
+  /// scanTLSReloc - relax the TLS sequences of an executable to the initial
+  /// exec or the local exec model, and reserve the GOT entries of the initial
+  /// exec model
+  void scanTLSReloc(Relocation& pReloc, const LDSection& pSection);
+
   /// addCopyReloc - add a copy relocation into .rel.dyn for pSym
   /// @param pSym - A resolved copy symbol that defined in BSS section
   void addCopyReloc(ResolveInfo& pSym);
@@ -136,6 +169,11 @@ class AArch64Relocator : public Relocator {
   SymPLTMap m_SymPLTMap;
   SymGOTMap m_SymGOTPLTMap;
   RelRelMap m_RelRelMap;
+
+  /// m_bCallMayOverflow, m_bCondBrMayOverflow - the B and BL branches, and
+  /// the conditional branches
+  bool m_bCallMayOverflow;
+  bool m_bCondBrMayOverflow;
 };
 
 }  // namespace mcld
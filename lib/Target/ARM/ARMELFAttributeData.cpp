@@ -1077,4 +1077,12 @@ bool ARMELFAttributeData::usingThumb2() const {
   return (arch == CPU_Arch_ARM_V6T2) || (arch == CPU_Arch_ARM_V7);
 }
 
+bool ARMELFAttributeData::hasBLX() const {
+  const ELFAttributeValue& arch = m_Attrs[Tag_CPU_arch];
+  if (!arch.isInitialized())
+    return true;
+  return (arch.getIntValue() >= CPU_Arch_ARM_V5T) &&
+         (arch.getIntValue() != CPU_Arch_ARM_V4T_Plus_V6_M);
+}
+
 }  // namespace mcld
@@ -182,6 +182,10 @@ class ARMELFAttributeData : public ELFAttributeData {
 
   virtual bool usingThumb2() const;
 
+  /// hasBLX - the output architecture has the BLX of an immediate, which is
+  /// ARMv5T or above. The inputs without Tag_CPU_arch are taken as ARMv5T.
+  bool hasBLX() const;
+
  private:
   /// GetAttributeValueType - obtain the value type of the indicated tag.
   static unsigned int GetAttributeValueType(TagType pTag);
@@ -39,12 +39,13 @@ void ARMExData::addInputMap(Input* pInput,
   ARMInputExMap* exMap = pExMap.get();
 
   // Add mapping to the input-to-exdata map.
-  m_Inputs.insert(std::make_pair(pInput, std::move(pExMap)));
+  m_Inputs[pInput] = exMap;
+  m_InputMaps.push_back(std::move(pExMap));
 
   // Add mapping to the fragment-to-exdata map.
   for (ARMInputExMap::iterator it = exMap->begin(), end = exMap->end();
        it != end; ++it) {
-    ARMExSectionTuple* exTuple = it->second.get();
+    ARMExSectionTuple* exTuple = it->get();
     m_ExIdxToTuple[exTuple->getExIdxFragment()] = exTuple;
   }
 }
@@ -64,56 +65,49 @@ std::unique_ptr<ARMInputExMap> ARMInputExMap::create(Input& pInput) {
 
   // Scan the input and collect all related sections.
   LDContext* ctx = pInput.context();
+  llvm::DenseMap<const LDSection*, LDSection*> exIdxRelocs;
+  for (LDContext::sect_iterator it = ctx->relocSectBegin(),
+                                end = ctx->relocSectEnd(); it != end; ++it) {
+    LDSection* relocSect = *it;
+    if (relocSect->getLink() != NULL &&
+        relocSect->getLink()->type() == llvm::ELF::SHT_ARM_EXIDX)
+      exIdxRelocs[relocSect->getLink()] = relocSect;
+  }
+
   for (LDContext::sect_iterator it = ctx->sectBegin(),
                                 end = ctx->sectEnd(); it != end; ++it) {
-    LDSection* sect = *it;
-    if (sect->type() == llvm::ELF::SHT_ARM_EXIDX) {
-      ARMExSectionTuple* exTuple = exMap->getOrCreateByExSection(*sect);
-      exTuple->setExIdxSection(sect);
-      exTuple->setTextSection(sect->getLink());
-      if (sect->getLink() == NULL) {
-        fatal(diag::eh_missing_text_section) << sect->name() << pInput.name();
-      }
-    }
-  }
+    LDSection* exIdx = *it;
+    if (exIdx->type() != llvm::ELF::SHT_ARM_EXIDX)
+      continue;
 
-  // Remove the invalid exception tuples and convert LDSection to RegionFragment
-  // or RelocData.
-  ARMInputExMap::iterator it = exMap->begin();
-  ARMInputExMap::iterator end = exMap->end();
-  while (it != end) {
-    ARMExSectionTuple* exTuple = it->second.get();
-    LDSection* const text = exTuple->getTextSection();
-    LDSection* const exIdx = exTuple->getExIdxSection();
+    LDSection* text = exIdx->getLink();
+    if (text == NULL) {
+      fatal(diag::eh_missing_text_section) << exIdx->name() << pInput.name();
+    }
 
     // Ignore the exception section if the text section is ignored.
     if ((text->kind() == LDFileFormat::Ignore) ||
         (text->kind() == LDFileFormat::Folded)) {
       // Set the related exception sections as LDFileFormat::Ignore.
       exIdx->setKind(LDFileFormat::Ignore);
-      // Remove this tuple from the input exception map.
-      ARMInputExMap::iterator deadIt = it++;
-      exMap->erase(deadIt);
       continue;
     }
 
-    // Get RegionFragment from ".text", ".ARM.exidx", and ".ARM.extab" sections.
-    RegionFragment* textFrag = findRegionFragment(*text);
+    // If there is no region fragment in the .ARM.exidx section, then we can
+    // skip this section.
     RegionFragment* exIdxFrag = findRegionFragment(*exIdx);
-
-    exTuple->setTextFragment(textFrag);
-    exTuple->setExIdxFragment(exIdxFrag);
-
-    // If there is no region fragment in the .ARM.extab section, then we can
-    // skip this tuple.
-    if (exIdxFrag == NULL) {
-      ARMInputExMap::iterator deadIt = it++;
-      exMap->erase(deadIt);
+    if (exIdxFrag == NULL)
       continue;
-    }
 
-    // Check next tuple
-    ++it;
+    // Get RegionFragment from ".text" and ".ARM.exidx" sections.
+    std::unique_ptr<ARMExSectionTuple> exTuple(new ARMExSectionTuple());
+    exTuple->setTextFragment(findRegionFragment(*text));
+    exTuple->setExIdxFragment(exIdxFrag);
+    llvm::DenseMap<const LDSection*, LDSection*>::iterator reloc =
+        exIdxRelocs.find(exIdx);
+    if (reloc != exIdxRelocs.end())
+      exTuple->setExIdxRelocSection(reloc->second);
+    exMap->m_Tuples.push_back(std::move(exTuple));
   }
 
   return exMap;
@@ -11,13 +11,14 @@
 
 #include "mcld/LD/LDSection.h"
 
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/PointerUnion.h>
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Support/ELF.h>
 
-#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace mcld {
 
@@ -33,7 +34,8 @@ class ARMExSectionTuple {
  public:
   ARMExSectionTuple()
       : m_pTextSection(NULL),
-        m_pExIdxSection(NULL) {
+        m_pExIdxSection(NULL),
+        m_pExIdxRelocSection(NULL) {
   }
 
   LDSection* getTextSection() const {
@@ -68,6 +70,16 @@ class ARMExSectionTuple {
     m_pExIdxFragment = pFragment;
   }
 
+  /// getExIdxRelocSection - the relocation section of the .ARM.exidx section,
+  /// or NULL if it has no relocation
+  LDSection* getExIdxRelocSection() const {
+    return m_pExIdxRelocSection;
+  }
+
+  void setExIdxRelocSection(LDSection* pSection) {
+    m_pExIdxRelocSection = pSection;
+  }
+
  private:
   // .text section
   union {
@@ -80,65 +92,44 @@ class ARMExSectionTuple {
     LDSection*      m_pExIdxSection;
     RegionFragment* m_pExIdxFragment;
   };
+
+  // relocation section of .ARM.exidx
+  LDSection* m_pExIdxRelocSection;
 };
 
 /// ARMInputExMap - ARM exception handling section mapping of a mcld::Input.
 class ARMInputExMap {
  public:
-  typedef std::map<LDSection*, std::unique_ptr<ARMExSectionTuple> > SectMap;
-  typedef SectMap::iterator iterator;
-  typedef SectMap::const_iterator const_iterator;
+  typedef std::vector<std::unique_ptr<ARMExSectionTuple> > TupleList;
+  typedef TupleList::iterator iterator;
+  typedef TupleList::const_iterator const_iterator;
 
  public:
   // create - Build the exception handling section mapping of a mcld::Input.
   static std::unique_ptr<ARMInputExMap> create(Input &input);
 
-  /// getByExSection - Get the ARMExSectionTuple by the address of the
-  /// .ARM.exidx section.
-  ARMExSectionTuple* getByExSection(LDSection &pSect) const {
-    assert(pSect.type() == llvm::ELF::SHT_ARM_EXIDX);
-    SectMap::const_iterator it = m_SectToExData.find(&pSect);
-    if (it == m_SectToExData.end()) {
-      return NULL;
-    }
-    return it->second.get();
-  }
+  /// begin - return the iterator to the first tuple, in the order of the
+  /// .ARM.exidx sections in the input
+  iterator       begin()       { return m_Tuples.begin(); }
+  const_iterator begin() const { return m_Tuples.begin(); }
 
-  /// getOrCreate - Get an existing or create a new ARMExSectionTuple which is
-  /// associated with the address of the .ARM.exidx section.
-  ARMExSectionTuple* getOrCreateByExSection(LDSection &pSect) {
-    assert(pSect.type() == llvm::ELF::SHT_ARM_EXIDX);
-    std::unique_ptr<ARMExSectionTuple>& result = m_SectToExData[&pSect];
-    if (!result) {
-      result.reset(new ARMExSectionTuple());
-    }
-    return result.get();
-  }
-
-  /// begin - return the iterator to the begin of the map
-  iterator       begin()       { return m_SectToExData.begin(); }
-  const_iterator begin() const { return m_SectToExData.begin(); }
-
-  /// end - return the iterator to the end of the map
-  iterator       end()       { return m_SectToExData.end(); }
-  const_iterator end() const { return m_SectToExData.end(); }
-
-  /// erase - remove an entry from the map
-  void erase(iterator it) { m_SectToExData.erase(it); }
+  /// end - return the iterator to the end of the tuples
+  iterator       end()       { return m_Tuples.end(); }
+  const_iterator end() const { return m_Tuples.end(); }
 
  private:
   ARMInputExMap() = default;
 
  private:
-  SectMap m_SectToExData;
+  TupleList m_Tuples;
 };
 
 /// ARMExData - ARM exception handling data of a mcld::Module.
 class ARMExData {
  private:
-  typedef std::map<Input*, std::unique_ptr<ARMInputExMap> > InputMap;
+  typedef llvm::DenseMap<const Input*, ARMInputExMap*> InputMap;
 
-  typedef std::map<const Fragment*, ARMExSectionTuple*> ExIdxMap;
+  typedef llvm::DenseMap<const Fragment*, ARMExSectionTuple*> ExIdxMap;
 
  public:
   // create - Build the exception handling section mapping of a mcld::Module.
@@ -154,7 +145,7 @@ class ARMExData {
     if (it == m_Inputs.end()) {
       return NULL;
     }
-    return it->second.get();
+    return it->second;
   }
 
   // getTupleByExIdx - get the ARMExSectionTuple corresponding to pExIdxFragment
@@ -170,6 +161,9 @@ class ARMExData {
   ARMExData() = default;
 
  private:
+  // ARMInputExMaps of the inputs, in the input order
+  std::vector<std::unique_ptr<ARMInputExMap> > m_InputMaps;
+
   // Map from Input to ARMInputExMap
   InputMap m_Inputs;
 
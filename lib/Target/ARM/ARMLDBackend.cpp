@@ -25,6 +25,7 @@
 #include "mcld/Fragment/FillFragment.h"
 #include "mcld/Fragment/NullFragment.h"
 #include "mcld/Fragment/RegionFragment.h"
+#include "mcld/Fragment/Relocation.h"
 #include "mcld/Fragment/Stub.h"
 #include "mcld/LD/BranchIslandFactory.h"
 #include "mcld/LD/ELFFileFormat.h"
@@ -37,6 +38,7 @@
 #include "mcld/Support/MemoryRegion.h"
 #include "mcld/Support/MsgHandling.h"
 #include "mcld/Support/TargetRegistry.h"
+#include "mcld/Support/ThreadPool.h"
 #include "mcld/Target/ELFAttribute.h"
 #include "mcld/Target/GNUInfo.h"
 
@@ -59,6 +61,41 @@ static const char g_CantUnwindEntry[8] = {
   1, 0, 0, 0,
 };
 
+/// EXIDX_CANTUNWIND in the second word of a .ARM.exidx entry.
+static const uint32_t g_CantUnwind = 0x1;
+
+/// Helper function to get the second word of the last entry of a .ARM.exidx
+/// fragment. The entries are little endian, as g_CantUnwindEntry.
+static uint32_t GetLastUnwindWord(const Fragment& pFrag) {
+  llvm::StringRef region = llvm::cast<RegionFragment>(pFrag).getRegion();
+  assert(region.size() >= 8 && "truncated .ARM.exidx entry");
+  const unsigned char* word =
+      reinterpret_cast<const unsigned char*>(region.data() + region.size() - 4);
+  return word[0] | (word[1] << 8) | (word[2] << 16) |
+         (static_cast<uint32_t>(word[3]) << 24);
+}
+
+/// Helper function to check if an unwind word is self-contained, i.e. either
+/// EXIDX_CANTUNWIND or an inlined table entry, so that equal words describe
+/// the same unwinding.
+static bool IsSelfContainedUnwindWord(uint32_t pWord) {
+  return pWord == g_CantUnwind || (pWord & 0x80000000) != 0;
+}
+
+/// Helper function to check if the .ARM.exidx entry of pTuple can be dropped
+/// because it unwinds the same as the entry before it, pPrevWord. Only an
+/// input section of a single entry whose sole relocation is the one to its
+/// text can be dropped.
+static bool CanMergeExIdx(const ARMExSectionTuple& pTuple, uint32_t pPrevWord) {
+  const Fragment* exIdxFrag = pTuple.getExIdxFragment();
+  const LDSection* relocSect = pTuple.getExIdxRelocSection();
+  if (exIdxFrag->size() != 8 || relocSect == NULL ||
+      !relocSect->hasRelocData() || relocSect->getRelocData()->size() != 1)
+    return false;
+  return IsSelfContainedUnwindWord(pPrevWord) &&
+         GetLastUnwindWord(*exIdxFrag) == pPrevWord;
+}
+
 /// Helper function to create a local symbol at the end of the fragment.
 static mcld::ResolveInfo*
 CreateLocalSymbolToFragmentEnd(mcld::Module& pModule, mcld::Fragment& pFrag) {
@@ -90,29 +127,20 @@ CreateLocalSymbolToFragmentEnd(mcld::Module& pModule, mcld::Fragment& pFrag) {
   return resolveInfo;
 }
 
-/// Comparator to sort .ARM.exidx fragments according to the address of the
+/// The key to sort .ARM.exidx fragments according to the address of the
 /// corresponding .text fragment.
-class ExIdxFragmentComparator {
+class ExIdxFragmentAddress {
  private:
   const ARMExData& m_pExData;
 
  public:
-  explicit ExIdxFragmentComparator(const ARMExData& pExData)
+  explicit ExIdxFragmentAddress(const ARMExData& pExData)
       : m_pExData(pExData) {
   }
 
-  bool operator()(const Fragment& a, const Fragment& b) {
-    ARMExSectionTuple* tupleA = m_pExData.getTupleByExIdx(&a);
-    ARMExSectionTuple* tupleB = m_pExData.getTupleByExIdx(&b);
-
-    Fragment* textFragA = tupleA->getTextFragment();
-    Fragment* textFragB = tupleB->getTextFragment();
-
-    uint64_t addrA = textFragA->getParent()->getSection().addr() +
-                     textFragA->getOffset();
-    uint64_t addrB = textFragB->getParent()->getSection().addr() +
-                     textFragB->getOffset();
-    return (addrA < addrB);
+  uint64_t operator()(const Fragment& pFrag) const {
+    Fragment* textFrag = m_pExData.getTupleByExIdx(&pFrag)->getTextFragment();
+    return textFrag->getParent()->getSection().addr() + textFrag->getOffset();
   }
 };
 
@@ -180,7 +208,7 @@ void ARMGNULDBackend::initTargetSections(Module& pModule,
 
     // initialize .plt
     LDSection& plt = file_format->getPLT();
-    m_pPLT = new ARMPLT(plt, *m_pGOT);
+    m_pPLT = new ARMPLT(plt, *m_pGOT, !config().options().hasNow());
 
     // initialize .rel.plt
     LDSection& relplt = file_format->getRelPlt();
@@ -322,6 +350,10 @@ void ARMGNULDBackend::doPreLayout(IRBuilder& pBuilder) {
   }
 }
 
+bool ARMGNULDBackend::isRelativeReloc(const Relocation& pReloc) const {
+  return (llvm::ELF::R_ARM_RELATIVE == pReloc.type());
+}
+
 void ARMGNULDBackend::doPostLayout(Module& pModule, IRBuilder& pBuilder) {
   const ELFFileFormat* file_format = getOutputFormat();
 
@@ -604,7 +636,7 @@ void ARMGNULDBackend::setUpReachedSectionsForGC(
             reached_sects = &pSectReachedListMap.getReachedList(*apply_sect);
             add_first = true;
           }
-          reached_sects->insert(target_sect);
+          reached_sects->push_back(target_sect);
         }
         reached_sects = NULL;
         add_first = false;
@@ -730,7 +762,7 @@ void ARMGNULDBackend::rewriteARMExIdxSection(Module& pModule) {
   }
 
   // Sort the region fragments in the .ARM.exidx output section.
-  sort(list, ExIdxFragmentComparator(*m_pExData));
+  sortByKey(list, ExIdxFragmentAddress(*m_pExData));
 
   // Fix the coverage of the .ARM.exidx table.
   llvm::StringRef cantUnwindRegion(g_CantUnwindEntry,
@@ -742,10 +774,11 @@ void ARMGNULDBackend::rewriteARMExIdxSection(Module& pModule) {
     uint64_t prevTextEnd = prevTextFrag->getParent()->getSection().addr() +
                            prevTextFrag->getOffset() +
                            prevTextFrag->size();
+    uint32_t prevUnwindWord = GetLastUnwindWord(*it);
     ++it;
     while (it != list.end()) {
-      Fragment* currTextFrag =
-          m_pExData->getTupleByExIdx(&*it)->getTextFragment();
+      ARMExSectionTuple* currTuple = m_pExData->getTupleByExIdx(&*it);
+      Fragment* currTextFrag = currTuple->getTextFragment();
       uint64_t currTextBegin = currTextFrag->getParent()->getSection().addr() +
                                currTextFrag->getOffset();
 
@@ -763,10 +796,22 @@ void ARMGNULDBackend::rewriteARMExIdxSection(Module& pModule) {
         reloc->setSymInfo(
             CreateLocalSymbolToFragmentEnd(pModule, *prevTextFrag));
         addExtraRelocation(reloc);
+        prevUnwindWord = g_CantUnwind;
       }
 
       prevTextEnd = currTextBegin + currTextFrag->size();
       prevTextFrag = currTextFrag;
+
+      if (CanMergeExIdx(*currTuple, prevUnwindWord)) {
+        // The previous entry covers this text as well. The relocation of the
+        // dropped entry still refers to its fragment, so the fragment is only
+        // unlinked and the relocation is ignored.
+        currTuple->getExIdxRelocSection()->setKind(LDFileFormat::Ignore);
+        list.remove(it);
+        continue;
+      }
+
+      prevUnwindWord = GetLastUnwindWord(*it);
       ++it;
     }
 
@@ -820,83 +865,79 @@ bool ARMGNULDBackend::doRelax(Module& pModule,
 
   bool isRelaxed = false;
   ELFFileFormat* file_format = getOutputFormat();
-  // check branch relocs and create the related stubs if needed
-  Module::obj_iterator input, inEnd = pModule.obj_end();
-  for (input = pModule.obj_begin(); input != inEnd; ++input) {
-    LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
-    for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
-      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
-        continue;
-      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
-      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
-        Relocation* relocation = llvm::cast<Relocation>(reloc);
-
-        switch (relocation->type()) {
-          case llvm::ELF::R_ARM_PC24:
-          case llvm::ELF::R_ARM_CALL:
-          case llvm::ELF::R_ARM_JUMP24:
-          case llvm::ELF::R_ARM_PLT32:
-          case llvm::ELF::R_ARM_THM_CALL:
-          case llvm::ELF::R_ARM_THM_XPC22:
-          case llvm::ELF::R_ARM_THM_JUMP24:
-          case llvm::ELF::R_ARM_THM_JUMP19: {
-            // calculate the possible symbol value
-            uint64_t sym_value = 0x0;
-            LDSymbol* symbol = relocation->symInfo()->outSymbol();
-            if (symbol->hasFragRef()) {
-              uint64_t value = symbol->fragRef()->getOutputOffset();
-              uint64_t addr =
-                  symbol->fragRef()->frag()->getParent()->getSection().addr();
-              sym_value = addr + value;
-            }
-            if ((relocation->symInfo()->reserved() &
-                 ARMRelocator::ReservePLT) != 0x0) {
-              // FIXME: we need to find out the address of the specific plt
-              // entry
-              assert(file_format->hasPLT());
-              sym_value = file_format->getPLT().addr();
-            }
-            Stub* stub = getStubFactory()->create(*relocation,  // relocation
-                                                  sym_value,    // symbol value
-                                                  pBuilder,
-                                                  *getBRIslandFactory());
-            if (stub != NULL) {
-              assert(stub->symInfo() != NULL);
-              // reset the branch target of the reloc to this stub instead
-              relocation->setSymInfo(stub->symInfo());
-
-              switch (config().options().getStripSymbolMode()) {
-                case GeneralOptions::StripSymbolMode::StripAllSymbols:
-                case GeneralOptions::StripSymbolMode::StripLocals:
-                  break;
-                default: {
-                  // a stub symbol should be local
-                  assert(stub->symInfo() != NULL && stub->symInfo()->isLocal());
-                  LDSection& symtab = file_format->getSymTab();
-                  LDSection& strtab = file_format->getStrTab();
-
-                  // increase the size of .symtab and .strtab if needed
-                  symtab.setSize(symtab.size() + sizeof(llvm::ELF::Elf32_Sym));
-                  symtab.setInfo(symtab.getInfo() + 1);
-                  strtab.setSize(strtab.size() + stub->symInfo()->nameSize() +
-                                 1);
-                }
-              }  // end of switch
-              isRelaxed = true;
-            }
-            break;
-          }
-          case llvm::ELF::R_ARM_V4BX:
-            /* FIXME: bypass R_ARM_V4BX relocation now */
-            break;
-          default:
-            break;
-        }  // end of switch
-      }  // for all relocations
-    }  // for all relocation section
-  }  // for all inputs
+  // find the branch relocs which need stubs by the current layout
+  StubFactory::CandidateList candidates;
+  StubFactory::BranchTarget target = [&](const Relocation& pReloc,
+                                         uint64_t& pTarget) {
+    switch (pReloc.type()) {
+      case llvm::ELF::R_ARM_PC24:
+      case llvm::ELF::R_ARM_CALL:
+      case llvm::ELF::R_ARM_JUMP24:
+      case llvm::ELF::R_ARM_PLT32:
+      case llvm::ELF::R_ARM_THM_CALL:
+      case llvm::ELF::R_ARM_THM_XPC22:
+      case llvm::ELF::R_ARM_THM_JUMP24:
+      case llvm::ELF::R_ARM_THM_JUMP19:
+        break;
+      case llvm::ELF::R_ARM_V4BX:
+        /* FIXME: bypass R_ARM_V4BX relocation now */
+        return false;
+      default:
+        return false;
+    }
 
-  // find the first fragment w/ invalid offset due to stub insertion
+    // calculate the possible symbol value
+    pTarget = 0x0;
+    const LDSymbol* symbol = pReloc.symInfo()->outSymbol();
+    if (symbol->hasFragRef()) {
+      uint64_t value = symbol->fragRef()->getOutputOffset();
+      uint64_t addr =
+          symbol->fragRef()->frag()->getParent()->getSection().addr();
+      pTarget = addr + value;
+    }
+    if ((pReloc.symInfo()->reserved() & ARMRelocator::ReservePLT) != 0x0) {
+      // FIXME: we need to find out the address of the specific plt entry
+      assert(file_format->hasPLT());
+      pTarget = file_format->getPLT().addr();
+    }
+    return true;
+  };
+  ThreadPool pool(config().options().numThreads());
+  getStubFactory()->findStubs(pModule, target, pool, candidates);
+
+  // create the stubs in the order of the inputs
+  StubFactory::CandidateList::iterator cand, candEnd = candidates.end();
+  for (cand = candidates.begin(); cand != candEnd; ++cand) {
+    Relocation* relocation = cand->reloc;
+    Stub* stub = getStubFactory()->create(
+        *relocation, *cand->prototype, pBuilder, *getBRIslandFactory());
+    if (stub == NULL)
+      continue;
+
+    assert(stub->symInfo() != NULL);
+    // reset the branch target of the reloc to this stub instead
+    relocation->setSymInfo(stub->symInfo());
+
+    switch (config().options().getStripSymbolMode()) {
+      case GeneralOptions::StripSymbolMode::StripAllSymbols:
+      case GeneralOptions::StripSymbolMode::StripLocals:
+        break;
+      default: {
+        // a stub symbol should be local
+        assert(stub->symInfo() != NULL && stub->symInfo()->isLocal());
+        LDSection& symtab = file_format->getSymTab();
+        LDSection& strtab = file_format->getStrTab();
+
+        // increase the size of .symtab and .strtab if needed
+        symtab.setSize(symtab.size() + sizeof(llvm::ELF::Elf32_Sym));
+        symtab.setInfo(symtab.getInfo() + 1);
+        strtab.setSize(strtab.size() + stub->symInfo()->nameSize() + 1);
+      }
+    }  // end of switch
+    isRelaxed = true;
+  }  // for all candidates
+
+  // find the fragments w/ invalid offset due to stub insertion
   std::vector<Fragment*> invalid_frags;
   pFinished = true;
   for (BranchIslandFactory::iterator island = getBRIslandFactory()->begin(),
@@ -918,11 +959,8 @@ bool ARMGNULDBackend::doRelax(Module& pModule,
     }
 
     if (((*island).offset() + (*island).size()) > exit->getOffset()) {
-      if (invalid_frags.empty() ||
-          (invalid_frags.back()->getParent() != (*island).getParent())) {
-        invalid_frags.push_back(exit);
-        pFinished = false;
-      }
+      invalid_frags.push_back(exit);
+      pFinished = false;
       continue;
     }
   }
@@ -930,12 +968,7 @@ bool ARMGNULDBackend::doRelax(Module& pModule,
   // reset the offset of invalid fragments
   for (auto it = invalid_frags.begin(), ie = invalid_frags.end(); it != ie;
        ++it) {
-    Fragment* invalid = *it;
-    while (invalid != NULL) {
-      invalid->setOffset(invalid->getPrevNode()->getOffset() +
-                         invalid->getPrevNode()->size());
-      invalid = invalid->getNextNode();
-    }
+    (*it)->getParent()->updateOffsets(**it);
   }
 
   // reset the size of section that has stubs inserted.
@@ -961,11 +994,14 @@ bool ARMGNULDBackend::doRelax(Module& pModule,
 bool ARMGNULDBackend::initTargetStubs() {
   if (getStubFactory() != NULL) {
     getStubFactory()->addPrototype(new ARMToARMStub(config().isCodeIndep()));
-    getStubFactory()->addPrototype(new ARMToTHMStub(config().isCodeIndep()));
+    getStubFactory()->addPrototype(
+        new ARMToTHMStub(config().isCodeIndep(), m_pAttrData->hasBLX()));
     getStubFactory()->addPrototype(
         new THMToTHMStub(config().isCodeIndep(), m_pAttrData->usingThumb2()));
     getStubFactory()->addPrototype(
-        new THMToARMStub(config().isCodeIndep(), m_pAttrData->usingThumb2()));
+        new THMToARMStub(config().isCodeIndep(),
+                         m_pAttrData->usingThumb2(),
+                         m_pAttrData->hasBLX()));
     return true;
   }
   return false;
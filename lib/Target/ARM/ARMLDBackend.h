@@ -169,6 +169,9 @@ class ARMGNULDBackend : public GNULDBackend {
     return 12;
   }
 
+  /// isRelativeReloc - check if pReloc is R_ARM_RELATIVE
+  bool isRelativeReloc(const Relocation& pReloc) const;
+
   /// doCreateProgramHdrs - backend can implement this function to create the
   /// target-dependent segments
   virtual void doCreateProgramHdrs(Module& pModule);
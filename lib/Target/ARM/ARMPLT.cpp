@@ -27,29 +27,27 @@ ARMPLT1::ARMPLT1(SectionData& pParent) : PLT::Entry<sizeof(arm_plt1)>(pParent) {
 //===----------------------------------------------------------------------===//
 // ARMPLT
 
-ARMPLT::ARMPLT(LDSection& pSection, ARMGOT& pGOTPLT)
-    : PLT(pSection), m_GOT(pGOTPLT) {
-  new ARMPLT0(*m_pSectionData);
+ARMPLT::ARMPLT(LDSection& pSection, ARMGOT& pGOTPLT, bool pLazy)
+    : PLT(pSection), m_GOT(pGOTPLT), m_bLazy(pLazy) {
+  if (m_bLazy)
+    new ARMPLT0(*m_pSectionData);
 }
 
 ARMPLT::~ARMPLT() {
 }
 
 bool ARMPLT::hasPLT1() const {
-  return (m_pSectionData->size() > 1);
+  return (m_pSectionData->size() > (m_bLazy ? 1u : 0u));
 }
 
 void ARMPLT::finalizeSectionSize() {
-  uint64_t size =
-      (m_pSectionData->size() - 1) * sizeof(arm_plt1) + sizeof(arm_plt0);
-  m_Section.setSize(size);
-
   uint32_t offset = 0;
   SectionData::iterator frag, fragEnd = m_pSectionData->end();
   for (frag = m_pSectionData->begin(); frag != fragEnd; ++frag) {
     frag->setOffset(offset);
     offset += frag->size();
   }
+  m_Section.setSize(offset);
 }
 
 ARMPLT1* ARMPLT::create() {
@@ -60,6 +58,9 @@ ARMPLT1* ARMPLT::create() {
 }
 
 void ARMPLT::applyPLT0() {
+  if (!m_bLazy)
+    return;
+
   uint64_t plt_base = m_Section.addr();
   assert(plt_base && ".plt base address is NULL!");
 
@@ -106,9 +107,13 @@ void ARMPLT::applyPLT1() {
   uint32_t GOTEntrySize = ARMGOTEntry::EntrySize;
   uint32_t GOTEntryAddress = got_base + GOTEntrySize * 3;
 
-  uint64_t PLTEntryAddress = plt_base + ARMPLT0::EntrySize;  // Offset of PLT0
-
-  ++it;  // skip PLT0
+  uint64_t PLTEntryAddress = plt_base;
+  const uint32_t* PLT1Template = arm_nonlazy_plt1;
+  if (m_bLazy) {
+    PLTEntryAddress += ARMPLT0::EntrySize;  // Offset of PLT0
+    PLT1Template = arm_plt1;
+    ++it;  // skip PLT0
+  }
   uint64_t PLT1EntrySize = ARMPLT1::EntrySize;
   ARMPLT1* plt1 = NULL;
 
@@ -124,9 +129,9 @@ void ARMPLT::applyPLT1() {
     // GOT entry.
     int32_t Offset = (GOTEntryAddress - (PLTEntryAddress + 8));
 
-    Out[0] = arm_plt1[0] | ((Offset >> 20) & 0xFF);
-    Out[1] = arm_plt1[1] | ((Offset >> 12) & 0xFF);
-    Out[2] = arm_plt1[2] | (Offset & 0xFFF);
+    Out[0] = PLT1Template[0] | ((Offset >> 20) & 0xFF);
+    Out[1] = PLT1Template[1] | ((Offset >> 12) & 0xFF);
+    Out[2] = PLT1Template[2] | (Offset & 0xFFF);
 
     plt1->setValue(reinterpret_cast<unsigned char*>(Out));
     ++it;
@@ -135,25 +140,22 @@ void ARMPLT::applyPLT1() {
     PLTEntryAddress += PLT1EntrySize;
   }
 
-  m_GOT.applyGOTPLT(plt_base);
+  // the loader binds the slots of a non-lazy PLT before they are used
+  if (m_bLazy)
+    m_GOT.applyGOTPLT(plt_base);
 }
 
 uint64_t ARMPLT::emit(MemoryRegion& pRegion) {
   uint64_t result = 0x0;
-  iterator it = begin();
-
   unsigned char* buffer = pRegion.begin();
-  memcpy(buffer, llvm::cast<ARMPLT0>((*it)).getValue(), ARMPLT0::EntrySize);
-  result += ARMPLT0::EntrySize;
-  ++it;
 
-  ARMPLT1* plt1 = 0;
-  ARMPLT::iterator ie = end();
-  while (it != ie) {
-    plt1 = &(llvm::cast<ARMPLT1>(*it));
-    memcpy(buffer + result, plt1->getValue(), ARMPLT1::EntrySize);
-    result += ARMPLT1::EntrySize;
-    ++it;
+  // PLT0, if any, and the PLT1 entries
+  PLTEntryBase* entry = 0;
+  ARMPLT::iterator it, ie = end();
+  for (it = begin(); it != ie; ++it) {
+    entry = &(llvm::cast<PLTEntryBase>(*it));
+    memcpy(buffer + result, entry->getValue(), entry->size());
+    result += entry->size();
   }
   return result;
 }
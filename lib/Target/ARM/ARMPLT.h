@@ -27,6 +27,14 @@ const uint32_t arm_plt1[] = {
     0xe5bcf000   // ldr   pc, [ip, #0xNNN]!
 };
 
+// the entry of the non-lazy PLT of -z now, which leaves no GOT address in ip
+// for PLT0
+const uint32_t arm_nonlazy_plt1[] = {
+    0xe28fc600,  // add   ip, pc, #0xNN00000
+    0xe28cca00,  // add   ip, ip, #0xNN000
+    0xe59cf000   // ldr   pc, [ip, #0xNNN]
+};
+
 namespace mcld {
 
 class ARMGOT;
@@ -43,10 +51,12 @@ class ARMPLT1 : public PLT::Entry<sizeof(arm_plt1)> {
 
 /** \class ARMPLT
  *  \brief ARM Procedure Linkage Table
+ *
+ *  A non-lazy PLT, for -z now, has no PLT0.
  */
 class ARMPLT : public PLT {
  public:
-  ARMPLT(LDSection& pSection, ARMGOT& pGOTPLT);
+  ARMPLT(LDSection& pSection, ARMGOT& pGOTPLT, bool pLazy);
   ~ARMPLT();
 
   // finalizeSectionSize - set LDSection size
@@ -55,6 +65,9 @@ class ARMPLT : public PLT {
   // hasPLT1 - return if this plt section has any plt1 entry
   bool hasPLT1() const;
 
+  // isLazy - return if the entries are bound by the lazy resolver of PLT0
+  bool isLazy() const { return m_bLazy; }
+
   ARMPLT1* create();
 
   ARMPLT0* getPLT0() const;
@@ -67,6 +80,7 @@ class ARMPLT : public PLT {
 
  private:
   ARMGOT& m_GOT;
+  bool m_bLazy;
 };
 
 }  // namespace mcld
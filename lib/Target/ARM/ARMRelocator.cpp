@@ -6,6 +6,7 @@
 // License. See LICENSE.TXT for details.
 //
 //===----------------------------------------------------------------------===//
+#include "ARMELFAttributeData.h"
 #include "ARMRelocator.h"
 #include "ARMRelocationFunctions.h"
 
@@ -327,6 +328,7 @@ void ARMRelocator::addCopyReloc(ResolveInfo& pSym) {
   assert(pSym.outSymbol()->hasFragRef());
   rel_entry.targetRef().assign(*pSym.outSymbol()->fragRef());
   rel_entry.setSymInfo(&pSym);
+  getTarget().noteCopyReloc(pSym);
 }
 
 /// defineSymbolForCopyReloc
@@ -1012,15 +1014,16 @@ ARMRelocator::Result call(Relocation& pReloc, ARMRelocator& pParent) {
   }
 
   // At this moment (after relaxation), if the jump target is thumb instruction,
-  // switch mode is needed, rewrite the instruction to BLX
-  // FIXME: check if we can use BLX instruction (check from .ARM.attribute
-  // CPU ARCH TAG, which should be ARMv5 or above)
+  // switch mode is needed, rewrite the instruction to BLX. Before ARMv5T,
+  // the stubs switch the mode instead.
   if (T != 0) {
     // cannot rewrite to blx for R_ARM_JUMP24
     if (pReloc.type() == llvm::ELF::R_ARM_JUMP24)
       return Relocator::BadReloc;
     if (pReloc.type() == llvm::ELF::R_ARM_PC24)
       return Relocator::BadReloc;
+    if (!pParent.getTarget().getAttributeData().hasBLX())
+      return Relocator::BadReloc;
 
     pReloc.target() =
         (pReloc.target() & 0xffffff) | 0xfa000000 | (((S + A - P) & 2) << 23);
@@ -1071,13 +1074,14 @@ ARMRelocator::Result thm_call(Relocation& pReloc, ARMRelocator& pParent) {
   S = S + A;
 
   // At this moment (after relaxation), if the jump target is arm
-  // instruction, switch mode is needed, rewrite the instruction to BLX
-  // FIXME: check if we can use BLX instruction (check from .ARM.attribute
-  // CPU ARCH TAG, which should be ARMv5 or above)
+  // instruction, switch mode is needed, rewrite the instruction to BLX.
+  // Before ARMv5T, the stubs switch the mode instead.
   if (T == 0) {
     // cannot rewrite to blx for R_ARM_THM_JUMP24
     if (pReloc.type() == llvm::ELF::R_ARM_THM_JUMP24)
       return Relocator::BadReloc;
+    if (!pParent.getTarget().getAttributeData().hasBLX())
+      return Relocator::BadReloc;
 
     // for BLX, select bit 1 from relocation base address to jump target
     // address
@@ -85,6 +85,14 @@ bool ARMToARMStub::isMyDuty(const class Relocation& pReloc,
   return result;
 }
 
+bool ARMToARMStub::getDutyTypes(std::vector<Type>& pTypes) const {
+  pTypes.push_back(llvm::ELF::R_ARM_PC24);
+  pTypes.push_back(llvm::ELF::R_ARM_CALL);
+  pTypes.push_back(llvm::ELF::R_ARM_JUMP24);
+  pTypes.push_back(llvm::ELF::R_ARM_PLT32);
+  return true;
+}
+
 const std::string& ARMToARMStub::name() const {
   return m_Name;
 }
@@ -34,6 +34,8 @@ class ARMToARMStub : public Stub {
                 uint64_t pSource,
                 uint64_t pTargetSymValue) const;
 
+  bool getDutyTypes(std::vector<Type>& pTypes) const;
+
   // observers
   const std::string& name() const;
 
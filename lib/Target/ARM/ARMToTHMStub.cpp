@@ -34,8 +34,11 @@ const uint32_t ARMToTHMStub::TEMPLATE[] = {
     0x0          // dcd   R_ARM_ABS32(X)
 };
 
-ARMToTHMStub::ARMToTHMStub(bool pIsOutputPIC)
-    : m_pData(NULL), m_Name("A2T_prototype"), m_Size(0x0) {
+ARMToTHMStub::ARMToTHMStub(bool pIsOutputPIC, bool pHasBLX)
+    : m_pData(NULL),
+      m_Name("A2T_prototype"),
+      m_Size(0x0),
+      m_bHasBLX(pHasBLX) {
   if (pIsOutputPIC) {
     m_pData = PIC_TEMPLATE;
     m_Size = sizeof(PIC_TEMPLATE);
@@ -51,8 +54,12 @@ ARMToTHMStub::ARMToTHMStub(bool pIsOutputPIC)
 ARMToTHMStub::ARMToTHMStub(const uint32_t* pData,
                            size_t pSize,
                            const_fixup_iterator pBegin,
-                           const_fixup_iterator pEnd)
-    : m_pData(pData), m_Name("A2T_veneer"), m_Size(pSize) {
+                           const_fixup_iterator pEnd,
+                           bool pHasBLX)
+    : m_pData(pData),
+      m_Name("A2T_veneer"),
+      m_Size(pSize),
+      m_bHasBLX(pHasBLX) {
   for (const_fixup_iterator it = pBegin, ie = pEnd; it != ie; ++it)
     addFixup(**it);
 }
@@ -68,8 +75,12 @@ bool ARMToTHMStub::isMyDuty(const class Relocation& pReloc,
   if ((pTargetSymValue & 0x1) != 0x0) {
     switch (pReloc.type()) {
       case llvm::ELF::R_ARM_CALL: {
-        // FIXME: Assuming blx is available (i.e., target is armv5 or above!)
-        // then, we do not need a stub unless the branch target is too far.
+        // with blx, we do not need a stub unless the branch target is too
+        // far
+        if (!m_bHasBLX) {
+          result = true;
+          break;
+        }
         uint64_t dest = pTargetSymValue + pReloc.addend() + 8u;
         int64_t branch_offset = static_cast<int64_t>(dest) - pSource;
         if ((branch_offset > ARMGNULDBackend::ARM_MAX_FWD_BRANCH_OFFSET) ||
@@ -93,6 +104,14 @@ bool ARMToTHMStub::isMyDuty(const class Relocation& pReloc,
   return result;
 }
 
+bool ARMToTHMStub::getDutyTypes(std::vector<Type>& pTypes) const {
+  pTypes.push_back(llvm::ELF::R_ARM_CALL);
+  pTypes.push_back(llvm::ELF::R_ARM_PC24);
+  pTypes.push_back(llvm::ELF::R_ARM_JUMP24);
+  pTypes.push_back(llvm::ELF::R_ARM_PLT32);
+  return true;
+}
+
 const std::string& ARMToTHMStub::name() const {
   return m_Name;
 }
@@ -110,7 +129,8 @@ size_t ARMToTHMStub::alignment() const {
 }
 
 Stub* ARMToTHMStub::doClone() {
-  return new ARMToTHMStub(m_pData, m_Size, fixup_begin(), fixup_end());
+  return new ARMToTHMStub(
+      m_pData, m_Size, fixup_begin(), fixup_end(), m_bHasBLX);
 }
 
 }  // namespace mcld
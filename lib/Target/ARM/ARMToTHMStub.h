@@ -25,7 +25,9 @@ class ResolveInfo;
  */
 class ARMToTHMStub : public Stub {
  public:
-  explicit ARMToTHMStub(bool pIsOutputPIC);
+  /// @param pHasBLX - a BL which is in range is rewritten to BLX instead of
+  /// calling a stub
+  ARMToTHMStub(bool pIsOutputPIC, bool pHasBLX);
 
   ~ARMToTHMStub();
 
@@ -34,6 +36,8 @@ class ARMToTHMStub : public Stub {
                 uint64_t pSource,
                 uint64_t pTargetSymValue) const;
 
+  bool getDutyTypes(std::vector<Type>& pTypes) const;
+
   // observers
   const std::string& name() const;
 
@@ -52,7 +56,8 @@ class ARMToTHMStub : public Stub {
   ARMToTHMStub(const uint32_t* pData,
                size_t pSize,
                const_fixup_iterator pBegin,
-               const_fixup_iterator pEnd);
+               const_fixup_iterator pEnd,
+               bool pHasBLX);
 
   /// doClone
   Stub* doClone();
@@ -63,6 +68,7 @@ class ARMToTHMStub : public Stub {
   const uint32_t* m_pData;
   std::string m_Name;
   size_t m_Size;
+  bool m_bHasBLX;
 };
 
 }  // namespace mcld
@@ -34,11 +34,14 @@ const uint32_t THMToARMStub::TEMPLATE[] = {
     0x0          // dcd   R_ARM_ABS32(X)
 };
 
-THMToARMStub::THMToARMStub(bool pIsOutputPIC, bool pUsingThumb2)
+THMToARMStub::THMToARMStub(bool pIsOutputPIC,
+                           bool pUsingThumb2,
+                           bool pHasBLX)
     : m_pData(NULL),
       m_Name("T2A_prototype"),
       m_Size(0x0),
-      m_bUsingThumb2(pUsingThumb2) {
+      m_bUsingThumb2(pUsingThumb2),
+      m_bHasBLX(pHasBLX) {
   if (pIsOutputPIC) {
     m_pData = PIC_TEMPLATE;
     m_Size = sizeof(PIC_TEMPLATE);
@@ -55,11 +58,13 @@ THMToARMStub::THMToARMStub(const uint32_t* pData,
                            size_t pSize,
                            const_fixup_iterator pBegin,
                            const_fixup_iterator pEnd,
-                           bool pUsingThumb2)
+                           bool pUsingThumb2,
+                           bool pHasBLX)
     : m_pData(pData),
       m_Name("T2A_veneer"),
       m_Size(pSize),
-      m_bUsingThumb2(pUsingThumb2) {
+      m_bUsingThumb2(pUsingThumb2),
+      m_bHasBLX(pHasBLX) {
   for (const_fixup_iterator it = pBegin, ie = pEnd; it != ie; ++it)
     addFixup(**it);
 }
@@ -75,8 +80,12 @@ bool THMToARMStub::isMyDuty(const class Relocation& pReloc,
   if ((pTargetSymValue & 0x1) == 0x0) {
     switch (pReloc.type()) {
       case llvm::ELF::R_ARM_THM_CALL: {
-        // FIXME: Assuming blx is available (i.e., target is armv5 or above!)
-        // then, we do not need a stub unless the branch target is too far.
+        // with blx, we do not need a stub unless the branch target is too
+        // far
+        if (!m_bHasBLX) {
+          result = true;
+          break;
+        }
         uint64_t dest = pTargetSymValue + pReloc.addend() + 4u;
         int64_t branch_offset = static_cast<int64_t>(dest) - pSource;
         if (m_bUsingThumb2) {
@@ -106,6 +115,12 @@ bool THMToARMStub::isMyDuty(const class Relocation& pReloc,
   return result;
 }
 
+bool THMToARMStub::getDutyTypes(std::vector<Type>& pTypes) const {
+  pTypes.push_back(llvm::ELF::R_ARM_THM_CALL);
+  pTypes.push_back(llvm::ELF::R_ARM_THM_JUMP24);
+  return true;
+}
+
 const std::string& THMToARMStub::name() const {
   return m_Name;
 }
@@ -129,7 +144,7 @@ uint64_t THMToARMStub::initSymValue() const {
 
 Stub* THMToARMStub::doClone() {
   return new THMToARMStub(
-      m_pData, m_Size, fixup_begin(), fixup_end(), m_bUsingThumb2);
+      m_pData, m_Size, fixup_begin(), fixup_end(), m_bUsingThumb2, m_bHasBLX);
 }
 
 }  // namespace mcld
@@ -24,7 +24,9 @@ class ResolveInfo;
  */
 class THMToARMStub : public Stub {
  public:
-  THMToARMStub(bool pIsOutputPIC, bool pUsingThumb2);
+  /// @param pHasBLX - a BL which is in range is rewritten to BLX instead of
+  /// calling a stub
+  THMToARMStub(bool pIsOutputPIC, bool pUsingThumb2, bool pHasBLX);
 
   ~THMToARMStub();
 
@@ -33,6 +35,8 @@ class THMToARMStub : public Stub {
                 uint64_t pSource,
                 uint64_t pTargetSymValue) const;
 
+  bool getDutyTypes(std::vector<Type>& pTypes) const;
+
   // observers
   const std::string& name() const;
 
@@ -55,7 +59,8 @@ class THMToARMStub : public Stub {
                size_t pSize,
                const_fixup_iterator pBegin,
                const_fixup_iterator pEnd,
-               bool pUsingThumb2);
+               bool pUsingThumb2,
+               bool pHasBLX);
 
   /// doClone
   Stub* doClone();
@@ -67,6 +72,7 @@ class THMToARMStub : public Stub {
   std::string m_Name;
   size_t m_Size;
   bool m_bUsingThumb2;
+  bool m_bHasBLX;
 };
 
 }  // namespace mcld
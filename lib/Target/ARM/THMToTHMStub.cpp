@@ -103,6 +103,12 @@ bool THMToTHMStub::isMyDuty(const class Relocation& pReloc,
   return result;
 }
 
+bool THMToTHMStub::getDutyTypes(std::vector<Type>& pTypes) const {
+  pTypes.push_back(llvm::ELF::R_ARM_THM_CALL);
+  pTypes.push_back(llvm::ELF::R_ARM_THM_JUMP24);
+  return true;
+}
+
 const std::string& THMToTHMStub::name() const {
   return m_Name;
 }
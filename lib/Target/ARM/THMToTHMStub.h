@@ -33,6 +33,8 @@ class THMToTHMStub : public Stub {
                 uint64_t pSource,
                 uint64_t pTargetSymValue) const;
 
+  bool getDutyTypes(std::vector<Type>& pTypes) const;
+
   // observers
   const std::string& name() const;
 
@@ -70,6 +70,11 @@ bool ELFAttribute::merge(const Input& pInput, LDSection& pInputAttrSectHdr) {
     return true;
   }
 
+  // Skip the section if the same content has been merged.
+  if (!m_MergedContents.insert(region.substr(0, pInputAttrSectHdr.size()))
+           .second)
+    return true;
+
   size_t subsection_offset = FormatVersionFieldSize;
 
   // Iterate all subsections containing in this attribute section.
@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include "mcld/LD/ELFFileFormat.h"
+#include "mcld/Support/ELF.h"
 #include "mcld/Support/MsgHandling.h"
 #include "mcld/Target/ELFDynamic.h"
 #include "mcld/Target/GNULDBackend.h"
@@ -15,53 +16,22 @@
 #include <llvm/Support/ErrorHandling.h>
 #include <llvm/Support/Host.h>
 
-namespace mcld {
-namespace elf_dynamic {
-
-//===----------------------------------------------------------------------===//
-// elf_dynamic::EntryIF
-//===----------------------------------------------------------------------===//
-EntryIF::EntryIF() {
-}
+#include <cstring>
 
-EntryIF::~EntryIF() {
-}
-
-}  // namespace elf_dynamic
+namespace mcld {
 
 //===----------------------------------------------------------------------===//
 // ELFDynamic
 //===----------------------------------------------------------------------===//
 ELFDynamic::ELFDynamic(const GNULDBackend& pParent, const LinkerConfig& pConfig)
-    : m_pEntryFactory(NULL), m_Backend(pParent), m_Config(pConfig), m_Idx(0) {
-  // FIXME: support big-endian machine.
-  if (m_Config.targets().is32Bits()) {
-    if (m_Config.targets().isLittleEndian())
-      m_pEntryFactory = new elf_dynamic::Entry<32, true>();
-  } else if (m_Config.targets().is64Bits()) {
-    if (m_Config.targets().isLittleEndian())
-      m_pEntryFactory = new elf_dynamic::Entry<64, true>();
-  } else {
+    : m_Backend(pParent), m_Config(pConfig), m_Idx(0) {
+  if (!m_Config.targets().is32Bits() && !m_Config.targets().is64Bits()) {
     fatal(diag::unsupported_bitclass) << m_Config.targets().triple().str()
                                       << m_Config.targets().bitclass();
   }
 }
 
 ELFDynamic::~ELFDynamic() {
-  if (m_pEntryFactory != NULL)
-    delete m_pEntryFactory;
-
-  EntryListType::iterator entry, entryEnd = m_EntryList.end();
-  for (entry = m_EntryList.begin(); entry != entryEnd; ++entry) {
-    if (*entry != NULL)
-      delete (*entry);
-  }
-
-  entryEnd = m_NeedList.end();
-  for (entry = m_NeedList.begin(); entry != entryEnd; ++entry) {
-    if (*entry != NULL)
-      delete (*entry);
-  }
 }
 
 size_t ELFDynamic::size() const {
@@ -73,17 +43,18 @@ size_t ELFDynamic::numOfBytes() const {
 }
 
 size_t ELFDynamic::entrySize() const {
-  return m_pEntryFactory->size();
+  if (m_Config.targets().is32Bits())
+    return sizeof(llvm::ELF::Elf32_Dyn);
+  return sizeof(llvm::ELF::Elf64_Dyn);
 }
 
 void ELFDynamic::reserveOne(uint64_t pTag) {
-  assert(m_pEntryFactory != NULL);
-  m_EntryList.push_back(m_pEntryFactory->clone());
+  m_EntryList.push_back(Entry());
 }
 
 void ELFDynamic::applyOne(uint64_t pTag, uint64_t pValue) {
   assert(m_Idx < m_EntryList.size());
-  m_EntryList[m_Idx]->setValue(pTag, pValue);
+  m_EntryList[m_Idx].setValue(pTag, pValue);
   ++m_Idx;
 }
 
@@ -142,15 +113,31 @@ void ELFDynamic::reserveEntries(const ELFFileFormat& pFormat) {
   }
 
   if (pFormat.hasRelDyn()) {
-    reserveOne(llvm::ELF::DT_REL);
-    reserveOne(llvm::ELF::DT_RELSZ);
-    reserveOne(llvm::ELF::DT_RELENT);
+    if (ELF::SHT_ANDROID_REL == pFormat.getRelDyn().type()) {
+      reserveOne(ELF::DT_ANDROID_REL);
+      reserveOne(ELF::DT_ANDROID_RELSZ);
+    } else {
+      reserveOne(llvm::ELF::DT_REL);
+      reserveOne(llvm::ELF::DT_RELSZ);
+      reserveOne(llvm::ELF::DT_RELENT);
+    }
   }
 
   if (pFormat.hasRelaDyn()) {
-    reserveOne(llvm::ELF::DT_RELA);
-    reserveOne(llvm::ELF::DT_RELASZ);
-    reserveOne(llvm::ELF::DT_RELAENT);
+    if (ELF::SHT_ANDROID_RELA == pFormat.getRelaDyn().type()) {
+      reserveOne(ELF::DT_ANDROID_RELA);
+      reserveOne(ELF::DT_ANDROID_RELASZ);
+    } else {
+      reserveOne(llvm::ELF::DT_RELA);
+      reserveOne(llvm::ELF::DT_RELASZ);
+      reserveOne(llvm::ELF::DT_RELAENT);
+    }
+  }
+
+  if (pFormat.hasRelrDyn()) {
+    reserveOne(ELF::DT_RELR);
+    reserveOne(ELF::DT_RELRSZ);
+    reserveOne(ELF::DT_RELRENT);
   }
 
   uint64_t dt_flags = 0x0;
@@ -183,6 +170,10 @@ void ELFDynamic::reserveEntries(const ELFFileFormat& pFormat) {
     reserveOne(llvm::ELF::DT_FLAGS_1);
   }
 
+  if ((LinkerConfig::DynObj == m_Config.codeGenType()) &&
+      m_Config.options().hasPrelinkBase())
+    reserveOne(ELF::DT_GNU_PRELINKED);
+
   unsigned num_spare_dtags = m_Config.options().getNumSpareDTags();
   for (unsigned i = 0; i < num_spare_dtags; ++i) {
     reserveOne(llvm::ELF::DT_NULL);
@@ -246,15 +237,31 @@ void ELFDynamic::applyEntries(const ELFFileFormat& pFormat) {
   }
 
   if (pFormat.hasRelDyn()) {
-    applyOne(llvm::ELF::DT_REL, pFormat.getRelDyn().addr());
-    applyOne(llvm::ELF::DT_RELSZ, pFormat.getRelDyn().size());
-    applyOne(llvm::ELF::DT_RELENT, m_pEntryFactory->relSize());
+    if (ELF::SHT_ANDROID_REL == pFormat.getRelDyn().type()) {
+      applyOne(ELF::DT_ANDROID_REL, pFormat.getRelDyn().addr());
+      applyOne(ELF::DT_ANDROID_RELSZ, pFormat.getRelDyn().size());
+    } else {
+      applyOne(llvm::ELF::DT_REL, pFormat.getRelDyn().addr());
+      applyOne(llvm::ELF::DT_RELSZ, pFormat.getRelDyn().size());
+      applyOne(llvm::ELF::DT_RELENT, relSize());
+    }
   }
 
   if (pFormat.hasRelaDyn()) {
-    applyOne(llvm::ELF::DT_RELA, pFormat.getRelaDyn().addr());
-    applyOne(llvm::ELF::DT_RELASZ, pFormat.getRelaDyn().size());
-    applyOne(llvm::ELF::DT_RELAENT, m_pEntryFactory->relaSize());
+    if (ELF::SHT_ANDROID_RELA == pFormat.getRelaDyn().type()) {
+      applyOne(ELF::DT_ANDROID_RELA, pFormat.getRelaDyn().addr());
+      applyOne(ELF::DT_ANDROID_RELASZ, pFormat.getRelaDyn().size());
+    } else {
+      applyOne(llvm::ELF::DT_RELA, pFormat.getRelaDyn().addr());
+      applyOne(llvm::ELF::DT_RELASZ, pFormat.getRelaDyn().size());
+      applyOne(llvm::ELF::DT_RELAENT, relaSize());
+    }
+  }
+
+  if (pFormat.hasRelrDyn()) {
+    applyOne(ELF::DT_RELR, pFormat.getRelrDyn().addr());
+    applyOne(ELF::DT_RELRSZ, pFormat.getRelrDyn().size());
+    applyOne(ELF::DT_RELRENT, m_Config.targets().bitclass() / 8);
   }
 
   if (m_Backend.hasTextRel()) {
@@ -308,6 +315,11 @@ void ELFDynamic::applyEntries(const ELFFileFormat& pFormat) {
   if (dt_flags_1 != 0x0)
     applyOne(llvm::ELF::DT_FLAGS_1, dt_flags_1);
 
+  // the value is the base, which the loader compares with its address map
+  if ((LinkerConfig::DynObj == m_Config.codeGenType()) &&
+      m_Config.options().hasPrelinkBase())
+    applyOne(ELF::DT_GNU_PRELINKED, m_Config.options().prelinkBase());
+
   unsigned num_spare_dtags = m_Config.options().getNumSpareDTags();
   for (unsigned i = 0; i < num_spare_dtags; ++i) {
     applyOne(llvm::ELF::DT_NULL, 0x0);
@@ -316,12 +328,46 @@ void ELFDynamic::applyEntries(const ELFFileFormat& pFormat) {
 
 /// symbolSize
 size_t ELFDynamic::symbolSize() const {
-  return m_pEntryFactory->symbolSize();
+  if (m_Config.targets().is32Bits())
+    return sizeof(llvm::ELF::Elf32_Sym);
+  return sizeof(llvm::ELF::Elf64_Sym);
+}
+
+size_t ELFDynamic::relSize() const {
+  if (m_Config.targets().is32Bits())
+    return sizeof(llvm::ELF::Elf32_Rel);
+  return sizeof(llvm::ELF::Elf64_Rel);
+}
+
+size_t ELFDynamic::relaSize() const {
+  if (m_Config.targets().is32Bits())
+    return sizeof(llvm::ELF::Elf32_Rela);
+  return sizeof(llvm::ELF::Elf64_Rela);
 }
 
 /// reserveNeedEntry - reserve on DT_NEED entry.
 void ELFDynamic::reserveNeedEntry() {
-  m_NeedList.push_back(m_pEntryFactory->clone());
+  m_NeedList.push_back(Entry());
+}
+
+/// emitEntries - encode the DT_NEEDED entries and then the others
+template <typename DYN>
+void ELFDynamic::emitEntries(uint8_t* pAddress) const {
+  // FIXME: support big-endian machine.
+  std::vector<DYN> table(size());
+  size_t idx = 0;
+  EntryListType::const_iterator entry, entryEnd = m_NeedList.end();
+  for (entry = m_NeedList.begin(); entry != entryEnd; ++entry, ++idx) {
+    table[idx].d_tag = entry->tag;
+    table[idx].d_un.d_val = entry->value;
+  }
+  entryEnd = m_EntryList.end();
+  for (entry = m_EntryList.begin(); entry != entryEnd; ++entry, ++idx) {
+    table[idx].d_tag = entry->tag;
+    table[idx].d_un.d_val = entry->value;
+  }
+  if (!table.empty())
+    std::memcpy(pAddress, table.data(), table.size() * sizeof(DYN));
 }
 
 /// emit
@@ -332,13 +378,10 @@ void ELFDynamic::emit(const LDSection& pSection, MemoryRegion& pRegion) const {
   }
 
   uint8_t* address = reinterpret_cast<uint8_t*>(pRegion.begin());
-  EntryListType::const_iterator entry, entryEnd = m_NeedList.end();
-  for (entry = m_NeedList.begin(); entry != entryEnd; ++entry)
-    address += (*entry)->emit(address);
-
-  entryEnd = m_EntryList.end();
-  for (entry = m_EntryList.begin(); entry != entryEnd; ++entry)
-    address += (*entry)->emit(address);
+  if (m_Config.targets().is32Bits())
+    emitEntries<llvm::ELF::Elf32_Dyn>(address);
+  else
+    emitEntries<llvm::ELF::Elf64_Dyn>(address);
 }
 
 void ELFDynamic::applySoname(uint64_t pStrTabIdx) {
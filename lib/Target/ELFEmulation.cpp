@@ -11,17 +11,31 @@
 #include "mcld/LinkerConfig.h"
 #include "mcld/Script/InputSectDesc.h"
 
+#include <llvm/ADT/StringRef.h>
 #include <llvm/Support/Host.h>
 
 namespace mcld {
 
+/// NameMap - the names are kept in place rather than behind pointers, so the
+/// table is constant data which needs no relocation when the linker starts.
 struct NameMap {
-  const char* from;  ///< the prefix of the input string. (match FROM*)
-  const char* to;    ///< the output string.
+  char from[32];  ///< the prefix of the input string. (match FROM*)
+  char to[20];    ///< the output string.
   InputSectDesc::KeepPolicy policy;  /// mark whether the input is kept in GC
 };
 
-static const NameMap map[] = {
+static constexpr NameMap map[] = {
+    // The code which the compilers placed by its profile is grouped in runs
+    // at the start of .text, in the order of GNU ld, so that the hot code
+    // and the code run only once do not share pages with the rest.
+    {".text.unlikely", ".text", InputSectDesc::NoKeep},
+    {".text.unlikely.*", ".text", InputSectDesc::NoKeep},
+    {".text.exit", ".text", InputSectDesc::NoKeep},
+    {".text.exit.*", ".text", InputSectDesc::NoKeep},
+    {".text.startup", ".text", InputSectDesc::NoKeep},
+    {".text.startup.*", ".text", InputSectDesc::NoKeep},
+    {".text.hot", ".text", InputSectDesc::NoKeep},
+    {".text.hot.*", ".text", InputSectDesc::NoKeep},
     {".text*", ".text", InputSectDesc::NoKeep},
     {".rodata*", ".rodata", InputSectDesc::NoKeep},
     {".data.rel.ro.local*", ".data.rel.ro.local", InputSectDesc::NoKeep},
@@ -73,7 +87,22 @@ bool MCLDEmulateELF(LinkerScript& pScript, LinkerConfig& pConfig) {
   if (pConfig.options().getScriptList().empty() &&
       pConfig.codeGenType() != LinkerConfig::Object) {
     const unsigned int map_size = (sizeof(map) / sizeof(map[0]));
+    // -z hugepage-text lays the hot code out at the start of .text, so that
+    // it sits at the start of the code segment, on the first huge pages.
+    bool hot_first = pConfig.options().hasHugePageText();
+    if (hot_first) {
+      for (unsigned int i = 0; i < map_size; ++i) {
+        if (!llvm::StringRef(map[i].from).startswith(".text.hot"))
+          continue;
+        std::pair<SectionMap::mapping, bool> res =
+            pScript.sectionMap().insert(map[i].from, map[i].to, map[i].policy);
+        if (!res.second)
+          return false;
+      }
+    }
     for (unsigned int i = 0; i < map_size; ++i) {
+      if (hot_first && llvm::StringRef(map[i].from).startswith(".text.hot"))
+        continue;
       std::pair<SectionMap::mapping, bool> res =
           pScript.sectionMap().insert(map[i].from, map[i].to, map[i].policy);
       if (!res.second)
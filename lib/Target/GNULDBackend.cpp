@@ -17,6 +17,7 @@
 #include "mcld/Config/Config.h"
 #include "mcld/Fragment/FillFragment.h"
 #include "mcld/LD/BranchIslandFactory.h"
+#include "mcld/LD/BuildIDNote.h"
 #include "mcld/LD/EhFrame.h"
 #include "mcld/LD/EhFrameHdr.h"
 #include "mcld/LD/ELFDynObjFileFormat.h"
@@ -25,6 +26,7 @@
 #include "mcld/LD/ELFObjectFileFormat.h"
 #include "mcld/LD/ELFSegment.h"
 #include "mcld/LD/ELFSegmentFactory.h"
+#include "mcld/LD/GdbIndex.h"
 #include "mcld/LD/LDContext.h"
 #include "mcld/LD/LDSymbol.h"
 #include "mcld/LD/RelocData.h"
@@ -38,12 +40,20 @@
 #include "mcld/Script/RpnEvaluator.h"
 #include "mcld/Support/FileOutputBuffer.h"
 #include "mcld/Support/MsgHandling.h"
+#include "mcld/Support/Statistic.h"
+#include "mcld/Support/ThreadPool.h"
+#include "mcld/Support/TimeTrace.h"
 #include "mcld/Target/ELFAttribute.h"
 #include "mcld/Target/ELFDynamic.h"
 #include "mcld/Target/GNUInfo.h"
+#include "mcld/Target/OutputPackedRelocSection.h"
+#include "mcld/Target/OutputRelrSection.h"
 
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringMap.h>
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Support/Host.h>
+#include <llvm/Support/MathExtras.h>
 
 #include <algorithm>
 #include <cstring>
@@ -69,10 +79,195 @@ static bool isCIdentifier(const std::string& pName) {
           std::string::npos);
 }
 
+/// RelocSortKey - the keys to sort a dynamic relocation by for -z combreloc.
+/// The relative relocations, which have no symbol, go first. The others are
+/// grouped by symbol. Each group is ordered by the relocation address, the
+/// type and the addend.
+struct RelocSortKey {
+  uint64_t symbol;
+  uint64_t place;
+  uint64_t type;
+  uint64_t addend;
+  mcld::Relocation* reloc;
+};
+
+/// radixSort - sort pKeys stably by the field pField, a byte at a time. The
+/// bytes above the highest one set in any key are skipped.
+static void radixSort(std::vector<RelocSortKey>& pKeys,
+                      std::vector<RelocSortKey>& pBuffer,
+                      uint64_t RelocSortKey::*pField) {
+  uint64_t bits = 0;
+  std::vector<RelocSortKey>::const_iterator key, keyEnd = pKeys.end();
+  for (key = pKeys.begin(); key != keyEnd; ++key)
+    bits |= (*key).*pField;
+
+  for (unsigned shift = 0; (shift < 64) && ((bits >> shift) != 0);
+       shift += 8) {
+    size_t counts[256] = {0};
+    for (key = pKeys.begin(); key != keyEnd; ++key)
+      ++counts[((*key).*pField >> shift) & 0xff];
+
+    size_t offset = 0;
+    for (unsigned i = 0; i < 256; ++i) {
+      size_t count = counts[i];
+      counts[i] = offset;
+      offset += count;
+    }
+
+    pBuffer.resize(pKeys.size());
+    for (key = pKeys.begin(); key != keyEnd; ++key)
+      pBuffer[counts[((*key).*pField >> shift) & 0xff]++] = *key;
+    pKeys.swap(pBuffer);
+    keyEnd = pKeys.end();
+  }
+}
+
+/// GNUHashLayout - a number of buckets and bloom filter bits of .gnu.hash
+struct GNUHashLayout {
+  size_t nbucket;
+  unsigned maskbitslog2;
+  uint64_t size;
+  double cost;
+};
+
+static bool isSmallerGNUHash(const GNUHashLayout& pX,
+                             const GNUHashLayout& pY) {
+  if (pX.size != pY.size)
+    return pX.size < pY.size;
+  if (pX.nbucket != pY.nbucket)
+    return pX.nbucket < pY.nbucket;
+  return pX.maskbitslog2 < pY.maskbitslog2;
+}
+
+static bool isSameGNUHash(const GNUHashLayout& pX, const GNUHashLayout& pY) {
+  return (pX.nbucket == pY.nbucket) && (pX.maskbitslog2 == pY.maskbitslog2);
+}
+
+/// nextPrime - the smallest prime which is not less than pValue
+static size_t nextPrime(size_t pValue) {
+  if (pValue <= 2)
+    return 2;
+  for (size_t value = pValue | 1;; value += 2) {
+    bool is_prime = true;
+    for (size_t div = 3; div * div <= value; div += 2) {
+      if ((value % div) == 0) {
+        is_prime = false;
+        break;
+      }
+    }
+    if (is_prime)
+      return value;
+  }
+}
+
+/// evaluateGNUHash - the expected number of hash compares of a lookup in a
+/// .gnu.hash with pNumOfBuckets buckets and 2^pMaskbitslog2 bloom filter bits.
+/// A defined symbol walks half of its chain on average. A missing symbol
+/// passes the bloom filter if both of its bits are set, and then walks a chain
+/// of the average length. Both kinds of lookup are weighted the same.
+static double evaluateGNUHash(const std::vector<uint32_t>& pHashes,
+                              size_t pNumOfBuckets,
+                              unsigned pMaskbitslog2,
+                              unsigned pWordBits) {
+  unsigned shift1 = (pWordBits == 32) ? 5 : 6;
+  uint32_t mask = pWordBits - 1;
+  size_t maskwords = size_t(1) << (pMaskbitslog2 - shift1);
+  std::vector<uint64_t> bloom(maskwords, 0);
+  std::vector<uint32_t> lengths(pNumOfBuckets, 0);
+  std::vector<uint32_t>::const_iterator hash, hashEnd = pHashes.end();
+  for (hash = pHashes.begin(); hash != hashEnd; ++hash) {
+    ++lengths[*hash % pNumOfBuckets];
+    uint64_t& word = bloom[(*hash >> shift1) & (maskwords - 1)];
+    word |= UINT64_C(1) << (*hash & mask);
+    word |= UINT64_C(1) << ((*hash >> pMaskbitslog2) & mask);
+  }
+
+  double hit = 0.0;
+  for (size_t i = 0; i < pNumOfBuckets; ++i)
+    hit += lengths[i] * (lengths[i] + 1.0) / 2.0;
+  hit /= pHashes.size();
+
+  double false_positive = 0.0;
+  for (size_t i = 0; i < maskwords; ++i) {
+    double ratio = llvm::countPopulation(bloom[i]) / double(pWordBits);
+    false_positive += ratio * ratio;
+  }
+  false_positive /= maskwords;
+  double miss = false_positive * pHashes.size() / pNumOfBuckets;
+  return hit + miss;
+}
+
+/// PackedRelocKey - the keys to order a relocation by for
+/// --pack-dyn-relocs=android
+struct PackedRelocKey {
+  size_t info;
+  size_t section;
+  uint64_t offset;
+  mcld::Relocation* reloc;
+};
+
+static bool isPackedRelocBefore(const PackedRelocKey& pX,
+                                const PackedRelocKey& pY) {
+  if (pX.info != pY.info)
+    return pX.info < pY.info;
+  if (pX.section != pY.section)
+    return pX.section < pY.section;
+  return pX.offset < pY.offset;
+}
+
+/// isMoreAligned - the order of --sort-common=descending. The value of a
+/// common symbol is its alignment.
+static bool isMoreAligned(const mcld::LDSymbol* pX, const mcld::LDSymbol* pY) {
+  return pX->value() > pY->value();
+}
+
+static bool isLessAligned(const mcld::LDSymbol* pX, const mcld::LDSymbol* pY) {
+  return pX->value() < pY->value();
+}
+
+/// appendCommons - place pCommons one after another, each at its alignment,
+/// in one fill fragment at the end of pSection. Return the size pSection
+/// grows by.
+static uint64_t appendCommons(const std::vector<mcld::LDSymbol*>& pCommons,
+                              mcld::LDSection& pSection) {
+  if (pCommons.empty())
+    return 0;
+
+  uint64_t size = 0, max_align = 1;
+  std::vector<mcld::LDSymbol*>::const_iterator sym, symEnd = pCommons.end();
+  for (sym = pCommons.begin(); sym != symEnd; ++sym) {
+    mcld::alignAddress(size, (*sym)->value());
+    size += (*sym)->size();
+    max_align = std::max<uint64_t>(max_align, (*sym)->value());
+  }
+
+  mcld::Fragment* frag = new mcld::FillFragment(0x0, 1, size);
+  uint64_t grown = mcld::ObjectBuilder::AppendFragment(
+      *frag, *pSection.getSectionData(), max_align);
+  mcld::ObjectBuilder::UpdateSectionAlign(pSection, max_align);
+
+  uint64_t offset = 0;
+  for (sym = pCommons.begin(); sym != symEnd; ++sym) {
+    mcld::alignAddress(offset, (*sym)->value());
+    (*sym)->setFragmentRef(mcld::FragmentRef::Create(*frag, offset));
+    offset += (*sym)->size();
+  }
+  return grown;
+}
+
 }  // anonymous namespace
 
 namespace mcld {
 
+static Statistic NumCopyRelocs("backend.copy-reloc",
+                               "The # of copy relocations");
+static Statistic NumCopyBytes("backend.copy-reloc-bytes",
+                              "The # of bytes copied by the copy relocations");
+static Statistic NumCanonicalPLTs("backend.canonical-plt",
+                                  "The # of PLT entries taken as addresses");
+static Statistic NumRelaxPasses("backend.relax-pass",
+                                "The # of relaxation passes");
+
 //===----------------------------------------------------------------------===//
 // GNULDBackend
 //===----------------------------------------------------------------------===//
@@ -87,9 +282,16 @@ GNULDBackend::GNULDBackend(const LinkerConfig& pConfig, GNUInfo* pInfo)
       m_pBRIslandFactory(NULL),
       m_pStubFactory(NULL),
       m_pEhFrameHdr(NULL),
+      m_pRelrDyn(NULL),
+      m_pPackedRelDyn(NULL),
+      m_pBuildID(NULL),
+      m_pGdbIndex(NULL),
       m_pAttribute(NULL),
       m_bHasTextRel(false),
       m_bHasStaticTLS(false),
+      m_NumOfGNUHashedSyms(0),
+      m_GNUHashBucketCount(0),
+      m_GNUHashMaskbitslog2(0),
       f_pPreInitArrayStart(NULL),
       f_pPreInitArrayEnd(NULL),
       f_pInitArrayStart(NULL),
@@ -110,7 +312,6 @@ GNULDBackend::GNULDBackend(const LinkerConfig& pConfig, GNUInfo* pInfo)
       f_pEnd(NULL),
       f_p_End(NULL) {
   m_pELFSegmentTable = new ELFSegmentFactory();
-  m_pSymIndexMap = new HashTableType(1024);
   m_pAttribute = new ELFAttribute(*this, pConfig);
 }
 
@@ -120,8 +321,11 @@ GNULDBackend::~GNULDBackend() {
   delete m_pDynObjFileFormat;
   delete m_pExecFileFormat;
   delete m_pObjectFileFormat;
-  delete m_pSymIndexMap;
   delete m_pEhFrameHdr;
+  delete m_pRelrDyn;
+  delete m_pPackedRelDyn;
+  delete m_pBuildID;
+  delete m_pGdbIndex;
   delete m_pAttribute;
   delete m_pBRIslandFactory;
   delete m_pStubFactory;
@@ -150,6 +354,9 @@ uint64_t GNULDBackend::getSegmentStartAddr(const LinkerScript& pScript) const {
       pScript.addressMap().find(".text");
   if (pScript.addressMap().end() != mapping)
     return mapping.getEntry()->value();
+  else if ((LinkerConfig::DynObj == config().codeGenType()) &&
+           config().options().hasPrelinkBase())
+    return config().options().prelinkBase();
   else if (config().isCodeIndep())
     return 0x0;
   else
@@ -783,13 +990,20 @@ void GNULDBackend::sizeNamePools(Module& pModule) {
             if (DynsymCompare().needGNUHash(**symbol))
               ++hashed_sym_cnt;
           }
+          m_NumOfGNUHashedSyms = hashed_sym_cnt;
           // Special case for empty .dynsym
           if (hashed_sym_cnt == 0)
             gnuhash = 5 * 4 + config().targets().bitclass() / 8;
           else {
             size_t nbucket = getHashBucketCount(hashed_sym_cnt, true);
+            unsigned maskbitslog2 = getGNUHashMaskbitslog2(hashed_sym_cnt);
+            if (GeneralOptions::HashOptimize::Lookup ==
+                config().options().getHashOptimize())
+              tuneGNUHash(symbols, nbucket, maskbitslog2);
+            m_GNUHashBucketCount = nbucket;
+            m_GNUHashMaskbitslog2 = maskbitslog2;
             gnuhash = (4 + nbucket + hashed_sym_cnt) * 4;
-            gnuhash += (1U << getGNUHashMaskbitslog2(hashed_sym_cnt)) / 8;
+            gnuhash += (1U << maskbitslog2) / 8;
           }
         }
 
@@ -865,46 +1079,102 @@ void GNULDBackend::sizeNamePools(Module& pModule) {
   }  // end of switch
 }
 
-/// emitSymbol32 - emit an ELF32 symbol
-void GNULDBackend::emitSymbol32(llvm::ELF::Elf32_Sym& pSym,
-                                LDSymbol& pSymbol,
-                                char* pStrtab,
-                                size_t pStrtabsize,
-                                size_t pSymtabIdx) {
-  // FIXME: check the endian between host and target
-  // write out symbol
-  if (hasEntryInStrTab(pSymbol)) {
-    pSym.st_name = pStrtabsize;
-    ::memcpy((pStrtab + pStrtabsize), pSymbol.name(), pSymbol.nameSize());
-  } else {
-    pSym.st_name = 0;
-  }
-  pSym.st_value = pSymbol.value();
-  pSym.st_size = getSymbolSize(pSymbol);
-  pSym.st_info = getSymbolInfo(pSymbol);
-  pSym.st_other = pSymbol.visibility();
-  pSym.st_shndx = getSymbolShndx(pSymbol);
-}
-
-/// emitSymbol64 - emit an ELF64 symbol
-void GNULDBackend::emitSymbol64(llvm::ELF::Elf64_Sym& pSym,
-                                LDSymbol& pSymbol,
-                                char* pStrtab,
-                                size_t pStrtabsize,
-                                size_t pSymtabIdx) {
-  // FIXME: check the endian between host and target
-  // write out symbol
-  if (hasEntryInStrTab(pSymbol)) {
-    pSym.st_name = pStrtabsize;
-    ::memcpy((pStrtab + pStrtabsize), pSymbol.name(), pSymbol.nameSize());
+/// emitSymbols - emit the symbols in [pBegin, pEnd) as the entries of
+/// pSymtab from pSymIdx, and their names into pStrtab from pStrtabSize, in the
+/// target byte order. The string table offsets of the chunks of symbols are
+/// summed up first, and then the chunks are written in parallel.
+template <size_t BITCLASS, bool ISLITTLE>
+void GNULDBackend::emitSymbols(Module::const_sym_iterator pBegin,
+                               Module::const_sym_iterator pEnd,
+                               uint8_t* pSymtab,
+                               size_t pSymIdx,
+                               char* pStrtab,
+                               size_t& pStrtabSize,
+                               bool pSetSymIdx) const {
+  typedef typename ELFSizeTraits<BITCLASS>::Sym Sym;
+  const bool swap = (llvm::sys::IsLittleEndianHost != ISLITTLE);
+  const size_t chunk_size = 4096;
+  size_t num = pEnd - pBegin;
+  size_t num_chunks = (num + chunk_size - 1) / chunk_size;
+  ThreadPool pool(config().options().numThreads());
+
+  // offsets[i] is the offset of the names of the i-th chunk in pStrtab
+  std::vector<size_t> offsets(num_chunks + 1, 0);
+  parallelFor(pool, 0, num_chunks, [&](size_t pChunk) {
+    size_t end = std::min(num, (pChunk + 1) * chunk_size);
+    for (size_t i = pChunk * chunk_size; i < end; ++i) {
+      if (hasEntryInStrTab(*pBegin[i]))
+        offsets[pChunk + 1] += pBegin[i]->nameSize() + 1;
+    }
+  });
+  offsets[0] = pStrtabSize;
+  for (size_t i = 0; i < num_chunks; ++i)
+    offsets[i + 1] += offsets[i];
+
+  Sym* symtab = reinterpret_cast<Sym*>(pSymtab) + pSymIdx;
+  parallelFor(pool, 0, num_chunks, [&](size_t pChunk) {
+    size_t strtab_size = offsets[pChunk];
+    size_t end = std::min(num, (pChunk + 1) * chunk_size);
+    for (size_t i = pChunk * chunk_size; i < end; ++i) {
+      LDSymbol& symbol = *pBegin[i];
+      uint32_t name = 0x0;
+      if (hasEntryInStrTab(symbol)) {
+        name = strtab_size;
+        ::memcpy(pStrtab + strtab_size, symbol.name(), symbol.nameSize());
+        strtab_size += symbol.nameSize() + 1;
+      }
+      typename ELFSizeTraits<BITCLASS>::Addr value = symbol.value();
+      typename SizeTraits<BITCLASS>::Word size = getSymbolSize(symbol);
+      uint16_t shndx = getSymbolShndx(symbol);
+      if (swap) {
+        name = bswap32(name);
+        value = bswap<BITCLASS>(value);
+        size = bswap<BITCLASS>(size);
+        shndx = bswap16(shndx);
+      }
+
+      Sym& sym = symtab[i];
+      sym.st_name = name;
+      sym.st_value = value;
+      sym.st_size = size;
+      sym.st_info = getSymbolInfo(symbol);
+      sym.st_other = symbol.visibility();
+      sym.st_shndx = shndx;
+      if (pSetSymIdx)
+        symbol.setSymIdx(pSymIdx + i);
+    }
+  });
+  pStrtabSize = offsets[num_chunks];
+}
+
+/// emitSymbolTable - emit the null symbol and the symbols in [pBegin, pEnd)
+void GNULDBackend::emitSymbolTable(Module::const_sym_iterator pBegin,
+                                   Module::const_sym_iterator pEnd,
+                                   MemoryRegion& pSymtab,
+                                   char* pStrtab,
+                                   size_t& pStrtabSize,
+                                   bool pSetSymIdx) const {
+  bool little = config().targets().isLittleEndian();
+  if (config().targets().is32Bits()) {
+    ::memset(pSymtab.begin(), 0x0, sizeof(llvm::ELF::Elf32_Sym));
+    if (little)
+      emitSymbols<32, true>(
+          pBegin, pEnd, pSymtab.begin(), 1, pStrtab, pStrtabSize, pSetSymIdx);
+    else
+      emitSymbols<32, false>(
+          pBegin, pEnd, pSymtab.begin(), 1, pStrtab, pStrtabSize, pSetSymIdx);
+  } else if (config().targets().is64Bits()) {
+    ::memset(pSymtab.begin(), 0x0, sizeof(llvm::ELF::Elf64_Sym));
+    if (little)
+      emitSymbols<64, true>(
+          pBegin, pEnd, pSymtab.begin(), 1, pStrtab, pStrtabSize, pSetSymIdx);
+    else
+      emitSymbols<64, false>(
+          pBegin, pEnd, pSymtab.begin(), 1, pStrtab, pStrtabSize, pSetSymIdx);
   } else {
-    pSym.st_name = 0;
+    fatal(diag::unsupported_bitclass) << config().targets().triple().str()
+                                      << config().targets().bitclass();
   }
-  pSym.st_value = pSymbol.value();
-  pSym.st_size = getSymbolSize(pSymbol);
-  pSym.st_info = getSymbolInfo(pSymbol);
-  pSym.st_other = pSymbol.visibility();
-  pSym.st_shndx = getSymbolShndx(pSymbol);
 }
 
 /// emitRegNamePools - emit regular name pools - .symtab, .strtab
@@ -924,55 +1194,17 @@ void GNULDBackend::emitRegNamePools(const Module& pModule,
       pOutput.request(symtab_sect.offset(), symtab_sect.size());
   MemoryRegion strtab_region =
       pOutput.request(strtab_sect.offset(), strtab_sect.size());
-
-  // set up symtab_region
-  llvm::ELF::Elf32_Sym* symtab32 = NULL;
-  llvm::ELF::Elf64_Sym* symtab64 = NULL;
-  if (config().targets().is32Bits())
-    symtab32 = (llvm::ELF::Elf32_Sym*)symtab_region.begin();
-  else if (config().targets().is64Bits())
-    symtab64 = (llvm::ELF::Elf64_Sym*)symtab_region.begin();
-  else {
-    fatal(diag::unsupported_bitclass) << config().targets().triple().str()
-                                      << config().targets().bitclass();
-  }
-
-  // set up strtab_region
   char* strtab = reinterpret_cast<char*>(strtab_region.begin());
 
-  // emit the first ELF symbol
-  if (config().targets().is32Bits())
-    emitSymbol32(symtab32[0], *LDSymbol::Null(), strtab, 0, 0);
-  else
-    emitSymbol64(symtab64[0], *LDSymbol::Null(), strtab, 0, 0);
-
-  bool sym_exist = false;
-  HashTableType::entry_type* entry = NULL;
-  if (LinkerConfig::Object == config().codeGenType()) {
-    entry = m_pSymIndexMap->insert(LDSymbol::Null(), sym_exist);
-    entry->setValue(0);
-  }
+  // the relocations of a relocatable output refer to the .symtab indices
+  bool set_sym_idx = (LinkerConfig::Object == config().codeGenType());
+  if (set_sym_idx)
+    LDSymbol::Null()->setSymIdx(0);
 
-  size_t symIdx = 1;
   size_t strtabsize = 1;
-
   const Module::SymbolTable& symbols = pModule.getSymbolTable();
-  Module::const_sym_iterator symbol, symEnd;
-
-  symEnd = symbols.end();
-  for (symbol = symbols.begin(); symbol != symEnd; ++symbol) {
-    if (LinkerConfig::Object == config().codeGenType()) {
-      entry = m_pSymIndexMap->insert(*symbol, sym_exist);
-      entry->setValue(symIdx);
-    }
-    if (config().targets().is32Bits())
-      emitSymbol32(symtab32[symIdx], **symbol, strtab, strtabsize, symIdx);
-    else
-      emitSymbol64(symtab64[symIdx], **symbol, strtab, strtabsize, symIdx);
-    ++symIdx;
-    if (hasEntryInStrTab(**symbol))
-      strtabsize += (*symbol)->nameSize() + 1;
-  }
+  emitSymbolTable(symbols.begin(), symbols.end(), symtab_region, strtab,
+                  strtabsize, set_sym_idx);
 }
 
 /// emitDynNamePools - emit dynamic name pools - .dyntab, .dynstr, .hash
@@ -986,9 +1218,6 @@ void GNULDBackend::emitDynNamePools(Module& pModule,
       !file_format->hasDynamic())
     return;
 
-  bool sym_exist = false;
-  HashTableType::entry_type* entry = 0;
-
   LDSection& symtab_sect = file_format->getDynSymTab();
   LDSection& strtab_sect = file_format->getDynStrTab();
   LDSection& dyn_sect = file_format->getDynamic();
@@ -998,31 +1227,13 @@ void GNULDBackend::emitDynNamePools(Module& pModule,
   MemoryRegion strtab_region =
       pOutput.request(strtab_sect.offset(), strtab_sect.size());
   MemoryRegion dyn_region = pOutput.request(dyn_sect.offset(), dyn_sect.size());
-  // set up symtab_region
-  llvm::ELF::Elf32_Sym* symtab32 = NULL;
-  llvm::ELF::Elf64_Sym* symtab64 = NULL;
-  if (config().targets().is32Bits())
-    symtab32 = (llvm::ELF::Elf32_Sym*)symtab_region.begin();
-  else if (config().targets().is64Bits())
-    symtab64 = (llvm::ELF::Elf64_Sym*)symtab_region.begin();
-  else {
-    fatal(diag::unsupported_bitclass) << config().targets().triple().str()
-                                      << config().targets().bitclass();
-  }
-
-  // set up strtab_region
   char* strtab = reinterpret_cast<char*>(strtab_region.begin());
 
-  // emit the first ELF symbol
-  if (config().targets().is32Bits())
-    emitSymbol32(symtab32[0], *LDSymbol::Null(), strtab, 0, 0);
-  else
-    emitSymbol64(symtab64[0], *LDSymbol::Null(), strtab, 0, 0);
-
-  size_t symIdx = 1;
   size_t strtabsize = 1;
 
   Module::SymbolTable& symbols = pModule.getSymbolTable();
+  hashDynsymNames(symbols);
+
   // emit .gnu.hash
   if (config().options().hasGNUHash())
     emitGNUHashTab(symbols, pOutput);
@@ -1031,21 +1242,10 @@ void GNULDBackend::emitDynNamePools(Module& pModule,
   if (config().options().hasSysVHash())
     emitELFHashTab(symbols, pOutput);
 
-  // emit .dynsym, and .dynstr (emit LocalDyn and Dynamic category)
-  Module::const_sym_iterator symbol, symEnd = symbols.dynamicEnd();
-  for (symbol = symbols.localDynBegin(); symbol != symEnd; ++symbol) {
-    if (config().targets().is32Bits())
-      emitSymbol32(symtab32[symIdx], **symbol, strtab, strtabsize, symIdx);
-    else
-      emitSymbol64(symtab64[symIdx], **symbol, strtab, strtabsize, symIdx);
-    // maintain output's symbol and index map
-    entry = m_pSymIndexMap->insert(*symbol, sym_exist);
-    entry->setValue(symIdx);
-    // sum up counters
-    ++symIdx;
-    if (hasEntryInStrTab(**symbol))
-      strtabsize += (*symbol)->nameSize() + 1;
-  }
+  // emit .dynsym, and .dynstr (emit LocalDyn and Dynamic category), and keep
+  // the .dynsym indices for the dynamic relocations
+  emitSymbolTable(symbols.localDynBegin(), symbols.dynamicEnd(),
+                  symtab_region, strtab, strtabsize, true);
 
   // emit DT_NEED
   // add DT_NEED strings into .dynstr
@@ -1056,7 +1256,7 @@ void GNULDBackend::emitDynNamePools(Module& pModule,
       ::memcpy((strtab + strtabsize),
                (*lib)->name().c_str(),
                (*lib)->name().size());
-      (*dt_need)->setValue(llvm::ELF::DT_NEEDED, strtabsize);
+      dt_need->setValue(llvm::ELF::DT_NEEDED, strtabsize);
       strtabsize += (*lib)->name().size() + 1;
       ++dt_need;
     }
@@ -1064,9 +1264,9 @@ void GNULDBackend::emitDynNamePools(Module& pModule,
 
   if (!config().options().getRpathList().empty()) {
     if (!config().options().hasNewDTags())
-      (*dt_need)->setValue(llvm::ELF::DT_RPATH, strtabsize);
+      dt_need->setValue(llvm::ELF::DT_RPATH, strtabsize);
     else
-      (*dt_need)->setValue(llvm::ELF::DT_RUNPATH, strtabsize);
+      dt_need->setValue(llvm::ELF::DT_RUNPATH, strtabsize);
     ++dt_need;
 
     GeneralOptions::const_rpath_iterator rpath,
@@ -1118,21 +1318,39 @@ void GNULDBackend::emitELFHashTab(const Module::SymbolTable& pSymtab,
   uint32_t* chain = (bucket + nbucket);
 
   // initialize bucket
-  memset(reinterpret_cast<void*>(bucket), 0, nbucket);
+  memset(reinterpret_cast<void*>(bucket), 0, nbucket * sizeof(uint32_t));
+  chain[0] = 0;
 
-  hash::StringHash<hash::ELF> hash_func;
-
-  size_t idx = 1;
-  Module::const_sym_iterator symbol, symEnd = pSymtab.dynamicEnd();
-  for (symbol = pSymtab.localDynBegin(); symbol != symEnd; ++symbol) {
-    llvm::StringRef name((*symbol)->name());
-    size_t bucket_pos = hash_func(name) % nbucket;
+  assert(m_SysVHashes.size() + 1 == dynsymSize);
+  for (size_t idx = 1; idx < dynsymSize; ++idx) {
+    size_t bucket_pos = m_SysVHashes[idx - 1] % nbucket;
     chain[idx] = bucket[bucket_pos];
     bucket[bucket_pos] = idx;
-    ++idx;
   }
 }
 
+/// hashDynsymNames - the hashes of .dynsym are computed in parallel. They
+/// follow the symbols when emitGNUHashTab() orders the symbols by bucket.
+void GNULDBackend::hashDynsymNames(const Module::SymbolTable& pSymtab) {
+  size_t num = pSymtab.numOfLocalDyns() + pSymtab.numOfDynamics();
+  bool gnu_hash = config().options().hasGNUHash();
+  bool sysv_hash = config().options().hasSysVHash();
+  m_GNUHashes.assign(gnu_hash ? num : 0, 0);
+  m_SysVHashes.assign(sysv_hash ? num : 0, 0);
+  if (!gnu_hash && !sysv_hash)
+    return;
+
+  Module::const_sym_iterator symbols = pSymtab.localDynBegin();
+  ThreadPool pool(config().options().numThreads());
+  parallelFor(pool, 0, num, [&](size_t pIndex) {
+    llvm::StringRef name(symbols[pIndex]->name());
+    if (gnu_hash)
+      m_GNUHashes[pIndex] = hash::StringHash<hash::DJB>()(name);
+    if (sysv_hash)
+      m_SysVHashes[pIndex] = hash::StringHash<hash::ELF>()(name);
+  });
+}
+
 /// emitGNUHashTab - emit .gnu.hash
 void GNULDBackend::emitGNUHashTab(Module::SymbolTable& pSymtab,
                                   FileOutputBuffer& pOutput) {
@@ -1155,16 +1373,14 @@ void GNULDBackend::emitGNUHashTab(Module::SymbolTable& pSymtab,
   uint32_t* bucket = NULL;
   uint32_t* chain = NULL;
 
-  // count the number of dynsym to hash
-  size_t unhashed_sym_cnt = pSymtab.numOfLocalDyns();
-  size_t hashed_sym_cnt = pSymtab.numOfDynamics();
-  Module::const_sym_iterator symbol, symEnd = pSymtab.dynamicEnd();
-  for (symbol = pSymtab.dynamicBegin(); symbol != symEnd; ++symbol) {
-    if (DynsymCompare().needGNUHash(**symbol))
-      break;
-    ++unhashed_sym_cnt;
-    --hashed_sym_cnt;
-  }
+  // the hashed symbols are counted by sizeNamePools(), and orderSymbolTable()
+  // moves them to the end of .dynsym
+  size_t hashed_sym_cnt = m_NumOfGNUHashedSyms;
+  size_t unhashed_sym_cnt =
+      pSymtab.numOfLocalDyns() + pSymtab.numOfDynamics() - hashed_sym_cnt;
+  assert((hashed_sym_cnt == 0) ||
+         DynsymCompare().needGNUHash(
+             **(pSymtab.localDynBegin() + unhashed_sym_cnt)));
 
   // special case for the empty hash table
   if (hashed_sym_cnt == 0) {
@@ -1187,12 +1403,12 @@ void GNULDBackend::emitGNUHashTab(Module::SymbolTable& pSymtab,
     return;
   }
 
-  uint32_t maskbitslog2 = getGNUHashMaskbitslog2(hashed_sym_cnt);
+  uint32_t maskbitslog2 = m_GNUHashMaskbitslog2;
   uint32_t maskbits = 1u << maskbitslog2;
   uint32_t shift1 = config().targets().is32Bits() ? 5 : 6;
   uint32_t mask = (1u << shift1) - 1;
 
-  nbucket = getHashBucketCount(hashed_sym_cnt, true);
+  nbucket = m_GNUHashBucketCount;
   symidx = 1 + unhashed_sym_cnt;
   maskwords = 1 << (maskbitslog2 - shift1);
   shift2 = maskbitslog2;
@@ -1201,48 +1417,45 @@ void GNULDBackend::emitGNUHashTab(Module::SymbolTable& pSymtab,
   bucket = reinterpret_cast<uint32_t*>(bitmask + maskbits / 8);
   chain = (bucket + nbucket);
 
-  // build the gnu style hash table
-  typedef std::multimap<uint32_t, std::pair<LDSymbol*, uint32_t> > SymMapType;
-  SymMapType symmap;
-  symEnd = pSymtab.dynamicEnd();
-  for (symbol = pSymtab.localDynBegin() + symidx - 1; symbol != symEnd;
-       ++symbol) {
-    hash::StringHash<hash::DJB> hasher;
-    uint32_t djbhash = hasher((*symbol)->name());
-    uint32_t hash = djbhash % nbucket;
-    symmap.insert(std::make_pair(hash, std::make_pair(*symbol, djbhash)));
-  }
+  // order the hashed symbols by bucket, keeping their order in each bucket
+  std::vector<size_t> bucket_begins(nbucket + 1, 0);
+  for (size_t idx = unhashed_sym_cnt; idx < m_GNUHashes.size(); ++idx)
+    ++bucket_begins[m_GNUHashes[idx] % nbucket + 1];
+  for (size_t idx = 0; idx < nbucket; ++idx)
+    bucket_begins[idx + 1] += bucket_begins[idx];
+
+  Module::sym_iterator hashed = pSymtab.localDynBegin() + unhashed_sym_cnt;
+  std::vector<LDSymbol*> symbols(hashed_sym_cnt);
+  std::vector<uint32_t> hashes(hashed_sym_cnt);
+  std::vector<uint32_t> sysv_hashes(m_SysVHashes.empty() ? 0 : hashed_sym_cnt);
+  std::vector<size_t> positions(bucket_begins.begin(), bucket_begins.end() - 1);
+  for (size_t idx = 0; idx < hashed_sym_cnt; ++idx) {
+    uint32_t djbhash = m_GNUHashes[unhashed_sym_cnt + idx];
+    size_t pos = positions[djbhash % nbucket]++;
+    symbols[pos] = hashed[idx];
+    hashes[pos] = djbhash;
+    if (!sysv_hashes.empty())
+      sysv_hashes[pos] = m_SysVHashes[unhashed_sym_cnt + idx];
+  }
+  std::copy(symbols.begin(), symbols.end(), hashed);
+  std::copy(hashes.begin(), hashes.end(),
+            m_GNUHashes.begin() + unhashed_sym_cnt);
+  std::copy(sysv_hashes.begin(), sysv_hashes.end(),
+            m_SysVHashes.begin() + unhashed_sym_cnt);
 
   // compute bucket, chain, and bitmask
   std::vector<uint64_t> bitmasks(maskwords);
-  size_t hashedidx = symidx;
   for (size_t idx = 0; idx < nbucket; ++idx) {
-    size_t count = 0;
-    std::pair<SymMapType::iterator, SymMapType::iterator> ret;
-    ret = symmap.equal_range(idx);
-    for (SymMapType::iterator it = ret.first; it != ret.second;) {
-      // rearrange the hashed symbol ordering
-      *(pSymtab.localDynBegin() + hashedidx - 1) = it->second.first;
-      uint32_t djbhash = it->second.second;
+    size_t begin = bucket_begins[idx], end = bucket_begins[idx + 1];
+    bucket[idx] = (begin == end) ? 0 : symidx + begin;
+    for (size_t pos = begin; pos != end; ++pos) {
+      uint32_t djbhash = hashes[pos];
       uint32_t val = ((djbhash >> shift1) & ((maskbits >> shift1) - 1));
-      bitmasks[val] |= 1u << (djbhash & mask);
-      bitmasks[val] |= 1u << ((djbhash >> shift2) & mask);
-      val = djbhash & ~1u;
-      // advance the iterator and check if we're dealing w/ the last elment
-      if (++it == ret.second) {
-        // last element terminates the chain
-        val |= 1;
-      }
-      chain[hashedidx - symidx] = val;
-
-      ++hashedidx;
-      ++count;
+      bitmasks[val] |= UINT64_C(1) << (djbhash & mask);
+      bitmasks[val] |= UINT64_C(1) << ((djbhash >> shift2) & mask);
+      // the last element terminates the chain
+      chain[pos] = (djbhash & ~1u) | ((pos + 1 == end) ? 1 : 0);
     }
-
-    if (count == 0)
-      bucket[idx] = 0;
-    else
-      bucket[idx] = hashedidx - count;
   }
 
   // write the bitmasks
@@ -1464,11 +1677,8 @@ uint64_t GNULDBackend::getSymbolShndx(const LDSymbol& pSymbol) const {
 
 /// getSymbolIdx - called by emitRelocation to get the ouput symbol table index
 size_t GNULDBackend::getSymbolIdx(const LDSymbol* pSymbol) const {
-  HashTableType::iterator entry =
-      m_pSymIndexMap->find(const_cast<LDSymbol*>(pSymbol));
-  assert(entry != m_pSymIndexMap->end() &&
-         "symbol not found in the symbol table");
-  return entry.getEntry()->value();
+  assert(pSymbol->hasSymIdx() && "symbol not found in the symbol table");
+  return pSymbol->symIdx();
 }
 
 /// isTemporary - Whether pSymbol is a local label.
@@ -1507,88 +1717,67 @@ bool GNULDBackend::allocateCommonSymbols(Module& pModule) {
       symbol_list.emptyLocals() && symbol_list.emptyLocalDyns())
     return true;
 
-  SymbolCategory::iterator com_sym, com_end;
-
-  // FIXME: If the order of common symbols is defined, then sort common symbols
-  // std::sort(com_sym, com_end, some kind of order);
-
   // get corresponding BSS LDSection
   ELFFileFormat* file_format = getOutputFormat();
   LDSection& bss_sect = file_format->getBSS();
   LDSection& tbss_sect = file_format->getTBSS();
 
   // get or create corresponding BSS SectionData
-  SectionData* bss_sect_data = NULL;
-  if (bss_sect.hasSectionData())
-    bss_sect_data = bss_sect.getSectionData();
-  else
-    bss_sect_data = IRBuilder::CreateSectionData(bss_sect);
-
-  SectionData* tbss_sect_data = NULL;
-  if (tbss_sect.hasSectionData())
-    tbss_sect_data = tbss_sect.getSectionData();
-  else
-    tbss_sect_data = IRBuilder::CreateSectionData(tbss_sect);
-
-  // remember original BSS size
-  uint64_t bss_offset = bss_sect.size();
-  uint64_t tbss_offset = tbss_sect.size();
-
-  // allocate all local common symbols
-  com_end = symbol_list.localEnd();
-
+  if (!bss_sect.hasSectionData())
+    IRBuilder::CreateSectionData(bss_sect);
+  if (!tbss_sect.hasSectionData())
+    IRBuilder::CreateSectionData(tbss_sect);
+
+  // collect the local common symbols and then the global ones
+  std::vector<LDSymbol*> bss_commons, tbss_commons;
+  SymbolCategory::iterator com_sym, com_end = symbol_list.localEnd();
   for (com_sym = symbol_list.localBegin(); com_sym != com_end; ++com_sym) {
-    if (ResolveInfo::Common == (*com_sym)->desc()) {
-      // We have to reset the description of the symbol here. When doing
-      // incremental linking, the output relocatable object may have common
-      // symbols. Therefore, we can not treat common symbols as normal symbols
-      // when emitting the regular name pools. We must change the symbols'
-      // description here.
-      (*com_sym)->resolveInfo()->setDesc(ResolveInfo::Define);
-      Fragment* frag = new FillFragment(0x0, 1, (*com_sym)->size());
-
-      if (ResolveInfo::ThreadLocal == (*com_sym)->type()) {
-        // allocate TLS common symbol in tbss section
-        tbss_offset += ObjectBuilder::AppendFragment(
-            *frag, *tbss_sect_data, (*com_sym)->value());
-        ObjectBuilder::UpdateSectionAlign(tbss_sect, (*com_sym)->value());
-        (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-      } else {
-        bss_offset += ObjectBuilder::AppendFragment(
-            *frag, *bss_sect_data, (*com_sym)->value());
-        ObjectBuilder::UpdateSectionAlign(bss_sect, (*com_sym)->value());
-        (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-      }
-    }
+    if (ResolveInfo::Common != (*com_sym)->desc())
+      continue;
+    if (ResolveInfo::ThreadLocal == (*com_sym)->type())
+      tbss_commons.push_back(*com_sym);
+    else
+      bss_commons.push_back(*com_sym);
   }
-
-  // allocate all global common symbols
   com_end = symbol_list.commonEnd();
   for (com_sym = symbol_list.commonBegin(); com_sym != com_end; ++com_sym) {
-    // We have to reset the description of the symbol here. When doing
-    // incremental linking, the output relocatable object may have common
-    // symbols. Therefore, we can not treat common symbols as normal symbols
-    // when emitting the regular name pools. We must change the symbols'
-    // description here.
-    (*com_sym)->resolveInfo()->setDesc(ResolveInfo::Define);
-    Fragment* frag = new FillFragment(0x0, 1, (*com_sym)->size());
-
-    if (ResolveInfo::ThreadLocal == (*com_sym)->type()) {
-      // allocate TLS common symbol in tbss section
-      tbss_offset += ObjectBuilder::AppendFragment(
-          *frag, *tbss_sect_data, (*com_sym)->value());
-      ObjectBuilder::UpdateSectionAlign(tbss_sect, (*com_sym)->value());
-      (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-    } else {
-      bss_offset += ObjectBuilder::AppendFragment(
-          *frag, *bss_sect_data, (*com_sym)->value());
-      ObjectBuilder::UpdateSectionAlign(bss_sect, (*com_sym)->value());
-      (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-    }
+    if (ResolveInfo::ThreadLocal == (*com_sym)->type())
+      tbss_commons.push_back(*com_sym);
+    else
+      bss_commons.push_back(*com_sym);
+  }
+
+  // We have to reset the description of the symbols here. When doing
+  // incremental linking, the output relocatable object may have common
+  // symbols. Therefore, we can not treat common symbols as normal symbols
+  // when emitting the regular name pools. We must change the symbols'
+  // description here.
+  std::vector<LDSymbol*>::iterator sym, symEnd = bss_commons.end();
+  for (sym = bss_commons.begin(); sym != symEnd; ++sym)
+    (*sym)->resolveInfo()->setDesc(ResolveInfo::Define);
+  symEnd = tbss_commons.end();
+  for (sym = tbss_commons.begin(); sym != symEnd; ++sym)
+    (*sym)->resolveInfo()->setDesc(ResolveInfo::Define);
+
+  // --sort-common packs the symbols of the same alignment together. The
+  // sort is stable, so that the order still follows the inputs.
+  switch (config().options().getSortCommon()) {
+    case GeneralOptions::SortCommon::Descending:
+      std::stable_sort(bss_commons.begin(), bss_commons.end(), isMoreAligned);
+      std::stable_sort(tbss_commons.begin(), tbss_commons.end(),
+                       isMoreAligned);
+      break;
+    case GeneralOptions::SortCommon::Ascending:
+      std::stable_sort(bss_commons.begin(), bss_commons.end(), isLessAligned);
+      std::stable_sort(tbss_commons.begin(), tbss_commons.end(),
+                       isLessAligned);
+      break;
+    default:
+      break;
   }
 
-  bss_sect.setSize(bss_offset);
-  tbss_sect.setSize(tbss_offset);
+  bss_sect.setSize(bss_sect.size() + appendCommons(bss_commons, bss_sect));
+  tbss_sect.setSize(tbss_sect.size() + appendCommons(tbss_commons, tbss_sect));
   symbol_list.changeCommonsToGlobal();
   return true;
 }
@@ -1777,20 +1966,25 @@ void GNULDBackend::createProgramHdrs(Module& pModule) {
                (prev_flag & llvm::ELF::PF_W) ^ (cur_flag & llvm::ELF::PF_W)) {
       // 2. create data segment if w/o omagic set
       createPT_LOAD = true;
+    } else if (config().options().hasSeparateCode() &&
+               !config().options().omagic() &&
+               (prev_flag & llvm::ELF::PF_X) ^ (cur_flag & llvm::ELF::PF_X)) {
+      // 3. create code segment and the segment after it if -z separate-code
+      createPT_LOAD = true;
     } else if (sect->kind() == LDFileFormat::BSS && load_seg->isDataSegment() &&
                addrEnd != ldscript.addressMap().find(".bss")) {
-      // 3. create bss segment if w/ -Tbss and there is a data segment
+      // 4. create bss segment if w/ -Tbss and there is a data segment
       createPT_LOAD = true;
     } else if ((sect != &(file_format->getText())) &&
                (sect != &(file_format->getData())) &&
                (sect != &(file_format->getBSS())) &&
                (addrEnd != ldscript.addressMap().find(sect->name()))) {
-      // 4. create PT_LOAD for sections in address map except for text, data,
+      // 5. create PT_LOAD for sections in address map except for text, data,
       // and bss
       createPT_LOAD = true;
     } else if (LDFileFormat::Null == (*prev)->getSection()->kind() &&
                !config().options().getScriptList().empty()) {
-      // 5. create PT_LOAD to hold NULL section if there is a default ldscript
+      // 6. create PT_LOAD to hold NULL section if there is a default ldscript
       createPT_LOAD = true;
     }
 
@@ -1809,6 +2003,30 @@ void GNULDBackend::createProgramHdrs(Module& pModule) {
     prev_flag = cur_flag;
   }
 
+  // -z hugepage-text starts the code segment and the segment after it on a
+  // huge page, so that no other segment shares the huge pages of the code and
+  // the code can be remapped onto transparent huge pages at runtime.
+  if (config().options().hasHugePageText() && !config().options().nmagic() &&
+      !config().options().omagic()) {
+    bool after_text = false;
+    for (ELFSegmentFactory::iterator seg = elfSegmentTable().begin(),
+                                     segEnd = elfSegmentTable().end();
+         seg != segEnd;
+         ++seg) {
+      if (llvm::ELF::PT_LOAD != (*seg)->type())
+        continue;
+
+      if (after_text) {
+        (*seg)->setAlign(hugePageSize());
+        break;
+      }
+      if (((*seg)->flag() & llvm::ELF::PF_X) != 0) {
+        (*seg)->setAlign(hugePageSize());
+        after_text = true;
+      }
+    }
+  }
+
   // make PT_DYNAMIC
   if (file_format->hasDynamic()) {
     ELFSegment* dyn_seg = elfSegmentTable().produce(
@@ -1829,7 +2047,7 @@ void GNULDBackend::createProgramHdrs(Module& pModule) {
       for (ELFSegment::iterator sect = (*seg)->begin(), sectEnd = (*seg)->end();
            sect != sectEnd;
            ++sect) {
-        unsigned int order = getSectionOrder(**sect);
+        unsigned int order = (*sect)->order();
         if (SHO_RELRO_LOCAL == order || SHO_RELRO == order ||
             SHO_RELRO_LAST == order) {
           relro_seg->append(*sect);
@@ -2115,6 +2333,21 @@ void GNULDBackend::setOutputSectionAddress(Module& pModule) {
   SectionMap::iterator out, outBegin, outEnd;
   outBegin = script.sectionMap().begin();
   outEnd = script.sectionMap().end();
+
+  // index the PT_LOAD of each section once, so that the sweep over the output
+  // sections does not scan all segments per section. As in
+  // ELFSegmentFactory::find, a section belongs to the first PT_LOAD holding it.
+  typedef llvm::DenseMap<const LDSection*, ELFSegmentFactory::iterator>
+      LoadSegmentMap;
+  LoadSegmentMap load_segs;
+  for (seg = elfSegmentTable().begin(); seg != segEnd; ++seg) {
+    if ((*seg)->type() != llvm::ELF::PT_LOAD)
+      continue;
+    ELFSegment::iterator sect, sectEnd = (*seg)->end();
+    for (sect = (*seg)->begin(); sect != sectEnd; ++sect)
+      load_segs.insert(std::make_pair(*sect, seg));
+  }
+
   for (out = outBegin; out != outEnd; prev = cur, ++out) {
     cur = (*out)->getSection();
 
@@ -2131,7 +2364,24 @@ void GNULDBackend::setOutputSectionAddress(Module& pModule) {
       (*it).assign(evaluator);
     }
 
-    seg = elfSegmentTable().find(llvm::ELF::PT_LOAD, cur);
+    LoadSegmentMap::iterator load = load_segs.find(cur);
+    seg = (load != load_segs.end()) ? load->second : segEnd;
+
+    // -z separate-code starts the code segment and the segment after it on a
+    // page of their own. Only the common page is padded in both the address
+    // and the file, which keeps them congruent modulo the abi page.
+    bool code_boundary = false;
+    if (config().options().hasSeparateCode() &&
+        !config().options().hasHugePageText() &&
+        config().options().getScriptList().empty() && seg != segEnd &&
+        cur == (*seg)->front()) {
+      LoadSegmentMap::iterator prev_load = load_segs.find(prev);
+      code_boundary =
+          ((*seg)->flag() & llvm::ELF::PF_X) != 0 ||
+          (prev_load != load_segs.end() &&
+           ((*prev_load->second)->flag() & llvm::ELF::PF_X) != 0);
+    }
+
     if (seg != segEnd && cur == (*seg)->front()) {
       if ((*seg)->isBssSegment())
         addr = script.addressMap().find(".bss");
@@ -2176,8 +2426,12 @@ void GNULDBackend::setOutputSectionAddress(Module& pModule) {
             // To do so will add more padding in file, but can save one page
             // at runtime.
             // Avoid doing this optimization if -z relro is given, because there
-            // seems to be too many padding.
-            if (!config().options().hasRelro()) {
+            // seems to be too many padding, unless -z hugepage-text asks for
+            // the padding.
+            if (code_boundary) {
+              alignAddress(vma, commonPageSize());
+            } else if (!config().options().hasRelro() ||
+                       config().options().hasHugePageText()) {
               alignAddress(vma, (*seg)->align());
             } else {
               vma += abiPageSize();
@@ -2206,7 +2460,7 @@ void GNULDBackend::setOutputSectionAddress(Module& pModule) {
         // add padding in front of .got instead.
         // FIXME: Maybe we can handle this in a more general way.
         LDSection& got = getOutputFormat()->getGOT();
-        if ((getSectionOrder(got) == SHO_RELRO_LAST) &&
+        if ((got.order() == SHO_RELRO_LAST) &&
             (got.addr() + got.size() < vma)) {
           uint64_t diff = vma - got.addr() - got.size();
           got.setAddr(vma - got.size());
@@ -2229,6 +2483,15 @@ void GNULDBackend::setOutputSectionAddress(Module& pModule) {
         break;
     }
     alignAddress(offset, cur->align());
+    if (code_boundary)
+      alignAddress(offset, commonPageSize());
+    // a segment aligned beyond the page, as for -z hugepage-text, starts at
+    // an offset congruent to its address modulo its alignment, so that the
+    // file can be mapped in pages of that size.
+    uint64_t page = abiPageSize();
+    if (config().options().hasHugePageText() && seg != segEnd &&
+        cur == (*seg)->front())
+      page = std::max(page, (*seg)->align());
     // in p75, http://www.sco.com/developers/devspecs/gabi41.pdf
     // p_align: As "Program Loading" describes in this chapter of the
     // processor supplement, loadable process segments must have congruent
@@ -2237,9 +2500,8 @@ void GNULDBackend::setOutputSectionAddress(Module& pModule) {
     // size. Otherwise, old objcopy (e.g., binutils 2.17) may fail with our
     // output!
     if ((cur->flag() & llvm::ELF::SHF_ALLOC) != 0 &&
-        (vma & (abiPageSize() - 1)) != (offset & (abiPageSize() - 1))) {
-      uint64_t padding = abiPageSize() + (vma & (abiPageSize() - 1)) -
-                         (offset & (abiPageSize() - 1));
+        (vma & (page - 1)) != (offset & (page - 1))) {
+      uint64_t padding = page + (vma & (page - 1)) - (offset & (page - 1));
       offset += padding;
     }
 
@@ -2255,7 +2517,8 @@ void GNULDBackend::setOutputSectionAddress(Module& pModule) {
       if (invalid != NULL && !(*in)->dotAssignments().empty()) {
         while (invalid != (*in)->dotAssignments().front().first) {
           Fragment* prev = invalid->getPrevNode();
-          invalid->setOffset(prev->getOffset() + prev->size());
+          invalid->setOffset(
+              invalid->alignOffset(prev->getOffset() + prev->size()));
           invalid = invalid->getNextNode();
         }
         invalid = NULL;
@@ -2280,7 +2543,8 @@ void GNULDBackend::setOutputSectionAddress(Module& pModule) {
     if (changed) {
       while (invalid != NULL) {
         Fragment* prev = invalid->getPrevNode();
-        invalid->setOffset(prev->getOffset() + prev->size());
+        invalid->setOffset(
+            invalid->alignOffset(prev->getOffset() + prev->size()));
         invalid = invalid->getNextNode();
       }
 
@@ -2292,10 +2556,18 @@ void GNULDBackend::setOutputSectionAddress(Module& pModule) {
 
 /// placeOutputSections - place output sections based on SectionMap
 void GNULDBackend::placeOutputSections(Module& pModule) {
-  typedef std::vector<LDSection*> Orphans;
-  Orphans orphans;
+  SectionMap::OrderedSectionList orphans;
+  LDSection* null_orphan = NULL;
   SectionMap& sectionMap = pModule.getScript().sectionMap();
 
+  // index the output section descriptions by name, in script order
+  typedef std::vector<SectionMap::Output*> OutputList;
+  llvm::StringMap<OutputList> outputs;
+  for (SectionMap::iterator out = sectionMap.begin(), outEnd = sectionMap.end();
+       out != outEnd;
+       ++out)
+    outputs[(*out)->name()].push_back(*out);
+
   for (Module::iterator it = pModule.begin(), ie = pModule.end(); it != ie;
        ++it) {
     bool wanted = false;
@@ -2355,12 +2627,13 @@ void GNULDBackend::placeOutputSections(Module& pModule) {
     }  // end of switch
 
     if (wanted) {
-      SectionMap::iterator out, outBegin, outEnd;
-      outBegin = sectionMap.begin();
-      outEnd = sectionMap.end();
-      for (out = outBegin; out != outEnd; ++out) {
-        bool matched = false;
-        if ((*it)->name().compare((*out)->name()) == 0) {
+      SectionMap::Output* output = NULL;
+      llvm::StringMap<OutputList>::iterator entry =
+          outputs.find((*it)->name());
+      if (entry != outputs.end()) {
+        OutputList::iterator out, outEnd = entry->second.end();
+        for (out = entry->second.begin(); out != outEnd; ++out) {
+          bool matched = false;
           switch ((*out)->prolog().constraint()) {
             case OutputSectDesc::NO_CONSTRAINT:
               matched = true;
@@ -2373,17 +2646,23 @@ void GNULDBackend::placeOutputSections(Module& pModule) {
               break;
           }  // end of switch
 
-          if (matched)
+          if (matched) {
+            output = *out;
             break;
-        }
-      }  // for each output section description
+          }
+        }  // for each output section description of the name
+      }
 
-      if (out != outEnd) {
+      // classify the section once, the later passes read its order
+      (*it)->setOrder(getSectionOrder(**it));
+      if (output != NULL) {
         // set up the section
-        (*out)->setSection(*it);
-        (*out)->setOrder(getSectionOrder(**it));
+        output->setSection(*it);
+        output->setOrder((*it)->order());
+      } else if ((*it)->kind() == LDFileFormat::Null) {
+        null_orphan = *it;
       } else {
-        orphans.push_back(*it);
+        orphans.push_back(std::make_pair((*it)->order(), *it));
       }
     }
   }  // for each section in Module
@@ -2404,35 +2683,24 @@ void GNULDBackend::placeOutputSections(Module& pModule) {
       type = (*out)->prolog().type();
     } else {
       (*out)->getSection()->setFlag(flag);
+      (*out)->getSection()->setOrder(order);
       (*out)->setOrder(order);
       (*out)->prolog().setType(type);
     }
   }  // for each output section description
 
-  // place orphan sections
-  for (Orphans::iterator it = orphans.begin(), ie = orphans.end(); it != ie;
-       ++it) {
-    size_t order = getSectionOrder(**it);
-    SectionMap::iterator out, outBegin, outEnd;
-    outBegin = sectionMap.begin();
-    outEnd = sectionMap.end();
-
-    if ((*it)->kind() == LDFileFormat::Null)
-      out = sectionMap.insert(outBegin, *it);
-    else {
-      for (out = outBegin; out != outEnd; ++out) {
-        if ((*out)->order() > order)
-          break;
-      }
-      out = sectionMap.insert(out, *it);
-    }
-    (*out)->setOrder(order);
-  }  // for each orphan section
+  // place orphan sections, each before the first output section description
+  // of a larger order, and the null section at the beginning
+  sectionMap.insertByOrder(orphans);
+  if (null_orphan != NULL) {
+    SectionMap::iterator out =
+        sectionMap.insert(sectionMap.begin(), null_orphan);
+    (*out)->setOrder(null_orphan->order());
+  }
 
   // sort output section orders if there is no default ldscript
   if (config().options().getScriptList().empty()) {
-    std::stable_sort(
-        sectionMap.begin(), sectionMap.end(), SectionMap::SHOCompare());
+    sectionMap.sortByOrder();
   }
 
   // when section ordering is fixed, now we can make sure dot assignments are
@@ -2447,7 +2715,7 @@ void GNULDBackend::layout(Module& pModule) {
 
   // 2. update output sections in Module
   SectionMap& sectionMap = pModule.getScript().sectionMap();
-  pModule.getSectionTable().clear();
+  pModule.clearSections();
   for (SectionMap::iterator out = sectionMap.begin(), outEnd = sectionMap.end();
        out != outEnd;
        ++out) {
@@ -2456,7 +2724,7 @@ void GNULDBackend::layout(Module& pModule) {
         (*out)->getSection()->kind() == LDFileFormat::StackNote ||
         config().codeGenType() == LinkerConfig::Object) {
       (*out)->getSection()->setIndex(pModule.size());
-      pModule.getSectionTable().push_back((*out)->getSection());
+      pModule.appendSection(*(*out)->getSection());
     }
   }  // for each output section description
 
@@ -2486,6 +2754,26 @@ void GNULDBackend::createAndSizeEhFrameHdr(Module& pModule) {
   }
 }
 
+void GNULDBackend::createAndSizeBuildID() {
+  // The notes of the inputs with the same name are kept as they are.
+  if (LinkerConfig::Object != config().codeGenType() &&
+      config().options().hasBuildID() &&
+      !getOutputFormat()->getBuildID().hasSectionData()) {
+    m_pBuildID = new BuildIDNote(getOutputFormat()->getBuildID(), config());
+    m_pBuildID->sizeOutput();
+  }
+}
+
+void GNULDBackend::createAndSizeGdbIndex(Module& pModule) {
+  if (LinkerConfig::Object != config().codeGenType() &&
+      config().options().hasGdbIndex() && !config().options().stripDebug() &&
+      !getOutputFormat()->getGdbIndex().hasSectionData()) {
+    m_pGdbIndex = new GdbIndex(getOutputFormat()->getGdbIndex());
+    ThreadPool pool(config().options().numThreads());
+    m_pGdbIndex->sizeOutput(pModule, pool);
+  }
+}
+
 /// mayHaveUnsafeFunctionPointerAccess - check if the section may have unsafe
 /// function pointer access
 bool GNULDBackend::mayHaveUnsafeFunctionPointerAccess(
@@ -2502,6 +2790,18 @@ void GNULDBackend::preLayout(Module& pModule, IRBuilder& pBuilder) {
   // prelayout target first
   doPreLayout(pBuilder);
 
+  // pack the relative relocations once the dynamic relocations are sized
+  packRelativeRelocs();
+
+  // pack the rest in the Android format
+  packAndroidRelocs(pModule);
+
+  // reserve the build ID, which is written after everything else
+  createAndSizeBuildID();
+
+  // the debug sections are merged, so .gdb_index can be sized
+  createAndSizeGdbIndex(pModule);
+
   // change .tbss and .tdata section symbol from Local to LocalDyn category
   if (f_pTDATA != NULL)
     pModule.getSymbolTable().changeToDynamic(*f_pTDATA);
@@ -2525,7 +2825,7 @@ void GNULDBackend::preLayout(Module& pModule, IRBuilder& pBuilder) {
               (*rs)->name(), (*rs)->kind(), (*rs)->type(), (*rs)->flag());
 
           output_sect->setAlign((*rs)->align());
-          pModule.getSectionTable().push_back(output_sect);
+          pModule.appendSection(*output_sect);
         }
 
         // set output relocation section link
@@ -2572,7 +2872,10 @@ void GNULDBackend::preLayout(Module& pModule, IRBuilder& pBuilder) {
 void GNULDBackend::postLayout(Module& pModule, IRBuilder& pBuilder) {
   if (LinkerConfig::Object != config().codeGenType()) {
     // do relaxation
-    relax(pModule, pBuilder);
+    {
+      TimeTrace::Scope scope("relax");
+      relax(pModule, pBuilder);
+    }
     // set up the attributes of program headers
     setupProgramHdrs(pModule.getScript());
   }
@@ -2584,7 +2887,38 @@ void GNULDBackend::postProcessing(FileOutputBuffer& pOutput) {
   if (LinkerConfig::Object != config().codeGenType() &&
       config().options().hasEhFrameHdr() && getOutputFormat()->hasEhFrame()) {
     // emit eh_frame_hdr
-    m_pEhFrameHdr->emitOutput<32>(pOutput);
+    ThreadPool pool(config().options().numThreads());
+    if (config().targets().is64Bits())
+      m_pEhFrameHdr->emitOutput<64>(pOutput, pool);
+    else
+      m_pEhFrameHdr->emitOutput<32>(pOutput, pool);
+  }
+
+  // the places of the packed RELA relocations hold their addends
+  if (m_pRelrDyn != NULL)
+    m_pRelrDyn->applyAddends(pOutput);
+
+  // a prelinked output holds the values at its base in the places of the
+  // relative relocations, which are kept for a loader that maps it elsewhere
+  if ((LinkerConfig::DynObj == config().codeGenType()) &&
+      config().options().hasPrelinkBase())
+    applyRelativeAddends(pOutput);
+
+  // .gdb_index was resolved with the relocation results
+  if (m_pGdbIndex != NULL && getOutputFormat()->hasGdbIndex()) {
+    ThreadPool pool(config().options().numThreads());
+    m_pGdbIndex->emitOutput(pOutput, pool);
+  }
+
+  // the build ID covers the whole output, so it is the last one to write.
+  // The rest of the output is final, and is written while it is hashed.
+  if (m_pBuildID != NULL) {
+    const LDSection& note = getOutputFormat()->getBuildID();
+    pOutput.flush(0x0, note.offset());
+    pOutput.flush(note.offset() + note.size(),
+                  pOutput.getBufferSize() - note.offset() - note.size());
+    ThreadPool pool(config().options().numThreads());
+    m_pBuildID->emitOutput(pOutput, pool);
   }
 }
 
@@ -2629,6 +2963,78 @@ unsigned GNULDBackend::getGNUHashMaskbitslog2(unsigned pNumOfSymbols) const {
   return maskbitslog2;
 }
 
+/// tuneGNUHash - the candidates have up to twice the default buckets and four
+/// times the default bloom filter. The budget bounds the number of candidates
+/// evaluated, and the smallest table within 1% of the best cost is chosen.
+void GNULDBackend::tuneGNUHash(const Module::SymbolTable& pSymtab,
+                               size_t& pNumOfBuckets,
+                               unsigned& pMaskbitslog2) const {
+  std::vector<const LDSymbol*> symbols;
+  Module::const_sym_iterator symbol, symEnd = pSymtab.dynamicEnd();
+  for (symbol = pSymtab.dynamicBegin(); symbol != symEnd; ++symbol) {
+    if (DynsymCompare().needGNUHash(**symbol))
+      symbols.push_back(*symbol);
+  }
+  if (symbols.empty())
+    return;
+
+  ThreadPool pool(config().options().numThreads());
+  std::vector<uint32_t> hashes(symbols.size());
+  parallelFor(pool, 0, symbols.size(), [&symbols, &hashes](size_t pIndex) {
+    hashes[pIndex] = hash::StringHash<hash::DJB>()(symbols[pIndex]->name());
+  });
+
+  static const double factors[] = {0.5, 0.75, 1.0, 1.5, 2.0};
+  std::vector<size_t> bucket_counts(1, pNumOfBuckets);
+  for (size_t i = 0; i < sizeof(factors) / sizeof(factors[0]); ++i) {
+    size_t count = nextPrime(static_cast<size_t>(symbols.size() * factors[i]));
+    if (count <= 2 * pNumOfBuckets)
+      bucket_counts.push_back(count);
+  }
+
+  std::vector<GNUHashLayout> layouts;
+  for (unsigned bits_log2 = pMaskbitslog2; bits_log2 <= pMaskbitslog2 + 2;
+       ++bits_log2) {
+    for (size_t i = 0; i < bucket_counts.size(); ++i) {
+      GNUHashLayout layout;
+      layout.nbucket = bucket_counts[i];
+      layout.maskbitslog2 = bits_log2;
+      layout.size = 4 * layout.nbucket + (UINT64_C(1) << bits_log2) / 8;
+      layout.cost = 0.0;
+      layouts.push_back(layout);
+    }
+  }
+  // the default layout is always evaluated, then the smaller ones first
+  std::sort(layouts.begin() + 1, layouts.end(), isSmallerGNUHash);
+  layouts.erase(std::unique(layouts.begin() + 1, layouts.end(),
+                            isSameGNUHash),
+                layouts.end());
+  if (layouts.size() > config().options().hashOptimizeBudget())
+    layouts.resize(config().options().hashOptimizeBudget());
+
+  unsigned word_bits = config().targets().bitclass();
+  parallelFor(pool, 0, layouts.size(), [&](size_t pIndex) {
+    layouts[pIndex].cost = evaluateGNUHash(hashes,
+                                           layouts[pIndex].nbucket,
+                                           layouts[pIndex].maskbitslog2,
+                                           word_bits);
+  });
+
+  double best = layouts[0].cost;
+  for (size_t i = 1; i < layouts.size(); ++i)
+    best = std::min(best, layouts[i].cost);
+  const GNUHashLayout* chosen = NULL;
+  for (size_t i = 0; i < layouts.size(); ++i) {
+    if (layouts[i].cost > best * 1.01)
+      continue;
+    if ((chosen == NULL) || (layouts[i].size < chosen->size) ||
+        ((layouts[i].size == chosen->size) && (layouts[i].cost < chosen->cost)))
+      chosen = &layouts[i];
+  }
+  pNumOfBuckets = chosen->nbucket;
+  pMaskbitslog2 = chosen->maskbitslog2;
+}
+
 /// isDynamicSymbol
 bool GNULDBackend::isDynamicSymbol(const LDSymbol& pSymbol) const {
   // If a local symbol is in the LDContext's symbol table, it's a real local
@@ -2695,6 +3101,11 @@ uint64_t GNULDBackend::abiPageSize() const {
     return m_pInfo->abiPageSize();
 }
 
+/// hugePageSize - the alignment of the code segment for -z hugepage-text.
+uint64_t GNULDBackend::hugePageSize() const {
+  return std::max(m_pInfo->hugePageSize(), abiPageSize());
+}
+
 /// isSymbolPreemtible - whether the symbol can be preemted by other
 /// link unit
 bool GNULDBackend::isSymbolPreemptible(const ResolveInfo& pSym) const {
@@ -2712,6 +3123,18 @@ bool GNULDBackend::isSymbolPreemptible(const ResolveInfo& pSym) const {
   if (config().options().Bsymbolic())
     return false;
 
+  // --dynamic-list keeps only the symbols it lists preemptible, and
+  // -Bsymbolic-functions binds the defined functions
+  if (pSym.isDefine() && !pSym.isDyn()) {
+    if (config().options().hasDynamicList() &&
+        m_DynamicListSymbols.count(&pSym) == 0)
+      return false;
+    if (!config().options().hasDynamicList() &&
+        config().options().BsymbolicFunctions() &&
+        ResolveInfo::Function == pSym.type())
+      return false;
+  }
+
   // A local defined symbol should be non-preemptible.
   // This issue is found when linking libstdc++ on freebsd. A R_386_GOT32
   // relocation refers to a local defined symbol, and we should generate a
@@ -2722,6 +3145,11 @@ bool GNULDBackend::isSymbolPreemptible(const ResolveInfo& pSym) const {
   return true;
 }
 
+/// addDynamicListSymbol - pSym is listed in the --dynamic-list
+void GNULDBackend::addDynamicListSymbol(const ResolveInfo& pSym) {
+  m_DynamicListSymbols.insert(&pSym);
+}
+
 /// symbolNeedsDynRel - return whether the symbol needs a dynamic relocation
 bool GNULDBackend::symbolNeedsDynRel(const ResolveInfo& pSym,
                                      bool pSymHasPLT,
@@ -2773,6 +3201,25 @@ bool GNULDBackend::symbolNeedsPLT(const ResolveInfo& pSym) const {
   return (pSym.isDyn() || pSym.isUndef() || isSymbolPreemptible(pSym));
 }
 
+/// symbolNeedsCanonicalPLT - return whether the absolute reference pReloc to
+/// pSym resolves to the PLT entry of pSym
+bool GNULDBackend::symbolNeedsCanonicalPLT(const Relocation& pReloc,
+                                           const ResolveInfo& pSym) const {
+  if (!symbolNeedsPLT(pSym))
+    return false;
+
+  // In the executables, the PLT entry becomes the address of the function.
+  // Under -z nocopyreloc, a writable place gets a symbolic dynamic relocation
+  // instead, which is resolved to the function itself.
+  if (config().options().hasNoCopyReloc() && !config().isCodeIndep() &&
+      pSym.isDyn() && ResolveInfo::Function == pSym.type()) {
+    uint32_t flag = pReloc.targetRef().frag()->getParent()->getSection().flag();
+    if (0 != (flag & llvm::ELF::SHF_WRITE))
+      return false;
+  }
+  return true;
+}
+
 /// symbolHasFinalValue - return true if the symbol's value can be decided at
 /// link time
 bool GNULDBackend::symbolFinalValueIsKnown(const ResolveInfo& pSym) const {
@@ -2808,17 +3255,36 @@ bool GNULDBackend::symbolNeedsCopyReloc(const Relocation& pReloc,
       pSym.type() == ResolveInfo::Function || pSym.size() == 0)
     return false;
 
-  // check if the option -z nocopyreloc is given
-  if (config().options().hasNoCopyReloc())
-    return false;
-
   // TODO: Is this check necessary?
   // if relocation target place is readonly, a copy relocation is needed
-  uint32_t flag = pReloc.targetRef().frag()->getParent()->getSection().flag();
-  if (0 == (flag & llvm::ELF::SHF_WRITE))
-    return true;
+  const LDSection& target =
+      pReloc.targetRef().frag()->getParent()->getSection();
+  if (0 != (target.flag() & llvm::ELF::SHF_WRITE))
+    return false;
 
-  return false;
+  // check if the option -z nocopyreloc is given, and tell once for each
+  // symbol that the place is left to a dynamic relocation
+  if (config().options().hasNoCopyReloc()) {
+    if (m_NoCopyRelocSymbols.insert(&pSym).second)
+      warning(diag::warn_nocopyreloc) << pSym.name() << target.name();
+    return false;
+  }
+  return true;
+}
+
+/// noteCopyReloc - count the copy relocation of pSym. The dynamic linker
+/// copies the size of pSym at startup.
+void GNULDBackend::noteCopyReloc(const ResolveInfo& pSym) {
+  ++NumCopyRelocs;
+  NumCopyBytes += pSym.size();
+  Statistic::Add(std::string("backend.copy-reloc-bytes.") + pSym.name(),
+                 pSym.size());
+}
+
+/// noteCanonicalPLT - count the PLT entry of pSym as its address
+void GNULDBackend::noteCanonicalPLT(const ResolveInfo& pSym) {
+  if (m_CanonicalPLTSymbols.insert(&pSym).second)
+    ++NumCanonicalPLTs;
 }
 
 LDSymbol& GNULDBackend::getTDATASymbol() {
@@ -2867,6 +3333,11 @@ void GNULDBackend::sortRelocation(LDSection& pSection) {
   if (!config().options().hasCombReloc())
     return;
 
+  // the packed relocations are ordered when they are sized
+  if ((m_pPackedRelDyn != NULL) &&
+      (&pSection == &m_pPackedRelDyn->getSection()))
+    return;
+
   assert(pSection.kind() == LDFileFormat::Relocation);
 
   switch (config().codeGenType()) {
@@ -2875,13 +3346,172 @@ void GNULDBackend::sortRelocation(LDSection& pSection) {
       if (&pSection == &getOutputFormat()->getRelDyn() ||
           &pSection == &getOutputFormat()->getRelaDyn()) {
         if (pSection.hasRelocData())
-          pSection.getRelocData()->sort(RelocCompare(*this));
+          sortDynRelocation(*pSection.getRelocData());
       }
     default:
       return;
   }
 }
 
+/// sortDynRelocation - sort pRelocs by RelocSortKey. The keys are computed
+/// once for each relocation and sorted as an array, least significant key
+/// first, and the list is rebuilt in the sorted order.
+void GNULDBackend::sortDynRelocation(RelocData& pRelocs) {
+  std::vector<RelocSortKey> keys;
+  keys.reserve(pRelocs.size());
+  RelocData::iterator reloc, rEnd = pRelocs.end();
+  for (reloc = pRelocs.begin(); reloc != rEnd; ++reloc) {
+    RelocSortKey key;
+    key.reloc = &*reloc;
+    key.symbol = 0;
+    if (reloc->symInfo() != NULL)
+      key.symbol = getSymbolIdx(reloc->symInfo()->outSymbol()) + 1;
+    key.place = reloc->place();
+    key.type = reloc->type();
+    key.addend = reloc->addend();
+    keys.push_back(key);
+  }
+
+  std::vector<RelocSortKey> buffer;
+  radixSort(keys, buffer, &RelocSortKey::addend);
+  radixSort(keys, buffer, &RelocSortKey::type);
+  radixSort(keys, buffer, &RelocSortKey::place);
+  radixSort(keys, buffer, &RelocSortKey::symbol);
+
+  RelocData::RelocationListType& list = pRelocs.getRelocationList();
+  while (!list.empty())
+    list.remove(list.begin());
+  std::vector<RelocSortKey>::iterator key, keyEnd = keys.end();
+  for (key = keys.begin(); key != keyEnd; ++key)
+    list.push_back(key->reloc);
+}
+
+void GNULDBackend::packRelativeRelocs() {
+  if (!config().options().hasPackRelativeRelocs() ||
+      config().isCodeStatic() ||
+      ((LinkerConfig::DynObj != config().codeGenType()) &&
+       (LinkerConfig::Exec != config().codeGenType())))
+    return;
+
+  ELFFileFormat* file_format = getOutputFormat();
+  LDSection* rel_dyn = NULL;
+  size_t entry_size = 0;
+  if (file_format->hasRelDyn()) {
+    rel_dyn = &file_format->getRelDyn();
+    entry_size = getRelEntrySize();
+  } else if (file_format->hasRelaDyn()) {
+    rel_dyn = &file_format->getRelaDyn();
+    entry_size = getRelaEntrySize();
+  }
+  if ((rel_dyn == NULL) || !rel_dyn->hasRelocData())
+    return;
+
+  m_pRelrDyn = new OutputRelrSection(file_format->getRelrDyn(),
+                                     config(),
+                                     llvm::ELF::SHT_RELA == rel_dyn->type());
+
+  RelocData::RelocationListType& list =
+      rel_dyn->getRelocData()->getRelocationList();
+  RelocData::iterator reloc = list.begin(), rEnd = list.end();
+  while (reloc != rEnd) {
+    RelocData::iterator cur = reloc++;
+    if (isRelativeReloc(*cur) && m_pRelrDyn->isPackable(*cur))
+      m_pRelrDyn->add(*list.remove(cur));
+  }
+
+  rel_dyn->setSize(list.size() * entry_size);
+  m_pRelrDyn->finalizeSectionSize();
+}
+
+void GNULDBackend::applyRelativeAddends(FileOutputBuffer& pOutput) const {
+  // the places of REL relocations hold their addends already
+  const ELFFileFormat* file_format = getOutputFormat();
+  if (!file_format->hasRelaDyn() ||
+      !file_format->getRelaDyn().hasRelocData())
+    return;
+
+  const bool swap =
+      (llvm::sys::IsLittleEndianHost != config().targets().isLittleEndian());
+  uint8_t* data = pOutput.getBufferStart();
+  const RelocData* relocs = file_format->getRelaDyn().getRelocData();
+  RelocData::const_iterator reloc, rEnd = relocs->end();
+  for (reloc = relocs->begin(); reloc != rEnd; ++reloc) {
+    if (!isRelativeReloc(*reloc))
+      continue;
+    const FragmentRef& ref = reloc->targetRef();
+    uint8_t* place = data + ref.frag()->getParent()->getSection().offset() +
+                     ref.getOutputOffset();
+    if (config().targets().is32Bits()) {
+      uint32_t value = static_cast<uint32_t>(reloc->addend());
+      if (swap)
+        value = bswap32(value);
+      std::memcpy(place, &value, 4);
+    } else {
+      uint64_t value = reloc->addend();
+      if (swap)
+        value = bswap64(value);
+      std::memcpy(place, &value, 8);
+    }
+  }
+}
+
+void GNULDBackend::packAndroidRelocs(const Module& pModule) {
+  if (!config().options().hasPackAndroidRelocs() ||
+      config().isCodeStatic() ||
+      ((LinkerConfig::DynObj != config().codeGenType()) &&
+       (LinkerConfig::Exec != config().codeGenType())))
+    return;
+
+  ELFFileFormat* file_format = getOutputFormat();
+  LDSection* rel_dyn = NULL;
+  if (file_format->hasRelDyn())
+    rel_dyn = &file_format->getRelDyn();
+  else if (file_format->hasRelaDyn())
+    rel_dyn = &file_format->getRelaDyn();
+  if ((rel_dyn == NULL) || !rel_dyn->hasRelocData())
+    return;
+
+  // The order is fixed before layout. The relative relocations go first, and
+  // the others are grouped by symbol and type in the order they are created.
+  // Each group is ordered by the output sections and the offsets of the places.
+  std::map<const LDSection*, size_t> section_ranks;
+  Module::const_iterator sect, sectEnd = pModule.end();
+  for (sect = pModule.begin(); sect != sectEnd; ++sect)
+    section_ranks.insert(std::make_pair(*sect, section_ranks.size()));
+
+  typedef std::pair<const ResolveInfo*, Relocation::Type> InfoKey;
+  std::map<InfoKey, size_t> info_ranks;
+  std::vector<PackedRelocKey> keys;
+  RelocData::RelocationListType& list =
+      rel_dyn->getRelocData()->getRelocationList();
+  keys.reserve(list.size());
+  RelocData::iterator reloc, rEnd = list.end();
+  for (reloc = list.begin(); reloc != rEnd; ++reloc) {
+    PackedRelocKey key;
+    key.reloc = &*reloc;
+    key.info = 0;
+    if (!isRelativeReloc(*reloc)) {
+      InfoKey info(reloc->symInfo(), reloc->type());
+      key.info = info_ranks.insert(
+          std::make_pair(info, info_ranks.size() + 1)).first->second;
+    }
+    const FragmentRef& ref = reloc->targetRef();
+    key.section = section_ranks[&ref.frag()->getParent()->getSection()];
+    key.offset = ref.getOutputOffset();
+    keys.push_back(key);
+  }
+  std::stable_sort(keys.begin(), keys.end(), isPackedRelocBefore);
+
+  while (!list.empty())
+    list.remove(list.begin());
+  std::vector<PackedRelocKey>::iterator key, keyEnd = keys.end();
+  for (key = keys.begin(); key != keyEnd; ++key)
+    list.push_back(key->reloc);
+
+  m_pPackedRelDyn = new OutputPackedRelocSection(*rel_dyn, config(), *this);
+  m_pPackedRelDyn->finalizeSectionSize();
+}
+
 unsigned GNULDBackend::stubGroupSize() const {
   const unsigned group_size = config().targets().getStubGroupSize();
   if (group_size == 0) {
@@ -2917,6 +3547,7 @@ bool GNULDBackend::relax(Module& pModule, IRBuilder& pBuilder) {
 
   bool finished = true;
   do {
+    ++NumRelaxPasses;
     if (doRelax(pModule, pBuilder, finished)) {
       setOutputSectionAddress(pModule);
     }
@@ -2937,43 +3568,4 @@ bool GNULDBackend::DynsymCompare::operator()(const LDSymbol* X,
   return !needGNUHash(*X) && needGNUHash(*Y);
 }
 
-bool GNULDBackend::RelocCompare::operator()(const Relocation& X,
-                                            const Relocation& Y) const {
-  // 1. compare if relocation is relative
-  if (X.symInfo() == NULL) {
-    if (Y.symInfo() != NULL)
-      return true;
-  } else if (Y.symInfo() == NULL) {
-    return false;
-  } else {
-    // 2. compare the symbol index
-    size_t symIdxX = m_Backend.getSymbolIdx(X.symInfo()->outSymbol());
-    size_t symIdxY = m_Backend.getSymbolIdx(Y.symInfo()->outSymbol());
-    if (symIdxX < symIdxY)
-      return true;
-    if (symIdxX > symIdxY)
-      return false;
-  }
-
-  // 3. compare the relocation address
-  if (X.place() < Y.place())
-    return true;
-  if (X.place() > Y.place())
-    return false;
-
-  // 4. compare the relocation type
-  if (X.type() < Y.type())
-    return true;
-  if (X.type() > Y.type())
-    return false;
-
-  // 5. compare the addend
-  if (X.addend() < Y.addend())
-    return true;
-  if (X.addend() > Y.addend())
-    return false;
-
-  return false;
-}
-
 }  // namespace mcld
@@ -89,6 +89,15 @@ bool HexagonAbsoluteStub::isMyDuty(const class Relocation& pReloc,
   return true;
 }
 
+bool HexagonAbsoluteStub::getDutyTypes(std::vector<Type>& pTypes) const {
+  pTypes.push_back(llvm::ELF::R_HEX_B22_PCREL);
+  pTypes.push_back(llvm::ELF::R_HEX_B15_PCREL);
+  pTypes.push_back(llvm::ELF::R_HEX_B7_PCREL);
+  pTypes.push_back(llvm::ELF::R_HEX_B13_PCREL);
+  pTypes.push_back(llvm::ELF::R_HEX_B9_PCREL);
+  return true;
+}
+
 const std::string& HexagonAbsoluteStub::name() const {
   return m_Name;
 }
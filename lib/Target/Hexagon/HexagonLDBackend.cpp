@@ -24,15 +24,19 @@
 #include "mcld/LD/ELFSegmentFactory.h"
 #include "mcld/LD/ELFSegment.h"
 #include "mcld/LD/LDContext.h"
+#include "mcld/LD/RelocData.h"
 #include "mcld/LD/StubFactory.h"
 #include "mcld/Object/ObjectBuilder.h"
 #include "mcld/Support/MemoryArea.h"
 #include "mcld/Support/MsgHandling.h"
 #include "mcld/Support/TargetRegistry.h"
+#include "mcld/Support/ThreadPool.h"
 
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/Triple.h>
 #include <llvm/Support/Casting.h>
 
+#include <algorithm>
 #include <cstring>
 #include <vector>
 
@@ -226,6 +230,30 @@ uint64_t HexagonLDBackend::emitSectionData(const LDSection& pSection,
   return pRegion.size();
 }
 
+bool HexagonLDBackend::fillCodePadding(uint8_t* pData,
+                                       uint64_t pAddress,
+                                       size_t pSize) const {
+  // the parse bits of the last word of a packet are 0b11, and of the others
+  // are 0b01. A packet holds up to four words.
+  const uint32_t nop = 0x7f000000;
+  const uint32_t not_end = 0x4000;
+  const uint32_t end = 0xc000;
+
+  // the bytes in front of the first word boundary are not code
+  size_t offset = (4 - pAddress % 4) % 4;
+  std::memset(pData, 0x0, std::min(offset, pSize));
+
+  size_t words = (pSize > offset) ? (pSize - offset) / 4 : 0;
+  for (size_t i = 0; i < words; ++i, offset += 4) {
+    bool last = (i % 4 == 3) || (i + 1 == words);
+    uint32_t word = nop | (last ? end : not_end);
+    std::memcpy(pData + offset, &word, 4);
+  }
+  if (offset < pSize)
+    std::memset(pData + offset, 0x0, pSize - offset);
+  return true;
+}
+
 HexagonGOT& HexagonLDBackend::getGOT() {
   assert(m_pGOT != NULL);
   return *m_pGOT;
@@ -548,52 +576,50 @@ bool HexagonLDBackend::doRelax(Module& pModule,
   assert(getStubFactory() != NULL && getBRIslandFactory() != NULL);
   bool isRelaxed = false;
   ELFFileFormat* file_format = getOutputFormat();
-  // check branch relocs and create the related stubs if needed
-  Module::obj_iterator input, inEnd = pModule.obj_end();
-  for (input = pModule.obj_begin(); input != inEnd; ++input) {
-    LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
-    for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
-      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
-        continue;
-      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
-      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
-        switch (reloc->type()) {
-          case llvm::ELF::R_HEX_B22_PCREL:
-          case llvm::ELF::R_HEX_B15_PCREL:
-          case llvm::ELF::R_HEX_B7_PCREL:
-          case llvm::ELF::R_HEX_B13_PCREL:
-          case llvm::ELF::R_HEX_B9_PCREL: {
-            Relocation* relocation = llvm::cast<Relocation>(reloc);
-            uint64_t sym_value = 0x0;
-            LDSymbol* symbol = relocation->symInfo()->outSymbol();
-            if (symbol->hasFragRef()) {
-              uint64_t value = symbol->fragRef()->getOutputOffset();
-              uint64_t addr =
-                  symbol->fragRef()->frag()->getParent()->getSection().addr();
-              sym_value = addr + value;
-            }
-            Stub* stub = getStubFactory()->create(*relocation,  // relocation
-                                                  sym_value,  // symbol value
-                                                  pBuilder,
-                                                  *getBRIslandFactory());
-            if (stub != NULL) {
-              assert(stub->symInfo() != NULL);
-              // reset the branch target of the reloc to this stub instead
-              relocation->setSymInfo(stub->symInfo());
-
-              // increase the size of .symtab and .strtab
-              LDSection& symtab = file_format->getSymTab();
-              LDSection& strtab = file_format->getStrTab();
-              symtab.setSize(symtab.size() + sizeof(llvm::ELF::Elf32_Sym));
-              strtab.setSize(strtab.size() + stub->symInfo()->nameSize() + 1);
-              isRelaxed = true;
-            }
-          } break;
-
-          default:
-            break;
-        }
-      }
+  // find the branch relocs which need stubs by the current layout
+  StubFactory::CandidateList candidates;
+  StubFactory::BranchTarget target = [](const Relocation& pReloc,
+                                        uint64_t& pTarget) {
+    switch (pReloc.type()) {
+      case llvm::ELF::R_HEX_B22_PCREL:
+      case llvm::ELF::R_HEX_B15_PCREL:
+      case llvm::ELF::R_HEX_B7_PCREL:
+      case llvm::ELF::R_HEX_B13_PCREL:
+      case llvm::ELF::R_HEX_B9_PCREL:
+        break;
+      default:
+        return false;
+    }
+    pTarget = 0x0;
+    const LDSymbol* symbol = pReloc.symInfo()->outSymbol();
+    if (symbol->hasFragRef()) {
+      uint64_t value = symbol->fragRef()->getOutputOffset();
+      uint64_t addr =
+          symbol->fragRef()->frag()->getParent()->getSection().addr();
+      pTarget = addr + value;
+    }
+    return true;
+  };
+  ThreadPool pool(config().options().numThreads());
+  getStubFactory()->findStubs(pModule, target, pool, candidates);
+
+  // create the stubs in the order of the inputs
+  StubFactory::CandidateList::iterator cand, candEnd = candidates.end();
+  for (cand = candidates.begin(); cand != candEnd; ++cand) {
+    Relocation* relocation = cand->reloc;
+    Stub* stub = getStubFactory()->create(
+        *relocation, *cand->prototype, pBuilder, *getBRIslandFactory());
+    if (stub != NULL) {
+      assert(stub->symInfo() != NULL);
+      // reset the branch target of the reloc to this stub instead
+      relocation->setSymInfo(stub->symInfo());
+
+      // increase the size of .symtab and .strtab
+      LDSection& symtab = file_format->getSymTab();
+      LDSection& strtab = file_format->getStrTab();
+      symtab.setSize(symtab.size() + sizeof(llvm::ELF::Elf32_Sym));
+      strtab.setSize(strtab.size() + stub->symInfo()->nameSize() + 1);
+      isRelaxed = true;
     }
   }
 
@@ -633,8 +659,9 @@ bool HexagonLDBackend::doRelax(Module& pModule,
        ++it) {
     Fragment* invalid = *it;
     while (invalid != NULL) {
-      invalid->setOffset(invalid->getPrevNode()->getOffset() +
-                         invalid->getPrevNode()->size());
+      invalid->setOffset(
+          invalid->alignOffset(invalid->getPrevNode()->getOffset() +
+                               invalid->getPrevNode()->size()));
       invalid = invalid->getNextNode();
     }
   }
@@ -722,8 +749,8 @@ bool HexagonLDBackend::SetSDataSection() {
     SectionData::FragmentListType::iterator fragTo, fragToEnd = to_list.end();
     uint32_t offset = 0;
     for (fragTo = to_list.begin(); fragTo != fragToEnd; ++fragTo) {
-      fragTo->setOffset(offset);
-      offset += fragTo->size();
+      fragTo->setOffset(fragTo->alignOffset(offset));
+      offset = fragTo->getOffset() + fragTo->size();
     }
 
     // set up pTo's header
@@ -741,8 +768,61 @@ bool HexagonLDBackend::SetSDataSection() {
   return true;
 }
 
+/// getSmallCommonSection - the .scommon section of the common symbols of
+/// pSize bytes, or NULL if they are larger than -G
+LDSection* HexagonLDBackend::getSmallCommonSection(uint64_t pSize) const {
+  int8_t maxGPSize = config().targets().getGPSize();
+  if (static_cast<int64_t>(pSize) > maxGPSize)
+    return NULL;
+  switch (pSize) {
+    case 1:
+      return m_pscommon_1;
+    case 2:
+      return m_pscommon_2;
+    case 4:
+      return m_pscommon_4;
+    case 8:
+      return m_pscommon_8;
+    default:
+      return NULL;
+  }
+}
+
+/// countGPRelRefs - count the GP-relative references to every symbol of
+/// pModule
+static void countGPRelRefs(
+    const Module& pModule,
+    llvm::DenseMap<const ResolveInfo*, uint64_t>& pRefs) {
+  Module::const_obj_iterator obj, objEnd = pModule.obj_end();
+  for (obj = pModule.obj_begin(); obj != objEnd; ++obj) {
+    const LDContext* context = (*obj)->context();
+    LDContext::const_sect_iterator rs, rsEnd = context->relocSectEnd();
+    for (rs = context->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+        continue;
+      RelocData::const_iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+        switch (reloc->type()) {
+          case llvm::ELF::R_HEX_GPREL16_0:
+          case llvm::ELF::R_HEX_GPREL16_1:
+          case llvm::ELF::R_HEX_GPREL16_2:
+          case llvm::ELF::R_HEX_GPREL16_3:
+            ++pRefs[reloc->symInfo()];
+            break;
+          default:
+            break;
+        }
+      }
+    }
+  }
+}
+
 /// allocateCommonSymbols - allocate common symbols in the corresponding
 /// sections. This is called at pre-layout stage.
+///
+/// The common symbols of at most -G bytes go into .sdata. With
+/// --small-data-by-refs, only those accessed relative to GP do, the most
+/// accessed first, and the window of GP is not spent on the others.
 bool HexagonLDBackend::allocateCommonSymbols(Module& pModule) {
   SymbolCategory& symbol_list = pModule.getSymbolTable();
 
@@ -751,7 +831,11 @@ bool HexagonLDBackend::allocateCommonSymbols(Module& pModule) {
     return true;
   }
 
-  int8_t maxGPSize = config().targets().getGPSize();
+  bool by_refs = config().targets().smallDataByRefs();
+  llvm::DenseMap<const ResolveInfo*, uint64_t> refs;
+  if (by_refs)
+    countGPRelRefs(pModule, refs);
+  std::vector<LDSymbol*> small_commons;
 
   SymbolCategory::iterator com_sym, com_end;
 
@@ -777,59 +861,39 @@ bool HexagonLDBackend::allocateCommonSymbols(Module& pModule) {
   uint64_t bss_offset = bss_sect.size();
   uint64_t tbss_offset = tbss_sect.size();
 
-  // allocate all local common symbols
-  com_end = symbol_list.localEnd();
-
-  for (com_sym = symbol_list.localBegin(); com_sym != com_end; ++com_sym) {
-    if (ResolveInfo::Common == (*com_sym)->desc()) {
+  // allocate all local common symbols, and then all global ones
+  for (int pass = 0; pass < 2; ++pass) {
+    if (pass == 0) {
+      com_sym = symbol_list.localBegin();
+      com_end = symbol_list.localEnd();
+    } else {
+      com_sym = symbol_list.commonBegin();
+      com_end = symbol_list.commonEnd();
+    }
+    for (; com_sym != com_end; ++com_sym) {
+      if (pass == 0 && ResolveInfo::Common != (*com_sym)->desc())
+        continue;
       // We have to reset the description of the symbol here. When doing
       // incremental linking, the output relocatable object may have common
-      // symbols. Therefore, we can not treat common symbols as normal symbols
-      // when emitting the regular name pools. We must change the symbols'
-      // description here.
+      // symbols. Therefore, we can not treat common symbols as normal
+      // symbols when emitting the regular name pools. We must change the
+      // symbols' description here.
       (*com_sym)->resolveInfo()->setDesc(ResolveInfo::Define);
-      Fragment* frag = new FillFragment(0x0, 1, (*com_sym)->size());
 
-      switch ((*com_sym)->size()) {
-        case 1:
-          if (maxGPSize <= 0)
-            break;
-          ObjectBuilder::AppendFragment(
-              *frag, *(m_pscommon_1->getSectionData()), (*com_sym)->value());
-          (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-          continue;
-        case 2:
-          if (maxGPSize <= 1)
-            break;
-          ObjectBuilder::AppendFragment(
-              *frag, *(m_pscommon_2->getSectionData()), (*com_sym)->value());
-          (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-          continue;
-        case 4:
-          if (maxGPSize <= 3)
-            break;
-          ObjectBuilder::AppendFragment(
-              *frag, *(m_pscommon_4->getSectionData()), (*com_sym)->value());
-          (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-          continue;
-        case 8:
-          if (maxGPSize <= 7)
-            break;
-          ObjectBuilder::AppendFragment(
-              *frag, *(m_pscommon_8->getSectionData()), (*com_sym)->value());
-          (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-          continue;
-        default:
-          break;
+      LDSection* small = getSmallCommonSection((*com_sym)->size());
+      if (small != NULL &&
+          (!by_refs || refs.count((*com_sym)->resolveInfo()) != 0)) {
+        small_commons.push_back(*com_sym);
+        continue;
       }
 
+      Fragment* frag = new FillFragment(0x0, 1, (*com_sym)->size());
       if (ResolveInfo::ThreadLocal == (*com_sym)->type()) {
         // allocate TLS common symbol in tbss section
         tbss_offset += ObjectBuilder::AppendFragment(
             *frag, *tbss_sect_data, (*com_sym)->value());
         (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
       } else {
-        // FIXME: how to identify small and large common symbols?
         bss_offset += ObjectBuilder::AppendFragment(
             *frag, *bss_sect_data, (*com_sym)->value());
         (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
@@ -837,61 +901,20 @@ bool HexagonLDBackend::allocateCommonSymbols(Module& pModule) {
     }
   }
 
-  // allocate all global common symbols
-  com_end = symbol_list.commonEnd();
-  for (com_sym = symbol_list.commonBegin(); com_sym != com_end; ++com_sym) {
-    // We have to reset the description of the symbol here. When doing
-    // incremental linking, the output relocatable object may have common
-    // symbols. Therefore, we can not treat common symbols as normal symbols
-    // when emitting the regular name pools. We must change the symbols'
-    // description here.
-    (*com_sym)->resolveInfo()->setDesc(ResolveInfo::Define);
-    Fragment* frag = new FillFragment(0x0, 1, (*com_sym)->size());
-
-    switch ((*com_sym)->size()) {
-      case 1:
-        if (maxGPSize <= 0)
-          break;
-        ObjectBuilder::AppendFragment(
-            *frag, *(m_pscommon_1->getSectionData()), (*com_sym)->value());
-        (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-        continue;
-      case 2:
-        if (maxGPSize <= 1)
-          break;
-        ObjectBuilder::AppendFragment(
-            *frag, *(m_pscommon_2->getSectionData()), (*com_sym)->value());
-        (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-        continue;
-      case 4:
-        if (maxGPSize <= 3)
-          break;
-        ObjectBuilder::AppendFragment(
-            *frag, *(m_pscommon_4->getSectionData()), (*com_sym)->value());
-        (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-        continue;
-      case 8:
-        if (maxGPSize <= 7)
-          break;
-        ObjectBuilder::AppendFragment(
-            *frag, *(m_pscommon_8->getSectionData()), (*com_sym)->value());
-        (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-        continue;
-      default:
-        break;
-    }
-
-    if (ResolveInfo::ThreadLocal == (*com_sym)->type()) {
-      // allocate TLS common symbol in tbss section
-      tbss_offset += ObjectBuilder::AppendFragment(
-          *frag, *tbss_sect_data, (*com_sym)->value());
-      (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-    } else {
-      // FIXME: how to identify small and large common symbols?
-      bss_offset += ObjectBuilder::AppendFragment(
-          *frag, *bss_sect_data, (*com_sym)->value());
-      (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-    }
+  // the small common symbols nearest to GP are the most accessed ones
+  if (by_refs) {
+    std::stable_sort(small_commons.begin(), small_commons.end(),
+                     [&refs](const LDSymbol* pA, const LDSymbol* pB) {
+      return refs.lookup(pA->resolveInfo()) > refs.lookup(pB->resolveInfo());
+    });
+  }
+  std::vector<LDSymbol*>::iterator small, smallEnd = small_commons.end();
+  for (small = small_commons.begin(); small != smallEnd; ++small) {
+    Fragment* frag = new FillFragment(0x0, 1, (*small)->size());
+    ObjectBuilder::AppendFragment(
+        *frag, *getSmallCommonSection((*small)->size())->getSectionData(),
+        (*small)->value());
+    (*small)->setFragmentRef(FragmentRef::Create(*frag, 0));
   }
 
   bss_sect.setSize(bss_offset);
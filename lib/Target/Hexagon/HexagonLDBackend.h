@@ -78,6 +78,9 @@ class HexagonLDBackend : public GNULDBackend {
   uint64_t emitSectionData(const LDSection& pSection,
                            MemoryRegion& pRegion) const;
 
+  /// fillCodePadding - fill the padding with packets of nops
+  bool fillCodePadding(uint8_t* pData, uint64_t pAddress, size_t pSize) const;
+
   /// initRelocator - create and initialize Relocator.
   bool initRelocator();
 
@@ -136,6 +139,10 @@ class HexagonLDBackend : public GNULDBackend {
 
   bool SetSDataSection();
 
+  /// getSmallCommonSection - the .scommon section of the common symbols of
+  /// pSize bytes, or NULL if they do not go into .sdata
+  LDSection* getSmallCommonSection(uint64_t pSize) const;
+
   uint32_t getGP() { return m_psdata->addr(); }
 
   Relocation::Type getCopyRelType() const { return m_CopyRel; }
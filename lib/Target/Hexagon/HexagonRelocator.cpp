@@ -18,6 +18,8 @@
 #include <llvm/Support/DataTypes.h>
 #include <llvm/Support/ELF.h>
 
+#include <vector>
+
 namespace mcld {
 
 //===--------------------------------------------------------------------===//
@@ -138,18 +140,53 @@ struct ApplyFunctionTriple {
 static const ApplyFunctionTriple ApplyFunctions[] = {
     DECL_HEXAGON_APPLY_RELOC_FUNC_PTRS};
 
-static uint32_t findBitMask(uint32_t insn,
-                            Instruction* encodings,
-                            int32_t numInsns) {
-  for (int32_t i = 0; i < numInsns; ++i) {
-    if (((insn & 0xc000) == 0) && !(encodings[i].isDuplex))
-      continue;
+/** \class EncodingIndex
+ *  \brief EncodingIndex groups the instruction encodings by the parse kind
+ *  and the instruction class (the bits 31:28) which they may match.
+ *
+ *  An encoding which does not fix all the class bits is in every group it may
+ *  match. Each group keeps the order of insn_encodings, so the first match in
+ *  a group is the first match in the whole table.
+ */
+class EncodingIndex {
+ public:
+  EncodingIndex(const Instruction* pEncodings, size_t pNumInsns);
+
+  /// findBitMask - the bit-scatter mask of the first encoding matching pInsn
+  uint32_t findBitMask(uint32_t pInsn) const;
+
+ private:
+  static const unsigned kClassShift = 28;
+  static const unsigned kNumClasses = 16;
+
+  static size_t group(bool pIsDuplex, unsigned pClass) {
+    return (pIsDuplex ? kNumClasses : 0) + pClass;
+  }
+
+ private:
+  std::vector<const Instruction*> m_Groups[2 * kNumClasses];
+};
 
-    if (((insn & 0xc000) != 0) && (encodings[i].isDuplex))
-      continue;
+EncodingIndex::EncodingIndex(const Instruction* pEncodings, size_t pNumInsns) {
+  for (size_t i = 0; i < pNumInsns; ++i) {
+    const Instruction& encoding = pEncodings[i];
+    uint32_t class_mask = encoding.insnMask >> kClassShift;
+    uint32_t class_cmp = (encoding.insnCmpMask >> kClassShift) & class_mask;
+    for (unsigned c = 0; c < kNumClasses; ++c) {
+      if ((c & class_mask) == class_cmp)
+        m_Groups[group(encoding.isDuplex, c)].push_back(&encoding);
+    }
+  }
+}
 
-    if (((encodings[i].insnMask) & insn) == encodings[i].insnCmpMask)
-      return encodings[i].insnBitMask;
+uint32_t EncodingIndex::findBitMask(uint32_t pInsn) const {
+  // the parse bits of a duplex are zero
+  const std::vector<const Instruction*>& encodings =
+      m_Groups[group((pInsn & 0xc000) == 0, pInsn >> kClassShift)];
+  std::vector<const Instruction*>::const_iterator it, end = encodings.end();
+  for (it = encodings.begin(); it != end; ++it) {
+    if (((*it)->insnMask & pInsn) == (*it)->insnCmpMask)
+      return (*it)->insnBitMask;
   }
   assert(0);
   // Should not be here, but add a return for -Werror=return-type
@@ -157,10 +194,11 @@ static uint32_t findBitMask(uint32_t insn,
   return -1;
 }
 
-#define FINDBITMASK(INSN)     \
-  findBitMask((uint32_t)INSN, \
-              insn_encodings, \
-              sizeof(insn_encodings) / sizeof(Instruction))
+// index the instruction encodings once
+static const EncodingIndex Encodings(
+    insn_encodings, sizeof(insn_encodings) / sizeof(Instruction));
+
+#define FINDBITMASK(INSN) Encodings.findBitMask((uint32_t)INSN)
 
 //===--------------------------------------------------------------------===//
 // HexagonRelocator
@@ -230,6 +268,7 @@ void HexagonRelocator::addCopyReloc(ResolveInfo& pSym,
   assert(pSym.outSymbol()->hasFragRef());
   rel_entry.targetRef().assign(*pSym.outSymbol()->fragRef());
   rel_entry.setSymInfo(&pSym);
+  pTarget.noteCopyReloc(pSym);
 }
 
 void HexagonRelocator::scanLocalReloc(Relocation& pReloc,
@@ -23,6 +23,18 @@ const uint64_t Mips64ModulePtr = 1ull << 63;
 const size_t MipsGOT0Num = 2;
 const size_t MipsGOTGpOffset = 0x7FF0;
 const size_t MipsGOTSize = MipsGOTGpOffset + 0x7FFF;
+
+typedef llvm::DenseMapInfo<const mcld::ResolveInfo*> SymbolInfo;
+
+/// hashEntry - mix the symbol, the addend and a small tag of a GOT entry
+unsigned hashEntry(const mcld::ResolveInfo* pInfo,
+                   uint64_t pAddend,
+                   uint64_t pTag) {
+  uint64_t hash = SymbolInfo::getHashValue(pInfo);
+  hash = hash * 37 + llvm::DenseMapInfo<uint64_t>::getHashValue(pAddend);
+  hash = hash * 37 + pTag;
+  return static_cast<unsigned>(hash ^ (hash >> 32));
+}
 }
 
 namespace mcld {
@@ -77,14 +89,57 @@ MipsGOT::LocalEntry::LocalEntry(const ResolveInfo* pInfo,
     : m_pInfo(pInfo), m_Addend(addend), m_IsGot16(isGot16) {
 }
 
-bool MipsGOT::LocalEntry::operator<(const LocalEntry& O) const {
-  if (m_pInfo != O.m_pInfo)
-    return m_pInfo < O.m_pInfo;
+bool MipsGOT::LocalEntry::operator==(const LocalEntry& O) const {
+  return m_pInfo == O.m_pInfo && m_Addend == O.m_Addend &&
+         m_IsGot16 == O.m_IsGot16;
+}
 
-  if (m_Addend != O.m_Addend)
-    return m_Addend < O.m_Addend;
+//===----------------------------------------------------------------------===//
+// MipsGOT::LocalEntryInfo
+//===----------------------------------------------------------------------===//
+MipsGOT::LocalEntry MipsGOT::LocalEntryInfo::getEmptyKey() {
+  return LocalEntry(SymbolInfo::getEmptyKey(), 0, false);
+}
+
+MipsGOT::LocalEntry MipsGOT::LocalEntryInfo::getTombstoneKey() {
+  return LocalEntry(SymbolInfo::getTombstoneKey(), 0, false);
+}
+
+unsigned MipsGOT::LocalEntryInfo::getHashValue(const LocalEntry& pEntry) {
+  return hashEntry(pEntry.m_pInfo, pEntry.m_Addend, pEntry.m_IsGot16);
+}
+
+bool MipsGOT::LocalEntryInfo::isEqual(const LocalEntry& pX,
+                                      const LocalEntry& pY) {
+  return pX == pY;
+}
+
+//===----------------------------------------------------------------------===//
+// MipsGOT::GotEntryKeyInfo
+//===----------------------------------------------------------------------===//
+MipsGOT::GotEntryKey MipsGOT::GotEntryKeyInfo::getEmptyKey() {
+  GotEntryKey key;
+  key.m_GOTPage = 0;
+  key.m_pInfo = SymbolInfo::getEmptyKey();
+  key.m_Addend = 0;
+  return key;
+}
+
+MipsGOT::GotEntryKey MipsGOT::GotEntryKeyInfo::getTombstoneKey() {
+  GotEntryKey key;
+  key.m_GOTPage = 0;
+  key.m_pInfo = SymbolInfo::getTombstoneKey();
+  key.m_Addend = 0;
+  return key;
+}
+
+unsigned MipsGOT::GotEntryKeyInfo::getHashValue(const GotEntryKey& pKey) {
+  return hashEntry(pKey.m_pInfo, pKey.m_Addend, pKey.m_GOTPage);
+}
 
-  return m_IsGot16 < O.m_IsGot16;
+bool MipsGOT::GotEntryKeyInfo::isEqual(const GotEntryKey& pX,
+                                       const GotEntryKey& pY) {
+  return pX == pY;
 }
 
 //===----------------------------------------------------------------------===//
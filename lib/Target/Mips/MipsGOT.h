@@ -16,8 +16,6 @@
 #include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/DenseSet.h>
 
-#include <map>
-#include <set>
 #include <vector>
 
 namespace mcld {
@@ -143,7 +141,17 @@ class MipsGOT : public GOT {
                Relocation::DWord addend,
                bool isGot16);
 
-    bool operator<(const LocalEntry& O) const;
+    bool operator==(const LocalEntry& O) const;
+  };
+
+  /** \class LocalEntryInfo
+   *  \brief LocalEntryInfo hashes LocalEntry for the DenseSet.
+   */
+  struct LocalEntryInfo {
+    static LocalEntry getEmptyKey();
+    static LocalEntry getTombstoneKey();
+    static unsigned getHashValue(const LocalEntry& pEntry);
+    static bool isEqual(const LocalEntry& pX, const LocalEntry& pY);
   };
 
   typedef std::vector<GOTMultipart> MultipartListType;
@@ -156,7 +164,7 @@ class MipsGOT : public GOT {
   typedef llvm::DenseMap<const ResolveInfo*, bool> SymbolUniqueMapType;
 
   // Set of local symbols.
-  typedef std::set<LocalEntry> LocalSymbolSetType;
+  typedef llvm::DenseSet<LocalEntry, LocalEntryInfo> LocalSymbolSetType;
 
   MultipartListType m_MultipartList;  ///< list of GOT's descriptors
   const Input* m_pInput;              ///< current input
@@ -196,18 +204,24 @@ class MipsGOT : public GOT {
     const ResolveInfo* m_pInfo;
     Relocation::DWord m_Addend;
 
-    bool operator<(const GotEntryKey& key) const {
-      if (m_GOTPage != key.m_GOTPage)
-        return m_GOTPage < key.m_GOTPage;
-
-      if (m_pInfo != key.m_pInfo)
-        return m_pInfo < key.m_pInfo;
-
-      return m_Addend < key.m_Addend;
+    bool operator==(const GotEntryKey& key) const {
+      return m_GOTPage == key.m_GOTPage && m_pInfo == key.m_pInfo &&
+             m_Addend == key.m_Addend;
     }
   };
 
-  typedef std::map<GotEntryKey, Fragment*> GotEntryMapType;
+  /** \class GotEntryKeyInfo
+   *  \brief GotEntryKeyInfo hashes GotEntryKey for the DenseMap.
+   */
+  struct GotEntryKeyInfo {
+    static GotEntryKey getEmptyKey();
+    static GotEntryKey getTombstoneKey();
+    static unsigned getHashValue(const GotEntryKey& pKey);
+    static bool isEqual(const GotEntryKey& pX, const GotEntryKey& pY);
+  };
+
+  typedef llvm::DenseMap<GotEntryKey, Fragment*, GotEntryKeyInfo>
+      GotEntryMapType;
   GotEntryMapType m_GotLocalEntriesMap;
   GotEntryMapType m_GotGlobalEntriesMap;
   GotEntryMapType m_GotTLSGdEntriesMap;
@@ -67,6 +67,11 @@ bool MipsLA25Stub::isMyDuty(const Relocation& pReloc,
   return true;
 }
 
+bool MipsLA25Stub::getDutyTypes(std::vector<Type>& pTypes) const {
+  pTypes.push_back(llvm::ELF::R_MIPS_26);
+  return true;
+}
+
 const std::string& MipsLA25Stub::name() const {
   return m_Name;
 }
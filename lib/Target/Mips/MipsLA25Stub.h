@@ -32,6 +32,8 @@ class MipsLA25Stub : public Stub {
   bool isMyDuty(const Relocation& pReloc,
                 uint64_t pSource,
                 uint64_t pTargetSymValue) const;
+
+  bool getDutyTypes(std::vector<Type>& pTypes) const;
   const std::string& name() const;
   const uint8_t* getContent() const;
   size_t size() const;
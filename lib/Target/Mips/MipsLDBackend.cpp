@@ -18,6 +18,7 @@
 #include "mcld/Module.h"
 #include "mcld/Fragment/AlignFragment.h"
 #include "mcld/Fragment/FillFragment.h"
+#include "mcld/Fragment/RegionFragment.h"
 #include "mcld/LD/BranchIslandFactory.h"
 #include "mcld/LD/LDContext.h"
 #include "mcld/LD/StubFactory.h"
@@ -30,8 +31,10 @@
 #include "mcld/Support/MemoryArea.h"
 #include "mcld/Support/MsgHandling.h"
 #include "mcld/Support/TargetRegistry.h"
+#include "mcld/Support/ThreadPool.h"
 #include "mcld/Target/OutputRelocSection.h"
 
+#include <llvm/ADT/StringSet.h>
 #include <llvm/ADT/Triple.h>
 #include <llvm/Object/ELFTypes.h>
 #include <llvm/Support/Casting.h>
@@ -39,6 +42,8 @@
 #include <llvm/Support/Host.h>
 #include <llvm/Support/MipsABIFlags.h>
 
+#include <algorithm>
+#include <string>
 #include <vector>
 
 namespace mcld {
@@ -579,98 +584,7 @@ bool MipsGNULDBackend::finalizeTargetSymbols() {
 /// sections. This is called at pre-layout stage.
 /// FIXME: Mips needs to allocate small common symbol
 bool MipsGNULDBackend::allocateCommonSymbols(Module& pModule) {
-  SymbolCategory& symbol_list = pModule.getSymbolTable();
-
-  if (symbol_list.emptyCommons() && symbol_list.emptyFiles() &&
-      symbol_list.emptyLocals() && symbol_list.emptyLocalDyns())
-    return true;
-
-  SymbolCategory::iterator com_sym, com_end;
-
-  // FIXME: If the order of common symbols is defined, then sort common symbols
-  // std::sort(com_sym, com_end, some kind of order);
-
-  // get corresponding BSS LDSection
-  ELFFileFormat* file_format = getOutputFormat();
-  LDSection& bss_sect = file_format->getBSS();
-  LDSection& tbss_sect = file_format->getTBSS();
-
-  // get or create corresponding BSS SectionData
-  SectionData* bss_sect_data = NULL;
-  if (bss_sect.hasSectionData())
-    bss_sect_data = bss_sect.getSectionData();
-  else
-    bss_sect_data = IRBuilder::CreateSectionData(bss_sect);
-
-  SectionData* tbss_sect_data = NULL;
-  if (tbss_sect.hasSectionData())
-    tbss_sect_data = tbss_sect.getSectionData();
-  else
-    tbss_sect_data = IRBuilder::CreateSectionData(tbss_sect);
-
-  // remember original BSS size
-  uint64_t bss_offset = bss_sect.size();
-  uint64_t tbss_offset = tbss_sect.size();
-
-  // allocate all local common symbols
-  com_end = symbol_list.localEnd();
-
-  for (com_sym = symbol_list.localBegin(); com_sym != com_end; ++com_sym) {
-    if (ResolveInfo::Common == (*com_sym)->desc()) {
-      // We have to reset the description of the symbol here. When doing
-      // incremental linking, the output relocatable object may have common
-      // symbols. Therefore, we can not treat common symbols as normal symbols
-      // when emitting the regular name pools. We must change the symbols'
-      // description here.
-      (*com_sym)->resolveInfo()->setDesc(ResolveInfo::Define);
-      Fragment* frag = new FillFragment(0x0, 1, (*com_sym)->size());
-
-      if (ResolveInfo::ThreadLocal == (*com_sym)->type()) {
-        // allocate TLS common symbol in tbss section
-        tbss_offset += ObjectBuilder::AppendFragment(
-            *frag, *tbss_sect_data, (*com_sym)->value());
-        ObjectBuilder::UpdateSectionAlign(tbss_sect, (*com_sym)->value());
-        (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-      } else {
-        // FIXME: how to identify small and large common symbols?
-        bss_offset += ObjectBuilder::AppendFragment(
-            *frag, *bss_sect_data, (*com_sym)->value());
-        ObjectBuilder::UpdateSectionAlign(bss_sect, (*com_sym)->value());
-        (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-      }
-    }
-  }
-
-  // allocate all global common symbols
-  com_end = symbol_list.commonEnd();
-  for (com_sym = symbol_list.commonBegin(); com_sym != com_end; ++com_sym) {
-    // We have to reset the description of the symbol here. When doing
-    // incremental linking, the output relocatable object may have common
-    // symbols. Therefore, we can not treat common symbols as normal symbols
-    // when emitting the regular name pools. We must change the symbols'
-    // description here.
-    (*com_sym)->resolveInfo()->setDesc(ResolveInfo::Define);
-    Fragment* frag = new FillFragment(0x0, 1, (*com_sym)->size());
-
-    if (ResolveInfo::ThreadLocal == (*com_sym)->type()) {
-      // allocate TLS common symbol in tbss section
-      tbss_offset += ObjectBuilder::AppendFragment(
-          *frag, *tbss_sect_data, (*com_sym)->value());
-      ObjectBuilder::UpdateSectionAlign(tbss_sect, (*com_sym)->value());
-      (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-    } else {
-      // FIXME: how to identify small and large common symbols?
-      bss_offset += ObjectBuilder::AppendFragment(
-          *frag, *bss_sect_data, (*com_sym)->value());
-      ObjectBuilder::UpdateSectionAlign(bss_sect, (*com_sym)->value());
-      (*com_sym)->setFragmentRef(FragmentRef::Create(*frag, 0));
-    }
-  }
-
-  bss_sect.setSize(bss_offset);
-  tbss_sect.setSize(tbss_offset);
-  symbol_list.changeCommonsToGlobal();
-  return true;
+  return GNULDBackend::allocateCommonSymbols(pModule);
 }
 
 uint64_t MipsGNULDBackend::getTPOffset(const Input& pInput) const {
@@ -763,31 +677,55 @@ void MipsGNULDBackend::doCreateProgramHdrs(Module& pModule) {
   abiSeg->append(m_pAbiFlags);
 }
 
-bool MipsGNULDBackend::relaxRelocation(IRBuilder& pBuilder, Relocation& pRel) {
-  uint64_t sym_value = 0x0;
+namespace {
 
-  LDSymbol* symbol = pRel.symInfo()->outSymbol();
-  if (symbol->hasFragRef()) {
-    uint64_t value = symbol->fragRef()->getOutputOffset();
-    uint64_t addr = symbol->fragRef()->frag()->getParent()->getSection().addr();
-    sym_value = addr + value;
-  }
+/// isInRegionOf - j only replaces the low 28 bits of the address of its
+/// delay slot, so it reaches the stubs in the 256MB region of pReloc
+bool isInRegionOf(const Stub& pStub, const Relocation& pReloc) {
+  uint64_t stub = pStub.getParent()->getSection().addr() + pStub.getOffset();
+  return ((stub ^ (pReloc.place() + 4)) >> 28) == 0x0;
+}
 
-  Stub* stub = getStubFactory()->create(
-      pRel, sym_value, pBuilder, *getBRIslandFactory());
+}  // anonymous namespace
 
-  if (stub == NULL)
-    return false;
+bool MipsGNULDBackend::relaxRelocation(IRBuilder& pBuilder,
+                                       Relocation& pRel,
+                                       Stub& pPrototype) {
+  // The stubs of a symbol are indexed by the symbol, so a branch to a symbol
+  // which has a stub in its region does not probe the islands. The stubs
+  // ignore the addends of the branches, and so does the index.
+  LA25StubList& stubs = m_LA25Stubs[pRel.symInfo()];
+  Stub* stub = NULL;
+  LA25StubList::iterator it, ie = stubs.end();
+  for (it = stubs.begin(); it != ie; ++it) {
+    if (isInRegionOf(**it, pRel)) {
+      stub = *it;
+      break;
+    }
+  }
+
+  bool is_new = false;
+  if (stub == NULL) {
+    stub = getStubFactory()->create(
+        pRel, pPrototype, pBuilder, *getBRIslandFactory());
+    if (stub == NULL)
+      return false;
+    is_new = (std::find(stubs.begin(), stubs.end(), stub) == stubs.end());
+    if (is_new)
+      stubs.push_back(stub);
+  }
 
   assert(stub->symInfo() != NULL);
   // reset the branch target of the reloc to this stub instead
   pRel.setSymInfo(stub->symInfo());
 
-  // increase the size of .symtab and .strtab
-  LDSection& symtab = getOutputFormat()->getSymTab();
-  LDSection& strtab = getOutputFormat()->getStrTab();
-  symtab.setSize(symtab.size() + sizeof(llvm::ELF::Elf32_Sym));
-  strtab.setSize(strtab.size() + stub->symInfo()->nameSize() + 1);
+  // increase the size of .symtab and .strtab once for each stub
+  if (is_new) {
+    LDSection& symtab = getOutputFormat()->getSymTab();
+    LDSection& strtab = getOutputFormat()->getStrTab();
+    symtab.setSize(symtab.size() + sizeof(llvm::ELF::Elf32_Sym));
+    strtab.setSize(strtab.size() + stub->symInfo()->nameSize() + 1);
+  }
 
   return true;
 }
@@ -799,32 +737,33 @@ bool MipsGNULDBackend::doRelax(Module& pModule,
 
   bool isRelaxed = false;
 
-  for (Module::obj_iterator input = pModule.obj_begin();
-       input != pModule.obj_end();
-       ++input) {
-    LDContext* context = (*input)->context();
-
-    for (LDContext::sect_iterator rs = context->relocSectBegin();
-         rs != context->relocSectEnd();
-         ++rs) {
-      LDSection* sec = *rs;
-
-      if (LDFileFormat::Ignore == sec->kind() || !sec->hasRelocData())
-        continue;
-
-      for (RelocData::iterator reloc = sec->getRelocData()->begin();
-           reloc != sec->getRelocData()->end();
-           ++reloc) {
-        if (llvm::ELF::R_MIPS_26 != reloc->type())
-          continue;
+  // find the R_MIPS_26 relocs which need stubs
+  StubFactory::CandidateList candidates;
+  StubFactory::BranchTarget target = [](const Relocation& pReloc,
+                                        uint64_t& pTarget) {
+    if (llvm::ELF::R_MIPS_26 != pReloc.type())
+      return false;
 
-        if (relaxRelocation(pBuilder, *llvm::cast<Relocation>(reloc)))
-          isRelaxed = true;
-      }
+    pTarget = 0x0;
+    const LDSymbol* symbol = pReloc.symInfo()->outSymbol();
+    if (symbol->hasFragRef()) {
+      uint64_t value = symbol->fragRef()->getOutputOffset();
+      uint64_t addr =
+          symbol->fragRef()->frag()->getParent()->getSection().addr();
+      pTarget = addr + value;
     }
+    return true;
+  };
+  ThreadPool pool(config().options().numThreads());
+  getStubFactory()->findStubs(pModule, target, pool, candidates);
+
+  StubFactory::CandidateList::iterator cand, candEnd = candidates.end();
+  for (cand = candidates.begin(); cand != candEnd; ++cand) {
+    if (relaxRelocation(pBuilder, *cand->reloc, *cand->prototype))
+      isRelaxed = true;
   }
 
-  // find the first fragment w/ invalid offset due to stub insertion
+  // find the fragments w/ invalid offset due to stub insertion
   std::vector<Fragment*> invalid_frags;
   pFinished = true;
   for (BranchIslandFactory::iterator ii = getBRIslandFactory()->begin(),
@@ -847,11 +786,8 @@ bool MipsGNULDBackend::doRelax(Module& pModule,
     }
 
     if ((island.offset() + island.size()) > exit->getOffset()) {
-      if (invalid_frags.empty() ||
-          (invalid_frags.back()->getParent() != island.getParent())) {
-        invalid_frags.push_back(exit);
-        pFinished = false;
-      }
+      invalid_frags.push_back(exit);
+      pFinished = false;
       continue;
     }
   }
@@ -859,12 +795,7 @@ bool MipsGNULDBackend::doRelax(Module& pModule,
   // reset the offset of invalid fragments
   for (auto it = invalid_frags.begin(), ie = invalid_frags.end(); it != ie;
        ++it) {
-    Fragment* invalid = *it;
-    while (invalid != NULL) {
-      invalid->setOffset(invalid->getPrevNode()->getOffset() +
-                         invalid->getPrevNode()->size());
-      invalid = invalid->getNextNode();
-    }
+    (*it)->getParent()->updateOffsets(**it);
   }
 
   // reset the size of section that has stubs inserted.
@@ -1061,6 +992,23 @@ static bool getAbiFlags(const Input& pInput, uint64_t elfFlags, bool& hasFlags,
   return true;
 }
 
+/// getFlagsKey - the e_flags and the .MIPS.abiflags content of pInput. The
+/// inputs of the same key have the same flags to merge.
+static std::string getFlagsKey(const Input& pInput, uint64_t elfFlags) {
+  std::string key(reinterpret_cast<const char*>(&elfFlags), sizeof(elfFlags));
+
+  const LDContext* ctx = pInput.context();
+  for (auto it = ctx->sectBegin(), ie = ctx->sectEnd(); it != ie; ++it)
+    if ((*it)->type() == llvm::ELF::SHT_MIPS_ABIFLAGS) {
+      const SectionData* secData = (*it)->getSectionData();
+      if (secData != NULL && !secData->empty() &&
+          llvm::isa<RegionFragment>(secData->front()))
+        key += llvm::cast<RegionFragment>(secData->front()).getRegion();
+      break;
+    }
+  return key;
+}
+
 static const char* getNanName(uint64_t flags) {
   return flags & llvm::ELF::EF_MIPS_NAN2008 ? "2008" : "legacy";
 }
@@ -1164,12 +1112,21 @@ void MipsGNULDBackend::preMergeSections(Module& pModule) {
   uint64_t elfFlags = 0;
   bool hasAbiFlags = false;
   MipsAbiFlags abiFlags = {};
+  // Most inputs have the same flags. Merging the flags is a join, so merge
+  // and validate each distinct e_flags and .MIPS.abiflags only once.
+  llvm::StringSet<> mergedKeys;
   for (const Input *input : pModule.getObjectList()) {
     if (input->type() != Input::Object)
       continue;
 
     uint64_t newElfFlags = m_ElfFlagsMap[input];
 
+    std::string key = getFlagsKey(*input, newElfFlags);
+    if (mergedKeys.count(key)) {
+      saveTPOffset(*input);
+      continue;
+    }
+
     MipsAbiFlags newAbiFlags = {};
     if (!getAbiFlags(*input, newElfFlags, hasAbiFlags, newAbiFlags))
       continue;
@@ -1180,6 +1137,7 @@ void MipsGNULDBackend::preMergeSections(Module& pModule) {
     if (!MipsAbiFlags::merge(*input, abiFlags, newAbiFlags))
       continue;
 
+    mergedKeys.insert(key);
     saveTPOffset(*input);
   }
 
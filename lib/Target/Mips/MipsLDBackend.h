@@ -23,6 +23,7 @@ class MemoryArea;
 class MipsGNUInfo;
 class OutputRelocSection;
 class SectionMap;
+class Stub;
 
 /** \class MipsGNULDBackend
  *  \brief Base linker backend of Mips target of GNU ELF format.
@@ -141,14 +142,9 @@ class MipsGNULDBackend : public GNULDBackend {
   void defineGOTSymbol(IRBuilder& pBuilder);
   void defineGOTPLTSymbol(IRBuilder& pBuilder);
 
-  bool relaxRelocation(IRBuilder& pBuilder, Relocation& pRel);
-
-  /// emitSymbol32 - emit an ELF32 symbol, override parent's function
-  void emitSymbol32(llvm::ELF::Elf32_Sym& pSym32,
-                    LDSymbol& pSymbol,
-                    char* pStrtab,
-                    size_t pStrtabsize,
-                    size_t pSymtabIdx);
+  bool relaxRelocation(IRBuilder& pBuilder,
+                       Relocation& pRel,
+                       Stub& pPrototype);
 
   /// doCreateProgramHdrs - backend can implement this function to create the
   /// target-dependent segments
@@ -231,6 +227,8 @@ class MipsGNULDBackend : public GNULDBackend {
   typedef llvm::DenseSet<const ResolveInfo*> ResolveInfoSetType;
   typedef llvm::DenseMap<const Input*, llvm::ELF::Elf64_Addr> InputNumMapType;
   typedef llvm::DenseMap<const Input*, uint64_t> ElfFlagsMapType;
+  typedef std::vector<Stub*> LA25StubList;
+  typedef llvm::DenseMap<const ResolveInfo*, LA25StubList> LA25StubMapType;
 
  protected:
   Relocator* m_pRelocator;
@@ -258,6 +256,9 @@ class MipsGNULDBackend : public GNULDBackend {
   InputNumMapType m_TpOffsetMap;
   InputNumMapType m_DtpOffsetMap;
   ElfFlagsMapType m_ElfFlagsMap;
+  /// m_LA25Stubs - the LA25 stubs of each symbol, one for each region of the
+  /// branches to it
+  LA25StubMapType m_LA25Stubs;
 
   void moveSectionData(SectionData& pFrom, SectionData& pTo);
   void saveTPOffset(const Input& pInput);
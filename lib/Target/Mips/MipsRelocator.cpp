@@ -479,6 +479,7 @@ void MipsRelocator::addCopyReloc(ResolveInfo& pSym) {
   assert(pSym.outSymbol()->hasFragRef());
   relEntry.targetRef().assign(*pSym.outSymbol()->fragRef());
   relEntry.setSymInfo(&pSym);
+  getTarget().noteCopyReloc(pSym);
 }
 
 LDSymbol& MipsRelocator::defineSymbolforCopyReloc(IRBuilder& pBuilder,
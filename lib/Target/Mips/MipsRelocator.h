@@ -63,6 +63,15 @@ class MipsRelocator : public Relocator {
   /// @return - return true for finalization success
   bool finalizeApply(Input& pInput);
 
+  /// mayApplyInParallel - Mips keeps the applying input and the postponed
+  /// HI16/GOT16 relocations between initializeApply() and finalizeApply(),
+  /// and creates GOT entries while applying.
+  bool mayApplyInParallel() const { return false; }
+
+  /// mayReorderRelocations - a HI16 or GOT16 relocation is paired with the
+  /// LO16 relocation which follows it in the input.
+  bool mayReorderRelocations() const { return false; }
+
   Result applyRelocation(Relocation& pReloc);
 
   /// getDebugStringOffset - get the offset from the relocation target. This is
@@ -0,0 +1,334 @@
+//===- OutputPackedRelocSection.cpp ---------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Target/OutputPackedRelocSection.h"
+
+#include "mcld/LinkerConfig.h"
+#include "mcld/Fragment/Fragment.h"
+#include "mcld/Fragment/FragmentRef.h"
+#include "mcld/Fragment/Relocation.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/LD/RelocData.h"
+#include "mcld/LD/ResolveInfo.h"
+#include "mcld/LD/SectionData.h"
+#include "mcld/Support/ELF.h"
+#include "mcld/Support/LEB128.h"
+#include "mcld/Target/GNULDBackend.h"
+
+#include <llvm/ADT/Twine.h>
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/ErrorHandling.h>
+
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+namespace mcld {
+
+namespace {
+
+/// The group flags of the APS2 format
+enum {
+  RELOCATION_GROUPED_BY_INFO_FLAG = 0x1,
+  RELOCATION_GROUPED_BY_OFFSET_DELTA_FLAG = 0x2,
+  RELOCATION_GROUPED_BY_ADDEND_FLAG = 0x4,
+  RELOCATION_GROUP_HAS_ADDEND_FLAG = 0x8
+};
+
+/// The shortest run of evenly spaced places that is grouped by offset delta
+const size_t kMinDeltaRun = 3;
+
+size_t slebSize(int64_t pValue) {
+  return leb128::size<int64_t>(pValue);
+}
+
+void appendSLEB(std::vector<uint8_t>& pBytes, int64_t pValue) {
+  leb128::ByteType buffer[16];
+  leb128::ByteType* out = buffer;
+  size_t size = leb128::encode<int64_t>(out, pValue);
+  pBytes.insert(pBytes.end(), buffer, buffer + size);
+}
+
+bool hasSameInfo(const Relocation& pX, const Relocation& pY) {
+  return (pX.type() == pY.type()) && (pX.symInfo() == pY.symInfo());
+}
+
+/// PackedEntry - a relocation and its place. The section is NULL if the place
+/// may still move in its output section.
+struct PackedEntry {
+  const Relocation* reloc;
+  const LDSection* section;
+  uint64_t offset;
+};
+
+/// PackedGroup - the entries encoded together. The flags only tell how the
+/// entries are grouped, the addend flags are chosen when the addends are known.
+struct PackedGroup {
+  size_t begin;
+  size_t size;
+  uint64_t flags;
+};
+
+typedef std::vector<PackedEntry> PackedEntries;
+
+/// hasStride - check if the distance from the place of the previous entry to
+/// the place of pEntries[pIdx] is known before layout
+bool hasStride(const PackedEntries& pEntries, size_t pIdx) {
+  return (pIdx > 0) && (pEntries[pIdx].section != NULL) &&
+         (pEntries[pIdx].section == pEntries[pIdx - 1].section);
+}
+
+int64_t stride(const PackedEntries& pEntries, size_t pIdx) {
+  return pEntries[pIdx].offset - pEntries[pIdx - 1].offset;
+}
+
+/// deltaRun - the number of entries from pIdx with the same info and evenly
+/// spaced places, or zero if the place of pIdx is not at a known distance
+size_t deltaRun(const PackedEntries& pEntries, size_t pIdx) {
+  if (!hasStride(pEntries, pIdx))
+    return 0;
+  size_t num = 1;
+  while ((pIdx + num < pEntries.size()) &&
+         hasStride(pEntries, pIdx + num) &&
+         (stride(pEntries, pIdx + num) == stride(pEntries, pIdx)) &&
+         hasSameInfo(*pEntries[pIdx + num].reloc, *pEntries[pIdx].reloc))
+    ++num;
+  return num;
+}
+
+/// collectEntries - get the relocations of pRelocs in their order
+void collectEntries(const RelocData& pRelocs, PackedEntries& pEntries) {
+  pEntries.reserve(pRelocs.size());
+  RelocData::const_iterator reloc, rEnd = pRelocs.end();
+  for (reloc = pRelocs.begin(); reloc != rEnd; ++reloc) {
+    const FragmentRef& ref = reloc->targetRef();
+    const LDSection& section = ref.frag()->getParent()->getSection();
+    PackedEntry entry;
+    entry.reloc = &*reloc;
+    entry.offset = ref.getOutputOffset();
+    // Relaxation inserts stubs into the code, and .eh_frame is sized after
+    // the relocations are packed.
+    if (((section.flag() & llvm::ELF::SHF_EXECINSTR) != 0) ||
+        (section.kind() == LDFileFormat::EhFrame))
+      entry.section = NULL;
+    else
+      entry.section = &section;
+    pEntries.push_back(entry);
+  }
+}
+
+/// groupEntries - split pEntries into groups. Only the output sections and
+/// the offsets of the places are used, so the groups are the same before and
+/// after layout.
+void groupEntries(const PackedEntries& pEntries,
+                  std::vector<PackedGroup>& pGroups) {
+  size_t idx = 0, num = pEntries.size();
+  while (idx < num) {
+    PackedGroup group;
+    group.begin = idx;
+    group.size = deltaRun(pEntries, idx);
+    if (group.size >= kMinDeltaRun) {
+      group.flags = RELOCATION_GROUPED_BY_INFO_FLAG |
+                    RELOCATION_GROUPED_BY_OFFSET_DELTA_FLAG;
+    } else if ((idx + 1 < num) &&
+               hasSameInfo(*pEntries[idx + 1].reloc, *pEntries[idx].reloc)) {
+      // the relocations of a symbol, up to a run grouped by offset delta
+      group.size = 1;
+      while ((idx + group.size < num) &&
+             hasSameInfo(*pEntries[idx + group.size].reloc,
+                         *pEntries[idx].reloc) &&
+             (deltaRun(pEntries, idx + group.size) < kMinDeltaRun))
+        ++group.size;
+      group.flags = RELOCATION_GROUPED_BY_INFO_FLAG;
+    } else {
+      // the relocations that share nothing with their neighbours
+      group.size = 1;
+      while ((idx + group.size < num) &&
+             (deltaRun(pEntries, idx + group.size) < kMinDeltaRun) &&
+             !((idx + group.size + 1 < num) &&
+               hasSameInfo(*pEntries[idx + group.size + 1].reloc,
+                           *pEntries[idx + group.size].reloc)))
+        ++group.size;
+      group.flags = 0x0;
+    }
+    pGroups.push_back(group);
+    idx += group.size;
+  }
+}
+
+/// getAddress - the address of the place of pEntry
+uint64_t getAddress(const PackedEntry& pEntry) {
+  const FragmentRef& ref = pEntry.reloc->targetRef();
+  return ref.frag()->getParent()->getSection().addr() + pEntry.offset;
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// OutputPackedRelocSection
+//===----------------------------------------------------------------------===//
+OutputPackedRelocSection::OutputPackedRelocSection(
+    LDSection& pSection,
+    const LinkerConfig& pConfig,
+    const GNULDBackend& pBackend)
+    : m_Section(pSection),
+      m_Backend(pBackend),
+      m_bIs32Bits(pConfig.targets().is32Bits()),
+      m_bHasAddend(llvm::ELF::SHT_RELA == pSection.type()),
+      m_MaxFieldSize(m_bIs32Bits ? 5 : 10) {
+  assert(pSection.hasRelocData() && "Given section has no relocation");
+  m_Section.setType(m_bHasAddend ? ELF::SHT_ANDROID_RELA
+                                 : ELF::SHT_ANDROID_REL);
+}
+
+OutputPackedRelocSection::~OutputPackedRelocSection() {
+}
+
+size_t OutputPackedRelocSection::numOfRelocs() const {
+  return m_Section.getRelocData()->size();
+}
+
+void OutputPackedRelocSection::finalizeSectionSize() {
+  PackedEntries entries;
+  collectEntries(*m_Section.getRelocData(), entries);
+  std::vector<PackedGroup> groups;
+  groupEntries(entries, groups);
+
+  // "APS2", the number of relocations and the initial offset
+  size_t size = 4 + slebSize(entries.size()) + slebSize(0);
+  std::vector<PackedGroup>::const_iterator grp, gEnd = groups.end();
+  for (grp = groups.begin(); grp != gEnd; ++grp) {
+    // the flags take one byte
+    size += slebSize(grp->size) + 1;
+    if ((grp->flags & RELOCATION_GROUPED_BY_OFFSET_DELTA_FLAG) != 0)
+      size += slebSize(stride(entries, grp->begin));
+    if ((grp->flags & RELOCATION_GROUPED_BY_INFO_FLAG) != 0)
+      size += m_MaxFieldSize;
+
+    for (size_t idx = grp->begin; idx < grp->begin + grp->size; ++idx) {
+      if ((grp->flags & RELOCATION_GROUPED_BY_OFFSET_DELTA_FLAG) == 0) {
+        if (hasStride(entries, idx))
+          size += slebSize(stride(entries, idx));
+        else
+          size += m_MaxFieldSize;
+      }
+      if ((grp->flags & RELOCATION_GROUPED_BY_INFO_FLAG) == 0)
+        size += m_MaxFieldSize;
+      // an addend shared by the group takes no more than one per relocation
+      if (m_bHasAddend)
+        size += m_MaxFieldSize;
+    }
+  }
+  m_Section.setSize(size);
+}
+
+void OutputPackedRelocSection::emit(MemoryRegion& pRegion) const {
+  PackedEntries entries;
+  collectEntries(*m_Section.getRelocData(), entries);
+  std::vector<PackedGroup> groups;
+  groupEntries(entries, groups);
+
+  std::vector<uint8_t> bytes;
+  bytes.reserve(pRegion.size());
+  bytes.push_back('A');
+  bytes.push_back('P');
+  bytes.push_back('S');
+  bytes.push_back('2');
+  appendSLEB(bytes, entries.size());
+  appendSLEB(bytes, 0);
+
+  uint64_t offset = 0x0;
+  int64_t addend = 0;
+  std::vector<PackedGroup>::const_iterator grp, gEnd = groups.end();
+  for (grp = groups.begin(); grp != gEnd; ++grp) {
+    const PackedEntry& first = entries[grp->begin];
+    uint64_t flags = grp->flags;
+    if (m_bHasAddend) {
+      bool same_addend = true;
+      for (size_t idx = grp->begin + 1; idx < grp->begin + grp->size; ++idx) {
+        if (getAddend(*entries[idx].reloc) != getAddend(*first.reloc)) {
+          same_addend = false;
+          break;
+        }
+      }
+      if (!same_addend)
+        flags |= RELOCATION_GROUP_HAS_ADDEND_FLAG;
+      else if (getAddend(*first.reloc) != 0)
+        flags |= RELOCATION_GROUP_HAS_ADDEND_FLAG |
+                 RELOCATION_GROUPED_BY_ADDEND_FLAG;
+    }
+
+    appendSLEB(bytes, grp->size);
+    appendSLEB(bytes, flags);
+    if ((flags & RELOCATION_GROUPED_BY_OFFSET_DELTA_FLAG) != 0)
+      appendSLEB(bytes, stride(entries, grp->begin));
+    if ((flags & RELOCATION_GROUPED_BY_INFO_FLAG) != 0)
+      appendSLEB(bytes, getInfo(*first.reloc));
+    if ((flags & RELOCATION_GROUPED_BY_ADDEND_FLAG) != 0) {
+      appendSLEB(bytes, getAddend(*first.reloc) - addend);
+      addend = getAddend(*first.reloc);
+    } else if ((flags & RELOCATION_GROUP_HAS_ADDEND_FLAG) == 0) {
+      // the dynamic linker resets the addend for a group without addends
+      addend = 0;
+    }
+
+    for (size_t idx = grp->begin; idx < grp->begin + grp->size; ++idx) {
+      const PackedEntry& entry = entries[idx];
+      uint64_t address = getAddress(entry);
+      if ((flags & RELOCATION_GROUPED_BY_OFFSET_DELTA_FLAG) == 0) {
+        if (m_bIs32Bits)
+          appendSLEB(bytes, static_cast<int64_t>(address) -
+                                static_cast<int64_t>(offset));
+        else
+          appendSLEB(bytes, static_cast<int64_t>(address - offset));
+      }
+      offset = address;
+      if ((flags & RELOCATION_GROUPED_BY_INFO_FLAG) == 0)
+        appendSLEB(bytes, getInfo(*entry.reloc));
+      if (((flags & RELOCATION_GROUP_HAS_ADDEND_FLAG) != 0) &&
+          ((flags & RELOCATION_GROUPED_BY_ADDEND_FLAG) == 0)) {
+        appendSLEB(bytes, getAddend(*entry.reloc) - addend);
+        addend = getAddend(*entry.reloc);
+      }
+    }
+  }
+
+  if (bytes.size() > pRegion.size())
+    llvm::report_fatal_error(
+        llvm::Twine("packed relocations exceed the size of ") +
+        m_Section.name());
+
+  // the dynamic linker stops after the last relocation, so the rest of the
+  // reserved size is left as zeros
+  std::memcpy(pRegion.begin(), bytes.data(), bytes.size());
+  std::memset(pRegion.begin() + bytes.size(), 0x0,
+              pRegion.size() - bytes.size());
+}
+
+int64_t OutputPackedRelocSection::getInfo(const Relocation& pReloc) const {
+  uint32_t sym_idx = 0;
+  if (pReloc.symInfo() != NULL)
+    sym_idx = m_Backend.getSymbolIdx(pReloc.symInfo()->outSymbol());
+
+  if (m_bIs32Bits) {
+    llvm::ELF::Elf32_Rel rel;
+    m_Backend.emitRelocation(rel, pReloc.type(), sym_idx, 0x0);
+    return rel.r_info;
+  }
+  llvm::ELF::Elf64_Rel rel;
+  m_Backend.emitRelocation(rel, pReloc.type(), sym_idx, 0x0);
+  return static_cast<int64_t>(rel.r_info);
+}
+
+int64_t OutputPackedRelocSection::getAddend(const Relocation& pReloc) const {
+  if (m_bIs32Bits)
+    return static_cast<int32_t>(pReloc.addend());
+  return static_cast<int64_t>(pReloc.addend());
+}
+
+}  // namespace mcld
@@ -24,8 +24,8 @@ namespace mcld {
 OutputRelocSection::OutputRelocSection(Module& pModule, LDSection& pSection)
     : m_Module(pModule),
       m_pRelocData(NULL),
-      m_isVisit(false),
-      m_ValidEntryIterator() {
+      m_NumOfReserved(0),
+      m_Cursor(0) {
   assert(!pSection.hasRelocData() &&
          "Given section is not a relocation section");
   m_pRelocData = IRBuilder::CreateRelocData(pSection);
@@ -41,36 +41,36 @@ Relocation* OutputRelocSection::create() {
 }
 
 void OutputRelocSection::reserveEntry(size_t pNum) {
-  for (size_t i = 0; i < pNum; ++i)
-    m_pRelocData->append(*Relocation::Create());
+  m_NumOfReserved += pNum;
 }
 
 Relocation* OutputRelocSection::consumeEntry() {
-  // first time visit this function, set m_ValidEntryIterator to
-  // Fragments.begin()
-  if (!m_isVisit) {
-    assert(!m_pRelocData->getRelocationList().empty() &&
-           "DynRelSection contains no entries.");
-    m_ValidEntryIterator = m_pRelocData->begin();
-    m_isVisit = true;
-  } else {
-    // Add m_ValidEntryIterator here instead of at the end of this function.
-    // We may reserve an entry and then consume it immediately, e.g. for COPY
-    // relocation, so we need to avoid setting this iterator to
-    // RelocData->end() in any case, or when reserve and consume again,
-    // ++m_ValidEntryIterator will still be RelocData->end().
-    ++m_ValidEntryIterator;
-  }
-  assert(m_ValidEntryIterator != m_pRelocData->end() &&
+  size_t index = m_Cursor.fetch_add(1, std::memory_order_relaxed);
+
+  // An entry may be reserved and taken at once while scanning, e.g., for a
+  // COPY relocation. The entries are all created before the parallel phases.
+  if (index >= m_Reserved.size())
+    createReservedEntries();
+  assert(index < m_Reserved.size() &&
          "No empty relocation entry for the incoming symbol.");
 
-  return &(*m_ValidEntryIterator);
+  return m_Reserved[index];
 }
 
 size_t OutputRelocSection::numOfRelocs() {
+  createReservedEntries();
   return m_pRelocData->size();
 }
 
+void OutputRelocSection::createReservedEntries() {
+  m_Reserved.reserve(m_NumOfReserved);
+  while (m_Reserved.size() < m_NumOfReserved) {
+    Relocation* reloc = Relocation::Create();
+    m_pRelocData->append(*reloc);
+    m_Reserved.push_back(reloc);
+  }
+}
+
 bool OutputRelocSection::addSymbolToDynSym(LDSymbol& pSymbol) {
   m_Module.getSymbolTable().changeToDynamic(pSymbol);
   return true;
@@ -0,0 +1,186 @@
+//===- OutputRelrSection.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Target/OutputRelrSection.h"
+
+#include "mcld/IRBuilder.h"
+#include "mcld/LinkerConfig.h"
+#include "mcld/ADT/SizeTraits.h"
+#include "mcld/Fragment/Fragment.h"
+#include "mcld/Fragment/FragmentRef.h"
+#include "mcld/Fragment/Relocation.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/LD/SectionData.h"
+#include "mcld/Support/FileOutputBuffer.h"
+
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/Host.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <functional>
+
+namespace mcld {
+
+namespace {
+
+/// RelrPlace - the place of a packed relocation. The base is the address of
+/// the output section, or zero when only the offsets are known.
+struct RelrPlace {
+  uint64_t base;
+  const LDSection* section;
+  uint64_t offset;
+};
+
+/// isPlaceBefore - order the places by their output sections, then by their
+/// offsets in the sections.
+bool isPlaceBefore(const RelrPlace& pX, const RelrPlace& pY) {
+  if (pX.base != pY.base)
+    return pX.base < pY.base;
+  if (pX.section != pY.section)
+    return std::less<const LDSection*>()(pX.section, pY.section);
+  return pX.offset < pY.offset;
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// OutputRelrSection
+//===----------------------------------------------------------------------===//
+OutputRelrSection::OutputRelrSection(LDSection& pSection,
+                                     const LinkerConfig& pConfig,
+                                     bool pHasAddend)
+    : m_Config(pConfig),
+      m_pRelocData(NULL),
+      m_WordSize(pConfig.targets().bitclass() / 8),
+      m_bHasAddend(pHasAddend) {
+  assert(!pSection.hasRelocData() &&
+         "Given section is not a relocation section");
+  m_pRelocData = IRBuilder::CreateRelocData(pSection);
+}
+
+OutputRelrSection::~OutputRelrSection() {
+}
+
+bool OutputRelrSection::isPackable(const Relocation& pReloc) const {
+  const Fragment* frag = pReloc.targetRef().frag();
+  if ((frag == NULL) || (frag->getParent() == NULL))
+    return false;
+
+  // Relaxation inserts stubs into the code, and .eh_frame is sized after the
+  // relocations are packed. The places there may still move.
+  const LDSection& section = frag->getParent()->getSection();
+  if (((section.flag() & llvm::ELF::SHF_EXECINSTR) != 0) ||
+      (section.kind() == LDFileFormat::EhFrame))
+    return false;
+
+  return (section.align() >= m_WordSize) &&
+         ((pReloc.targetRef().getOutputOffset() % m_WordSize) == 0);
+}
+
+void OutputRelrSection::add(Relocation& pReloc) {
+  m_pRelocData->append(pReloc);
+}
+
+void OutputRelrSection::finalizeSectionSize() {
+  std::vector<uint64_t> entries;
+  encode(entries, false);
+  m_pRelocData->getSection().setSize(entries.size() * m_WordSize);
+}
+
+void OutputRelrSection::encode(std::vector<uint64_t>& pEntries,
+                               bool pUseAddress) const {
+  std::vector<RelrPlace> places;
+  places.reserve(m_pRelocData->size());
+  RelocData::const_iterator reloc, rEnd = m_pRelocData->end();
+  for (reloc = m_pRelocData->begin(); reloc != rEnd; ++reloc) {
+    const FragmentRef& ref = reloc->targetRef();
+    RelrPlace place;
+    place.section = &ref.frag()->getParent()->getSection();
+    place.base = pUseAddress ? place.section->addr() : 0x0;
+    place.offset = ref.getOutputOffset();
+    places.push_back(place);
+  }
+  std::sort(places.begin(), places.end(), isPlaceBefore);
+
+  // Each bitmap covers the (bits - 1) words after the previous entry.
+  const uint64_t bits = m_WordSize * 8;
+  size_t i = 0, num = places.size();
+  while (i < num) {
+    const LDSection* section = places[i].section;
+    uint64_t base = places[i].base;
+    assert((base % m_WordSize) == 0);
+    uint64_t where = base + places[i].offset;
+    pEntries.push_back(where);
+    where += m_WordSize;
+    ++i;
+
+    while (true) {
+      uint64_t bitmap = 0x0;
+      for (; (i < num) && (places[i].section == section); ++i) {
+        uint64_t place = base + places[i].offset;
+        // the same place is relocated once
+        if (place < where)
+          continue;
+        uint64_t index = (place - where) / m_WordSize;
+        if (index >= bits - 1)
+          break;
+        bitmap |= UINT64_C(1) << (index + 1);
+      }
+      if (bitmap == 0x0)
+        break;
+      pEntries.push_back(bitmap | 0x1);
+      where += (bits - 1) * m_WordSize;
+    }
+  }
+}
+
+void OutputRelrSection::emit(MemoryRegion& pRegion) const {
+  std::vector<uint64_t> entries;
+  encode(entries, true);
+  assert(entries.size() * m_WordSize == pRegion.size());
+
+  uint8_t* out = pRegion.begin();
+  std::vector<uint64_t>::const_iterator entry, entryEnd = entries.end();
+  for (entry = entries.begin(); entry != entryEnd; ++entry) {
+    write(out, *entry);
+    out += m_WordSize;
+  }
+}
+
+void OutputRelrSection::applyAddends(FileOutputBuffer& pOutput) const {
+  if (!m_bHasAddend)
+    return;
+
+  uint8_t* data = pOutput.getBufferStart();
+  RelocData::const_iterator reloc, rEnd = m_pRelocData->end();
+  for (reloc = m_pRelocData->begin(); reloc != rEnd; ++reloc) {
+    const FragmentRef& ref = reloc->targetRef();
+    uint64_t offset =
+        ref.frag()->getParent()->getSection().offset() + ref.getOutputOffset();
+    write(data + offset, reloc->addend());
+  }
+}
+
+void OutputRelrSection::write(uint8_t* pPlace, uint64_t pValue) const {
+  bool swap =
+      (llvm::sys::IsLittleEndianHost != m_Config.targets().isLittleEndian());
+  if (m_WordSize == 4) {
+    uint32_t value = static_cast<uint32_t>(pValue);
+    if (swap)
+      value = bswap32(value);
+    std::memcpy(pPlace, &value, 4);
+  } else {
+    if (swap)
+      pValue = bswap64(pValue);
+    std::memcpy(pPlace, &pValue, 8);
+  }
+}
+
+}  // namespace mcld
@@ -39,6 +39,10 @@ void X86_32GOTPLT::applyGOT0(uint64_t pAddress) {
 }
 
 void X86_32GOTPLT::applyAllGOTPLT(const X86PLT& pPLT) {
+  // the loader binds the slots of a non-lazy PLT before they are used
+  if (!pPLT.isLazy())
+    return;
+
   iterator it = begin();
   // skip GOT0
   for (size_t i = 0; i < X86GOTPLT0Num; ++i)
@@ -72,6 +76,10 @@ void X86_64GOTPLT::applyGOT0(uint64_t pAddress) {
 }
 
 void X86_64GOTPLT::applyAllGOTPLT(const X86PLT& pPLT) {
+  // the loader binds the slots of a non-lazy PLT before they are used
+  if (!pPLT.isLazy())
+    return;
+
   iterator it = begin();
   // skip GOT0
   for (size_t i = 0; i < X86GOTPLT0Num; ++i)
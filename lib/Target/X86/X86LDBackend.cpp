@@ -16,6 +16,7 @@
 #include "mcld/LinkerConfig.h"
 #include "mcld/Fragment/FillFragment.h"
 #include "mcld/Fragment/RegionFragment.h"
+#include "mcld/Fragment/Relocation.h"
 #include "mcld/LD/ELFFileFormat.h"
 #include "mcld/Object/ObjectBuilder.h"
 #include "mcld/Support/MsgHandling.h"
@@ -26,6 +27,7 @@
 #include <llvm/Support/Casting.h>
 #include <llvm/Support/Dwarf.h>
 
+#include <algorithm>
 #include <cstring>
 
 namespace mcld {
@@ -171,21 +173,15 @@ uint64_t X86GNULDBackend::emitSectionData(const LDSection& pSection,
 
     m_pPLT->applyPLT0();
     m_pPLT->applyPLT1();
-    X86PLT::iterator it = m_pPLT->begin();
-    unsigned int plt0_size = llvm::cast<PLTEntryBase>((*it)).size();
-
-    memcpy(buffer, llvm::cast<PLTEntryBase>((*it)).getValue(), plt0_size);
-    RegionSize += plt0_size;
-    ++it;
-
-    PLTEntryBase* plt1 = 0;
-    X86PLT::iterator ie = m_pPLT->end();
-    while (it != ie) {
-      plt1 = &(llvm::cast<PLTEntryBase>(*it));
-      EntrySize = plt1->size();
-      memcpy(buffer + RegionSize, plt1->getValue(), EntrySize);
+
+    // PLT0, if any, and the PLT1 entries
+    PLTEntryBase* entry = 0;
+    X86PLT::iterator it, ie = m_pPLT->end();
+    for (it = m_pPLT->begin(); it != ie; ++it) {
+      entry = &(llvm::cast<PLTEntryBase>(*it));
+      EntrySize = entry->size();
+      memcpy(buffer + RegionSize, entry->getValue(), EntrySize);
       RegionSize += EntrySize;
-      ++it;
     }
   } else if (FileFormat->hasGOT() && (&pSection == &(FileFormat->getGOT()))) {
     RegionSize += emitGOTSectionData(pRegion);
@@ -199,6 +195,31 @@ uint64_t X86GNULDBackend::emitSectionData(const LDSection& pSection,
   return RegionSize;
 }
 
+bool X86GNULDBackend::fillCodePadding(uint8_t* pData,
+                                      uint64_t pAddress,
+                                      size_t pSize) const {
+  // the nops recommended by the optimization manuals, the longest first
+  static const uint8_t nops[10][10] = {
+    {0x90},
+    {0x66, 0x90},
+    {0x0f, 0x1f, 0x00},
+    {0x0f, 0x1f, 0x40, 0x00},
+    {0x0f, 0x1f, 0x44, 0x00, 0x00},
+    {0x66, 0x0f, 0x1f, 0x44, 0x00, 0x00},
+    {0x0f, 0x1f, 0x80, 0x00, 0x00, 0x00, 0x00},
+    {0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x66, 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x66, 0x2e, 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00},
+  };
+  while (pSize != 0) {
+    size_t size = std::min(pSize, sizeof(nops[0]));
+    memcpy(pData, nops[size - 1], size);
+    pData += size;
+    pSize -= size;
+  }
+  return true;
+}
+
 X86PLT& X86GNULDBackend::getPLT() {
   assert(m_pPLT != NULL && "PLT section not exist");
   return *m_pPLT;
@@ -290,22 +311,17 @@ void X86GNULDBackend::addEhFrameForPLT(Module& pModule) {
   cie->setFDEEncode(aug_data);
   cie->setAugmentationData(std::string(1, aug_data));
 
-  EhFrame::cie_iterator i = eh_frame->cie_begin();
-  for (EhFrame::cie_iterator e = eh_frame->cie_end(); i != e; ++i) {
-    EhFrame::CIE& exist_cie = **i;
-    if (exist_cie == *cie) {
-      // Insert the FDE fragment
-      SectionData::iterator cur_iter(exist_cie);
-      frag_list.insertAfter(cur_iter, fde);
-      fde->setCIE(exist_cie);
-
-      // Cleanup the CIE we created
-      cie->clearFDEs();
-      delete cie;
-      break;
-    }
-  }
-  if (i == eh_frame->cie_end()) {
+  EhFrame::CIE* exist_cie = eh_frame->findCIE(*cie);
+  if (exist_cie != NULL) {
+    // Insert the FDE fragment
+    SectionData::iterator cur_iter(*exist_cie);
+    frag_list.insertAfter(cur_iter, fde);
+    fde->setCIE(*exist_cie);
+
+    // Cleanup the CIE we created
+    cie->clearFDEs();
+    delete cie;
+  } else {
     // Newly insert
     eh_frame->addCIE(*cie);
     eh_frame->addFDE(*fde);
@@ -411,6 +427,26 @@ llvm::StringRef X86_32GNULDBackend::createCIERegionForPLT() {
 }
 
 llvm::StringRef X86_32GNULDBackend::createFDERegionForPLT() {
+  // The entries of a non-lazy PLT only jump, so the CFA of the CIE holds
+  // through the whole PLT.
+  if (!getPLT().isLazy()) {
+    static const uint8_t nonlazy[4 + 4 + 16] = {
+        0x14, 0, 0, 0,  // length
+        0, 0, 0, 0,  // offset to CIE
+        0, 0, 0, 0,  // offset to PLT
+        0, 0, 0, 0,  // size of PLT
+        0,  // augmentation data size
+        llvm::dwarf::DW_CFA_nop,
+        llvm::dwarf::DW_CFA_nop,
+        llvm::dwarf::DW_CFA_nop,
+        llvm::dwarf::DW_CFA_nop,
+        llvm::dwarf::DW_CFA_nop,
+        llvm::dwarf::DW_CFA_nop,
+        llvm::dwarf::DW_CFA_nop
+    };
+    return llvm::StringRef((const char*)nonlazy, 4 + 4 + 16);
+  }
+
   static const uint8_t data[4 + 4 + 32] = {
       0x24, 0, 0, 0,  // length
       0, 0, 0, 0,  // offset to CIE
@@ -568,6 +604,26 @@ llvm::StringRef X86_64GNULDBackend::createCIERegionForPLT() {
 }
 
 llvm::StringRef X86_64GNULDBackend::createFDERegionForPLT() {
+  // The entries of a non-lazy PLT only jump, so the CFA of the CIE holds
+  // through the whole PLT.
+  if (!getPLT().isLazy()) {
+    static const uint8_t nonlazy[4 + 4 + 16] = {
+        0x14, 0, 0, 0,  // length
+        0, 0, 0, 0,  // ID
+        0, 0, 0, 0,  // offset to PLT
+        0, 0, 0, 0,  // size of PLT
+        0,  // augmentation data size
+        llvm::dwarf::DW_CFA_nop,
+        llvm::dwarf::DW_CFA_nop,
+        llvm::dwarf::DW_CFA_nop,
+        llvm::dwarf::DW_CFA_nop,
+        llvm::dwarf::DW_CFA_nop,
+        llvm::dwarf::DW_CFA_nop,
+        llvm::dwarf::DW_CFA_nop
+    };
+    return llvm::StringRef((const char*)nonlazy, 4 + 4 + 16);
+  }
+
   static const uint8_t data[4 + 4 + 32] = {
       0x24, 0, 0, 0,  // length
       0, 0, 0, 0,  // ID
@@ -609,6 +665,10 @@ void X86_64GNULDBackend::setRelPLTSize() {
                                     getRelaEntrySize());
 }
 
+bool X86_64GNULDBackend::isRelativeReloc(const Relocation& pReloc) const {
+  return (llvm::ELF::R_X86_64_RELATIVE == pReloc.type());
+}
+
 void X86_64GNULDBackend::initTargetSections(Module& pModule,
                                             ObjectBuilder& pBuilder) {
   if (LinkerConfig::Object != config().codeGenType()) {
@@ -72,6 +72,9 @@ class X86GNULDBackend : public GNULDBackend {
   uint64_t emitSectionData(const LDSection& pSection,
                            MemoryRegion& pRegion) const;
 
+  /// fillCodePadding - fill the padding with the multi-byte nops of 0F 1F
+  bool fillCodePadding(uint8_t* pData, uint64_t pAddress, size_t pSize) const;
+
   /// initRelocator - create and initialize Relocator.
   virtual bool initRelocator() = 0;
 
@@ -227,6 +230,9 @@ class X86_64GNULDBackend : public X86GNULDBackend {
   void setRelDynSize();
   void setRelPLTSize();
 
+  /// isRelativeReloc - check if pReloc is R_X86_64_RELATIVE
+  bool isRelativeReloc(const Relocation& pReloc) const;
+
   llvm::StringRef createCIERegionForPLT();
   llvm::StringRef createFDERegionForPLT();
 
@@ -37,6 +37,10 @@ X86_32ExecPLT1::X86_32ExecPLT1(SectionData& pParent)
     : PLT::Entry<sizeof(x86_32_exec_plt1)>(pParent) {
 }
 
+X86_32NonLazyPLT1::X86_32NonLazyPLT1(SectionData& pParent)
+    : PLT::Entry<sizeof(x86_32_exec_nonlazy_plt1)>(pParent) {
+}
+
 X86_64PLT0::X86_64PLT0(SectionData& pParent)
     : PLT::Entry<sizeof(x86_64_plt0)>(pParent) {
 }
@@ -45,16 +49,30 @@ X86_64PLT1::X86_64PLT1(SectionData& pParent)
     : PLT::Entry<sizeof(x86_64_plt1)>(pParent) {
 }
 
+X86_64NonLazyPLT1::X86_64NonLazyPLT1(SectionData& pParent)
+    : PLT::Entry<sizeof(x86_64_nonlazy_plt1)>(pParent) {
+}
+
 //===----------------------------------------------------------------------===//
 // X86PLT
 //===----------------------------------------------------------------------===//
 X86PLT::X86PLT(LDSection& pSection, const LinkerConfig& pConfig, int got_size)
-    : PLT(pSection), m_Config(pConfig) {
+    : PLT(pSection), m_bLazy(!pConfig.options().hasNow()), m_Config(pConfig) {
   assert(LinkerConfig::DynObj == m_Config.codeGenType() ||
          LinkerConfig::Exec == m_Config.codeGenType() ||
          LinkerConfig::Binary == m_Config.codeGenType());
 
-  if (got_size == 32) {
+  if (!m_bLazy) {
+    m_PLT0 = NULL;
+    m_PLT0Size = 0;
+    if (got_size == 32 && LinkerConfig::DynObj == m_Config.codeGenType())
+      m_PLT1 = x86_32_dyn_nonlazy_plt1;
+    else if (got_size == 32)
+      m_PLT1 = x86_32_exec_nonlazy_plt1;
+    else
+      m_PLT1 = x86_64_nonlazy_plt1;
+    m_PLT1Size = sizeof(x86_64_nonlazy_plt1);
+  } else if (got_size == 32) {
     if (LinkerConfig::DynObj == m_Config.codeGenType()) {
       m_PLT0 = x86_32_dyn_plt0;
       m_PLT1 = x86_32_dyn_plt1;
@@ -85,33 +103,26 @@ X86PLT::~X86PLT() {
 }
 
 void X86PLT::finalizeSectionSize() {
-  uint64_t size = 0;
-  // plt0 size
-  size = getPLT0()->size();
-
-  // get first plt1 entry
-  X86PLT::iterator it = begin();
-  ++it;
-  if (end() != it) {
-    // plt1 size
-    PLTEntryBase* plt1 = &(llvm::cast<PLTEntryBase>(*it));
-    size += (m_pSectionData->size() - 1) * plt1->size();
-  }
-  m_Section.setSize(size);
-
+  // the section is PLT0, if any, followed by the PLT1 entries
   uint32_t offset = 0;
   SectionData::iterator frag, fragEnd = m_pSectionData->end();
   for (frag = m_pSectionData->begin(); frag != fragEnd; ++frag) {
     frag->setOffset(offset);
     offset += frag->size();
   }
+  m_Section.setSize(offset);
 }
 
 bool X86PLT::hasPLT1() const {
-  return (m_pSectionData->size() > 1);
+  return (m_pSectionData->size() > (m_bLazy ? 1u : 0u));
 }
 
 PLTEntryBase* X86PLT::create() {
+  if (!m_bLazy) {
+    if (m_PLT1 == x86_64_nonlazy_plt1)
+      return new X86_64NonLazyPLT1(*m_pSectionData);
+    return new X86_32NonLazyPLT1(*m_pSectionData);
+  }
   if (LinkerConfig::DynObj == m_Config.codeGenType())
     return new X86_32DynPLT1(*m_pSectionData);
   else
@@ -119,6 +130,7 @@ PLTEntryBase* X86PLT::create() {
 }
 
 PLTEntryBase* X86PLT::getPLT0() const {
+  assert(m_bLazy && "a non-lazy PLT has no PLT0!");
   iterator first = m_pSectionData->getFragmentList().begin();
 
   assert(first != m_pSectionData->getFragmentList().end() &&
@@ -140,6 +152,9 @@ X86_32PLT::X86_32PLT(LDSection& pSection,
 
 // FIXME: It only works on little endian machine.
 void X86_32PLT::applyPLT0() {
+  if (!m_bLazy)
+    return;
+
   PLTEntryBase* plt0 = getPLT0();
 
   unsigned char* data = 0;
@@ -177,7 +192,8 @@ void X86_32PLT::applyPLT1() {
 
   // skip PLT0
   uint64_t PLTEntryOffset = m_PLT0Size;
-  ++it;
+  if (m_bLazy)
+    ++it;
 
   PLTEntryBase* plt1 = 0;
 
@@ -199,12 +215,14 @@ void X86_32PLT::applyPLT1() {
     *offset = GOTEntryOffset;
     GOTEntryOffset += GOTEntrySize;
 
-    offset = reinterpret_cast<uint32_t*>(data + 7);
-    *offset = PLTRelOffset;
-    PLTRelOffset += sizeof(llvm::ELF::Elf32_Rel);
+    if (m_bLazy) {
+      offset = reinterpret_cast<uint32_t*>(data + 7);
+      *offset = PLTRelOffset;
+      PLTRelOffset += sizeof(llvm::ELF::Elf32_Rel);
 
-    offset = reinterpret_cast<uint32_t*>(data + 12);
-    *offset = -(PLTEntryOffset + 12 + 4);
+      offset = reinterpret_cast<uint32_t*>(data + 12);
+      *offset = -(PLTEntryOffset + 12 + 4);
+    }
     PLTEntryOffset += m_PLT1Size;
 
     plt1->setValue(data);
@@ -223,6 +241,9 @@ X86_64PLT::X86_64PLT(LDSection& pSection,
 
 // FIXME: It only works on little endian machine.
 void X86_64PLT::applyPLT0() {
+  if (!m_bLazy)
+    return;
+
   PLTEntryBase* plt0 = getPLT0();
 
   unsigned char* data = 0;
@@ -261,7 +282,8 @@ void X86_64PLT::applyPLT1() {
 
   // skip PLT0
   uint64_t PLTEntryOffset = m_PLT0Size;
-  ++it;
+  if (m_bLazy)
+    ++it;
 
   // PC-relative to entry in PLT section.
   SymGOTPCREL -= addr() + PLTEntryOffset + 6;
@@ -287,14 +309,16 @@ void X86_64PLT::applyPLT1() {
     *offset = SymGOTPCREL;
     SymGOTPCREL += GOTEntrySize - m_PLT1Size;
 
-    // pushq $index
-    offset = reinterpret_cast<uint32_t*>(data + 7);
-    *offset = PLTRelIndex;
-    PLTRelIndex++;
+    if (m_bLazy) {
+      // pushq $index
+      offset = reinterpret_cast<uint32_t*>(data + 7);
+      *offset = PLTRelIndex;
+      PLTRelIndex++;
 
-    // jmpq plt0
-    offset = reinterpret_cast<uint32_t*>(data + 12);
-    *offset = -(PLTEntryOffset + 12 + 4);
+      // jmpq plt0
+      offset = reinterpret_cast<uint32_t*>(data + 12);
+      *offset = -(PLTEntryOffset + 12 + 4);
+    }
     PLTEntryOffset += m_PLT1Size;
 
     plt1->setValue(data);
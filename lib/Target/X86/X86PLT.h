@@ -47,6 +47,23 @@ const uint8_t x86_64_plt1[] = {
     0xe9, 0, 0, 0, 0         // jmpq   plt0
 };
 
+// The entries of the non-lazy PLT of -z now. There is no PLT0, and nothing to
+// push for the lazy resolver.
+const uint8_t x86_32_dyn_nonlazy_plt1[] = {
+    0xff, 0xa3, 0, 0, 0, 0,  // jmp    *sym@GOT(%ebx)
+    0x66, 0x90               // xchg   %ax, %ax
+};
+
+const uint8_t x86_32_exec_nonlazy_plt1[] = {
+    0xff, 0x25, 0, 0, 0, 0,  // jmp    *(sym in .got)
+    0x66, 0x90               // xchg   %ax, %ax
+};
+
+const uint8_t x86_64_nonlazy_plt1[] = {
+    0xff, 0x25, 0, 0, 0, 0,  // jmpq   *sym@GOTPCREL(%rip)
+    0x66, 0x90               // xchg   %ax, %ax
+};
+
 namespace mcld {
 
 class X86_32GOTPLT;
@@ -76,6 +93,12 @@ class X86_32ExecPLT1 : public PLT::Entry<sizeof(x86_32_exec_plt1)> {
   X86_32ExecPLT1(SectionData& pParent);
 };
 
+class X86_32NonLazyPLT1
+    : public PLT::Entry<sizeof(x86_32_exec_nonlazy_plt1)> {
+ public:
+  X86_32NonLazyPLT1(SectionData& pParent);
+};
+
 //===----------------------------------------------------------------------===//
 // X86_64PLT Entry
 //===----------------------------------------------------------------------===//
@@ -89,11 +112,20 @@ class X86_64PLT1 : public PLT::Entry<sizeof(x86_64_plt1)> {
   X86_64PLT1(SectionData& pParent);
 };
 
+class X86_64NonLazyPLT1 : public PLT::Entry<sizeof(x86_64_nonlazy_plt1)> {
+ public:
+  X86_64NonLazyPLT1(SectionData& pParent);
+};
+
 //===----------------------------------------------------------------------===//
 // X86PLT
 //===----------------------------------------------------------------------===//
 /** \class X86PLT
  *  \brief X86 Procedure Linkage Table
+ *
+ *  With -z now, the PLT is non-lazy. The loader binds every slot before the
+ *  program starts, so there is no PLT0 and an entry only jumps through its
+ *  slot in .got.plt.
  */
 class X86PLT : public PLT {
  public:
@@ -106,6 +138,9 @@ class X86PLT : public PLT {
   // hasPLT1 - return if this PLT has any PLT1 entry
   bool hasPLT1() const;
 
+  // isLazy - return if the entries push their index for the lazy resolver
+  bool isLazy() const { return m_bLazy; }
+
   PLTEntryBase* create();
 
   virtual void applyPLT0() = 0;
@@ -123,6 +158,7 @@ class X86PLT : public PLT {
   const uint8_t* m_PLT1;
   unsigned int m_PLT0Size;
   unsigned int m_PLT1Size;
+  bool m_bLazy;
 
   const LinkerConfig& m_Config;
 };
@@ -186,12 +186,24 @@ void X86Relocator::scanRelocation(Relocation& pReloc,
     issueUndefRef(pReloc, pSection, pInput);
 }
 
+bool X86Relocator::mayNeedScan(const Relocation& pReloc,
+                               const LDSection& pSection) const {
+  if (!Relocator::mayNeedScan(pReloc, pSection))
+    return false;
+
+  const ResolveInfo* rsym = pReloc.symInfo();
+  if (!rsym->isLocal() || rsym->isUndef())
+    return true;
+  return !isPCRelative(pReloc.type());
+}
+
 void X86Relocator::addCopyReloc(ResolveInfo& pSym, X86GNULDBackend& pTarget) {
   Relocation& rel_entry = *pTarget.getRelDyn().create();
   rel_entry.setType(pTarget.getCopyRelType());
   assert(pSym.outSymbol()->hasFragRef());
   rel_entry.targetRef().assign(*pSym.outSymbol()->fragRef());
   rel_entry.setSymInfo(&pSym);
+  pTarget.noteCopyReloc(pSym);
 }
 
 /// defineSymbolforCopyReloc
@@ -294,6 +306,17 @@ Relocator::Size X86_32Relocator::getSize(Relocation::Type pType) const {
   return X86_32ApplyFunctions[pType].size;
 }
 
+bool X86_32Relocator::isPCRelative(Relocation::Type pType) const {
+  switch (pType) {
+    case llvm::ELF::R_386_PC32:
+    case llvm::ELF::R_386_PC16:
+    case llvm::ELF::R_386_PC8:
+      return true;
+    default:
+      return false;
+  }
+}
+
 bool X86_32Relocator::mayHaveFunctionPointerAccess(
     const Relocation& pReloc) const {
   switch (pReloc.type()) {
@@ -1245,6 +1268,44 @@ Relocator::Result X86_64Relocator::applyRelocation(Relocation& pRelocation) {
   return X86_64ApplyFunctions[type].func(pRelocation, *this);
 }
 
+void X86_64Relocator::applyRelocations(const RelocList& pRelocs,
+                                       FailureList& pFailures) {
+  RelocList::const_iterator reloc, rEnd = pRelocs.end();
+  for (reloc = pRelocs.begin(); reloc != rEnd; ++reloc) {
+    Relocation& relocation = **reloc;
+    // a local symbol needs neither PLT nor dynamic relocation, so rel() only
+    // performs the static relocation
+    if (relocation.type() == llvm::ELF::R_X86_64_PC32 &&
+        relocation.symInfo()->isLocal()) {
+      relocation.target() = relocation.symValue() + relocation.target() +
+                            relocation.addend() - relocation.place();
+      continue;
+    }
+
+    Result result = applyRelocation(relocation);
+    if (result != OK)
+      pFailures.push_back(std::make_pair(&relocation, result));
+  }
+}
+
+void X86_64Relocator::applyDebugRelocations(const RelocList& pRelocs,
+                                            FailureList& pFailures) {
+  RelocList::const_iterator reloc, rEnd = pRelocs.end();
+  for (reloc = pRelocs.begin(); reloc != rEnd; ++reloc) {
+    Relocation& relocation = **reloc;
+    if (relocation.type() == llvm::ELF::R_X86_64_64 ||
+        relocation.type() == llvm::ELF::R_X86_64_32) {
+      relocation.target() =
+          relocation.symValue() + relocation.target() + relocation.addend();
+      continue;
+    }
+
+    Result result = applyRelocation(relocation);
+    if (result != OK)
+      pFailures.push_back(std::make_pair(&relocation, result));
+  }
+}
+
 const char* X86_64Relocator::getName(Relocation::Type pType) const {
   return X86_64ApplyFunctions[pType].name;
 }
@@ -1253,6 +1314,17 @@ Relocator::Size X86_64Relocator::getSize(Relocation::Type pType) const {
   return X86_64ApplyFunctions[pType].size;
 }
 
+bool X86_64Relocator::isPCRelative(Relocation::Type pType) const {
+  switch (pType) {
+    case llvm::ELF::R_X86_64_PC32:
+    case llvm::ELF::R_X86_64_PC16:
+    case llvm::ELF::R_X86_64_PC8:
+      return true;
+    default:
+      return false;
+  }
+}
+
 bool X86_64Relocator::mayHaveFunctionPointerAccess(
     const Relocation& pReloc) const {
   bool possible_funcptr_reloc = false;
@@ -1266,6 +1338,8 @@ bool X86_64Relocator::mayHaveFunctionPointerAccess(
     case llvm::ELF::R_X86_64_GOT32:
     case llvm::ELF::R_X86_64_GOTPCREL64:
     case llvm::ELF::R_X86_64_GOTPCREL:
+    case llvm::ELF::R_X86_64_GOTPCRELX:
+    case llvm::ELF::R_X86_64_REX_GOTPCRELX:
     case llvm::ELF::R_X86_64_GOTPLT64: {
       possible_funcptr_reloc = true;
       break;
@@ -1336,6 +1410,11 @@ void X86_64Relocator::scanLocalReloc(Relocation& pReloc,
     case llvm::ELF::R_X86_64_PC8:
       return;
 
+    case llvm::ELF::R_X86_64_GOTPCRELX:
+    case llvm::ELF::R_X86_64_REX_GOTPCRELX:
+      if (relaxGOTPCRELX(pReloc, pSection))
+        return;
+      // Fall through
     case llvm::ELF::R_X86_64_GOTPCREL:
       // Symbol needs GOT entry, reserve entry in .got
       // return if we already create GOT for this symbol
@@ -1364,6 +1443,7 @@ void X86_64Relocator::scanGlobalReloc(Relocation& pReloc,
                                       LDSection& pSection) {
   // rsym - The relocation target symbol
   ResolveInfo* rsym = pReloc.symInfo();
+  bool canonical_plt = false;
 
   switch (pReloc.type()) {
     case llvm::ELF::R_X86_64_64:
@@ -1373,7 +1453,8 @@ void X86_64Relocator::scanGlobalReloc(Relocation& pReloc,
     case llvm::ELF::R_X86_64_32S:
       // Absolute relocation type, symbol may needs PLT entry or
       // dynamic relocation entry
-      if (getTarget().symbolNeedsPLT(*rsym)) {
+      canonical_plt = getTarget().symbolNeedsCanonicalPLT(pReloc, *rsym);
+      if (canonical_plt) {
         // create plt for this symbol if it does not have one
         if (!(rsym->reserved() & ReservePLT)) {
           // Symbol needs PLT entry, we need to reserve a PLT entry
@@ -1383,11 +1464,12 @@ void X86_64Relocator::scanGlobalReloc(Relocation& pReloc,
           // set PLT bit
           rsym->setReserved(rsym->reserved() | ReservePLT);
         }
+        getTarget().noteCanonicalPLT(*rsym);
       }
 
-      if (getTarget()
-              .symbolNeedsDynRel(
-                  *rsym, (rsym->reserved() & ReservePLT), true)) {
+      // the place refers to the function itself if it is not canonical
+      if (getTarget().symbolNeedsDynRel(
+              *rsym, canonical_plt && (rsym->reserved() & ReservePLT), true)) {
         // symbol needs dynamic relocation entry, set up the dynrel entry
         if (getTarget().symbolNeedsCopyReloc(pReloc, *rsym)) {
           LDSymbol& cpy_sym =
@@ -1418,6 +1500,11 @@ void X86_64Relocator::scanGlobalReloc(Relocation& pReloc,
       }
       return;
 
+    case llvm::ELF::R_X86_64_GOTPCRELX:
+    case llvm::ELF::R_X86_64_REX_GOTPCRELX:
+      if (relaxGOTPCRELX(pReloc, pSection))
+        return;
+      // Fall through
     case llvm::ELF::R_X86_64_GOTPCREL:
       // Symbol needs GOT entry, reserve entry in .got
       // return if we already create GOT for this symbol
@@ -1489,6 +1576,11 @@ void X86_64Relocator::scanGlobalReloc(Relocation& pReloc,
         LDSymbol& cpy_sym =
             defineSymbolforCopyReloc(pBuilder, *rsym, getTarget());
         addCopyReloc(*cpy_sym.resolveInfo(), getTarget());
+      } else if (config().options().hasNoCopyReloc() && rsym->isDyn() &&
+                 ResolveInfo::Function != rsym->type()) {
+        // a PC-relative place cannot be redirected to the GOT
+        error(diag::err_nocopyreloc_pcrel) << getName(pReloc.type())
+                                           << rsym->name();
       }
       return;
 
@@ -1499,6 +1591,55 @@ void X86_64Relocator::scanGlobalReloc(Relocation& pReloc,
   }  // end switch
 }
 
+bool X86_64Relocator::relaxGOTPCRELX(Relocation& pReloc, LDSection& pSection) {
+  assert(pReloc.targetRef().frag() != NULL);
+  // the address of a non-preemptible symbol is fixed relative to the place
+  ResolveInfo* rsym = pReloc.symInfo();
+  if (!rsym->isDefine() || rsym->isDyn() ||
+      ResolveInfo::IndirectFunc == rsym->type() ||
+      getTarget().isSymbolPreemptible(*rsym) ||
+      (rsym->isAbsolute() && config().isCodeIndep()))
+    return false;
+  if (pReloc.targetRef().offset() < 2)
+    return false;
+
+  // 1. create the new reloc of the opcode and the ModRM byte
+  Relocation* reloc =
+      Relocation::Create(X86_64Relocator::R_X86_64_GOTPCRELX_OPT,
+                         *FragmentRef::Create(*pReloc.targetRef().frag(),
+                                              pReloc.targetRef().offset() - 2),
+                         0x0);
+  reloc->setSymInfo(rsym);
+
+  // 2. modify the opcodes to the appropriate ones
+  uint8_t* op = (reinterpret_cast<uint8_t*>(&reloc->target()));
+  if (op[0] == 0x8b) {
+    // mov foo@GOTPCREL(%rip), %reg => lea foo(%rip), %reg
+    op[0] = 0x8d;
+  } else if (pReloc.type() == llvm::ELF::R_X86_64_GOTPCRELX &&
+             op[0] == 0xff && op[1] == 0x15) {
+    // call *foo@GOTPCREL(%rip) => addr32 call foo
+    op[0] = 0x67;
+    op[1] = 0xe8;
+  } else if (pReloc.type() == llvm::ELF::R_X86_64_GOTPCRELX &&
+             op[0] == 0xff && op[1] == 0x25) {
+    // jmp *foo@GOTPCREL(%rip) => nop; jmp foo
+    op[0] = 0x90;
+    op[1] = 0xe9;
+  } else {
+    Relocation::Destroy(reloc);
+    return false;
+  }
+
+  // 3. insert the new reloc "BEFORE" the original reloc.
+  pSection.getRelocData()->getRelocationList().insert(
+      RelocData::iterator(pReloc), reloc);
+
+  // 4. change the type of the original reloc
+  pReloc.setType(llvm::ELF::R_X86_64_PC32);
+  return true;
+}
+
 uint32_t X86_64Relocator::getDebugStringOffset(Relocation& pReloc) const {
   if (pReloc.type() != llvm::ELF::R_X86_64_32)
     error(diag::unsupport_reloc_for_debug_string)
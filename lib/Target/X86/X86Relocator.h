@@ -83,6 +83,10 @@ class X86Relocator : public Relocator {
                       LDSection& pSection,
                       Input& pInput);
 
+  /// mayNeedScan - a PC-relative relocation against a defined local symbol
+  /// needs no entry either.
+  bool mayNeedScan(const Relocation& pReloc, const LDSection& pSection) const;
+
  protected:
   /// addCopyReloc - add a copy relocation into .rel.dyn for pSym
   /// @param pSym - A resolved copy symbol that defined in BSS section
@@ -106,6 +110,10 @@ class X86Relocator : public Relocator {
                                Module& pModule,
                                LDSection& pSection) = 0;
 
+  /// isPCRelative - check if pType is a PC-relative type that scanLocalReloc
+  /// creates nothing for
+  virtual bool isPCRelative(Relocation::Type pType) const = 0;
+
  private:
   SymPLTMap m_SymPLTMap;
 };
@@ -167,6 +175,8 @@ class X86_32Relocator : public X86Relocator {
                        Module& pModule,
                        LDSection& pSection);
 
+  bool isPCRelative(Relocation::Type pType) const;
+
   /// -----  tls optimization  ----- ///
   /// convert R_386_TLS_IE to R_386_TLS_LE
   void convertTLSIEtoLE(Relocation& pReloc, LDSection& pSection);
@@ -187,11 +197,24 @@ class X86_64Relocator : public X86Relocator {
   typedef KeyEntryMap<ResolveInfo, X86_64GOTEntry> SymGOTPLTMap;
   typedef KeyEntryMap<Relocation, Relocation> RelRelMap;
 
+  enum {
+    R_X86_64_GOTPCRELX_OPT = 43  // mcld internal relocation type
+  };
+
  public:
   X86_64Relocator(X86_64GNULDBackend& pParent, const LinkerConfig& pConfig);
 
   Result applyRelocation(Relocation& pRelocation);
 
+  /// applyRelocations - apply R_X86_64_PC32 against the local symbols, the
+  /// most common relocation of the code, without dispatching it
+  void applyRelocations(const RelocList& pRelocs, FailureList& pFailures);
+
+  /// applyDebugRelocations - apply R_X86_64_64 and R_X86_64_32 without
+  /// dispatching them
+  void applyDebugRelocations(const RelocList& pRelocs,
+                             FailureList& pFailures);
+
   X86_64GNULDBackend& getTarget() { return m_Target; }
 
   const X86_64GNULDBackend& getTarget() const { return m_Target; }
@@ -232,6 +255,13 @@ class X86_64Relocator : public X86Relocator {
                        Module& pModule,
                        LDSection& pSection);
 
+  bool isPCRelative(Relocation::Type pType) const;
+
+  /// relaxGOTPCRELX - rewrite the load of the GOT entry of a non-preemptible
+  /// symbol to the computation of its PC-relative address
+  /// @return true if pReloc is converted to R_X86_64_PC32
+  bool relaxGOTPCRELX(Relocation& pReloc, LDSection& pSection);
+
  private:
   X86_64GNULDBackend& m_Target;
   SymGOTMap m_SymGOTMap;
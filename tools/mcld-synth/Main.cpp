@@ -0,0 +1,522 @@
+//===- Main.cpp -----------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// mcld-synth generates a reproducible set of relocatable objects to measure
+// the linker with. Every input defines global functions in its own sections,
+// calls functions of the other inputs, and carries COMDAT groups and
+// mergeable debug strings that are shared with the other inputs.
+//
+//===----------------------------------------------------------------------===//
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using namespace llvm;
+
+static cl::opt<std::string> OptOutputDir("o",
+                                         cl::desc("The output directory"),
+                                         cl::value_desc("dir"),
+                                         cl::init("synth"));
+
+static cl::opt<std::string> OptTarget(
+    "target",
+    cl::desc("The target of the objects: x86_64, aarch64 or arm"),
+    cl::init("x86_64"));
+
+static cl::opt<unsigned> OptInputs("inputs",
+                                   cl::desc("The number of objects"),
+                                   cl::init(100));
+
+static cl::opt<unsigned> OptSections("sections",
+                                     cl::desc("The text sections per object"),
+                                     cl::init(16));
+
+static cl::opt<unsigned> OptSymbols("symbols",
+                                    cl::desc("The functions per object"),
+                                    cl::init(64));
+
+static cl::opt<unsigned> OptRelocs("relocs",
+                                   cl::desc("The calls per text section"),
+                                   cl::init(32));
+
+static cl::opt<unsigned> OptComdats(
+    "comdats",
+    cl::desc("The COMDAT groups per object, drawn from a shared pool"),
+    cl::init(8));
+
+static cl::opt<unsigned> OptDebugStr(
+    "debug-str",
+    cl::desc("The bytes of .debug_str per object, drawn from a shared pool"),
+    cl::init(4096));
+
+static cl::opt<unsigned> OptSeed("seed",
+                                 cl::desc("The seed of the generator"),
+                                 cl::init(1));
+
+namespace {
+
+/// the instructions of a target. A call is one relocated instruction.
+struct TargetDesc {
+  const char* name;
+  const char* triple;
+  uint16_t machine;
+  bool is64;
+  bool isRela;
+  uint32_t callType;
+  unsigned callSize;
+  /// the offset of the relocated field in a call
+  unsigned callFixup;
+  int64_t callAddend;
+  uint8_t call[8];
+  unsigned retSize;
+  uint8_t ret[4];
+};
+
+const TargetDesc kTargets[] = {
+    {"x86_64", "x86_64-linux-gnu", ELF::EM_X86_64, true, true,
+     ELF::R_X86_64_PLT32, 5, 1, -4,
+     {0xe8, 0x00, 0x00, 0x00, 0x00}, 1, {0xc3}},
+    {"aarch64", "aarch64-linux-gnu", ELF::EM_AARCH64, true, true,
+     ELF::R_AARCH64_CALL26, 4, 0, 0,
+     {0x00, 0x00, 0x00, 0x94}, 4, {0xc0, 0x03, 0x5f, 0xd6}},
+    {"arm", "arm-linux-gnueabi", ELF::EM_ARM, false, false,
+     ELF::R_ARM_CALL, 4, 0, 0,
+     {0xfe, 0xff, 0xff, 0xeb}, 4, {0x1e, 0xff, 0x2f, 0xe1}},
+};
+
+/// the generator draws all the numbers with x % n, which gives the same
+/// sequence with any C++ library, unlike the std distributions.
+typedef std::mt19937_64 Random;
+
+struct Section {
+  std::string name;
+  uint32_t type;
+  uint64_t flags;
+  uint32_t link;
+  uint32_t info;
+  uint64_t align;
+  uint64_t entsize;
+  std::vector<uint8_t> data;
+};
+
+struct Symbol {
+  std::string name;
+  uint16_t shndx;
+  uint64_t value;
+  uint8_t binding;
+  uint8_t type;
+};
+
+/// ObjectBuilder - collect the sections and symbols of one object. The
+/// symbol table, its strings and the section names take the first indices.
+class ObjectBuilder {
+ public:
+  enum { SymTab = 1, StrTab = 2, ShStrTab = 3, FirstSection = 4 };
+
+  explicit ObjectBuilder(const TargetDesc& pTarget) : m_Target(pTarget) {
+    m_Sections.resize(FirstSection);
+    m_Symbols.push_back(Symbol());
+  }
+
+  unsigned addSection(const std::string& pName,
+                      uint32_t pType,
+                      uint64_t pFlags,
+                      uint64_t pAlign) {
+    Section sect;
+    sect.name = pName;
+    sect.type = pType;
+    sect.flags = pFlags;
+    sect.link = 0;
+    sect.info = 0;
+    sect.align = pAlign;
+    sect.entsize = 0;
+    m_Sections.push_back(sect);
+    return m_Sections.size() - 1;
+  }
+
+  Section& getSection(unsigned pIndex) { return m_Sections[pIndex]; }
+
+  /// getSymbol - the index of the symbol pName, an undefined global unless it
+  /// has been defined
+  uint32_t getSymbol(const std::string& pName) {
+    std::map<std::string, uint32_t>::iterator it = m_SymbolMap.find(pName);
+    if (it != m_SymbolMap.end())
+      return it->second;
+    Symbol sym;
+    sym.name = pName;
+    sym.shndx = ELF::SHN_UNDEF;
+    sym.value = 0;
+    sym.binding = ELF::STB_GLOBAL;
+    sym.type = ELF::STT_NOTYPE;
+    m_Symbols.push_back(sym);
+    m_SymbolMap[pName] = m_Symbols.size() - 1;
+    return m_Symbols.size() - 1;
+  }
+
+  void defineFunction(const std::string& pName,
+                      unsigned pSection,
+                      uint64_t pValue) {
+    Symbol& sym = m_Symbols[getSymbol(pName)];
+    sym.shndx = pSection;
+    sym.value = pValue;
+    sym.type = ELF::STT_FUNC;
+  }
+
+  /// addCall - append a call to pCallee to the text section pSection
+  void addCall(unsigned pSection, unsigned pRelSection,
+               const std::string& pCallee);
+
+  void addReturn(unsigned pSection) {
+    std::vector<uint8_t>& data = m_Sections[pSection].data;
+    data.insert(data.end(), m_Target.ret, m_Target.ret + m_Target.retSize);
+  }
+
+  bool write(const std::string& pPath) const;
+
+ private:
+  template <typename Ehdr, typename Shdr, typename Sym>
+  bool writeAs(raw_ostream& pOS) const;
+
+  template <typename T>
+  void append(std::vector<uint8_t>& pData, const T& pValue) const {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&pValue);
+    pData.insert(pData.end(), bytes, bytes + sizeof(T));
+  }
+
+ private:
+  const TargetDesc& m_Target;
+  std::vector<Section> m_Sections;
+  std::vector<Symbol> m_Symbols;
+  std::map<std::string, uint32_t> m_SymbolMap;
+};
+
+void ObjectBuilder::addCall(unsigned pSection,
+                            unsigned pRelSection,
+                            const std::string& pCallee) {
+  std::vector<uint8_t>& data = m_Sections[pSection].data;
+  uint64_t offset = data.size() + m_Target.callFixup;
+  data.insert(data.end(), m_Target.call, m_Target.call + m_Target.callSize);
+
+  uint32_t sym = getSymbol(pCallee);
+  std::vector<uint8_t>& rel = m_Sections[pRelSection].data;
+  if (m_Target.is64) {
+    ELF::Elf64_Rela rela;
+    rela.r_offset = offset;
+    rela.setSymbolAndType(sym, m_Target.callType);
+    rela.r_addend = m_Target.callAddend;
+    append(rel, rela);
+  } else if (m_Target.isRela) {
+    ELF::Elf32_Rela rela;
+    rela.r_offset = offset;
+    rela.setSymbolAndType(sym, m_Target.callType);
+    rela.r_addend = m_Target.callAddend;
+    append(rel, rela);
+  } else {
+    // the addend is in the instruction
+    ELF::Elf32_Rel r;
+    r.r_offset = offset;
+    r.setSymbolAndType(sym, m_Target.callType);
+    append(rel, r);
+  }
+}
+
+bool ObjectBuilder::write(const std::string& pPath) const {
+  std::error_code ec;
+  raw_fd_ostream os(pPath, ec, sys::fs::F_None);
+  if (ec) {
+    errs() << "mcld-synth: cannot write " << pPath << ": " << ec.message()
+           << "\n";
+    return false;
+  }
+  if (m_Target.is64)
+    return writeAs<ELF::Elf64_Ehdr, ELF::Elf64_Shdr, ELF::Elf64_Sym>(os);
+  return writeAs<ELF::Elf32_Ehdr, ELF::Elf32_Shdr, ELF::Elf32_Sym>(os);
+}
+
+template <typename Ehdr, typename Shdr, typename Sym>
+bool ObjectBuilder::writeAs(raw_ostream& pOS) const {
+  std::vector<Section> sections = m_Sections;
+
+  // the globals follow the null symbol, there are no other locals
+  Section& symtab = sections[SymTab];
+  Section& strtab = sections[StrTab];
+  strtab.data.push_back(0);
+  for (size_t i = 0; i < m_Symbols.size(); ++i) {
+    Sym sym;
+    std::memset(&sym, 0x0, sizeof(sym));
+    if (i != 0) {
+      sym.st_name = strtab.data.size();
+      strtab.data.insert(strtab.data.end(), m_Symbols[i].name.begin(),
+                         m_Symbols[i].name.end());
+      strtab.data.push_back(0);
+      sym.st_value = m_Symbols[i].value;
+      sym.st_shndx = m_Symbols[i].shndx;
+      sym.setBindingAndType(m_Symbols[i].binding, m_Symbols[i].type);
+    }
+    append(symtab.data, sym);
+  }
+  symtab.name = ".symtab";
+  symtab.type = ELF::SHT_SYMTAB;
+  symtab.link = StrTab;
+  symtab.info = 1;
+  symtab.align = m_Target.is64 ? 8 : 4;
+  symtab.entsize = sizeof(Sym);
+  strtab.name = ".strtab";
+  strtab.type = ELF::SHT_STRTAB;
+  strtab.align = 1;
+
+  Section& shstrtab = sections[ShStrTab];
+  shstrtab.name = ".shstrtab";
+  shstrtab.type = ELF::SHT_STRTAB;
+  shstrtab.align = 1;
+  std::vector<uint32_t> names(sections.size(), 0);
+  shstrtab.data.push_back(0);
+  for (size_t i = 1; i < sections.size(); ++i) {
+    names[i] = shstrtab.data.size();
+    shstrtab.data.insert(shstrtab.data.end(), sections[i].name.begin(),
+                         sections[i].name.end());
+    shstrtab.data.push_back(0);
+  }
+
+  // lay out the contents after the ELF header, then the section headers
+  std::vector<uint64_t> offsets(sections.size(), 0);
+  uint64_t offset = sizeof(Ehdr);
+  for (size_t i = 1; i < sections.size(); ++i) {
+    uint64_t align = sections[i].align ? sections[i].align : 1;
+    offset = (offset + align - 1) / align * align;
+    offsets[i] = offset;
+    offset += sections[i].data.size();
+  }
+  uint64_t shoff = (offset + 7) / 8 * 8;
+
+  std::vector<uint8_t> file;
+  Ehdr ehdr;
+  std::memset(&ehdr, 0x0, sizeof(ehdr));
+  std::memcpy(ehdr.e_ident, ELF::ElfMagic, 4);
+  ehdr.e_ident[ELF::EI_CLASS] = m_Target.is64 ? ELF::ELFCLASS64
+                                              : ELF::ELFCLASS32;
+  ehdr.e_ident[ELF::EI_DATA] = ELF::ELFDATA2LSB;
+  ehdr.e_ident[ELF::EI_VERSION] = ELF::EV_CURRENT;
+  ehdr.e_type = ELF::ET_REL;
+  ehdr.e_machine = m_Target.machine;
+  ehdr.e_version = ELF::EV_CURRENT;
+  if (ELF::EM_ARM == m_Target.machine)
+    ehdr.e_flags = ELF::EF_ARM_EABI_VER5;
+  ehdr.e_shoff = shoff;
+  ehdr.e_ehsize = sizeof(Ehdr);
+  ehdr.e_shentsize = sizeof(Shdr);
+  ehdr.e_shnum = sections.size();
+  ehdr.e_shstrndx = ShStrTab;
+  append(file, ehdr);
+
+  for (size_t i = 1; i < sections.size(); ++i) {
+    file.resize(offsets[i], 0);
+    file.insert(file.end(), sections[i].data.begin(), sections[i].data.end());
+  }
+  file.resize(shoff, 0);
+
+  for (size_t i = 0; i < sections.size(); ++i) {
+    Shdr shdr;
+    std::memset(&shdr, 0x0, sizeof(shdr));
+    if (i != 0) {
+      shdr.sh_name = names[i];
+      shdr.sh_type = sections[i].type;
+      shdr.sh_flags = sections[i].flags;
+      shdr.sh_offset = offsets[i];
+      shdr.sh_size = sections[i].data.size();
+      shdr.sh_link = sections[i].link;
+      shdr.sh_info = sections[i].info;
+      shdr.sh_addralign = sections[i].align;
+      shdr.sh_entsize = sections[i].entsize;
+    }
+    append(file, shdr);
+  }
+
+  pOS.write(reinterpret_cast<const char*>(file.data()), file.size());
+  return true;
+}
+
+std::string getFunctionName(unsigned pInput, unsigned pSymbol) {
+  return "f_" + std::to_string(pInput) + "_" + std::to_string(pSymbol);
+}
+
+/// addTextSection - add a text section, and its relocation section if any
+/// call is made from it
+std::pair<unsigned, unsigned> addTextSection(ObjectBuilder& pBuilder,
+                                             const TargetDesc& pTarget,
+                                             const std::string& pName,
+                                             uint64_t pGroupFlag) {
+  unsigned text = pBuilder.addSection(
+      pName, ELF::SHT_PROGBITS,
+      ELF::SHF_ALLOC | ELF::SHF_EXECINSTR | pGroupFlag, 4);
+  unsigned rel = pBuilder.addSection(
+      (pTarget.isRela ? ".rela" : ".rel") + pName,
+      pTarget.isRela ? ELF::SHT_RELA : ELF::SHT_REL,
+      ELF::SHF_INFO_LINK | pGroupFlag, pTarget.is64 ? 8 : 4);
+  Section& rel_sect = pBuilder.getSection(rel);
+  rel_sect.link = ObjectBuilder::SymTab;
+  rel_sect.info = text;
+  if (pTarget.is64)
+    rel_sect.entsize = sizeof(ELF::Elf64_Rela);
+  else if (pTarget.isRela)
+    rel_sect.entsize = sizeof(ELF::Elf32_Rela);
+  else
+    rel_sect.entsize = sizeof(ELF::Elf32_Rel);
+  return std::make_pair(text, rel);
+}
+
+void appendWord(std::vector<uint8_t>& pData, uint32_t pValue) {
+  for (size_t i = 0; i < 4; ++i)
+    pData.push_back(static_cast<uint8_t>(pValue >> (i * 8)));
+}
+
+/// buildInput - the functions f_<input>_<n> are spread over the text
+/// sections. Each function calls random functions of any input.
+void buildInput(ObjectBuilder& pBuilder,
+                const TargetDesc& pTarget,
+                unsigned pInput,
+                Random& pRandom) {
+  unsigned num_sections = std::max(1u, unsigned(OptSections));
+  unsigned num_symbols = std::max(num_sections, unsigned(OptSymbols));
+  unsigned num_inputs = OptInputs;
+
+  for (unsigned s = 0; s < num_sections; ++s) {
+    std::pair<unsigned, unsigned> text = addTextSection(
+        pBuilder, pTarget, ".text.f_" + std::to_string(pInput) + "_" +
+                               std::to_string(s), 0x0);
+    // the functions of the section share its calls
+    unsigned num_funcs = num_symbols / num_sections +
+                         (s < num_symbols % num_sections ? 1 : 0);
+    for (unsigned f = 0; f < num_funcs; ++f) {
+      unsigned symbol = f * num_sections + s;
+      pBuilder.defineFunction(getFunctionName(pInput, symbol), text.first,
+                              pBuilder.getSection(text.first).data.size());
+      unsigned num_calls = OptRelocs / num_funcs +
+                           (f < OptRelocs % num_funcs ? 1 : 0);
+      for (unsigned c = 0; c < num_calls; ++c) {
+        unsigned callee_input = pRandom() % num_inputs;
+        unsigned callee = pRandom() % num_symbols;
+        pBuilder.addCall(text.first, text.second,
+                         getFunctionName(callee_input, callee));
+      }
+      pBuilder.addReturn(text.first);
+    }
+  }
+
+  // COMDAT groups, each defines its signature and calls a function of the
+  // first input
+  for (unsigned c = 0; c < OptComdats; ++c) {
+    unsigned id = pRandom() % (OptComdats * 4);
+    std::string signature = "comdat_" + std::to_string(id);
+    unsigned group = pBuilder.addSection(".group", ELF::SHT_GROUP, 0x0, 4);
+    std::pair<unsigned, unsigned> text = addTextSection(
+        pBuilder, pTarget, ".text." + signature, ELF::SHF_GROUP);
+    pBuilder.defineFunction(signature, text.first, 0x0);
+    pBuilder.addCall(text.first, text.second,
+                     getFunctionName(0, pRandom() % num_symbols));
+    pBuilder.addReturn(text.first);
+
+    Section& group_sect = pBuilder.getSection(group);
+    group_sect.link = ObjectBuilder::SymTab;
+    group_sect.info = pBuilder.getSymbol(signature);
+    group_sect.entsize = 4;
+    appendWord(group_sect.data, ELF::GRP_COMDAT);
+    appendWord(group_sect.data, text.first);
+    appendWord(group_sect.data, text.second);
+  }
+
+  if (OptDebugStr != 0) {
+    unsigned debug_str = pBuilder.addSection(
+        ".debug_str", ELF::SHT_PROGBITS, ELF::SHF_MERGE | ELF::SHF_STRINGS, 1);
+    Section& sect = pBuilder.getSection(debug_str);
+    sect.entsize = 1;
+    // about a half of the strings are duplicates of the other inputs
+    unsigned pool_size = std::max(1u, OptDebugStr * OptInputs / 64);
+    while (sect.data.size() < OptDebugStr) {
+      std::string str = "debug_string_" + std::to_string(pRandom() % pool_size);
+      sect.data.insert(sect.data.end(), str.begin(), str.end());
+      sect.data.push_back(0);
+    }
+  }
+}
+
+/// buildStart - _start calls the first function of every input
+void buildStart(ObjectBuilder& pBuilder, const TargetDesc& pTarget) {
+  std::pair<unsigned, unsigned> text =
+      addTextSection(pBuilder, pTarget, ".text", 0x0);
+  pBuilder.defineFunction("_start", text.first, 0x0);
+  for (unsigned i = 0; i < OptInputs; ++i)
+    pBuilder.addCall(text.first, text.second, getFunctionName(i, 0));
+  pBuilder.addReturn(text.first);
+}
+
+}  // anonymous namespace
+
+int main(int argc, char** argv) {
+  cl::ParseCommandLineOptions(argc, argv, "synthetic link inputs for mcld\n");
+
+  if (!sys::IsLittleEndianHost) {
+    errs() << "mcld-synth: only little endian hosts are supported\n";
+    return 1;
+  }
+
+  const TargetDesc* target = NULL;
+  for (size_t i = 0; i < sizeof(kTargets) / sizeof(kTargets[0]); ++i) {
+    if (OptTarget == kTargets[i].name)
+      target = &kTargets[i];
+  }
+  if (target == NULL) {
+    errs() << "mcld-synth: unknown target " << OptTarget << "\n";
+    return 1;
+  }
+  if (OptInputs == 0) {
+    errs() << "mcld-synth: -inputs must be positive\n";
+    return 1;
+  }
+
+  std::error_code ec = sys::fs::create_directories(OptOutputDir);
+  if (ec) {
+    errs() << "mcld-synth: cannot create " << OptOutputDir << ": "
+           << ec.message() << "\n";
+    return 1;
+  }
+
+  Random random(OptSeed);
+  {
+    ObjectBuilder start(*target);
+    buildStart(start, *target);
+    if (!start.write(OptOutputDir + "/start.o"))
+      return 1;
+  }
+  for (unsigned i = 0; i < OptInputs; ++i) {
+    ObjectBuilder input(*target);
+    buildInput(input, *target, i, random);
+    if (!input.write(OptOutputDir + "/input" + std::to_string(i) + ".o"))
+      return 1;
+  }
+
+  // the harness reads the triple of the workload from here
+  raw_fd_ostream triple(OptOutputDir + "/triple", ec, sys::fs::F_Text);
+  if (ec) {
+    errs() << "mcld-synth: cannot write the triple: " << ec.message() << "\n";
+    return 1;
+  }
+  triple << target->triple << "\n";
+  return 0;
+}
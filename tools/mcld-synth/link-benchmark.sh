@@ -0,0 +1,83 @@
+#!/bin/sh
+#===- link-benchmark.sh ----------------------------------------------------===#
+#
+#                     The MCLinker Project
+#
+# This file is distributed under the University of Illinois Open Source
+# License. See LICENSE.TXT for details.
+#
+#===------------------------------------------------------------------------===#
+#
+# link-benchmark.sh links a workload of mcld-synth a few times and prints the
+# fastest time of every phase, the peak RSS and the link statistics, as
+# reported by --print-stats. The Chrome trace of the last run is kept in
+# <workload>/link.time-trace.json.
+#
+# usage: link-benchmark.sh <ld.mc> <workload> [runs] [linker options...]
+#
+#===------------------------------------------------------------------------===#
+
+if [ $# -lt 2 ]; then
+  echo "usage: $0 <ld.mc> <workload> [runs] [linker options...]" >&2
+  exit 1
+fi
+
+LD=$1
+WORKLOAD=$2
+shift 2
+RUNS=3
+if [ $# -gt 0 ]; then
+  RUNS=$1
+  shift
+fi
+
+if [ ! -f "$WORKLOAD/triple" ]; then
+  echo "$0: $WORKLOAD is not a workload of mcld-synth" >&2
+  exit 1
+fi
+TRIPLE=$(cat "$WORKLOAD/triple")
+
+STATS=$(mktemp)
+trap 'rm -f "$STATS"' EXIT
+
+run=0
+while [ $run -lt $RUNS ]; do
+  if ! "$LD" -mtriple="$TRIPLE" -e _start -o "$WORKLOAD/link.out" \
+       --print-stats --time-trace \
+       --time-trace-file="$WORKLOAD/link.time-trace.json" \
+       "$@" "$WORKLOAD"/start.o "$WORKLOAD"/input*.o 2>>"$STATS"; then
+    echo "$0: the link failed" >&2
+    cat "$STATS" >&2
+    exit 1
+  fi
+  run=$((run + 1))
+done
+
+# The phases and "total" are lines of a name and milliseconds; keep the
+# minimum over the runs. The peak RSS, the counts and the statistics are the
+# same for every run, except the RSS, so keep the maximum.
+awk -v runs="$RUNS" '
+  /^phase / { section = "phase"; next }
+  /^statistic / { section = "stat"; next }
+  /^peak RSS:/ {
+    if ($3 > rss) rss = $3
+    section = "count"
+    next
+  }
+  NF == 2 && section == "phase" {
+    if (!($1 in time)) { order[n++] = $1; time[$1] = $2 }
+    else if ($2 < time[$1]) time[$1] = $2
+    next
+  }
+  NF == 2 {
+    if (!($1 in count)) corder[m++] = $1
+    count[$1] = $2
+  }
+  END {
+    printf "best of %d runs\n", runs
+    for (i = 0; i < n; ++i)
+      printf "  %-30s %10.3f ms\n", order[i], time[order[i]]
+    printf "  %-30s %10.1f MiB\n", "peak RSS", rss
+    for (i = 0; i < m; ++i)
+      printf "  %-30s %10d\n", corder[i], count[corder[i]]
+  }' "$STATS"
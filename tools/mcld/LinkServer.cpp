@@ -0,0 +1,400 @@
+//===- LinkServer.cpp -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "LinkServer.h"
+
+#include <mcld/Config/Config.h>
+#include <mcld/Environment.h>
+#include <mcld/Support/InputCache.h>
+#include <mcld/Support/raw_ostream.h>
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/FileSystem.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(MCLD_ON_UNIX)
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace mcld {
+
+#if defined(MCLD_ON_UNIX)
+
+//===----------------------------------------------------------------------===//
+// Helper Function
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// A request is a 32-bit count of strings followed by the strings, each of
+/// them a 32-bit length and the bytes. The first string is the working
+/// directory of the client and the rest is the command line. The reply is
+/// the output of the link followed by the 32-bit exit status. All integers
+/// are little-endian.
+
+/// Job - a link running in a child
+struct Job {
+  pid_t pid;
+  int client;
+  int misses;
+  std::string paths;
+};
+
+bool writeAll(int pFD, const char* pData, size_t pSize) {
+  while (pSize > 0) {
+    ssize_t written = ::write(pFD, pData, pSize);
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0)
+      return false;
+    pData += written;
+    pSize -= written;
+  }
+  return true;
+}
+
+bool readAll(int pFD, char* pData, size_t pSize) {
+  while (pSize > 0) {
+    ssize_t count = ::read(pFD, pData, pSize);
+    if (count < 0 && errno == EINTR)
+      continue;
+    if (count <= 0)
+      return false;
+    pData += count;
+    pSize -= count;
+  }
+  return true;
+}
+
+bool writeU32(int pFD, uint32_t pValue) {
+  char bytes[4];
+  for (int i = 0; i < 4; ++i)
+    bytes[i] = static_cast<char>((pValue >> (8 * i)) & 0xff);
+  return writeAll(pFD, bytes, sizeof(bytes));
+}
+
+uint32_t decodeU32(const char* pBytes) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i)
+    value |= static_cast<uint32_t>(static_cast<unsigned char>(pBytes[i]))
+             << (8 * i);
+  return value;
+}
+
+bool readU32(int pFD, uint32_t& pValue) {
+  char bytes[4];
+  if (!readAll(pFD, bytes, sizeof(bytes)))
+    return false;
+  pValue = decodeU32(bytes);
+  return true;
+}
+
+bool writeString(int pFD, llvm::StringRef pString) {
+  return writeU32(pFD, pString.size()) &&
+         writeAll(pFD, pString.data(), pString.size());
+}
+
+bool readRequest(int pFD, std::vector<std::string>& pStrings) {
+  // a sane bound keeps a broken client from exhausting the server
+  const uint32_t kMaxSize = 64 * 1024 * 1024;
+  uint32_t count;
+  if (!readU32(pFD, count) || count < 2 || count > kMaxSize)
+    return false;
+  pStrings.resize(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t size;
+    if (!readU32(pFD, size) || size > kMaxSize)
+      return false;
+    pStrings[i].resize(size);
+    if (size != 0 && !readAll(pFD, &pStrings[i][0], size))
+      return false;
+  }
+  return true;
+}
+
+bool fillAddress(const std::string& pSocket, struct sockaddr_un& pAddress) {
+  std::memset(&pAddress, 0x0, sizeof(pAddress));
+  pAddress.sun_family = AF_UNIX;
+  if (pSocket.size() >= sizeof(pAddress.sun_path)) {
+    mcld::errs() << "socket path is too long: " << pSocket << "\n";
+    return false;
+  }
+  std::memcpy(pAddress.sun_path, pSocket.c_str(), pSocket.size() + 1);
+  return true;
+}
+
+/// runChild - link the request in the forked child. Never returns.
+void runChild(std::vector<std::string>& pRequest,
+              int pClient,
+              int pMisses,
+              LinkFunction pLink) {
+  ::dup2(pClient, STDOUT_FILENO);
+  ::dup2(pClient, STDERR_FILENO);
+  ::close(pClient);
+
+  int status = EXIT_FAILURE;
+  if (::chdir(pRequest[0].c_str()) != 0) {
+    mcld::errs() << "cannot change the directory to " << pRequest[0] << "\n";
+  } else {
+    std::vector<char*> argv;
+    for (size_t i = 1; i < pRequest.size(); ++i)
+      argv.push_back(&pRequest[i][0]);
+    argv.push_back(NULL);
+    status = pLink(static_cast<int>(pRequest.size() - 1), argv.data());
+  }
+
+  mcld::outs().flush();
+  mcld::errs().flush();
+  std::fflush(NULL);
+
+  // tell the server which files are worth caching
+  const std::vector<std::string>& misses = InputCache::GetMisses();
+  for (size_t i = 0; i < misses.size(); ++i) {
+    if (!writeAll(pMisses, misses[i].data(), misses[i].size()) ||
+        !writeAll(pMisses, "\n", 1))
+      break;
+  }
+  ::close(pMisses);
+
+  // the static objects belong to the server
+  ::_exit(status);
+}
+
+/// startJob - fork a child for the request on pClient
+bool startJob(int pServer,
+              int pClient,
+              const std::vector<Job>& pJobs,
+              LinkFunction pLink,
+              Job& pJob) {
+  std::vector<std::string> request;
+  if (!readRequest(pClient, request))
+    return false;
+
+  int misses[2];
+  if (::pipe(misses) != 0)
+    return false;
+
+  mcld::outs().flush();
+  mcld::errs().flush();
+  pid_t pid = ::fork();
+  if (pid < 0) {
+    ::close(misses[0]);
+    ::close(misses[1]);
+    return false;
+  }
+
+  if (pid == 0) {
+    ::close(pServer);
+    ::close(misses[0]);
+    for (size_t i = 0; i < pJobs.size(); ++i) {
+      ::close(pJobs[i].client);
+      ::close(pJobs[i].misses);
+    }
+    runChild(request, pClient, misses[1], pLink);
+  }
+
+  ::close(misses[1]);
+  pJob.pid = pid;
+  pJob.client = pClient;
+  pJob.misses = misses[0];
+  return true;
+}
+
+/// finishJob - reply the exit status and cache the files the child read
+void finishJob(Job& pJob) {
+  ::close(pJob.misses);
+
+  int status;
+  while (::waitpid(pJob.pid, &status, 0) < 0 && errno == EINTR) {
+  }
+  uint32_t code = EXIT_FAILURE;
+  if (WIFEXITED(status))
+    code = WEXITSTATUS(status);
+  else if (WIFSIGNALED(status))
+    code = 128 + WTERMSIG(status);
+  writeU32(pJob.client, code);
+  ::close(pJob.client);
+
+  llvm::StringRef paths(pJob.paths);
+  while (!paths.empty()) {
+    std::pair<llvm::StringRef, llvm::StringRef> line = paths.split('\n');
+    if (!line.first.empty())
+      InputCache::Load(line.first);
+    paths = line.second;
+  }
+}
+
+}  // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// Link Server
+//===----------------------------------------------------------------------===//
+int RunLinkServer(const std::string& pSocket,
+                  const std::vector<std::string>& pPreload,
+                  LinkFunction pLink) {
+  struct sockaddr_un address;
+  if (!fillAddress(pSocket, address))
+    return EXIT_FAILURE;
+
+  // a client may go away before its link finishes
+  ::signal(SIGPIPE, SIG_IGN);
+
+  int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  ::unlink(pSocket.c_str());
+  if (server < 0 ||
+      ::bind(server, reinterpret_cast<struct sockaddr*>(&address),
+             sizeof(address)) != 0 ||
+      ::listen(server, SOMAXCONN) != 0) {
+    mcld::errs() << "cannot listen on " << pSocket << ": "
+                 << std::strerror(errno) << "\n";
+    return EXIT_FAILURE;
+  }
+
+  mcld::Initialize();
+  InputCache::Enable(true);
+  for (size_t i = 0; i < pPreload.size(); ++i) {
+    if (!InputCache::Load(pPreload[i]))
+      mcld::errs() << "cannot preload " << pPreload[i] << "\n";
+  }
+
+  std::vector<Job> jobs;
+  while (true) {
+    std::vector<struct pollfd> fds(jobs.size() + 1);
+    fds[0].fd = server;
+    fds[0].events = POLLIN;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      fds[i + 1].fd = jobs[i].misses;
+      fds[i + 1].events = POLLIN;
+    }
+
+    if (::poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      mcld::errs() << "link server: " << std::strerror(errno) << "\n";
+      return EXIT_FAILURE;
+    }
+
+    // collect the finished children from the back, so that the indices of
+    // the remaining jobs still match fds
+    for (size_t i = jobs.size(); i > 0; --i) {
+      if (fds[i].revents == 0)
+        continue;
+      char buffer[4096];
+      ssize_t count = ::read(jobs[i - 1].misses, buffer, sizeof(buffer));
+      if (count > 0) {
+        jobs[i - 1].paths.append(buffer, count);
+      } else if (count == 0 || errno != EINTR) {
+        finishJob(jobs[i - 1]);
+        jobs.erase(jobs.begin() + (i - 1));
+      }
+    }
+
+    if ((fds[0].revents & POLLIN) == 0)
+      continue;
+    int client = ::accept(server, NULL, NULL);
+    if (client < 0)
+      continue;
+    Job job;
+    if (startJob(server, client, jobs, pLink, job))
+      jobs.push_back(job);
+    else
+      ::close(client);
+  }
+  return EXIT_SUCCESS;
+}
+
+//===----------------------------------------------------------------------===//
+// Link Client
+//===----------------------------------------------------------------------===//
+int RunLinkClient(const std::string& pSocket,
+                  const std::vector<std::string>& pArgs) {
+  struct sockaddr_un address;
+  if (!fillAddress(pSocket, address))
+    return EXIT_FAILURE;
+
+  llvm::SmallString<256> cwd;
+  if (llvm::sys::fs::current_path(cwd)) {
+    mcld::errs() << "cannot get the current directory\n";
+    return EXIT_FAILURE;
+  }
+
+  // report a server which goes away instead of dying on SIGPIPE
+  ::signal(SIGPIPE, SIG_IGN);
+
+  int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (server < 0 ||
+      ::connect(server, reinterpret_cast<struct sockaddr*>(&address),
+                sizeof(address)) != 0) {
+    mcld::errs() << "cannot connect to " << pSocket << ": "
+                 << std::strerror(errno) << "\n";
+    return EXIT_FAILURE;
+  }
+
+  bool sent = writeU32(server, pArgs.size() + 1) && writeString(server, cwd);
+  for (size_t i = 0; sent && i < pArgs.size(); ++i)
+    sent = writeString(server, pArgs[i]);
+  if (!sent) {
+    mcld::errs() << "cannot send the link to " << pSocket << "\n";
+    ::close(server);
+    return EXIT_FAILURE;
+  }
+
+  // the last four bytes are the exit status, hold them back from the output
+  std::string pending;
+  char buffer[4096];
+  while (true) {
+    ssize_t count = ::read(server, buffer, sizeof(buffer));
+    if (count < 0 && errno == EINTR)
+      continue;
+    if (count <= 0)
+      break;
+    pending.append(buffer, count);
+    if (pending.size() > 4) {
+      size_t size = pending.size() - 4;
+      writeAll(STDERR_FILENO, pending.data(), size);
+      pending.erase(0, size);
+    }
+  }
+  ::close(server);
+
+  if (pending.size() != 4) {
+    mcld::errs() << "the link server closed the connection\n";
+    return EXIT_FAILURE;
+  }
+  return static_cast<int>(decodeU32(pending.data()));
+}
+
+#else  // !MCLD_ON_UNIX
+
+int RunLinkServer(const std::string& pSocket,
+                  const std::vector<std::string>& pPreload,
+                  LinkFunction pLink) {
+  mcld::errs() << "the link server is not supported on this host\n";
+  return EXIT_FAILURE;
+}
+
+int RunLinkClient(const std::string& pSocket,
+                  const std::vector<std::string>& pArgs) {
+  mcld::errs() << "the link server is not supported on this host\n";
+  return EXIT_FAILURE;
+}
+
+#endif  // MCLD_ON_UNIX
+
+}  // namespace mcld
@@ -0,0 +1,41 @@
+//===- LinkServer.h -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef TOOLS_MCLD_LINKSERVER_H_
+#define TOOLS_MCLD_LINKSERVER_H_
+
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+/// LinkFunction - run the link of a command line and return the exit status
+typedef int (*LinkFunction)(int pArgc, char** pArgv);
+
+/// RunLinkServer - serve the link requests sent to the Unix socket pSocket
+/// until the server is killed.
+///
+/// The server initializes the targets once and keeps the shared objects and
+/// the archives resident in the InputCache. Every request is linked in a
+/// forked child by pLink, so that no state of a link leaks into the next
+/// one. The files a child had to read are loaded into the cache when the
+/// child exits. pPreload are loaded before the first request.
+int RunLinkServer(const std::string& pSocket,
+                  const std::vector<std::string>& pPreload,
+                  LinkFunction pLink);
+
+/// RunLinkClient - send the command line pArgs and the working directory to
+/// the server on pSocket. The output of the link is copied to the standard
+/// error.
+/// @return the exit status of the link
+int RunLinkClient(const std::string& pSocket,
+                  const std::vector<std::string>& pArgs);
+
+}  // namespace mcld
+
+#endif  // TOOLS_MCLD_LINKSERVER_H_
@@ -6,6 +6,8 @@
 // License. See LICENSE.TXT for details.
 //
 //===----------------------------------------------------------------------===//
+#include "LinkServer.h"
+
 #include <mcld/Environment.h>
 #include <mcld/IRBuilder.h>
 #include <mcld/Linker.h>
@@ -32,13 +34,19 @@
 #include <llvm/Option/ArgList.h>
 #include <llvm/Option/OptTable.h>
 #include <llvm/Option/Option.h>
+#include <llvm/Support/Allocator.h>
+#include <llvm/Support/FileSystem.h>
 #include <llvm/Support/ManagedStatic.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
 #include <llvm/Support/Process.h>
 #include <llvm/Support/Signals.h>
 
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include <string>
+#include <vector>
 
 #if defined(HAVE_UNISTD_H)
 #include <unistd.h>
@@ -100,6 +108,8 @@ class Driver {
  private:
   bool TranslateArguments(llvm::opt::InputArgList& args);
 
+  void TranslateReproduceArguments(llvm::opt::InputArgList& args);
+
  private:
   const char* prog_name_;
 
@@ -240,6 +250,120 @@ inline bool ConfigureOutputName(llvm::StringRef output_name,
   return true;
 }
 
+/// RewriteReproducePath - the path of a file in the reproduce archive, which
+/// is its absolute path under the base directory of the archive
+std::string RewriteReproducePath(const std::string& base,
+                                 llvm::StringRef path) {
+  llvm::SmallString<256> absolute(path);
+  llvm::sys::fs::make_absolute(absolute);
+  llvm::StringRef relative = llvm::sys::path::relative_path(absolute);
+  return base + "/" + relative.str();
+}
+
+/// QuoteReproduceArgument - quote an argument for the GNU tokenizer of the
+/// response files
+std::string QuoteReproduceArgument(llvm::StringRef arg) {
+  if (arg.find_first_of(" \t\n\"'\\") == llvm::StringRef::npos)
+    return arg.str();
+  std::string result("\"");
+  for (char c : arg) {
+    if (c == '"' || c == '\\')
+      result.push_back('\\');
+    result.push_back(c);
+  }
+  result.push_back('"');
+  return result;
+}
+
+/// IsResponseSpace - the characters which separate the arguments of a
+/// response file
+bool IsResponseSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/// TokenizeResponseFile - split the NUL-terminated contents of a response
+/// file into arguments, as llvm::cl::TokenizeGNUCommandLine does. An
+/// argument is never longer than its quoted form, so it is unquoted over the
+/// contents and terminated in place, and no argument is copied.
+void TokenizeResponseFile(char* data, size_t size,
+                          llvm::SmallVectorImpl<const char*>& tokens) {
+  char* in = data;
+  char* end = data + size;
+  char* out = data;
+  char* token = data;
+  while (in != end) {
+    // consume runs of whitespace between the arguments
+    if (out == token) {
+      while (in != end && IsResponseSpace(*in))
+        ++in;
+      if (in == end)
+        break;
+      out = token = in;
+    }
+
+    char c = *in++;
+    if (c == '\\' && in != end) {
+      // a backslash escapes the next character
+      *out++ = *in++;
+    } else if (c == '"' || c == '\'') {
+      // a quoted string, in which a backslash escapes the next character
+      while (in != end && *in != c) {
+        if (*in == '\\' && in + 1 != end)
+          ++in;
+        *out++ = *in++;
+      }
+      if (in == end)
+        break;
+      ++in;
+    } else if (IsResponseSpace(c)) {
+      if (out != token) {
+        *out = '\0';
+        tokens.push_back(token);
+      }
+      token = out;
+    } else {
+      *out++ = c;
+    }
+  }
+  if (out != token) {
+    *out = '\0';
+    tokens.push_back(token);
+  }
+}
+
+/// ExpandArgument - append arg to argv, or the arguments of the response file
+/// @file. The contents of a response file are read into allocator once and
+/// tokenized there. A file which cannot be read is left as an argument, and
+/// the response files are nested up to 20 deep.
+void ExpandArgument(const char* arg, llvm::BumpPtrAllocator& allocator,
+                    llvm::SmallVectorImpl<const char*>& argv,
+                    unsigned depth = 0) {
+  if (arg[0] != '@' || depth >= 20) {
+    argv.push_back(arg);
+    return;
+  }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      llvm::MemoryBuffer::getFile(arg + 1);
+  if (!buffer) {
+    argv.push_back(arg);
+    return;
+  }
+
+  llvm::StringRef contents = (*buffer)->getBuffer();
+  if (contents.startswith("\xef\xbb\xbf"))
+    contents = contents.drop_front(3);
+  char* data = allocator.Allocate<char>(contents.size() + 1);
+  memcpy(data, contents.data(), contents.size());
+  data[contents.size()] = '\0';
+
+  llvm::SmallVector<const char*, 0> tokens;
+  TokenizeResponseFile(data, contents.size(), tokens);
+  argv.reserve(argv.size() + tokens.size());
+  for (const char* token : tokens)
+    ExpandArgument(token, allocator, argv, depth + 1);
+}
+
 bool InitializeInputs(mcld::IRBuilder& ir_builder,
     std::vector<std::unique_ptr<mcld::InputAction>>& input_actions) {
   for (auto& action : input_actions) {
@@ -277,6 +401,65 @@ bool Driver::TranslateArguments(llvm::opt::InputArgList& args) {
   // --trace
   config_.options().setTrace(args.hasArg(kOpt_Trace));
 
+  // --trace-buffer-size=N
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_TraceBufferSize)) {
+    llvm::StringRef value = arg->getValue();
+    uint64_t size;
+    if (value.getAsInteger(0, size)) {
+      mcld::errs() << "Invalid value for" << arg->getOption().getPrefixedName()
+                   << ": " << arg->getValue() << "\n";
+      return false;
+    }
+    config_.options().setTraceBufferSize(size);
+  }
+
+  // --time-trace, --time-trace-file=file
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_TimeTraceFile)) {
+    config_.options().setTimeTrace();
+    config_.options().setTimeTraceFile(arg->getValue());
+  } else {
+    config_.options().setTimeTrace(args.hasArg(kOpt_TimeTrace));
+  }
+
+  // --print-stats
+  config_.options().setPrintStats(args.hasArg(kOpt_PrintStats));
+
+  // --print-memory-usage
+  config_.options().setPrintMemoryUsage(args.hasArg(kOpt_PrintMemoryUsage));
+
+  // -M, --print-map
+  config_.options().setPrintMap(args.hasArg(kOpt_PrintMap));
+
+  // -Map=file
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_Map))
+    config_.options().setMapFile(arg->getValue());
+
+  // --size-report=file
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_SizeReport))
+    config_.options().setSizeReportFile(arg->getValue());
+
+  // --dwp=file
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_Dwp))
+    config_.options().setDwpFile(arg->getValue());
+
+  // --reproduce=file.tar
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_Reproduce)) {
+    config_.options().setReproduceFile(arg->getValue());
+    TranslateReproduceArguments(args);
+  }
+
+  // --script-cache=dir
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_ScriptCache))
+    config_.options().setScriptCacheDir(arg->getValue());
+
+  // --dso-cache=dir
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_DSOCache))
+    config_.options().setDSOCacheDir(arg->getValue());
+
+  // --thinlto-cache-dir=dir
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_LTOCacheDir))
+    config_.options().setLTOCacheDir(arg->getValue());
+
   // --verbose=level
   if (llvm::opt::Arg* arg = args.getLastArg(kOpt_Verbose)) {
     llvm::StringRef value = arg->getValue();
@@ -374,6 +557,18 @@ bool Driver::TranslateArguments(llvm::opt::InputArgList& args) {
     config_.targets().setStubGroupSize(size);
   }
 
+  // --stub-reserve=value
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_StubReserve)) {
+    llvm::StringRef value = arg->getValue();
+    int size;
+    if (value.getAsInteger(0, size) || (size < 0)) {
+      mcld::errs() << "Invalid value for" << arg->getOption().getPrefixedName()
+                   << ": " << arg->getValue() << "\n";
+      return false;
+    }
+    config_.targets().setStubReserve(size);
+  }
+
   // --fix-cortex-a53-835769
   config_.targets().setFixCA53Erratum835769(
       args.hasArg(kOpt_FixCA53Erratum835769));
@@ -382,6 +577,12 @@ bool Driver::TranslateArguments(llvm::opt::InputArgList& args) {
   config_.targets().setFixCA53Erratum843419(
       args.hasArg(kOpt_FixCA53Erratum843419));
 
+  // --relax-adrp
+  config_.targets().setRelaxADRP(args.hasArg(kOpt_RelaxADRP));
+
+  // --small-data-by-refs
+  config_.targets().setSmallDataByRefs(args.hasArg(kOpt_SmallDataByRefs));
+
   //===--------------------------------------------------------------------===//
   // Dynamic
   //===--------------------------------------------------------------------===//
@@ -394,6 +595,14 @@ bool Driver::TranslateArguments(llvm::opt::InputArgList& args) {
   // -Bsymbolic
   config_.options().setBsymbolic(args.hasArg(kOpt_Bsymbolic));
 
+  // -Bsymbolic-functions
+  config_.options().setBsymbolicFunctions(
+      args.hasArg(kOpt_BsymbolicFunctions));
+
+  // --dynamic-list=file
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_DynamicList))
+    config_.options().setDynamicList(arg->getValue());
+
   // -Bgroup
   config_.options().setBgroup(args.hasArg(kOpt_Bgroup));
 
@@ -436,6 +645,14 @@ bool Driver::TranslateArguments(llvm::opt::InputArgList& args) {
             .Case("lazy", mcld::ZOption(mcld::ZOption::Lazy))
             .Case("now", mcld::ZOption(mcld::ZOption::Now))
             .Case("origin", mcld::ZOption(mcld::ZOption::Origin))
+            .Case("pack-relative-relocs",
+                  mcld::ZOption(mcld::ZOption::PackRelativeRelocs))
+            .Case("nopack-relative-relocs",
+                  mcld::ZOption(mcld::ZOption::NoPackRelativeRelocs))
+            .Case("hugepage-text", mcld::ZOption(mcld::ZOption::HugePageText))
+            .Case("separate-code", mcld::ZOption(mcld::ZOption::SeparateCode))
+            .Case("noseparate-code",
+                  mcld::ZOption(mcld::ZOption::NoSeparateCode))
             .Default(mcld::ZOption());
 
     if (z_opt.kind() == mcld::ZOption::Unknown) {
@@ -563,6 +780,129 @@ bool Driver::TranslateArguments(llvm::opt::InputArgList& args) {
     }
   }
 
+  // --hash-optimize=goal
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_HashOptimize)) {
+    mcld::GeneralOptions::HashOptimize mode =
+        llvm::StringSwitch<mcld::GeneralOptions::HashOptimize>(arg->getValue())
+            .Case("none", mcld::GeneralOptions::HashOptimize::None)
+            .Case("lookup", mcld::GeneralOptions::HashOptimize::Lookup)
+            .Default(mcld::GeneralOptions::HashOptimize::Unknown);
+    if (mode == mcld::GeneralOptions::HashOptimize::Unknown) {
+      mcld::errs() << "Invalid value for" << arg->getOption().getPrefixedName()
+                   << ": " << arg->getValue();
+      return false;
+    }
+    config_.options().setHashOptimize(mode);
+  }
+
+  // --hash-optimize-budget=N
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_HashOptimizeBudget)) {
+    llvm::StringRef value = arg->getValue();
+    unsigned budget;
+    if (value.getAsInteger(0, budget) || (budget == 0)) {
+      mcld::errs() << "Invalid value for" << arg->getOption().getPrefixedName()
+                   << ": " << arg->getValue();
+      return false;
+    }
+    config_.options().setHashOptimizeBudget(budget);
+  }
+
+  // --build-id, --build-id=style
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_BuildID, kOpt_BuildIDStyle)) {
+    mcld::GeneralOptions::BuildID style = mcld::GeneralOptions::BuildID::Fast;
+    if (arg->getOption().matches(kOpt_BuildIDStyle)) {
+      style =
+          llvm::StringSwitch<mcld::GeneralOptions::BuildID>(arg->getValue())
+              .Case("none", mcld::GeneralOptions::BuildID::None)
+              .Case("fast", mcld::GeneralOptions::BuildID::Fast)
+              .Case("sha1", mcld::GeneralOptions::BuildID::SHA1)
+              .Case("uuid", mcld::GeneralOptions::BuildID::UUID)
+              .Default(mcld::GeneralOptions::BuildID::Unknown);
+      if (style == mcld::GeneralOptions::BuildID::Unknown) {
+        mcld::errs() << "Invalid value for"
+                     << arg->getOption().getPrefixedName() << ": "
+                     << arg->getValue();
+        return false;
+      }
+    }
+    config_.options().setBuildID(style);
+  }
+
+  // --compress-debug-sections=format
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_CompressDebugSections)) {
+    mcld::GeneralOptions::CompressDebugSections format =
+        llvm::StringSwitch<mcld::GeneralOptions::CompressDebugSections>(
+            arg->getValue())
+            .Case("none", mcld::GeneralOptions::CompressDebugSections::None)
+            .Case("zlib", mcld::GeneralOptions::CompressDebugSections::Zlib)
+            .Default(mcld::GeneralOptions::CompressDebugSections::Unknown);
+    if (format == mcld::GeneralOptions::CompressDebugSections::Unknown) {
+      mcld::errs() << "Invalid value for" << arg->getOption().getPrefixedName()
+                   << ": " << arg->getValue();
+      return false;
+    }
+    config_.options().setCompressDebugSections(format);
+  }
+
+  // --gdb-index
+  config_.options().setGdbIndex(args.hasArg(kOpt_GdbIndex));
+
+  // --sort-relocations
+  config_.options().setSortRelocations(args.hasArg(kOpt_SortRelocations));
+
+  // --output-mode=mode
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_OutputMode)) {
+    mcld::GeneralOptions::OutputMode mode =
+        llvm::StringSwitch<mcld::GeneralOptions::OutputMode>(arg->getValue())
+            .Case("mmap", mcld::GeneralOptions::OutputMode::MMap)
+            .Case("stream", mcld::GeneralOptions::OutputMode::Stream)
+            .Default(mcld::GeneralOptions::OutputMode::Unknown);
+    if (mode == mcld::GeneralOptions::OutputMode::Unknown) {
+      mcld::errs() << "Invalid value for" << arg->getOption().getPrefixedName()
+                   << ": " << arg->getValue();
+      return false;
+    }
+    config_.options().setOutputMode(mode);
+  }
+
+  // --fsync-output
+  config_.options().setFsyncOutput(args.hasArg(kOpt_FsyncOutput));
+
+  // --incremental
+  config_.options().setIncremental(args.hasArg(kOpt_Incremental));
+
+  // --pack-dyn-relocs=format
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_PackDynRelocs)) {
+    llvm::StringRef format = arg->getValue();
+    if (format == "none") {
+      config_.options().setPackAndroidRelocs(false);
+      config_.options().setPackRelativeRelocs(false);
+    } else if (format == "android") {
+      config_.options().setPackAndroidRelocs(true);
+    } else if (format == "relr") {
+      config_.options().setPackRelativeRelocs(true);
+    } else if (format == "android+relr") {
+      config_.options().setPackAndroidRelocs(true);
+      config_.options().setPackRelativeRelocs(true);
+    } else {
+      mcld::errs() << "Invalid value for" << arg->getOption().getPrefixedName()
+                   << ": " << arg->getValue();
+      return false;
+    }
+  }
+
+  // --prelink-base=addr
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_PrelinkBase)) {
+    llvm::StringRef value = arg->getValue();
+    uint64_t addr = 0;
+    if (value.getAsInteger(0, addr)) {
+      mcld::errs() << "Invalid value for" << arg->getOption().getPrefixedName()
+                   << ": " << arg->getValue() << "\n";
+      return false;
+    }
+    config_.options().setPrelinkBase(addr);
+  }
+
   // --[no]-export-dynamic
   if (llvm::opt::Arg* arg = args.getLastArg(kOpt_ExportDynamic,
                                               kOpt_NoExportDynamic)) {
@@ -573,6 +913,10 @@ bool Driver::TranslateArguments(llvm::opt::InputArgList& args) {
     }
   }
 
+  // --version-script=file
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_VersionScript))
+    config_.options().setVersionScript(arg->getValue());
+
   // --no-warn-mismatch
   config_.options().setWarnMismatch(!args.hasArg(kOpt_NoWarnMismatch));
 
@@ -619,6 +963,25 @@ bool Driver::TranslateArguments(llvm::opt::InputArgList& args) {
   // -d/-dc/-dp
   config_.options().setDefineCommon(args.hasArg(kOpt_DefineCommon));
 
+  // --sort-common[=ascending|descending]
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_SortCommon,
+                                              kOpt_SortCommonEq)) {
+    typedef mcld::GeneralOptions::SortCommon SortCommon;
+    SortCommon order = SortCommon::Descending;
+    if (arg->getOption().matches(kOpt_SortCommonEq)) {
+      order = llvm::StringSwitch<SortCommon>(arg->getValue())
+                  .Case("ascending", SortCommon::Ascending)
+                  .Case("descending", SortCommon::Descending)
+                  .Default(SortCommon::Unknown);
+    }
+    if (order == SortCommon::Unknown) {
+      mcld::errs() << "Invalid value for" << arg->getOption().getPrefixedName()
+                   << ": " << arg->getValue() << "\n";
+      return false;
+    }
+    config_.options().setSortCommon(order);
+  }
+
   // -u symbol
   for (llvm::opt::Arg* arg : args.filtered(kOpt_Undefined)) {
     config_.options().getUndefSymList().push_back(arg->getValue());
@@ -765,6 +1128,9 @@ bool Driver::TranslateArguments(llvm::opt::InputArgList& args) {
     }
   }
 
+  // --split-text-for-gc
+  config_.options().setSplitTextForGC(args.hasArg(kOpt_SplitTextForGC));
+
   // --[no-]ld-generated-unwind-info
   if (llvm::opt::Arg* arg = args.getLastArg(kOpt_LDGeneratedUnwindInfo,
                                               kOpt_NoLDGeneratedUnwindInfo)) {
@@ -813,6 +1179,43 @@ bool Driver::TranslateArguments(llvm::opt::InputArgList& args) {
     }
   }
 
+  // --symbol-ordering-file=file
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_SymbolOrderingFile))
+    config_.options().setSymbolOrderingFile(arg->getValue());
+
+  // --call-graph-ordering-file=file, --[no-]call-graph-profile-sort
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_CallGraphOrderingFile))
+    config_.options().setCallGraphOrderingFile(arg->getValue());
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_CallGraphProfileSort,
+                                            kOpt_NoCallGraphProfileSort)) {
+    config_.options().setCallGraphProfileSort(
+        arg->getOption().matches(kOpt_CallGraphProfileSort));
+  }
+
+  // --data-ordering-file=file, --separate-written-data
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_DataOrderingFile))
+    config_.options().setDataOrderingFile(arg->getValue());
+  if (args.hasArg(kOpt_SeparateWrittenData))
+    config_.options().setSeparateWrittenData(true);
+
+  // --lazy-dso-symbols
+  config_.options().setLazyDSOSymbols(args.hasArg(kOpt_LazyDSOSymbols));
+
+  // --threads=N
+  if (llvm::opt::Arg* arg = args.getLastArg(kOpt_Threads)) {
+    llvm::StringRef value = arg->getValue();
+    int num;
+    if (value.getAsInteger(0, num) || (num <= 0)) {
+      mcld::errs() << "Invalid value for" << arg->getOption().getPrefixedName()
+                   << ": " << arg->getValue() << "\n";
+      return false;
+    }
+    config_.options().setNumThreads(num);
+  }
+
+  // --verify-determinism
+  config_.options().setVerifyDeterminism(args.hasArg(kOpt_VerifyDeterminism));
+
   //===--------------------------------------------------------------------===//
   // Positional
   //===--------------------------------------------------------------------===//
@@ -825,6 +1228,9 @@ bool Driver::TranslateArguments(llvm::opt::InputArgList& args) {
   Action action;
   actions.reserve(32);
 
+  // the inputs in a row share one action, which the others end
+  mcld::InputFilesAction* files = nullptr;
+
   for (llvm::opt::Arg* arg : args) {
     const unsigned index = arg->getIndex();
 
@@ -953,16 +1359,11 @@ bool Driver::TranslateArguments(llvm::opt::InputArgList& args) {
       }
 
       case kOpt_INPUT: {
-        action.reset(new mcld::InputFileAction(index, arg->getValue()));
-        actions.push_back(std::move(action));
-
-        action.reset(new mcld::ContextAction(index));
-        actions.push_back(std::move(action));
-
-        action.reset(new mcld::MemoryAreaAction(index,
-                                                mcld::FileHandle::ReadOnly));
-        actions.push_back(std::move(action));
-
+        if (files == nullptr || actions.back().get() != files) {
+          files = new mcld::InputFilesAction(index);
+          actions.push_back(Action(files));
+        }
+        files->append(arg->getValue());
         ++input_num;
         break;
       }
@@ -1000,13 +1401,89 @@ bool Driver::TranslateArguments(llvm::opt::InputArgList& args) {
   return true;
 }
 
+/// TranslateReproduceArguments - the arguments to replay the link from the
+/// extracted reproduce archive. The inputs, the scripts, the search
+/// directories and the sysroot refer to the copies in the archive, and the
+/// other arguments are kept.
+void Driver::TranslateReproduceArguments(llvm::opt::InputArgList& args) {
+  std::string base = llvm::sys::path::stem(
+      config_.options().getReproduceFile()).str();
+  std::vector<std::string>& result = config_.options().getReproduceArgs();
+
+  for (llvm::opt::Arg* arg : args) {
+    switch (arg->getOption().getID()) {
+      case kOpt_Reproduce:
+      case kOpt_ScriptCache:
+      case kOpt_DSOCache:
+      case kOpt_LTOCacheDir:
+        break;
+      case kOpt_INPUT:
+        result.push_back(RewriteReproducePath(base, arg->getValue()));
+        break;
+      case kOpt_Script:
+        result.push_back("-T");
+        result.push_back(RewriteReproducePath(base, arg->getValue()));
+        break;
+      case kOpt_LibraryPath:
+        result.push_back("-L" + RewriteReproducePath(base, arg->getValue()));
+        break;
+      case kOpt_Sysroot:
+        result.push_back("--sysroot=" +
+                         RewriteReproducePath(base, arg->getValue()));
+        break;
+      case kOpt_SymbolOrderingFile:
+        result.push_back("--symbol-ordering-file=" +
+                         RewriteReproducePath(base, arg->getValue()));
+        break;
+      case kOpt_CallGraphOrderingFile:
+        result.push_back("--call-graph-ordering-file=" +
+                         RewriteReproducePath(base, arg->getValue()));
+        break;
+      case kOpt_DataOrderingFile:
+        result.push_back("--data-ordering-file=" +
+                         RewriteReproducePath(base, arg->getValue()));
+        break;
+      case kOpt_VersionScript:
+        result.push_back("--version-script=" +
+                         RewriteReproducePath(base, arg->getValue()));
+        break;
+      case kOpt_DynamicList:
+        result.push_back("--dynamic-list=" +
+                         RewriteReproducePath(base, arg->getValue()));
+        break;
+      default: {
+        llvm::opt::ArgStringList rendered;
+        arg->render(args, rendered);
+        for (const char* value : rendered)
+          result.push_back(value);
+        break;
+      }
+    }
+  }
+
+  for (std::string& value : result)
+    value = QuoteReproduceArgument(value);
+}
+
 std::unique_ptr<Driver> Driver::Create(llvm::ArrayRef<const char*> argv) {
+  // Expand @file, which is how a reproduce archive is replayed and how the
+  // build systems pass huge command lines. The strings are referred by the
+  // arguments, so they live as long as the driver.
+  static llvm::BumpPtrAllocator allocator;
+  llvm::SmallVector<const char*, 64> expanded;
+  expanded.reserve(argv.size());
+  if (!argv.empty())
+    expanded.push_back(argv[0]);
+  for (size_t i = 1; i < argv.size(); ++i)
+    ExpandArgument(argv[i], allocator, expanded);
+
   // Parse command line options.
   OptTable opt_table;
   unsigned missing_arg_idx;
   unsigned missing_arg_count;
-  llvm::opt::InputArgList args =
-      opt_table.ParseArgs(argv.slice(1), missing_arg_idx, missing_arg_count);
+  llvm::opt::InputArgList args = opt_table.ParseArgs(
+      llvm::makeArrayRef(expanded).slice(1), missing_arg_idx,
+      missing_arg_count);
   if (missing_arg_count > 0) {
     mcld::errs() << "Argument to '" << args.getArgString(missing_arg_idx)
                  << "' is missing (expected " << missing_arg_count
@@ -1044,6 +1521,15 @@ bool Driver::Run() {
     return false;
   }
 
+  if (config_.options().verifyDeterminism()) {
+    if (!linker_.verifyDeterminism(module_, ir_builder_, module_.name())) {
+      mcld::errs() << "Failed to verify the determinism of the link!\n";
+      return false;
+    }
+    mcld::Finalize();
+    return true;
+  }
+
   if (!linker_.link(module_, ir_builder_)) {
     mcld::errs() << "Failed to link objects!\n";
     return false;
@@ -1060,7 +1546,8 @@ bool Driver::Run() {
 
 }  // anonymous namespace
 
-int main(int argc, char** argv) {
+/// Link - link the command line. This is also the link of a server child.
+static int Link(int argc, char** argv) {
   std::unique_ptr<Driver> driver =
       Driver::Create(llvm::makeArrayRef(argv, argc));
 
@@ -1070,3 +1557,27 @@ int main(int argc, char** argv) {
     return EXIT_SUCCESS;
   }
 }
+
+int main(int argc, char** argv) {
+  // --server and --connect are handled before the command line is parsed,
+  // so that the client forwards the rest of it untouched.
+  std::string server, connect;
+  std::vector<std::string> preload, args;
+  for (int i = 0; i < argc; ++i) {
+    llvm::StringRef arg(argv[i]);
+    if (arg.startswith("--server="))
+      server = arg.substr(std::strlen("--server=")).str();
+    else if (arg.startswith("--server-preload="))
+      preload.push_back(arg.substr(std::strlen("--server-preload=")).str());
+    else if (arg.startswith("--connect="))
+      connect = arg.substr(std::strlen("--connect=")).str();
+    else
+      args.push_back(arg.str());
+  }
+
+  if (!server.empty())
+    return mcld::RunLinkServer(server, preload, Link);
+  if (!connect.empty())
+    return mcld::RunLinkClient(connect, args);
+  return Link(argc, argv);
+}
@@ -0,0 +1,97 @@
+//===- CallGraphSortTest.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/CallGraphSort.h"
+#include "mcld/LD/LDSection.h"
+#include "CallGraphSortTest.h"
+
+#include <llvm/Support/ELF.h>
+
+#include <vector>
+
+using namespace mcld;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+CallGraphSortTest::CallGraphSortTest() {
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+CallGraphSortTest::~CallGraphSortTest() {
+}
+
+// SetUp() will be called immediately before each test.
+void CallGraphSortTest::SetUp() {
+}
+
+// TearDown() will be called immediately after each test.
+void CallGraphSortTest::TearDown() {
+}
+
+static LDSection* createText(const char* pName, uint64_t pSize) {
+  return LDSection::Create(pName,
+                           LDFileFormat::TEXT,
+                           llvm::ELF::SHT_PROGBITS,
+                           llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_EXECINSTR,
+                           pSize);
+}
+
+//==========================================================================//
+// Testcases
+//
+TEST_F(CallGraphSortTest, dense_cluster_first) {
+  LDSection* a = createText(".text.a", 16);
+  LDSection* b = createText(".text.b", 16);
+  LDSection* c = createText(".text.c", 16);
+  LDSection* d = createText(".text.d", 16);
+
+  CallGraphSort graph;
+  graph.addEdge(*a, *b, 50);
+  graph.addEdge(*c, *d, 100);
+
+  std::vector<const LDSection*> order;
+  graph.sort(order);
+  ASSERT_EQ(4u, order.size());
+  ASSERT_TRUE(order[0] == c);
+  ASSERT_TRUE(order[1] == d);
+  ASSERT_TRUE(order[2] == a);
+  ASSERT_TRUE(order[3] == b);
+}
+
+TEST_F(CallGraphSortTest, callee_follows_caller) {
+  LDSection* main = createText(".text.main", 64);
+  LDSection* init = createText(".text.init", 16);
+  LDSection* work = createText(".text.work", 16);
+
+  CallGraphSort graph;
+  graph.addEdge(*main, *init, 10);
+  graph.addEdge(*main, *work, 1000);
+  graph.addEdge(*work, *init, 20);
+
+  std::vector<const LDSection*> order;
+  graph.sort(order);
+  ASSERT_EQ(3u, order.size());
+  ASSERT_TRUE(order[0] == main);
+  ASSERT_TRUE(order[1] == work);
+  ASSERT_TRUE(order[2] == init);
+}
+
+TEST_F(CallGraphSortTest, large_cluster) {
+  LDSection* big = createText(".text.big", 1024 * 1024);
+  LDSection* hot = createText(".text.hot", 16);
+
+  CallGraphSort graph;
+  graph.addEdge(*big, *hot, 100);
+
+  // the callee is not merged behind a megabyte of code
+  std::vector<const LDSection*> order;
+  graph.sort(order);
+  ASSERT_EQ(2u, order.size());
+  ASSERT_TRUE(order[0] == hot);
+  ASSERT_TRUE(order[1] == big);
+}
@@ -0,0 +1,96 @@
+//===- CompressedSectionTest.cpp ------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/CompressedSection.h"
+#include "mcld/LinkerConfig.h"
+#include "mcld/Fragment/RegionFragment.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/LD/SectionData.h"
+#include "mcld/Support/ELF.h"
+#include "mcld/Support/ThreadPool.h"
+#include "CompressedSectionTest.h"
+
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/ELF.h>
+
+#include <zlib.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace mcld;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+CompressedSectionTest::CompressedSectionTest() {
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+CompressedSectionTest::~CompressedSectionTest() {
+}
+
+// SetUp() will be called immediately before each test.
+void CompressedSectionTest::SetUp() {
+}
+
+// TearDown() will be called immediately after each test.
+void CompressedSectionTest::TearDown() {
+}
+
+//==========================================================================//
+// Testcases
+//
+TEST_F(CompressedSectionTest, round_trip) {
+  LinkerConfig config("x86_64-linux-gnu");
+  config.targets().setEndian(TargetOptions::Little);
+  config.targets().setBitClass(64);
+
+  LDSection* debug_info = LDSection::Create(".debug_info",
+                                            LDFileFormat::Debug,
+                                            llvm::ELF::SHT_PROGBITS,
+                                            0x0);
+  debug_info->setAlign(1);
+
+  // more than two chunks, so that the deflate streams are concatenated
+  std::vector<uint8_t> content(5 << 19);
+  for (size_t i = 0; i < content.size(); ++i)
+    content[i] = static_cast<uint8_t>((i * 7) ^ (i >> 11));
+  debug_info->setSize(content.size());
+
+  ThreadPool pool(4);
+  CompressedSection compressed(*debug_info, config);
+  compressed.compress(content, pool);
+  ASSERT_TRUE(content.size() == compressed.getUncompressedSize());
+  ASSERT_TRUE((debug_info->flag() & ELF::SHF_COMPRESSED) != 0);
+  ASSERT_TRUE(8 == debug_info->align());
+
+  const RegionFragment& frag =
+      llvm::cast<RegionFragment>(debug_info->getSectionData()->front());
+  ASSERT_TRUE(debug_info->size() == frag.size());
+  const uint8_t* data =
+      reinterpret_cast<const uint8_t*>(frag.getRegion().data());
+
+  // Elf64_Chdr
+  uint32_t type;
+  uint64_t size, align;
+  std::memcpy(&type, data, 4);
+  std::memcpy(&size, data + 8, 8);
+  std::memcpy(&align, data + 16, 8);
+  ASSERT_TRUE(ELF::ELFCOMPRESS_ZLIB == type);
+  ASSERT_TRUE(content.size() == size);
+  ASSERT_TRUE(1 == align);
+
+  std::vector<uint8_t> result(content.size());
+  uLongf result_size = result.size();
+  ASSERT_TRUE(Z_OK == uncompress(result.data(), &result_size, data + 24,
+                                 frag.size() - 24));
+  ASSERT_TRUE(content.size() == result_size);
+  ASSERT_TRUE(content == result);
+
+  LDSection::Destroy(debug_info);
+}
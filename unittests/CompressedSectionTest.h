@@ -0,0 +1,38 @@
+//===- CompressedSectionTest.h --------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_COMPRESSED_SECTION_TEST_H
+#define MCLD_COMPRESSED_SECTION_TEST_H
+
+#include <gtest.h>
+
+namespace mcldtest {
+
+/** \class CompressedSectionTest
+ *  \brief Testcase for compressing debug sections in CompressedSection
+ *
+ *  \see CompressedSection
+ */
+class CompressedSectionTest : public ::testing::Test {
+ public:
+  // Constructor can do set-up work for all test here.
+  CompressedSectionTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~CompressedSectionTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+};
+
+}  // namespace of mcldtest
+
+#endif
@@ -144,6 +144,27 @@ TEST_F(ELFReaderTest, read_symbol_and_rela) {
   ASSERT_EQ(static_cast<mcld::Relocation::Address>(-0x4), rReloc->addend());
 }
 
+TEST_F(ELFReaderTest, parse_symbols_then_add) {
+  ASSERT_TRUE(m_pInput->hasMemArea());
+  ASSERT_TRUE(m_pInput->hasContext());
+  m_pInput->setType(Input::Object);
+
+  // -- parsing only stages the symbols
+  ObjectReader::SymbolStage stage;
+  ASSERT_TRUE(m_pELFObjReader->parseSymbols(*m_pInput, stage));
+  ASSERT_EQ(10u, stage.size());
+  ASSERT_EQ("hello.c", stage[0].name);
+  ASSERT_EQ("puts", stage[9].name);
+  ASSERT_EQ(ResolveInfo::Undefined, stage[9].desc);
+  ASSERT_TRUE(NULL == m_pInput->context()->getSymbol(1));
+
+  // -- adding creates the LDSymbols in symbol table order
+  ASSERT_TRUE(m_pELFObjReader->addSymbols(*m_pInput, stage));
+  ASSERT_EQ("hello.c", std::string(m_pInput->context()->getSymbol(1)->name()));
+  ASSERT_EQ("puts", std::string(m_pInput->context()->getSymbol(10)->name()));
+  ASSERT_TRUE(NULL == m_pInput->context()->getSymbol(11));
+}
+
 TEST_F(ELFReaderTest, read_regular_sections) {
   ASSERT_TRUE(m_pELFObjReader->readSections(*m_pInput));
 }
@@ -0,0 +1,252 @@
+//===- FileOutputBufferTest.cpp -------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Support/FileOutputBuffer.h"
+#include "mcld/Support/FileHandle.h"
+#include "mcld/Support/Path.h"
+#include "FileOutputBufferTest.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace mcld;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+FileOutputBufferTest::FileOutputBufferTest() {
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+FileOutputBufferTest::~FileOutputBufferTest() {
+}
+
+// SetUp() will be called immediately before each test.
+void FileOutputBufferTest::SetUp() {
+}
+
+// TearDown() will be called immediately after each test.
+void FileOutputBufferTest::TearDown() {
+}
+
+//==========================================================================//
+// Testcases
+//
+TEST_F(FileOutputBufferTest, stream) {
+  char path[] = "/tmp/mcld-output-XXXXXX";
+  int fd = ::mkstemp(path);
+  ASSERT_TRUE(fd >= 0);
+
+  FileHandle file;
+  ASSERT_TRUE(file.delegate(fd, FileHandle::ReadWrite));
+
+  const size_t size = 3 << 20;
+  std::unique_ptr<FileOutputBuffer> output;
+  ASSERT_FALSE(FileOutputBuffer::create(file, size, output,
+                                        FileOutputBuffer::Stream));
+  ASSERT_TRUE(size == output->getBufferSize());
+
+  // flush the middle, and leave both ends to commit
+  uint8_t* data = output->getBufferStart();
+  for (size_t i = 0; i < size; ++i)
+    data[i] = static_cast<uint8_t>(i ^ (i >> 9));
+  output->flush(1 << 20, 1 << 20);
+  std::vector<uint8_t> expected(data, data + size);
+  ASSERT_FALSE(output->commit());
+  output.reset();
+
+  std::vector<uint8_t> result(size);
+  ASSERT_TRUE(file.read(result.data(), 0, size));
+  ASSERT_TRUE(expected == result);
+
+  ASSERT_TRUE(file.close());
+  ::close(fd);
+  ::unlink(path);
+}
+
+TEST_F(FileOutputBufferTest, sparse) {
+  char path[] = "/tmp/mcld-output-XXXXXX";
+  int fd = ::mkstemp(path);
+  ASSERT_TRUE(fd >= 0);
+
+  FileHandle file;
+  ASSERT_TRUE(file.delegate(fd, FileHandle::ReadWrite));
+
+  // the new file is empty, so the zero blocks are not written
+  const size_t size = 1 << 20;
+  std::unique_ptr<FileOutputBuffer> output;
+  ASSERT_FALSE(FileOutputBuffer::create(file, size, output,
+                                        FileOutputBuffer::Stream));
+  ASSERT_TRUE(output->isZeroed());
+
+  uint8_t* data = output->getBufferStart();
+  std::memset(data + 100, 0xaa, 100);
+  data[(512 << 10) + 1] = 0x55;
+  data[size - 1] = 0x33;
+  std::vector<uint8_t> expected(data, data + size);
+  output->flush(0, 256 << 10);
+  ASSERT_FALSE(output->commit());
+  output.reset();
+
+  std::vector<uint8_t> result(size, 0xff);
+  ASSERT_TRUE(file.read(result.data(), 0, size));
+  ASSERT_TRUE(expected == result);
+
+  ASSERT_TRUE(file.close());
+  ::close(fd);
+  ::unlink(path);
+}
+
+TEST_F(FileOutputBufferTest, mmap_on_old_file) {
+  char path[] = "/tmp/mcld-output-XXXXXX";
+  int fd = ::mkstemp(path);
+  ASSERT_TRUE(fd >= 0);
+  ASSERT_TRUE(4 == ::write(fd, "\x7f" "ELF", 4));
+
+  FileHandle file;
+  ASSERT_TRUE(file.delegate(fd, FileHandle::ReadWrite));
+
+  // the old bytes are still there, so the zeros must be written
+  std::unique_ptr<FileOutputBuffer> output;
+  ASSERT_FALSE(FileOutputBuffer::create(file, 4096, output));
+  ASSERT_FALSE(output->isZeroed());
+  output.reset();
+
+  ASSERT_TRUE(file.close());
+  ::close(fd);
+  ::unlink(path);
+}
+
+TEST_F(FileOutputBufferTest, copy_file) {
+  char input_path[] = "/tmp/mcld-input-XXXXXX";
+  int input_fd = ::mkstemp(input_path);
+  ASSERT_TRUE(input_fd >= 0);
+  const size_t size = 64 << 10;
+  std::vector<uint8_t> expected(size);
+  for (size_t i = 0; i < size; ++i)
+    expected[i] = static_cast<uint8_t>(i ^ (i >> 9));
+  ASSERT_TRUE(size == (size_t)::write(input_fd, expected.data(), size));
+  ::close(input_fd);
+
+  char path[] = "/tmp/mcld-output-XXXXXX";
+  int fd = ::mkstemp(path);
+  ASSERT_TRUE(fd >= 0);
+  FileHandle file;
+  ASSERT_TRUE(file.delegate(fd, FileHandle::ReadWrite));
+
+  // the copied bytes are seen through the mapping; nothing is copied past
+  // the end of the output
+  std::unique_ptr<FileOutputBuffer> output;
+  ASSERT_FALSE(FileOutputBuffer::create(file, 2 * size, output));
+  ASSERT_TRUE(output->canCopyFile());
+  ASSERT_FALSE(output->copyFile(input_path, 0, size + 1, size));
+  if (output->copyFile(input_path, 0, size, size)) {
+    ASSERT_TRUE(std::memcmp(output->getBufferStart() + size,
+                            expected.data(), size) == 0);
+  }
+  ASSERT_FALSE(output->commit());
+  output.reset();
+
+  ASSERT_TRUE(file.close());
+  ::close(fd);
+  ::unlink(path);
+  ::unlink(input_path);
+}
+
+TEST_F(FileOutputBufferTest, patch) {
+  char path[] = "/tmp/mcld-output-XXXXXX";
+  int fd = ::mkstemp(path);
+  ASSERT_TRUE(fd >= 0);
+
+  // the old output
+  const size_t size = 1 << 20;
+  std::vector<uint8_t> expected(size);
+  for (size_t i = 0; i < size; ++i)
+    expected[i] = static_cast<uint8_t>(i ^ (i >> 9));
+  ASSERT_TRUE(size == (size_t)::write(fd, expected.data(), size));
+
+  FileHandle file;
+  ASSERT_TRUE(file.delegate(fd, FileHandle::ReadWrite));
+
+  std::unique_ptr<FileOutputBuffer> output;
+  ASSERT_FALSE(FileOutputBuffer::create(file, size, output,
+                                        FileOutputBuffer::Patch));
+
+  // change two bytes in different blocks
+  std::memcpy(output->getBufferStart(), expected.data(), size);
+  output->getBufferStart()[10] ^= 0xff;
+  output->getBufferStart()[size - 1] ^= 0xff;
+  expected[10] ^= 0xff;
+  expected[size - 1] ^= 0xff;
+  ASSERT_FALSE(output->commit());
+  ASSERT_TRUE((128u << 10) == output->getPatchedSize());
+  output.reset();
+
+  std::vector<uint8_t> result(size);
+  ASSERT_TRUE(file.read(result.data(), 0, size));
+  ASSERT_TRUE(expected == result);
+
+  ASSERT_TRUE(file.close());
+  ::close(fd);
+  ::unlink(path);
+}
+
+TEST_F(FileOutputBufferTest, restore) {
+  char path[] = "/tmp/mcld-output-XXXXXX";
+  int fd = ::mkstemp(path);
+  ASSERT_TRUE(fd >= 0);
+
+  // the old output
+  const size_t size = 1 << 20;
+  std::vector<uint8_t> expected(size);
+  for (size_t i = 0; i < size; ++i)
+    expected[i] = static_cast<uint8_t>(i ^ (i >> 9));
+  ASSERT_TRUE(size == (size_t)::write(fd, expected.data(), size));
+
+  FileHandle file;
+  ASSERT_TRUE(file.delegate(fd, FileHandle::ReadWrite));
+
+  std::unique_ptr<FileOutputBuffer> output;
+  ASSERT_FALSE(FileOutputBuffer::create(file, size, output,
+                                        FileOutputBuffer::Patch));
+
+  // read a range of the old bytes back, and nothing past the end
+  std::memset(output->getBufferStart(), 0x0, size);
+  ASSERT_TRUE(output->restore(4096, 8192));
+  ASSERT_FALSE(output->restore(size - 1, 2));
+  ASSERT_TRUE(std::memcmp(output->getBufferStart() + 4096,
+                          expected.data() + 4096, 8192) == 0);
+  ASSERT_TRUE(output->getBufferStart()[4095] == 0x0);
+  ASSERT_TRUE(output->getBufferStart()[4096 + 8192] == 0x0);
+  output.reset();
+
+  ASSERT_TRUE(file.close());
+  ::close(fd);
+  ::unlink(path);
+}
+
+TEST_F(FileOutputBufferTest, memory) {
+  std::vector<uint8_t> memory(4096, 0x0);
+  std::unique_ptr<FileOutputBuffer> output;
+  ASSERT_FALSE(FileOutputBuffer::create(memory.data(), memory.size(), output));
+  ASSERT_TRUE(memory.data() == output->getBufferStart());
+  ASSERT_TRUE(memory.size() == output->getBufferSize());
+  ASSERT_TRUE(output->getPath().empty());
+
+  // the writes go to the memory of the caller, which outlives the buffer
+  MemoryRegion region = output->request(100, 4);
+  ASSERT_TRUE(4 == region.size());
+  std::memcpy(region.begin(), "\x7f" "ELF", 4);
+  ASSERT_FALSE(output->restore(0, 4));
+  ASSERT_FALSE(output->commit());
+  output.reset();
+  ASSERT_TRUE(std::memcmp(memory.data() + 100, "\x7f" "ELF", 4) == 0);
+}
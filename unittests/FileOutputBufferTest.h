@@ -0,0 +1,38 @@
+//===- FileOutputBufferTest.h ---------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_FILE_OUTPUT_BUFFER_TEST_H
+#define MCLD_FILE_OUTPUT_BUFFER_TEST_H
+
+#include <gtest.h>
+
+namespace mcldtest {
+
+/** \class FileOutputBufferTest
+ *  \brief Testcase for the output modes of FileOutputBuffer
+ *
+ *  \see FileOutputBuffer
+ */
+class FileOutputBufferTest : public ::testing::Test {
+ public:
+  // Constructor can do set-up work for all test here.
+  FileOutputBufferTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~FileOutputBufferTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+};
+
+}  // namespace of mcldtest
+
+#endif
@@ -16,6 +16,8 @@
 #include "mcld/Support/Path.h"
 #include <llvm/ADT/StringRef.h>
 
+#include <string>
+
 using namespace mcld;
 using namespace mcld::sys::fs;
 using namespace mcldtest;
@@ -67,3 +69,20 @@ TEST_F(FragmentRefTest, ) {
   delete frag;
   delete areaFactory;
 }
+
+TEST_F(FragmentRefTest, compact_offset) {
+#if MCLD_COMPACT_FRAGMENT_REF
+  ASSERT_EQ(12u, sizeof(FragmentRef));
+#endif
+  std::string content(64, 'x');
+  RegionFragment* frag = new RegionFragment(llvm::StringRef(content));
+  FragmentRef* ref = FragmentRef::Create(*frag, 0x30);
+  ASSERT_EQ(frag, ref->frag());
+  ASSERT_TRUE(0x30 == ref->offset());
+  ASSERT_TRUE(0x30 == ref->getOutputOffset());
+
+  ref->assign(*frag, 0x3f);
+  ASSERT_TRUE(0x3f == ref->offset());
+
+  delete frag;
+}
@@ -65,3 +65,13 @@ TEST_F(FragmentTest, Fragment_trivial_function) {
   LDSection::Destroy(test);
   //  SectionData::Destroy(s);
 }
+
+TEST_F(FragmentTest, Fragment_storage_reuse) {
+  Fragment* f = new Fragment(Fragment::Alignment);
+  void* storage = f;
+  delete f;
+
+  Fragment* g = new Fragment(Fragment::Region);
+  EXPECT_TRUE(storage == g);
+  delete g;
+}
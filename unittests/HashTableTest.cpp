@@ -10,6 +10,10 @@
 #include "HashTableTest.h"
 #include "mcld/ADT/HashEntry.h"
 #include "mcld/ADT/HashTable.h"
+#include "mcld/ADT/StringEntry.h"
+#include "mcld/ADT/StringHash.h"
+#include "mcld/LD/ResolveInfo.h"
+#include "mcld/LD/ResolveInfoFactory.h"
 #include <cstdlib>
 
 using namespace std;
@@ -80,7 +84,7 @@ TEST_F(HashTableTest, ptr_entry) {
 TEST_F(HashTableTest, constructor) {
   typedef HashEntry<int, int, IntCompare> HashEntryType;
   HashTable<HashEntryType, IntHash, EntryFactory<HashEntryType> > hashTable(16);
-  EXPECT_TRUE(17 == hashTable.numOfBuckets());
+  EXPECT_TRUE(32 == hashTable.numOfBuckets());
   EXPECT_TRUE(hashTable.empty());
   EXPECT_TRUE(0 == hashTable.numOfEntries());
 }
@@ -122,7 +126,7 @@ TEST_F(HashTableTest, alloc100) {
 
   EXPECT_FALSE(hashTable->empty());
   EXPECT_TRUE(100 == hashTable->numOfEntries());
-  EXPECT_TRUE(197 == hashTable->numOfBuckets());
+  EXPECT_TRUE(256 == hashTable->numOfBuckets());
   delete hashTable;
 }
 
@@ -205,7 +209,7 @@ TEST_F(HashTableTest, tombstone) {
     hashTable->insert(key, exist);
   }
   EXPECT_TRUE(100 == hashTable->numOfEntries());
-  EXPECT_TRUE(197 == hashTable->numOfBuckets());
+  EXPECT_TRUE(256 == hashTable->numOfBuckets());
 
   delete hashTable;
 }
@@ -297,7 +301,7 @@ TEST_F(HashTableTest, chain_iterator_list) {
     entry->setValue(key);
   }
   ASSERT_TRUE(16 == hashTable->numOfEntries());
-  ASSERT_TRUE(37 == hashTable->numOfBuckets());
+  ASSERT_TRUE(32 == hashTable->numOfBuckets());
 
   unsigned int key = 0;
   int count = 0;
@@ -308,3 +312,110 @@ TEST_F(HashTableTest, chain_iterator_list) {
   ASSERT_EQ(16, count);
   delete hashTable;
 }
+
+struct LastBucketHash {
+  size_t operator()(int pKey) const { return 31; }
+};
+
+TEST_F(HashTableTest, probe_wrap_around) {
+  typedef HashEntry<int, int, IntCompare> HashEntryType;
+  typedef HashTable<HashEntryType, LastBucketHash, EntryFactory<HashEntryType> >
+      HashTableTy;
+  HashTableTy* hashTable = new HashTableTy(16);
+  ASSERT_TRUE(32 == hashTable->numOfBuckets());
+
+  // all keys start probing at the last bucket and wrap around to the front
+  bool exist;
+  for (int key = 0; key < 20; ++key) {
+    hashTable->insert(key, exist);
+    ASSERT_FALSE(exist);
+  }
+  ASSERT_TRUE(32 == hashTable->numOfBuckets());
+
+  for (int key = 0; key < 20; key += 2)
+    EXPECT_EQ(1u, hashTable->erase(key));
+
+  for (int key = 0; key < 20; ++key) {
+    HashTableTy::iterator iter = hashTable->find(key);
+    if (key % 2 == 0)
+      EXPECT_TRUE(iter == hashTable->end());
+    else
+      EXPECT_TRUE(iter != hashTable->end());
+  }
+
+  // tombstones are reused
+  for (int key = 0; key < 20; key += 2) {
+    hashTable->insert(key, exist);
+    ASSERT_FALSE(exist);
+  }
+  EXPECT_TRUE(20 == hashTable->numOfEntries());
+  for (int key = 0; key < 20; ++key)
+    EXPECT_TRUE(hashTable->find(key) != hashTable->end());
+  delete hashTable;
+}
+
+TEST_F(HashTableTest, insert_with_hash_value) {
+  typedef HashTable<ResolveInfo, ResolveInfo::hasher> HashTableTy;
+  HashTableTy* hashTable = new HashTableTy(0);
+
+  // the hash values are computed ahead, as the symbol readers do
+  llvm::StringRef names[] = {"main", "printf", "_start", "__libc_csu_init"};
+  bool exist;
+  for (int i = 0; i < 4; ++i) {
+    uint32_t hash_value = ResolveInfo::hasher()(names[i]);
+    ResolveInfo* info = hashTable->insert(names[i], hash_value, exist);
+    ASSERT_FALSE(exist);
+    EXPECT_TRUE(hash_value == info->hashValue());
+  }
+
+  // the entries are found by the lookups which hash the keys themselves
+  for (int i = 0; i < 4; ++i) {
+    ResolveInfo* info = hashTable->insert(names[i], exist);
+    ASSERT_TRUE(exist);
+    EXPECT_TRUE(hashTable->find(names[i]).getEntry() == info);
+  }
+  EXPECT_TRUE(4 == hashTable->numOfEntries());
+  delete hashTable;
+}
+
+TEST_F(HashTableTest, resolve_info_factory) {
+  ResolveInfoFactory factory;
+  ResolveInfo* foo = factory.produce("foo");
+  ResolveInfo* bar = factory.produce("bar");
+  EXPECT_STREQ("foo", foo->name());
+  EXPECT_STREQ("bar", bar->name());
+  EXPECT_TRUE(ResolveInfo::hasher()("bar") == bar->hashValue());
+
+  // the storage of the last entry is reused
+  ResolveInfo* last = bar;
+  factory.destroy(bar);
+  EXPECT_TRUE(bar == NULL);
+  ResolveInfo* baz = factory.produce("baz");
+  EXPECT_TRUE(baz == last);
+  EXPECT_STREQ("baz", baz->name());
+  EXPECT_STREQ("foo", foo->name());
+}
+
+TEST_F(HashTableTest, string_entry_factory) {
+  typedef HashTable<StringEntry<uint64_t>,
+                    mcld::hash::StringHash<mcld::hash::DJB>,
+                    StringEntryFactory<uint64_t> > StringMap;
+  StringMap* table = new StringMap();
+  bool exist;
+  std::string long_key(8192, 'x');
+  table->insert(".text", exist)->setValue(0x1000);
+  table->insert(long_key, exist)->setValue(0x2000);
+  table->insert(".data", exist)->setValue(0x3000);
+  EXPECT_TRUE(0x1000 == table->find(".text").getEntry()->value());
+  EXPECT_TRUE(0x2000 == table->find(long_key).getEntry()->value());
+  EXPECT_TRUE(long_key == table->find(long_key).getEntry()->key());
+
+  // the storage of the last entry is reused
+  StringEntry<uint64_t>* last = table->find(".data").getEntry();
+  EXPECT_TRUE(1 == table->erase(".data"));
+  EXPECT_TRUE(table->insert(".bss", exist) == last);
+  EXPECT_FALSE(exist);
+  EXPECT_TRUE(".bss" == last->key());
+  EXPECT_TRUE(3 == table->numOfEntries());
+  delete table;
+}
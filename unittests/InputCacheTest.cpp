@@ -0,0 +1,117 @@
+//===- InputCacheTest.cpp -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Support/InputCache.h"
+#include "InputCacheTest.h"
+
+#include <llvm/Support/MemoryBuffer.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace mcld;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+InputCacheTest::InputCacheTest() {
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+InputCacheTest::~InputCacheTest() {
+}
+
+// SetUp() will be called immediately before each test.
+void InputCacheTest::SetUp() {
+  InputCache::Enable(true);
+}
+
+// TearDown() will be called immediately after each test.
+void InputCacheTest::TearDown() {
+  InputCache::Enable(false);
+}
+
+static std::string createFile(const std::string& pContent) {
+  char path[] = "/tmp/mcld-cache-XXXXXX";
+  int fd = ::mkstemp(path);
+  ::close(fd);
+  std::ofstream out(path, std::ios::binary);
+  out << pContent;
+  return path;
+}
+
+/// a little-endian ELF header of type ET_DYN, so far as the cache reads it
+static std::string getSharedObject() {
+  std::string header("\x7f" "ELF\x02\x01\x01", 7);
+  header.resize(16, '\0');
+  header += std::string("\x03\x00", 2);
+  return header;
+}
+
+//==========================================================================//
+// Testcases
+//
+TEST_F(InputCacheTest, shared_object) {
+  std::string path = createFile(getSharedObject());
+  ASSERT_TRUE(InputCache::Load(path));
+  ASSERT_EQ(1u, InputCache::size());
+
+  const llvm::MemoryBuffer* buffer = InputCache::Lookup(path);
+  ASSERT_TRUE(buffer != NULL);
+  ASSERT_TRUE(buffer->getBuffer() == getSharedObject());
+  ::unlink(path.c_str());
+}
+
+TEST_F(InputCacheTest, archive) {
+  std::string path = createFile("!<arch>\n");
+  ASSERT_TRUE(InputCache::Load(path));
+  ASSERT_TRUE(InputCache::Lookup(path) != NULL);
+  ::unlink(path.c_str());
+}
+
+TEST_F(InputCacheTest, relocatable_is_not_cached) {
+  std::string object = getSharedObject();
+  object[16] = '\x01';
+  std::string path = createFile(object);
+  ASSERT_FALSE(InputCache::Load(path));
+  ASSERT_TRUE(InputCache::Lookup(path) == NULL);
+  ::unlink(path.c_str());
+}
+
+TEST_F(InputCacheTest, changed_file) {
+  std::string path = createFile("!<arch>\n");
+  ASSERT_TRUE(InputCache::Load(path));
+
+  std::ofstream out(path.c_str(), std::ios::binary | std::ios::app);
+  out << "changed";
+  out.close();
+  ASSERT_TRUE(InputCache::Lookup(path) == NULL);
+  ASSERT_EQ(0u, InputCache::size());
+  ::unlink(path.c_str());
+}
+
+TEST_F(InputCacheTest, disabled) {
+  std::string path = createFile("!<arch>\n");
+  InputCache::Enable(false);
+  ASSERT_FALSE(InputCache::Load(path));
+  ASSERT_TRUE(InputCache::Lookup(path) == NULL);
+
+  InputCache::RecordMiss(path);
+  ASSERT_TRUE(InputCache::GetMisses().empty());
+  ::unlink(path.c_str());
+}
+
+TEST_F(InputCacheTest, misses) {
+  InputCache::RecordMiss("a.so");
+  InputCache::RecordMiss("b.a");
+  InputCache::RecordMiss("a.so");
+  ASSERT_EQ(2u, InputCache::GetMisses().size());
+  ASSERT_TRUE(InputCache::GetMisses()[0] == "a.so");
+}
@@ -0,0 +1,109 @@
+//===- InputCostReportTest.cpp --------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/InputCostReport.h"
+#include "mcld/MC/Input.h"
+#include "mcld/Support/TimeTrace.h"
+#include "InputCostReportTest.h"
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <string>
+
+using namespace mcld;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+InputCostReportTest::InputCostReportTest() {
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+InputCostReportTest::~InputCostReportTest() {
+}
+
+// SetUp() will be called immediately before each test.
+void InputCostReportTest::SetUp() {
+}
+
+// TearDown() will be called immediately after each test.
+void InputCostReportTest::TearDown() {
+}
+
+//==========================================================================//
+// Testcases
+//
+TEST_F(InputCostReportTest, top_inputs) {
+  Input fast("fast.o", sys::fs::Path("fast.o"));
+  Input slow("slow.o", sys::fs::Path("slow.o"));
+  Input member("a.o", sys::fs::Path("libx.a"));
+  Input other("b.o", sys::fs::Path("libx.a"));
+
+  InputCostReport report;
+  report.addTime(fast, InputCostReport::Read, 1000);
+  report.addTime(slow, InputCostReport::Read, 2000);
+  report.addTime(slow, InputCostReport::Apply, 3000);
+  report.addTime(member, InputCostReport::Scan, 1500);
+  report.addTime(other, InputCostReport::Scan, 1500);
+
+  std::string out;
+  llvm::raw_string_ostream os(out);
+  report.print(os, 2);
+  os.flush();
+
+  // the longest come first, and the members are charged to their archive
+  size_t first = out.find("slow.o");
+  size_t second = out.find("libx.a");
+  ASSERT_NE(std::string::npos, first);
+  ASSERT_NE(std::string::npos, second);
+  EXPECT_LT(first, second);
+  EXPECT_NE(std::string::npos, out.find("5.000"));
+  EXPECT_NE(std::string::npos, out.find("3.000"));
+  EXPECT_EQ(std::string::npos, out.find("fast.o"));
+}
+
+TEST_F(InputCostReportTest, trace_events) {
+  Input input("a\"b.o", sys::fs::Path("dir\\a\"b.o"));
+  InputCostReport report;
+  report.addTime(input, InputCostReport::Resolve, 42);
+
+  TimeTrace trace;
+  report.addEvents(trace, 10);
+  std::string out;
+  llvm::raw_string_ostream os(out);
+  trace.printChromeTrace(os);
+  os.flush();
+
+  // the path is escaped, and the costs are the arguments of the event
+  EXPECT_NE(std::string::npos, out.find("\"detail\":\"dir\\\\a\\\"b.o\""));
+  EXPECT_NE(std::string::npos, out.find("\"resolve us\":42"));
+  EXPECT_NE(std::string::npos, out.find("\"ph\":\"i\""));
+}
+
+TEST_F(InputCostReportTest, scope) {
+  Input input("a.o", sys::fs::Path("a.o"));
+  EXPECT_TRUE(InputCostReport::Current() == NULL);
+  {
+    // nothing is charged unless a report is installed
+    InputCostReport::Scope cost(input, InputCostReport::Read);
+  }
+  {
+    InputCostReport report;
+    InputCostReport::SetCurrent(&report);
+    EXPECT_EQ(&report, InputCostReport::Current());
+    {
+      InputCostReport::Scope cost(input, InputCostReport::Read);
+    }
+    std::string out;
+    llvm::raw_string_ostream os(out);
+    report.print(os, 10);
+    os.flush();
+    EXPECT_NE(std::string::npos, out.find("a.o"));
+  }
+  // a report uninstalls itself when it is gone
+  EXPECT_TRUE(InputCostReport::Current() == NULL);
+}
@@ -0,0 +1,38 @@
+//===- InputCostReportTest.h ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_INPUT_COST_REPORT_TEST_H
+#define MCLD_INPUT_COST_REPORT_TEST_H
+
+#include <gtest.h>
+
+namespace mcldtest {
+
+/** \class InputCostReportTest
+ *  \brief Testcase for the costs of InputCostReport
+ *
+ *  \see InputCostReport
+ */
+class InputCostReportTest : public ::testing::Test {
+ public:
+  // Constructor can do set-up work for all test here.
+  InputCostReportTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~InputCostReportTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+};
+
+}  // namespace of mcldtest
+
+#endif
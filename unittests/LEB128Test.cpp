@@ -525,3 +525,51 @@ TEST_F(LEB128Test, Type_Conversion_Test) {
   ASSERT_TRUE(leb128::decode<uint64_t>(p) == 154452);
   ASSERT_TRUE(p == (buffer + 3));
 }
+
+TEST_F(LEB128Test, Size_Test) {
+  leb128::ByteType buffer[16];
+  leb128::ByteType* result;
+  uint64_t uvalues[] = {0, 0x7f, 0x80, 0x3fff, 0x4000, 0xffffffffULL,
+                        0xffffffffffffffffULL};
+  for (size_t i = 0; i < sizeof(uvalues) / sizeof(uvalues[0]); ++i) {
+    result = buffer;
+    ASSERT_EQ(leb128::encode<uint64_t>(result, uvalues[i]),
+              leb128::size<uint64_t>(uvalues[i]));
+  }
+
+  int64_t svalues[] = {0, 1, -1, 0x3f, 0x40, -0x40, -0x41, 0x1fff, -0x2001,
+                       INT64_MAX, INT64_MIN};
+  for (size_t i = 0; i < sizeof(svalues) / sizeof(svalues[0]); ++i) {
+    result = buffer;
+    ASSERT_EQ(leb128::encode<int64_t>(result, svalues[i]),
+              leb128::size<int64_t>(svalues[i]));
+  }
+}
+
+TEST_F(LEB128Test, DecodeBatch_Test) {
+  leb128::ByteType buffer[1024];
+  uint64_t values[100];
+  leb128::ByteType* out = buffer;
+  for (int i = 0; i < 100; i++) {
+    // from one byte to the ten bytes of the largest values
+    unsigned long int random = sys::GetRandomNum();
+    values[i] = static_cast<uint64_t>(random) << (i % 40);
+    if (i % 10 == 9)
+      values[i] |= 0xffffffff00000000ULL;
+    leb128::encode<uint64_t>(out, values[i]);
+  }
+
+  uint64_t decoded[100];
+  const leb128::ByteType* in = buffer;
+  ASSERT_EQ(100u, leb128::decodeBatch(in, out, decoded, 100));
+  ASSERT_TRUE(in == out);
+  for (int i = 0; i < 100; i++)
+    ASSERT_EQ(values[i], decoded[i]);
+
+  // a truncated value is not read
+  leb128::ByteType truncated[] = {0x81, 0x01, 0x82};
+  in = truncated;
+  ASSERT_EQ(1u, leb128::decodeBatch(in, truncated + 3, decoded, 2));
+  ASSERT_EQ(129u, decoded[0]);
+  ASSERT_TRUE(in == truncated + 2);
+}
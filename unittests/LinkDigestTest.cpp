@@ -0,0 +1,74 @@
+//===- LinkDigestTest.cpp -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/LinkDigest.h"
+#include "LinkDigestTest.h"
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <string>
+
+using namespace mcld;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+LinkDigestTest::LinkDigestTest() {
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+LinkDigestTest::~LinkDigestTest() {
+}
+
+// SetUp() will be called immediately before each test.
+void LinkDigestTest::SetUp() {
+}
+
+// TearDown() will be called immediately after each test.
+void LinkDigestTest::TearDown() {
+}
+
+//==========================================================================//
+// Testcases
+//
+TEST_F(LinkDigestTest, output) {
+  LinkDigest digest;
+  digest.addOutput("\x7f" "ELF one");
+  digest.addOutput("\x7f" "ELF two");
+  digest.addOutput("\x7f" "ELF one");
+
+  const LinkDigest::EntryList& entries = digest.entries();
+  ASSERT_EQ(3u, entries.size());
+  EXPECT_EQ("output", entries[0].phase);
+  EXPECT_EQ(0u, entries[0].symbols);
+  EXPECT_EQ(0u, entries[0].sections);
+  EXPECT_NE(entries[0].output, entries[1].output);
+  EXPECT_EQ(entries[0].output, entries[2].output);
+}
+
+TEST_F(LinkDigestTest, write_and_read) {
+  LinkDigest digest;
+  digest.addOutput("contents");
+
+  std::string out;
+  llvm::raw_string_ostream os(out);
+  digest.write(os);
+  os.flush();
+
+  LinkDigest copy;
+  ASSERT_TRUE(copy.read(out));
+  ASSERT_EQ(1u, copy.entries().size());
+  EXPECT_EQ(digest.entries()[0].phase, copy.entries()[0].phase);
+  EXPECT_EQ(digest.entries()[0].output, copy.entries()[0].output);
+
+  // a line which is cut short is not a digest
+  LinkDigest broken;
+  EXPECT_FALSE(broken.read("layout 0000000000000001 0000000000000002\n"));
+  EXPECT_FALSE(broken.read("layout 1 2 xyz\n"));
+  EXPECT_TRUE(broken.read(""));
+  EXPECT_TRUE(broken.entries().empty());
+}
@@ -0,0 +1,82 @@
+//===- MemoryReportTest.cpp -----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/MemoryReport.h"
+#include "MemoryReportTest.h"
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <string>
+
+using namespace mcld;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+MemoryReportTest::MemoryReportTest() {
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+MemoryReportTest::~MemoryReportTest() {
+}
+
+// SetUp() will be called immediately before each test.
+void MemoryReportTest::SetUp() {
+}
+
+// TearDown() will be called immediately after each test.
+void MemoryReportTest::TearDown() {
+}
+
+//==========================================================================//
+// Testcases
+//
+TEST_F(MemoryReportTest, samples) {
+  MemoryReport report;
+  report.add("NamePool", 2, 96);
+  report.add("Fragment", 3, 120);
+  report.add("NamePool", 1, 48);
+  report.endSample("normalize");
+  report.add("ICF candidates", 4, 512);
+  report.endSample("icf");
+
+  std::string out;
+  llvm::raw_string_ostream os(out);
+  report.print(os);
+  os.flush();
+
+  size_t normalize = out.find("after normalize");
+  size_t icf = out.find("after icf");
+  ASSERT_NE(std::string::npos, normalize);
+  ASSERT_NE(std::string::npos, icf);
+  ASSERT_LT(normalize, icf);
+
+  // the usages of one structure are summed up within a sample
+  std::string first = out.substr(normalize, icf - normalize);
+  EXPECT_NE(std::string::npos, first.find("NamePool"));
+  EXPECT_NE(std::string::npos, first.find(" 3 "));
+  EXPECT_NE(std::string::npos, first.find(" 144\n"));
+  EXPECT_NE(std::string::npos, first.find(" 264\n"));
+  EXPECT_EQ(std::string::npos, first.find("ICF candidates"));
+
+  // a sample starts empty
+  std::string second = out.substr(icf);
+  EXPECT_EQ(std::string::npos, second.find("NamePool"));
+  EXPECT_NE(std::string::npos, second.find("ICF candidates"));
+  EXPECT_NE(std::string::npos, second.find(" 512\n"));
+}
+
+TEST_F(MemoryReportTest, current) {
+  EXPECT_TRUE(MemoryReport::Current() == NULL);
+  {
+    MemoryReport report;
+    MemoryReport::SetCurrent(&report);
+    EXPECT_EQ(&report, MemoryReport::Current());
+  }
+  // a report uninstalls itself when it is gone
+  EXPECT_TRUE(MemoryReport::Current() == NULL);
+}
@@ -0,0 +1,38 @@
+//===- MemoryReportTest.h -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_MEMORY_REPORT_TEST_H
+#define MCLD_MEMORY_REPORT_TEST_H
+
+#include <gtest.h>
+
+namespace mcldtest {
+
+/** \class MemoryReportTest
+ *  \brief Testcase for the samples of MemoryReport
+ *
+ *  \see MemoryReport
+ */
+class MemoryReportTest : public ::testing::Test {
+ public:
+  // Constructor can do set-up work for all test here.
+  MemoryReportTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~MemoryReportTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+};
+
+}  // namespace of mcldtest
+
+#endif
@@ -0,0 +1,123 @@
+//===- MergedStringTableTest.cpp ------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/MergedStringTable.h"
+#include "mcld/Support/ThreadPool.h"
+#include "MergedStringTableTest.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace mcld;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+MergedStringTableTest::MergedStringTableTest() {
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+MergedStringTableTest::~MergedStringTableTest() {
+}
+
+// SetUp() will be called immediately before each test.
+void MergedStringTableTest::SetUp() {
+}
+
+// TearDown() will be called immediately after each test.
+void MergedStringTableTest::TearDown() {
+}
+
+static const char g_Block1[] = "foobar\0bar\0baz\0";
+static const char g_Block2[] = "bar\0qux\0foobar\0ar\0";
+
+static void checkTable(unsigned pNumThreads) {
+  MergedStringTable table;
+  table.addStrings(llvm::StringRef(g_Block1, sizeof(g_Block1) - 1));
+  table.addStrings(llvm::StringRef(g_Block2, sizeof(g_Block2) - 1));
+
+  ThreadPool pool(pNumThreads);
+  uint64_t size = table.finalizeOffset(pool);
+  // "bar" and "ar" share the tail of "foobar".
+  ASSERT_TRUE(std::strlen("foobar baz qux ") == size);
+
+  std::vector<uint8_t> buffer(size, 0);
+  MemoryRegion region(buffer.data(), buffer.size());
+  table.emit(region);
+
+  const char* strings[] = {"foobar", "bar", "baz", "qux", "ar"};
+  for (size_t i = 0; i < sizeof(strings) / sizeof(strings[0]); ++i) {
+    size_t offset = table.getOutputOffset(strings[i]);
+    ASSERT_TRUE(offset < size);
+    const char* emitted = reinterpret_cast<const char*>(&buffer[offset]);
+    ASSERT_STREQ(strings[i], emitted);
+  }
+}
+
+//==========================================================================//
+// Testcases
+//
+TEST_F(MergedStringTableTest, serial_merge) {
+  checkTable(1);
+}
+
+TEST_F(MergedStringTableTest, parallel_merge) {
+  checkTable(4);
+}
+
+TEST_F(MergedStringTableTest, same_layout_for_any_thread_count) {
+  std::string strings;
+  for (unsigned i = 0; i < 1000; ++i) {
+    strings += "str" + std::to_string(i * 7);
+    strings += '\0';
+  }
+
+  MergedStringTable serial, parallel;
+  serial.addStrings(strings);
+  parallel.addStrings(strings);
+  ThreadPool serial_pool(1), parallel_pool(4);
+  ASSERT_TRUE(serial.finalizeOffset(serial_pool) ==
+              parallel.finalizeOffset(parallel_pool));
+
+  for (unsigned i = 0; i < 1000; ++i) {
+    std::string str = "str" + std::to_string(i * 7);
+    ASSERT_TRUE(serial.getOutputOffset(str) == parallel.getOutputOffset(str));
+  }
+}
+
+TEST_F(MergedStringTableTest, block_offsets) {
+  llvm::StringRef block1(g_Block1, sizeof(g_Block1) - 1);
+  llvm::StringRef block2(g_Block2, sizeof(g_Block2) - 1);
+  MergedStringTable table;
+  table.addStrings(block1);
+  table.addStrings(block2);
+  ThreadPool pool(1);
+  table.finalizeOffset(pool);
+
+  // a byte inside a string or its terminator follows the string
+  size_t foobar = table.getOutputOffset("foobar");
+  ASSERT_TRUE(foobar + 2 == table.getOutputOffset(block1, 2));
+  ASSERT_TRUE(foobar + 6 == table.getOutputOffset(block2, 14));
+  ASSERT_TRUE(table.getOutputOffset("bar") == table.getOutputOffset(block2, 0));
+  ASSERT_TRUE(table.getOutputOffset("ar") == table.getOutputOffset(block2, 15));
+}
+
+TEST_F(MergedStringTableTest, fixed_size_entries) {
+  static const char entries[] = "AAAABBBBAAAACCCC";
+  llvm::StringRef block(entries, sizeof(entries) - 1);
+  MergedStringTable table(4, false);
+  table.addStrings(block);
+  ThreadPool pool(1);
+  ASSERT_TRUE(12 == table.finalizeOffset(pool));
+
+  ASSERT_TRUE(table.getOutputOffset(block, 0) ==
+              table.getOutputOffset(block, 8));
+  ASSERT_TRUE(table.getOutputOffset(block, 1) ==
+              table.getOutputOffset(block, 9));
+  ASSERT_TRUE(0 == (table.getOutputOffset(block, 4) % 4));
+}
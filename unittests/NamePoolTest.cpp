@@ -12,6 +12,7 @@
 #include "mcld/LD/StaticResolver.h"
 #include "mcld/LD/ResolveInfo.h"
 #include "mcld/LD/LDSymbol.h"
+#include "mcld/MC/Input.h"
 #include <llvm/ADT/StringRef.h>
 #include <string>
 #include <cstdio>
@@ -205,3 +206,28 @@ TEST_F(NamePoolTest, insert_16384_weak_reference_symbols) {
     }
   }
 }
+
+TEST_F(NamePoolTest, reference_marks_dyn_definer_needed) {
+  Input lib("libfoo.so", sys::fs::Path("libfoo.so"), Input::DynObj);
+  Resolver::Result def;
+  m_pTestee->insertSymbol("foo", true, ResolveInfo::Function,
+                          ResolveInfo::Define, ResolveInfo::Global, 0, 0,
+                          ResolveInfo::Default, NULL, def);
+  m_pTestee->setDynDefiner(*def.info, lib);
+  EXPECT_FALSE(lib.isNeeded());
+
+  // a weak reference does not use the shared object
+  Resolver::Result weak;
+  m_pTestee->insertSymbol("foo", false, ResolveInfo::NoType,
+                          ResolveInfo::Undefined, ResolveInfo::Weak, 0, 0,
+                          ResolveInfo::Default, NULL, weak);
+  EXPECT_EQ(def.info, weak.info);
+  EXPECT_FALSE(lib.isNeeded());
+
+  Resolver::Result ref;
+  m_pTestee->insertSymbol("foo", false, ResolveInfo::NoType,
+                          ResolveInfo::Undefined, ResolveInfo::Global, 0, 0,
+                          ResolveInfo::Default, NULL, ref);
+  EXPECT_EQ(def.info, ref.info);
+  EXPECT_TRUE(lib.isNeeded());
+}
@@ -0,0 +1,142 @@
+//===- OutputRelrSectionTest.cpp ------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Target/OutputRelrSection.h"
+#include "mcld/LinkerConfig.h"
+#include "mcld/Fragment/FillFragment.h"
+#include "mcld/Fragment/FragmentRef.h"
+#include "mcld/Fragment/Relocation.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/LD/SectionData.h"
+#include "mcld/Support/ELF.h"
+#include "OutputRelrSectionTest.h"
+
+#include <llvm/Support/ELF.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace mcld;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+OutputRelrSectionTest::OutputRelrSectionTest() {
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+OutputRelrSectionTest::~OutputRelrSectionTest() {
+}
+
+// SetUp() will be called immediately before each test.
+void OutputRelrSectionTest::SetUp() {
+}
+
+// TearDown() will be called immediately after each test.
+void OutputRelrSectionTest::TearDown() {
+}
+
+static Relocation* createRelative(Fragment& pFrag, uint64_t pOffset) {
+  return Relocation::Create(llvm::ELF::R_X86_64_RELATIVE,
+                            *FragmentRef::Create(pFrag, pOffset));
+}
+
+//==========================================================================//
+// Testcases
+//
+TEST_F(OutputRelrSectionTest, pack_places) {
+  LinkerConfig config("x86_64-linux-gnu");
+  config.targets().setEndian(TargetOptions::Little);
+  config.targets().setBitClass(64);
+  Relocation::SetUp(config);
+
+  LDSection* data = LDSection::Create(".data",
+                                      LDFileFormat::DATA,
+                                      llvm::ELF::SHT_PROGBITS,
+                                      llvm::ELF::SHF_ALLOC |
+                                          llvm::ELF::SHF_WRITE);
+  data->setAlign(8);
+  data->setAddr(0x1000);
+  SectionData* sd = SectionData::Create(*data);
+  Fragment* frag = new FillFragment(0x0, 1, 0x400, sd);
+  frag->setOffset(0x0);
+
+  LDSection* relr = LDSection::Create(".relr.dyn",
+                                      LDFileFormat::Relocation,
+                                      ELF::SHT_RELR,
+                                      llvm::ELF::SHF_ALLOC);
+  OutputRelrSection relr_dyn(*relr, config, true);
+
+  // a misaligned place is left to .rela.dyn
+  Relocation* misaligned = createRelative(*frag, 0x4);
+  ASSERT_FALSE(relr_dyn.isPackable(*misaligned));
+
+  // 0x1000 is an address, 0x1008 and 0x1010 are in the first bitmap, and
+  // 0x1230 is in the second one. 0x1008 is added twice but relocated once.
+  uint64_t offsets[] = {0x230, 0x8, 0x0, 0x10, 0x8};
+  for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); ++i) {
+    Relocation* reloc = createRelative(*frag, offsets[i]);
+    ASSERT_TRUE(relr_dyn.isPackable(*reloc));
+    relr_dyn.add(*reloc);
+  }
+  relr_dyn.finalizeSectionSize();
+  ASSERT_TRUE(3 * 8 == relr->size());
+
+  std::vector<uint8_t> buffer(relr->size(), 0);
+  MemoryRegion region(buffer.data(), buffer.size());
+  relr_dyn.emit(region);
+
+  uint64_t entries[3];
+  std::memcpy(entries, buffer.data(), sizeof(entries));
+  ASSERT_TRUE(0x1000 == entries[0]);
+  ASSERT_TRUE(0x7 == entries[1]);
+  ASSERT_TRUE(0x81 == entries[2]);
+
+  LDSection::Destroy(relr);
+  LDSection::Destroy(data);
+}
+
+TEST_F(OutputRelrSectionTest, size_before_layout) {
+  LinkerConfig config("x86_64-linux-gnu");
+  config.targets().setEndian(TargetOptions::Little);
+  config.targets().setBitClass(64);
+  Relocation::SetUp(config);
+
+  LDSection* data = LDSection::Create(".data",
+                                      LDFileFormat::DATA,
+                                      llvm::ELF::SHT_PROGBITS,
+                                      llvm::ELF::SHF_ALLOC |
+                                          llvm::ELF::SHF_WRITE);
+  data->setAlign(8);
+  SectionData* sd = SectionData::Create(*data);
+  Fragment* frag = new FillFragment(0x0, 1, 0x1000, sd);
+  frag->setOffset(0x0);
+
+  LDSection* relr = LDSection::Create(".relr.dyn",
+                                      LDFileFormat::Relocation,
+                                      ELF::SHT_RELR,
+                                      llvm::ELF::SHF_ALLOC);
+  OutputRelrSection relr_dyn(*relr, config, true);
+  for (uint64_t offset = 0x0; offset < 0x800; offset += 0x10)
+    relr_dyn.add(*createRelative(*frag, offset));
+  relr_dyn.finalizeSectionSize();
+  uint64_t size = relr->size();
+
+  // the number of entries does not depend on the address of the section
+  data->setAddr(0x12340);
+  std::vector<uint8_t> buffer(size, 0);
+  MemoryRegion region(buffer.data(), buffer.size());
+  relr_dyn.emit(region);
+
+  uint64_t first = 0;
+  std::memcpy(&first, buffer.data(), sizeof(first));
+  ASSERT_TRUE(0x12340 == first);
+  ASSERT_TRUE(size < relr_dyn.numOfRelocs() * 24);
+
+  LDSection::Destroy(relr);
+  LDSection::Destroy(data);
+}
@@ -0,0 +1,38 @@
+//===- OutputRelrSectionTest.h --------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_OUTPUT_RELR_SECTION_TEST_H
+#define MCLD_OUTPUT_RELR_SECTION_TEST_H
+
+#include <gtest.h>
+
+namespace mcldtest {
+
+/** \class OutputRelrSectionTest
+ *  \brief Testcase for packing relative relocations in OutputRelrSection
+ *
+ *  \see OutputRelrSection
+ */
+class OutputRelrSectionTest : public ::testing::Test {
+ public:
+  // Constructor can do set-up work for all test here.
+  OutputRelrSectionTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~OutputRelrSectionTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+};
+
+}  // namespace of mcldtest
+
+#endif
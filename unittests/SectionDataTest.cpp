@@ -8,9 +8,14 @@
 //===----------------------------------------------------------------------===//
 #include "SectionDataTest.h"
 
+#include "mcld/Fragment/FillFragment.h"
 #include "mcld/LD/SectionData.h"
 #include "mcld/LD/LDFileFormat.h"
 #include "mcld/LD/LDSection.h"
+#include "mcld/Object/ObjectBuilder.h"
+#include "mcld/Support/ThreadPool.h"
+
+#include <vector>
 
 using namespace mcld;
 using namespace mcldtest;
@@ -73,3 +78,102 @@ TEST_F(SectionDataTest, Fragment_list_and_iterator) {
 
   LDSection::Destroy(test);
 }
+
+TEST_F(SectionDataTest, MoveSectionData_aligns_first_fragment) {
+  LDSection* from = LDSection::Create("from", LDFileFormat::TEXT, 0, 0);
+  LDSection* to = LDSection::Create("to", LDFileFormat::TEXT, 0, 0);
+  from->setAlign(16);
+  SectionData* from_data = SectionData::Create(*from);
+  SectionData* to_data = SectionData::Create(*to);
+
+  FillFragment* first = new FillFragment(0x0, 1, 3, to_data);
+  first->setOffset(0);
+  to->setSize(3);
+  FillFragment* second = new FillFragment(0x0, 1, 5, from_data);
+  FillFragment* third = new FillFragment(0x0, 1, 7, from_data);
+  EXPECT_TRUE(ObjectBuilder::MoveSectionData(*from_data, *to_data));
+
+  // no AlignFragment is appended
+  EXPECT_TRUE(3 == to_data->size());
+  EXPECT_TRUE(16 == second->getAlign());
+  EXPECT_TRUE(16 == second->getOffset());
+  EXPECT_TRUE(1 == third->getAlign());
+  EXPECT_TRUE(21 == third->getOffset());
+  EXPECT_TRUE(28 == to->size());
+
+  // the padding is kept when the offsets are recomputed
+  second->setOffset(0);
+  third->setOffset(0);
+  to_data->updateOffsets(*second);
+  EXPECT_TRUE(16 == second->getOffset());
+  EXPECT_TRUE(21 == third->getOffset());
+
+  LDSection::Destroy(from);
+  LDSection::Destroy(to);
+}
+
+TEST_F(SectionDataTest, layout_in_chunks) {
+  LDSection* test = LDSection::Create("test", LDFileFormat::TEXT, 0, 0);
+  SectionData* s = SectionData::Create(*test);
+
+  // the expected offsets are those of one walk
+  std::vector<Fragment*> frags;
+  std::vector<uint64_t> expected;
+  uint64_t offset = 0;
+  for (size_t i = 0; i < 20000; ++i) {
+    Fragment* frag = new FillFragment(0x0, 1, 1 + (i % 7), s);
+    if (i % 5 == 0)
+      frag->setAlign((i % 3 == 0) ? 16 : 8);
+    frags.push_back(frag);
+    expected.push_back(frag->alignOffset(offset));
+    offset = expected.back() + frag->size();
+  }
+
+  ThreadPool pool(4);
+  s->layout(pool);
+  for (size_t i = 0; i < frags.size(); ++i)
+    ASSERT_TRUE(expected[i] == frags[i]->getOffset());
+  EXPECT_TRUE(offset == test->size());
+
+  LDSection::Destroy(test);
+}
+
+TEST_F(SectionDataTest, FragmentIndex_find_and_split) {
+  LDSection* test = LDSection::Create("test", LDFileFormat::TEXT, 0, 0);
+  SectionData* s = SectionData::Create(*test);
+
+  // fragments of 4 bytes, an empty one at 8, and a gap before 32
+  for (size_t i = 0; i < 4; ++i)
+    new FillFragment(0x0, 1, (i == 2) ? 0 : 4, s);
+  Fragment* last = new FillFragment(0x0, 1, 4, s);
+  last->setAlign(32);
+  ThreadPool pool(1);
+  s->layout(pool);
+
+  FragmentIndex index(*s);
+  ASSERT_TRUE(5 == index.size());
+  EXPECT_TRUE(last == &index[4]);
+  EXPECT_TRUE(0 == index.find(0));
+  EXPECT_TRUE(0 == index.find(3));
+  EXPECT_TRUE(1 == index.find(4));
+  EXPECT_TRUE(3 == index.find(8));
+  EXPECT_TRUE(3 == index.find(11));
+  EXPECT_TRUE(index.size() == index.find(12));
+  EXPECT_TRUE(4 == index.find(35));
+  EXPECT_TRUE(index.size() == index.find(36));
+
+  // the runs start at the aligned fragments
+  std::vector<size_t> starts;
+  index.split(2, 32, starts);
+  ASSERT_TRUE(3 == starts.size());
+  EXPECT_TRUE(0 == starts[0]);
+  EXPECT_TRUE(4 == starts[1]);
+  EXPECT_TRUE(5 == starts[2]);
+
+  // the index is built again after an insertion
+  new FillFragment(0x0, 1, 4, s);
+  index.build(*s);
+  EXPECT_TRUE(6 == index.size());
+
+  LDSection::Destroy(test);
+}
@@ -0,0 +1,96 @@
+//===- SizeReportTest.cpp -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/SizeReport.h"
+#include "mcld/LD/LDSection.h"
+#include "mcld/MC/Input.h"
+#include "SizeReportTest.h"
+
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <string>
+
+using namespace mcld;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+SizeReportTest::SizeReportTest() {
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+SizeReportTest::~SizeReportTest() {
+}
+
+// SetUp() will be called immediately before each test.
+void SizeReportTest::SetUp() {
+}
+
+// TearDown() will be called immediately after each test.
+void SizeReportTest::TearDown() {
+}
+
+static LDSection* createSection(const char* pName, uint64_t pSize) {
+  return LDSection::Create(pName,
+                           LDFileFormat::TEXT,
+                           llvm::ELF::SHT_PROGBITS,
+                           llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_EXECINSTR,
+                           pSize);
+}
+
+//==========================================================================//
+// Testcases
+//
+TEST_F(SizeReportTest, json) {
+  Input a("a.o", sys::fs::Path("a.o"), Input::Object);
+  Input b("b.o", sys::fs::Path("libb.a"), Input::Object, 8);
+  LDSection* text = createSection(".text", 0);
+  LDSection* foo = createSection(".text.foo", 16);
+  LDSection* bar = createSection(".text.bar", 8);
+  LDSection* baz = createSection(".text.baz", 4);
+
+  SizeReport report;
+  report.addSection(a, *foo, *text);
+  report.addSection(a, *bar, *text);
+  report.addSection(b, *foo, *text);
+  report.addStripped(b, *bar);
+  report.addFolded(a, *baz);
+
+  std::string result;
+  llvm::raw_string_ostream os(result);
+  report.writeJSON(os);
+  os.flush();
+
+  ASSERT_TRUE(result.find("{\"file\": \"a.o\", \"member\": \"\", "
+                          "\"sections\": {\".text\": 24}, \"gc\": 0, "
+                          "\"icf\": 4}") != std::string::npos);
+  ASSERT_TRUE(result.find("{\"file\": \"libb.a\", \"member\": \"b.o\", "
+                          "\"sections\": {\".text\": 16}, \"gc\": 8, "
+                          "\"icf\": 0}") != std::string::npos);
+  ASSERT_TRUE(result.find("\"sections\": {\".text\": 40},\n  \"gc\": 8,\n"
+                          "  \"icf\": 4\n}") != std::string::npos);
+}
+
+TEST_F(SizeReportTest, csv) {
+  Input a("a,b.o", sys::fs::Path("a,b.o"), Input::Object);
+  LDSection* text = createSection(".text", 0);
+  LDSection* foo = createSection(".text.foo", 16);
+
+  SizeReport report;
+  report.addSection(a, *foo, *text);
+  report.addStripped(a, *foo);
+
+  std::string result;
+  llvm::raw_string_ostream os(result);
+  report.writeCSV(os);
+  os.flush();
+
+  ASSERT_TRUE(result == "file,member,section,bytes\n"
+                        "\"a,b.o\",,.text,16\n"
+                        "\"a,b.o\",,(gc),16\n");
+}
@@ -0,0 +1,38 @@
+//===- SizeReportTest.h ---------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SIZE_REPORT_TEST_H
+#define MCLD_SIZE_REPORT_TEST_H
+
+#include <gtest.h>
+
+namespace mcldtest {
+
+/** \class SizeReportTest
+ *  \brief Testcase for the bytes of SizeReport
+ *
+ *  \see SizeReport
+ */
+class SizeReportTest : public ::testing::Test {
+ public:
+  // Constructor can do set-up work for all test here.
+  SizeReportTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~SizeReportTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+};
+
+}  // namespace of mcldtest
+
+#endif
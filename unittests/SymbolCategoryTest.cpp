@@ -10,6 +10,7 @@
 #include "mcld/LD/ResolveInfo.h"
 #include "mcld/LD/LDSymbol.h"
 #include <iostream>
+#include <vector>
 #include "SymbolCategoryTest.h"
 
 using namespace std;
@@ -137,3 +138,97 @@ TEST_F(SymbolCategoryTest, change_local_to_dynamic) {
   ++sym;
   ASSERT_STREQ("e", (*sym)->name());
 }
+
+TEST_F(SymbolCategoryTest, arrange_forced_local) {
+  ResolveInfo* a = ResolveInfo::Create("a");
+  ResolveInfo* b = ResolveInfo::Create("b");
+  ResolveInfo* c = ResolveInfo::Create("c");
+  a->setBinding(ResolveInfo::Global);
+  b->setBinding(ResolveInfo::Global);
+  c->setBinding(ResolveInfo::Global);
+
+  LDSymbol* aa = LDSymbol::Create(*a);
+  LDSymbol* bb = LDSymbol::Create(*b);
+  LDSymbol* cc = LDSymbol::Create(*c);
+
+  m_pTestee->add(*aa);
+  m_pTestee->forceLocal(*bb);
+  m_pTestee->add(*cc);
+  ASSERT_TRUE(1 == m_pTestee->numOfLocals());
+  ASSERT_TRUE(2 == m_pTestee->numOfDynamics());
+
+  // b is a local although its ResolveInfo says global
+  ResolveInfo* old_info = ResolveInfo::Create("b");
+  old_info->override(*b);
+  b->setDesc(ResolveInfo::Common);
+  m_pTestee->arrange(*bb, *old_info);
+  ASSERT_TRUE(0 == m_pTestee->numOfLocals());
+  ASSERT_TRUE(1 == m_pTestee->numOfCommons());
+  ASSERT_TRUE(bb == *m_pTestee->commonBegin());
+
+  // the common is allocated before it changes to global
+  b->setDesc(ResolveInfo::Define);
+  m_pTestee->changeCommonsToGlobal();
+  ASSERT_TRUE(3 == m_pTestee->numOfDynamics());
+  m_pTestee->changeToDynamic(*cc);
+  ASSERT_TRUE(1 == m_pTestee->numOfLocalDyns());
+  ASSERT_TRUE(cc == *m_pTestee->localDynBegin());
+}
+
+TEST_F(SymbolCategoryTest, add_at_once) {
+  ResolveInfo* a = ResolveInfo::Create("a");
+  ResolveInfo* b = ResolveInfo::Create("b");
+  ResolveInfo* c = ResolveInfo::Create("c");
+  ResolveInfo* d = ResolveInfo::Create("d");
+  ResolveInfo* e = ResolveInfo::Create("e");
+  ResolveInfo* f = ResolveInfo::Create("f");
+  a->setBinding(ResolveInfo::Global);
+  b->setBinding(ResolveInfo::Global);
+  c->setBinding(ResolveInfo::Local);
+  d->setBinding(ResolveInfo::Global);
+  e->setDesc(ResolveInfo::Common);
+  e->setBinding(ResolveInfo::Global);
+  f->setType(ResolveInfo::File);
+
+  LDSymbol* aa = LDSymbol::Create(*a);
+  LDSymbol* bb = LDSymbol::Create(*b);
+  LDSymbol* cc = LDSymbol::Create(*c);
+  LDSymbol* dd = LDSymbol::Create(*d);
+  LDSymbol* ee = LDSymbol::Create(*e);
+  LDSymbol* ff = LDSymbol::Create(*f);
+
+  m_pTestee->add(*aa);
+
+  std::vector<LDSymbol*> symbols;
+  std::vector<bool> force_local;
+  symbols.push_back(bb);
+  force_local.push_back(false);
+  symbols.push_back(cc);
+  force_local.push_back(false);
+  symbols.push_back(dd);
+  force_local.push_back(true);
+  symbols.push_back(ee);
+  force_local.push_back(false);
+  symbols.push_back(ff);
+  force_local.push_back(false);
+  m_pTestee->add(symbols, force_local);
+
+  ASSERT_TRUE(6 == m_pTestee->numOfSymbols());
+  ASSERT_TRUE(2 == m_pTestee->numOfLocals());
+  ASSERT_TRUE(1 == m_pTestee->numOfCommons());
+  ASSERT_TRUE(2 == m_pTestee->numOfDynamics());
+
+  // the symbols of a category keep their order
+  SymbolCategory::iterator sym = m_pTestee->begin();
+  ASSERT_TRUE(ff == *sym++);
+  ASSERT_TRUE(cc == *sym++);
+  ASSERT_TRUE(dd == *sym++);
+  ASSERT_TRUE(ee == *sym++);
+  ASSERT_TRUE(aa == *sym++);
+  ASSERT_TRUE(bb == *sym++);
+
+  // the positions are kept for the later moves
+  m_pTestee->changeToDynamic(*dd);
+  ASSERT_TRUE(1 == m_pTestee->numOfLocals());
+  ASSERT_TRUE(dd == *m_pTestee->localDynBegin());
+}
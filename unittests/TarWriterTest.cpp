@@ -0,0 +1,95 @@
+//===- TarWriterTest.cpp --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Support/TarWriter.h"
+#include "TarWriterTest.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include <unistd.h>
+
+using namespace mcld;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+TarWriterTest::TarWriterTest() {
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+TarWriterTest::~TarWriterTest() {
+}
+
+// SetUp() will be called immediately before each test.
+void TarWriterTest::SetUp() {
+}
+
+// TearDown() will be called immediately after each test.
+void TarWriterTest::TearDown() {
+}
+
+static std::string readFile(const char* pPath) {
+  std::ifstream in(pPath, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in),
+                     std::istreambuf_iterator<char>());
+}
+
+static bool hasValidChecksum(const char* pHeader) {
+  unsigned checksum = 0;
+  for (size_t i = 0; i < 512; ++i)
+    checksum += (i >= 148 && i < 156) ? ' ' : (unsigned char)pHeader[i];
+  return checksum == std::strtoul(pHeader + 148, NULL, 8);
+}
+
+//==========================================================================//
+// Testcases
+//
+TEST_F(TarWriterTest, ustar) {
+  char path[] = "/tmp/mcld-tar-XXXXXX";
+  int fd = ::mkstemp(path);
+  ASSERT_TRUE(fd >= 0);
+  ::close(fd);
+
+  std::unique_ptr<TarWriter> tar;
+  ASSERT_FALSE(TarWriter::create(path, "repro", tar));
+  tar->append("response.txt", "a.o\n");
+  // a path is only added once
+  tar->append("response.txt", "b.o\n");
+  tar->append(std::string(120, 'x') + ".o", "\x7f" "ELF");
+  ASSERT_FALSE(tar->close());
+
+  std::string data = readFile(path);
+  // a header and a block of content for each file, a PAX header and its
+  // record, and two zero blocks
+  ASSERT_TRUE(512 * 8 == data.size());
+
+  const char* header = data.data();
+  ASSERT_STREQ("repro/response.txt", header);
+  ASSERT_TRUE(0 == std::memcmp(header + 257, "ustar", 6));
+  ASSERT_TRUE(4 == std::strtoul(header + 124, NULL, 8));
+  ASSERT_TRUE(hasValidChecksum(header));
+  ASSERT_TRUE(0 == std::memcmp(header + 512, "a.o\n", 4));
+
+  const char* pax = header + 1024;
+  ASSERT_TRUE('x' == pax[156]);
+  ASSERT_TRUE(hasValidChecksum(pax));
+  std::string record = "138 path=repro/" + std::string(120, 'x') + ".o\n";
+  ASSERT_TRUE(record.size() == std::strtoul(pax + 124, NULL, 8));
+  ASSERT_TRUE(0 == std::memcmp(pax + 512, record.data(), record.size()));
+
+  const char* elf = pax + 1024;
+  ASSERT_TRUE('0' == elf[156]);
+  ASSERT_TRUE(0 == std::memcmp(elf + 512, "\x7f" "ELF", 4));
+  ASSERT_TRUE(std::string(1024, '\0') == data.substr(512 * 6));
+
+  ::unlink(path);
+}
@@ -0,0 +1,38 @@
+//===- TarWriterTest.h ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_TAR_WRITER_TEST_H
+#define MCLD_TAR_WRITER_TEST_H
+
+#include <gtest.h>
+
+namespace mcldtest {
+
+/** \class TarWriterTest
+ *  \brief Testcase for the ustar archives of TarWriter
+ *
+ *  \see TarWriter
+ */
+class TarWriterTest : public ::testing::Test {
+ public:
+  // Constructor can do set-up work for all test here.
+  TarWriterTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~TarWriterTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+};
+
+}  // namespace of mcldtest
+
+#endif
@@ -0,0 +1,170 @@
+//===- ThreadPoolTest.cpp -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LinkerConfig.h"
+#include "mcld/LD/Diagnostic.h"
+#include "mcld/LD/DiagnosticPrinter.h"
+#include "mcld/Support/MsgHandling.h"
+#include "mcld/Support/ThreadPool.h"
+#include "ThreadPoolTest.h"
+
+#include <llvm/ADT/StringExtras.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+using namespace mcld;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+ThreadPoolTest::ThreadPoolTest() {
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+ThreadPoolTest::~ThreadPoolTest() {
+}
+
+// SetUp() will be called immediately before each test.
+void ThreadPoolTest::SetUp() {
+}
+
+// TearDown() will be called immediately after each test.
+void ThreadPoolTest::TearDown() {
+}
+
+namespace {
+
+/** \class RecordingPrinter
+ *  \brief RecordingPrinter keeps the first argument of each diagnostic.
+ */
+class RecordingPrinter : public DiagnosticPrinter {
+ public:
+  virtual void handleDiagnostic(DiagnosticEngine::Severity pSeverity,
+                                const Diagnostic& pInfo) {
+    DiagnosticPrinter::handleDiagnostic(pSeverity, pInfo);
+    args.push_back(pInfo.getArgStdStr(0));
+  }
+
+  std::vector<std::string> args;
+};
+
+}  // anonymous namespace
+
+//==========================================================================//
+// Testcases
+//
+TEST_F(ThreadPoolTest, serial_pool) {
+  ThreadPool pool(1);
+  ASSERT_FALSE(pool.isParallel());
+  ASSERT_TRUE(1 == pool.size());
+
+  // a serial pool runs the task in place
+  int counter = 0;
+  pool.async([&counter]() { ++counter; });
+  ASSERT_TRUE(1 == counter);
+  pool.wait();
+  ASSERT_TRUE(1 == counter);
+}
+
+TEST_F(ThreadPoolTest, async_and_wait) {
+  ThreadPool pool(4);
+  ASSERT_TRUE(pool.isParallel());
+  ASSERT_TRUE(4 == pool.size());
+
+  std::atomic<int> counter(0);
+  for (int i = 0; i < 1000; ++i)
+    pool.async([&counter]() { ++counter; });
+  pool.wait();
+  ASSERT_TRUE(1000 == counter.load());
+
+  // the pool can be reused after wait()
+  for (int i = 0; i < 10; ++i)
+    pool.async([&counter]() { ++counter; });
+  pool.wait();
+  ASSERT_TRUE(1010 == counter.load());
+}
+
+TEST_F(ThreadPoolTest, parallel_for_visits_each_index_once) {
+  ThreadPool pool(3);
+  std::vector<int> visited(1001, 0);
+  parallelFor(pool, 0, visited.size(), [&visited](size_t pIndex) {
+    ++visited[pIndex];
+  });
+  for (size_t i = 0; i < visited.size(); ++i)
+    ASSERT_TRUE(1 == visited[i]);
+}
+
+TEST_F(ThreadPoolTest, parallel_for_empty_range) {
+  ThreadPool pool(2);
+  int counter = 0;
+  parallelFor(pool, 5, 5, [&counter](size_t pIndex) { ++counter; });
+  ASSERT_TRUE(0 == counter);
+}
+
+TEST_F(ThreadPoolTest, parallel_for_reports_in_index_order) {
+  // the engine keeps pointers to both after the test
+  static LinkerConfig config("x86_64-linux-gnu");
+  static RecordingPrinter printer;
+  InitializeDiagnosticEngine(config, &printer);
+
+  ThreadPool pool(4);
+  parallelFor(pool, 0, 64, [](size_t pIndex) {
+    warning(diag::warn_cannot_write_time_trace) << llvm::utostr(pIndex)
+                                                << "reason";
+  });
+  ASSERT_TRUE(64 == printer.args.size());
+  for (size_t i = 0; i < printer.args.size(); ++i)
+    ASSERT_TRUE(llvm::utostr(i) == printer.args[i]);
+  ASSERT_TRUE(64 == printer.getNumWarnings());
+}
+
+TEST_F(ThreadPoolTest, nested_pools) {
+  // every outer task waits on a pool of its own while the outer pool holds
+  // all the workers
+  ThreadPool outer(2);
+  std::atomic<int> counter(0);
+  for (int i = 0; i < 8; ++i) {
+    outer.async([&counter]() {
+      ThreadPool inner(2);
+      for (int j = 0; j < 100; ++j)
+        inner.async([&counter]() { ++counter; });
+      inner.wait();
+    });
+  }
+  outer.wait();
+  ASSERT_TRUE(800 == counter.load());
+}
+
+TEST_F(ThreadPoolTest, parallel_for_each) {
+  ThreadPool pool(3);
+  std::vector<int> values(257, 1);
+  parallelForEach(pool, values.begin(), values.end(), [](int& pValue) {
+    pValue += 1;
+  });
+  for (size_t i = 0; i < values.size(); ++i)
+    ASSERT_TRUE(2 == values[i]);
+}
+
+TEST_F(ThreadPoolTest, parallel_reduce_keeps_index_order) {
+  // the concatenation is associative but not commutative
+  std::string expected;
+  for (size_t i = 0; i < 300; ++i)
+    expected += llvm::utostr(i % 10);
+
+  for (unsigned threads = 1; threads <= 4; ++threads) {
+    ThreadPool pool(threads);
+    std::string result = parallelReduce(
+        pool, 0, 300, std::string(),
+        [](size_t pIndex) { return llvm::utostr(pIndex % 10); },
+        [](const std::string& pLeft, const std::string& pRight) {
+          return pLeft + pRight;
+        });
+    ASSERT_TRUE(expected == result);
+  }
+}
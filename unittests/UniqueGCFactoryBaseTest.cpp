@@ -64,6 +64,19 @@ TEST_F(UniqueGCFactoryBaseTest, unique_produce2) {
   delete contextFactory;
 }
 
+TEST_F(UniqueGCFactoryBaseTest, member_produce) {
+  ContextFactory* contextFactory = new ContextFactory(10);
+  LDContext* context1 = contextFactory->produce("abc/def");
+  LDContext* member1 = contextFactory->produce();
+  LDContext* member2 = contextFactory->produce();
+  ASSERT_TRUE(3 == contextFactory->size());
+  ASSERT_NE(member1, member2);
+  ASSERT_NE(context1, member1);
+  LDContext* context2 = contextFactory->produce("abc/def");
+  ASSERT_EQ(context1, context2);
+  delete contextFactory;
+}
+
 TEST_F(UniqueGCFactoryBaseTest, iterator) {
   sys::fs::Path path1(TOPDIR), path2(TOPDIR);
   path1.append("unittests/test.txt");
@@ -0,0 +1,86 @@
+//===- VersionScriptTest.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/LD/VersionScript.h"
+#include "VersionScriptTest.h"
+
+#include <string>
+
+using namespace mcld;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+VersionScriptTest::VersionScriptTest() {
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+VersionScriptTest::~VersionScriptTest() {
+}
+
+// SetUp() will be called immediately before each test.
+void VersionScriptTest::SetUp() {
+}
+
+// TearDown() will be called immediately after each test.
+void VersionScriptTest::TearDown() {
+}
+
+//==========================================================================//
+// Testcases
+//
+TEST_F(VersionScriptTest, anonymous_node) {
+  VersionScript script;
+  std::string error;
+  ASSERT_TRUE(script.parse("{ global: foo; bar_*; local: *; };", error));
+  ASSERT_FALSE(script.empty());
+  ASSERT_TRUE(VersionScript::Global == script.scope("foo"));
+  ASSERT_TRUE(VersionScript::Global == script.scope("bar_baz"));
+  ASSERT_TRUE(VersionScript::Local == script.scope("baz"));
+}
+
+TEST_F(VersionScriptTest, named_nodes) {
+  VersionScript script;
+  std::string error;
+  ASSERT_TRUE(script.parse("# the public interface\n"
+                           "LIBFOO_1.0 {\n"
+                           "  global:\n"
+                           "    foo_init; /* the entry */\n"
+                           "    extern \"C++\" { ns::*; };\n"
+                           "  local:\n"
+                           "    foo_*;\n"
+                           "};\n"
+                           "LIBFOO_2.0 { foo_run; } LIBFOO_1.0;\n",
+                           error));
+  ASSERT_TRUE(VersionScript::Global == script.scope("foo_init"));
+  ASSERT_TRUE(VersionScript::Global == script.scope("foo_run"));
+  ASSERT_TRUE(VersionScript::Local == script.scope("foo_helper"));
+  ASSERT_TRUE(VersionScript::Unspecified == script.scope("bar"));
+}
+
+TEST_F(VersionScriptTest, malformed) {
+  VersionScript script;
+  std::string error;
+  ASSERT_FALSE(script.parse("{ global: foo }", error));
+  ASSERT_FALSE(error.empty());
+  ASSERT_FALSE(script.parse("{ global: foo; }", error));
+}
+
+TEST_F(VersionScriptTest, compiled_patterns) {
+  VersionScript script;
+  std::string error;
+  ASSERT_TRUE(script.parse("{ global: api_*; api_v?_*; *_export;\n"
+                           "  local: api_internal_*; _Z*; *; };",
+                           error));
+  // a global prefix wins over a longer local prefix
+  ASSERT_TRUE(VersionScript::Global == script.scope("api_internal_init"));
+  ASSERT_TRUE(VersionScript::Global == script.scope("api_v2_run"));
+  ASSERT_TRUE(VersionScript::Global == script.scope("foo_export"));
+  ASSERT_TRUE(VersionScript::Local == script.scope("_ZN3foo3barEv"));
+  ASSERT_TRUE(VersionScript::Local == script.scope("ap"));
+  ASSERT_TRUE(VersionScript::Local == script.scope(""));
+}
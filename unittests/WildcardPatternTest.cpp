@@ -0,0 +1,91 @@
+//===- WildcardPatternTest.cpp --------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Script/WildcardPattern.h"
+#include "WildcardPatternTest.h"
+
+using namespace mcld;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+WildcardPatternTest::WildcardPatternTest() {
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+WildcardPatternTest::~WildcardPatternTest() {
+}
+
+// SetUp() will be called immediately before each test.
+void WildcardPatternTest::SetUp() {
+}
+
+// TearDown() will be called immediately after each test.
+void WildcardPatternTest::TearDown() {
+}
+
+static WildcardPattern* createPattern(const char* pPattern) {
+  return WildcardPattern::create(pPattern, WildcardPattern::SORT_NONE);
+}
+
+//==========================================================================//
+// Testcases
+//
+TEST_F(WildcardPatternTest, simple_shapes) {
+  WildcardPattern* exact = createPattern(".text");
+  ASSERT_TRUE(WildcardPattern::Exact == exact->matchKind());
+  ASSERT_TRUE(exact->matches(".text"));
+  ASSERT_FALSE(exact->matches(".text.foo"));
+
+  WildcardPattern* prefix = createPattern(".text.*");
+  ASSERT_TRUE(prefix->isPrefix());
+  ASSERT_TRUE(".text." == prefix->prefix());
+  ASSERT_TRUE(prefix->matches(".text.foo"));
+  ASSERT_FALSE(prefix->matches(".text"));
+
+  WildcardPattern* suffix = createPattern("*.init_array");
+  ASSERT_TRUE(WildcardPattern::Suffix == suffix->matchKind());
+  ASSERT_TRUE(suffix->matches(".ctors.init_array"));
+  ASSERT_FALSE(suffix->matches(".init_array.1"));
+
+  WildcardPattern* contains = createPattern("*crtbegin*");
+  ASSERT_TRUE(WildcardPattern::Contains == contains->matchKind());
+  ASSERT_TRUE(contains->matches("/usr/lib/crtbegin.o"));
+  ASSERT_FALSE(contains->matches("crtend.o"));
+
+  WildcardPattern* all = createPattern("*");
+  ASSERT_TRUE(all->isPrefix());
+  ASSERT_TRUE(all->matches(""));
+  ASSERT_TRUE(all->matches(".data"));
+
+  // an escaped wildcard is an ordinary character
+  WildcardPattern* escaped = createPattern("foo\\*");
+  ASSERT_TRUE(WildcardPattern::Exact == escaped->matchKind());
+  ASSERT_TRUE(escaped->matches("foo*"));
+  ASSERT_FALSE(escaped->matches("foobar"));
+}
+
+TEST_F(WildcardPatternTest, globs) {
+  WildcardPattern* classes = createPattern(".text.[a-c]*");
+  ASSERT_TRUE(WildcardPattern::Glob == classes->matchKind());
+  ASSERT_FALSE(classes->isPrefix());
+  ASSERT_TRUE(classes->matches(".text.bar"));
+  ASSERT_FALSE(classes->matches(".text.foo"));
+
+  WildcardPattern* negated = createPattern("*.[!o]");
+  ASSERT_TRUE(negated->matches("libc.a"));
+  ASSERT_FALSE(negated->matches("crt1.o"));
+
+  WildcardPattern* stars = createPattern("*.ctors.*.?");
+  ASSERT_TRUE(stars->matches("a.ctors.b.ctors.c.1"));
+  ASSERT_FALSE(stars->matches("a.ctors.b.12"));
+
+  // an unterminated bracket is an ordinary character
+  WildcardPattern* bracket = createPattern("[abc");
+  ASSERT_TRUE(WildcardPattern::Exact == bracket->matchKind());
+  ASSERT_TRUE(bracket->matches("[abc"));
+}
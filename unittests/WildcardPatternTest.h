@@ -0,0 +1,38 @@
+//===- WildcardPatternTest.h ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_WILDCARD_PATTERN_TEST_H
+#define MCLD_WILDCARD_PATTERN_TEST_H
+
+#include <gtest.h>
+
+namespace mcldtest {
+
+/** \class WildcardPatternTest
+ *  \brief Testcase for the matching of WildcardPattern
+ *
+ *  \see WildcardPattern
+ */
+class WildcardPatternTest : public ::testing::Test {
+ public:
+  // Constructor can do set-up work for all test here.
+  WildcardPatternTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~WildcardPatternTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+};
+
+}  // namespace of mcldtest
+
+#endif